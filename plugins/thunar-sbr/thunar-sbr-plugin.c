@@ -62,6 +62,10 @@ thunar_extension_initialize (ThunarxProviderPlugin *plugin)
   g_message ("Initializing ThunarSbr extension");
 #endif
 
+  /* the replace renamer keeps a thread pool and per-thread buffers around,
+   * so the plugin must not be unloaded */
+  thunarx_provider_plugin_set_resident (plugin, TRUE);
+
   /* register the enum types for this plugin */
   thunar_sbr_register_enum_types (plugin);
 
@@ -35,6 +35,11 @@
 
 
 
+/* number of names processed by a single thread in a batch */
+#define TSRR_BATCH_CHUNK_SIZE (64)
+
+
+
 /* Property identifiers */
 enum
 {
@@ -66,6 +71,12 @@ thunar_sbr_replace_renamer_process (ThunarxRenamer  *renamer,
                                     ThunarxFileInfo *file,
                                     const gchar     *text,
                                     guint            idx);
+static gchar **
+thunar_sbr_replace_renamer_process_batch (ThunarxRenamer         *renamer,
+                                          guint                   n_items,
+                                          ThunarxFileInfo *const *files,
+                                          const gchar *const     *texts,
+                                          const guint            *indices);
 #ifdef HAVE_PCRE2
 static gchar *
 thunar_sbr_replace_renamer_pcre_exec (ThunarSbrReplaceRenamer *replace_renamer,
@@ -100,6 +111,36 @@ struct _ThunarSbrReplaceRenamer
 #endif
 };
 
+typedef struct
+{
+  ThunarSbrReplaceRenamer *replace_renamer;
+  const gchar *const      *texts;
+  gchar                  **names;
+  guint                    start;
+  guint                    end;
+
+  /* shared by all chunks of a batch */
+  gint   *n_pending;
+  GMutex *mutex;
+  GCond  *cond;
+} TsrrBatchChunk;
+
+#ifdef HAVE_PCRE2
+/* per-thread buffers for pcre2_substitute(), reused for every name */
+typedef struct
+{
+  pcre2_match_data *match_data;
+  uint32_t          match_data_pairs;
+  PCRE2_UCHAR      *output;
+  PCRE2_SIZE        output_size;
+} TsrrPcreScratch;
+
+static void
+tsrr_pcre_scratch_free (gpointer data);
+
+static GPrivate tsrr_pcre_scratch = G_PRIVATE_INIT (tsrr_pcre_scratch_free);
+#endif
+
 
 
 THUNARX_DEFINE_TYPE (ThunarSbrReplaceRenamer, thunar_sbr_replace_renamer, THUNARX_TYPE_RENAMER);
@@ -123,6 +164,7 @@ thunar_sbr_replace_renamer_class_init (ThunarSbrReplaceRenamerClass *klass)
 
   thunarxrenamer_class = THUNARX_RENAMER_CLASS (klass);
   thunarxrenamer_class->process = thunar_sbr_replace_renamer_process;
+  thunarxrenamer_class->process_batch = thunar_sbr_replace_renamer_process_batch;
 
   /**
    * ThunarSbrReplaceRenamer:case-sensitive:
@@ -453,60 +495,168 @@ thunar_sbr_replace_renamer_process (ThunarxRenamer  *renamer,
 
 
 
+static void
+thunar_sbr_replace_renamer_batch_chunk (gpointer data,
+                                        gpointer user_data)
+{
+  TsrrBatchChunk *chunk = data;
+  guint           n;
+
+  for (n = chunk->start; n < chunk->end; ++n)
+    chunk->names[n] = thunar_sbr_replace_renamer_process (THUNARX_RENAMER (chunk->replace_renamer), NULL, chunk->texts[n], n);
+
+  /* wake up the caller after the last chunk */
+  g_mutex_lock (chunk->mutex);
+  if (--(*chunk->n_pending) == 0)
+    g_cond_signal (chunk->cond);
+  g_mutex_unlock (chunk->mutex);
+}
+
+
+
+static gchar **
+thunar_sbr_replace_renamer_process_batch (ThunarxRenamer         *renamer,
+                                          guint                   n_items,
+                                          ThunarxFileInfo *const *files,
+                                          const gchar *const     *texts,
+                                          const guint            *indices)
+{
+  static GThreadPool *pool = NULL;
+  TsrrBatchChunk     *chunks;
+  GMutex              mutex;
+  GCond               cond;
+  gchar             **names;
+  guint               n_chunks;
+  guint               n;
+  gint                n_pending;
+
+  names = g_new0 (gchar *, n_items + 1);
+
+  /* the replacement only depends on the text, so the chunks can run in any thread */
+  n_chunks = MIN ((n_items + TSRR_BATCH_CHUNK_SIZE - 1) / TSRR_BATCH_CHUNK_SIZE, g_get_num_processors ());
+  if (n_chunks <= 1)
+    {
+      for (n = 0; n < n_items; ++n)
+        names[n] = thunar_sbr_replace_renamer_process (renamer, files[n], texts[n], indices[n]);
+      return names;
+    }
+
+  /* the pool shares its threads with other non-exclusive pools */
+  if (g_once_init_enter (&pool))
+    g_once_init_leave (&pool, g_thread_pool_new (thunar_sbr_replace_renamer_batch_chunk, NULL, g_get_num_processors (), FALSE, NULL));
+
+  g_mutex_init (&mutex);
+  g_cond_init (&cond);
+  n_pending = n_chunks;
+
+  /* split the names into evenly sized chunks */
+  chunks = g_new (TsrrBatchChunk, n_chunks);
+  for (n = 0; n < n_chunks; ++n)
+    {
+      chunks[n].replace_renamer = THUNAR_SBR_REPLACE_RENAMER (renamer);
+      chunks[n].texts = texts;
+      chunks[n].names = names;
+      chunks[n].start = (guint) (((guint64) n_items * n) / n_chunks);
+      chunks[n].end = (guint) (((guint64) n_items * (n + 1)) / n_chunks);
+      chunks[n].n_pending = &n_pending;
+      chunks[n].mutex = &mutex;
+      chunks[n].cond = &cond;
+
+      /* process the first chunk in this thread */
+      if (n > 0)
+        g_thread_pool_push (pool, &chunks[n], NULL);
+    }
+  thunar_sbr_replace_renamer_batch_chunk (&chunks[0], NULL);
+
+  /* wait for the other chunks */
+  g_mutex_lock (&mutex);
+  while (n_pending > 0)
+    g_cond_wait (&cond, &mutex);
+  g_mutex_unlock (&mutex);
+
+  g_mutex_clear (&mutex);
+  g_cond_clear (&cond);
+  g_free (chunks);
+
+  return names;
+}
+
+
+
 #ifdef HAVE_PCRE2
+static void
+tsrr_pcre_scratch_free (gpointer data)
+{
+  TsrrPcreScratch *scratch = data;
+
+  if (scratch->match_data != NULL)
+    pcre2_match_data_free (scratch->match_data);
+  g_free (scratch->output);
+  g_slice_free (TsrrPcreScratch, scratch);
+}
+
+
+
 static gchar *
 thunar_sbr_replace_renamer_pcre_exec (ThunarSbrReplaceRenamer *replace_renamer,
                                       const gchar             *subject)
 {
-  GString    *result;
-  int         error;
-  PCRE2_SIZE  erroffset;
-  gchar       output[1024];
-  pcre2_code *compiled_pattern;
-  PCRE2_SIZE  outlen;
-  int         n_substitutions; /* number of substitutions that were carried out */
-
-  result = g_string_sized_new (32);
-
-  compiled_pattern = pcre2_compile_8 ((PCRE2_SPTR) replace_renamer->pattern,
-                                      PCRE2_ZERO_TERMINATED,
-                                      0,
-                                      &error,
-                                      &erroffset,
-                                      0);
-  if (compiled_pattern == NULL)
-    return g_strdup (subject);
-
-  pcre2_jit_compile (compiled_pattern, PCRE2_JIT_COMPLETE);
-
-  outlen = sizeof (output) / sizeof (PCRE2_UCHAR);
-
-  n_substitutions = pcre2_substitute (compiled_pattern,
-                                      (PCRE2_SPTR) subject,
-                                      PCRE2_ZERO_TERMINATED,
-                                      0,
-                                      PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_EXTENDED,
-                                      0,
-                                      0,
-                                      (PCRE2_SPTR) replace_renamer->replacement,
-                                      PCRE2_ZERO_TERMINATED,
-                                      (PCRE2_UCHAR *) output,
-                                      &outlen);
+  TsrrPcreScratch *scratch;
+  PCRE2_UCHAR      buffer[256];
+  PCRE2_SIZE       outlen;
+  uint32_t         n_pairs;
+  int              n_substitutions; /* number of substitutions that were carried out */
+
+  /* lookup the buffers of this thread */
+  scratch = g_private_get (&tsrr_pcre_scratch);
+  if (G_UNLIKELY (scratch == NULL))
+    {
+      scratch = g_slice_new0 (TsrrPcreScratch);
+      scratch->output_size = 1024;
+      scratch->output = g_new (PCRE2_UCHAR, scratch->output_size);
+      g_private_set (&tsrr_pcre_scratch, scratch);
+    }
 
-  if (n_substitutions < 0)
+  /* make sure the match data can hold all capture groups of the pattern */
+  n_pairs = replace_renamer->pcre_capture_count + 1;
+  if (G_UNLIKELY (scratch->match_data_pairs < n_pairs))
     {
-      PCRE2_UCHAR buffer[256];
-      pcre2_get_error_message (error, buffer, sizeof (buffer));
-      g_warning ("PCRE2 substitution failed at offset %d: %s\n", (int) erroffset, buffer);
-      return g_strdup (subject);
+      if (scratch->match_data != NULL)
+        pcre2_match_data_free (scratch->match_data);
+      scratch->match_data = pcre2_match_data_create (n_pairs, NULL);
+      scratch->match_data_pairs = n_pairs;
     }
 
-  pcre2_code_free (compiled_pattern);
+  for (;;)
+    {
+      outlen = scratch->output_size;
+      n_substitutions = pcre2_substitute (replace_renamer->pcre_pattern,
+                                          (PCRE2_SPTR) subject,
+                                          PCRE2_ZERO_TERMINATED,
+                                          0,
+                                          PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_EXTENDED | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH,
+                                          scratch->match_data,
+                                          NULL,
+                                          (PCRE2_SPTR) replace_renamer->replacement,
+                                          PCRE2_ZERO_TERMINATED,
+                                          scratch->output,
+                                          &outlen);
+
+      /* grow the output buffer to the required length and try again */
+      if (n_substitutions != PCRE2_ERROR_NOMEMORY)
+        break;
+      scratch->output_size = outlen;
+      scratch->output = g_renew (PCRE2_UCHAR, scratch->output, scratch->output_size);
+    }
 
-  for (size_t i = 0; i < outlen; i++)
-    g_string_append_c (result, output[i]);
+  if (n_substitutions < 0)
+    {
+      pcre2_get_error_message (n_substitutions, buffer, sizeof (buffer));
+      g_warning ("PCRE2 substitution failed: %s\n", buffer);
+      return g_strdup (subject);
+    }
 
-  return g_string_free (result, FALSE);
+  return g_strndup ((const gchar *) scratch->output, outlen);
 }
 
 
@@ -521,6 +671,7 @@ thunar_sbr_replace_renamer_pcre_update (ThunarSbrReplaceRenamer *replace_renamer
   gint         error_offset = -1;
   int          error;
   PCRE2_SIZE   erroffset;
+  uint32_t     capture_count;
 
   /* pre-compile the pattern if regexp is enabled */
   if (G_UNLIKELY (replace_renamer->regexp))
@@ -532,7 +683,18 @@ thunar_sbr_replace_renamer_pcre_update (ThunarSbrReplaceRenamer *replace_renamer
       /* try to compile the new pattern */
       replace_renamer->pcre_pattern = pcre2_compile ((PCRE2_SPTR) replace_renamer->pattern, PCRE2_ZERO_TERMINATED, 0, &error, &erroffset, 0);
 
-      if (replace_renamer->pcre_pattern == NULL)
+      if (G_LIKELY (replace_renamer->pcre_pattern != NULL))
+        {
+          /* translate to machine code, falls back to the interpreter if JIT is not available */
+          pcre2_jit_compile (replace_renamer->pcre_pattern, PCRE2_JIT_COMPLETE);
+
+          /* the match data must be large enough for all capture groups */
+          if (pcre2_pattern_info (replace_renamer->pcre_pattern, PCRE2_INFO_CAPTURECOUNT, &capture_count) == 0)
+            replace_renamer->pcre_capture_count = capture_count;
+          else
+            replace_renamer->pcre_capture_count = 0;
+        }
+      else
         {
           PCRE2_UCHAR buffer[256];
           pcre2_get_error_message (error, buffer, sizeof (buffer));
@@ -73,6 +73,10 @@ thunar_tpa_query_trash_reply (GObject      *source_object,
                               GAsyncResult *result,
                               gpointer      user_data);
 static void
+thunar_tpa_query_trash_usage_reply (GObject      *source_object,
+                                    GAsyncResult *result,
+                                    gpointer      user_data);
+static void
 thunar_tpa_drag_data_received (GtkWidget        *button,
                                GdkDragContext   *context,
                                gint              x,
@@ -123,6 +127,9 @@ struct _ThunarTpa
   GCancellable   *cancellable_empty_trash;
   GCancellable   *cancellable_move_to_trash;
   GCancellable   *cancellable_query_trash;
+
+  /* the file manager does not know QueryTrashUsage, use QueryTrash instead */
+  gboolean no_trash_usage;
 };
 
 /* Target types for dropping to the trash can */
@@ -414,6 +421,57 @@ thunar_tpa_query_trash_reply (GObject      *source_object,
 
 
 
+static void
+thunar_tpa_query_trash_usage_reply (GObject      *source_object,
+                                    GAsyncResult *result,
+                                    gpointer      user_data)
+{
+  thunarTPATrash *proxy = THUNAR_TPA_TRASH (source_object);
+  ThunarTpa      *plugin = THUNAR_TPA (user_data);
+  GError         *error = NULL;
+  guint64         n_items;
+  guint64         size;
+  gchar          *size_string;
+  gchar          *tooltip;
+
+  if (thunar_tpa_trash_call_query_trash_usage_finish (proxy, &n_items, &size, result, &error))
+    {
+      thunar_tpa_state (plugin, n_items > 0);
+
+      /* tell the user how much is in the trash */
+      if (n_items > 0)
+        {
+          size_string = g_format_size (size);
+          tooltip = g_strdup_printf (ngettext ("Trash contains %" G_GUINT64_FORMAT " item (%s)",
+                                               "Trash contains %" G_GUINT64_FORMAT " items (%s)",
+                                               n_items),
+                                     n_items, size_string);
+          gtk_widget_set_tooltip_text (plugin->button, tooltip);
+          g_free (size_string);
+          g_free (tooltip);
+        }
+    }
+  else if (g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD))
+    {
+      /* an older file manager, fall back to QueryTrash */
+      plugin->no_trash_usage = TRUE;
+      g_error_free (error);
+      thunar_tpa_query_trash (plugin);
+    }
+  else if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      /* setup an error tooltip/plugin */
+      thunar_tpa_error (plugin, error);
+      g_error_free (error);
+    }
+  else
+    {
+      g_error_free (error);
+    }
+}
+
+
+
 static void
 thunar_tpa_drag_data_received (GtkWidget        *button,
                                GdkDragContext   *context,
@@ -595,7 +653,10 @@ thunar_tpa_query_trash (ThunarTpa *plugin)
       g_cancellable_cancel (plugin->cancellable_query_trash);
       g_cancellable_reset (plugin->cancellable_query_trash);
 
-      /* schedule a new call */
-      thunar_tpa_trash_call_query_trash (plugin->proxy, plugin->cancellable_query_trash, thunar_tpa_query_trash_reply, plugin);
+      /* schedule a new call, the usage is answered without walking the trash */
+      if (!plugin->no_trash_usage)
+        thunar_tpa_trash_call_query_trash_usage (plugin->proxy, plugin->cancellable_query_trash, thunar_tpa_query_trash_usage_reply, plugin);
+      else
+        thunar_tpa_trash_call_query_trash (plugin->proxy, plugin->cancellable_query_trash, thunar_tpa_query_trash_reply, plugin);
     }
 }
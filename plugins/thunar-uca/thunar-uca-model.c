@@ -52,6 +52,9 @@
 #define _PATH_BSHELL "/bin/sh"
 #endif
 
+/* maximum number of selection signatures remembered by thunar_uca_model_match() */
+#define THUNAR_UCA_MODEL_MAX_MATCH_CACHE (64)
+
 
 
 typedef struct _ThunarUcaModelItem ThunarUcaModelItem;
@@ -137,6 +140,10 @@ thunar_uca_model_item_reset (ThunarUcaModelItem *item);
 static void
 thunar_uca_model_item_free (gpointer data);
 static void
+thunar_uca_model_item_compile (ThunarUcaModelItem *item);
+static void
+thunar_uca_model_invalidate_matches (ThunarUcaModel *uca_model);
+static void
 start_element_handler (GMarkupParseContext *context,
                        const gchar         *element_name,
                        const gchar        **attribute_names,
@@ -168,6 +175,10 @@ struct _ThunarUcaModel
 
   GList *items;
   gint   stamp;
+
+  /* results of thunar_uca_model_match(), keyed by selection signature */
+  GHashTable *match_cache;
+  gboolean    match_cacheable;
 };
 
 struct _ThunarUcaModelItem
@@ -186,6 +197,14 @@ struct _ThunarUcaModelItem
 
   /* derived attributes */
   guint multiple_selection : 1;
+  guint match_all : 1;      /* one of the patterns is "*" */
+  guint has_range : 1;
+  gint  range_lower;
+  gint  range_upper;
+
+  /* compiled patterns, "*.ext" patterns are kept in a set of extensions */
+  GHashTable *extensions;
+  GPtrArray  *pattern_specs;
 };
 
 typedef XFCE_GENERIC_STACK (ParserState) ParserStack;
@@ -271,6 +290,8 @@ thunar_uca_model_init (ThunarUcaModel *uca_model)
   /* generate a unique stamp */
   uca_model->stamp = g_random_int ();
 
+  uca_model->match_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_array_unref);
+
   /* determine the path to the uca.xml config */
   filename = xfce_resource_lookup (XFCE_RESOURCE_CONFIG, "Thunar/uca.xml");
   if (G_LIKELY (filename != NULL))
@@ -297,6 +318,8 @@ thunar_uca_model_finalize (GObject *object)
   /* release all items */
   g_list_free_full (uca_model->items, thunar_uca_model_item_free);
 
+  g_hash_table_destroy (uca_model->match_cache);
+
   (*G_OBJECT_CLASS (thunar_uca_model_parent_class)->finalize) (object);
 }
 
@@ -655,6 +678,11 @@ thunar_uca_model_item_reset (ThunarUcaModelItem *item)
   if (item->gicon != NULL)
     g_object_unref (item->gicon);
 
+  if (item->extensions != NULL)
+    g_hash_table_destroy (item->extensions);
+  if (item->pattern_specs != NULL)
+    g_ptr_array_unref (item->pattern_specs);
+
   /* ...and reset the item memory */
   memset (item, 0, sizeof (*item));
 }
@@ -671,6 +699,91 @@ thunar_uca_model_item_free (gpointer data)
 
 
 
+static void
+thunar_uca_model_item_compile (ThunarUcaModelItem *item)
+{
+  const gchar *pattern;
+  gchar      **limits;
+  guint        n;
+
+  /* parse the range of the selection size once */
+  if (item->range != NULL)
+    {
+      limits = g_strsplit (item->range, "-", 2);
+      if (limits[0] != NULL && limits[1] != NULL)
+        {
+          item->range_lower = g_strtod (limits[0], NULL);
+          item->range_upper = g_strtod (limits[1], NULL);
+          item->has_range = TRUE;
+        }
+      g_strfreev (limits);
+    }
+
+  /* compile the patterns, simple "*.ext" patterns are looked up by extension */
+  item->extensions = g_hash_table_new (g_str_hash, g_str_equal);
+  item->pattern_specs = g_ptr_array_new_with_free_func ((GDestroyNotify) g_pattern_spec_free);
+  for (n = 0; item->patterns[n] != NULL; ++n)
+    {
+      pattern = item->patterns[n];
+      if (strcmp (pattern, "*") == 0)
+        item->match_all = TRUE;
+      else if (pattern[0] == '*' && pattern[1] == '.' && strpbrk (pattern + 2, "*?.") == NULL)
+        g_hash_table_add (item->extensions, (gpointer) (pattern + 1));
+      else
+        g_ptr_array_add (item->pattern_specs, g_pattern_spec_new (pattern));
+    }
+}
+
+
+
+static gboolean
+thunar_uca_model_item_match_name (const ThunarUcaModelItem *item,
+                                  const gchar              *name,
+                                  const gchar              *extension)
+{
+  gsize name_len;
+  guint n;
+
+  if (item->match_all)
+    return TRUE;
+
+  if (extension != NULL && g_hash_table_contains (item->extensions, extension))
+    return TRUE;
+
+  name_len = strlen (name);
+  for (n = 0; n < item->pattern_specs->len; ++n)
+    if (g_pattern_spec_match (g_ptr_array_index (item->pattern_specs, n), name_len, name, NULL))
+      return TRUE;
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_uca_model_invalidate_matches (ThunarUcaModel *uca_model)
+{
+  ThunarUcaModelItem *item;
+  GList              *lp;
+
+  g_hash_table_remove_all (uca_model->match_cache);
+
+  /* results can only be reused for other selections with the same signature
+   * if no item has a pattern which depends on more than the extension */
+  uca_model->match_cacheable = TRUE;
+  for (lp = uca_model->items; lp != NULL; lp = lp->next)
+    {
+      item = lp->data;
+      if (item->pattern_specs != NULL && item->pattern_specs->len > 0)
+        {
+          uca_model->match_cacheable = FALSE;
+          break;
+        }
+    }
+}
+
+
+
 static void
 start_element_handler (GMarkupParseContext *context,
                        const gchar         *element_name,
@@ -1142,19 +1255,26 @@ thunar_uca_model_match (ThunarUcaModel *uca_model,
   typedef struct
   {
     gchar         *name;
+    const gchar   *extension;
     ThunarUcaTypes types;
   } ThunarUcaFile;
 
   ThunarUcaModelItem *item;
+  ThunarUcaTypes      types = 0;
   ThunarUcaFile      *files;
+  GHashTable         *extensions = NULL;
+  GHashTableIter      hash_iter;
   GFile              *location;
+  GString            *signature = NULL;
+  GArray             *matches;
   gchar              *mime_type;
-  gboolean            matches;
+  gboolean            matched;
+  gpointer            key;
   GList              *paths = NULL;
+  GList              *keys;
   GList              *lp;
   gint                n_files;
-  gint                i, m, n;
-  gint                upper, lower;
+  gint                i, n;
   gchar              *path_test;
 
   g_return_val_if_fail (THUNAR_UCA_IS_MODEL (uca_model), NULL);
@@ -1171,75 +1291,129 @@ thunar_uca_model_match (ThunarUcaModel *uca_model,
     {
       location = thunarx_file_info_get_location (lp->data);
 
-      path_test = g_file_get_path (location);
-      if (path_test == NULL)
+      /* native files always have a path, only ask the others */
+      if (!g_file_is_native (location))
         {
-          /* cannot handle non-local files */
-          g_object_unref (location);
-          g_free (files);
-          return NULL;
+          path_test = g_file_get_path (location);
+          if (path_test == NULL)
+            {
+              /* cannot handle non-local files */
+              g_object_unref (location);
+              for (i = 0; i < n; ++i)
+                g_free (files[i].name);
+              g_free (files);
+              return NULL;
+            }
+          g_free (path_test);
         }
-      g_free (path_test);
 
       g_object_unref (location);
 
       mime_type = thunarx_file_info_get_mime_type (lp->data);
 
       files[n].name = thunarx_file_info_get_name (lp->data);
+      files[n].extension = strrchr (files[n].name, '.');
       files[n].types = types_from_mime_type (mime_type);
 
       if (G_UNLIKELY (files[n].types == 0))
         files[n].types = THUNAR_UCA_TYPE_OTHER_FILES;
 
+      /* every file has exactly one type */
+      types |= files[n].types;
+
       g_free (mime_type);
     }
 
+  /* if only the extensions matter, the selection is described by its size,
+   * types and extensions, and other selections with the same signature match
+   * the same items */
+  if (uca_model->match_cacheable)
+    {
+      extensions = g_hash_table_new (g_str_hash, g_str_equal);
+      for (n = 0; n < n_files; ++n)
+        g_hash_table_add (extensions, (gpointer) (files[n].extension != NULL ? files[n].extension : ""));
+
+      signature = g_string_new (NULL);
+      g_string_printf (signature, "%d:%x", n_files, (guint) types);
+      keys = g_list_sort (g_hash_table_get_keys (extensions), (GCompareFunc) strcmp);
+      for (lp = keys; lp != NULL; lp = lp->next)
+        {
+          g_string_append_c (signature, '/');
+          g_string_append (signature, lp->data);
+        }
+      g_list_free (keys);
+
+      matches = g_hash_table_lookup (uca_model->match_cache, signature->str);
+      if (matches != NULL)
+        {
+          g_string_free (signature, TRUE);
+          g_hash_table_destroy (extensions);
+          goto done;
+        }
+    }
+
   /* lookup the matching items */
+  matches = g_array_new (FALSE, FALSE, sizeof (gint));
   for (i = 0, lp = uca_model->items; lp != NULL; ++i, lp = lp->next)
     {
       /* check if we can just ignore this item */
       item = (ThunarUcaModelItem *) lp->data;
-      upper = n_files;
-      lower = n_files;
 
-      if (item->range != NULL)
-        {
-          gchar **limits = g_strsplit (item->range, "-", 2);
-          if (limits[0] != NULL && limits[1] != NULL)
-            {
-              lower = g_strtod (limits[0], NULL);
-              upper = g_strtod (limits[1], NULL);
-            }
-          g_strfreev (limits);
-        }
-
-      if ((n_files > upper) || (n_files < lower))
+      if (item->has_range && (n_files > item->range_upper || n_files < item->range_lower))
         continue;
       if (!item->multiple_selection && n_files > 1)
         continue;
 
-      /* match the specified files */
-      for (n = 0; n < n_files; ++n)
+      /* verify that we support the types of all files */
+      if ((types & ~item->types) != 0)
+        continue;
+
+      if (extensions != NULL)
         {
-          /* verify that we support this type of file */
-          if ((files[n].types & item->types) == 0)
-            break;
+          /* it's enough to check every extension once */
+          matched = TRUE;
+          if (!item->match_all)
+            {
+              g_hash_table_iter_init (&hash_iter, extensions);
+              while (matched && g_hash_table_iter_next (&hash_iter, &key, NULL))
+                matched = g_hash_table_contains (item->extensions, key);
+            }
 
-          /* atleast on pattern must match the file name */
-          for (m = 0, matches = FALSE; item->patterns[m] != NULL && !matches; ++m)
-            matches = g_pattern_match_simple (item->patterns[m], files[n].name);
+          if (!matched)
+            continue;
+        }
+      else
+        {
+          /* atleast on pattern must match each file name */
+          for (n = 0; n < n_files; ++n)
+            if (!thunar_uca_model_item_match_name (item, files[n].name, files[n].extension))
+              break;
 
-          /* no need to continue if none of the patterns match */
-          if (!matches)
-            break;
+          if (n < n_files)
+            continue;
         }
 
-      /* add the path if all files match one of the patterns */
-      if (G_UNLIKELY (n == n_files))
-        paths = g_list_append (paths, gtk_tree_path_new_from_indices (i, -1));
+      /* all files match one of the patterns */
+      g_array_append_val (matches, i);
+    }
+
+  /* remember the result for the next selection with this signature */
+  if (signature != NULL)
+    {
+      if (g_hash_table_size (uca_model->match_cache) >= THUNAR_UCA_MODEL_MAX_MATCH_CACHE)
+        g_hash_table_remove_all (uca_model->match_cache);
+      g_hash_table_insert (uca_model->match_cache, g_string_free (signature, FALSE), matches);
+      g_hash_table_destroy (extensions);
     }
 
+done:
+  /* generate the paths of the matching items */
+  for (n = (gint) matches->len - 1; n >= 0; --n)
+    paths = g_list_prepend (paths, gtk_tree_path_new_from_indices (g_array_index (matches, gint, n), -1));
+
   /* cleanup */
+  if (!uca_model->match_cacheable)
+    g_array_unref (matches);
   for (n = 0; n < n_files; ++n)
     g_free (files[n].name);
   g_free (files);
@@ -1270,6 +1444,7 @@ thunar_uca_model_append (ThunarUcaModel *uca_model,
   /* append the new item */
   item = g_new0 (ThunarUcaModelItem, 1);
   uca_model->items = g_list_append (uca_model->items, item);
+  thunar_uca_model_invalidate_matches (uca_model);
 
   /* determine the tree iter of the new item */
   iter->stamp = uca_model->stamp;
@@ -1323,6 +1498,7 @@ thunar_uca_model_exchange (ThunarUcaModel *uca_model,
   item = list_a->data;
   list_a->data = list_b->data;
   list_b->data = item;
+  thunar_uca_model_invalidate_matches (uca_model);
 
   /* notify listeners about the new order */
   path = gtk_tree_path_new ();
@@ -1372,6 +1548,7 @@ thunar_uca_model_remove (ThunarUcaModel *uca_model,
   item = ((GList *) iter->user_data)->data;
   uca_model->items = g_list_delete_link (uca_model->items, iter->user_data);
   thunar_uca_model_item_free (item);
+  thunar_uca_model_invalidate_matches (uca_model);
 
   /* notify listeners */
   gtk_tree_model_row_deleted (GTK_TREE_MODEL (uca_model), path);
@@ -1464,6 +1641,10 @@ thunar_uca_model_update (ThunarUcaModel *uca_model,
   /* check if this item will work for multiple files */
   item->multiple_selection = (command != NULL && (strstr (command, "%F") != NULL || strstr (command, "%D") != NULL || strstr (command, "%N") != NULL || strstr (command, "%U") != NULL));
 
+  /* prepare the item for thunar_uca_model_match() */
+  thunar_uca_model_item_compile (item);
+  thunar_uca_model_invalidate_matches (uca_model);
+
   /* notify listeners about the changed item */
   path = gtk_tree_model_get_path (GTK_TREE_MODEL (uca_model), iter);
   gtk_tree_model_row_changed (GTK_TREE_MODEL (uca_model), path, iter);
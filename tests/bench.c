@@ -0,0 +1,187 @@
+#include "bench.h"
+
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+
+
+/* the functions of a benchmark added with bench_add_full() */
+typedef struct
+{
+  gconstpointer    data;
+  BenchSetupFunc   setup;
+  GTestFixtureFunc test;
+  GTestFixtureFunc teardown;
+} BenchCase;
+
+
+
+/* the factor for the sizes of the benchmarks, see bench_init() */
+gdouble bench_scale = 1.0;
+
+/* whether the fixture of the running benchmark was set up */
+static gboolean bench_ready = FALSE;
+
+
+
+/* reads $THUNAR_BENCH_SCALE, to be called from main() */
+void
+bench_init (void)
+{
+  const gchar *scale;
+
+  scale = g_getenv ("THUNAR_BENCH_SCALE");
+  if (scale != NULL)
+    bench_scale = g_ascii_strtod (scale, NULL);
+  g_assert_cmpfloat (bench_scale, >, 0.0);
+}
+
+
+
+/* @n at the current scale, at least 1 */
+guint
+bench_scaled (guint n)
+{
+  return MAX (1, (guint) (n * bench_scale));
+}
+
+
+
+static void
+bench_case_setup (gpointer      fixture,
+                  gconstpointer user_data)
+{
+  const BenchCase *bench = user_data;
+
+  /* the benchmarks take too long for a regular test run */
+  if (!g_test_perf ())
+    {
+      g_test_skip ("only run in perf mode");
+      bench_ready = FALSE;
+      return;
+    }
+
+  bench_ready = bench->setup (fixture, bench->data);
+}
+
+
+
+static void
+bench_case_test (gpointer      fixture,
+                 gconstpointer user_data)
+{
+  const BenchCase *bench = user_data;
+
+  if (bench_ready)
+    bench->test (fixture, bench->data);
+}
+
+
+
+static void
+bench_case_teardown (gpointer      fixture,
+                     gconstpointer user_data)
+{
+  const BenchCase *bench = user_data;
+
+  if (bench_ready && bench->teardown != NULL)
+    bench->teardown (fixture, bench->data);
+  bench_ready = FALSE;
+}
+
+
+
+/* adds the benchmark @test at @path, which is only run in perf mode (and only
+ * if @setup succeeds), @fixture_size bytes are zeroed for its fixture */
+void
+bench_add_full (const gchar     *path,
+                gsize            fixture_size,
+                gconstpointer    data,
+                BenchSetupFunc   setup,
+                GTestFixtureFunc test,
+                GTestFixtureFunc teardown)
+{
+  BenchCase *bench;
+
+  /* the benchmarks are added once, for the lifetime of the test binary */
+  bench = g_new0 (BenchCase, 1);
+  bench->data = data;
+  bench->setup = setup;
+  bench->test = test;
+  bench->teardown = teardown;
+
+  g_test_add_vtable (path, fixture_size, bench, bench_case_setup, bench_case_test, bench_case_teardown);
+}
+
+
+
+/* prints the JSON object @line of a benchmark and appends it to $THUNAR_BENCH_RESULTS */
+void
+bench_publish (const gchar *line)
+{
+  const gchar *results;
+  FILE        *fp;
+
+  g_test_message ("%s", line);
+
+  results = g_getenv ("THUNAR_BENCH_RESULTS");
+  if (results != NULL)
+    {
+      fp = g_fopen (results, "a");
+      g_assert_nonnull (fp);
+      fprintf (fp, "%s\n", line);
+      fclose (fp);
+    }
+}
+
+
+
+/* publishes the time of @n_ops operations on @n_rows rows, @extra
+ * are additional members of the JSON object or %NULL */
+void
+bench_report (const gchar *name,
+              guint        n_rows,
+              guint        n_ops,
+              gdouble      elapsed,
+              const gchar *extra)
+{
+  gchar *line;
+
+  line = g_strdup_printf ("{\"benchmark\":\"%s\",\"scale\":%g,\"rows\":%u,\"ops\":%u,\"seconds\":%.6f,\"ns_per_op\":%.1f%s%s}",
+                          name, bench_scale, n_rows, n_ops, elapsed, elapsed * 1e9 / MAX (n_ops, 1),
+                          extra != NULL ? "," : "", extra != NULL ? extra : "");
+
+  g_test_minimized_result (elapsed, "%s: %.3f seconds", name, elapsed);
+  bench_publish (line);
+  g_free (line);
+}
+
+
+
+/* removes @path and everything below it, without following symbolic links */
+void
+bench_remove_path (const gchar *path)
+{
+  GStatBuf     statb;
+  const gchar *name;
+  gchar       *child;
+  GDir        *dir;
+
+  if (g_lstat (path, &statb) != 0)
+    return;
+
+  dir = S_ISDIR (statb.st_mode) ? g_dir_open (path, 0, NULL) : NULL;
+  if (dir != NULL)
+    {
+      while ((name = g_dir_read_name (dir)) != NULL)
+        {
+          child = g_build_filename (path, name, NULL);
+          bench_remove_path (child);
+          g_free (child);
+        }
+      g_dir_close (dir);
+    }
+
+  g_remove (path);
+}
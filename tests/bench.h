@@ -0,0 +1,54 @@
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS;
+
+/* Helpers shared by the benchmarks, run them with 'meson test --benchmark'.
+ *
+ * The sizes of the benchmarks are multiplied by $THUNAR_BENCH_SCALE (e.g. 0.01 for a
+ * quick run). The results are printed as one JSON object per benchmark (in a TAP
+ * comment), and appended to $THUNAR_BENCH_RESULTS if that is set. */
+
+extern gdouble bench_scale;
+
+/* sets up the @fixture of a benchmark, returns %FALSE after g_test_skip() if it cannot run */
+typedef gboolean (*BenchSetupFunc) (gpointer      fixture,
+                                    gconstpointer data);
+
+/* adds a benchmark with a fixture of type @Fixture, see bench_add_full() */
+#define bench_add(path, Fixture, data, setup, test, teardown) \
+  bench_add_full (path, sizeof (Fixture), data, \
+                  (BenchSetupFunc) (setup), (GTestFixtureFunc) (test), (GTestFixtureFunc) (teardown))
+
+void
+bench_init (void);
+
+guint
+bench_scaled (guint n);
+
+void
+bench_add_full (const gchar     *path,
+                gsize            fixture_size,
+                gconstpointer    data,
+                BenchSetupFunc   setup,
+                GTestFixtureFunc test,
+                GTestFixtureFunc teardown);
+
+void
+bench_publish (const gchar *line);
+
+void
+bench_report (const gchar *name,
+              guint        n_rows,
+              guint        n_ops,
+              gdouble      elapsed,
+              const gchar *extra);
+
+void
+bench_remove_path (const gchar *path);
+
+G_END_DECLS;
+
+#endif /* !__BENCH_H__ */
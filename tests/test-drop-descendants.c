@@ -0,0 +1,191 @@
+#include "thunar/thunar-gio-extensions.h"
+
+
+
+static GList *
+file_list_new (const gchar *first_path,
+               ...)
+{
+  GList       *file_list = NULL;
+  const gchar *path;
+  va_list      args;
+
+  va_start (args, first_path);
+  for (path = first_path; path != NULL; path = va_arg (args, const gchar *))
+    file_list = g_list_append (file_list, g_file_new_for_path (path));
+  va_end (args);
+
+  return file_list;
+}
+
+
+
+static void
+assert_file_list (GList       *file_list,
+                  const gchar *first_path,
+                  ...)
+{
+  const gchar *path;
+  va_list      args;
+  GList       *lp = file_list;
+
+  va_start (args, first_path);
+  for (path = first_path; path != NULL; path = va_arg (args, const gchar *), lp = lp->next)
+    {
+      g_assert_nonnull (lp);
+
+      g_autofree gchar *file_path = g_file_get_path (lp->data);
+      g_assert_cmpstr (file_path, ==, path);
+    }
+  va_end (args);
+
+  g_assert_null (lp);
+}
+
+
+
+static void
+test_drop_children (void)
+{
+  GList *file_list = file_list_new ("/tmp/a/b/c", "/tmp/a", "/tmp/x", "/tmp/a/b", "/tmp/x/y", NULL);
+
+  file_list = thunar_g_file_list_drop_descendants (file_list);
+  assert_file_list (file_list, "/tmp/a", "/tmp/x", NULL);
+
+  thunar_g_list_free_full (file_list);
+}
+
+
+
+static void
+test_keep_siblings_with_common_prefix (void)
+{
+  /* '-' and '.' sort before '/', which must not hide descendants behind siblings */
+  GList *file_list = file_list_new ("/tmp/a", "/tmp/a-b", "/tmp/a.c", "/tmp/ab", "/tmp/a/d", "/tmp/a-b/e", NULL);
+
+  file_list = thunar_g_file_list_drop_descendants (file_list);
+  assert_file_list (file_list, "/tmp/a", "/tmp/a-b", "/tmp/a.c", "/tmp/ab", NULL);
+
+  thunar_g_list_free_full (file_list);
+}
+
+
+
+static void
+test_drop_duplicates (void)
+{
+  GList *file_list = file_list_new ("/tmp/b", "/tmp/a", "/tmp/b", "/tmp/c", "/tmp/a", NULL);
+
+  file_list = thunar_g_file_list_drop_descendants (file_list);
+  assert_file_list (file_list, "/tmp/b", "/tmp/a", "/tmp/c", NULL);
+
+  thunar_g_list_free_full (file_list);
+}
+
+
+
+static void
+test_drop_all_below_root (void)
+{
+  GList *file_list = file_list_new ("/tmp/a", "/", "/usr", NULL);
+
+  file_list = thunar_g_file_list_drop_descendants (file_list);
+  assert_file_list (file_list, "/", NULL);
+
+  thunar_g_list_free_full (file_list);
+}
+
+
+
+static void
+test_match_is_descendant (void)
+{
+  const gchar *paths[] = { "/a", "/a/b", "/a/b/c", "/a-b", "/a-b/c", "/ab", "/b", "/b/a", "/b/a/b" };
+  GList       *file_list = NULL;
+  GList       *result;
+  GList       *lp;
+  GList       *lq;
+  gboolean     dropped;
+  gboolean     kept;
+
+  for (guint n = 0; n < G_N_ELEMENTS (paths); ++n)
+    file_list = g_list_append (file_list, g_file_new_for_path (paths[n]));
+
+  result = thunar_g_file_list_drop_descendants (thunar_g_list_copy_deep (file_list));
+
+  /* a file is dropped exactly if thunar_g_file_is_descendant() finds an ancestor for it */
+  for (lp = file_list; lp != NULL; lp = lp->next)
+    {
+      dropped = FALSE;
+      for (lq = file_list; lq != NULL; lq = lq->next)
+        if (lq != lp && thunar_g_file_is_descendant (lp->data, lq->data))
+          dropped = TRUE;
+
+      kept = FALSE;
+      for (lq = result; lq != NULL; lq = lq->next)
+        if (g_file_equal (lq->data, lp->data))
+          kept = TRUE;
+
+      g_assert_true (dropped != kept);
+    }
+
+  thunar_g_list_free_full (result);
+  thunar_g_list_free_full (file_list);
+}
+
+
+
+static void
+test_perf_large_list (void)
+{
+  GList  *file_list = NULL;
+  gchar  *path;
+  gdouble elapsed;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("only run in perf mode");
+      return;
+    }
+
+  /* 100 folders with 1000 files each, plus the folders themselves at the end */
+  for (guint i = 0; i < 100; ++i)
+    for (guint j = 0; j < 1000; ++j)
+      {
+        path = g_strdup_printf ("/tmp/thunar-perf/folder-%03u/file-%04u", i, j);
+        file_list = g_list_prepend (file_list, g_file_new_for_path (path));
+        g_free (path);
+      }
+  for (guint i = 0; i < 100; ++i)
+    {
+      path = g_strdup_printf ("/tmp/thunar-perf/folder-%03u", i);
+      file_list = g_list_prepend (file_list, g_file_new_for_path (path));
+      g_free (path);
+    }
+
+  g_test_timer_start ();
+  file_list = thunar_g_file_list_drop_descendants (file_list);
+  elapsed = g_test_timer_elapsed ();
+
+  g_assert_cmpuint (g_list_length (file_list), ==, 100);
+  g_test_minimized_result (elapsed, "dropped descendants of 100100 files in %.3f seconds", elapsed);
+
+  thunar_g_list_free_full (file_list);
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/drop-descendants/test_drop_children", test_drop_children);
+  g_test_add_func ("/drop-descendants/test_keep_siblings_with_common_prefix", test_keep_siblings_with_common_prefix);
+  g_test_add_func ("/drop-descendants/test_drop_duplicates", test_drop_duplicates);
+  g_test_add_func ("/drop-descendants/test_drop_all_below_root", test_drop_all_below_root);
+  g_test_add_func ("/drop-descendants/test_match_is_descendant", test_match_is_descendant);
+  g_test_add_func ("/drop-descendants/test_perf_large_list", test_perf_large_list);
+
+  return g_test_run ();
+}
@@ -0,0 +1,227 @@
+#include "bench.h"
+#include "thunar/thunar-folder-snapshot.h"
+#include "thunar/thunar-preferences.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+/* The snapshots are written to $XDG_CACHE_HOME, which points to a temporary directory */
+
+#define N_FILE_NAMES (3)
+
+static const gchar *const file_names[N_FILE_NAMES + 1] = { "a.txt", "b.png", ".hidden", NULL };
+
+
+
+static gchar *
+create_folder (void)
+{
+  gchar *path;
+  gchar *filename;
+
+  path = g_dir_make_tmp ("thunar-test-snapshot-XXXXXX", NULL);
+  g_assert_nonnull (path);
+
+  for (guint n = 0; n < N_FILE_NAMES; ++n)
+    {
+      filename = g_build_filename (path, file_names[n], NULL);
+      g_assert_true (g_file_set_contents (filename, file_names[n], -1, NULL));
+      g_free (filename);
+    }
+
+  return path;
+}
+
+
+
+static void
+delete_folder (const gchar *path)
+{
+  gchar *filename;
+
+  for (guint n = 0; n < N_FILE_NAMES; ++n)
+    {
+      filename = g_build_filename (path, file_names[n], NULL);
+      g_remove (filename);
+      g_free (filename);
+    }
+  g_rmdir (path);
+}
+
+
+
+/* writes the snapshot of @folder and waits until it can be loaded */
+static GList *
+save_and_load (ThunarFile *folder)
+{
+  GHashTable *files;
+  ThunarFile *file;
+  GFile      *gfile;
+  GList      *loaded;
+  gint64      end_time;
+
+  files = g_hash_table_new_full (g_direct_hash, NULL, g_object_unref, NULL);
+  for (guint n = 0; n < N_FILE_NAMES; ++n)
+    {
+      gfile = g_file_get_child (thunar_file_get_file (folder), file_names[n]);
+      file = thunar_file_get (gfile, NULL);
+      g_assert_nonnull (file);
+      thunar_file_set_content_type (file, "text/plain");
+      g_hash_table_add (files, file);
+      g_object_unref (gfile);
+    }
+
+  thunar_folder_snapshot_save (folder, files);
+
+  /* drop the files, so they are restored from the snapshot */
+  g_hash_table_destroy (files);
+
+  /* the write is done in a thread, and nothing wakes up the main loop if it fails */
+  end_time = g_get_monotonic_time () + 10 * G_USEC_PER_SEC;
+  while ((loaded = thunar_folder_snapshot_load (folder)) == NULL)
+    {
+      g_assert_cmpint (g_get_monotonic_time (), <, end_time);
+      if (!g_main_context_iteration (NULL, FALSE))
+        g_usleep (10 * 1000);
+    }
+
+  return loaded;
+}
+
+
+
+static void
+test_round_trip (void)
+{
+  ThunarFile *folder;
+  ThunarFile *file;
+  GFileInfo  *info;
+  GList      *files;
+  GList      *lp;
+  gchar      *path;
+  guint       n_hidden = 0;
+
+  path = create_folder ();
+  folder = thunar_file_get_for_uri (path, NULL);
+  g_assert_nonnull (folder);
+
+  files = save_and_load (folder);
+  g_assert_cmpuint (g_list_length (files), ==, N_FILE_NAMES);
+
+  for (lp = files; lp != NULL; lp = lp->next)
+    {
+      file = THUNAR_FILE (lp->data);
+      g_assert_true (g_strv_contains (file_names, thunar_file_get_basename (file)));
+      g_assert_cmpuint (thunar_file_get_size (file), ==, strlen (thunar_file_get_basename (file)));
+      g_assert_cmpstr (thunar_file_peek_content_type (file), ==, "text/plain");
+      if (thunar_file_is_hidden (file))
+        n_hidden++;
+    }
+  g_assert_cmpuint (n_hidden, ==, 1);
+
+  /* a scan replaces the provisional info by the complete one */
+  file = THUNAR_FILE (files->data);
+  g_assert_false (thunar_file_apply_pending_info (file));
+  info = g_file_query_info (thunar_file_get_file (file), THUNARX_FILE_INFO_NAMESPACE, G_FILE_QUERY_INFO_NONE, NULL, NULL);
+  g_assert_nonnull (info);
+  g_object_unref (thunar_file_get_with_info (thunar_file_get_file (file), info, NULL, FALSE));
+  g_assert_true (thunar_file_get_info (file) != info);
+  g_assert_true (thunar_file_apply_pending_info (file));
+  g_assert_true (thunar_file_get_info (file) == info);
+  g_assert_false (thunar_file_apply_pending_info (file));
+  g_object_unref (info);
+
+  thunar_g_list_free_full (files);
+  g_object_unref (folder);
+  delete_folder (path);
+  g_free (path);
+}
+
+
+
+static void
+test_stale (void)
+{
+  ThunarFile *folder;
+  GFile      *gfile;
+  gchar      *path;
+  guint64     mtime;
+
+  path = create_folder ();
+  folder = thunar_file_get_for_uri (path, NULL);
+  g_assert_nonnull (folder);
+
+  thunar_g_list_free_full (save_and_load (folder));
+
+  /* the snapshot is not used once the folder was modified */
+  gfile = g_file_new_for_path (path);
+  mtime = thunar_file_get_date (folder, THUNAR_FILE_DATE_MODIFIED);
+  g_assert_true (g_file_set_attribute_uint64 (gfile, G_FILE_ATTRIBUTE_TIME_MODIFIED, mtime + 10,
+                                              G_FILE_QUERY_INFO_NONE, NULL, NULL));
+  g_object_unref (gfile);
+
+  g_assert_true (thunar_file_reload (folder));
+  g_assert_null (thunar_folder_snapshot_load (folder));
+
+  g_object_unref (folder);
+  delete_folder (path);
+  g_free (path);
+}
+
+
+
+static void
+test_clear (void)
+{
+  ThunarFile *folder;
+  GList      *files;
+  gchar      *path;
+
+  path = create_folder ();
+  folder = thunar_file_get_for_uri (path, NULL);
+  g_assert_nonnull (folder);
+
+  thunar_g_list_free_full (save_and_load (folder));
+
+  /* the snapshots are removed in the background */
+  thunar_folder_snapshot_clear ();
+  while ((files = thunar_folder_snapshot_load (folder)) != NULL)
+    {
+      thunar_g_list_free_full (files);
+      g_main_context_iteration (NULL, TRUE);
+    }
+
+  g_object_unref (folder);
+  delete_folder (path);
+  g_free (path);
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  gchar *cache_dir;
+  int    result;
+
+  g_test_init (&argc, &argv, NULL);
+
+  /* the files read the preferences, use the defaults instead of xfconf */
+  thunar_preferences_xfconf_init_failed ();
+
+  /* keep the snapshots away from the user's cache */
+  cache_dir = g_dir_make_tmp ("thunar-test-cache-XXXXXX", NULL);
+  g_assert_nonnull (cache_dir);
+  g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+
+  g_test_add_func ("/folder-snapshot/round-trip", test_round_trip);
+  g_test_add_func ("/folder-snapshot/stale", test_stale);
+  g_test_add_func ("/folder-snapshot/clear", test_clear);
+
+  result = g_test_run ();
+
+  bench_remove_path (cache_dir);
+  g_free (cache_dir);
+
+  return result;
+}
@@ -0,0 +1,205 @@
+#include "bench.h"
+#include "thunar/thunar-grid-view.h"
+
+/* Benchmarks for the ThunarGridView layout, run them with 'meson test --benchmark'.
+ *
+ * The grid view shows a GtkListStore of synthetic names in an offscreen window, so a
+ * display is required (the tests are skipped otherwise). The number of rows can be
+ * adjusted with $THUNAR_BENCH_SCALE. The results are printed as one JSON object per
+ * benchmark (in a TAP comment), and appended to $THUNAR_BENCH_RESULTS if that is set. */
+
+/* number of rows at scale 1 */
+#define BENCH_N_ROWS (100000)
+
+/* number of operations per benchmark */
+#define BENCH_N_OPS (1000)
+
+
+
+typedef struct
+{
+  GtkListStore *store;
+  GtkWidget    *window;
+  GtkWidget    *grid_view;
+  guint         n_rows;
+} BenchFixture;
+
+
+
+static void
+bench_allocate (BenchFixture *fixture,
+                gint          width,
+                gint          height)
+{
+  GtkAllocation allocation = { 0, 0, width, height };
+
+  gtk_widget_size_allocate (fixture->grid_view, &allocation);
+}
+
+
+
+static gboolean
+bench_setup (BenchFixture *fixture,
+             gconstpointer user_data)
+{
+  GtkCellRenderer *renderer;
+  GtkWidget       *scrolled_window;
+  GtkTreeIter      iter;
+  gchar           *name;
+  guint            n;
+
+  if (gdk_display_get_default () == NULL)
+    {
+      g_test_skip ("no display available");
+      return FALSE;
+    }
+
+  fixture->n_rows = bench_scaled (BENCH_N_ROWS);
+
+  fixture->store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (n = 0; n < fixture->n_rows; ++n)
+    {
+      /* vary the name lengths, so the lines differ in size */
+      name = g_strdup_printf ("file-%0*u.txt", 1 + (gint) (n % 24), n);
+      gtk_list_store_insert_with_values (fixture->store, &iter, -1, 0, name, -1);
+      g_free (name);
+    }
+
+  fixture->grid_view = thunar_grid_view_new ();
+  renderer = gtk_cell_renderer_text_new ();
+  gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (fixture->grid_view), renderer, TRUE);
+  gtk_cell_layout_add_attribute (GTK_CELL_LAYOUT (fixture->grid_view), renderer, "text", 0);
+  thunar_grid_view_set_search_column (THUNAR_GRID_VIEW (fixture->grid_view), 0);
+  thunar_grid_view_set_model (THUNAR_GRID_VIEW (fixture->grid_view), GTK_TREE_MODEL (fixture->store));
+
+  scrolled_window = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (scrolled_window), fixture->grid_view);
+
+  fixture->window = gtk_offscreen_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (fixture->window), 800, 600);
+  gtk_container_add (GTK_CONTAINER (fixture->window), scrolled_window);
+  gtk_widget_show_all (fixture->window);
+
+  bench_allocate (fixture, 800, 600);
+
+  return TRUE;
+}
+
+
+
+static void
+bench_teardown (BenchFixture *fixture,
+                gconstpointer user_data)
+{
+  gtk_widget_destroy (fixture->window);
+  g_object_unref (fixture->store);
+}
+
+
+
+static void
+test_set_model (BenchFixture *fixture,
+                gconstpointer user_data)
+{
+  GTimer *timer;
+  guint   n;
+
+  /* attaching a model must not depend on measuring all rows */
+  timer = g_timer_new ();
+  for (n = 0; n < 10; ++n)
+    {
+      thunar_grid_view_set_model (THUNAR_GRID_VIEW (fixture->grid_view), NULL);
+      thunar_grid_view_set_model (THUNAR_GRID_VIEW (fixture->grid_view), GTK_TREE_MODEL (fixture->store));
+      bench_allocate (fixture, 800, 600);
+    }
+  bench_report ("set-model", fixture->n_rows, 10, g_timer_elapsed (timer, NULL), NULL);
+  g_timer_destroy (timer);
+}
+
+
+
+static void
+test_relayout (BenchFixture *fixture,
+               gconstpointer user_data)
+{
+  GTimer *timer;
+  guint   n;
+
+  /* resizing the window re-flows the grid */
+  timer = g_timer_new ();
+  for (n = 0; n < BENCH_N_OPS; ++n)
+    bench_allocate (fixture, 400 + (gint) (n % 800), 600);
+  bench_report ("relayout", fixture->n_rows, BENCH_N_OPS, g_timer_elapsed (timer, NULL), NULL);
+  g_timer_destroy (timer);
+}
+
+
+
+static void
+test_scroll_to_path (BenchFixture *fixture,
+                     gconstpointer user_data)
+{
+  GtkTreePath *path;
+  GTimer      *timer;
+  GRand       *rand;
+  guint        n;
+
+  /* jumping around measures the newly visible items only */
+  rand = g_rand_new_with_seed (42);
+  timer = g_timer_new ();
+  for (n = 0; n < BENCH_N_OPS; ++n)
+    {
+      path = gtk_tree_path_new_from_indices (g_rand_int_range (rand, 0, fixture->n_rows), -1);
+      thunar_grid_view_scroll_to_path (THUNAR_GRID_VIEW (fixture->grid_view), path, TRUE, 0.5f, 0.0f);
+      gtk_tree_path_free (path);
+
+      /* apply the layout if the cells grew */
+      bench_allocate (fixture, 800, 600);
+    }
+  bench_report ("scroll-to-path", fixture->n_rows, BENCH_N_OPS, g_timer_elapsed (timer, NULL), NULL);
+  g_timer_destroy (timer);
+  g_rand_free (rand);
+}
+
+
+
+static void
+test_select_all (BenchFixture *fixture,
+                 gconstpointer user_data)
+{
+  GList  *selected_items;
+  GTimer *timer;
+  guint   n;
+
+  timer = g_timer_new ();
+  for (n = 0; n < 10; ++n)
+    {
+      thunar_grid_view_select_all (THUNAR_GRID_VIEW (fixture->grid_view));
+      selected_items = thunar_grid_view_get_selected_items (THUNAR_GRID_VIEW (fixture->grid_view));
+      g_assert_cmpuint (g_list_length (selected_items), ==, fixture->n_rows);
+      g_list_free_full (selected_items, (GDestroyNotify) gtk_tree_path_free);
+      thunar_grid_view_unselect_all (THUNAR_GRID_VIEW (fixture->grid_view));
+    }
+  bench_report ("select-all", fixture->n_rows, 10, g_timer_elapsed (timer, NULL), NULL);
+  g_timer_destroy (timer);
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  /* the benchmarks are skipped without a display, see bench_setup() */
+  gtk_init_check (&argc, &argv);
+
+  bench_init ();
+
+  bench_add ("/grid-view-perf/set-model", BenchFixture, NULL, bench_setup, test_set_model, bench_teardown);
+  bench_add ("/grid-view-perf/relayout", BenchFixture, NULL, bench_setup, test_relayout, bench_teardown);
+  bench_add ("/grid-view-perf/scroll-to-path", BenchFixture, NULL, bench_setup, test_scroll_to_path, bench_teardown);
+  bench_add ("/grid-view-perf/select-all", BenchFixture, NULL, bench_setup, test_select_all, bench_teardown);
+
+  return g_test_run ();
+}
@@ -0,0 +1,342 @@
+#include "thunar/thunar-grid-view.h"
+
+/* Tests for the ThunarGridView selection, hit testing, layout and accessibility.
+ *
+ * The grid view shows a GtkListStore of a few names in an offscreen window, so a
+ * display is required (the tests are skipped otherwise). */
+
+/* number of rows in the store */
+#define TEST_N_ROWS (100)
+
+
+
+typedef struct
+{
+  GtkListStore *store;
+  GtkWidget    *window;
+  GtkWidget    *grid_view;
+} GridViewFixture;
+
+
+
+typedef struct
+{
+  gboolean has_delta;
+  guint    n_selected;
+  guint    n_unselected;
+  gint     first_selected;
+} DeltaRecord;
+
+
+
+static gboolean
+grid_view_skip (void)
+{
+  if (gdk_display_get_default () != NULL)
+    return FALSE;
+
+  g_test_skip ("no display available");
+  return TRUE;
+}
+
+
+
+static void
+grid_view_allocate (GridViewFixture *fixture,
+                    gint             width,
+                    gint             height)
+{
+  GtkAllocation allocation = { 0, 0, width, height };
+
+  gtk_widget_size_allocate (fixture->grid_view, &allocation);
+}
+
+
+
+static void
+grid_view_setup (GridViewFixture *fixture,
+                 gconstpointer    user_data)
+{
+  GtkCellRenderer *renderer;
+  GtkWidget       *scrolled_window;
+  GtkTreeIter      iter;
+  gchar           *name;
+  guint            n;
+
+  /* nothing to set up for skipped tests, see grid_view_skip() */
+  if (gdk_display_get_default () == NULL)
+    return;
+
+  fixture->store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (n = 0; n < TEST_N_ROWS; ++n)
+    {
+      name = g_strdup_printf ("file-%03u.txt", n);
+      gtk_list_store_insert_with_values (fixture->store, &iter, -1, 0, name, -1);
+      g_free (name);
+    }
+
+  fixture->grid_view = thunar_grid_view_new ();
+  renderer = gtk_cell_renderer_text_new ();
+  gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (fixture->grid_view), renderer, TRUE);
+  gtk_cell_layout_add_attribute (GTK_CELL_LAYOUT (fixture->grid_view), renderer, "text", 0);
+  thunar_grid_view_set_search_column (THUNAR_GRID_VIEW (fixture->grid_view), 0);
+  thunar_grid_view_set_model (THUNAR_GRID_VIEW (fixture->grid_view), GTK_TREE_MODEL (fixture->store));
+
+  scrolled_window = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (scrolled_window), fixture->grid_view);
+
+  fixture->window = gtk_offscreen_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (fixture->window), 800, 600);
+  gtk_container_add (GTK_CONTAINER (fixture->window), scrolled_window);
+  gtk_widget_show_all (fixture->window);
+
+  grid_view_allocate (fixture, 800, 600);
+}
+
+
+
+static void
+grid_view_teardown (GridViewFixture *fixture,
+                    gconstpointer    user_data)
+{
+  if (fixture->window == NULL)
+    return;
+
+  gtk_widget_destroy (fixture->window);
+  g_object_unref (fixture->store);
+}
+
+
+
+static void
+test_selection_follows_rows (GridViewFixture *fixture,
+                             gconstpointer    user_data)
+{
+  GdkRectangle area;
+  GtkTreePath *path;
+  GtkTreePath *hit;
+  GtkTreeIter  iter;
+  GList       *selected_items;
+
+  if (grid_view_skip ())
+    return;
+
+  /* select the third row and insert one before it */
+  path = gtk_tree_path_new_from_indices (2, -1);
+  thunar_grid_view_select_path (THUNAR_GRID_VIEW (fixture->grid_view), path);
+  gtk_tree_path_free (path);
+  gtk_list_store_insert_with_values (fixture->store, &iter, 0, 0, "inserted", -1);
+
+  selected_items = thunar_grid_view_get_selected_items (THUNAR_GRID_VIEW (fixture->grid_view));
+  g_assert_cmpuint (g_list_length (selected_items), ==, 1);
+  g_assert_cmpint (gtk_tree_path_get_indices (selected_items->data)[0], ==, 3);
+  g_list_free_full (selected_items, (GDestroyNotify) gtk_tree_path_free);
+
+  /* removing the selected row leaves nothing selected */
+  g_assert_true (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (fixture->store), &iter, NULL, 3));
+  gtk_list_store_remove (fixture->store, &iter);
+  g_assert_null (thunar_grid_view_get_selected_items (THUNAR_GRID_VIEW (fixture->grid_view)));
+
+  /* every item is hit at its own area */
+  grid_view_allocate (fixture, 800, 600);
+  path = gtk_tree_path_new_from_indices (4, -1);
+  g_assert_true (thunar_grid_view_get_item_area (THUNAR_GRID_VIEW (fixture->grid_view), path, &area));
+  hit = thunar_grid_view_get_path_at_pos (THUNAR_GRID_VIEW (fixture->grid_view), area.x + area.width / 2, area.y + area.height / 2);
+  g_assert_nonnull (hit);
+  g_assert_cmpint (gtk_tree_path_compare (hit, path), ==, 0);
+  gtk_tree_path_free (hit);
+  gtk_tree_path_free (path);
+}
+
+
+
+static void
+record_selection_delta (ThunarGridView *grid_view,
+                        DeltaRecord    *record)
+{
+  GList *selected_paths;
+  GList *unselected_paths;
+
+  record->has_delta = thunar_grid_view_get_selection_delta (grid_view, &selected_paths, &unselected_paths);
+  record->n_selected = g_list_length (selected_paths);
+  record->n_unselected = g_list_length (unselected_paths);
+  record->first_selected = selected_paths != NULL ? gtk_tree_path_get_indices (selected_paths->data)[0] : -1;
+  g_list_free_full (selected_paths, (GDestroyNotify) gtk_tree_path_free);
+  g_list_free_full (unselected_paths, (GDestroyNotify) gtk_tree_path_free);
+}
+
+
+
+static void
+test_selection_delta (GridViewFixture *fixture,
+                      gconstpointer    user_data)
+{
+  ThunarGridView *grid_view;
+  DeltaRecord     record = { FALSE, 0, 0, -1 };
+  GtkTreePath    *path;
+  GtkTreeIter     iter;
+
+  if (grid_view_skip ())
+    return;
+
+  grid_view = THUNAR_GRID_VIEW (fixture->grid_view);
+  g_signal_connect (grid_view, "selection-changed", G_CALLBACK (record_selection_delta), &record);
+
+  path = gtk_tree_path_new_from_indices (5, -1);
+  thunar_grid_view_select_path (grid_view, path);
+  gtk_tree_path_free (path);
+  g_assert_true (record.has_delta);
+  g_assert_cmpuint (record.n_selected, ==, 1);
+  g_assert_cmpuint (record.n_unselected, ==, 0);
+  g_assert_cmpint (record.first_selected, ==, 5);
+
+  /* only the items which were not selected yet are reported */
+  thunar_grid_view_select_all (grid_view);
+  g_assert_true (record.has_delta);
+  g_assert_cmpuint (record.n_selected, ==, TEST_N_ROWS - 1);
+  g_assert_cmpuint (record.n_unselected, ==, 0);
+  g_assert_cmpint (record.first_selected, ==, 0);
+
+  thunar_grid_view_unselect_all (grid_view);
+  g_assert_true (record.has_delta);
+  g_assert_cmpuint (record.n_selected, ==, 0);
+  g_assert_cmpuint (record.n_unselected, ==, TEST_N_ROWS);
+
+  /* a deleted row cannot be reported by its path */
+  path = gtk_tree_path_new_from_indices (3, -1);
+  thunar_grid_view_select_path (grid_view, path);
+  gtk_tree_path_free (path);
+  g_assert_true (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (fixture->store), &iter, NULL, 3));
+  gtk_list_store_remove (fixture->store, &iter);
+  g_assert_false (record.has_delta);
+
+  g_signal_handlers_disconnect_by_func (grid_view, record_selection_delta, &record);
+}
+
+
+
+static void
+test_line_sizes (GridViewFixture *fixture,
+                 gconstpointer    user_data)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (fixture->grid_view);
+  GdkRectangle    area;
+  GdkRectangle    first_area;
+  GdkRectangle    last_area;
+  GtkTreePath    *path;
+  GtkTreeIter     iter;
+  gint            x;
+
+  if (grid_view_skip ())
+    return;
+
+  /* lay out the items in columns, like the compact view, and make the first name longer */
+  thunar_grid_view_set_layout_mode (grid_view, THUNAR_GRID_VIEW_LAYOUT_COLS);
+  g_assert_true (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (fixture->store), &iter, NULL, 0));
+  gtk_list_store_set (fixture->store, &iter, 0, "file-000-with-a-much-longer-name.txt", -1);
+  grid_view_allocate (fixture, 200, 100);
+
+  /* only the column of the long name is wider */
+  path = gtk_tree_path_new_from_indices (0, -1);
+  g_assert_true (thunar_grid_view_get_item_area (grid_view, path, &first_area));
+  gtk_tree_path_free (path);
+  path = gtk_tree_path_new_from_indices (1, -1);
+  g_assert_true (thunar_grid_view_get_item_area (grid_view, path, &area));
+  gtk_tree_path_free (path);
+  g_assert_cmpint (area.x, ==, first_area.x);
+  g_assert_cmpint (area.width, ==, first_area.width);
+
+  path = gtk_tree_path_new_from_indices (TEST_N_ROWS - 1, -1);
+  thunar_grid_view_scroll_to_path (grid_view, path, FALSE, 0.0f, 0.0f);
+  grid_view_allocate (fixture, 200, 100);
+  grid_view_allocate (fixture, 200, 100);
+  g_assert_true (thunar_grid_view_get_item_area (grid_view, path, &last_area));
+  gtk_tree_path_free (path);
+  g_assert_cmpint (last_area.width, <, first_area.width);
+
+  /* the first visible item keeps its place when its column grows */
+  path = gtk_tree_path_new_from_indices (TEST_N_ROWS / 2, -1);
+  thunar_grid_view_scroll_to_path (grid_view, path, TRUE, 0.0f, 0.0f);
+  grid_view_allocate (fixture, 200, 100);
+  grid_view_allocate (fixture, 200, 100);
+  g_assert_true (thunar_grid_view_get_item_area (grid_view, path, &area));
+  x = area.x;
+
+  g_assert_true (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (fixture->store), &iter, NULL, TEST_N_ROWS / 2));
+  gtk_list_store_set (fixture->store, &iter, 0, "file-050-with-an-even-much-longer-name.txt", -1);
+  grid_view_allocate (fixture, 200, 100);
+  g_assert_true (thunar_grid_view_get_item_area (grid_view, path, &area));
+  g_assert_cmpint (area.x, ==, x);
+  g_assert_cmpint (area.width, >, last_area.width);
+  gtk_tree_path_free (path);
+}
+
+
+
+static void
+test_accessible (GridViewFixture *fixture,
+                 gconstpointer    user_data)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (fixture->grid_view);
+  AtkStateSet    *state_set;
+  AtkObject      *accessible;
+  AtkObject      *child;
+  AtkObject      *moved;
+  GtkTreePath    *path;
+  GtkTreeIter     iter;
+
+  if (grid_view_skip ())
+    return;
+
+  accessible = gtk_widget_get_accessible (fixture->grid_view);
+  g_assert_cmpint (atk_object_get_n_accessible_children (accessible), ==, TEST_N_ROWS);
+
+  /* the items are named after the search column */
+  child = atk_object_ref_accessible_child (accessible, 5);
+  g_assert_cmpstr (atk_object_get_name (child), ==, "file-005.txt");
+  g_assert_cmpint (atk_object_get_index_in_parent (child), ==, 5);
+
+  /* the selection is shared with the view */
+  g_assert_true (atk_selection_add_selection (ATK_SELECTION (accessible), 5));
+  path = gtk_tree_path_new_from_indices (5, -1);
+  g_assert_true (thunar_grid_view_path_is_selected (grid_view, path));
+  gtk_tree_path_free (path);
+  state_set = atk_object_ref_state_set (child);
+  g_assert_true (atk_state_set_contains_state (state_set, ATK_STATE_SELECTED));
+  g_object_unref (state_set);
+  g_assert_cmpint (atk_selection_get_selection_count (ATK_SELECTION (accessible)), ==, 1);
+
+  /* an insertion moves the item along, a removal makes it defunct */
+  gtk_list_store_insert_with_values (fixture->store, &iter, 0, 0, "inserted", -1);
+  g_assert_cmpint (atk_object_get_index_in_parent (child), ==, 6);
+  moved = atk_object_ref_accessible_child (accessible, 6);
+  g_assert_true (moved == child);
+  g_object_unref (moved);
+
+  g_assert_true (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (fixture->store), &iter, NULL, 6));
+  gtk_list_store_remove (fixture->store, &iter);
+  state_set = atk_object_ref_state_set (child);
+  g_assert_true (atk_state_set_contains_state (state_set, ATK_STATE_DEFUNCT));
+  g_object_unref (state_set);
+  g_assert_cmpint (atk_selection_get_selection_count (ATK_SELECTION (accessible)), ==, 0);
+
+  g_object_unref (child);
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  /* the tests skip themselves without a display */
+  gtk_init_check (&argc, &argv);
+
+  g_test_add ("/grid-view/selection-follows-rows", GridViewFixture, NULL, grid_view_setup, test_selection_follows_rows, grid_view_teardown);
+  g_test_add ("/grid-view/selection-delta", GridViewFixture, NULL, grid_view_setup, test_selection_delta, grid_view_teardown);
+  g_test_add ("/grid-view/line-sizes", GridViewFixture, NULL, grid_view_setup, test_line_sizes, grid_view_teardown);
+  g_test_add ("/grid-view/accessible", GridViewFixture, NULL, grid_view_setup, test_accessible, grid_view_teardown);
+
+  return g_test_run ();
+}
@@ -0,0 +1,804 @@
+#include "bench.h"
+#include "thunar/thunar-deep-count-job.h"
+#include "thunar/thunar-file.h"
+#include "thunar/thunar-gio-extensions.h"
+#include "thunar/thunar-io-jobs.h"
+#include "thunar/thunar-job.h"
+#include "thunar/thunar-preferences.h"
+#include "thunar/thunar-tree-view-model.h"
+
+#include <fcntl.h>
+#include <glib/gstdio.h>
+#include <sys/resource.h> // for getrusage()
+#include <unistd.h>       // for ftruncate()
+
+/* Benchmarks for the I/O jobs on synthetic trees, run them with 'meson test --benchmark'.
+ *
+ * The trees are created below a temporary directory (or $THUNAR_BENCH_DIR), their size can
+ * be adjusted with $THUNAR_BENCH_SCALE (e.g. 0.01 for a quick run). Every benchmark runs in
+ * its own process, so the reported peak RSS belongs to it alone. The results are printed as
+ * one JSON object per benchmark (in a TAP comment), and appended to $THUNAR_BENCH_RESULTS
+ * if that is set. */
+
+/* sizes of the synthetic trees at scale 1 */
+#define BENCH_FLAT_FILES   (1000000)
+#define BENCH_DEEP_LEVELS  (512)
+#define BENCH_DEEP_FILES   (8) /* per level */
+#define BENCH_SMALL_DIRS   (100)
+#define BENCH_SMALL_FILES  (500) /* per directory */
+#define BENCH_SMALL_SIZE   (4096)
+#define BENCH_SPARSE_FILES (4)
+#define BENCH_SPARSE_SIZE  (G_GINT64_CONSTANT (256) << 20)
+
+
+
+typedef struct
+{
+  gchar  *path;
+  guint   n_files;
+  guint64 n_bytes;
+} BenchTree;
+
+typedef struct
+{
+  GMainLoop *loop;
+  guint      n_running;
+  GError    *error;
+  gchar     *question;
+  guint      n_files;
+  guint64    n_bytes;
+} BenchJob;
+
+
+
+static gchar *bench_root = NULL;
+
+
+
+static void
+bench_create_file (const gchar *path,
+                   goffset      size,
+                   gboolean     sparse)
+{
+  static const gchar buffer[BENCH_SMALL_SIZE];
+  goffset            written;
+  gint               fd;
+
+  fd = g_open (path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+  g_assert_cmpint (fd, >=, 0);
+
+  if (sparse)
+    g_assert_cmpint (ftruncate (fd, size), ==, 0);
+  else
+    for (written = 0; written < size; written += sizeof (buffer))
+      g_assert_cmpint (write (fd, buffer, MIN ((goffset) sizeof (buffer), size - written)), >, 0);
+
+  g_close (fd, NULL);
+}
+
+
+
+static void
+bench_tree_new (BenchTree   *tree,
+                const gchar *name)
+{
+  tree->path = g_build_filename (bench_root, name, NULL);
+  tree->n_files = 0;
+  tree->n_bytes = 0;
+
+  g_assert_cmpint (g_mkdir (tree->path, 0755), ==, 0);
+}
+
+
+
+static void
+bench_tree_add_file (BenchTree   *tree,
+                     const gchar *path,
+                     goffset      size,
+                     gboolean     sparse)
+{
+  bench_create_file (path, size, sparse);
+  tree->n_files += 1;
+  tree->n_bytes += size;
+}
+
+
+
+/* one directory with a million empty files */
+static void
+bench_tree_new_flat (BenchTree *tree)
+{
+  gchar *path;
+
+  bench_tree_new (tree, "flat");
+  for (guint i = 0; i < bench_scaled (BENCH_FLAT_FILES); ++i)
+    {
+      path = g_strdup_printf ("%s/file-%07u", tree->path, i);
+      bench_tree_add_file (tree, path, 0, FALSE);
+      g_free (path);
+    }
+}
+
+
+
+/* a chain of nested directories with a few empty files on every level */
+static void
+bench_tree_new_deep (BenchTree *tree)
+{
+  GString *dir;
+  gchar   *path;
+
+  bench_tree_new (tree, "deep");
+  dir = g_string_new (tree->path);
+  for (guint i = 0; i < bench_scaled (BENCH_DEEP_LEVELS); ++i)
+    {
+      g_string_append (dir, "/d");
+      g_assert_cmpint (g_mkdir (dir->str, 0755), ==, 0);
+
+      for (guint j = 0; j < BENCH_DEEP_FILES; ++j)
+        {
+          path = g_strdup_printf ("%s/file-%u", dir->str, j);
+          bench_tree_add_file (tree, path, 0, FALSE);
+          g_free (path);
+        }
+    }
+  g_string_free (dir, TRUE);
+}
+
+
+
+/* a hundred directories with many small files each */
+static void
+bench_tree_new_small (BenchTree   *tree,
+                      const gchar *name)
+{
+  gchar *dir;
+  gchar *path;
+
+  bench_tree_new (tree, name);
+  for (guint i = 0; i < BENCH_SMALL_DIRS; ++i)
+    {
+      dir = g_strdup_printf ("%s/dir-%03u", tree->path, i);
+      g_assert_cmpint (g_mkdir (dir, 0755), ==, 0);
+
+      for (guint j = 0; j < bench_scaled (BENCH_SMALL_FILES); ++j)
+        {
+          path = g_strdup_printf ("%s/file-%04u", dir, j);
+          bench_tree_add_file (tree, path, BENCH_SMALL_SIZE, FALSE);
+          g_free (path);
+        }
+      g_free (dir);
+    }
+}
+
+
+
+/* a few huge sparse files */
+static void
+bench_tree_new_sparse (BenchTree *tree)
+{
+  gchar *path;
+
+  bench_tree_new (tree, "sparse");
+  for (guint i = 0; i < BENCH_SPARSE_FILES; ++i)
+    {
+      path = g_strdup_printf ("%s/file-%u", tree->path, i);
+      bench_tree_add_file (tree, path, bench_scaled (BENCH_SPARSE_SIZE >> 20) * G_GINT64_CONSTANT (1048576), TRUE);
+      g_free (path);
+    }
+}
+
+
+
+static void
+bench_tree_free (BenchTree *tree)
+{
+  bench_remove_path (tree->path);
+  g_free (tree->path);
+}
+
+
+
+static void
+bench_job_finished (ThunarJob *job,
+                    BenchJob  *bench)
+{
+  if (--bench->n_running == 0)
+    g_main_loop_quit (bench->loop);
+}
+
+
+
+static void
+bench_job_error (ThunarJob *job,
+                 GError    *error,
+                 BenchJob  *bench)
+{
+  if (bench->error == NULL)
+    bench->error = g_error_copy (error);
+}
+
+
+
+static ThunarJobResponse
+bench_job_ask (ThunarJob        *job,
+               const gchar      *message,
+               ThunarJobResponse choices,
+               BenchJob         *bench)
+{
+  /* nothing should ask on fresh trees, except when trashing is not supported */
+  if (bench->question == NULL)
+    bench->question = g_strdup (message);
+  return THUNAR_JOB_RESPONSE_CANCEL;
+}
+
+
+
+static gboolean
+bench_job_files_ready (ThunarJob *job,
+                       GList     *files,
+                       BenchJob  *bench)
+{
+  bench->n_files += g_list_length (files);
+  return FALSE;
+}
+
+
+
+static void
+bench_job_status_update (ThunarJob *job,
+                         guint64    total_size,
+                         guint64    total_size_on_disk,
+                         guint      file_count,
+                         guint      directory_count,
+                         guint      unreadable_directory_count,
+                         BenchJob  *bench)
+{
+  bench->n_files = file_count;
+  bench->n_bytes = total_size;
+}
+
+
+
+static void
+bench_connect_job (ThunarJob *job,
+                   BenchJob  *bench)
+{
+  g_signal_connect (job, "finished", G_CALLBACK (bench_job_finished), bench);
+  g_signal_connect (job, "error", G_CALLBACK (bench_job_error), bench);
+  g_signal_connect (job, "ask", G_CALLBACK (bench_job_ask), bench);
+  g_signal_connect (job, "files-ready", G_CALLBACK (bench_job_files_ready), bench);
+  if (THUNAR_IS_DEEP_COUNT_JOB (job))
+    g_signal_connect (job, "status-update", G_CALLBACK (bench_job_status_update), bench);
+
+  bench->n_running++;
+}
+
+
+
+/* runs the job to completion in the main loop and returns the elapsed time */
+static gdouble
+bench_run_job (ThunarJob *job,
+               BenchJob  *bench)
+{
+  gdouble elapsed;
+
+  bench_connect_job (job, bench);
+  bench->loop = g_main_loop_new (NULL, FALSE);
+
+  g_test_timer_start ();
+  thunar_job_launch (job);
+  g_main_loop_run (bench->loop);
+  elapsed = g_test_timer_elapsed ();
+
+  g_main_loop_unref (bench->loop);
+  g_object_unref (job);
+
+  return elapsed;
+}
+
+
+
+static void
+bench_job_assert_ok (BenchJob *bench)
+{
+  g_assert_no_error (bench->error);
+  g_assert_null (bench->question);
+}
+
+
+
+static gchar *
+bench_result_path (void)
+{
+  return g_build_filename (bench_root, "result.json", NULL);
+}
+
+
+
+/* stores the result of the benchmark process for the parent, @extra
+ * are additional members of the JSON object or %NULL */
+static void
+bench_store_full (const gchar *name,
+                  gdouble      elapsed,
+                  guint        n_files,
+                  guint64      n_bytes,
+                  const gchar *extra)
+{
+  struct rusage usage;
+  gchar        *line;
+  gchar        *path;
+
+  g_assert_cmpint (getrusage (RUSAGE_SELF, &usage), ==, 0);
+
+  line = g_strdup_printf ("{\"benchmark\":\"%s\",\"scale\":%g,\"seconds\":%.6f,\"files\":%u,\"bytes\":%" G_GUINT64_FORMAT ","
+                          "\"files_per_second\":%.1f,\"mb_per_second\":%.2f,\"peak_rss_kb\":%ld%s%s}",
+                          name, bench_scale, elapsed, n_files, n_bytes,
+                          n_files / elapsed, n_bytes / 1048576.0 / elapsed, usage.ru_maxrss,
+                          extra != NULL ? "," : "", extra != NULL ? extra : "");
+
+  path = bench_result_path ();
+  g_assert_true (g_file_set_contents (path, line, -1, NULL));
+  g_free (path);
+  g_free (line);
+}
+
+
+
+static void
+bench_store (const gchar *name,
+             gdouble      elapsed,
+             guint        n_files,
+             guint64      n_bytes)
+{
+  bench_store_full (name, elapsed, n_files, n_bytes, NULL);
+}
+
+
+
+/* returns TRUE if the calling benchmark should run in this process */
+static gboolean
+bench_enter (void)
+{
+  gchar *line;
+  gchar *path;
+
+  if (g_test_subprocess ())
+    return TRUE;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("only run in perf mode");
+      return FALSE;
+    }
+
+  g_test_trap_subprocess (NULL, 0, G_TEST_SUBPROCESS_INHERIT_STDERR);
+  g_test_trap_assert_passed ();
+
+  /* publish the result, if the benchmark was not skipped */
+  path = bench_result_path ();
+  if (g_file_get_contents (path, &line, NULL, NULL))
+    {
+      bench_publish (line);
+      g_remove (path);
+      g_free (line);
+    }
+  g_free (path);
+
+  return FALSE;
+}
+
+
+
+static GList *
+bench_file_list_new (const gchar *path)
+{
+  return g_list_prepend (NULL, g_file_new_for_path (path));
+}
+
+
+
+static void
+test_list_flat (void)
+{
+  BenchTree tree;
+  BenchJob  bench = { 0 };
+  GFile    *directory;
+  gdouble   elapsed;
+
+  if (!bench_enter ())
+    return;
+
+  bench_tree_new_flat (&tree);
+
+  directory = g_file_new_for_path (tree.path);
+  elapsed = bench_run_job (thunar_io_jobs_list_directory (directory), &bench);
+  g_object_unref (directory);
+
+  bench_job_assert_ok (&bench);
+  g_assert_cmpuint (bench.n_files, ==, tree.n_files);
+  bench_store ("list-flat", elapsed, bench.n_files, 0);
+
+  bench_tree_free (&tree);
+}
+
+
+
+/* lists all folders of the small tree at once, like many open tabs */
+static void
+test_list_concurrent (void)
+{
+  BenchTree  tree;
+  BenchJob   bench = { 0 };
+  ThunarJob *jobs[BENCH_SMALL_DIRS];
+  GFile     *directory;
+  gdouble    elapsed;
+  guint64    n_locks[2];
+  guint64    n_contended[2];
+  gchar     *extra;
+  gchar     *path;
+
+  if (!bench_enter ())
+    return;
+
+  bench_tree_new_small (&tree, "small");
+
+  for (guint i = 0; i < BENCH_SMALL_DIRS; ++i)
+    {
+      path = g_strdup_printf ("%s/dir-%03u", tree.path, i);
+      directory = g_file_new_for_path (path);
+      jobs[i] = thunar_io_jobs_list_directory (directory);
+      bench_connect_job (jobs[i], &bench);
+      g_object_unref (directory);
+      g_free (path);
+    }
+
+  bench.loop = g_main_loop_new (NULL, FALSE);
+  thunar_file_cache_get_stats (NULL, &n_locks[0], &n_contended[0]);
+
+  g_test_timer_start ();
+  for (guint i = 0; i < BENCH_SMALL_DIRS; ++i)
+    thunar_job_launch (jobs[i]);
+  g_main_loop_run (bench.loop);
+  elapsed = g_test_timer_elapsed ();
+
+  thunar_file_cache_get_stats (NULL, &n_locks[1], &n_contended[1]);
+  g_main_loop_unref (bench.loop);
+  for (guint i = 0; i < BENCH_SMALL_DIRS; ++i)
+    g_object_unref (jobs[i]);
+
+  bench_job_assert_ok (&bench);
+  g_assert_cmpuint (bench.n_files, ==, tree.n_files);
+
+  /* the lock contention of the global file cache */
+  extra = g_strdup_printf ("\"cache_locks\":%" G_GUINT64_FORMAT ",\"cache_contended\":%" G_GUINT64_FORMAT,
+                           n_locks[1] - n_locks[0], n_contended[1] - n_contended[0]);
+  bench_store_full ("list-concurrent", elapsed, bench.n_files, 0, extra);
+  g_free (extra);
+
+  bench_tree_free (&tree);
+}
+
+
+
+static void
+bench_deep_count (BenchTree   *tree,
+                  const gchar *name)
+{
+  ThunarFile *file;
+  BenchJob    bench = { 0 };
+  GFile      *gfile;
+  GList       files = { NULL, NULL, NULL };
+  gdouble     elapsed;
+
+  gfile = g_file_new_for_path (tree->path);
+  file = thunar_file_get (gfile, NULL);
+  g_assert_nonnull (file);
+  files.data = file;
+
+  elapsed = bench_run_job (THUNAR_JOB (thunar_deep_count_job_new (&files, G_FILE_QUERY_INFO_NONE)), &bench);
+
+  bench_job_assert_ok (&bench);
+  g_assert_cmpuint (bench.n_files, ==, tree->n_files);
+  bench_store (name, elapsed, bench.n_files, bench.n_bytes);
+
+  g_object_unref (file);
+  g_object_unref (gfile);
+}
+
+
+
+static void
+test_deep_count_small (void)
+{
+  BenchTree tree;
+
+  if (!bench_enter ())
+    return;
+
+  bench_tree_new_small (&tree, "small");
+  bench_deep_count (&tree, "deep-count-small");
+  bench_tree_free (&tree);
+}
+
+
+
+static void
+test_deep_count_deep (void)
+{
+  BenchTree tree;
+
+  if (!bench_enter ())
+    return;
+
+  bench_tree_new_deep (&tree);
+  bench_deep_count (&tree, "deep-count-deep");
+  bench_tree_free (&tree);
+}
+
+
+
+static void
+test_search_small (void)
+{
+  ThunarTreeViewModel *model;
+  ThunarFile          *file;
+  BenchTree            tree;
+  BenchJob             bench = { 0 };
+  GFile               *gfile;
+  gdouble              elapsed;
+
+  if (!bench_enter ())
+    return;
+
+  bench_tree_new_small (&tree, "small");
+
+  gfile = g_file_new_for_path (tree.path);
+  file = thunar_file_get (gfile, NULL);
+  g_assert_nonnull (file);
+  model = thunar_tree_view_model_new ();
+
+  /* every file is visited, but only a few of them match */
+  elapsed = bench_run_job (thunar_io_jobs_search_directory (model, "file-0042", file), &bench);
+
+  bench_job_assert_ok (&bench);
+  bench_store ("search-small", elapsed, tree.n_files, 0);
+
+  g_object_unref (model);
+  g_object_unref (file);
+  g_object_unref (gfile);
+  bench_tree_free (&tree);
+}
+
+
+
+static void
+bench_transfer (BenchTree   *tree,
+                const gchar *name,
+                gboolean     move)
+{
+  BenchJob bench = { 0 };
+  GList   *source_list;
+  GList   *target_list;
+  gchar   *target;
+  gdouble  elapsed;
+
+  target = g_strconcat (tree->path, "-target", NULL);
+  source_list = bench_file_list_new (tree->path);
+  target_list = bench_file_list_new (target);
+
+  if (move)
+    elapsed = bench_run_job (thunar_io_jobs_move_files (source_list, target_list), &bench);
+  else
+    elapsed = bench_run_job (thunar_io_jobs_copy_files (source_list, target_list), &bench);
+
+  bench_job_assert_ok (&bench);
+  g_assert_true (g_file_test (target, G_FILE_TEST_IS_DIR));
+  g_assert_true (g_file_test (tree->path, G_FILE_TEST_EXISTS) != move);
+  bench_store (name, elapsed, tree->n_files, tree->n_bytes);
+
+  bench_remove_path (target);
+  thunar_g_list_free_full (source_list);
+  thunar_g_list_free_full (target_list);
+  g_free (target);
+}
+
+
+
+static void
+test_copy_small (void)
+{
+  BenchTree tree;
+
+  if (!bench_enter ())
+    return;
+
+  bench_tree_new_small (&tree, "small");
+  bench_transfer (&tree, "copy-small", FALSE);
+  bench_tree_free (&tree);
+}
+
+
+
+static void
+test_copy_sparse (void)
+{
+  BenchTree tree;
+
+  if (!bench_enter ())
+    return;
+
+  bench_tree_new_sparse (&tree);
+  bench_transfer (&tree, "copy-sparse", FALSE);
+  bench_tree_free (&tree);
+}
+
+
+
+static void
+test_move_small (void)
+{
+  BenchTree tree;
+
+  if (!bench_enter ())
+    return;
+
+  bench_tree_new_small (&tree, "small");
+  bench_transfer (&tree, "move-small", TRUE);
+  bench_tree_free (&tree);
+}
+
+
+
+static void
+test_unlink_small (void)
+{
+  BenchTree tree;
+  BenchJob  bench = { 0 };
+  GList    *file_list;
+  gdouble   elapsed;
+
+  if (!bench_enter ())
+    return;
+
+  bench_tree_new_small (&tree, "small");
+
+  file_list = bench_file_list_new (tree.path);
+  elapsed = bench_run_job (thunar_io_jobs_unlink_files (file_list), &bench);
+  thunar_g_list_free_full (file_list);
+
+  bench_job_assert_ok (&bench);
+  g_assert_false (g_file_test (tree.path, G_FILE_TEST_EXISTS));
+  bench_store ("unlink-small", elapsed, tree.n_files, tree.n_bytes);
+
+  bench_tree_free (&tree);
+}
+
+
+
+static void
+test_trash_small (void)
+{
+  BenchTree tree;
+  BenchJob  bench = { 0 };
+  GList    *file_list;
+  gdouble   elapsed;
+
+  if (!bench_enter ())
+    return;
+
+  bench_tree_new_small (&tree, "small");
+
+  /* $HOME points into the benchmark directory, so this never touches the user's trash */
+  file_list = bench_file_list_new (tree.path);
+  elapsed = bench_run_job (thunar_io_jobs_trash_files (file_list), &bench);
+  thunar_g_list_free_full (file_list);
+
+  if (bench.question != NULL)
+    {
+      g_test_skip ("trash is not supported in the benchmark directory");
+      g_free (bench.question);
+      bench.question = NULL;
+    }
+  else
+    {
+      bench_job_assert_ok (&bench);
+      g_assert_false (g_file_test (tree.path, G_FILE_TEST_EXISTS));
+      bench_store ("trash-small", elapsed, tree.n_files, tree.n_bytes);
+    }
+
+  bench_tree_free (&tree);
+}
+
+
+
+static void
+test_chmod_small (void)
+{
+  BenchTree tree;
+  BenchJob  bench = { 0 };
+  GList    *file_list;
+  gdouble   elapsed;
+
+  if (!bench_enter ())
+    return;
+
+  bench_tree_new_small (&tree, "small");
+
+  file_list = bench_file_list_new (tree.path);
+  elapsed = bench_run_job (thunar_io_jobs_change_mode (file_list,
+                                                       THUNAR_FILE_MODE_GRP_WRITE, THUNAR_FILE_MODE_GRP_WRITE,
+                                                       THUNAR_FILE_MODE_GRP_WRITE, THUNAR_FILE_MODE_GRP_WRITE,
+                                                       TRUE),
+                           &bench);
+  thunar_g_list_free_full (file_list);
+
+  bench_job_assert_ok (&bench);
+  bench_store ("chmod-small", elapsed, tree.n_files, 0);
+
+  bench_tree_free (&tree);
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  gchar *home;
+  int    result;
+
+  g_test_init (&argc, &argv, NULL);
+
+  /* the jobs read the preferences, use the defaults instead of xfconf */
+  thunar_preferences_xfconf_init_failed ();
+
+  bench_init ();
+
+  /* the benchmark processes share the root directory of the parent */
+  if (g_test_subprocess ())
+    {
+      bench_root = g_strdup (g_getenv ("THUNAR_BENCH_ROOT"));
+      g_assert_nonnull (bench_root);
+    }
+  else
+    {
+      if (g_getenv ("THUNAR_BENCH_DIR") != NULL)
+        {
+          bench_root = g_build_filename (g_getenv ("THUNAR_BENCH_DIR"), "thunar-bench-XXXXXX", NULL);
+          g_assert_nonnull (g_mkdtemp (bench_root));
+        }
+      else
+        {
+          bench_root = g_dir_make_tmp ("thunar-bench-XXXXXX", NULL);
+          g_assert_nonnull (bench_root);
+        }
+      g_setenv ("THUNAR_BENCH_ROOT", bench_root, TRUE);
+
+      /* keep the trash on the same file system, and away from the user's home */
+      home = g_build_filename (bench_root, "home", NULL);
+      g_assert_cmpint (g_mkdir (home, 0700), ==, 0);
+      g_setenv ("HOME", home, TRUE);
+      g_setenv ("XDG_DATA_HOME", home, TRUE);
+      g_free (home);
+    }
+
+  g_test_add_func ("/io-jobs-perf/list-flat", test_list_flat);
+  g_test_add_func ("/io-jobs-perf/list-concurrent", test_list_concurrent);
+  g_test_add_func ("/io-jobs-perf/deep-count-small", test_deep_count_small);
+  g_test_add_func ("/io-jobs-perf/deep-count-deep", test_deep_count_deep);
+  g_test_add_func ("/io-jobs-perf/search-small", test_search_small);
+  g_test_add_func ("/io-jobs-perf/copy-small", test_copy_small);
+  g_test_add_func ("/io-jobs-perf/copy-sparse", test_copy_sparse);
+  g_test_add_func ("/io-jobs-perf/move-small", test_move_small);
+  g_test_add_func ("/io-jobs-perf/unlink-small", test_unlink_small);
+  g_test_add_func ("/io-jobs-perf/trash-small", test_trash_small);
+  g_test_add_func ("/io-jobs-perf/chmod-small", test_chmod_small);
+
+  result = g_test_run ();
+
+  if (!g_test_subprocess ())
+    bench_remove_path (bench_root);
+  g_free (bench_root);
+
+  return result;
+}
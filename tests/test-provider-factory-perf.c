@@ -0,0 +1,193 @@
+#include "bench.h"
+#include "thunarx/thunarx.h"
+
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+#include <stdio.h>
+
+/* Benchmarks for the start of the extension provider factory, run them with 'meson test --benchmark'.
+ *
+ * The installed extensions are listed once per process, since a process creates its modules only
+ * once, so every run is a new process. The provider manifest is written to $XDG_CACHE_HOME, which
+ * points to a temporary directory. The number of runs can be adjusted with $THUNAR_BENCH_SCALE.
+ * The results are printed as one JSON object per benchmark (in a TAP comment), and appended to
+ * $THUNAR_BENCH_RESULTS if that is set. */
+
+/* number of processes per benchmark at scale 1 */
+#define BENCH_N_RUNS (20)
+
+
+
+/* the temporary cache directory, shared with the benchmark processes */
+static gchar *bench_root = NULL;
+
+
+
+static gchar *
+bench_manifest_path (void)
+{
+  return g_build_filename (bench_root, "thunarx-3", "providers.manifest", NULL);
+}
+
+
+
+static gchar *
+bench_result_path (void)
+{
+  return g_build_filename (bench_root, "result.txt", NULL);
+}
+
+
+
+/* lists the menu providers, like Thunar does for its first context menu,
+ * and appends the time and the number of providers to the result file */
+static void
+bench_list_providers (void)
+{
+  ThunarxProviderFactory *factory;
+  GList                  *providers;
+  gdouble                 elapsed;
+  gchar                  *path;
+  gchar                  *line;
+  FILE                   *fp;
+
+  factory = thunarx_provider_factory_get_default ();
+
+  g_test_timer_start ();
+  providers = thunarx_provider_factory_list_providers (factory, THUNARX_TYPE_MENU_PROVIDER);
+  elapsed = g_test_timer_elapsed ();
+
+  line = g_strdup_printf ("%.9f %u\n", elapsed, g_list_length (providers));
+  path = bench_result_path ();
+  fp = g_fopen (path, "a");
+  g_assert_nonnull (fp);
+  fputs (line, fp);
+  fclose (fp);
+  g_free (path);
+  g_free (line);
+
+  g_list_free_full (providers, g_object_unref);
+  g_object_unref (factory);
+}
+
+
+
+/* runs bench_list_providers() in @n_runs new processes, with or without the manifest
+ * of the previous run, and returns the total time and the number of providers */
+static gdouble
+bench_run (guint    n_runs,
+           gboolean with_manifest,
+           guint   *n_providers)
+{
+  gdouble elapsed = 0.0;
+  gchar  *end;
+  gchar  *manifest;
+  gchar  *path;
+  gchar  *contents;
+  gchar **lines;
+  guint   n;
+
+  manifest = bench_manifest_path ();
+  path = bench_result_path ();
+
+  for (n = 0; n < n_runs; ++n)
+    {
+      if (!with_manifest)
+        g_remove (manifest);
+
+      g_test_trap_subprocess (NULL, 0, G_TEST_SUBPROCESS_INHERIT_STDERR);
+      g_test_trap_assert_passed ();
+    }
+
+  g_assert_true (g_file_get_contents (path, &contents, NULL, NULL));
+  lines = g_strsplit (contents, "\n", -1);
+  for (n = 0; n < n_runs; ++n)
+    {
+      g_assert_nonnull (lines[n]);
+      elapsed += g_ascii_strtod (lines[n], &end);
+      *n_providers = g_ascii_strtoull (end, NULL, 10);
+    }
+
+  g_remove (path);
+  g_strfreev (lines);
+  g_free (contents);
+  g_free (manifest);
+  g_free (path);
+
+  return elapsed;
+}
+
+
+
+static void
+test_list_providers (gconstpointer data)
+{
+  gboolean with_manifest = GPOINTER_TO_INT (data);
+  gdouble  elapsed;
+  guint    n_providers = 0;
+  guint    n_runs;
+  gchar   *extra;
+
+  if (g_test_subprocess ())
+    {
+      bench_list_providers ();
+      return;
+    }
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("only run in perf mode");
+      return;
+    }
+
+  /* write a valid manifest for the installed extensions first */
+  if (with_manifest)
+    bench_run (1, FALSE, &n_providers);
+
+  n_runs = bench_scaled (BENCH_N_RUNS);
+  elapsed = bench_run (n_runs, with_manifest, &n_providers);
+
+  extra = g_strdup_printf ("\"providers\":%u,\"manifest\":%s", n_providers, with_manifest ? "true" : "false");
+  bench_report (with_manifest ? "list-providers-manifest" : "list-providers-no-manifest",
+                n_providers, n_runs, elapsed, extra);
+  g_free (extra);
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  int result;
+
+  g_test_init (&argc, &argv, NULL);
+
+  /* some extensions look at the display when their providers are created */
+  gtk_init_check (&argc, &argv);
+
+  bench_init ();
+
+  /* the benchmark processes share the cache directory of the parent */
+  if (g_test_subprocess ())
+    {
+      bench_root = g_strdup (g_getenv ("XDG_CACHE_HOME"));
+      g_assert_nonnull (bench_root);
+    }
+  else
+    {
+      bench_root = g_dir_make_tmp ("thunar-bench-XXXXXX", NULL);
+      g_assert_nonnull (bench_root);
+      g_setenv ("XDG_CACHE_HOME", bench_root, TRUE);
+    }
+
+  g_test_add_data_func ("/provider-factory-perf/list-providers-no-manifest", GINT_TO_POINTER (FALSE), test_list_providers);
+  g_test_add_data_func ("/provider-factory-perf/list-providers-manifest", GINT_TO_POINTER (TRUE), test_list_providers);
+
+  result = g_test_run ();
+
+  if (!g_test_subprocess ())
+    bench_remove_path (bench_root);
+  g_free (bench_root);
+
+  return result;
+}
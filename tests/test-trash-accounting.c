@@ -0,0 +1,211 @@
+#include "bench.h"
+#include "thunar/thunar-trash-accounting.h"
+
+#include <glib/gstdio.h>
+
+/* The home trash is created in $XDG_DATA_HOME, which points to a temporary directory,
+ * and the mounted volumes are hidden, so their trash directories are never seen */
+
+static gchar *trash_dir = NULL;
+
+
+
+/* a volume monitor without any mounts */
+typedef GVolumeMonitor      TestVolumeMonitor;
+typedef GVolumeMonitorClass TestVolumeMonitorClass;
+
+G_DEFINE_TYPE (TestVolumeMonitor, test_volume_monitor, G_TYPE_VOLUME_MONITOR)
+
+static GList *
+test_volume_monitor_get_mounts (GVolumeMonitor *volume_monitor)
+{
+  return NULL;
+}
+
+static void
+test_volume_monitor_class_init (TestVolumeMonitorClass *klass)
+{
+  klass->get_mounts = test_volume_monitor_get_mounts;
+}
+
+static void
+test_volume_monitor_init (TestVolumeMonitor *volume_monitor)
+{
+}
+
+
+
+static ThunarTrashAccounting *
+accounting_new (void)
+{
+  ThunarTrashAccounting *accounting;
+  GVolumeMonitor        *volume_monitor;
+
+  volume_monitor = g_object_new (test_volume_monitor_get_type (), NULL);
+  accounting = g_object_new (THUNAR_TYPE_TRASH_ACCOUNTING, "volume-monitor", volume_monitor, NULL);
+  g_object_unref (volume_monitor);
+
+  return accounting;
+}
+
+
+
+static void
+add_trash_item (const gchar *name,
+                const gchar *contents)
+{
+  gchar *path;
+  gchar *info;
+
+  path = g_build_filename (trash_dir, "info", name, NULL);
+  info = g_strconcat (path, ".trashinfo", NULL);
+  g_assert_true (g_file_set_contents (info, "[Trash Info]\nPath=/tmp/x\nDeletionDate=2026-01-01T00:00:00\n", -1, NULL));
+  g_free (info);
+  g_free (path);
+
+  path = g_build_filename (trash_dir, "files", name, NULL);
+  g_assert_true (g_file_set_contents (path, contents, -1, NULL));
+  g_free (path);
+}
+
+
+
+static void
+remove_trash_item (const gchar *name)
+{
+  gchar *path;
+  gchar *info;
+
+  path = g_build_filename (trash_dir, "files", name, NULL);
+  g_remove (path);
+  g_free (path);
+
+  path = g_build_filename (trash_dir, "info", name, NULL);
+  info = g_strconcat (path, ".trashinfo", NULL);
+  g_remove (info);
+  g_free (info);
+  g_free (path);
+}
+
+
+
+/* spins the main loop until the accounting reports @n_items */
+static guint64
+wait_for_items (ThunarTrashAccounting *accounting,
+                guint64                n_items)
+{
+  guint64 n;
+  guint64 size = 0;
+  gint64  end_time = g_get_monotonic_time () + 10 * G_USEC_PER_SEC;
+
+  while (!thunar_trash_accounting_get_usage (accounting, &n, &size) || n != n_items)
+    {
+      g_assert_cmpint (g_get_monotonic_time (), <, end_time);
+      g_main_context_iteration (NULL, TRUE);
+    }
+
+  return size;
+}
+
+
+
+static void
+test_seed (void)
+{
+  ThunarTrashAccounting *accounting;
+  gchar                 *path;
+
+  add_trash_item ("a.txt", "12345");
+  add_trash_item ("b.txt", "123");
+
+  /* a directory, which is measured recursively */
+  path = g_build_filename (trash_dir, "info", "dir.trashinfo", NULL);
+  g_assert_true (g_file_set_contents (path, "[Trash Info]\nPath=/tmp/dir\n", -1, NULL));
+  g_free (path);
+  path = g_build_filename (trash_dir, "files", "dir", NULL);
+  g_assert_cmpint (g_mkdir (path, 0700), ==, 0);
+  g_free (path);
+  path = g_build_filename (trash_dir, "files", "dir", "c.txt", NULL);
+  g_assert_true (g_file_set_contents (path, "1234567890", -1, NULL));
+  g_free (path);
+
+  accounting = accounting_new ();
+  g_assert_cmpuint (wait_for_items (accounting, 3), >=, 5 + 3 + 10);
+  g_object_unref (accounting);
+
+  path = g_build_filename (trash_dir, "files", "dir", "c.txt", NULL);
+  g_remove (path);
+  g_free (path);
+  path = g_build_filename (trash_dir, "files", "dir", NULL);
+  g_rmdir (path);
+  g_free (path);
+  remove_trash_item ("dir");
+  remove_trash_item ("a.txt");
+  remove_trash_item ("b.txt");
+}
+
+
+
+static void
+test_updates (void)
+{
+  ThunarTrashAccounting *accounting;
+  guint64                size;
+
+  accounting = accounting_new ();
+  size = wait_for_items (accounting, 0);
+  g_assert_cmpuint (size, ==, 0);
+
+  /* reported by a job */
+  add_trash_item ("d.txt", "1234");
+  thunar_trash_accounting_item_added (trash_dir, "d.txt");
+  g_assert_cmpuint (wait_for_items (accounting, 1), ==, 4);
+
+  /* reported by the monitor only */
+  add_trash_item ("e.txt", "12");
+  g_assert_cmpuint (wait_for_items (accounting, 2), ==, 6);
+
+  remove_trash_item ("d.txt");
+  g_assert_cmpuint (wait_for_items (accounting, 1), ==, 2);
+
+  remove_trash_item ("e.txt");
+  g_assert_cmpuint (wait_for_items (accounting, 0), ==, 0);
+
+  g_object_unref (accounting);
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  gchar *data_dir;
+  gchar *path;
+  int    result;
+
+  g_test_init (&argc, &argv, NULL);
+
+  /* keep away from the user's trash */
+  data_dir = g_dir_make_tmp ("thunar-test-data-XXXXXX", NULL);
+  g_assert_nonnull (data_dir);
+  g_setenv ("XDG_DATA_HOME", data_dir, TRUE);
+
+  trash_dir = g_build_filename (data_dir, "Trash", NULL);
+  path = g_build_filename (trash_dir, "files", NULL);
+  g_assert_cmpint (g_mkdir_with_parents (path, 0700), ==, 0);
+  g_free (path);
+  path = g_build_filename (trash_dir, "info", NULL);
+  g_assert_cmpint (g_mkdir_with_parents (path, 0700), ==, 0);
+  g_free (path);
+
+  g_test_add_func ("/trash-accounting/seed", test_seed);
+  g_test_add_func ("/trash-accounting/updates", test_updates);
+
+  result = g_test_run ();
+
+  bench_remove_path (data_dir);
+  g_free (trash_dir);
+  g_free (data_dir);
+
+  return result;
+}
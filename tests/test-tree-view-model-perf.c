@@ -0,0 +1,551 @@
+#include "bench.h"
+#include "thunar/thunar-file.h"
+#include "thunar/thunar-folder.h"
+#include "thunar/thunar-gio-extensions.h"
+#include "thunar/thunar-preferences.h"
+#include "thunar/thunar-tree-view-model.h"
+
+#include <unistd.h>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h> // for mallinfo2()
+#define BENCH_HAVE_MALLINFO2 1
+#endif
+
+/* Microbenchmarks for ThunarTreeViewModel, run them with 'meson test --benchmark'.
+ *
+ * The model is fed synthetic ThunarFiles, created from in-memory GFileInfos, through the
+ * "files-added" and "files-removed" signals of an (empty) folder, so neither the disk nor
+ * a display is involved. The number of rows can be adjusted with $THUNAR_BENCH_SCALE.
+ * The results are printed as one JSON object per benchmark (in a TAP comment), and
+ * appended to $THUNAR_BENCH_RESULTS if that is set. */
+
+/* number of rows at scale 1 */
+#define BENCH_N_FILES (100000)
+
+/* depth of the expanded folders for the get_path/get_iter benchmarks */
+#define BENCH_DEPTH (8)
+
+
+
+typedef struct
+{
+  gchar               *path;
+  ThunarFolder        *folder;
+  ThunarTreeViewModel *model;
+  GHashTable          *files;
+  guint                n_files;
+} BenchFixture;
+
+typedef struct
+{
+  ThunarColumn column;
+  const gchar *name;
+} BenchColumn;
+
+
+
+static const BenchColumn bench_columns[] = {
+  { THUNAR_COLUMN_DATE_CREATED, "date-created" },
+  { THUNAR_COLUMN_DATE_ACCESSED, "date-accessed" },
+  { THUNAR_COLUMN_DATE_MODIFIED, "date-modified" },
+  { THUNAR_COLUMN_DATE_DELETED, "date-deleted" },
+  { THUNAR_COLUMN_RECENCY, "recency" },
+  { THUNAR_COLUMN_LOCATION, "location" },
+  { THUNAR_COLUMN_GROUP, "group" },
+  { THUNAR_COLUMN_MIME_TYPE, "mime-type" },
+  { THUNAR_COLUMN_NAME, "name" },
+  { THUNAR_COLUMN_OWNER, "owner" },
+  { THUNAR_COLUMN_PERMISSIONS, "permissions" },
+  { THUNAR_COLUMN_SIZE, "size" },
+  { THUNAR_COLUMN_SIZE_IN_BYTES, "size-in-bytes" },
+  { THUNAR_COLUMN_TYPE, "type" },
+  { THUNAR_COLUMN_FILE, "file" },
+  { THUNAR_COLUMN_FILE_NAME, "file-name" },
+};
+
+static const gchar *bench_content_types[] = {
+  "text/plain",
+  "image/png",
+  "image/jpeg",
+  "application/pdf",
+  "audio/ogg",
+  "video/mp4",
+  "application/x-sharedlib",
+  "text/x-csrc",
+};
+
+
+
+static gint64
+bench_heap_size (void)
+{
+#ifdef BENCH_HAVE_MALLINFO2
+  struct mallinfo2 info = mallinfo2 ();
+
+  return info.uordblks + info.hblkhd;
+#else
+  return -1;
+#endif
+}
+
+
+
+static void
+bench_wait_for_folder (ThunarFolder *folder)
+{
+  while (thunar_folder_get_loading (folder))
+    g_main_context_iteration (NULL, TRUE);
+}
+
+
+
+/* creates a file below @directory which only exists in memory */
+static ThunarFile *
+bench_file_new (GFile *directory,
+                guint  n)
+{
+  ThunarFile *file;
+  GDateTime  *date;
+  GFileInfo  *info;
+  GFile      *gfile;
+  gchar      *name;
+
+  name = g_strdup_printf ("file-%07u", n);
+  gfile = g_file_get_child (directory, name);
+
+  /* spread sizes and dates, so the sort functions have some work to do */
+  info = g_file_info_new ();
+  g_file_info_set_name (info, name);
+  g_file_info_set_display_name (info, name);
+  g_file_info_set_file_type (info, G_FILE_TYPE_REGULAR);
+  g_file_info_set_size (info, g_int_hash (&n) % (G_GUINT64_CONSTANT (1) << 30));
+  g_file_info_set_content_type (info, bench_content_types[n % G_N_ELEMENTS (bench_content_types)]);
+  date = g_date_time_new_from_unix_utc (1500000000 + (g_str_hash (name) % 100000000));
+  g_file_info_set_modification_date_time (info, date);
+  g_file_info_set_access_date_time (info, date);
+  g_file_info_set_creation_date_time (info, date);
+  g_file_info_set_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_MODE, 0100000 | (n % 2 ? 0644 : 0600));
+  g_file_info_set_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_UID, getuid ());
+  g_file_info_set_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_GID, getgid ());
+  g_file_info_set_attribute_boolean (info, G_FILE_ATTRIBUTE_ACCESS_CAN_READ, TRUE);
+
+  file = thunar_file_get_with_info (gfile, info, NULL, FALSE);
+  thunar_file_set_content_type (file, bench_content_types[n % G_N_ELEMENTS (bench_content_types)]);
+
+  g_date_time_unref (date);
+  g_object_unref (info);
+  g_object_unref (gfile);
+  g_free (name);
+
+  return file;
+}
+
+
+
+static GHashTable *
+bench_files_new (ThunarFolder *folder,
+                 guint         n_files)
+{
+  GHashTable *files;
+  GFile      *directory;
+
+  files = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
+  directory = thunar_file_get_file (thunar_folder_get_corresponding_file (folder));
+  for (guint n = 0; n < n_files; ++n)
+    g_hash_table_add (files, bench_file_new (directory, n));
+
+  return files;
+}
+
+
+
+static ThunarFolder *
+bench_folder_new (const gchar *path)
+{
+  ThunarFolder *folder;
+  ThunarFile   *file;
+  GFile        *gfile;
+
+  gfile = g_file_new_for_path (path);
+  file = thunar_file_get (gfile, NULL);
+  g_assert_nonnull (file);
+
+  folder = thunar_folder_get_for_file (file);
+  g_assert_nonnull (folder);
+  bench_wait_for_folder (folder);
+
+  g_object_unref (file);
+  g_object_unref (gfile);
+
+  return folder;
+}
+
+
+
+static gboolean
+bench_setup (BenchFixture *fixture,
+             gconstpointer data)
+{
+  fixture->path = g_dir_make_tmp ("thunar-model-bench-XXXXXX", NULL);
+  g_assert_nonnull (fixture->path);
+
+  fixture->folder = bench_folder_new (fixture->path);
+  fixture->model = thunar_tree_view_model_new ();
+  thunar_tree_view_model_set_folder (fixture->model, fixture->folder, NULL);
+
+  fixture->n_files = bench_scaled (BENCH_N_FILES);
+  fixture->files = bench_files_new (fixture->folder, fixture->n_files);
+
+  return TRUE;
+}
+
+
+
+static void
+bench_teardown (BenchFixture *fixture,
+                gconstpointer data)
+{
+  thunar_tree_view_model_set_folder (fixture->model, NULL, NULL);
+  g_object_unref (fixture->model);
+  g_object_unref (fixture->folder);
+  g_hash_table_destroy (fixture->files);
+
+  bench_remove_path (fixture->path);
+  g_free (fixture->path);
+}
+
+
+
+/* adds the files to the model the same way a folder does after loading */
+static void
+bench_populate (BenchFixture *fixture)
+{
+  g_signal_emit_by_name (fixture->folder, "files-added", fixture->files);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (fixture->model), NULL), ==, fixture->n_files);
+}
+
+
+
+static void
+test_populate (BenchFixture *fixture,
+               gconstpointer data)
+{
+  gdouble elapsed;
+  gint64  heap_size;
+  gchar  *extra = NULL;
+
+  heap_size = bench_heap_size ();
+
+  g_test_timer_start ();
+  bench_populate (fixture);
+  elapsed = g_test_timer_elapsed ();
+
+  /* the files already exist, so this is only the memory used by the model for the rows */
+  if (heap_size >= 0)
+    extra = g_strdup_printf ("\"bytes_per_row\":%.1f", (gdouble) (bench_heap_size () - heap_size) / MAX (fixture->n_files, 1));
+
+  bench_report ("populate", fixture->n_files, fixture->n_files, elapsed, extra);
+  g_free (extra);
+}
+
+
+
+static void
+test_bulk_remove_add (BenchFixture *fixture,
+                      gconstpointer data)
+{
+  GHashTableIter iter;
+  GHashTable    *half;
+  gpointer       key;
+  gdouble        elapsed;
+  guint          n = 0;
+
+  bench_populate (fixture);
+
+  /* every other file, so the removals are spread over the whole model */
+  half = g_hash_table_new (g_direct_hash, g_direct_equal);
+  g_hash_table_iter_init (&iter, fixture->files);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    if (n++ % 2 == 0)
+      g_hash_table_add (half, key);
+
+  g_test_timer_start ();
+  g_signal_emit_by_name (fixture->folder, "files-removed", half);
+  elapsed = g_test_timer_elapsed ();
+  bench_report ("bulk-remove", fixture->n_files, g_hash_table_size (half), elapsed, NULL);
+
+  g_test_timer_start ();
+  g_signal_emit_by_name (fixture->folder, "files-added", half);
+  elapsed = g_test_timer_elapsed ();
+  bench_report ("bulk-add", fixture->n_files, g_hash_table_size (half), elapsed, NULL);
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (fixture->model), NULL), ==, fixture->n_files);
+  g_hash_table_destroy (half);
+}
+
+
+
+static void
+test_sort (BenchFixture *fixture,
+           gconstpointer data)
+{
+  gdouble elapsed;
+  gchar  *name;
+
+  bench_populate (fixture);
+
+  for (guint n = 0; n < G_N_ELEMENTS (bench_columns); ++n)
+    {
+      if (bench_columns[n].column >= THUNAR_N_VISIBLE_COLUMNS)
+        continue;
+
+      g_test_timer_start ();
+      gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (fixture->model), bench_columns[n].column, GTK_SORT_ASCENDING);
+      elapsed = g_test_timer_elapsed ();
+
+      name = g_strconcat ("sort-", bench_columns[n].name, NULL);
+      bench_report (name, fixture->n_files, fixture->n_files, elapsed, NULL);
+      g_free (name);
+    }
+}
+
+
+
+static void
+bench_search_done (ThunarTreeViewModel *model,
+                   gboolean            *done)
+{
+  *done = TRUE;
+}
+
+
+
+static void
+test_search (BenchFixture *fixture,
+             gconstpointer data)
+{
+  gboolean done = FALSE;
+  gdouble  elapsed;
+  GList   *keys;
+  gchar   *query;
+
+  g_signal_connect (fixture->model, "search-done", G_CALLBACK (bench_search_done), &done);
+
+  /* the search job finds nothing in the empty folder, the synthetic files are passed
+   * to the model like search results and filtered by it once the job is done */
+  query = g_strdup ("42");
+  g_test_timer_start ();
+  thunar_tree_view_model_set_folder (fixture->model, fixture->folder, query);
+  keys = g_hash_table_get_keys (fixture->files);
+  thunar_tree_view_model_add_search_files (fixture->model, thunar_g_list_copy_deep (keys));
+  g_list_free (keys);
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+  elapsed = g_test_timer_elapsed ();
+  g_free (query);
+
+  bench_report ("search", fixture->n_files, fixture->n_files, elapsed, NULL);
+  if (fixture->n_files > 42)
+    g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (fixture->model), NULL), >, 0);
+
+  g_signal_handlers_disconnect_by_func (fixture->model, bench_search_done, &done);
+}
+
+
+
+static void
+test_get_value (BenchFixture *fixture,
+                gconstpointer data)
+{
+  GtkTreeModel *model = GTK_TREE_MODEL (fixture->model);
+  GtkTreeIter   iter;
+  GValue        value = G_VALUE_INIT;
+  gdouble       elapsed;
+  gchar        *name;
+
+  bench_populate (fixture);
+
+  /* the second pass is like redrawing the rows, which reuses the formatted strings */
+  for (guint n = 0; n < G_N_ELEMENTS (bench_columns); ++n)
+    for (guint pass = 0; pass < 2; ++pass)
+      {
+        g_test_timer_start ();
+        for (gboolean valid = gtk_tree_model_get_iter_first (model, &iter); valid; valid = gtk_tree_model_iter_next (model, &iter))
+          {
+            gtk_tree_model_get_value (model, &iter, bench_columns[n].column, &value);
+            g_value_unset (&value);
+          }
+        elapsed = g_test_timer_elapsed ();
+
+        name = g_strconcat (pass == 0 ? "get-value-" : "get-value-again-", bench_columns[n].name, NULL);
+        bench_report (name, fixture->n_files, fixture->n_files, elapsed, NULL);
+        g_free (name);
+      }
+}
+
+
+
+static void
+bench_paths (BenchFixture *fixture,
+             GtkTreeIter  *parent,
+             const gchar  *name)
+{
+  GtkTreeModel *model = GTK_TREE_MODEL (fixture->model);
+  GtkTreePath **paths;
+  GtkTreeIter  *iters;
+  GtkTreeIter   iter;
+  gdouble       elapsed;
+  gchar        *bench_name;
+  guint         n_rows;
+  guint         n;
+
+  n_rows = gtk_tree_model_iter_n_children (model, parent);
+  iters = g_new (GtkTreeIter, n_rows);
+  paths = g_new (GtkTreePath *, n_rows);
+
+  n = 0;
+  for (gboolean valid = gtk_tree_model_iter_children (model, &iter, parent); valid; valid = gtk_tree_model_iter_next (model, &iter))
+    iters[n++] = iter;
+  g_assert_cmpuint (n, ==, n_rows);
+
+  g_test_timer_start ();
+  for (n = 0; n < n_rows; ++n)
+    paths[n] = gtk_tree_model_get_path (model, &iters[n]);
+  elapsed = g_test_timer_elapsed ();
+
+  bench_name = g_strconcat ("get-path-", name, NULL);
+  bench_report (bench_name, n_rows, n_rows, elapsed, NULL);
+  g_free (bench_name);
+
+  g_test_timer_start ();
+  for (n = 0; n < n_rows; ++n)
+    gtk_tree_model_get_iter (model, &iters[n], paths[n]);
+  elapsed = g_test_timer_elapsed ();
+
+  bench_name = g_strconcat ("get-iter-", name, NULL);
+  bench_report (bench_name, n_rows, n_rows, elapsed, NULL);
+  g_free (bench_name);
+
+  for (n = 0; n < n_rows; ++n)
+    gtk_tree_path_free (paths[n]);
+  g_free (paths);
+  g_free (iters);
+}
+
+
+
+static void
+test_paths_toplevel (BenchFixture *fixture,
+                     gconstpointer data)
+{
+  bench_populate (fixture);
+  bench_paths (fixture, NULL, "depth-0");
+}
+
+
+
+/* returns the first real file below @parent, waiting for the model to add it */
+static ThunarFile *
+bench_find_child (GtkTreeModel *model,
+                  GtkTreeIter  *parent,
+                  GtkTreeIter  *iter)
+{
+  ThunarFile *file = NULL;
+
+  for (;;)
+    {
+      for (gboolean valid = gtk_tree_model_iter_children (model, iter, parent); valid; valid = gtk_tree_model_iter_next (model, iter))
+        {
+          gtk_tree_model_get (model, iter, THUNAR_COLUMN_FILE, &file, -1);
+          if (file != NULL)
+            return file;
+        }
+
+      g_main_context_iteration (NULL, TRUE);
+    }
+}
+
+
+
+static void
+test_paths_nested (BenchFixture *fixture,
+                   gconstpointer data)
+{
+  GtkTreeModel *model = GTK_TREE_MODEL (fixture->model);
+  ThunarFolder *folder;
+  GtkTreeIter   parent;
+  GtkTreeIter   iter;
+  ThunarFile   *file;
+  GHashTable   *files;
+  gboolean      have_parent = FALSE;
+  GString      *path;
+  gchar        *name;
+
+  /* a chain of real (empty) folders, expanded like in the tree view */
+  path = g_string_new (fixture->path);
+  for (guint n = 0; n < BENCH_DEPTH; ++n)
+    {
+      g_string_append (path, "/d");
+      g_assert_cmpint (g_mkdir (path->str, 0755), ==, 0);
+    }
+
+  thunar_folder_reload (fixture->folder, FALSE);
+  bench_wait_for_folder (fixture->folder);
+
+  folder = NULL;
+  for (guint n = 0; n < BENCH_DEPTH; ++n)
+    {
+      /* look up the only folder on this level, skipping the "Loading..." dummy */
+      file = bench_find_child (model, have_parent ? &parent : NULL, &iter);
+
+      if (folder != NULL)
+        g_object_unref (folder);
+      folder = thunar_folder_get_for_file (file);
+      thunar_tree_view_model_load_subdir (fixture->model, &iter);
+      bench_wait_for_folder (folder);
+
+      g_object_unref (file);
+      parent = iter;
+      have_parent = TRUE;
+    }
+
+  /* fill the deepest folder with the synthetic files */
+  files = bench_files_new (folder, fixture->n_files);
+  g_signal_emit_by_name (folder, "files-added", files);
+
+  name = g_strdup_printf ("depth-%d", BENCH_DEPTH);
+  bench_paths (fixture, &parent, name);
+  g_free (name);
+
+  thunar_tree_view_model_set_folder (fixture->model, NULL, NULL);
+  g_hash_table_destroy (files);
+  g_object_unref (folder);
+  g_string_free (path, TRUE);
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  /* account the rows to the heap, not to the slice allocator */
+  g_setenv ("G_SLICE", "always-malloc", TRUE);
+
+  g_test_init (&argc, &argv, NULL);
+
+  /* the model reads the preferences, use the defaults instead of xfconf */
+  thunar_preferences_xfconf_init_failed ();
+
+  bench_init ();
+
+  bench_add ("/tree-view-model-perf/populate", BenchFixture, NULL, bench_setup, test_populate, bench_teardown);
+  bench_add ("/tree-view-model-perf/bulk-remove-add", BenchFixture, NULL, bench_setup, test_bulk_remove_add, bench_teardown);
+  bench_add ("/tree-view-model-perf/sort", BenchFixture, NULL, bench_setup, test_sort, bench_teardown);
+  bench_add ("/tree-view-model-perf/search", BenchFixture, NULL, bench_setup, test_search, bench_teardown);
+  bench_add ("/tree-view-model-perf/get-value", BenchFixture, NULL, bench_setup, test_get_value, bench_teardown);
+  bench_add ("/tree-view-model-perf/paths-toplevel", BenchFixture, NULL, bench_setup, test_paths_toplevel, bench_teardown);
+  bench_add ("/tree-view-model-perf/paths-nested", BenchFixture, NULL, bench_setup, test_paths_nested, bench_teardown);
+
+  return g_test_run ();
+}
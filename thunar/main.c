@@ -35,6 +35,7 @@
 #include "thunar/thunar-preferences.h"
 #include "thunar/thunar-private.h"
 #include "thunar/thunar-session-client.h"
+#include "thunar/thunar-trace.h"
 
 #include <xfconf/xfconf.h>
 
@@ -64,6 +65,9 @@ main (int argc, char **argv)
       thunar_preferences_xfconf_init_failed ();
     }
 
+  /* record main loop stalls if requested via THUNAR_TRACE */
+  thunar_trace_init ();
+
   /* register additional transformation functions */
   thunar_g_initialize_transformations ();
 
@@ -82,6 +86,8 @@ main (int argc, char **argv)
   /* release the application reference */
   g_object_unref (G_OBJECT (application));
 
+  thunar_trace_shutdown ();
+
 #ifdef HAVE_LIBNOTIFY
   thunar_notify_uninit ();
 #endif
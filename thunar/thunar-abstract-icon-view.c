@@ -20,6 +20,7 @@
 #include "thunar/thunar-abstract-icon-view.h"
 #include "thunar/thunar-action-manager.h"
 #include "thunar/thunar-gobject-extensions.h"
+#include "thunar/thunar-grid-view.h"
 #include "thunar/thunar-gtk-extensions.h"
 #include "thunar/thunar-preferences.h"
 #include "thunar/thunar-private.h"
@@ -65,39 +66,38 @@ thunar_abstract_icon_view_get_visible_range (ThunarStandardView *standard_view,
 static void
 thunar_abstract_icon_view_highlight_path (ThunarStandardView *standard_view,
                                           GtkTreePath        *path);
-static void
-thunar_abstract_icon_view_notify_model (XfceIconView           *view,
-                                        GParamSpec             *pspec,
-                                        ThunarAbstractIconView *abstract_icon_view);
 static gboolean
-thunar_abstract_icon_view_button_press_event (XfceIconView           *view,
+thunar_abstract_icon_view_button_press_event (ThunarGridView         *view,
                                               GdkEventButton         *event,
                                               ThunarAbstractIconView *abstract_icon_view);
 static gboolean
-thunar_abstract_icon_view_button_release_event (XfceIconView           *view,
+thunar_abstract_icon_view_button_release_event (ThunarGridView         *view,
                                                 GdkEventButton         *event,
                                                 ThunarAbstractIconView *abstract_icon_view);
 static gboolean
-thunar_abstract_icon_view_draw (XfceIconView           *view,
+thunar_abstract_icon_view_draw (ThunarGridView         *view,
                                 cairo_t                *cr,
                                 ThunarAbstractIconView *abstract_icon_view);
 static gboolean
-thunar_abstract_icon_view_key_press_event (XfceIconView           *view,
+thunar_abstract_icon_view_key_press_event (ThunarGridView         *view,
                                            GdkEventKey            *event,
                                            ThunarAbstractIconView *abstract_icon_view);
 static gboolean
-thunar_abstract_icon_view_key_release_event (XfceIconView           *view,
+thunar_abstract_icon_view_key_release_event (ThunarGridView         *view,
                                              GdkEventKey            *event,
                                              ThunarAbstractIconView *abstract_icon_view);
 static gboolean
-thunar_abstract_icon_view_motion_notify_event (XfceIconView           *view,
+thunar_abstract_icon_view_motion_notify_event (ThunarGridView         *view,
                                                GdkEventMotion         *event,
                                                ThunarAbstractIconView *abstract_icon_view);
 static void
-thunar_abstract_icon_view_item_activated (XfceIconView           *view,
+thunar_abstract_icon_view_item_activated (ThunarGridView         *view,
                                           GtkTreePath            *path,
                                           ThunarAbstractIconView *abstract_icon_view);
 static void
+thunar_abstract_icon_view_selection_changed (ThunarGridView         *view,
+                                             ThunarAbstractIconView *abstract_icon_view);
+static void
 thunar_abstract_icon_view_zoom_level_changed (ThunarAbstractIconView *abstract_icon_view);
 static void
 thunar_abstract_icon_view_queue_redraw (ThunarStandardView *standard_view);
@@ -190,19 +190,17 @@ thunar_abstract_icon_view_init (ThunarAbstractIconView *abstract_icon_view)
   g_signal_connect (G_OBJECT (abstract_icon_view), "notify::zoom-level", G_CALLBACK (thunar_abstract_icon_view_zoom_level_changed), NULL);
 
   /* create the real view */
-  view = xfce_icon_view_new ();
-  g_signal_connect (G_OBJECT (view), "notify::model", G_CALLBACK (thunar_abstract_icon_view_notify_model), abstract_icon_view);
+  view = thunar_grid_view_new ();
   g_signal_connect (G_OBJECT (view), "button-press-event", G_CALLBACK (thunar_abstract_icon_view_button_press_event), abstract_icon_view);
   g_signal_connect (G_OBJECT (view), "key-press-event", G_CALLBACK (thunar_abstract_icon_view_key_press_event), abstract_icon_view);
   g_signal_connect (G_OBJECT (view), "key-release-event", G_CALLBACK (thunar_abstract_icon_view_key_release_event), abstract_icon_view);
   g_signal_connect (G_OBJECT (view), "item-activated", G_CALLBACK (thunar_abstract_icon_view_item_activated), abstract_icon_view);
-  g_signal_connect_swapped (G_OBJECT (view), "selection-changed", G_CALLBACK (thunar_standard_view_selection_changed), abstract_icon_view);
+  g_signal_connect (G_OBJECT (view), "selection-changed", G_CALLBACK (thunar_abstract_icon_view_selection_changed), abstract_icon_view);
   gtk_container_add (GTK_CONTAINER (abstract_icon_view), view);
   gtk_widget_show (view);
 
   /* initialize the abstract icon view properties */
-  xfce_icon_view_set_enable_search (XFCE_ICON_VIEW (view), TRUE);
-  xfce_icon_view_set_selection_mode (XFCE_ICON_VIEW (view), GTK_SELECTION_MULTIPLE);
+  thunar_grid_view_set_search_column (THUNAR_GRID_VIEW (view), THUNAR_COLUMN_NAME);
 
   /* add the abstract icon renderer */
   g_object_set (G_OBJECT (THUNAR_STANDARD_VIEW (abstract_icon_view)->icon_renderer), "follow-state", TRUE, "rounded-corners", TRUE, NULL);
@@ -220,12 +218,6 @@ thunar_abstract_icon_view_init (ThunarAbstractIconView *abstract_icon_view)
 
   /* Set the type of model to be used by the view */
   g_object_set (G_OBJECT (THUNAR_STANDARD_VIEW (abstract_icon_view)), "model-type", THUNAR_TYPE_TREE_VIEW_MODEL, NULL);
-
-  /* update the icon view on size-allocate events */
-  /* TODO: issue not reproducible anymore as of gtk 3.24.18
-   * we can probably remove this in the future. */
-  g_signal_connect_swapped (G_OBJECT (abstract_icon_view), "size-allocate",
-                            G_CALLBACK (gtk_widget_queue_resize), view);
 }
 
 
@@ -241,8 +233,8 @@ thunar_abstract_icon_view_style_set (GtkWidget *widget,
   gtk_widget_style_get (widget, "column-spacing", &column_spacing, "row-spacing", &row_spacing, NULL);
 
   /* apply the column/row spacing to the icon view */
-  xfce_icon_view_set_column_spacing (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (widget))), column_spacing);
-  xfce_icon_view_set_row_spacing (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (widget))), row_spacing);
+  thunar_grid_view_set_column_spacing (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (widget))), column_spacing);
+  thunar_grid_view_set_row_spacing (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (widget))), row_spacing);
 
   /* call the parent handler */
   (*GTK_WIDGET_CLASS (thunar_abstract_icon_view_parent_class)->style_set) (widget, previous_style);
@@ -253,7 +245,7 @@ thunar_abstract_icon_view_style_set (GtkWidget *widget,
 static GList *
 thunar_abstract_icon_view_get_selected_items (ThunarStandardView *standard_view)
 {
-  return xfce_icon_view_get_selected_items (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))));
+  return thunar_grid_view_get_selected_items (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))));
 }
 
 
@@ -262,7 +254,7 @@ static void
 thunar_abstract_icon_view_select_all (ThunarStandardView *standard_view)
 {
   _thunar_return_if_fail (THUNAR_IS_ABSTRACT_ICON_VIEW (standard_view));
-  xfce_icon_view_select_all (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))));
+  thunar_grid_view_select_all (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))));
 }
 
 
@@ -271,7 +263,7 @@ static void
 thunar_abstract_icon_view_unselect_all (ThunarStandardView *standard_view)
 {
   _thunar_return_if_fail (THUNAR_IS_ABSTRACT_ICON_VIEW (standard_view));
-  xfce_icon_view_unselect_all (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))));
+  thunar_grid_view_unselect_all (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))));
 }
 
 
@@ -280,7 +272,7 @@ static void
 thunar_abstract_icon_view_selection_invert (ThunarStandardView *standard_view)
 {
   _thunar_return_if_fail (THUNAR_IS_ABSTRACT_ICON_VIEW (standard_view));
-  xfce_icon_view_selection_invert (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))));
+  thunar_grid_view_selection_invert (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))));
 }
 
 
@@ -290,7 +282,7 @@ thunar_abstract_icon_view_select_path (ThunarStandardView *standard_view,
                                        GtkTreePath        *path)
 {
   _thunar_return_if_fail (THUNAR_IS_ABSTRACT_ICON_VIEW (standard_view));
-  xfce_icon_view_select_path (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), path);
+  thunar_grid_view_select_path (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), path);
 }
 
 
@@ -300,19 +292,10 @@ thunar_abstract_icon_view_set_cursor (ThunarStandardView *standard_view,
                                       GtkTreePath        *path,
                                       gboolean            start_editing)
 {
-  GtkCellRendererMode mode;
-
   _thunar_return_if_fail (THUNAR_IS_ABSTRACT_ICON_VIEW (standard_view));
 
-  /* make sure the name renderer is editable */
-  g_object_get (G_OBJECT (standard_view->name_renderer), "mode", &mode, NULL);
-  g_object_set (G_OBJECT (standard_view->name_renderer), "mode", GTK_CELL_RENDERER_MODE_EDITABLE, NULL);
-
-  /* tell the abstract_icon view to start editing the given item */
-  xfce_icon_view_set_cursor (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), path, standard_view->name_renderer, start_editing);
-
-  /* reset the name renderer mode */
-  g_object_set (G_OBJECT (standard_view->name_renderer), "mode", mode, NULL);
+  /* the icon views have no inline editing, so start_editing is ignored */
+  thunar_grid_view_set_cursor (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), path);
 }
 
 
@@ -325,7 +308,7 @@ thunar_abstract_icon_view_scroll_to_path (ThunarStandardView *standard_view,
                                           gfloat              col_align)
 {
   _thunar_return_if_fail (THUNAR_IS_ABSTRACT_ICON_VIEW (standard_view));
-  xfce_icon_view_scroll_to_path (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), path, use_align, row_align, col_align);
+  thunar_grid_view_scroll_to_path (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), path, use_align, row_align, col_align);
 }
 
 
@@ -336,7 +319,7 @@ thunar_abstract_icon_view_get_path_at_pos (ThunarStandardView *standard_view,
                                            gint                y)
 {
   _thunar_return_val_if_fail (THUNAR_IS_ABSTRACT_ICON_VIEW (standard_view), NULL);
-  return xfce_icon_view_get_path_at_pos (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), x, y);
+  return thunar_grid_view_get_path_at_pos (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), x, y);
 }
 
 
@@ -347,7 +330,7 @@ thunar_abstract_icon_view_get_visible_range (ThunarStandardView *standard_view,
                                              GtkTreePath       **end_path)
 {
   _thunar_return_val_if_fail (THUNAR_IS_ABSTRACT_ICON_VIEW (standard_view), FALSE);
-  return xfce_icon_view_get_visible_range (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), start_path, end_path);
+  return thunar_grid_view_get_visible_range (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), start_path, end_path);
 }
 
 
@@ -357,7 +340,7 @@ thunar_abstract_icon_view_highlight_path (ThunarStandardView *standard_view,
                                           GtkTreePath        *path)
 {
   _thunar_return_if_fail (THUNAR_IS_ABSTRACT_ICON_VIEW (standard_view));
-  xfce_icon_view_set_drag_dest_item (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), path, XFCE_ICON_VIEW_DROP_INTO);
+  thunar_grid_view_set_drag_dest_item (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), path);
 }
 
 
@@ -399,21 +382,8 @@ thunar_abstract_icon_view_gesture_action (ThunarAbstractIconView *abstract_icon_
 
 
 
-static void
-thunar_abstract_icon_view_notify_model (XfceIconView           *view,
-                                        GParamSpec             *pspec,
-                                        ThunarAbstractIconView *abstract_icon_view)
-{
-  /* We need to set the search column here, as XfceIconView resets it
-   * whenever a new model is set.
-   */
-  xfce_icon_view_set_search_column (view, THUNAR_COLUMN_NAME);
-}
-
-
-
 static gboolean
-thunar_abstract_icon_view_button_press_event (XfceIconView           *view,
+thunar_abstract_icon_view_button_press_event (ThunarGridView         *view,
                                               GdkEventButton         *event,
                                               ThunarAbstractIconView *abstract_icon_view)
 {
@@ -426,24 +396,24 @@ thunar_abstract_icon_view_button_press_event (XfceIconView           *view,
 
   if (event->type == GDK_BUTTON_PRESS && event->button == 1)
     {
-      if (xfce_icon_view_get_item_at_pos (view, event->x, event->y, &path, NULL))
+      if ((path = thunar_grid_view_get_path_at_pos (view, event->x, event->y)) != NULL)
         {
-          thunar_standard_view_preload_neighboring_preview_images (THUNAR_STANDARD_VIEW (abstract_icon_view), xfce_icon_view_get_model (view), path);
+          thunar_standard_view_preload_neighboring_preview_images (THUNAR_STANDARD_VIEW (abstract_icon_view), thunar_grid_view_get_model (view), path);
           gtk_tree_path_free (path);
         }
     }
   else if (event->type == GDK_BUTTON_PRESS && event->button == 3)
     {
       /* open the context menu on right clicks */
-      if (xfce_icon_view_get_item_at_pos (view, event->x, event->y, &path, NULL))
+      if ((path = thunar_grid_view_get_path_at_pos (view, event->x, event->y)) != NULL)
         {
           /* select the path on which the user clicked if not selected yet */
-          if (!xfce_icon_view_path_is_selected (view, path))
+          if (!thunar_grid_view_path_is_selected (view, path))
             {
               /* we don't unselect all other items if Control is active */
               if ((event->state & GDK_CONTROL_MASK) == 0)
-                xfce_icon_view_unselect_all (view);
-              xfce_icon_view_select_path (view, path);
+                thunar_grid_view_unselect_all (view);
+              thunar_grid_view_select_path (view, path);
             }
           gtk_tree_path_free (path);
 
@@ -455,7 +425,7 @@ thunar_abstract_icon_view_button_press_event (XfceIconView           *view,
           /* user clicked on an empty area, so we unselect everything
            * to make sure that the folder context menu is opened.
            */
-          xfce_icon_view_unselect_all (view);
+          thunar_grid_view_unselect_all (view);
 
           /* open the context menu */
           thunar_standard_view_context_menu (THUNAR_STANDARD_VIEW (abstract_icon_view));
@@ -466,13 +436,13 @@ thunar_abstract_icon_view_button_press_event (XfceIconView           *view,
   else if (event->type == GDK_BUTTON_PRESS && event->button == 2)
     {
       /* unselect all currently selected items */
-      xfce_icon_view_unselect_all (view);
+      thunar_grid_view_unselect_all (view);
 
       /* determine the path to the item that was middle-clicked */
-      if (xfce_icon_view_get_item_at_pos (view, event->x, event->y, &path, NULL))
+      if ((path = thunar_grid_view_get_path_at_pos (view, event->x, event->y)) != NULL)
         {
           /* select only the path to the item on which the user clicked */
-          xfce_icon_view_select_path (view, path);
+          thunar_grid_view_select_path (view, path);
 
           /* try to open the path as new window/tab, if possible */
           _thunar_standard_view_open_on_middle_click (THUNAR_STANDARD_VIEW (abstract_icon_view), path, event->state);
@@ -505,14 +475,14 @@ thunar_abstract_icon_view_button_press_event (XfceIconView           *view,
 
 
 static gboolean
-thunar_abstract_icon_view_button_release_event (XfceIconView           *view,
+thunar_abstract_icon_view_button_release_event (ThunarGridView         *view,
                                                 GdkEventButton         *event,
                                                 ThunarAbstractIconView *abstract_icon_view)
 {
   const XfceGtkActionEntry *action_entry;
   GtkWidget                *window;
 
-  _thunar_return_val_if_fail (XFCE_IS_ICON_VIEW (view), FALSE);
+  _thunar_return_val_if_fail (THUNAR_IS_GRID_VIEW (view), FALSE);
   _thunar_return_val_if_fail (THUNAR_IS_ABSTRACT_ICON_VIEW (abstract_icon_view), FALSE);
   _thunar_return_val_if_fail (abstract_icon_view->priv->gesture_expose_id > 0, FALSE);
   _thunar_return_val_if_fail (abstract_icon_view->priv->gesture_motion_id > 0, FALSE);
@@ -546,7 +516,7 @@ thunar_abstract_icon_view_button_release_event (XfceIconView           *view,
 
 
 static gboolean
-thunar_abstract_icon_view_draw (XfceIconView           *view,
+thunar_abstract_icon_view_draw (ThunarGridView         *view,
                                 cairo_t                *cr,
                                 ThunarAbstractIconView *abstract_icon_view)
 {
@@ -556,7 +526,7 @@ thunar_abstract_icon_view_draw (XfceIconView           *view,
   gint                      x, y;
   gint                      scale_factor;
 
-  _thunar_return_val_if_fail (XFCE_IS_ICON_VIEW (view), FALSE);
+  _thunar_return_val_if_fail (THUNAR_IS_GRID_VIEW (view), FALSE);
   _thunar_return_val_if_fail (THUNAR_IS_ABSTRACT_ICON_VIEW (abstract_icon_view), FALSE);
   _thunar_return_val_if_fail (abstract_icon_view->priv->gesture_expose_id > 0, FALSE);
   _thunar_return_val_if_fail (abstract_icon_view->priv->gesture_motion_id > 0, FALSE);
@@ -608,7 +578,7 @@ thunar_abstract_icon_view_draw (XfceIconView           *view,
 
 
 static gboolean
-thunar_abstract_icon_view_key_press_event (XfceIconView           *view,
+thunar_abstract_icon_view_key_press_event (ThunarGridView         *view,
                                            GdkEventKey            *event,
                                            ThunarAbstractIconView *abstract_icon_view)
 {
@@ -625,16 +595,16 @@ thunar_abstract_icon_view_key_press_event (XfceIconView           *view,
 
 
 static gboolean
-thunar_abstract_icon_view_key_release_event (XfceIconView           *view,
+thunar_abstract_icon_view_key_release_event (ThunarGridView         *view,
                                              GdkEventKey            *event,
                                              ThunarAbstractIconView *abstract_icon_view)
 {
   GtkTreePath *path;
 
-  xfce_icon_view_get_cursor (view, &path, NULL);
+  path = thunar_grid_view_get_cursor (view);
   if (path != NULL)
     {
-      thunar_standard_view_preload_neighboring_preview_images (THUNAR_STANDARD_VIEW (abstract_icon_view), xfce_icon_view_get_model (view), path);
+      thunar_standard_view_preload_neighboring_preview_images (THUNAR_STANDARD_VIEW (abstract_icon_view), thunar_grid_view_get_model (view), path);
       gtk_tree_path_free (path);
     }
 
@@ -644,13 +614,13 @@ thunar_abstract_icon_view_key_release_event (XfceIconView           *view,
 
 
 static gboolean
-thunar_abstract_icon_view_motion_notify_event (XfceIconView           *view,
+thunar_abstract_icon_view_motion_notify_event (ThunarGridView         *view,
                                                GdkEventMotion         *event,
                                                ThunarAbstractIconView *abstract_icon_view)
 {
   GdkRectangle area;
 
-  _thunar_return_val_if_fail (XFCE_IS_ICON_VIEW (view), FALSE);
+  _thunar_return_val_if_fail (THUNAR_IS_GRID_VIEW (view), FALSE);
   _thunar_return_val_if_fail (THUNAR_IS_ABSTRACT_ICON_VIEW (abstract_icon_view), FALSE);
   _thunar_return_val_if_fail (abstract_icon_view->priv->gesture_expose_id > 0, FALSE);
   _thunar_return_val_if_fail (abstract_icon_view->priv->gesture_motion_id > 0, FALSE);
@@ -682,7 +652,7 @@ thunar_abstract_icon_view_motion_notify_event (XfceIconView           *view,
 
 
 static void
-thunar_abstract_icon_view_item_activated (XfceIconView           *view,
+thunar_abstract_icon_view_item_activated (ThunarGridView         *view,
                                           GtkTreePath            *path,
                                           ThunarAbstractIconView *abstract_icon_view)
 {
@@ -696,6 +666,30 @@ thunar_abstract_icon_view_item_activated (XfceIconView           *view,
 
 
 
+static void
+thunar_abstract_icon_view_selection_changed (ThunarGridView         *view,
+                                             ThunarAbstractIconView *abstract_icon_view)
+{
+  GList *selected_paths;
+  GList *unselected_paths;
+
+  _thunar_return_if_fail (THUNAR_IS_ABSTRACT_ICON_VIEW (abstract_icon_view));
+
+  /* pass on only what changed, so large selections are not walked for every change */
+  if (thunar_grid_view_get_selection_delta (view, &selected_paths, &unselected_paths))
+    {
+      thunar_standard_view_selection_delta (THUNAR_STANDARD_VIEW (abstract_icon_view), selected_paths, unselected_paths);
+      g_list_free_full (selected_paths, (GDestroyNotify) gtk_tree_path_free);
+      g_list_free_full (unselected_paths, (GDestroyNotify) gtk_tree_path_free);
+    }
+  else
+    {
+      thunar_standard_view_selection_changed (THUNAR_STANDARD_VIEW (abstract_icon_view));
+    }
+}
+
+
+
 static void
 thunar_abstract_icon_view_zoom_level_changed (ThunarAbstractIconView *abstract_icon_view)
 {
@@ -729,7 +723,7 @@ thunar_abstract_icon_view_block_selection_changed (ThunarStandardView *view)
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (view));
 
   g_signal_handlers_block_by_func (G_OBJECT (gtk_bin_get_child (GTK_BIN (view))),
-                                   thunar_standard_view_selection_changed, view);
+                                   thunar_abstract_icon_view_selection_changed, view);
 }
 
 
@@ -740,5 +734,5 @@ thunar_abstract_icon_view_unblock_selection_changed (ThunarStandardView *view)
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (view));
 
   g_signal_handlers_unblock_by_func (G_OBJECT (gtk_bin_get_child (GTK_BIN (view))),
-                                     thunar_standard_view_selection_changed, view);
+                                     thunar_abstract_icon_view_selection_changed, view);
 }
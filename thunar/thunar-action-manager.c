@@ -39,6 +39,8 @@
 #include "thunar/thunar-gtk-extensions.h"
 #include "thunar/thunar-icon-factory.h"
 #include "thunar/thunar-io-scan-directory.h"
+#include "thunar/thunar-menu-providers.h"
+#include "thunar/thunar-menu.h"
 #include "thunar/thunar-preferences.h"
 #include "thunar/thunar-private.h"
 #include "thunar/thunar-properties-dialog.h"
@@ -2400,12 +2402,79 @@ thunar_action_manager_action_duplicate (ThunarActionManager *action_mgr)
 
 
 
+/* inserts the menu items of the providers into @menu, in front of the @anchor */
+static gboolean
+thunar_action_manager_insert_thunarx_menu_items (GtkMenuShell *menu,
+                                                 GList        *thunarx_menu_items,
+                                                 GtkWidget    *anchor)
+{
+  GtkWidget *gtk_menu_item;
+  GList     *children;
+  GList     *lp_item;
+  gchar     *name;
+  gint       position;
+
+  for (lp_item = thunarx_menu_items; lp_item != NULL; lp_item = lp_item->next)
+    {
+      gtk_menu_item = thunar_gtk_menu_thunarx_menu_item_new (lp_item->data, menu);
+
+      /* move items which arrive after the menu was built in front of the anchor */
+      if (anchor != NULL)
+        {
+          children = gtk_container_get_children (GTK_CONTAINER (menu));
+          position = g_list_index (children, anchor);
+          g_list_free (children);
+          if (position >= 0)
+            gtk_menu_reorder_child (GTK_MENU (menu), gtk_menu_item, position);
+
+          /* the menu may already be visible, so nobody else will show the item */
+          gtk_widget_show_all (gtk_menu_item);
+        }
+
+      /* setting the id for reordering elements by ThunarContextMenuOrderModel */
+      g_object_get (lp_item->data, "name", &name, NULL);
+      if (name != NULL)
+        g_object_set_data_full (G_OBJECT (gtk_menu_item), "id", g_strdup_printf ("custom-action-%s", name), (GDestroyNotify) g_free);
+      else
+        g_object_set_data (G_OBJECT (gtk_menu_item), "id", "custom-action-unnamed");
+      g_free (name);
+
+      /* Each thunarx_menu_item will be destroyed together with its related gtk_menu_item*/
+      g_signal_connect_swapped (G_OBJECT (gtk_menu_item), "destroy", G_CALLBACK (g_object_unref), lp_item->data);
+    }
+
+  return (thunarx_menu_items != NULL);
+}
+
+
+
+static void
+thunar_action_manager_append_deferred_custom_actions (GList   *thunarx_menu_items,
+                                                      gpointer user_data)
+{
+  GtkWidget *anchor = GTK_WIDGET (user_data);
+  GtkWidget *menu = gtk_widget_get_parent (anchor);
+
+  thunar_action_manager_insert_thunarx_menu_items (GTK_MENU_SHELL (menu), thunarx_menu_items, anchor);
+  g_list_free (thunarx_menu_items);
+
+  /* sort the late items like the rest of the menu, otherwise separate them
+   * from the next section if the menu was built without custom actions */
+  if (THUNAR_IS_MENU (menu) && thunar_menu_apply_context_menu_order (THUNAR_MENU (menu)))
+    return;
+  if (g_object_steal_data (G_OBJECT (anchor), "separator-pending") != NULL)
+    gtk_widget_show (anchor);
+}
+
+
+
 /**
  * thunar_action_manager_append_custom_actions:
  * @action_mgr: a #ThunarActionManager instance
  * @menu      : #GtkMenuShell on which the custom actions should be appended
  *
- * Will append all custom actions which match the file-type to the provided #GtkMenuShell
+ * Will append all custom actions which match the file-type to the provided #GtkMenuShell.
+ * The items of slow menu providers are added to the @menu later, after it is shown.
  *
  * Return value: TRUE if any custom action was added
  **/
@@ -2413,14 +2482,11 @@ gboolean
 thunar_action_manager_append_custom_actions (ThunarActionManager *action_mgr,
                                              GtkMenuShell        *menu)
 {
-  gboolean                uca_added = FALSE;
-  GtkWidget              *window;
-  GtkWidget              *gtk_menu_item;
-  ThunarxProviderFactory *provider_factory;
-  GList                  *providers;
-  GList                  *thunarx_menu_items = NULL;
-  GList                  *lp_provider;
-  GList                  *lp_item;
+  gboolean      uca_added;
+  GtkWidget    *window;
+  GtkWidget    *anchor;
+  GCancellable *cancellable;
+  GList        *thunarx_menu_items;
 
   _thunar_return_val_if_fail (THUNAR_IS_ACTION_MANAGER (action_mgr), FALSE);
   _thunar_return_val_if_fail (GTK_IS_MENU (menu), FALSE);
@@ -2432,43 +2498,33 @@ thunar_action_manager_append_custom_actions (ThunarActionManager *action_mgr,
   /* determine the toplevel window we belong to */
   window = gtk_widget_get_toplevel (action_mgr->widget);
 
-  /* load the menu providers from the provider factory */
-  provider_factory = thunarx_provider_factory_get_default ();
-  providers = thunarx_provider_factory_list_providers (provider_factory, THUNARX_TYPE_MENU_PROVIDER);
-  g_object_unref (provider_factory);
+  /* hidden item which marks the position for the items of deferred providers,
+   * the menu keeps it together with the custom actions when it is reordered */
+  anchor = gtk_separator_menu_item_new ();
+  gtk_widget_set_no_show_all (anchor, TRUE);
+  g_object_set_data (G_OBJECT (anchor), "id", "deferred-custom-actions-anchor");
+  gtk_menu_shell_append (menu, anchor);
 
-  if (G_UNLIKELY (providers == NULL))
-    return FALSE;
+  /* stop querying deferred providers once the menu is gone */
+  cancellable = g_cancellable_new ();
+  g_signal_connect_object (G_OBJECT (anchor), "destroy", G_CALLBACK (g_cancellable_cancel), cancellable, G_CONNECT_SWAPPED);
 
   /* load the menu items offered by the menu providers */
-  for (lp_provider = providers; lp_provider != NULL; lp_provider = lp_provider->next)
-    {
-      if (action_mgr->files_are_selected == FALSE)
-        thunarx_menu_items = thunarx_menu_provider_get_folder_menu_items (lp_provider->data, window, THUNARX_FILE_INFO (action_mgr->current_directory));
-      else
-        thunarx_menu_items = thunarx_menu_provider_get_file_menu_items (lp_provider->data, window, action_mgr->files_to_process);
+  if (action_mgr->files_are_selected == FALSE)
+    thunarx_menu_items = thunar_menu_providers_get_items (THUNAR_MENU_PROVIDERS_FOLDER_ITEMS, window, action_mgr->current_directory, NULL,
+                                                          thunar_action_manager_append_deferred_custom_actions, anchor, cancellable);
+  else
+    thunarx_menu_items = thunar_menu_providers_get_items (THUNAR_MENU_PROVIDERS_FILE_ITEMS, window, action_mgr->current_directory, action_mgr->files_to_process,
+                                                          thunar_action_manager_append_deferred_custom_actions, anchor, cancellable);
+  g_object_unref (cancellable);
 
-      for (lp_item = thunarx_menu_items; lp_item != NULL; lp_item = lp_item->next)
-        {
-          gchar *name;
+  uca_added = thunar_action_manager_insert_thunarx_menu_items (menu, thunarx_menu_items, anchor);
+  g_list_free (thunarx_menu_items);
 
-          gtk_menu_item = thunar_gtk_menu_thunarx_menu_item_new (lp_item->data, menu);
+  /* the caller adds no separator behind the custom actions if there are none yet */
+  if (!uca_added)
+    g_object_set_data (G_OBJECT (anchor), "separator-pending", GINT_TO_POINTER (TRUE));
 
-          /* setting the id for reordering elements by ThunarContextMenuOrderModel */
-          g_object_get (lp_item->data, "name", &name, NULL);
-          if (name != NULL)
-            g_object_set_data_full (G_OBJECT (gtk_menu_item), "id", g_strdup_printf ("custom-action-%s", name), (GDestroyNotify) g_free);
-          else
-            g_object_set_data (G_OBJECT (gtk_menu_item), "id", "custom-action-unnamed");
-          g_free (name);
-
-          /* Each thunarx_menu_item will be destroyed together with its related gtk_menu_item*/
-          g_signal_connect_swapped (G_OBJECT (gtk_menu_item), "destroy", G_CALLBACK (g_object_unref), lp_item->data);
-          uca_added = TRUE;
-        }
-      g_list_free (thunarx_menu_items);
-    }
-  g_list_free_full (providers, g_object_unref);
   return uca_added;
 }
 
@@ -2532,46 +2588,33 @@ gboolean
 thunar_action_manager_check_uca_key_activation (ThunarActionManager *action_mgr,
                                                 GdkEventKey         *key_event)
 {
-  GtkWidget              *window;
-  ThunarxProviderFactory *provider_factory;
-  GList                  *providers;
-  GList                  *thunarx_file_menu_items = NULL;
-  GList                  *thunarx_folder_menu_items = NULL;
-  GList                  *lp_provider;
-  gboolean                matching_uca_shortcut_found = FALSE;
+  GtkWidget *window;
+  GList     *thunarx_file_menu_items;
+  GList     *thunarx_folder_menu_items;
+  gboolean   matching_uca_shortcut_found = FALSE;
 
   /* determine the toplevel window we belong to */
   window = gtk_widget_get_toplevel (action_mgr->widget);
 
-  /* load the menu providers from the provider factory */
-  provider_factory = thunarx_provider_factory_get_default ();
-  providers = thunarx_provider_factory_list_providers (provider_factory, THUNARX_TYPE_MENU_PROVIDER);
-  g_object_unref (provider_factory);
+  /* load the menu items offered by the menu providers, this runs on every key press,
+   * so the items are usually taken from the cache */
+  thunarx_file_menu_items = thunar_menu_providers_get_items (THUNAR_MENU_PROVIDERS_FILE_ITEMS, window, action_mgr->current_directory, action_mgr->files_to_process, NULL, NULL, NULL);
+  thunarx_folder_menu_items = thunar_menu_providers_get_items (THUNAR_MENU_PROVIDERS_FOLDER_ITEMS, window, action_mgr->current_directory, NULL, NULL, NULL, NULL);
 
-  if (G_UNLIKELY (providers == NULL))
-    return matching_uca_shortcut_found;
+  /* check if we processed the shortcut successfully */
+  matching_uca_shortcut_found |= _thunar_action_manager_check_uca_key_activation_for_menu_items (thunarx_file_menu_items, key_event, FALSE);
+  matching_uca_shortcut_found |= _thunar_action_manager_check_uca_key_activation_for_menu_items (thunarx_folder_menu_items, key_event, FALSE);
 
-  /* load the menu items offered by the menu providers */
-  for (lp_provider = providers; lp_provider != NULL; lp_provider = lp_provider->next)
-    {
-      thunarx_file_menu_items = thunarx_menu_provider_get_file_menu_items (lp_provider->data, window, action_mgr->files_to_process);
-      thunarx_folder_menu_items = thunarx_menu_provider_get_folder_menu_items (lp_provider->data, window, THUNARX_FILE_INFO (action_mgr->current_directory));
+  if (action_mgr->files_are_selected)
+    _thunar_action_manager_check_uca_key_activation_for_menu_items (thunarx_file_menu_items, key_event, TRUE);
+  else
+    _thunar_action_manager_check_uca_key_activation_for_menu_items (thunarx_folder_menu_items, key_event, TRUE);
 
-      /* check if we processed the shortcut successfully */
-      matching_uca_shortcut_found |= _thunar_action_manager_check_uca_key_activation_for_menu_items (thunarx_file_menu_items, key_event, FALSE);
-      matching_uca_shortcut_found |= _thunar_action_manager_check_uca_key_activation_for_menu_items (thunarx_folder_menu_items, key_event, FALSE);
+  if (thunarx_file_menu_items != NULL)
+    thunarx_menu_item_list_free (thunarx_file_menu_items);
+  if (thunarx_folder_menu_items != NULL)
+    thunarx_menu_item_list_free (thunarx_folder_menu_items);
 
-      if (action_mgr->files_are_selected)
-        _thunar_action_manager_check_uca_key_activation_for_menu_items (thunarx_file_menu_items, key_event, TRUE);
-      else
-        _thunar_action_manager_check_uca_key_activation_for_menu_items (thunarx_folder_menu_items, key_event, TRUE);
-
-      if (thunarx_file_menu_items != NULL)
-        thunarx_menu_item_list_free (thunarx_file_menu_items);
-      if (thunarx_folder_menu_items != NULL)
-        thunarx_menu_item_list_free (thunarx_folder_menu_items);
-    }
-  g_list_free_full (providers, g_object_unref);
   return matching_uca_shortcut_found;
 }
 
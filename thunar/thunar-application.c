@@ -54,6 +54,7 @@
 #include "thunar/thunar-browser.h"
 #include "thunar/thunar-dbus-service.h"
 #include "thunar/thunar-dialogs.h"
+#include "thunar/thunar-folder-snapshot.h"
 #include "thunar/thunar-gdk-extensions.h"
 #include "thunar/thunar-gobject-extensions.h"
 #include "thunar/thunar-gtk-extensions.h"
@@ -161,6 +162,8 @@ thunar_application_dbus_register (GApplication    *application,
 static void
 thunar_application_load_css (void);
 static void
+thunar_application_folder_snapshots_changed (ThunarApplication *application);
+static void
 thunar_application_accel_map_changed (ThunarApplication *application);
 static gboolean
 thunar_application_accel_map_save (gpointer user_data);
@@ -243,8 +246,9 @@ struct _ThunarApplication
   ThunarPreferences *preferences;
   GtkWidget         *progress_dialog;
 
-  ThunarThumbnailCache *thumbnail_cache;
-  ThunarThumbnailer    *thumbnailer;
+  ThunarThumbnailCache  *thumbnail_cache;
+  ThunarThumbnailer     *thumbnailer;
+  ThunarTrashAccounting *trash_accounting;
 
   ThunarDBusService *dbus_service;
 
@@ -433,6 +437,8 @@ thunar_application_startup (GApplication *gapp)
 
   /* initialize the application */
   application->preferences = thunar_preferences_get ();
+  g_signal_connect_swapped (G_OBJECT (application->preferences), "notify::misc-folder-snapshots",
+                            G_CALLBACK (thunar_application_folder_snapshots_changed), application);
 
 #ifdef HAVE_GUDEV
   /* establish connection with udev */
@@ -522,7 +528,12 @@ thunar_application_shutdown (GApplication *gapp)
   if (application->thumbnail_cache != NULL)
     g_object_unref (G_OBJECT (application->thumbnail_cache));
 
+  /* release the trash accounting */
+  if (application->trash_accounting != NULL)
+    g_object_unref (G_OBJECT (application->trash_accounting));
+
   /* disconnect from the preferences */
+  g_signal_handlers_disconnect_by_func (G_OBJECT (application->preferences), thunar_application_folder_snapshots_changed, application);
   g_object_unref (G_OBJECT (application->preferences));
 
   /* disconnect from the session manager */
@@ -746,6 +757,19 @@ thunar_application_dbus_register (GApplication    *gapp,
 
 
 
+static void
+thunar_application_folder_snapshots_changed (ThunarApplication *application)
+{
+  gboolean folder_snapshots;
+
+  /* don't keep the contents of folders on disk once the user opted out */
+  g_object_get (G_OBJECT (application->preferences), "misc-folder-snapshots", &folder_snapshots, NULL);
+  if (!folder_snapshots)
+    thunar_folder_snapshot_clear ();
+}
+
+
+
 static void
 thunar_application_load_css (void)
 {
@@ -911,45 +935,6 @@ thunar_application_accel_map_changed (ThunarApplication *application)
   g_list_free (windows);
 }
 
-/**
- * thunar_application_drop_descendant_files_from_list:
- * @list : a #GList of #GFile<!---->s
- *
- * Delete all #GFile<!---->s from the list, which are contained in any directory that is also on the list (and unref them)
- *
- * Returns: the (possibly changed) start of the #GList.
- */
-static GList *
-thunar_application_drop_descendant_files_from_list (GList *list)
-{
-  GList *lp1, *lp2, *next2;
-  GFile *f1, *f2;
-  for (lp1 = list; lp1 != NULL; lp1 = lp1->next)
-    {
-      for (lp2 = list; lp2 != NULL; lp2 = next2)
-        {
-          next2 = lp2->next;
-          if (G_LIKELY (lp1 != lp2))
-            {
-              f1 = G_FILE (lp1->data);
-              f2 = G_FILE (lp2->data);
-              if (G_UNLIKELY (thunar_g_file_is_descendant (f2, f1)))
-                {
-                  gchar *f1_basename = g_file_get_basename (f1);
-                  gchar *f2_basename = g_file_get_basename (f2);
-                  g_info ("The file '%s' was dropped from the file operation, because it is located in the directory '%s', which is already part of the operation.", f2_basename, f1_basename);
-                  g_free (f1_basename);
-                  g_free (f2_basename);
-
-                  g_object_unref (lp2->data);
-                  list = g_list_delete_link (list, lp2);
-                }
-            }
-        }
-    }
-  return list;
-}
-
 static void
 thunar_application_collect_and_launch (ThunarApplication     *application,
                                        gpointer               parent,
@@ -2452,7 +2437,7 @@ thunar_application_copy_into (ThunarApplication     *application,
   g_free (display_name);
 
   /* Duplicates will be created when the parent of a file is copied in the same operation. Sort out such files. */
-  source_file_list = thunar_application_drop_descendant_files_from_list (source_file_list);
+  source_file_list = thunar_g_file_list_drop_descendants (source_file_list);
 
   /* collect the target files and launch the job */
   thunar_application_collect_and_launch (application, parent, "edit-copy",
@@ -2511,7 +2496,7 @@ thunar_application_link_into (ThunarApplication     *application,
   g_free (display_name);
 
   /* Duplicates will be created when the parent of a file is linked in the same operation. Sort out such files. */
-  source_file_list = thunar_application_drop_descendant_files_from_list (source_file_list);
+  source_file_list = thunar_g_file_list_drop_descendants (source_file_list);
 
   /* collect the target files and launch the job */
   thunar_application_collect_and_launch (application, parent, "insert-link",
@@ -2593,7 +2578,7 @@ thunar_application_move_into (ThunarApplication     *application,
   else
     {
       /* Errors will occur if the parent of a file is moved in the same operation. Sort out such files. */
-      source_file_list = thunar_application_drop_descendant_files_from_list (source_file_list);
+      source_file_list = thunar_g_file_list_drop_descendants (source_file_list);
 
       /* generate a title for the progress dialog */
       display_name = thunar_file_cached_display_name (target_file);
@@ -2805,7 +2790,7 @@ thunar_application_unlink_files (ThunarApplication     *application,
     return FALSE;
 
   /* Errors will occur if the parent of a file is deleted in the same operation. Sort out such files. */
-  path_list = thunar_application_drop_descendant_files_from_list (path_list);
+  path_list = thunar_g_file_list_drop_descendants (path_list);
 
   operation_canceled = !_thunar_application_confirm_file_removal (parent, path_list, n_path_list, TRUE);
   if (G_LIKELY (!operation_canceled))
@@ -2861,7 +2846,7 @@ thunar_application_trash_files (ThunarApplication     *application,
     return FALSE;
 
   /* Errors will occur if the parent of a file is trashed in the same operation. Sort out such files. */
-  path_list = thunar_application_drop_descendant_files_from_list (path_list);
+  path_list = thunar_g_file_list_drop_descendants (path_list);
 
   g_object_get (G_OBJECT (application->preferences), "misc-confirm-move-to-trash", &warn, NULL);
   if (G_UNLIKELY (warn))
@@ -2981,10 +2966,14 @@ thunar_application_empty_trash (ThunarApplication *application,
                                 gpointer           parent,
                                 const gchar       *startup_id)
 {
-  GtkWidget *dialog;
-  GtkWindow *window;
-  GList      file_list;
-  gint       response;
+  ThunarTrashAccounting *accounting;
+  GtkWidget             *dialog;
+  GtkWindow             *window;
+  GList                  file_list;
+  gint                   response;
+  guint64                n_items;
+  guint64                size;
+  gchar                 *size_string;
 
   _thunar_return_if_fail (THUNAR_IS_APPLICATION (application));
   _thunar_return_if_fail (parent == NULL || GDK_IS_SCREEN (parent) || GTK_IS_WIDGET (parent));
@@ -3011,9 +3000,29 @@ thunar_application_empty_trash (ThunarApplication *application,
                             _("_Empty Trash"), GTK_RESPONSE_YES,
                           NULL);
   gtk_dialog_set_default_response (GTK_DIALOG (dialog), GTK_RESPONSE_YES);
-  gtk_message_dialog_format_secondary_text (GTK_MESSAGE_DIALOG (dialog),
-                                            _("If you choose to empty the Trash, all items in it will be permanently lost. "
-                                              "Please note that you can also delete them separately."));
+
+  /* tell the user how much is going to be deleted, if the trash was measured already */
+  accounting = thunar_application_get_trash_accounting (application);
+  if (!thunar_trash_accounting_get_usage (accounting, &n_items, &size))
+    {
+      gtk_message_dialog_format_secondary_text (GTK_MESSAGE_DIALOG (dialog),
+                                                _("If you choose to empty the Trash, all items in it will be permanently lost. "
+                                                  "Please note that you can also delete them separately."));
+    }
+  else
+    {
+      size_string = g_format_size (size);
+      gtk_message_dialog_format_secondary_text (GTK_MESSAGE_DIALOG (dialog),
+                                                ngettext ("The %" G_GUINT64_FORMAT " item in the Trash (%s) will be permanently lost. "
+                                                          "Please note that you can also delete items separately.",
+                                                          "All %" G_GUINT64_FORMAT " items in the Trash (%s) will be permanently lost. "
+                                                          "Please note that you can also delete them separately.",
+                                                          n_items),
+                                                n_items, size_string);
+      g_free (size_string);
+    }
+  g_object_unref (accounting);
+
   response = gtk_dialog_run (GTK_DIALOG (dialog));
   gtk_widget_destroy (dialog);
 
@@ -3136,6 +3145,30 @@ thunar_application_get_thumbnail_cache (ThunarApplication *application)
 
 
 
+/**
+ * thunar_application_get_trash_accounting:
+ * @application : a #ThunarApplication.
+ *
+ * Returns the #ThunarTrashAccounting, which is kept alive by the
+ * @application once it was requested, so the trash is only measured
+ * once. The caller is responsible to free the returned object using
+ * g_object_unref() when no longer needed.
+ *
+ * Return value: the #ThunarTrashAccounting.
+ **/
+ThunarTrashAccounting *
+thunar_application_get_trash_accounting (ThunarApplication *application)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_APPLICATION (application), NULL);
+
+  if (application->trash_accounting == NULL)
+    application->trash_accounting = thunar_trash_accounting_get ();
+
+  return g_object_ref (application->trash_accounting);
+}
+
+
+
 static gboolean
 thunar_application_malloc_trim_idle (gpointer application_ptr)
 {
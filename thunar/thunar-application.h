@@ -25,6 +25,7 @@
 
 #include "thunar/thunar-job-operation.h"
 #include "thunar/thunar-thumbnail-cache.h"
+#include "thunar/thunar-trash-accounting.h"
 #include "thunar/thunar-window.h"
 
 #include <gio/gio.h>
@@ -203,6 +204,9 @@ thunar_application_restore_files (ThunarApplication *application,
 ThunarThumbnailCache *
 thunar_application_get_thumbnail_cache (ThunarApplication *application);
 
+ThunarTrashAccounting *
+thunar_application_get_trash_accounting (ThunarApplication *application);
+
 gboolean
 thunar_application_accel_map_init (ThunarApplication *application);
 
@@ -57,6 +57,7 @@ enum
   TARGET_TEXT_URI_LIST,
   TARGET_GNOME_COPIED_FILES,
   TARGET_UTF8_STRING,
+  N_TARGETS,
 };
 
 
@@ -74,6 +75,8 @@ static void
 thunar_clipboard_manager_file_destroyed (ThunarFile             *file,
                                          ThunarClipboardManager *manager);
 static void
+thunar_clipboard_manager_release_files (ThunarClipboardManager *manager);
+static void
 thunar_clipboard_manager_owner_changed (GtkClipboard           *clipboard,
                                         GdkEventOwnerChange    *event,
                                         ThunarClipboardManager *manager);
@@ -120,8 +123,12 @@ struct _ThunarClipboardManager
   GdkAtom       x_special_gnome_copied_files;
   GdkAtom       image_target; /* NULL except when there is a image that can be pasted */
 
-  gboolean files_cutted;
-  GList   *files;
+  gboolean    files_cutted;
+  GList      *files;
+  GHashTable *files_links; /* ThunarFile -> its link in files */
+
+  /* serialized files per target, built on demand */
+  GBytes *targets_data[N_TARGETS];
 };
 
 typedef struct
@@ -197,6 +204,7 @@ thunar_clipboard_manager_init (ThunarClipboardManager *manager)
 {
   manager->x_special_gnome_copied_files = gdk_atom_intern_static_string ("x-special/gnome-copied-files");
   manager->image_target = NULL;
+  manager->files_links = g_hash_table_new (g_direct_hash, g_direct_equal);
 }
 
 
@@ -226,15 +234,10 @@ static void
 thunar_clipboard_manager_finalize (GObject *object)
 {
   ThunarClipboardManager *manager = THUNAR_CLIPBOARD_MANAGER (object);
-  GList                  *lp;
 
   /* release any pending files */
-  for (lp = manager->files; lp != NULL; lp = lp->next)
-    {
-      g_signal_handlers_disconnect_by_func (G_OBJECT (lp->data), thunar_clipboard_manager_file_destroyed, manager);
-      g_object_unref (G_OBJECT (lp->data));
-    }
-  g_list_free (manager->files);
+  thunar_clipboard_manager_release_files (manager);
+  g_hash_table_destroy (manager->files_links);
 
   /* disconnect from the clipboard */
   g_signal_handlers_disconnect_by_func (G_OBJECT (manager->clipboard), thunar_clipboard_manager_owner_changed, manager);
@@ -268,18 +271,56 @@ thunar_clipboard_manager_get_property (GObject    *object,
 
 
 
+static void
+thunar_clipboard_manager_invalidate_targets (ThunarClipboardManager *manager)
+{
+  guint n;
+
+  for (n = 0; n < N_TARGETS; ++n)
+    g_clear_pointer (&manager->targets_data[n], g_bytes_unref);
+}
+
+
+
+static void
+thunar_clipboard_manager_release_files (ThunarClipboardManager *manager)
+{
+  GList *lp;
+
+  for (lp = manager->files; lp != NULL; lp = lp->next)
+    {
+      g_signal_handlers_disconnect_by_func (G_OBJECT (lp->data), thunar_clipboard_manager_file_destroyed, manager);
+      g_signal_handlers_disconnect_by_func (G_OBJECT (lp->data), thunar_clipboard_manager_invalidate_targets, manager);
+      g_object_unref (G_OBJECT (lp->data));
+    }
+  g_list_free (manager->files);
+  manager->files = NULL;
+
+  g_hash_table_remove_all (manager->files_links);
+  thunar_clipboard_manager_invalidate_targets (manager);
+}
+
+
+
 static void
 thunar_clipboard_manager_file_destroyed (ThunarFile             *file,
                                          ThunarClipboardManager *manager)
 {
+  GList *link;
+
   _thunar_return_if_fail (THUNAR_IS_CLIPBOARD_MANAGER (manager));
-  _thunar_return_if_fail (g_list_find (manager->files, file) != NULL);
+
+  link = g_hash_table_lookup (manager->files_links, file);
+  _thunar_return_if_fail (link != NULL);
 
   /* remove the file from our list */
-  manager->files = g_list_remove (manager->files, file);
+  manager->files = g_list_delete_link (manager->files, link);
+  g_hash_table_remove (manager->files_links, file);
+  thunar_clipboard_manager_invalidate_targets (manager);
 
   /* disconnect from the file */
   g_signal_handlers_disconnect_by_func (G_OBJECT (file), thunar_clipboard_manager_file_destroyed, manager);
+  g_signal_handlers_disconnect_by_func (G_OBJECT (file), thunar_clipboard_manager_invalidate_targets, manager);
   g_object_unref (G_OBJECT (file));
 }
 
@@ -502,37 +543,38 @@ thunar_clipboard_manager_targets_received (GtkClipboard     *clipboard,
 
 
 
-static gchar *
-thunar_clipboard_manager_g_file_list_to_string (GList       *list,
-                                                const gchar *prefix,
-                                                gboolean     format_for_text,
-                                                gsize       *len)
+static GBytes *
+thunar_clipboard_manager_build_target (ThunarClipboardManager *manager,
+                                       guint                   target_info)
 {
-  GString *string;
-  gchar   *tmp;
-  GList   *lp;
+  const gchar *separator;
+  GString     *string;
+  gchar       *tmp;
+  GList       *lp;
 
-  /* allocate initial string */
-  string = g_string_new (prefix);
+  if (target_info == TARGET_GNOME_COPIED_FILES)
+    string = g_string_new (manager->files_cutted ? "cut\n" : "copy\n");
+  else
+    string = g_string_new (NULL);
+
+  /* text/uri-list terminates every line, the other targets only separate them */
+  separator = (target_info == TARGET_TEXT_URI_LIST) ? "\r\n" : "\n";
 
-  for (lp = list; lp != NULL; lp = lp->next)
+  for (lp = manager->files; lp != NULL; lp = lp->next)
     {
-      if (format_for_text)
-        tmp = g_file_get_parse_name (G_FILE (lp->data));
+      if (target_info == TARGET_UTF8_STRING)
+        tmp = g_file_get_parse_name (thunar_file_get_file (lp->data));
       else
-        tmp = g_file_get_uri (G_FILE (lp->data));
+        tmp = g_file_get_uri (thunar_file_get_file (lp->data));
 
       string = g_string_append (string, tmp);
       g_free (tmp);
 
-      if (lp->next != NULL)
-        string = g_string_append_c (string, '\n');
+      if (lp->next != NULL || target_info == TARGET_TEXT_URI_LIST)
+        string = g_string_append (string, separator);
     }
 
-  if (len != NULL)
-    *len = string->len;
-
-  return g_string_free (string, FALSE);
+  return g_string_free_to_bytes (string);
 }
 
 
@@ -544,46 +586,34 @@ thunar_clipboard_manager_get_callback (GtkClipboard     *clipboard,
                                        gpointer          user_data)
 {
   ThunarClipboardManager *manager = THUNAR_CLIPBOARD_MANAGER (user_data);
-  GList                  *file_list;
-  gchar                  *str;
-  gchar                 **uris;
-  const gchar            *prefix;
+  const guchar           *data;
   gsize                   len;
 
   _thunar_return_if_fail (GTK_IS_CLIPBOARD (clipboard));
   _thunar_return_if_fail (THUNAR_IS_CLIPBOARD_MANAGER (manager));
   _thunar_return_if_fail (manager->clipboard == clipboard);
+  _thunar_return_if_fail (target_info < N_TARGETS);
+
+  /* serialize the files only once per target, paste targets tend to query them often */
+  if (manager->targets_data[target_info] == NULL)
+    manager->targets_data[target_info] = thunar_clipboard_manager_build_target (manager, target_info);
 
-  /* determine the path list from the file list */
-  file_list = thunar_file_list_to_thunar_g_file_list (manager->files);
+  data = g_bytes_get_data (manager->targets_data[target_info], &len);
 
   switch (target_info)
     {
     case TARGET_TEXT_URI_LIST:
-      uris = thunar_g_file_list_to_stringv (file_list);
-      gtk_selection_data_set_uris (selection_data, uris);
-      g_strfreev (uris);
-      break;
-
     case TARGET_GNOME_COPIED_FILES:
-      prefix = manager->files_cutted ? "cut\n" : "copy\n";
-      str = thunar_clipboard_manager_g_file_list_to_string (file_list, prefix, FALSE, &len);
-      gtk_selection_data_set (selection_data, gtk_selection_data_get_target (selection_data), 8, (guchar *) str, len);
-      g_free (str);
+      gtk_selection_data_set (selection_data, gtk_selection_data_get_target (selection_data), 8, data, len);
       break;
 
     case TARGET_UTF8_STRING:
-      str = thunar_clipboard_manager_g_file_list_to_string (file_list, NULL, TRUE, &len);
-      gtk_selection_data_set_text (selection_data, str, len);
-      g_free (str);
+      gtk_selection_data_set_text (selection_data, (const gchar *) data, len);
       break;
 
     default:
       _thunar_assert_not_reached ();
     }
-
-  /* cleanup */
-  thunar_g_list_free_full (file_list);
 }
 
 
@@ -593,20 +623,13 @@ thunar_clipboard_manager_clear_callback (GtkClipboard *clipboard,
                                          gpointer      user_data)
 {
   ThunarClipboardManager *manager = THUNAR_CLIPBOARD_MANAGER (user_data);
-  GList                  *lp;
 
   _thunar_return_if_fail (GTK_IS_CLIPBOARD (clipboard));
   _thunar_return_if_fail (THUNAR_IS_CLIPBOARD_MANAGER (manager));
   _thunar_return_if_fail (manager->clipboard == clipboard);
 
   /* release the pending files */
-  for (lp = manager->files; lp != NULL; lp = lp->next)
-    {
-      g_signal_handlers_disconnect_by_func (G_OBJECT (lp->data), thunar_clipboard_manager_file_destroyed, manager);
-      g_object_unref (G_OBJECT (lp->data));
-    }
-  g_list_free (manager->files);
-  manager->files = NULL;
+  thunar_clipboard_manager_release_files (manager);
 }
 
 
@@ -620,22 +643,25 @@ thunar_clipboard_manager_transfer_files (ThunarClipboardManager *manager,
   GList      *lp;
 
   /* release any pending files */
-  for (lp = manager->files; lp != NULL; lp = lp->next)
-    {
-      g_signal_handlers_disconnect_by_func (G_OBJECT (lp->data), thunar_clipboard_manager_file_destroyed, manager);
-      g_object_unref (G_OBJECT (lp->data));
-    }
-  g_list_free (manager->files);
+  thunar_clipboard_manager_release_files (manager);
 
   /* remember the transfer operation */
   manager->files_cutted = !copy;
 
   /* setup the new file list */
-  for (lp = g_list_last (files), manager->files = NULL; lp != NULL; lp = lp->prev)
+  for (lp = g_list_last (files); lp != NULL; lp = lp->prev)
     {
+      /* skip duplicates, so each file has exactly one link */
+      if (g_hash_table_contains (manager->files_links, lp->data))
+        continue;
+
       file = THUNAR_FILE (g_object_ref (G_OBJECT (lp->data)));
       manager->files = g_list_prepend (manager->files, file);
+      g_hash_table_insert (manager->files_links, file, manager->files);
       g_signal_connect (G_OBJECT (file), "destroy", G_CALLBACK (thunar_clipboard_manager_file_destroyed), manager);
+
+      /* the serialized targets contain the file's location, which changes on rename or move */
+      g_signal_connect_swapped (G_OBJECT (file), "renamed", G_CALLBACK (thunar_clipboard_manager_invalidate_targets), manager);
     }
 
   /* acquire the CLIPBOARD ownership */
@@ -740,7 +766,7 @@ thunar_clipboard_manager_has_cutted_file (ThunarClipboardManager *manager,
   _thunar_return_val_if_fail (THUNAR_IS_CLIPBOARD_MANAGER (manager), FALSE);
   _thunar_return_val_if_fail (THUNAR_IS_FILE (file), FALSE);
 
-  return (manager->files_cutted && g_list_find (manager->files, file) != NULL);
+  return (manager->files_cutted && g_hash_table_contains (manager->files_links, file));
 }
 
 
@@ -18,6 +18,7 @@
  */
 
 #include "thunar/thunar-compact-view.h"
+#include "thunar/thunar-grid-view.h"
 
 #include <libxfce4ui/libxfce4ui.h>
 
@@ -75,9 +76,9 @@ thunar_compact_view_init (ThunarCompactView *compact_view)
   gboolean max_chars;
 
   /* initialize the icon view properties */
-  xfce_icon_view_set_margin (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (compact_view))), 3);
-  xfce_icon_view_set_layout_mode (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (compact_view))), XFCE_ICON_VIEW_LAYOUT_COLS);
-  xfce_icon_view_set_orientation (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (compact_view))), GTK_ORIENTATION_HORIZONTAL);
+  thunar_grid_view_set_margin (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (compact_view))), 3);
+  thunar_grid_view_set_layout_mode (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (compact_view))), THUNAR_GRID_VIEW_LAYOUT_COLS);
+  thunar_grid_view_set_orientation (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (compact_view))), GTK_ORIENTATION_HORIZONTAL);
 
   /* setup the icon renderer */
   g_object_set (G_OBJECT (THUNAR_STANDARD_VIEW (compact_view)->icon_renderer),
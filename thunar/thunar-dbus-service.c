@@ -19,6 +19,9 @@
  * Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
 #ifdef HAVE_MEMORY_H
 #include <memory.h>
 #endif
@@ -31,10 +34,12 @@
 #include "thunar/thunar-dbus-service.h"
 #include "thunar/thunar-file.h"
 #include "thunar/thunar-gdk-extensions.h"
+#include "thunar/thunar-io-jobs.h"
 #include "thunar/thunar-preferences-dialog.h"
 #include "thunar/thunar-preferences.h"
 #include "thunar/thunar-private.h"
 #include "thunar/thunar-properties-dialog.h"
+#include "thunar/thunar-trash-accounting.h"
 #include "thunar/thunar-util.h"
 
 #include <glib/gstdio.h>
@@ -56,12 +61,46 @@ typedef enum
   THUNAR_DBUS_TRANSFER_MODE_LINK_INTO,
 } ThunarDBusTransferMode;
 
+/* the kinds of operations accepted by SubmitOperations, see operation_kinds */
+typedef enum
+{
+  THUNAR_DBUS_OPERATION_COPY_TO,
+  THUNAR_DBUS_OPERATION_COPY_INTO,
+  THUNAR_DBUS_OPERATION_MOVE_INTO,
+  THUNAR_DBUS_OPERATION_LINK_INTO,
+  THUNAR_DBUS_OPERATION_UNLINK,
+  THUNAR_DBUS_OPERATION_TRASH,
+} ThunarDBusOperationKind;
+
+/* how SubmitOperations handles existing files, see conflict_policies */
+typedef enum
+{
+  THUNAR_DBUS_CONFLICT_SKIP,
+  THUNAR_DBUS_CONFLICT_OVERWRITE,
+  THUNAR_DBUS_CONFLICT_RENAME,
+  THUNAR_DBUS_CONFLICT_CANCEL,
+} ThunarDBusConflictPolicy;
+
+typedef struct _ThunarDBusServiceOperation ThunarDBusServiceOperation;
+
+/* the default and the smallest minimum time between two Progress signals of an operation, in ms */
+#define OPERATION_PROGRESS_INTERVAL     (250)
+#define OPERATION_PROGRESS_INTERVAL_MIN (50)
+
+/* the time a finished operation stays on the bus, in seconds */
+#define OPERATION_LINGER_TIME (60)
+
+/* the time QueryTrashUsage waits for slow volumes, before it answers with the trash measured so far, in seconds */
+#define TRASH_USAGE_TIMEOUT (2)
+
 
 static void
 thunar_dbus_service_finalize (GObject *object);
 static gboolean
 thunar_dbus_service_connect_trash_bin (ThunarDBusService *dbus_service,
                                        GError           **error);
+static void
+thunar_dbus_service_connect_trash_accounting (ThunarDBusService *dbus_service);
 static gboolean
 thunar_dbus_service_parse_uri_and_display (ThunarDBusService *dbus_service,
                                            const gchar       *uri,
@@ -157,6 +196,16 @@ thunar_dbus_service_query_trash (ThunarDBusTrash       *object,
                                  GDBusMethodInvocation *invocation,
                                  ThunarDBusService     *dbus_service);
 static gboolean
+thunar_dbus_service_query_trash_usage (ThunarDBusTrash       *object,
+                                       GDBusMethodInvocation *invocation,
+                                       ThunarDBusService     *dbus_service);
+static void
+thunar_dbus_service_trash_accounting_changed (ThunarDBusService *dbus_service);
+static void
+thunar_dbus_service_answer_trash_usage (ThunarDBusService *dbus_service);
+static gboolean
+thunar_dbus_service_trash_usage_timeout (gpointer user_data);
+static gboolean
 thunar_dbus_service_bulk_rename (ThunarDBusThunar      *object,
                                  GDBusMethodInvocation *invocation,
                                  const gchar           *working_directory,
@@ -241,6 +290,77 @@ thunar_dbus_service_unlink_files (ThunarDBusFileManager *object,
                                   const gchar           *startup_id,
                                   ThunarDBusService     *dbus_service);
 static gboolean
+thunar_dbus_service_submit_operations (ThunarDBusFileManager *object,
+                                       GDBusMethodInvocation *invocation,
+                                       const gchar           *working_directory,
+                                       GVariant              *operations,
+                                       GVariant              *options,
+                                       ThunarDBusService     *dbus_service);
+static gboolean
+thunar_dbus_service_parse_filenames (const gchar *const *filenames,
+                                     GList             **file_list,
+                                     GError            **error);
+static gint
+thunar_dbus_service_lookup_name (const gchar *const *names,
+                                 const gchar        *name);
+static ThunarDBusServiceOperation *
+thunar_dbus_service_operation_new (ThunarDBusService       *dbus_service,
+                                   const gchar             *kind_name,
+                                   const gchar *const      *source_filenames,
+                                   const gchar *const      *target_filenames,
+                                   ThunarDBusConflictPolicy conflict,
+                                   guint                    progress_interval,
+                                   GError                 **error);
+static void
+thunar_dbus_service_operation_free (gpointer data);
+static void
+thunar_dbus_service_operation_release (ThunarDBusServiceOperation *operation);
+static gboolean
+thunar_dbus_service_operation_cancel (ThunarDBusOperation        *object,
+                                      GDBusMethodInvocation      *invocation,
+                                      ThunarDBusServiceOperation *operation);
+static void
+thunar_dbus_service_operation_started (ThunarDBusServiceOperation *operation);
+static void
+thunar_dbus_service_operation_add_error (ThunarDBusServiceOperation *operation,
+                                         GFile                      *file,
+                                         const gchar                *message);
+static ThunarJobResponse
+thunar_dbus_service_operation_resolve_conflict (ThunarDBusServiceOperation *operation,
+                                                ThunarJobResponse           choices,
+                                                gboolean                    is_directory);
+static void
+thunar_dbus_service_operation_info_message (ThunarJob                  *job,
+                                            const gchar                *message,
+                                            ThunarDBusServiceOperation *operation);
+static void
+thunar_dbus_service_operation_percent (ThunarJob                  *job,
+                                       gdouble                     percent,
+                                       ThunarDBusServiceOperation *operation);
+static gboolean
+thunar_dbus_service_operation_progress_timeout (gpointer user_data);
+static void
+thunar_dbus_service_operation_emit_progress (ThunarDBusServiceOperation *operation);
+static ThunarJobResponse
+thunar_dbus_service_operation_ask (ThunarJob                  *job,
+                                   const gchar                *message,
+                                   ThunarJobResponse           choices,
+                                   ThunarDBusServiceOperation *operation);
+static ThunarJobResponse
+thunar_dbus_service_operation_ask_for_action (ThunarJob                  *job,
+                                              ThunarFile                 *source_file,
+                                              ThunarFile                 *target_file,
+                                              ThunarDBusServiceOperation *operation);
+static void
+thunar_dbus_service_operation_error (ThunarJob                  *job,
+                                     GError                     *error,
+                                     ThunarDBusServiceOperation *operation);
+static void
+thunar_dbus_service_operation_finished (ThunarJob                  *job,
+                                        ThunarDBusServiceOperation *operation);
+static gboolean
+thunar_dbus_service_operation_linger_timeout (gpointer user_data);
+static gboolean
 thunar_dbus_service_terminate (ThunarDBusThunar      *object,
                                GDBusMethodInvocation *invocation,
                                ThunarDBusService     *dbus_service);
@@ -280,6 +400,63 @@ struct _ThunarDBusService
   ThunarOrgFreedesktopFileManager1 *file_manager_fdo;
 
   ThunarFile *trash_bin;
+
+  /* counts the items in the trash, and the QueryTrashUsage calls waiting for it */
+  ThunarTrashAccounting *trash_accounting;
+  GSList                *trash_usage_invocations;
+  guint                  trash_usage_timer_id;
+
+  /* the operations queued with SubmitOperations, by object path */
+  GHashTable *operations;
+  guint       next_operation_id;
+};
+
+struct _ThunarDBusServiceOperation
+{
+  ThunarDBusService   *dbus_service;
+  ThunarDBusOperation *skeleton;
+  gchar               *object_path;
+  ThunarJob           *job;
+  gboolean             finished;
+
+  /* the application is held while the job runs */
+  gboolean held;
+
+  /* answers the questions of the job */
+  ThunarDBusConflictPolicy conflict;
+
+  /* the items which failed, reported by the Finished signal */
+  GVariantBuilder errors;
+  guint           n_errors;
+  gboolean        failed;
+
+  /* the Progress signal is emitted at most once per progress_interval */
+  gdouble  percent;
+  gboolean percent_pending;
+  guint    progress_interval;
+  guint    progress_timer_id;
+
+  guint linger_timer_id;
+};
+
+
+
+static const gchar *const operation_kinds[] = {
+  "copy-to",
+  "copy-into",
+  "move-into",
+  "link-into",
+  "unlink",
+  "trash",
+  NULL,
+};
+
+static const gchar *const conflict_policies[] = {
+  "skip",
+  "overwrite",
+  "rename",
+  "cancel",
+  NULL,
 };
 
 
@@ -330,6 +507,7 @@ thunar_dbus_service_init (ThunarDBusService *dbus_service)
   dbus_service->trash = thunar_dbus_trash_skeleton_new ();
   dbus_service->thunar = thunar_dbus_thunar_skeleton_new ();
   dbus_service->file_manager_fdo = thunar_org_freedesktop_file_manager1_skeleton_new ();
+  dbus_service->operations = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, thunar_dbus_service_operation_free);
 
   connect_signals_multiple (dbus_service->file_manager, dbus_service,
                             "handle-display-application-chooser-dialog", thunar_dbus_service_display_app_chooser_dialog,
@@ -348,6 +526,7 @@ thunar_dbus_service_init (ThunarDBusService *dbus_service)
                             "handle-rename-file", thunar_dbus_service_rename_file,
                             "handle-create-file", thunar_dbus_service_create_file,
                             "handle-create-file-from-template", thunar_dbus_service_create_file_from_template,
+                            "handle-submit-operations", thunar_dbus_service_submit_operations,
                             NULL);
 
   connect_signals_multiple (dbus_service->trash, dbus_service,
@@ -355,6 +534,7 @@ thunar_dbus_service_init (ThunarDBusService *dbus_service)
                             "handle-empty-trash", thunar_dbus_service_empty_trash,
                             "handle-move-to-trash", thunar_dbus_service_move_to_trash,
                             "handle-query-trash", thunar_dbus_service_query_trash,
+                            "handle-query-trash-usage", thunar_dbus_service_query_trash_usage,
                             NULL);
 
   connect_signals_multiple (dbus_service->thunar, dbus_service,
@@ -374,7 +554,11 @@ thunar_dbus_service_init (ThunarDBusService *dbus_service)
 static void
 thunar_dbus_service_finalize (GObject *object)
 {
-  ThunarDBusService *dbus_service = THUNAR_DBUS_SERVICE (object);
+  ThunarDBusService          *dbus_service = THUNAR_DBUS_SERVICE (object);
+  ThunarDBusServiceOperation *operation;
+  GHashTableIter              iter;
+  GSList                     *lp;
+  gpointer                    value;
 
   g_object_unref (dbus_service->file_manager);
   g_object_unref (dbus_service->trash);
@@ -384,6 +568,37 @@ thunar_dbus_service_finalize (GObject *object)
   if (dbus_service->trash_bin)
     g_object_unref (dbus_service->trash_bin);
 
+  if (dbus_service->trash_usage_timer_id != 0)
+    g_source_remove (dbus_service->trash_usage_timer_id);
+
+  if (dbus_service->trash_accounting != NULL)
+    {
+      g_signal_handlers_disconnect_by_data (dbus_service->trash_accounting, dbus_service);
+      g_object_unref (dbus_service->trash_accounting);
+    }
+
+  /* nobody will measure the trash anymore */
+  for (lp = dbus_service->trash_usage_invocations; lp != NULL; lp = lp->next)
+    g_dbus_method_invocation_return_error (lp->data, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                                           _("The file manager is shutting down"));
+  g_slist_free (dbus_service->trash_usage_invocations);
+
+  /* tell the callers of the operations which are still running that they were aborted */
+  g_hash_table_iter_init (&iter, dbus_service->operations);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      operation = value;
+      if (operation->finished)
+        continue;
+
+      thunar_dbus_service_operation_add_error (operation, NULL, _("The file manager is shutting down"));
+      thunar_dbus_operation_set_state (operation->skeleton, "cancelled");
+      thunar_dbus_operation_emit_finished (operation->skeleton, FALSE, g_variant_builder_end (&operation->errors));
+    }
+
+  /* this also cancels the operations which are still running */
+  g_hash_table_destroy (dbus_service->operations);
+
   (*G_OBJECT_CLASS (thunar_dbus_service_parent_class)->finalize) (object);
 }
 
@@ -420,6 +635,25 @@ thunar_dbus_service_connect_trash_bin (ThunarDBusService *dbus_service,
 
 
 
+static void
+thunar_dbus_service_connect_trash_accounting (ThunarDBusService *dbus_service)
+{
+  ThunarApplication *application;
+
+  /* the trash is measured once, when it is first queried */
+  if (G_UNLIKELY (dbus_service->trash_accounting == NULL))
+    {
+      application = thunar_application_get ();
+      dbus_service->trash_accounting = thunar_application_get_trash_accounting (application);
+      g_object_unref (application);
+      g_signal_connect_swapped (G_OBJECT (dbus_service->trash_accounting), "changed",
+                                G_CALLBACK (thunar_dbus_service_trash_accounting_changed),
+                                dbus_service);
+    }
+}
+
+
+
 static gboolean
 thunar_dbus_service_parse_uri_and_display (ThunarDBusService *dbus_service,
                                            const gchar       *uri,
@@ -460,6 +694,62 @@ thunar_dbus_service_trash_bin_changed (ThunarDBusService *dbus_service,
 
 
 
+static void
+thunar_dbus_service_trash_accounting_changed (ThunarDBusService *dbus_service)
+{
+  _thunar_return_if_fail (THUNAR_IS_DBUS_SERVICE (dbus_service));
+
+  if (!thunar_trash_accounting_get_usage (dbus_service->trash_accounting, NULL, NULL))
+    return;
+
+  /* answer the calls which waited for the trash to be measured */
+  thunar_dbus_service_answer_trash_usage (dbus_service);
+
+  thunar_dbus_trash_emit_trash_changed (dbus_service->trash);
+}
+
+
+
+/* answers the waiting QueryTrashUsage calls with the trash measured so far */
+static void
+thunar_dbus_service_answer_trash_usage (ThunarDBusService *dbus_service)
+{
+  GSList *invocations;
+  GSList *lp;
+  guint64 n_items;
+  guint64 size;
+
+  if (dbus_service->trash_usage_timer_id != 0)
+    {
+      g_source_remove (dbus_service->trash_usage_timer_id);
+      dbus_service->trash_usage_timer_id = 0;
+    }
+
+  thunar_trash_accounting_get_usage (dbus_service->trash_accounting, &n_items, &size);
+
+  invocations = g_slist_reverse (dbus_service->trash_usage_invocations);
+  dbus_service->trash_usage_invocations = NULL;
+  for (lp = invocations; lp != NULL; lp = lp->next)
+    thunar_dbus_trash_complete_query_trash_usage (dbus_service->trash, lp->data, n_items, size);
+  g_slist_free (invocations);
+}
+
+
+
+static gboolean
+thunar_dbus_service_trash_usage_timeout (gpointer user_data)
+{
+  ThunarDBusService *dbus_service = THUNAR_DBUS_SERVICE (user_data);
+
+  /* a slow volume is still measured, do not keep the callers waiting for it */
+  dbus_service->trash_usage_timer_id = 0;
+  thunar_dbus_service_answer_trash_usage (dbus_service);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+
 static gboolean
 thunar_dbus_service_display_app_chooser_dialog (ThunarDBusFileManager *object,
                                                 GDBusMethodInvocation *invocation,
@@ -915,9 +1205,17 @@ thunar_dbus_service_query_trash (ThunarDBusTrash       *object,
 {
   GError  *error = NULL;
   gboolean full = FALSE;
+  guint64  n_items;
+
+  thunar_dbus_service_connect_trash_accounting (dbus_service);
 
+  /* use the accounted items if the trash was measured already */
+  if (thunar_trash_accounting_get_usage (dbus_service->trash_accounting, &n_items, NULL))
+    {
+      full = (n_items > 0);
+    }
   /* connect to the trash bin on-demand */
-  if (thunar_dbus_service_connect_trash_bin (dbus_service, &error))
+  else if (thunar_dbus_service_connect_trash_bin (dbus_service, &error))
     {
       /* check whether the trash bin is not empty */
       full = (thunar_file_get_trash_item_count (dbus_service->trash_bin) > 0);
@@ -933,6 +1231,35 @@ thunar_dbus_service_query_trash (ThunarDBusTrash       *object,
 
 
 
+static gboolean
+thunar_dbus_service_query_trash_usage (ThunarDBusTrash       *object,
+                                       GDBusMethodInvocation *invocation,
+                                       ThunarDBusService     *dbus_service)
+{
+  guint64 n_items;
+  guint64 size;
+
+  thunar_dbus_service_connect_trash_accounting (dbus_service);
+
+  /* answer once the trash was measured, see thunar_dbus_service_trash_accounting_changed(),
+   * or with the part measured so far after TRASH_USAGE_TIMEOUT */
+  if (thunar_trash_accounting_get_usage (dbus_service->trash_accounting, &n_items, &size))
+    {
+      thunar_dbus_trash_complete_query_trash_usage (object, invocation, n_items, size);
+    }
+  else
+    {
+      dbus_service->trash_usage_invocations = g_slist_prepend (dbus_service->trash_usage_invocations,
+                                                               g_object_ref (invocation));
+      if (dbus_service->trash_usage_timer_id == 0)
+        dbus_service->trash_usage_timer_id = g_timeout_add_seconds (TRASH_USAGE_TIMEOUT, thunar_dbus_service_trash_usage_timeout, dbus_service);
+    }
+
+  return TRUE;
+}
+
+
+
 static gboolean
 thunar_dbus_service_bulk_rename (ThunarDBusThunar      *object,
                                  GDBusMethodInvocation *invocation,
@@ -1156,6 +1483,40 @@ out:
 
 
 
+static gboolean
+thunar_dbus_service_parse_filenames (const gchar *const *filenames,
+                                     GList             **file_list,
+                                     GError            **error)
+{
+  GFile *file;
+  GList *files = NULL;
+  gchar *filename;
+  guint  n;
+
+  for (n = 0; filenames != NULL && filenames[n] != NULL; ++n)
+    {
+      /* decode the filename (D-BUS uses UTF-8) */
+      filename = g_filename_from_utf8 (filenames[n], -1, NULL, NULL, error);
+      if (G_UNLIKELY (filename == NULL))
+        {
+          thunar_g_list_free_full (files);
+          return FALSE;
+        }
+
+      file = g_file_new_for_commandline_arg (filename);
+      files = thunar_g_list_prepend_deep (files, file);
+      g_object_unref (file);
+      g_free (filename);
+    }
+
+  /* append the files in the given order */
+  *file_list = g_list_concat (*file_list, g_list_reverse (files));
+
+  return TRUE;
+}
+
+
+
 static gboolean
 thunar_dbus_service_transfer_files (ThunarDBusTransferMode transfer_mode,
                                     const gchar           *working_directory,
@@ -1168,13 +1529,10 @@ thunar_dbus_service_transfer_files (ThunarDBusTransferMode transfer_mode,
   ThunarApplication *application;
   GdkScreen         *screen;
   GError            *err = NULL;
-  GFile             *file;
   GList             *source_file_list = NULL;
   GList             *target_file_list = NULL;
-  gchar             *filename;
   gchar             *new_working_dir = NULL;
   gchar             *old_working_dir = NULL;
-  guint              n;
 
   /* verify that at least one file to transfer is given */
   if (source_filenames == NULL || *source_filenames == NULL)
@@ -1212,31 +1570,10 @@ thunar_dbus_service_transfer_files (ThunarDBusTransferMode transfer_mode,
       if (!xfce_str_is_empty (working_directory))
         old_working_dir = thunar_util_change_working_directory (working_directory);
 
-      /* transform the source filenames into GFile objects */
-      for (n = 0; err == NULL && source_filenames[n] != NULL; ++n)
-        {
-          filename = g_filename_from_utf8 (source_filenames[n], -1, NULL, NULL, &err);
-          if (filename != NULL)
-            {
-              file = g_file_new_for_commandline_arg (filename);
-              source_file_list = thunar_g_list_append_deep (source_file_list, file);
-              g_object_unref (file);
-              g_free (filename);
-            }
-        }
-
-      /* transform the target filename(s) into (a) GFile object(s) */
-      for (n = 0; err == NULL && target_filenames[n] != NULL; ++n)
-        {
-          filename = g_filename_from_utf8 (target_filenames[n], -1, NULL, NULL, &err);
-          if (filename != NULL)
-            {
-              file = g_file_new_for_commandline_arg (filename);
-              target_file_list = thunar_g_list_append_deep (target_file_list, file);
-              g_object_unref (file);
-              g_free (filename);
-            }
-        }
+      /* transform the source filenames into GFile objects, and the
+       * target filename(s) into (a) GFile object(s) */
+      if (thunar_dbus_service_parse_filenames (source_filenames, &source_file_list, &err))
+        thunar_dbus_service_parse_filenames (target_filenames, &target_file_list, &err);
 
       /* switch back to the previous working directory */
       if (!xfce_str_is_empty (working_directory))
@@ -1510,6 +1847,622 @@ out:
 
 
 
+static gboolean
+thunar_dbus_service_submit_operations (ThunarDBusFileManager *object,
+                                       GDBusMethodInvocation *invocation,
+                                       const gchar           *working_directory,
+                                       GVariant              *operations,
+                                       GVariant              *options,
+                                       ThunarDBusService     *dbus_service)
+{
+  ThunarDBusServiceOperation *operation;
+  ThunarJobPriority           priority = THUNAR_JOB_PRIORITY_FILE_OPERATION;
+  ThunarApplication          *application;
+  GDBusConnection            *connection;
+  GVariantIter                iter;
+  const gchar                *kind_name;
+  const gchar               **source_filenames;
+  const gchar               **target_filenames;
+  const gchar                *conflict_name;
+  GPtrArray                  *object_paths;
+  gboolean                    background;
+  GError                     *error = NULL;
+  GList                      *operation_list = NULL;
+  GList                      *lp;
+  gchar                      *new_working_dir = NULL;
+  gchar                      *old_working_dir = NULL;
+  guint                       progress_interval = OPERATION_PROGRESS_INTERVAL;
+  gint                        conflict = THUNAR_DBUS_CONFLICT_SKIP;
+
+  /* parse the options */
+  if (g_variant_lookup (options, "conflict", "&s", &conflict_name))
+    {
+      conflict = thunar_dbus_service_lookup_name (conflict_policies, conflict_name);
+      if (G_UNLIKELY (conflict < 0))
+        {
+          g_set_error (&error, G_FILE_ERROR, G_FILE_ERROR_INVAL, _("Unknown conflict policy \"%s\""), conflict_name);
+          goto out;
+        }
+    }
+  if (g_variant_lookup (options, "progress-interval", "u", &progress_interval))
+    progress_interval = MAX (progress_interval, OPERATION_PROGRESS_INTERVAL_MIN);
+  if (g_variant_lookup (options, "background", "b", &background) && background)
+    priority = THUNAR_JOB_PRIORITY_BACKGROUND;
+
+  /* change the working directory if necessary */
+  if (!xfce_str_is_empty (working_directory))
+    old_working_dir = thunar_util_change_working_directory (working_directory);
+
+  /* create the jobs, but do not launch any of them before all operations were accepted */
+  g_variant_iter_init (&iter, operations);
+  while (error == NULL && g_variant_iter_next (&iter, "(&s^a&s^a&s)", &kind_name, &source_filenames, &target_filenames))
+    {
+      operation = thunar_dbus_service_operation_new (dbus_service, kind_name, source_filenames, target_filenames,
+                                                     conflict, progress_interval, &error);
+      if (G_LIKELY (operation != NULL))
+        operation_list = g_list_prepend (operation_list, operation);
+
+      g_free (source_filenames);
+      g_free (target_filenames);
+    }
+  operation_list = g_list_reverse (operation_list);
+
+  /* switch back to the previous working directory */
+  if (!xfce_str_is_empty (working_directory))
+    {
+      new_working_dir = thunar_util_change_working_directory (old_working_dir);
+      g_free (old_working_dir);
+      g_free (new_working_dir);
+    }
+
+  /* the operations are reported to the caller only */
+  connection = g_dbus_method_invocation_get_connection (invocation);
+  for (lp = operation_list; error == NULL && lp != NULL; lp = lp->next)
+    {
+      operation = lp->data;
+      g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (operation->skeleton), connection,
+                                        operation->object_path, &error);
+    }
+
+out:
+  if (error != NULL)
+    {
+      g_list_free_full (operation_list, thunar_dbus_service_operation_free);
+      g_dbus_method_invocation_take_error (invocation, error);
+      return TRUE;
+    }
+
+  /* queue the jobs on the file operation scheduler */
+  application = thunar_application_get ();
+  object_paths = g_ptr_array_sized_new (g_list_length (operation_list) + 1);
+  for (lp = operation_list; lp != NULL; lp = lp->next)
+    {
+      operation = lp->data;
+      g_hash_table_insert (dbus_service->operations, operation->object_path, operation);
+      g_ptr_array_add (object_paths, operation->object_path);
+
+      thunar_job_set_priority (operation->job, priority);
+      thunar_job_launch (operation->job);
+
+      /* keep the application alive until the job is done */
+      g_application_hold (G_APPLICATION (application));
+      operation->held = TRUE;
+    }
+  g_ptr_array_add (object_paths, NULL);
+  g_list_free (operation_list);
+  g_object_unref (application);
+
+  thunar_dbus_file_manager_complete_submit_operations (object, invocation, (const gchar *const *) object_paths->pdata);
+  g_ptr_array_free (object_paths, TRUE);
+
+  return TRUE;
+}
+
+
+
+static gint
+thunar_dbus_service_lookup_name (const gchar *const *names,
+                                 const gchar        *name)
+{
+  gint n;
+
+  for (n = 0; names[n] != NULL; ++n)
+    if (g_strcmp0 (names[n], name) == 0)
+      return n;
+
+  return -1;
+}
+
+
+
+static ThunarDBusServiceOperation *
+thunar_dbus_service_operation_new (ThunarDBusService       *dbus_service,
+                                   const gchar             *kind_name,
+                                   const gchar *const      *source_filenames,
+                                   const gchar *const      *target_filenames,
+                                   ThunarDBusConflictPolicy conflict,
+                                   guint                    progress_interval,
+                                   GError                 **error)
+{
+  ThunarDBusServiceOperation *operation;
+  ThunarJob                  *job = NULL;
+  GFile                      *target_file;
+  GList                      *source_file_list = NULL;
+  GList                      *target_file_list = NULL;
+  GList                      *into_file_list = NULL;
+  GList                      *lp;
+  gchar                      *base_name;
+  guint                       n_targets;
+  gint                        kind;
+
+  kind = thunar_dbus_service_lookup_name (operation_kinds, kind_name);
+  if (G_UNLIKELY (kind < 0))
+    {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL, _("Unknown operation \"%s\""), kind_name);
+      return NULL;
+    }
+
+  /* verify that at least one file to operate on is given */
+  if (source_filenames == NULL || *source_filenames == NULL)
+    {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                   _("At least one source filename must be specified"));
+      return NULL;
+    }
+
+  /* verify that the number of target filenames matches the kind */
+  n_targets = (target_filenames != NULL) ? g_strv_length ((gchar **) target_filenames) : 0;
+  switch (kind)
+    {
+    case THUNAR_DBUS_OPERATION_COPY_TO:
+      if (n_targets != g_strv_length ((gchar **) source_filenames))
+        {
+          g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                       _("The number of source and target filenames must be the same"));
+          return NULL;
+        }
+      break;
+
+    case THUNAR_DBUS_OPERATION_COPY_INTO:
+    case THUNAR_DBUS_OPERATION_MOVE_INTO:
+    case THUNAR_DBUS_OPERATION_LINK_INTO:
+      if (n_targets != 1)
+        {
+          g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                       _("Exactly one destination directory must be specified"));
+          return NULL;
+        }
+      break;
+
+    default:
+      if (n_targets != 0)
+        {
+          g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                       _("The operation \"%s\" does not take target filenames"), kind_name);
+          return NULL;
+        }
+      break;
+    }
+
+  if (!thunar_dbus_service_parse_filenames (source_filenames, &source_file_list, error)
+      || !thunar_dbus_service_parse_filenames (target_filenames, &target_file_list, error))
+    goto out;
+
+  /* operations "into" a directory keep the names of the source files */
+  if (kind == THUNAR_DBUS_OPERATION_COPY_INTO
+      || kind == THUNAR_DBUS_OPERATION_MOVE_INTO
+      || kind == THUNAR_DBUS_OPERATION_LINK_INTO)
+    {
+      for (lp = g_list_last (source_file_list); lp != NULL; lp = lp->prev)
+        {
+          /* verify that we're not trying to collect a root node */
+          if (G_UNLIKELY (thunar_g_file_is_root (lp->data)))
+            {
+              g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "%s", g_strerror (EINVAL));
+              thunar_g_list_free_full (into_file_list);
+              goto out;
+            }
+
+          base_name = g_file_get_basename (lp->data);
+          target_file = g_file_resolve_relative_path (target_file_list->data, base_name);
+          into_file_list = thunar_g_list_prepend_deep (into_file_list, target_file);
+          g_object_unref (target_file);
+          g_free (base_name);
+        }
+
+      thunar_g_list_free_full (target_file_list);
+      target_file_list = into_file_list;
+    }
+
+  switch (kind)
+    {
+    case THUNAR_DBUS_OPERATION_COPY_TO:
+    case THUNAR_DBUS_OPERATION_COPY_INTO:
+      job = thunar_io_jobs_copy_files (source_file_list, target_file_list);
+      break;
+
+    case THUNAR_DBUS_OPERATION_MOVE_INTO:
+      job = thunar_io_jobs_move_files (source_file_list, target_file_list);
+      break;
+
+    case THUNAR_DBUS_OPERATION_LINK_INTO:
+      job = thunar_io_jobs_link_files (source_file_list, target_file_list);
+      break;
+
+    case THUNAR_DBUS_OPERATION_UNLINK:
+      job = thunar_io_jobs_unlink_files (source_file_list);
+      break;
+
+    case THUNAR_DBUS_OPERATION_TRASH:
+      job = thunar_io_jobs_trash_files (source_file_list);
+      break;
+    }
+
+  thunar_job_set_log_mode (job, THUNAR_OPERATION_LOG_NO_OPERATIONS);
+
+out:
+  thunar_g_list_free_full (source_file_list);
+  thunar_g_list_free_full (target_file_list);
+
+  if (G_UNLIKELY (job == NULL))
+    return NULL;
+
+  operation = g_slice_new0 (ThunarDBusServiceOperation);
+  operation->dbus_service = dbus_service;
+  operation->object_path = g_strdup_printf ("/org/xfce/FileManager/Operations/%u", ++dbus_service->next_operation_id);
+  operation->job = job;
+  operation->conflict = conflict;
+  operation->progress_interval = progress_interval;
+  g_variant_builder_init (&operation->errors, G_VARIANT_TYPE ("a(ss)"));
+
+  operation->skeleton = thunar_dbus_operation_skeleton_new ();
+  thunar_dbus_operation_set_kind (operation->skeleton, kind_name);
+  thunar_dbus_operation_set_state (operation->skeleton, "queued");
+  g_signal_connect (operation->skeleton, "handle-cancel",
+                    G_CALLBACK (thunar_dbus_service_operation_cancel), operation);
+
+  /* nobody can be asked, so the questions of the job are answered here */
+  g_signal_connect (job, "info-message", G_CALLBACK (thunar_dbus_service_operation_info_message), operation);
+  g_signal_connect (job, "percent", G_CALLBACK (thunar_dbus_service_operation_percent), operation);
+  g_signal_connect (job, "ask", G_CALLBACK (thunar_dbus_service_operation_ask), operation);
+  g_signal_connect (job, "ask-for-action", G_CALLBACK (thunar_dbus_service_operation_ask_for_action), operation);
+  g_signal_connect (job, "error", G_CALLBACK (thunar_dbus_service_operation_error), operation);
+  g_signal_connect (job, "finished", G_CALLBACK (thunar_dbus_service_operation_finished), operation);
+
+  return operation;
+}
+
+
+
+static void
+thunar_dbus_service_operation_free (gpointer data)
+{
+  ThunarDBusServiceOperation *operation = data;
+
+  if (operation->progress_timer_id != 0)
+    g_source_remove (operation->progress_timer_id);
+  if (operation->linger_timer_id != 0)
+    g_source_remove (operation->linger_timer_id);
+
+  /* nobody would answer the questions of the job anymore */
+  g_signal_handlers_disconnect_by_data (operation->job, operation);
+  if (!operation->finished)
+    thunar_job_cancel (operation->job);
+  g_object_unref (operation->job);
+  thunar_dbus_service_operation_release (operation);
+
+  if (g_dbus_interface_skeleton_get_connection (G_DBUS_INTERFACE_SKELETON (operation->skeleton)) != NULL)
+    g_dbus_interface_skeleton_unexport (G_DBUS_INTERFACE_SKELETON (operation->skeleton));
+  g_signal_handlers_disconnect_by_data (operation->skeleton, operation);
+  g_object_unref (operation->skeleton);
+
+  g_variant_builder_clear (&operation->errors);
+  g_free (operation->object_path);
+  g_slice_free (ThunarDBusServiceOperation, operation);
+}
+
+
+
+static void
+thunar_dbus_service_operation_release (ThunarDBusServiceOperation *operation)
+{
+  ThunarApplication *application;
+
+  if (!operation->held)
+    return;
+
+  operation->held = FALSE;
+  application = thunar_application_get ();
+  g_application_release (G_APPLICATION (application));
+  g_object_unref (application);
+}
+
+
+
+static gboolean
+thunar_dbus_service_operation_cancel (ThunarDBusOperation        *object,
+                                      GDBusMethodInvocation      *invocation,
+                                      ThunarDBusServiceOperation *operation)
+{
+  /* the Finished signal follows once the job stopped */
+  if (!operation->finished)
+    thunar_job_cancel (operation->job);
+
+  thunar_dbus_operation_complete_cancel (object, invocation);
+
+  return TRUE;
+}
+
+
+
+static void
+thunar_dbus_service_operation_started (ThunarDBusServiceOperation *operation)
+{
+  /* the job does not tell when it leaves the queue, so use its first signal */
+  if (g_strcmp0 (thunar_dbus_operation_get_state (operation->skeleton), "queued") == 0)
+    thunar_dbus_operation_set_state (operation->skeleton, "running");
+}
+
+
+
+static void
+thunar_dbus_service_operation_add_error (ThunarDBusServiceOperation *operation,
+                                         GFile                      *file,
+                                         const gchar                *message)
+{
+  gchar *uri = NULL;
+
+  if (file != NULL)
+    uri = g_file_get_uri (file);
+
+  g_variant_builder_add (&operation->errors, "(ss)", uri != NULL ? uri : "", message);
+  operation->n_errors++;
+
+  g_free (uri);
+}
+
+
+
+static ThunarJobResponse
+thunar_dbus_service_operation_resolve_conflict (ThunarDBusServiceOperation *operation,
+                                                ThunarJobResponse           choices,
+                                                gboolean                    is_directory)
+{
+  switch (operation->conflict)
+    {
+    case THUNAR_DBUS_CONFLICT_OVERWRITE:
+      /* existing directories are merged, not replaced */
+      if (is_directory && (choices & THUNAR_JOB_RESPONSE_MERGE) != 0)
+        return THUNAR_JOB_RESPONSE_MERGE;
+      if ((choices & THUNAR_JOB_RESPONSE_REPLACE) != 0)
+        return THUNAR_JOB_RESPONSE_REPLACE;
+      break;
+
+    case THUNAR_DBUS_CONFLICT_RENAME:
+      if ((choices & THUNAR_JOB_RESPONSE_RENAME) != 0)
+        return THUNAR_JOB_RESPONSE_RENAME;
+      break;
+
+    case THUNAR_DBUS_CONFLICT_CANCEL:
+      return THUNAR_JOB_RESPONSE_CANCEL;
+
+    default:
+      break;
+    }
+
+  return THUNAR_JOB_RESPONSE_SKIP;
+}
+
+
+
+static void
+thunar_dbus_service_operation_info_message (ThunarJob                  *job,
+                                            const gchar                *message,
+                                            ThunarDBusServiceOperation *operation)
+{
+  thunar_dbus_service_operation_started (operation);
+}
+
+
+
+static void
+thunar_dbus_service_operation_percent (ThunarJob                  *job,
+                                       gdouble                     percent,
+                                       ThunarDBusServiceOperation *operation)
+{
+  thunar_dbus_service_operation_started (operation);
+
+  operation->percent = percent;
+
+  /* emit the first update right away and throttle the following ones */
+  if (operation->progress_timer_id != 0)
+    {
+      operation->percent_pending = TRUE;
+      return;
+    }
+
+  thunar_dbus_service_operation_emit_progress (operation);
+  operation->progress_timer_id = g_timeout_add (operation->progress_interval,
+                                                thunar_dbus_service_operation_progress_timeout,
+                                                operation);
+}
+
+
+
+static gboolean
+thunar_dbus_service_operation_progress_timeout (gpointer user_data)
+{
+  ThunarDBusServiceOperation *operation = user_data;
+
+  /* stop once the job went quiet, the next update is emitted right away again */
+  if (!operation->percent_pending)
+    {
+      operation->progress_timer_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  thunar_dbus_service_operation_emit_progress (operation);
+
+  return G_SOURCE_CONTINUE;
+}
+
+
+
+static void
+thunar_dbus_service_operation_emit_progress (ThunarDBusServiceOperation *operation)
+{
+  operation->percent_pending = FALSE;
+  thunar_dbus_operation_set_percent (operation->skeleton, operation->percent);
+  thunar_dbus_operation_emit_progress (operation->skeleton, operation->percent);
+}
+
+
+
+static ThunarJobResponse
+thunar_dbus_service_operation_ask (ThunarJob                  *job,
+                                   const gchar                *message,
+                                   ThunarJobResponse           choices,
+                                   ThunarDBusServiceOperation *operation)
+{
+  ThunarJobResponse response;
+  const gchar      *question;
+  GFile            *file;
+  gchar            *text;
+
+  thunar_dbus_service_operation_started (operation);
+
+  if ((choices & THUNAR_JOB_RESPONSE_REPLACE) != 0)
+    response = thunar_dbus_service_operation_resolve_conflict (operation, choices, FALSE);
+  else if ((choices & THUNAR_JOB_RESPONSE_SKIP) != 0)
+    response = THUNAR_JOB_RESPONSE_SKIP;
+  else if ((choices & THUNAR_JOB_RESPONSE_NO) != 0)
+    response = THUNAR_JOB_RESPONSE_NO;
+  else
+    response = THUNAR_JOB_RESPONSE_CANCEL;
+
+  /* report the item unless it was processed anyway, without the question appended to the message */
+  if (response != THUNAR_JOB_RESPONSE_REPLACE && response != THUNAR_JOB_RESPONSE_RENAME)
+    {
+      question = strstr (message, "\n\n");
+      text = (question != NULL) ? g_strndup (message, question - message) : g_strdup (message);
+      file = thunar_job_dup_current_file (job);
+      thunar_dbus_service_operation_add_error (operation, file, text);
+      if (file != NULL)
+        g_object_unref (file);
+      g_free (text);
+    }
+
+  return response;
+}
+
+
+
+static ThunarJobResponse
+thunar_dbus_service_operation_ask_for_action (ThunarJob                  *job,
+                                              ThunarFile                 *source_file,
+                                              ThunarFile                 *target_file,
+                                              ThunarDBusServiceOperation *operation)
+{
+  ThunarJobResponse response;
+  gchar            *message;
+
+  thunar_dbus_service_operation_started (operation);
+
+  response = thunar_dbus_service_operation_resolve_conflict (operation,
+                                                             THUNAR_JOB_RESPONSE_REPLACE
+                                                             | THUNAR_JOB_RESPONSE_RENAME
+                                                             | THUNAR_JOB_RESPONSE_MERGE,
+                                                             thunar_file_is_directory (source_file));
+
+  if (response == THUNAR_JOB_RESPONSE_SKIP || response == THUNAR_JOB_RESPONSE_CANCEL)
+    {
+      message = g_strdup_printf (_("The file \"%s\" already exists"), thunar_file_get_display_name (target_file));
+      thunar_dbus_service_operation_add_error (operation, thunar_file_get_file (target_file), message);
+      g_free (message);
+    }
+
+  return response;
+}
+
+
+
+static void
+thunar_dbus_service_operation_error (ThunarJob                  *job,
+                                     GError                     *error,
+                                     ThunarDBusServiceOperation *operation)
+{
+  GFile *file;
+
+  /* the job stops at the file which failed */
+  operation->failed = TRUE;
+  file = thunar_job_dup_current_file (job);
+  thunar_dbus_service_operation_add_error (operation, file, error->message);
+  if (file != NULL)
+    g_object_unref (file);
+}
+
+
+
+static void
+thunar_dbus_service_operation_finished (ThunarJob                  *job,
+                                        ThunarDBusServiceOperation *operation)
+{
+  const gchar *state;
+  gboolean     cancelled;
+
+  _thunar_return_if_fail (operation->job == job);
+
+  operation->finished = TRUE;
+  g_signal_handlers_disconnect_by_data (job, operation);
+
+  /* deliver the last progress update before the Finished signal */
+  if (operation->progress_timer_id != 0)
+    {
+      g_source_remove (operation->progress_timer_id);
+      operation->progress_timer_id = 0;
+    }
+  if (operation->percent_pending)
+    thunar_dbus_service_operation_emit_progress (operation);
+
+  cancelled = thunar_job_is_cancelled (job);
+  if (cancelled)
+    state = "cancelled";
+  else if (operation->failed)
+    state = "failed";
+  else
+    state = "finished";
+
+  if (!cancelled && !operation->failed)
+    thunar_dbus_operation_set_percent (operation->skeleton, 100.0);
+  thunar_dbus_operation_set_state (operation->skeleton, state);
+  thunar_dbus_operation_emit_finished (operation->skeleton,
+                                       !cancelled && operation->n_errors == 0,
+                                       g_variant_builder_end (&operation->errors));
+
+  /* the job is done, the lingering operation does not keep Thunar alive */
+  thunar_dbus_service_operation_release (operation);
+
+  /* give the caller the chance to look at the operation before it disappears */
+  operation->linger_timer_id = g_timeout_add_seconds (OPERATION_LINGER_TIME,
+                                                      thunar_dbus_service_operation_linger_timeout,
+                                                      operation);
+}
+
+
+
+static gboolean
+thunar_dbus_service_operation_linger_timeout (gpointer user_data)
+{
+  ThunarDBusServiceOperation *operation = user_data;
+
+  operation->linger_timer_id = 0;
+  g_hash_table_remove (operation->dbus_service->operations, operation->object_path);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+
 static gboolean
 thunar_dbus_service_terminate (ThunarDBusThunar      *object,
                                GDBusMethodInvocation *invocation,
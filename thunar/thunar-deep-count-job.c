@@ -157,14 +157,14 @@ thunar_deep_count_job_status_update (ThunarDeepCountJob *job)
 {
   _thunar_return_if_fail (THUNAR_IS_DEEP_COUNT_JOB (job));
 
-  thunar_job_emit (THUNAR_JOB (job),
-                   deep_count_signals[STATUS_UPDATE],
-                   0,
-                   job->total_size,
-                   job->total_size_on_disk,
-                   job->file_count,
-                   job->directory_count,
-                   job->unreadable_directory_count);
+  thunar_job_emit_coalesced (THUNAR_JOB (job),
+                             deep_count_signals[STATUS_UPDATE],
+                             0,
+                             job->total_size,
+                             job->total_size_on_disk,
+                             job->file_count,
+                             job->directory_count,
+                             job->unreadable_directory_count);
 }
 
 
@@ -419,6 +419,9 @@ thunar_deep_count_job_new (GList              *files,
   job->files = g_list_copy (files);
   job->query_flags = flags;
 
+  /* deep counts can take a long time, don't let them delay more important jobs */
+  thunar_job_set_priority (THUNAR_JOB (job), THUNAR_JOB_PRIORITY_BACKGROUND);
+
   g_list_foreach (job->files, (GFunc) (void (*) (void)) g_object_ref, NULL);
 
   return job;
@@ -168,6 +168,9 @@ thunar_details_view_queue_redraw (ThunarStandardView *standard_view);
 static gboolean
 thunar_details_view_toggle_expandable_folders (ThunarDetailsView *details_view);
 static void
+thunar_details_view_selection_changed (GtkTreeSelection  *selection,
+                                       ThunarDetailsView *details_view);
+static void
 thunar_details_view_block_selection_changed (ThunarStandardView *standard_view);
 static void
 thunar_details_view_unblock_selection_changed (ThunarStandardView *standard_view);
@@ -206,6 +209,9 @@ struct _ThunarDetailsView
   gboolean expandable_folders;
 
   guint update_expand_arrows_timeout_source_id;
+
+  /* paths whose selection may have changed since the last "changed" of the tree selection */
+  GPtrArray *selection_delta;
 };
 
 
@@ -292,7 +298,9 @@ thunar_details_view_class_init (ThunarDetailsViewClass *klass)
 
 /**
  * thunar_details_view_tree_selection_cb
- * A filter function to prevent "Loading..." rows from being selected
+ * A filter function to prevent "Loading..." rows from being selected.
+ * It also remembers the rows whose selection changes, see
+ * thunar_details_view_selection_changed().
  * See #GtkTreeSelectionFunc for arguments
  */
 static gboolean
@@ -300,15 +308,20 @@ thunar_details_view_tree_selection_cb (GtkTreeSelection *selection,
                                        GtkTreeModel     *model,
                                        GtkTreePath      *path,
                                        gboolean          is_currently_selected,
-                                       gpointer          unused)
+                                       gpointer          user_data)
 {
-  GtkTreeIter iter;
+  ThunarDetailsView *details_view = THUNAR_DETAILS_VIEW (user_data);
+  GtkTreeIter        iter;
   g_autoptr (ThunarFile) file = NULL;
   if (gtk_tree_model_get_iter (model, &iter, path))
     {
       file = thunar_tree_view_model_get_file (THUNAR_TREE_VIEW_MODEL (model), &iter);
     }
-  return file != NULL || is_currently_selected;
+  if (file == NULL && !is_currently_selected)
+    return FALSE;
+
+  g_ptr_array_add (details_view->selection_delta, gtk_tree_path_copy (path));
+  return TRUE;
 }
 
 static void
@@ -321,6 +334,7 @@ thunar_details_view_init (ThunarDetailsView *details_view)
   ThunarColumn      column;
 
   details_view->update_expand_arrows_timeout_source_id = 0;
+  details_view->selection_delta = g_ptr_array_new_with_free_func ((GDestroyNotify) gtk_tree_path_free);
 
   /* we need to force the GtkTreeView to recalculate column sizes
    * whenever the zoom-level changes, so we connect a handler here.
@@ -331,7 +345,7 @@ thunar_details_view_init (ThunarDetailsView *details_view)
   details_view->tree_view = XFCE_TREE_VIEW (xfce_tree_view_new ());
   gtk_tree_selection_set_select_function (gtk_tree_view_get_selection (GTK_TREE_VIEW (details_view->tree_view)),
                                           thunar_details_view_tree_selection_cb,
-                                          NULL, NULL);
+                                          details_view, NULL);
   g_signal_connect (G_OBJECT (details_view->tree_view), "notify::model",
                     G_CALLBACK (thunar_details_view_notify_model), details_view);
   g_signal_connect (G_OBJECT (details_view->tree_view), "button-press-event",
@@ -445,8 +459,8 @@ thunar_details_view_init (ThunarDetailsView *details_view)
   /* configure the tree selection */
   selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (details_view->tree_view));
   gtk_tree_selection_set_mode (selection, GTK_SELECTION_MULTIPLE);
-  g_signal_connect_swapped (G_OBJECT (selection), "changed",
-                            G_CALLBACK (thunar_standard_view_selection_changed), details_view);
+  g_signal_connect (G_OBJECT (selection), "changed",
+                    G_CALLBACK (thunar_details_view_selection_changed), details_view);
 
   /* apply the initial column order and visibility from the column model */
   thunar_details_view_columns_changed (details_view->column_model, details_view);
@@ -571,6 +585,8 @@ thunar_details_view_finalize (GObject *object)
   g_signal_handlers_disconnect_by_func (G_OBJECT (THUNAR_STANDARD_VIEW (details_view)->preferences),
                                         thunar_details_view_highlight_option_changed, details_view);
 
+  g_ptr_array_unref (details_view->selection_delta);
+
   (*G_OBJECT_CLASS (thunar_details_view_parent_class)->finalize) (object);
 }
 
@@ -662,7 +678,7 @@ thunar_details_view_selection_invert (ThunarStandardView *standard_view)
   selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))));
 
   /* block updates */
-  g_signal_handlers_block_by_func (selection, thunar_standard_view_selection_changed, standard_view);
+  g_signal_handlers_block_by_func (selection, thunar_details_view_selection_changed, standard_view);
 
   /* get paths of selected files */
   gtk_tree_selection_selected_foreach (selection, thunar_details_view_selection_invert_foreach, &selected_paths);
@@ -678,8 +694,9 @@ thunar_details_view_selection_invert (ThunarStandardView *standard_view)
 
   g_list_free (selected_paths);
 
-  /* unblock updates */
-  g_signal_handlers_unblock_by_func (selection, thunar_standard_view_selection_changed, standard_view);
+  /* unblock updates, every row changed anyway */
+  g_signal_handlers_unblock_by_func (selection, thunar_details_view_selection_changed, standard_view);
+  g_ptr_array_set_size (THUNAR_DETAILS_VIEW (standard_view)->selection_delta, 0);
 
   thunar_standard_view_selection_changed (THUNAR_STANDARD_VIEW (standard_view));
 }
@@ -1884,6 +1901,44 @@ thunar_details_view_toggle_expandable_folders (ThunarDetailsView *details_view)
 
 
 
+static void
+thunar_details_view_selection_changed (GtkTreeSelection  *selection,
+                                       ThunarDetailsView *details_view)
+{
+  GtkTreePath *path;
+  GList       *selected_paths = NULL;
+  GList       *unselected_paths = NULL;
+  guint        n;
+
+  _thunar_return_if_fail (THUNAR_IS_DETAILS_VIEW (details_view));
+
+  /* rows which were deleted or collapsed change the selection without the
+   * select function, so the selected files have to be determined again */
+  if (details_view->selection_delta->len == 0)
+    {
+      thunar_standard_view_selection_changed (THUNAR_STANDARD_VIEW (details_view));
+      return;
+    }
+
+  /* pass on only the rows which changed, according to their current state */
+  for (n = 0; n < details_view->selection_delta->len; ++n)
+    {
+      path = g_ptr_array_index (details_view->selection_delta, n);
+      if (gtk_tree_selection_path_is_selected (selection, path))
+        selected_paths = g_list_prepend (selected_paths, path);
+      else
+        unselected_paths = g_list_prepend (unselected_paths, path);
+    }
+
+  thunar_standard_view_selection_delta (THUNAR_STANDARD_VIEW (details_view), selected_paths, unselected_paths);
+
+  g_list_free (selected_paths);
+  g_list_free (unselected_paths);
+  g_ptr_array_set_size (details_view->selection_delta, 0);
+}
+
+
+
 static void
 thunar_details_view_block_selection_changed (ThunarStandardView *view)
 {
@@ -1893,7 +1948,7 @@ thunar_details_view_block_selection_changed (ThunarStandardView *view)
   _thunar_return_if_fail (THUNAR_IS_DETAILS_VIEW (details_view));
 
   selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (details_view->tree_view));
-  g_signal_handlers_block_by_func (G_OBJECT (selection), thunar_standard_view_selection_changed, view);
+  g_signal_handlers_block_by_func (G_OBJECT (selection), thunar_details_view_selection_changed, view);
 }
 
 
@@ -1907,5 +1962,8 @@ thunar_details_view_unblock_selection_changed (ThunarStandardView *view)
   _thunar_return_if_fail (THUNAR_IS_DETAILS_VIEW (details_view));
 
   selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (details_view->tree_view));
-  g_signal_handlers_unblock_by_func (G_OBJECT (selection), thunar_standard_view_selection_changed, view);
+  g_signal_handlers_unblock_by_func (G_OBJECT (selection), thunar_details_view_selection_changed, view);
+
+  /* the caller reports the changes made meanwhile with thunar_standard_view_selection_changed() */
+  g_ptr_array_set_size (details_view->selection_delta, 0);
 }
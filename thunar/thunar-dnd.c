@@ -23,6 +23,7 @@
 #include "thunar/thunar-dialogs.h"
 #include "thunar/thunar-dnd.h"
 #include "thunar/thunar-gtk-extensions.h"
+#include "thunar/thunar-menu-providers.h"
 #include "thunar/thunar-private.h"
 #include "thunarx/thunarx.h"
 
@@ -67,25 +68,20 @@ thunar_dnd_ask (GtkWidget    *widget,
   static const gchar        *dnd_action_names[] = { N_ ("Copy _Here"), N_ ("_Move Here"), N_ ("_Link Here") };
   static const gchar        *dnd_action_icons[] = { "stock_folder-copy", "stock_folder-move", "insert-link" };
 
-  ThunarxProviderFactory *factory;
-  GdkDragAction           dnd_action = 0;
-  ThunarFile             *file;
-  GtkWidget              *window;
-  GtkWidget              *image;
-  GtkWidget              *menu;
-  GtkWidget              *item;
-  GList                  *file_list = NULL;
-  GList                  *providers = NULL;
-  GList                  *items = NULL;
-  GList                  *lp;
-  guint                   n;
+  GdkDragAction  dnd_action = 0;
+  ThunarFile    *file;
+  GtkWidget     *window;
+  GtkWidget     *image;
+  GtkWidget     *menu;
+  GtkWidget     *item;
+  GList         *file_list = NULL;
+  GList         *items = NULL;
+  GList         *lp;
+  guint          n;
 
   _thunar_return_val_if_fail (thunar_file_is_directory (folder), 0);
   _thunar_return_val_if_fail (GTK_IS_WIDGET (widget), 0);
 
-  /* connect to the provider factory */
-  factory = thunarx_provider_factory_get_default ();
-
   /* prepare the popup menu */
   menu = gtk_menu_new ();
 
@@ -134,17 +130,8 @@ thunar_dnd_ask (GtkWidget    *widget,
       /* check if we resolved all paths (and have atleast one file) */
       if (G_LIKELY (file_list != NULL && lp == NULL))
         {
-          /* load the menu providers from the provider factory */
-          providers = thunarx_provider_factory_list_providers (factory, THUNARX_TYPE_MENU_PROVIDER);
-
           /* load the dnd menu items offered by the menu providers */
-          for (lp = providers; lp != NULL; lp = lp->next)
-            {
-              /* merge the menu items from this provider */
-              items = g_list_concat (items, thunarx_menu_provider_get_dnd_menu_items (lp->data, window, THUNARX_FILE_INFO (folder), file_list));
-              g_object_unref (G_OBJECT (lp->data));
-            }
-          g_list_free (providers);
+          items = thunar_menu_providers_get_items (THUNAR_MENU_PROVIDERS_DND_ITEMS, window, folder, file_list, NULL, NULL, NULL);
 
           /* check if we have at least one item */
           if (G_UNLIKELY (items != NULL))
@@ -175,7 +162,6 @@ thunar_dnd_ask (GtkWidget    *widget,
   thunar_gtk_menu_run (GTK_MENU (menu));
 
   /* cleanup */
-  g_object_unref (G_OBJECT (factory));
   g_list_free_full (file_list, g_object_unref);
 
   return dnd_action;
@@ -148,24 +148,35 @@ thunar_file_reset_thumbnail (ThunarFile         *file,
 
 
 
-static GRecMutex G_LOCK_NAME (file_cache_mutex);
-
 /* In order to limit the number of total file watches */
 /* Note that a global, system-wide limit is defined in '/proc/sys/fs/inotify/max_user_watches' */
 #define THUNAR_FILE_WATCH_MAX 10000
 static gint thunar_file_watch_total_count = 0;
 
-#define G_REC_LOCK(name) g_rec_mutex_lock (&G_LOCK_NAME (name))
-#define G_REC_UNLOCK(name) g_rec_mutex_unlock (&G_LOCK_NAME (name))
+/* The file cache is split into shards by the hash of the GFile, each with
+ * its own lock, so threads scanning different folders and the lookups in
+ * the main thread rarely have to wait for each other */
+#define THUNAR_FILE_CACHE_SHARD_BITS (4)
+#define THUNAR_FILE_CACHE_N_SHARDS (1 << THUNAR_FILE_CACHE_SHARD_BITS)
+
+typedef struct
+{
+  GRecMutex   mutex;
+  GHashTable *table;
+
+  /* lock statistics, see thunar_file_cache_get_stats() */
+  guint n_locks;
+  guint n_contended;
+} ThunarFileCacheShard;
 
 
 
-static ThunarUserManager *user_manager;
-static GHashTable        *file_cache;
-static guint32            effective_user_id;
-static gboolean           enable_smart_sort;
-static GQuark             thunar_file_watch_quark;
-static guint              file_signals[LAST_SIGNAL];
+static ThunarUserManager   *user_manager;
+static ThunarFileCacheShard file_cache[THUNAR_FILE_CACHE_N_SHARDS];
+static guint32              effective_user_id;
+static gboolean             enable_smart_sort;
+static GQuark               thunar_file_watch_quark;
+static guint                file_signals[LAST_SIGNAL];
 
 
 
@@ -238,6 +249,11 @@ struct _ThunarFile
    * there were > 10.000 files in a folder (Creation of #ThunarFolder seems to be slow) */
   guint   file_count;
   guint64 file_count_timestamp;
+
+  /* files created from a folder snapshot have incomplete info until a scan of the folder
+   * sees them, see thunar_file_get_provisional(). Protected by the file cache shard lock */
+  gboolean   provisional;
+  GFileInfo *pending_info;
 };
 
 typedef struct
@@ -292,6 +308,88 @@ weak_ref_free (GWeakRef *ref)
 }
 
 
+
+static void
+thunar_file_cache_init (void)
+{
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized))
+    {
+      for (guint n = 0; n < THUNAR_FILE_CACHE_N_SHARDS; ++n)
+        {
+          file_cache[n].table = g_hash_table_new_full (g_file_hash,
+                                                       (GEqualFunc) g_file_equal,
+                                                       (GDestroyNotify) g_object_unref,
+                                                       (GDestroyNotify) weak_ref_free);
+        }
+
+      g_once_init_leave (&initialized, 1);
+    }
+}
+
+
+
+static guint
+thunar_file_cache_shard_index (const GFile *gfile)
+{
+  /* use the upper bits of a multiplicative hash, the hash
+   * tables of the shards already use the lower ones */
+  return ((guint32) g_file_hash (gfile) * 2654435769u) >> (32 - THUNAR_FILE_CACHE_SHARD_BITS);
+}
+
+
+
+static ThunarFileCacheShard *
+thunar_file_cache_lock_shard (guint index)
+{
+  ThunarFileCacheShard *shard = &file_cache[index];
+
+  thunar_file_cache_init ();
+
+  g_atomic_int_inc (&shard->n_locks);
+  if (!g_rec_mutex_trylock (&shard->mutex))
+    {
+      g_atomic_int_inc (&shard->n_contended);
+      g_rec_mutex_lock (&shard->mutex);
+    }
+
+  return shard;
+}
+
+
+
+static ThunarFileCacheShard *
+thunar_file_cache_lock (const GFile *gfile)
+{
+  return thunar_file_cache_lock_shard (thunar_file_cache_shard_index (gfile));
+}
+
+
+
+static void
+thunar_file_cache_unlock (ThunarFileCacheShard *shard)
+{
+  g_rec_mutex_unlock (&shard->mutex);
+}
+
+
+
+/* returns a new reference on the cached file, the @shard of @gfile must be locked */
+static ThunarFile *
+thunar_file_cache_lookup_locked (ThunarFileCacheShard *shard,
+                                 const GFile          *gfile)
+{
+  GWeakRef *ref;
+
+  ref = g_hash_table_lookup (shard->table, gfile);
+  if (ref == NULL)
+    return NULL;
+
+  return g_weak_ref_get (ref);
+}
+
+
 #ifdef G_ENABLE_DEBUG
 #ifdef HAVE_ATEXIT
 static gboolean thunar_file_atexit_registered = FALSE;
@@ -317,22 +415,23 @@ thunar_file_atexit_foreach (gpointer key,
 static void
 thunar_file_atexit (void)
 {
-  G_REC_LOCK (file_cache_mutex);
+  ThunarFileCacheShard *shard;
+  guint                 n_files;
 
-  if (file_cache == NULL || g_hash_table_size (file_cache) == 0)
-    {
-      G_REC_UNLOCK (file_cache_mutex);
-      return;
-    }
+  thunar_file_cache_get_stats (&n_files, NULL, NULL);
+  if (n_files == 0)
+    return;
 
-  g_print ("--- Leaked a total of %u ThunarFile objects:\n",
-           g_hash_table_size (file_cache));
+  g_print ("--- Leaked a total of %u ThunarFile objects:\n", n_files);
 
-  g_hash_table_foreach (file_cache, thunar_file_atexit_foreach, NULL);
+  for (guint n = 0; n < THUNAR_FILE_CACHE_N_SHARDS; ++n)
+    {
+      shard = thunar_file_cache_lock_shard (n);
+      g_hash_table_foreach (shard->table, thunar_file_atexit_foreach, NULL);
+      thunar_file_cache_unlock (shard);
+    }
 
   g_print ("\n");
-
-  G_REC_UNLOCK (file_cache_mutex);
 }
 #endif
 #endif
@@ -357,19 +456,23 @@ thunar_file_cache_dump_foreach (gpointer gfile,
 static gboolean
 thunar_file_cache_dump (gpointer user_data)
 {
-  G_REC_LOCK (file_cache_mutex);
-
-  if (file_cache != NULL)
-    {
-      g_print ("--- %d ThunarFile objects in cache:\n",
-               g_hash_table_size (file_cache));
+  ThunarFileCacheShard *shard;
+  guint64               n_locks;
+  guint64               n_contended;
+  guint                 n_files;
 
-      g_hash_table_foreach (file_cache, thunar_file_cache_dump_foreach, NULL);
+  thunar_file_cache_get_stats (&n_files, &n_locks, &n_contended);
+  g_print ("--- %u ThunarFile objects in cache (%" G_GUINT64_FORMAT " of %" G_GUINT64_FORMAT " locks contended):\n",
+           n_files, n_contended, n_locks);
 
-      g_print ("\n");
+  for (guint n = 0; n < THUNAR_FILE_CACHE_N_SHARDS; ++n)
+    {
+      shard = thunar_file_cache_lock_shard (n);
+      g_hash_table_foreach (shard->table, thunar_file_cache_dump_foreach, NULL);
+      thunar_file_cache_unlock (shard);
     }
 
-  G_REC_UNLOCK (file_cache_mutex);
+  g_print ("\n");
 
   return TRUE;
 }
@@ -504,7 +607,8 @@ thunar_file_dispose (GObject *object)
 static void
 thunar_file_finalize (GObject *object)
 {
-  ThunarFile *file = THUNAR_FILE (object);
+  ThunarFile           *file = THUNAR_FILE (object);
+  ThunarFileCacheShard *shard;
 
   if (file->signal_changed_source_id != 0)
     g_source_remove (file->signal_changed_source_id);
@@ -526,9 +630,9 @@ thunar_file_finalize (GObject *object)
     g_object_unref (file->thumbnailer);
 
   /* drop the entry from the cache */
-  G_REC_LOCK (file_cache_mutex);
-  g_hash_table_remove (file_cache, file->gfile);
-  G_REC_UNLOCK (file_cache_mutex);
+  shard = thunar_file_cache_lock (file->gfile);
+  g_hash_table_remove (shard->table, file->gfile);
+  thunar_file_cache_unlock (shard);
 
   /* release file info */
   if (file->info != NULL)
@@ -538,6 +642,9 @@ thunar_file_finalize (GObject *object)
   if (file->recent_info != NULL)
     g_object_unref (file->recent_info);
 
+  if (file->pending_info != NULL)
+    g_object_unref (file->pending_info);
+
   /* free the custom icon name */
   g_free (file->custom_icon_name);
 
@@ -788,9 +895,20 @@ void
 thunar_file_replace_file (ThunarFile *file,
                           GFile      *renamed_file)
 {
-  GFile *previous_file;
-
-  G_REC_LOCK (file_cache_mutex);
+  ThunarFileCacheShard *previous_shard;
+  ThunarFileCacheShard *shard;
+  GFile                *previous_file;
+  guint                 previous_index;
+  guint                 index;
+
+  /* lock both shards (in index order to avoid deadlocks), so
+   * the file cannot be looked up while moving between them */
+  previous_index = thunar_file_cache_shard_index (file->gfile);
+  index = thunar_file_cache_shard_index (renamed_file);
+  thunar_file_cache_lock_shard (MIN (previous_index, index));
+  thunar_file_cache_lock_shard (MAX (previous_index, index));
+  previous_shard = &file_cache[previous_index];
+  shard = &file_cache[index];
 
   /* get the old location */
   previous_file = file->gfile;
@@ -799,7 +917,7 @@ thunar_file_replace_file (ThunarFile *file,
   file->gfile = g_object_ref (renamed_file);
 
   /* drop the previous entry from the cache */
-  g_hash_table_remove (file_cache, previous_file);
+  g_hash_table_remove (previous_shard->table, previous_file);
 
   /* need to re-register the monitor handle for the new uri */
   thunar_file_watch_reconnect (file);
@@ -808,11 +926,12 @@ thunar_file_replace_file (ThunarFile *file,
   g_object_unref (previous_file);
 
   /* insert the new entry */
-  g_hash_table_insert (file_cache,
+  g_hash_table_insert (shard->table,
                        g_object_ref (file->gfile),
                        weak_ref_new (G_OBJECT (file)));
 
-  G_REC_UNLOCK (file_cache_mutex);
+  thunar_file_cache_unlock (shard);
+  thunar_file_cache_unlock (previous_shard);
 }
 
 
@@ -1147,11 +1266,12 @@ thunar_file_get_async_finish (GObject      *object,
                               GAsyncResult *result,
                               gpointer      user_data)
 {
-  ThunarFileGetData *data = user_data;
-  ThunarFile        *file;
-  GFileInfo         *file_info;
-  GError            *error = NULL;
-  GFile             *location = G_FILE (object);
+  ThunarFileGetData    *data = user_data;
+  ThunarFileCacheShard *shard;
+  ThunarFile           *file;
+  GFileInfo            *file_info;
+  GError               *error = NULL;
+  GFile                *location = G_FILE (object);
 
   _thunar_return_if_fail (G_IS_FILE (location));
   _thunar_return_if_fail (G_IS_ASYNC_RESULT (result));
@@ -1182,11 +1302,11 @@ thunar_file_get_async_finish (GObject      *object,
     }
 
   /* insert the file into the cache */
-  G_REC_LOCK (file_cache_mutex);
-  g_hash_table_insert (file_cache,
+  shard = thunar_file_cache_lock (file->gfile);
+  g_hash_table_insert (shard->table,
                        g_object_ref (file->gfile),
                        weak_ref_new (G_OBJECT (file)));
-  G_REC_UNLOCK (file_cache_mutex);
+  thunar_file_cache_unlock (shard);
 
   /* pass the loaded file and possible errors to the return function */
   (data->func) (location, file, error, data->user_data);
@@ -1225,19 +1345,20 @@ thunar_file_load (ThunarFile   *file,
                   GCancellable *cancellable,
                   GError      **error)
 {
-  GError    *err = NULL;
-  GFileInfo *info = NULL;
-  gboolean   mounted = TRUE;
+  ThunarFileCacheShard *shard;
+  GError               *err = NULL;
+  GFileInfo            *info = NULL;
+  gboolean              mounted = TRUE;
 
   _thunar_return_val_if_fail (THUNAR_IS_FILE (file), FALSE);
   _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
   _thunar_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
   _thunar_return_val_if_fail (G_IS_FILE (file->gfile), FALSE);
 
-  G_REC_LOCK (file_cache_mutex);
+  shard = thunar_file_cache_lock (file->gfile);
 
   /* remove the file from cache */
-  g_hash_table_remove (file_cache, file->gfile);
+  g_hash_table_remove (shard->table, file->gfile);
 
   /* query a new file info */
   info = g_file_query_info (file->gfile,
@@ -1262,10 +1383,10 @@ thunar_file_load (ThunarFile   *file,
       g_propagate_error (error, err);
 
       /* even if we failed to load it, re-add the file into the cache */
-      g_hash_table_insert (file_cache,
+      g_hash_table_insert (shard->table,
                            g_object_ref (file->gfile),
                            weak_ref_new (G_OBJECT (file)));
-      G_REC_UNLOCK (file_cache_mutex);
+      thunar_file_cache_unlock (shard);
       return FALSE;
     }
 
@@ -1282,15 +1403,19 @@ thunar_file_load (ThunarFile   *file,
   if (mounted == FALSE)
     FLAG_UNSET (file, THUNAR_FILE_FLAG_IS_MOUNTED);
 
+  /* the info is complete now */
+  file->provisional = FALSE;
+  g_clear_object (&file->pending_info);
+
   /* (re)insert the file into the cache */
   if (file->kind != G_FILE_TYPE_UNKNOWN)
     {
-      g_hash_table_insert (file_cache,
+      g_hash_table_insert (shard->table,
                            g_object_ref (file->gfile),
                            weak_ref_new (G_OBJECT (file)));
     }
 
-  G_REC_UNLOCK (file_cache_mutex);
+  thunar_file_cache_unlock (shard);
 
   return TRUE;
 }
@@ -1315,20 +1440,21 @@ ThunarFile *
 thunar_file_get (GFile   *gfile,
                  GError **error)
 {
-  ThunarFile *file;
+  ThunarFileCacheShard *shard;
+  ThunarFile           *file;
 
   _thunar_return_val_if_fail (G_IS_FILE (gfile), NULL);
 
   /* both lookup and insert must happen in the same critical section
    * because the insert is contigent upon the lookup */
-  G_REC_LOCK (file_cache_mutex);
+  shard = thunar_file_cache_lock (gfile);
 
   /* check if we already have a cached version of that file */
-  file = thunar_file_cache_lookup (gfile);
+  file = thunar_file_cache_lookup_locked (shard, gfile);
   if (G_UNLIKELY (file != NULL))
     {
       /* return the file, it already has an additional ref set
-       * in thunar_file_cache_lookup */
+       * in thunar_file_cache_lookup_locked */
     }
   else
     {
@@ -1340,7 +1466,7 @@ thunar_file_get (GFile   *gfile,
         {
           /* Just check that it's been cached, if appropriate */
           if (file->kind != G_FILE_TYPE_UNKNOWN)
-            _thunar_assert (g_hash_table_contains (file_cache, file->gfile) == TRUE);
+            _thunar_assert (g_hash_table_contains (shard->table, file->gfile) == TRUE);
         }
       else
         {
@@ -1353,12 +1479,61 @@ thunar_file_get (GFile   *gfile,
     }
 
   /* finished related activity on the cache */
-  G_REC_UNLOCK (file_cache_mutex);
+  thunar_file_cache_unlock (shard);
+
+  return file;
+}
+
+
+/* looks up or creates the file for @gfile, the @shard of @gfile must be locked */
+static ThunarFile *
+thunar_file_get_with_info_locked (ThunarFileCacheShard *shard,
+                                  GFile                *gfile,
+                                  GFileInfo            *info,
+                                  gboolean              not_mounted)
+{
+  ThunarFile *file;
+
+  /* check if we already have a cached version of that file */
+  file = thunar_file_cache_lookup_locked (shard, gfile);
+  if (G_UNLIKELY (file != NULL))
+    {
+      /* return the file, it already has an additional ref set
+       * in thunar_file_cache_lookup_locked. If it was restored from a
+       * snapshot, keep the complete info for thunar_file_apply_pending_info() */
+      if (G_UNLIKELY (file->provisional))
+        g_set_object (&file->pending_info, info);
+    }
+  else
+    {
+      /* allocate a new object */
+      file = g_object_new (THUNAR_TYPE_FILE, NULL);
+      file->gfile = g_object_ref (gfile);
+
+      /* reset the file */
+      thunar_file_info_clear (file);
+
+      /* set the passed info */
+      file->info = g_object_ref (info);
+
+      /* update the file from the information */
+      thunar_file_info_reload (file, NULL);
+
+      /* update the mounted info */
+      if (not_mounted)
+        FLAG_UNSET (file, THUNAR_FILE_FLAG_IS_MOUNTED);
+
+      /* insert the file into the cache */
+      g_hash_table_insert (shard->table,
+                           g_object_ref (file->gfile),
+                           weak_ref_new (G_OBJECT (file)));
+    }
 
   return file;
 }
 
 
+
 /**
  * thunar_file_get_with_info:
  * @uri         : a URI or an absolute filename.
@@ -1384,57 +1559,213 @@ thunar_file_get_with_info (GFile     *gfile,
                            GFileInfo *recent_info,
                            gboolean   not_mounted)
 {
-  ThunarFile *file;
+  ThunarFileCacheShard *shard;
+  ThunarFile           *file;
 
   _thunar_return_val_if_fail (G_IS_FILE (gfile), NULL);
   _thunar_return_val_if_fail (G_IS_FILE_INFO (info), NULL);
 
   /* all contingent lookups and inserts must happen in the same critical section */
-  G_REC_LOCK (file_cache_mutex);
+  shard = thunar_file_cache_lock (gfile);
+  file = thunar_file_get_with_info_locked (shard, gfile, info, not_mounted);
+  thunar_file_cache_unlock (shard);
 
-  /* check if we already have a cached version of that file */
-  file = thunar_file_cache_lookup (gfile);
-  if (G_UNLIKELY (file != NULL))
+  if (recent_info != NULL)
+    file->recent_info = g_object_ref (recent_info);
+
+  return file;
+}
+
+
+
+/**
+ * thunar_file_get_with_infos:
+ * @entries   : an array of #ThunarFileInfoEntry<!---->s.
+ * @n_entries : the number of @entries.
+ *
+ * Like thunar_file_get_with_info(), but for a whole batch of files,
+ * e.g. the files of a scanned folder. The entries are grouped by
+ * their place in the file cache, so every part of the cache is only
+ * locked once for the batch, instead of once per file.
+ *
+ * The file of each entry is stored in its @file field. The caller is
+ * responsible to call g_object_unref() on them when done.
+ **/
+void
+thunar_file_get_with_infos (ThunarFileInfoEntry *entries,
+                            guint                n_entries)
+{
+  ThunarFileCacheShard *shard;
+  guint                 offsets[THUNAR_FILE_CACHE_N_SHARDS + 1] = { 0 };
+  guint                *indices;
+  guint                *order;
+  guint                 begin;
+  guint                 n;
+
+  _thunar_return_if_fail (entries != NULL || n_entries == 0);
+
+  if (G_UNLIKELY (n_entries == 0))
+    return;
+
+  /* sort the entries by shard */
+  indices = g_new (guint, n_entries);
+  order = g_new (guint, n_entries);
+  for (n = 0; n < n_entries; ++n)
     {
-      /* return the file, it already has an additional ref set
-       * in thunar_file_cache_lookup */
+      _thunar_assert (G_IS_FILE (entries[n].gfile));
+      _thunar_assert (G_IS_FILE_INFO (entries[n].info));
+
+      indices[n] = thunar_file_cache_shard_index (entries[n].gfile);
+      offsets[indices[n] + 1]++;
     }
-  else
+  for (n = 1; n <= THUNAR_FILE_CACHE_N_SHARDS; ++n)
+    offsets[n] += offsets[n - 1];
+  for (n = 0; n < n_entries; ++n)
+    order[offsets[indices[n]]++] = n;
+
+  /* look up or create the files, locking each shard only once */
+  begin = 0;
+  for (guint i = 0; i < THUNAR_FILE_CACHE_N_SHARDS; ++i)
     {
-      /* allocate a new object */
-      file = g_object_new (THUNAR_TYPE_FILE, NULL);
-      file->gfile = g_object_ref (gfile);
+      /* offsets[i] is the end of the entries of shard i now */
+      if (begin < offsets[i])
+        {
+          shard = thunar_file_cache_lock_shard (i);
+          for (n = begin; n < offsets[i]; ++n)
+            {
+              ThunarFileInfoEntry *entry = &entries[order[n]];
+              entry->file = thunar_file_get_with_info_locked (shard, entry->gfile, entry->info, entry->not_mounted);
+            }
+          thunar_file_cache_unlock (shard);
+        }
 
-      /* reset the file */
-      thunar_file_info_clear (file);
+      begin = offsets[i];
+    }
 
-      /* set the passed info */
-      file->info = g_object_ref (info);
+  for (n = 0; n < n_entries; ++n)
+    if (entries[n].recent_info != NULL)
+      entries[n].file->recent_info = g_object_ref (entries[n].recent_info);
 
-      /* update the file from the information */
-      thunar_file_info_reload (file, NULL);
+  g_free (indices);
+  g_free (order);
+}
 
-      /* update the mounted info */
-      if (not_mounted)
-        FLAG_UNSET (file, THUNAR_FILE_FLAG_IS_MOUNTED);
 
-      /* insert the file into the cache */
-      g_hash_table_insert (file_cache,
-                           g_object_ref (file->gfile),
-                           weak_ref_new (G_OBJECT (file)));
-    }
 
-  /* done reading and writing the cache for this file instance */
-  G_REC_UNLOCK (file_cache_mutex);
+/**
+ * thunar_file_get_provisional:
+ * @gfile        : a #GFile.
+ * @info         : a #GFileInfo with the basic attributes of @gfile, e.g. from a folder snapshot.
+ * @content_type : the content type of @gfile stored with @info, or %NULL.
+ *
+ * Like thunar_file_get_with_info(), but if the file is not cached yet, @info
+ * and @content_type are only used until the next scan of its folder passes the
+ * complete info to thunar_file_get_with_info() or thunar_file_get_with_infos().
+ * It is applied by thunar_file_apply_pending_info() then. A cached file keeps
+ * its info and content type.
+ *
+ * The caller is responsible to call g_object_unref()
+ * when done with the returned object.
+ *
+ * Return value: the #ThunarFile for @gfile.
+ **/
+ThunarFile *
+thunar_file_get_provisional (GFile       *gfile,
+                             GFileInfo   *info,
+                             const gchar *content_type)
+{
+  ThunarFileCacheShard *shard;
+  ThunarFile           *file;
 
-  if (recent_info != NULL)
-    file->recent_info = g_object_ref (recent_info);
+  _thunar_return_val_if_fail (G_IS_FILE (gfile), NULL);
+  _thunar_return_val_if_fail (G_IS_FILE_INFO (info), NULL);
+
+  shard = thunar_file_cache_lock (gfile);
+  file = thunar_file_cache_lookup_locked (shard, gfile);
+  if (G_LIKELY (file == NULL))
+    {
+      file = thunar_file_get_with_info_locked (shard, gfile, info, FALSE);
+      file->provisional = TRUE;
+      if (content_type != NULL)
+        thunar_file_set_content_type (file, content_type);
+    }
+  thunar_file_cache_unlock (shard);
 
   return file;
 }
 
 
 
+/**
+ * thunar_file_apply_pending_info:
+ * @file : a #ThunarFile.
+ *
+ * Replaces the info of a @file created by thunar_file_get_provisional()
+ * with the complete info, if a scan of its folder has seen the file since.
+ *
+ * Return value: %TRUE if the info of @file was replaced.
+ **/
+gboolean
+thunar_file_apply_pending_info (ThunarFile *file)
+{
+  ThunarFileCacheShard *shard;
+  GFileInfo            *info;
+  gchar                *content_type = NULL;
+
+  _thunar_return_val_if_fail (THUNAR_IS_FILE (file), FALSE);
+
+  /* only set in the main thread, so no need to lock here */
+  if (G_LIKELY (!file->provisional))
+    return FALSE;
+
+  shard = thunar_file_cache_lock (file->gfile);
+  info = g_steal_pointer (&file->pending_info);
+  if (info != NULL)
+    file->provisional = FALSE;
+  thunar_file_cache_unlock (shard);
+
+  if (info == NULL)
+    return FALSE;
+
+  /* the content type from the snapshot is still valid if the file was not modified */
+  if (g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED)
+      == g_file_info_get_attribute_uint64 (file->info, G_FILE_ATTRIBUTE_TIME_MODIFIED))
+    content_type = g_steal_pointer (&file->content_type);
+
+  thunar_icon_factory_clear_pixmap_cache (file);
+  thunar_file_info_clear (file);
+  file->info = info;
+  thunar_file_info_reload (file, NULL);
+
+  if (content_type != NULL)
+    {
+      thunar_file_set_content_type (file, content_type);
+      g_free (content_type);
+    }
+
+  return TRUE;
+}
+
+
+
+/**
+ * thunar_file_peek_content_type:
+ * @file : a #ThunarFile.
+ *
+ * Returns the content type of @file if it was already determined,
+ * unlike thunar_file_get_content_type() this never does any I/O.
+ *
+ * Return value: the content type of @file or %NULL.
+ **/
+const gchar *
+thunar_file_peek_content_type (const ThunarFile *file)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_FILE (file), NULL);
+  return file->content_type;
+}
+
+
+
 /**
  * thunar_file_get_for_uri:
  * @uri   : a URI or an absolute filename.
@@ -4640,32 +4971,61 @@ thunar_file_same_filesystem (const ThunarFile *file_a,
 ThunarFile *
 thunar_file_cache_lookup (const GFile *file)
 {
-  GWeakRef   *ref;
-  ThunarFile *cached_file;
+  ThunarFileCacheShard *shard;
+  ThunarFile           *cached_file;
 
   _thunar_return_val_if_fail (G_IS_FILE (file), NULL);
 
-  G_REC_LOCK (file_cache_mutex);
+  shard = thunar_file_cache_lock (file);
+  cached_file = thunar_file_cache_lookup_locked (shard, file);
+  thunar_file_cache_unlock (shard);
 
-  /* allocate the ThunarFile cache on-demand */
-  if (G_UNLIKELY (file_cache == NULL))
-    {
-      file_cache = g_hash_table_new_full (g_file_hash,
-                                          (GEqualFunc) g_file_equal,
-                                          (GDestroyNotify) g_object_unref,
-                                          (GDestroyNotify) weak_ref_free);
-    }
+  return cached_file;
+}
 
-  ref = g_hash_table_lookup (file_cache, file);
 
-  if (ref == NULL)
-    cached_file = NULL;
-  else
-    cached_file = g_weak_ref_get (ref);
 
-  G_REC_UNLOCK (file_cache_mutex);
+/**
+ * thunar_file_cache_get_stats:
+ * @n_files     : return location for the number of cached files or %NULL.
+ * @n_locks     : return location for the number of times the cache was locked or %NULL.
+ * @n_contended : return location for the number of times a thread had to wait
+ *                for the lock of the cache, or %NULL.
+ *
+ * Returns statistics about the global #ThunarFile cache, to measure
+ * the lock contention e.g. with many concurrent folder listings.
+ **/
+void
+thunar_file_cache_get_stats (guint   *n_files,
+                             guint64 *n_locks,
+                             guint64 *n_contended)
+{
+  ThunarFileCacheShard *shard;
 
-  return cached_file;
+  if (n_files != NULL)
+    *n_files = 0;
+  if (n_locks != NULL)
+    *n_locks = 0;
+  if (n_contended != NULL)
+    *n_contended = 0;
+
+  for (guint n = 0; n < THUNAR_FILE_CACHE_N_SHARDS; ++n)
+    {
+      shard = &file_cache[n];
+
+      /* read the statistics first, so we don't count ourselves */
+      if (n_locks != NULL)
+        *n_locks += (guint) g_atomic_int_get (&shard->n_locks);
+      if (n_contended != NULL)
+        *n_contended += (guint) g_atomic_int_get (&shard->n_contended);
+
+      if (n_files != NULL)
+        {
+          shard = thunar_file_cache_lock_shard (n);
+          *n_files += g_hash_table_size (shard->table);
+          thunar_file_cache_unlock (shard);
+        }
+    }
 }
 
 
@@ -5476,6 +5836,9 @@ thunar_file_changed_signal_timeout (gpointer data)
 void
 thunar_file_changed (ThunarFile *file)
 {
+  /* the emblems may have changed */
+  thunar_icon_factory_clear_surface_cache (file);
+
   /* in case a timeout is running, the change-signal will be delayed (performance) */
   if (file->signal_changed_source_id != 0)
     {
@@ -134,6 +134,25 @@ typedef void (*ThunarFileGetFunc) (GFile      *location,
                                    GError     *error,
                                    gpointer    user_data);
 
+/**
+ * ThunarFileInfoEntry:
+ * @gfile       : the #GFile to look up.
+ * @info        : the #GFileInfo to use when loading the info.
+ * @recent_info : additional #GFileInfo, only for files in `recent:///`, or %NULL.
+ * @not_mounted : if the file is not mounted.
+ * @file        : set to the #ThunarFile for @gfile by thunar_file_get_with_infos().
+ *
+ * One file of a batch passed to thunar_file_get_with_infos().
+ **/
+typedef struct
+{
+  GFile      *gfile;
+  GFileInfo  *info;
+  GFileInfo  *recent_info;
+  gboolean    not_mounted;
+  ThunarFile *file;
+} ThunarFileInfoEntry;
+
 
 
 GType
@@ -147,6 +166,15 @@ thunar_file_get_with_info (GFile     *file,
                            GFileInfo *info,
                            GFileInfo *recent_info,
                            gboolean   not_mounted);
+void
+thunar_file_get_with_infos (ThunarFileInfoEntry *entries,
+                            guint                n_entries);
+ThunarFile *
+thunar_file_get_provisional (GFile       *gfile,
+                             GFileInfo   *info,
+                             const gchar *content_type);
+gboolean
+thunar_file_apply_pending_info (ThunarFile *file);
 ThunarFile *
 thunar_file_get_for_uri (const gchar *uri,
                          GError     **error);
@@ -232,6 +260,8 @@ thunar_file_get_content_type (ThunarFile *file);
 void
 thunar_file_set_content_type (ThunarFile  *file,
                               const gchar *content_type);
+const gchar *
+thunar_file_peek_content_type (const ThunarFile *file);
 gchar *
 thunar_file_get_content_type_desc (ThunarFile *file,
                                    gboolean    add_link_target);
@@ -388,6 +418,10 @@ thunar_file_compare_by_name (const ThunarFile *file_a,
 
 ThunarFile *
 thunar_file_cache_lookup (const GFile *file);
+void
+thunar_file_cache_get_stats (guint   *n_files,
+                             guint64 *n_locks,
+                             guint64 *n_contended);
 gchar *
 thunar_file_cached_display_name (const GFile *file);
 
@@ -0,0 +1,607 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar Development Team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "thunar/thunar-folder-snapshot.h"
+#include "thunar/thunar-private.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+/**
+ * SECTION:thunar-folder-snapshot
+ * @Short_description: Stores the contents of folders on disk
+ * @Title: ThunarFolderSnapshot
+ *
+ * If the "misc-folder-snapshots" preference is set, the contents of a local folder
+ * are written to the user cache directory whenever the folder was scanned. When the
+ * folder is opened again, even in a later session, the snapshot is mapped into memory
+ * and shown right away, while the folder is scanned in the background.
+ *
+ * A snapshot is a header, followed by one fixed size record per file and a pool of
+ * NUL-terminated strings, all numbers in little endian. It is only used if the
+ * modification time of the folder is still the one stored in the header.
+ *
+ * Snapshots which were not written for SNAPSHOT_MAX_AGE are removed, and only the
+ * SNAPSHOT_MAX_COUNT most recently written ones are kept. */
+
+/* the first bytes of a snapshot, to be changed with the layout */
+#define SNAPSHOT_MAGIC "TFS1"
+
+/* magic, number of records, folder mtime (seconds, microseconds), offset of the folder uri in the pool, pool size */
+#define SNAPSHOT_HEADER_SIZE (32)
+
+/* type, flags, offsets of the name and content type in the pool, size, mtime (seconds, microseconds) */
+#define SNAPSHOT_RECORD_SIZE (40)
+
+/* content type offset of files without a known content type */
+#define SNAPSHOT_NO_STRING (G_MAXUINT32)
+
+/* record flags */
+#define SNAPSHOT_FLAG_HIDDEN     (1 << 0)
+#define SNAPSHOT_FLAG_BACKUP     (1 << 1)
+#define SNAPSHOT_FLAG_SYMLINK    (1 << 2)
+#define SNAPSHOT_FLAG_CAN_READ   (1 << 3)
+#define SNAPSHOT_FLAG_CAN_WRITE  (1 << 4)
+#define SNAPSHOT_FLAG_CAN_EXEC   (1 << 5)
+
+/* snapshots which were not written for this long are removed (30 days) */
+#define SNAPSHOT_MAX_AGE (G_GINT64_CONSTANT (30) * 24 * 60 * 60)
+
+/* the number of snapshots kept, the least recently written ones are removed first */
+#define SNAPSHOT_MAX_COUNT (1000)
+
+/* the snapshots are pruned on the first save and then after this many saves */
+#define SNAPSHOT_PRUNE_INTERVAL (100)
+
+
+
+typedef struct
+{
+  gchar *path;
+  gint64 mtime;
+} ThunarFolderSnapshotEntry;
+
+/* a snapshot to be written by thunar_folder_snapshot_write_thread() */
+typedef struct
+{
+  gchar  *path;
+  GBytes *bytes;
+} ThunarFolderSnapshotWrite;
+
+
+
+/* the number of snapshots saved since the last pruning, -1 before the first one */
+static gint     snapshot_n_saved = -1;
+static gboolean snapshot_pruning = FALSE;
+
+
+
+static gchar *
+thunar_folder_snapshot_get_dirname (void)
+{
+  return g_build_filename (g_get_user_cache_dir (), "Thunar", "snapshots", NULL);
+}
+
+
+
+static gchar *
+thunar_folder_snapshot_get_path (ThunarFile *folder)
+{
+  gchar *uri;
+  gchar *checksum;
+  gchar *dirname;
+  gchar *path;
+
+  uri = g_file_get_uri (thunar_file_get_file (folder));
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_MD5, uri, -1);
+  dirname = thunar_folder_snapshot_get_dirname ();
+  path = g_build_filename (dirname, checksum, NULL);
+  g_free (dirname);
+  g_free (checksum);
+  g_free (uri);
+
+  return path;
+}
+
+
+
+static inline guint32
+thunar_folder_snapshot_get_u32 (const guint8 *p)
+{
+  guint32 value;
+
+  memcpy (&value, p, sizeof (value));
+  return GUINT32_FROM_LE (value);
+}
+
+
+
+static inline guint64
+thunar_folder_snapshot_get_u64 (const guint8 *p)
+{
+  guint64 value;
+
+  memcpy (&value, p, sizeof (value));
+  return GUINT64_FROM_LE (value);
+}
+
+
+
+static inline void
+thunar_folder_snapshot_put_u32 (GByteArray *data,
+                                guint32     value)
+{
+  value = GUINT32_TO_LE (value);
+  g_byte_array_append (data, (const guint8 *) &value, sizeof (value));
+}
+
+
+
+static inline void
+thunar_folder_snapshot_put_u64 (GByteArray *data,
+                                guint64     value)
+{
+  value = GUINT64_TO_LE (value);
+  g_byte_array_append (data, (const guint8 *) &value, sizeof (value));
+}
+
+
+
+/* appends @str to the string @pool, unless it's already there, and returns its offset */
+static guint32
+thunar_folder_snapshot_put_string (GByteArray  *pool,
+                                   GHashTable  *offsets,
+                                   const gchar *str)
+{
+  gpointer offset;
+
+  if (offsets != NULL && g_hash_table_lookup_extended (offsets, str, NULL, &offset))
+    return GPOINTER_TO_UINT (offset);
+
+  offset = GUINT_TO_POINTER (pool->len);
+  g_byte_array_append (pool, (const guint8 *) str, strlen (str) + 1);
+
+  if (offsets != NULL)
+    g_hash_table_insert (offsets, g_strdup (str), offset);
+
+  return GPOINTER_TO_UINT (offset);
+}
+
+
+
+static GFileInfo *
+thunar_folder_snapshot_read_record (const guint8 *record,
+                                    const gchar  *pool,
+                                    guint32       pool_size)
+{
+  GFileInfo   *info;
+  const gchar *name;
+  gchar       *display_name;
+  guint32      flags;
+  guint32      offset;
+
+  offset = thunar_folder_snapshot_get_u32 (record + 8);
+  if (G_UNLIKELY (offset >= pool_size))
+    return NULL;
+  name = pool + offset;
+
+  flags = thunar_folder_snapshot_get_u32 (record + 4);
+
+  info = g_file_info_new ();
+  g_file_info_set_name (info, name);
+  display_name = g_filename_display_name (name);
+  g_file_info_set_display_name (info, display_name);
+  g_free (display_name);
+  g_file_info_set_file_type (info, (GFileType) thunar_folder_snapshot_get_u32 (record));
+  g_file_info_set_is_hidden (info, (flags & SNAPSHOT_FLAG_HIDDEN) != 0);
+  g_file_info_set_is_backup (info, (flags & SNAPSHOT_FLAG_BACKUP) != 0);
+  g_file_info_set_is_symlink (info, (flags & SNAPSHOT_FLAG_SYMLINK) != 0);
+  g_file_info_set_attribute_boolean (info, G_FILE_ATTRIBUTE_ACCESS_CAN_READ, (flags & SNAPSHOT_FLAG_CAN_READ) != 0);
+  g_file_info_set_attribute_boolean (info, G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE, (flags & SNAPSHOT_FLAG_CAN_WRITE) != 0);
+  g_file_info_set_attribute_boolean (info, G_FILE_ATTRIBUTE_ACCESS_CAN_EXECUTE, (flags & SNAPSHOT_FLAG_CAN_EXEC) != 0);
+  g_file_info_set_size (info, thunar_folder_snapshot_get_u64 (record + 16));
+  g_file_info_set_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED, thunar_folder_snapshot_get_u64 (record + 24));
+  g_file_info_set_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC, thunar_folder_snapshot_get_u32 (record + 32));
+
+  return info;
+}
+
+
+
+/**
+ * thunar_folder_snapshot_load:
+ * @folder : the #ThunarFile of a folder.
+ *
+ * Returns the files stored in the snapshot of @folder, if there is one
+ * and the folder was not modified since the snapshot was written.
+ * Files which are not known yet are created with the info of the
+ * snapshot, see thunar_file_get_provisional().
+ *
+ * Return value: (transfer full): the #GList of #ThunarFile<!---->s, to be
+ *               released with thunar_g_list_free_full(), or %NULL.
+ **/
+GList *
+thunar_folder_snapshot_load (ThunarFile *folder)
+{
+  GMappedFile  *mapped;
+  GFileInfo    *folder_info;
+  GFileInfo    *info;
+  GFile        *gfile;
+  GList        *files = NULL;
+  const guint8 *data;
+  const guint8 *record;
+  const gchar  *pool = NULL;
+  gchar        *path;
+  gchar        *uri;
+  ThunarFile   *file;
+  gsize         length;
+  guint32       n_records;
+  guint32       pool_size;
+  guint32       offset;
+  gboolean      valid;
+
+  _thunar_return_val_if_fail (THUNAR_IS_FILE (folder), NULL);
+
+  folder_info = thunar_file_get_info (folder);
+  if (folder_info == NULL || !g_file_info_has_attribute (folder_info, G_FILE_ATTRIBUTE_TIME_MODIFIED))
+    return NULL;
+
+  path = thunar_folder_snapshot_get_path (folder);
+  mapped = g_mapped_file_new (path, FALSE, NULL);
+  g_free (path);
+
+  if (mapped == NULL)
+    return NULL;
+
+  data = (const guint8 *) g_mapped_file_get_contents (mapped);
+  length = g_mapped_file_get_length (mapped);
+
+  /* check the layout, the strings in the pool must be terminated */
+  valid = length >= SNAPSHOT_HEADER_SIZE && memcmp (data, SNAPSHOT_MAGIC, 4) == 0;
+  n_records = valid ? thunar_folder_snapshot_get_u32 (data + 4) : 0;
+  pool_size = valid ? thunar_folder_snapshot_get_u32 (data + 24) : 0;
+  valid = valid
+          && pool_size > 0
+          && n_records <= (length - SNAPSHOT_HEADER_SIZE) / SNAPSHOT_RECORD_SIZE
+          && length == SNAPSHOT_HEADER_SIZE + (gsize) n_records * SNAPSHOT_RECORD_SIZE + pool_size
+          && data[length - 1] == '\0';
+
+  /* a snapshot of a modified folder is stale */
+  valid = valid
+          && thunar_folder_snapshot_get_u64 (data + 8) == g_file_info_get_attribute_uint64 (folder_info, G_FILE_ATTRIBUTE_TIME_MODIFIED)
+          && thunar_folder_snapshot_get_u32 (data + 16) == g_file_info_get_attribute_uint32 (folder_info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+
+  /* make sure the snapshot belongs to this folder */
+  if (valid)
+    {
+      pool = (const gchar *) data + SNAPSHOT_HEADER_SIZE + (gsize) n_records * SNAPSHOT_RECORD_SIZE;
+      offset = thunar_folder_snapshot_get_u32 (data + 20);
+      uri = g_file_get_uri (thunar_file_get_file (folder));
+      valid = offset < pool_size && strcmp (pool + offset, uri) == 0;
+      g_free (uri);
+    }
+
+  for (record = data + SNAPSHOT_HEADER_SIZE; valid && n_records > 0; --n_records, record += SNAPSHOT_RECORD_SIZE)
+    {
+      info = thunar_folder_snapshot_read_record (record, pool, pool_size);
+      if (G_UNLIKELY (info == NULL))
+        break;
+
+      /* the content type is loaded on demand otherwise */
+      offset = thunar_folder_snapshot_get_u32 (record + 12);
+
+      gfile = g_file_get_child (thunar_file_get_file (folder), g_file_info_get_name (info));
+      file = thunar_file_get_provisional (gfile, info, offset < pool_size ? pool + offset : NULL);
+      g_object_unref (gfile);
+      g_object_unref (info);
+
+      files = g_list_prepend (files, file);
+    }
+
+  g_mapped_file_unref (mapped);
+
+  return files;
+}
+
+
+
+static void
+thunar_folder_snapshot_write_free (gpointer data)
+{
+  ThunarFolderSnapshotWrite *write = data;
+
+  g_free (write->path);
+  g_bytes_unref (write->bytes);
+  g_slice_free (ThunarFolderSnapshotWrite, write);
+}
+
+
+
+static void
+thunar_folder_snapshot_write_thread (GTask        *task,
+                                     gpointer      source_object,
+                                     gpointer      task_data,
+                                     GCancellable *cancellable)
+{
+  ThunarFolderSnapshotWrite *write = task_data;
+  GError                    *error = NULL;
+  GFile                     *snapshot;
+  gchar                     *dirname;
+
+  dirname = g_path_get_dirname (write->path);
+  g_mkdir_with_parents (dirname, 0700);
+  g_free (dirname);
+
+  /* the snapshot is replaced atomically, so a mapped one stays intact */
+  snapshot = g_file_new_for_path (write->path);
+  if (g_file_replace_contents (snapshot,
+                               g_bytes_get_data (write->bytes, NULL), g_bytes_get_size (write->bytes),
+                               NULL, FALSE, G_FILE_CREATE_PRIVATE, NULL, cancellable, &error))
+    g_task_return_boolean (task, TRUE);
+  else
+    g_task_return_error (task, error);
+  g_object_unref (snapshot);
+}
+
+
+
+static void
+thunar_folder_snapshot_saved (GObject      *object,
+                              GAsyncResult *result,
+                              gpointer      user_data)
+{
+  GError *error = NULL;
+
+  if (!g_task_propagate_boolean (G_TASK (result), &error))
+    {
+      g_debug ("Failed to write folder snapshot: %s", error->message);
+      g_error_free (error);
+    }
+}
+
+
+
+static gint
+thunar_folder_snapshot_entry_compare (gconstpointer a,
+                                      gconstpointer b)
+{
+  const ThunarFolderSnapshotEntry *entry_a = a;
+  const ThunarFolderSnapshotEntry *entry_b = b;
+
+  /* most recently written first */
+  return (entry_a->mtime < entry_b->mtime) - (entry_a->mtime > entry_b->mtime);
+}
+
+
+
+/* removes all snapshots if @task_data is set, otherwise the old ones
+ * and the least recently written ones exceeding SNAPSHOT_MAX_COUNT */
+static void
+thunar_folder_snapshot_prune_thread (GTask        *task,
+                                     gpointer      source_object,
+                                     gpointer      task_data,
+                                     GCancellable *cancellable)
+{
+  ThunarFolderSnapshotEntry *entry;
+  GStatBuf                   statb;
+  GArray                    *entries;
+  GDir                      *dir;
+  const gchar               *name;
+  gchar                     *dirname;
+  gchar                     *path;
+  gint64                     now;
+  gboolean                   clear = GPOINTER_TO_INT (task_data);
+  guint                      n;
+
+  dirname = thunar_folder_snapshot_get_dirname ();
+  dir = g_dir_open (dirname, 0, NULL);
+  if (dir == NULL)
+    {
+      g_free (dirname);
+      return;
+    }
+
+  entries = g_array_new (FALSE, FALSE, sizeof (ThunarFolderSnapshotEntry));
+  now = g_get_real_time () / G_USEC_PER_SEC;
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      /* skip the temporary files of snapshots being written */
+      if (name[0] == '.')
+        continue;
+
+      path = g_build_filename (dirname, name, NULL);
+      if (!clear && g_stat (path, &statb) != 0)
+        {
+          g_free (path);
+        }
+      else if (clear || now - (gint64) statb.st_mtime > SNAPSHOT_MAX_AGE)
+        {
+          g_remove (path);
+          g_free (path);
+        }
+      else
+        {
+          g_array_set_size (entries, entries->len + 1);
+          entry = &g_array_index (entries, ThunarFolderSnapshotEntry, entries->len - 1);
+          entry->path = path;
+          entry->mtime = statb.st_mtime;
+        }
+    }
+  g_dir_close (dir);
+
+  /* drop the least recently written snapshots, the folders were not visited since */
+  if (entries->len > SNAPSHOT_MAX_COUNT)
+    {
+      g_array_sort (entries, thunar_folder_snapshot_entry_compare);
+      for (n = SNAPSHOT_MAX_COUNT; n < entries->len; ++n)
+        g_remove (g_array_index (entries, ThunarFolderSnapshotEntry, n).path);
+    }
+
+  for (n = 0; n < entries->len; ++n)
+    g_free (g_array_index (entries, ThunarFolderSnapshotEntry, n).path);
+  g_array_free (entries, TRUE);
+  g_free (dirname);
+}
+
+
+
+static void
+thunar_folder_snapshot_pruned (GObject      *object,
+                               GAsyncResult *result,
+                               gpointer      user_data)
+{
+  snapshot_pruning = FALSE;
+}
+
+
+
+static void
+thunar_folder_snapshot_prune (gboolean clear)
+{
+  GTask *task;
+
+  snapshot_pruning = TRUE;
+  snapshot_n_saved = 0;
+
+  task = g_task_new (NULL, NULL, thunar_folder_snapshot_pruned, NULL);
+  g_task_set_task_data (task, GINT_TO_POINTER (clear), NULL);
+  g_task_run_in_thread (task, thunar_folder_snapshot_prune_thread);
+  g_object_unref (task);
+}
+
+
+
+/**
+ * thunar_folder_snapshot_clear:
+ *
+ * Removes all folder snapshots in the background, e.g. after
+ * the "misc-folder-snapshots" preference was switched off.
+ **/
+void
+thunar_folder_snapshot_clear (void)
+{
+  thunar_folder_snapshot_prune (TRUE);
+}
+
+
+
+/**
+ * thunar_folder_snapshot_save:
+ * @folder : the #ThunarFile of a folder.
+ * @files  : the #ThunarFile<!---->s in @folder, as keys of a #GHashTable.
+ *
+ * Writes the snapshot of @folder in the background, replacing
+ * the previous one.
+ **/
+void
+thunar_folder_snapshot_save (ThunarFile *folder,
+                             GHashTable *files)
+{
+  ThunarFolderSnapshotWrite *write;
+  GHashTableIter             iter;
+  GHashTable                *offsets;
+  GFileInfo                 *folder_info;
+  GFileInfo                 *info;
+  GByteArray                *data;
+  GByteArray                *pool;
+  GTask                     *task;
+  gpointer                   key;
+  const gchar               *content_type;
+  gchar                     *uri;
+  guint32                    flags;
+  guint32                    pool_size;
+
+  _thunar_return_if_fail (THUNAR_IS_FILE (folder));
+  _thunar_return_if_fail (files != NULL);
+
+  folder_info = thunar_file_get_info (folder);
+  if (folder_info == NULL || !g_file_info_has_attribute (folder_info, G_FILE_ATTRIBUTE_TIME_MODIFIED))
+    return;
+
+  data = g_byte_array_sized_new (SNAPSHOT_HEADER_SIZE + g_hash_table_size (files) * SNAPSHOT_RECORD_SIZE);
+  pool = g_byte_array_new ();
+
+  /* most content types are shared by many files */
+  offsets = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  uri = g_file_get_uri (thunar_file_get_file (folder));
+  g_byte_array_append (data, (const guint8 *) SNAPSHOT_MAGIC, 4);
+  thunar_folder_snapshot_put_u32 (data, g_hash_table_size (files));
+  thunar_folder_snapshot_put_u64 (data, g_file_info_get_attribute_uint64 (folder_info, G_FILE_ATTRIBUTE_TIME_MODIFIED));
+  thunar_folder_snapshot_put_u32 (data, g_file_info_get_attribute_uint32 (folder_info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC));
+  thunar_folder_snapshot_put_u32 (data, thunar_folder_snapshot_put_string (pool, NULL, uri));
+  thunar_folder_snapshot_put_u32 (data, 0); /* pool size, see below */
+  thunar_folder_snapshot_put_u32 (data, 0);
+  g_free (uri);
+
+  g_hash_table_iter_init (&iter, files);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      info = thunar_file_get_info (key);
+      _thunar_assert (info != NULL);
+
+      flags = 0;
+      if (g_file_info_get_is_hidden (info))
+        flags |= SNAPSHOT_FLAG_HIDDEN;
+      if (g_file_info_get_is_backup (info))
+        flags |= SNAPSHOT_FLAG_BACKUP;
+      if (g_file_info_get_is_symlink (info))
+        flags |= SNAPSHOT_FLAG_SYMLINK;
+      if (g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_ACCESS_CAN_READ))
+        flags |= SNAPSHOT_FLAG_CAN_READ;
+      if (g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE))
+        flags |= SNAPSHOT_FLAG_CAN_WRITE;
+      if (g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_ACCESS_CAN_EXECUTE))
+        flags |= SNAPSHOT_FLAG_CAN_EXEC;
+
+      content_type = thunar_file_peek_content_type (key);
+
+      thunar_folder_snapshot_put_u32 (data, g_file_info_get_file_type (info));
+      thunar_folder_snapshot_put_u32 (data, flags);
+      thunar_folder_snapshot_put_u32 (data, thunar_folder_snapshot_put_string (pool, NULL, g_file_info_get_name (info)));
+      thunar_folder_snapshot_put_u32 (data, content_type != NULL ? thunar_folder_snapshot_put_string (pool, offsets, content_type) : SNAPSHOT_NO_STRING);
+      thunar_folder_snapshot_put_u64 (data, g_file_info_get_size (info));
+      thunar_folder_snapshot_put_u64 (data, g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED));
+      thunar_folder_snapshot_put_u32 (data, g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC));
+      thunar_folder_snapshot_put_u32 (data, 0);
+    }
+
+  /* patch the pool size into the header */
+  pool_size = GUINT32_TO_LE (pool->len);
+  memcpy (data->data + 24, &pool_size, sizeof (pool_size));
+  g_byte_array_append (data, pool->data, pool->len);
+
+  g_hash_table_destroy (offsets);
+  g_byte_array_unref (pool);
+
+  /* keep the number and age of the snapshots in bounds */
+  if (!snapshot_pruning && (snapshot_n_saved < 0 || ++snapshot_n_saved >= SNAPSHOT_PRUNE_INTERVAL))
+    thunar_folder_snapshot_prune (FALSE);
+
+  /* the snapshot directory is created by the thread as well */
+  write = g_slice_new (ThunarFolderSnapshotWrite);
+  write->path = thunar_folder_snapshot_get_path (folder);
+  write->bytes = g_byte_array_free_to_bytes (data);
+
+  task = g_task_new (NULL, NULL, thunar_folder_snapshot_saved, NULL);
+  g_task_set_task_data (task, write, thunar_folder_snapshot_write_free);
+  g_task_run_in_thread (task, thunar_folder_snapshot_write_thread);
+  g_object_unref (task);
+}
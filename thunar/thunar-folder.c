@@ -18,11 +18,15 @@
  * Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include "thunar/thunar-folder-snapshot.h"
 #include "thunar/thunar-folder.h"
+#include "thunar/thunar-gio-extensions.h"
 #include "thunar/thunar-gobject-extensions.h"
 #include "thunar/thunar-io-jobs.h"
 #include "thunar/thunar-job.h"
+#include "thunar/thunar-preferences.h"
 #include "thunar/thunar-private.h"
+#include "thunar/thunar-trace.h"
 
 #include <libxfce4util/libxfce4util.h>
 
@@ -31,6 +35,13 @@
 /* The maximum throttle interval (in ms) in which files will be added, removed or notified to be changed */
 #define THUNAR_FOLDER_UPDATE_TIMEOUT (25)
 
+/* The maximum number of remote folder listings which are kept after the folder is gone */
+#define THUNAR_FOLDER_LISTING_CACHE_SIZE (16)
+
+/* The attributes used to revalidate a cached listing */
+#define THUNAR_FOLDER_VALIDATOR_ATTRIBUTES \
+  G_FILE_ATTRIBUTE_ETAG_VALUE "," G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC
+
 /* property identifiers */
 enum
 {
@@ -113,6 +124,8 @@ static void
 thunar_folder_thumbnail_updated (ThunarFolder       *folder,
                                  ThunarThumbnailSize size,
                                  ThunarFile         *file);
+static void
+thunar_folder_start_job (ThunarFolder *folder);
 
 
 
@@ -175,12 +188,39 @@ struct _ThunarFolder
 
   /* True if all files of the directory are available as ThunarFiles */
   gboolean loaded;
+
+  /* remote folders only: queries the etag/mtime of the folder before it is listed */
+  GCancellable *validate_cancellable;
+
+  /* the etag/mtime of the folder when the running job was started, NULL if unknown */
+  gchar *validator;
+
+  /* True if the files were restored from the listing cache and still need to be revalidated */
+  gboolean listing_cached;
+
+  /* True if the running job reported an error, so its listing is incomplete */
+  gboolean job_failed;
+
+  /* number of views currently showing the folder */
+  guint n_displayed;
 };
 
 
 
-static guint  folder_signals[LAST_SIGNAL];
-static GQuark thunar_folder_quark;
+/* The last listing of a remote folder, used to show the folder right away
+ * on the next visit while it is revalidated in the background */
+typedef struct
+{
+  gchar *validator;
+  GList *files;
+  gint64 stamp;
+} ThunarFolderListing;
+
+
+
+static guint       folder_signals[LAST_SIGNAL];
+static GQuark      thunar_folder_quark;
+static GHashTable *listing_cache = NULL;
 
 
 
@@ -428,6 +468,14 @@ thunar_folder_finalize (GObject *object)
       folder->job = NULL;
     }
 
+  /* cancel the pending validation (if any) */
+  if (G_UNLIKELY (folder->validate_cancellable != NULL))
+    {
+      g_cancellable_cancel (folder->validate_cancellable);
+      g_object_unref (folder->validate_cancellable);
+    }
+  g_free (folder->validator);
+
   /* disconnect from the corresponding file */
   if (G_LIKELY (folder->corresponding_file != NULL))
     {
@@ -553,6 +601,9 @@ _thunar_folder_files_update_timeout (gpointer data)
   GHashTable    *files = g_hash_table_new_full (g_direct_hash, NULL, g_object_unref, NULL);
   GHashTableIter iter;
   gpointer       key;
+  gint64         trace_time;
+
+  trace_time = thunar_trace_begin ();
 
   /* send a 'files-removed' signal for all files which were removed */
   g_hash_table_iter_init (&iter, folder->removed_files_map);
@@ -610,7 +661,7 @@ _thunar_folder_files_update_timeout (gpointer data)
   g_hash_table_remove_all (folder->changed_files_map);
 
   /* Loading is done for this folder */
-  if (folder->loaded == FALSE && folder->job == NULL)
+  if (folder->loaded == FALSE && folder->job == NULL && folder->validate_cancellable == NULL)
     {
       folder->loaded = TRUE;
       g_object_notify (G_OBJECT (folder), "loading");
@@ -618,6 +669,9 @@ _thunar_folder_files_update_timeout (gpointer data)
 
   folder->files_update_timeout_source_id = 0;
 
+  thunar_trace_end_detail (trace_time, "folder", "_thunar_folder_files_update_timeout", "%s",
+                           folder->corresponding_file != NULL ? thunar_file_get_display_name (folder->corresponding_file) : "");
+
   return G_SOURCE_REMOVE;
 }
 
@@ -686,6 +740,160 @@ thunar_folder_real_destroy (ThunarFolder *folder)
 
 
 
+static void
+thunar_folder_listing_free (gpointer data)
+{
+  ThunarFolderListing *listing = data;
+
+  thunar_g_list_free_full (listing->files);
+  g_free (listing->validator);
+  g_slice_free (ThunarFolderListing, listing);
+}
+
+
+
+/* TRUE for folders on remote backends (sftp://, smb://, dav://, ...), for which the listing is cached */
+static gboolean
+thunar_folder_is_remote (ThunarFolder *folder)
+{
+  GFile *gfile = thunar_file_get_file (folder->corresponding_file);
+
+  return !g_file_is_native (gfile)
+         && !thunar_g_file_is_trash (gfile)
+         && !thunar_g_file_is_recent (gfile)
+         && !thunar_g_file_is_computer (gfile)
+         && !thunar_g_file_is_network (gfile);
+}
+
+
+
+/* returns the etag of the folder or, if the backend does not provide one, its mtime */
+static gchar *
+thunar_folder_get_validator (GFileInfo *info)
+{
+  const gchar *etag;
+
+  etag = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_ETAG_VALUE);
+  if (etag != NULL)
+    return g_strconcat ("etag:", etag, NULL);
+
+  if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_TIME_MODIFIED))
+    return g_strdup_printf ("mtime:%" G_GUINT64_FORMAT ".%06u",
+                            g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED),
+                            g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC));
+
+  return NULL;
+}
+
+
+
+/* remembers the files just loaded by the job, together with the validator of the folder */
+static void
+thunar_folder_listing_store (ThunarFolder *folder)
+{
+  ThunarFolderListing *listing;
+  GHashTableIter       iter;
+  gpointer             key, value;
+  gpointer             oldest = NULL;
+  gint64               oldest_stamp = G_MAXINT64;
+
+  if (G_UNLIKELY (listing_cache == NULL))
+    listing_cache = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal, g_object_unref, thunar_folder_listing_free);
+
+  /* drop the least recently used listing if the cache is full */
+  if (g_hash_table_size (listing_cache) >= THUNAR_FOLDER_LISTING_CACHE_SIZE
+      && !g_hash_table_contains (listing_cache, thunar_file_get_file (folder->corresponding_file)))
+    {
+      g_hash_table_iter_init (&iter, listing_cache);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+          listing = value;
+          if (listing->stamp < oldest_stamp)
+            {
+              oldest_stamp = listing->stamp;
+              oldest = key;
+            }
+        }
+      g_hash_table_remove (listing_cache, oldest);
+    }
+
+  listing = g_slice_new0 (ThunarFolderListing);
+  listing->validator = g_strdup (folder->validator);
+  listing->stamp = g_get_monotonic_time ();
+
+  g_hash_table_iter_init (&iter, folder->loaded_files_map);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    listing->files = g_list_prepend (listing->files, g_object_ref (key));
+
+  g_hash_table_replace (listing_cache, g_object_ref (thunar_file_get_file (folder->corresponding_file)), listing);
+}
+
+
+
+/* shows the cached listing of the folder right away, returns TRUE if there was one */
+static gboolean
+thunar_folder_listing_restore (ThunarFolder *folder)
+{
+  ThunarFolderListing *listing;
+  GHashTable          *files;
+  GList               *lp;
+
+  if (listing_cache == NULL)
+    return FALSE;
+
+  listing = g_hash_table_lookup (listing_cache, thunar_file_get_file (folder->corresponding_file));
+  if (listing == NULL)
+    return FALSE;
+
+  listing->stamp = g_get_monotonic_time ();
+
+  files = g_hash_table_new_full (g_direct_hash, NULL, g_object_unref, NULL);
+  for (lp = listing->files; lp != NULL; lp = lp->next)
+    if (_thunar_folder_add_file (folder, lp->data))
+      g_hash_table_add (files, g_object_ref (lp->data));
+
+  g_signal_emit (G_OBJECT (folder), folder_signals[FILES_ADDED], 0, files);
+  g_hash_table_destroy (files);
+
+  return TRUE;
+}
+
+
+
+/* TRUE if the contents of the (local) folder are kept in a snapshot on disk */
+static gboolean
+thunar_folder_use_snapshots (ThunarFolder *folder)
+{
+  ThunarPreferences *preferences;
+  gboolean           folder_snapshots;
+
+  if (!thunar_file_is_local (folder->corresponding_file))
+    return FALSE;
+
+  preferences = thunar_preferences_get ();
+  g_object_get (G_OBJECT (preferences), "misc-folder-snapshots", &folder_snapshots, NULL);
+  g_object_unref (preferences);
+
+  return folder_snapshots;
+}
+
+
+
+/* adds the files of the snapshot to the new folder, they are reconciled when the scan finished */
+static void
+thunar_folder_restore_snapshot (ThunarFolder *folder)
+{
+  GList *files;
+  GList *lp;
+
+  files = thunar_folder_snapshot_load (folder->corresponding_file);
+  for (lp = files; lp != NULL; lp = lp->next)
+    _thunar_folder_add_file (folder, lp->data);
+  thunar_g_list_free_full (files);
+}
+
+
+
 static void
 thunar_folder_error (ThunarJob    *job,
                      GError       *error,
@@ -694,6 +902,12 @@ thunar_folder_error (ThunarJob    *job,
   _thunar_return_if_fail (THUNAR_IS_FOLDER (folder));
   _thunar_return_if_fail (THUNAR_IS_JOB (job));
 
+  /* don't remember an incomplete listing, and forget the one of the last visit */
+  folder->job_failed = TRUE;
+  g_clear_pointer (&folder->validator, g_free);
+  if (listing_cache != NULL)
+    g_hash_table_remove (listing_cache, thunar_file_get_file (folder->corresponding_file));
+
   /* tell the consumer about the problem */
   g_signal_emit (G_OBJECT (folder), folder_signals[ERROR], 0, error);
 }
@@ -765,6 +979,8 @@ thunar_folder_finished (ThunarJob    *job,
                         ThunarFolder *folder)
 {
   GHashTableIter iter;
+  GHashTable    *changed_files = NULL;
+  GFileInfo     *info;
   gpointer       key;
   gboolean       file_list_changed = FALSE;
 
@@ -796,6 +1012,37 @@ thunar_folder_finished (ThunarJob    *job,
       file_list_changed = TRUE;
     }
 
+  /* files restored from a snapshot get the complete info of the scan now */
+  g_hash_table_iter_init (&iter, folder->loaded_files_map);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      if (!thunar_file_apply_pending_info (THUNAR_FILE (key)) || !g_hash_table_contains (folder->files_map, key))
+        continue;
+
+      if (changed_files == NULL)
+        changed_files = g_hash_table_new_full (g_direct_hash, NULL, g_object_unref, NULL);
+      g_hash_table_add (changed_files, g_object_ref (key));
+    }
+
+  if (changed_files != NULL)
+    {
+      g_signal_emit (G_OBJECT (folder), folder_signals[FILES_CHANGED], 0, changed_files);
+      g_hash_table_destroy (changed_files);
+    }
+
+  /* without a cached listing, the job determined the etag/mtime of the folder before listing it */
+  info = g_object_get_data (G_OBJECT (job), "directory-info");
+  if (folder->validator == NULL && !folder->job_failed && info != NULL && thunar_folder_is_remote (folder))
+    folder->validator = thunar_folder_get_validator (info);
+
+  /* remember the listing of remote folders for the next visit, the validator is dropped if the job failed */
+  if (folder->validator != NULL)
+    thunar_folder_listing_store (folder);
+
+  /* remember the contents of local folders for the next visit */
+  if (!folder->job_failed && thunar_folder_use_snapshots (folder))
+    thunar_folder_snapshot_save (folder->corresponding_file, folder->loaded_files_map);
+
   /* drop all mappings for new_files list too */
   g_hash_table_remove_all (folder->loaded_files_map);
 
@@ -1178,6 +1425,10 @@ thunar_folder_get_for_file (ThunarFile *file)
       /* connect the folder to the file */
       g_object_set_qdata (G_OBJECT (file), thunar_folder_quark, folder);
 
+      /* show the last known contents until the folder is scanned */
+      if (thunar_folder_use_snapshots (folder))
+        thunar_folder_restore_snapshot (folder);
+
       /* schedule the loading of the folder */
       thunar_folder_reload (folder, FALSE);
     }
@@ -1261,6 +1512,90 @@ thunar_folder_has_folder_monitor (const ThunarFolder *folder)
 
 
 
+static void
+thunar_folder_validated (GObject      *object,
+                         GAsyncResult *result,
+                         gpointer      user_data)
+{
+  ThunarFolderListing *listing;
+  ThunarFolder        *folder;
+  GFileInfo           *info;
+  GError              *error = NULL;
+
+  info = g_file_query_info_finish (G_FILE (object), result, &error);
+
+  /* the folder may already be gone if the query was cancelled */
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_error_free (error);
+      return;
+    }
+
+  folder = THUNAR_FOLDER (user_data);
+  g_clear_object (&folder->validate_cancellable);
+
+  /* without an etag or mtime the listing is not cached, errors are reported by the job */
+  if (info != NULL)
+    {
+      folder->validator = thunar_folder_get_validator (info);
+      g_object_unref (info);
+    }
+  g_clear_error (&error);
+
+  /* the cached listing is still up to date, no need to list the folder again */
+  if (folder->listing_cached && folder->validator != NULL)
+    {
+      listing = g_hash_table_lookup (listing_cache, thunar_file_get_file (folder->corresponding_file));
+      if (listing != NULL && g_strcmp0 (listing->validator, folder->validator) == 0)
+        {
+          folder->listing_cached = FALSE;
+          folder->loaded = TRUE;
+          g_object_notify (G_OBJECT (folder), "loading");
+
+          /* the etag/mtime of a folder does not cover changes of the files inside,
+           * so they are still refreshed once per visit, without blocking the user */
+          thunar_folder_start_job (folder);
+          thunar_job_set_priority (folder->job, THUNAR_JOB_PRIORITY_BACKGROUND);
+          return;
+        }
+    }
+
+  folder->listing_cached = FALSE;
+  thunar_folder_start_job (folder);
+}
+
+
+
+/**
+ * thunar_folder_set_displayed:
+ * @folder    : a #ThunarFolder instance.
+ * @displayed : %TRUE when a view starts showing @folder, %FALSE when it stops.
+ *
+ * Tells the @folder whether it is shown in a view. A listing the user
+ * navigated away from, before it finished, no longer competes with the
+ * folder the user is waiting for, and gets its priority back when a view
+ * shows the @folder again.
+ **/
+void
+thunar_folder_set_displayed (ThunarFolder *folder,
+                             gboolean      displayed)
+{
+  _thunar_return_if_fail (THUNAR_IS_FOLDER (folder));
+
+  /* the view may outlive a folder which was destroyed and created anew */
+  if (displayed)
+    folder->n_displayed++;
+  else if (folder->n_displayed > 0)
+    folder->n_displayed--;
+  else
+    return;
+
+  if (folder->job != NULL && folder->n_displayed <= 1)
+    thunar_job_set_priority (folder->job, folder->n_displayed > 0 ? THUNAR_JOB_PRIORITY_INTERACTIVE : THUNAR_JOB_PRIORITY_BACKGROUND);
+}
+
+
+
 /**
  * thunar_folder_reload:
  * @folder : a #ThunarFolder instance.
@@ -1278,6 +1613,15 @@ thunar_folder_reload (ThunarFolder *folder,
   /* reload file info too? */
   folder->reload_info = reload_info;
 
+  /* stop a pending validation */
+  if (G_UNLIKELY (folder->validate_cancellable != NULL))
+    {
+      g_cancellable_cancel (folder->validate_cancellable);
+      g_clear_object (&folder->validate_cancellable);
+    }
+  g_clear_pointer (&folder->validator, g_free);
+  folder->listing_cached = FALSE;
+
   /* stop content type loading */
   if (G_UNLIKELY (folder->content_type_job != NULL))
     thunar_job_cancel (THUNAR_JOB (folder->content_type_job));
@@ -1298,14 +1642,49 @@ thunar_folder_reload (ThunarFolder *folder,
   folder->loaded = FALSE;
   g_object_notify (G_OBJECT (folder), "loading");
 
+  if (thunar_folder_is_remote (folder))
+    {
+      /* show the last listing of the folder right away, unless the user asked for fresh information */
+      if (!reload_info && g_hash_table_size (folder->files_map) == 0)
+        folder->listing_cached = thunar_folder_listing_restore (folder);
+
+      if (folder->listing_cached)
+        {
+          /* check whether the listing is still up to date, see thunar_folder_validated() */
+          folder->validate_cancellable = g_cancellable_new ();
+          g_file_query_info_async (thunar_file_get_file (folder->corresponding_file),
+                                   THUNAR_FOLDER_VALIDATOR_ATTRIBUTES,
+                                   G_FILE_QUERY_INFO_NONE, G_PRIORITY_DEFAULT,
+                                   folder->validate_cancellable,
+                                   thunar_folder_validated, folder);
+        }
+      else
+        {
+          /* nothing to revalidate, the job determines the etag/mtime itself */
+          thunar_folder_start_job (folder);
+        }
+    }
+  else
+    {
+      /* start a new job */
+      thunar_folder_start_job (folder);
+    }
+
+  /* reset the monitoring */
+  thunar_folder_reset_monitor (folder);
+}
+
+
+
+static void
+thunar_folder_start_job (ThunarFolder *folder)
+{
+  folder->job_failed = FALSE;
   folder->job = thunar_io_jobs_list_directory (thunar_file_get_file (folder->corresponding_file));
   g_signal_connect (folder->job, "error", G_CALLBACK (thunar_folder_error), folder);
   g_signal_connect (folder->job, "finished", G_CALLBACK (thunar_folder_finished), folder);
   g_signal_connect (folder->job, "files-ready", G_CALLBACK (thunar_folder_files_ready), folder);
   thunar_job_launch (THUNAR_JOB (folder->job));
-
-  /* reset the monitoring */
-  thunar_folder_reset_monitor (folder);
 }
 
 
@@ -48,6 +48,9 @@ gboolean
 thunar_folder_get_loading (const ThunarFolder *folder);
 gboolean
 thunar_folder_has_folder_monitor (const ThunarFolder *folder);
+void
+thunar_folder_set_displayed (ThunarFolder *folder,
+                             gboolean      displayed);
 
 void
 thunar_folder_reload (ThunarFolder *folder,
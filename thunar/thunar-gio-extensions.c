@@ -1455,6 +1455,111 @@ thunar_g_file_is_descendant (GFile *descendant,
 
 
 
+typedef struct
+{
+  gchar *uri;
+  GList *link;
+  guint  index;
+} ThunarDescendantEntry;
+
+
+
+/* orders URIs like strcmp(), but with '/' in front of every other character,
+ * so each folder is directly followed by all of its descendants */
+static gint
+thunar_g_file_list_compare_entries (gconstpointer a,
+                                    gconstpointer b)
+{
+  const ThunarDescendantEntry *entry_a = a;
+  const ThunarDescendantEntry *entry_b = b;
+  const guchar                *s = (const guchar *) entry_a->uri;
+  const guchar                *t = (const guchar *) entry_b->uri;
+
+  for (; *s != '\0' && *s == *t; ++s, ++t)
+    ;
+
+  if (*s != *t)
+    {
+      if (*s == '/' && *t != '\0')
+        return -1;
+      if (*t == '/' && *s != '\0')
+        return 1;
+      return (gint) *s - (gint) *t;
+    }
+
+  /* keep the first of several equal files */
+  return (gint) entry_a->index - (gint) entry_b->index;
+}
+
+
+
+/**
+ * thunar_g_file_list_drop_descendants:
+ * @file_list : a list of #GFile<!---->s.
+ *
+ * Deletes all #GFile<!---->s from @file_list which are located in a folder that is also
+ * in @file_list, as well as all but the first of several equal #GFile<!---->s, and
+ * releases them. The order of the remaining files is preserved.
+ *
+ * Other than comparing all pairs with thunar_g_file_is_descendant(), this
+ * sorts the URIs of the files once, which takes O(n log n).
+ *
+ * Return value: the (possibly changed) start of @file_list.
+ **/
+GList *
+thunar_g_file_list_drop_descendants (GList *file_list)
+{
+  ThunarDescendantEntry *entries;
+  ThunarDescendantEntry *ancestor = NULL;
+  gsize                  ancestor_len = 0;
+  guint                  n_entries;
+  guint                  n;
+  GList                 *lp;
+
+  n_entries = g_list_length (file_list);
+  if (n_entries < 2)
+    return file_list;
+
+  entries = g_new (ThunarDescendantEntry, n_entries);
+  for (lp = file_list, n = 0; lp != NULL; lp = lp->next, ++n)
+    {
+      entries[n].uri = g_file_get_uri (lp->data);
+      entries[n].link = lp;
+      entries[n].index = n;
+    }
+
+  qsort (entries, n_entries, sizeof (*entries), thunar_g_file_list_compare_entries);
+
+  for (n = 0; n < n_entries; ++n)
+    {
+      /* descendants of the last kept file follow it directly */
+      if (ancestor != NULL
+          && strncmp (entries[n].uri, ancestor->uri, ancestor_len) == 0
+          && (entries[n].uri[ancestor_len] == '\0'
+              || entries[n].uri[ancestor_len] == '/'
+              || ancestor->uri[ancestor_len - 1] == '/'))
+        {
+          g_info ("The file '%s' was dropped from the file operation, because it is located in the directory '%s', which is already part of the operation.",
+                  entries[n].uri, ancestor->uri);
+
+          g_object_unref (entries[n].link->data);
+          file_list = g_list_delete_link (file_list, entries[n].link);
+          continue;
+        }
+
+      ancestor = &entries[n];
+      ancestor_len = strlen (ancestor->uri);
+    }
+
+  for (n = 0; n < n_entries; ++n)
+    g_free (entries[n].uri);
+  g_free (entries);
+
+  return file_list;
+}
+
+
+
 gboolean
 thunar_g_app_info_launch (GAppInfo          *info,
                           GFile             *working_directory,
@@ -166,6 +166,8 @@ thunar_g_file_list_get_parents (GList *list);
 gboolean
 thunar_g_file_is_descendant (GFile *descendant,
                              GFile *ancestor);
+GList *
+thunar_g_file_list_drop_descendants (GList *file_list);
 
 
 /* deep copy jobs for GLists */
@@ -0,0 +1,4972 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar Development Team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* ThunarGridView is the item grid behind the icon and the compact view.
+ *
+ * The items are arranged in lines, the rows of the icon view or the columns of the
+ * compact view, which are stacked in scroll direction. All items have the same
+ * breadth across the lines, while every line is as long as the largest item in it,
+ * so a long name only widens its own column. Only items which get scrolled into view
+ * are ever measured, lines without a measured item get the average size of the
+ * measured ones. The layout never has to walk the model: it only looks at the lines
+ * with measured items. When a line changes its size, the first visible item keeps its
+ * place on the screen. The per-item state (just the selection and the measured size)
+ * is kept in a GSequence parallel to the toplevel rows of the model. */
+
+#include "thunar/thunar-grid-view.h"
+#include "thunar/thunar-private.h"
+
+#include <gdk/gdkkeysyms.h>
+#include <gtk/gtk-a11y.h>
+#include <libxfce4util/libxfce4util.h>
+
+
+
+/* the item flags are stored directly in the data pointer of the GSequence */
+#define THUNAR_GRID_VIEW_ITEM_SELECTED    (1u << 0)
+#define THUNAR_GRID_VIEW_ITEM_PREVIOUS    (1u << 1) /* selection state when the rubberband started */
+#define THUNAR_GRID_VIEW_ITEM_STALE       (1u << 2) /* the row changed since the item was measured */
+#define THUNAR_GRID_VIEW_ITEM_STATE_MASK  (THUNAR_GRID_VIEW_ITEM_SELECTED | THUNAR_GRID_VIEW_ITEM_PREVIOUS)
+#define THUNAR_GRID_VIEW_ITEM_SIZE_SHIFT  (3) /* size in scroll direction, 0 if not measured */
+
+/* interval of the rubberband auto-scrolling */
+#define THUNAR_GRID_VIEW_SCROLL_INTERVAL (30)
+
+/* the search popup is hidden after this amount of ms without input */
+#define THUNAR_GRID_VIEW_SEARCH_DIALOG_TIMEOUT (5000)
+
+
+
+/* Property identifiers */
+enum
+{
+  PROP_0,
+  PROP_MODEL,
+  PROP_SINGLE_CLICK,
+  PROP_SINGLE_CLICK_TIMEOUT,
+  PROP_HADJUSTMENT,
+  PROP_VADJUSTMENT,
+  PROP_HSCROLL_POLICY,
+  PROP_VSCROLL_POLICY,
+};
+
+/* Signal identifiers */
+enum
+{
+  ITEM_ACTIVATED,
+  SELECTION_CHANGED,
+  LAST_SIGNAL,
+};
+
+
+
+typedef struct _ThunarGridViewCell                 ThunarGridViewCell;
+typedef struct _ThunarGridViewLine                 ThunarGridViewLine;
+typedef struct _ThunarGridViewAccessibleClass      ThunarGridViewAccessibleClass;
+typedef struct _ThunarGridViewAccessible           ThunarGridViewAccessible;
+typedef struct _ThunarGridViewItemAccessibleClass  ThunarGridViewItemAccessibleClass;
+typedef struct _ThunarGridViewItemAccessible       ThunarGridViewItemAccessible;
+
+#define THUNAR_TYPE_GRID_VIEW_ACCESSIBLE (thunar_grid_view_accessible_get_type ())
+#define THUNAR_GRID_VIEW_ACCESSIBLE(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), THUNAR_TYPE_GRID_VIEW_ACCESSIBLE, ThunarGridViewAccessible))
+#define THUNAR_TYPE_GRID_VIEW_ITEM_ACCESSIBLE (thunar_grid_view_item_accessible_get_type ())
+#define THUNAR_GRID_VIEW_ITEM_ACCESSIBLE(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), THUNAR_TYPE_GRID_VIEW_ITEM_ACCESSIBLE, ThunarGridViewItemAccessible))
+
+GType
+thunar_grid_view_accessible_get_type (void);
+GType
+thunar_grid_view_item_accessible_get_type (void);
+
+
+
+static void
+thunar_grid_view_cell_layout_init (GtkCellLayoutIface *iface);
+static void
+thunar_grid_view_dispose (GObject *object);
+static void
+thunar_grid_view_finalize (GObject *object);
+static void
+thunar_grid_view_get_property (GObject    *object,
+                               guint       prop_id,
+                               GValue     *value,
+                               GParamSpec *pspec);
+static void
+thunar_grid_view_set_property (GObject      *object,
+                               guint         prop_id,
+                               const GValue *value,
+                               GParamSpec   *pspec);
+static void
+thunar_grid_view_realize (GtkWidget *widget);
+static void
+thunar_grid_view_get_preferred_width (GtkWidget *widget,
+                                      gint      *minimum,
+                                      gint      *natural);
+static void
+thunar_grid_view_get_preferred_height (GtkWidget *widget,
+                                       gint      *minimum,
+                                       gint      *natural);
+static void
+thunar_grid_view_size_allocate (GtkWidget     *widget,
+                                GtkAllocation *allocation);
+static gboolean
+thunar_grid_view_draw (GtkWidget *widget,
+                       cairo_t   *cr);
+static gboolean
+thunar_grid_view_button_press_event (GtkWidget      *widget,
+                                     GdkEventButton *event);
+static gboolean
+thunar_grid_view_button_release_event (GtkWidget      *widget,
+                                       GdkEventButton *event);
+static gboolean
+thunar_grid_view_motion_notify_event (GtkWidget      *widget,
+                                      GdkEventMotion *event);
+static gboolean
+thunar_grid_view_leave_notify_event (GtkWidget        *widget,
+                                     GdkEventCrossing *event);
+static gboolean
+thunar_grid_view_key_press_event (GtkWidget   *widget,
+                                  GdkEventKey *event);
+static gboolean
+thunar_grid_view_focus_in_event (GtkWidget     *widget,
+                                 GdkEventFocus *event);
+static gboolean
+thunar_grid_view_focus_out_event (GtkWidget     *widget,
+                                  GdkEventFocus *event);
+static void
+thunar_grid_view_style_updated (GtkWidget *widget);
+static void
+thunar_grid_view_direction_changed (GtkWidget       *widget,
+                                    GtkTextDirection previous_direction);
+static void
+thunar_grid_view_drag_begin (GtkWidget      *widget,
+                             GdkDragContext *context);
+static void
+thunar_grid_view_cell_layout_pack_start (GtkCellLayout   *layout,
+                                         GtkCellRenderer *renderer,
+                                         gboolean         expand);
+static void
+thunar_grid_view_cell_layout_clear (GtkCellLayout *layout);
+static void
+thunar_grid_view_cell_layout_add_attribute (GtkCellLayout   *layout,
+                                            GtkCellRenderer *renderer,
+                                            const gchar     *attribute,
+                                            gint             column);
+static void
+thunar_grid_view_cell_layout_set_cell_data_func (GtkCellLayout        *layout,
+                                                 GtkCellRenderer      *renderer,
+                                                 GtkCellLayoutDataFunc func,
+                                                 gpointer              func_data,
+                                                 GDestroyNotify        destroy);
+static void
+thunar_grid_view_cell_layout_clear_attributes (GtkCellLayout   *layout,
+                                               GtkCellRenderer *renderer);
+static void
+thunar_grid_view_cell_layout_reorder (GtkCellLayout   *layout,
+                                      GtkCellRenderer *renderer,
+                                      gint             position);
+static GList *
+thunar_grid_view_cell_layout_get_cells (GtkCellLayout *layout);
+static void
+thunar_grid_view_set_adjustment (ThunarGridView *grid_view,
+                                 GtkOrientation  orientation,
+                                 GtkAdjustment  *adjustment);
+static void
+thunar_grid_view_adjustment_value_changed (GtkAdjustment  *adjustment,
+                                           ThunarGridView *grid_view);
+static void
+thunar_grid_view_row_changed (GtkTreeModel   *model,
+                              GtkTreePath    *path,
+                              GtkTreeIter    *iter,
+                              ThunarGridView *grid_view);
+static void
+thunar_grid_view_row_inserted (GtkTreeModel   *model,
+                               GtkTreePath    *path,
+                               GtkTreeIter    *iter,
+                               ThunarGridView *grid_view);
+static void
+thunar_grid_view_row_deleted (GtkTreeModel   *model,
+                              GtkTreePath    *path,
+                              ThunarGridView *grid_view);
+static void
+thunar_grid_view_rows_reordered (GtkTreeModel   *model,
+                                 GtkTreePath    *path,
+                                 GtkTreeIter    *iter,
+                                 gint           *new_order,
+                                 ThunarGridView *grid_view);
+static void
+thunar_grid_view_queue_layout (ThunarGridView *grid_view);
+static void
+thunar_grid_view_invalidate_sizes (ThunarGridView *grid_view);
+static void
+thunar_grid_view_update_rubberband (ThunarGridView *grid_view);
+static void
+thunar_grid_view_stop_rubberband (ThunarGridView *grid_view);
+static void
+thunar_grid_view_scroll_to_index (ThunarGridView *grid_view,
+                                  gint            index,
+                                  gboolean        use_align,
+                                  gfloat          row_align,
+                                  gfloat          col_align);
+static void
+thunar_grid_view_search_changed (GtkEntry       *entry,
+                                 ThunarGridView *grid_view);
+static void
+thunar_grid_view_search_hide (ThunarGridView *grid_view);
+static void
+thunar_grid_view_accessible_selection_init (AtkSelectionIface *iface);
+static void
+thunar_grid_view_accessible_component_init (AtkComponentIface *iface);
+static void
+thunar_grid_view_accessible_finalize (GObject *object);
+static void
+thunar_grid_view_accessible_initialize (AtkObject *object,
+                                        gpointer   data);
+static gint
+thunar_grid_view_accessible_get_n_children (AtkObject *object);
+static AtkObject *
+thunar_grid_view_accessible_ref_child (AtkObject *object,
+                                       gint       index);
+static void
+thunar_grid_view_accessible_widget_unset (GtkAccessible *accessible);
+static void
+thunar_grid_view_accessible_rows_changed (ThunarGridView *grid_view,
+                                          gint            index,
+                                          gint            delta);
+static void
+thunar_grid_view_accessible_rows_reordered (ThunarGridView *grid_view,
+                                            const gint     *inverse);
+static void
+thunar_grid_view_accessible_model_changed (ThunarGridView *grid_view);
+static void
+thunar_grid_view_accessible_selection_changed (ThunarGridView *grid_view);
+static void
+thunar_grid_view_accessible_cursor_changed (ThunarGridView *grid_view);
+static void
+thunar_grid_view_item_accessible_component_init (AtkComponentIface *iface);
+static void
+thunar_grid_view_item_accessible_action_init (AtkActionIface *iface);
+static void
+thunar_grid_view_item_accessible_finalize (GObject *object);
+static const gchar *
+thunar_grid_view_item_accessible_get_name (AtkObject *object);
+static gint
+thunar_grid_view_item_accessible_get_index_in_parent (AtkObject *object);
+static AtkStateSet *
+thunar_grid_view_item_accessible_ref_state_set (AtkObject *object);
+
+
+
+struct _ThunarGridViewCell
+{
+  GtkCellRenderer      *cell;
+  GSList               *attributes; /* (name, column) pairs */
+  GtkCellLayoutDataFunc func;
+  gpointer              func_data;
+  GDestroyNotify        destroy;
+
+  /* largest natural size of this cell among the measured items */
+  gint max_width;
+  gint max_height;
+};
+
+/* a line with measured items */
+struct _ThunarGridViewLine
+{
+  gint line;
+  gint size;
+
+  /* sum of the differences to the estimated size of the measured lines before */
+  gint offset;
+};
+
+struct _ThunarGridViewAccessibleClass
+{
+  GtkWidgetAccessibleClass __parent__;
+};
+
+struct _ThunarGridViewAccessible
+{
+  GtkWidgetAccessible __parent__;
+
+  /* ThunarGridViewItemAccessible's handed out so far, by item index */
+  GHashTable *items;
+
+  /* the item last reported as the active descendant, -1 if none */
+  gint focus_index;
+};
+
+struct _ThunarGridViewItemAccessibleClass
+{
+  AtkObjectClass __parent__;
+};
+
+struct _ThunarGridViewItemAccessible
+{
+  AtkObject __parent__;
+
+  /* the item index, -1 once the item was removed */
+  gint index;
+
+  /* states last reported to the assistive technologies */
+  gboolean selected;
+  gboolean focused;
+
+  /* storage for the name returned by get_name() */
+  gchar *name;
+};
+
+struct _ThunarGridViewClass
+{
+  GtkWidgetClass __parent__;
+
+  /* signals */
+  void (*item_activated) (ThunarGridView *grid_view,
+                          GtkTreePath    *path);
+  void (*selection_changed) (ThunarGridView *grid_view);
+};
+
+struct _ThunarGridView
+{
+  GtkWidget __parent__;
+
+  GtkTreeModel *model;
+
+  /* flags of the toplevel rows, in model order */
+  GSequence *items;
+  gint       n_items;
+  gint       n_selected;
+
+  /* indices of the items (un)selected since "selection-changed" was emitted
+   * last, see thunar_grid_view_get_selection_delta() */
+  GArray  *selection_delta;
+  gboolean selection_delta_lost;
+
+  /* ThunarGridViewCell's in packing order */
+  GList *cells;
+
+  GtkAdjustment *hadjustment;
+  GtkAdjustment *vadjustment;
+  guint          hscroll_policy : 1;
+  guint          vscroll_policy : 1;
+
+  /* layout parameters */
+  GtkOrientation           orientation;
+  ThunarGridViewLayoutMode layout_mode;
+  gint                     item_width;
+  gint                     margin;
+  gint                     row_spacing;
+  gint                     column_spacing;
+
+  /* current layout, in content coordinates */
+  gint     item_breadth;
+  gint     line_estimate;
+  gint     n_columns;
+  gint     n_rows;
+  gint     content_width;
+  gint     content_height;
+  gboolean in_layout;
+  gboolean layout_pending;
+  gboolean layout_valid;
+
+  /* ThunarGridViewLine's of the lines with measured items, in line order,
+   * rebuilt from the measured items if they were regrouped */
+  GArray  *lines;
+  gint     lines_length;
+  gboolean lines_valid;
+
+  /* the GSequenceIter's of the measured items, and their largest breadth */
+  GHashTable *measured;
+  gint        measured_breadth;
+
+  /* item indices, -1 if unset */
+  gint cursor;
+  gint anchor;
+  gint prelit;
+  gint pressed;
+  gint drag_dest;
+
+  /* the pressed item was already selected, so the selection is only collapsed on release */
+  gboolean press_deferred;
+
+  /* rubberband selection, the corners are in content coordinates */
+  gboolean rubberbanding;
+  gboolean rubberband_modify;
+  gboolean rubberband_previous;
+  gint     rubberband_x1;
+  gint     rubberband_y1;
+  gint     rubberband_x2;
+  gint     rubberband_y2;
+  gint     pointer_x;
+  gint     pointer_y;
+  guint    rubberband_scroll_id;
+
+  /* single click mode */
+  gboolean single_click;
+  guint    single_click_timeout;
+  guint    single_click_timeout_id;
+
+  /* interactive search, the popup is created on demand */
+  gint       search_column;
+  GtkWidget *search_window;
+  GtkWidget *search_entry;
+  guint      search_timeout_id;
+
+  /* scroll_to_path() request, applied after the next allocation */
+  GtkTreeRowReference *scroll_to_path;
+  gboolean             scroll_to_use_align;
+  gfloat               scroll_to_row_align;
+  gfloat               scroll_to_col_align;
+
+  /* the ThunarGridViewAccessible, once it was requested */
+  AtkObject *accessible;
+};
+
+
+
+static guint grid_view_signals[LAST_SIGNAL];
+
+
+
+G_DEFINE_TYPE_WITH_CODE (ThunarGridView, thunar_grid_view, GTK_TYPE_WIDGET,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_CELL_LAYOUT, thunar_grid_view_cell_layout_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_SCROLLABLE, NULL))
+
+G_DEFINE_TYPE_WITH_CODE (ThunarGridViewAccessible, thunar_grid_view_accessible, GTK_TYPE_WIDGET_ACCESSIBLE,
+                         G_IMPLEMENT_INTERFACE (ATK_TYPE_SELECTION, thunar_grid_view_accessible_selection_init)
+                         G_IMPLEMENT_INTERFACE (ATK_TYPE_COMPONENT, thunar_grid_view_accessible_component_init))
+
+G_DEFINE_TYPE_WITH_CODE (ThunarGridViewItemAccessible, thunar_grid_view_item_accessible, ATK_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (ATK_TYPE_COMPONENT, thunar_grid_view_item_accessible_component_init)
+                         G_IMPLEMENT_INTERFACE (ATK_TYPE_ACTION, thunar_grid_view_item_accessible_action_init))
+
+
+
+static void
+thunar_grid_view_class_init (ThunarGridViewClass *klass)
+{
+  GtkWidgetClass *gtkwidget_class;
+  GObjectClass   *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->dispose = thunar_grid_view_dispose;
+  gobject_class->finalize = thunar_grid_view_finalize;
+  gobject_class->get_property = thunar_grid_view_get_property;
+  gobject_class->set_property = thunar_grid_view_set_property;
+
+  gtkwidget_class = GTK_WIDGET_CLASS (klass);
+  gtkwidget_class->realize = thunar_grid_view_realize;
+  gtkwidget_class->get_preferred_width = thunar_grid_view_get_preferred_width;
+  gtkwidget_class->get_preferred_height = thunar_grid_view_get_preferred_height;
+  gtkwidget_class->size_allocate = thunar_grid_view_size_allocate;
+  gtkwidget_class->draw = thunar_grid_view_draw;
+  gtkwidget_class->button_press_event = thunar_grid_view_button_press_event;
+  gtkwidget_class->button_release_event = thunar_grid_view_button_release_event;
+  gtkwidget_class->motion_notify_event = thunar_grid_view_motion_notify_event;
+  gtkwidget_class->leave_notify_event = thunar_grid_view_leave_notify_event;
+  gtkwidget_class->key_press_event = thunar_grid_view_key_press_event;
+  gtkwidget_class->focus_in_event = thunar_grid_view_focus_in_event;
+  gtkwidget_class->focus_out_event = thunar_grid_view_focus_out_event;
+  gtkwidget_class->style_updated = thunar_grid_view_style_updated;
+  gtkwidget_class->direction_changed = thunar_grid_view_direction_changed;
+  gtkwidget_class->drag_begin = thunar_grid_view_drag_begin;
+
+  /* same node name as GtkIconView, so themes style us like an icon view */
+  gtk_widget_class_set_css_name (gtkwidget_class, "iconview");
+  gtk_widget_class_set_accessible_type (gtkwidget_class, THUNAR_TYPE_GRID_VIEW_ACCESSIBLE);
+
+  /**
+   * ThunarGridView:model:
+   *
+   * The #GtkTreeModel whose toplevel rows are displayed.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_MODEL,
+                                   g_param_spec_object ("model",
+                                                        "model",
+                                                        "model",
+                                                        GTK_TYPE_TREE_MODEL,
+                                                        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * ThunarGridView:single-click:
+   *
+   * %TRUE to activate items on a single click instead of a double click.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_SINGLE_CLICK,
+                                   g_param_spec_boolean ("single-click",
+                                                         "single-click",
+                                                         "single-click",
+                                                         FALSE,
+                                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * ThunarGridView:single-click-timeout:
+   *
+   * The amount of milliseconds after which the item below the pointer
+   * is selected in single click mode. A value of 0 disables this.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_SINGLE_CLICK_TIMEOUT,
+                                   g_param_spec_uint ("single-click-timeout",
+                                                      "single-click-timeout",
+                                                      "single-click-timeout",
+                                                      0, G_MAXUINT, 0,
+                                                      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /* GtkScrollable properties */
+  g_object_class_override_property (gobject_class, PROP_HADJUSTMENT, "hadjustment");
+  g_object_class_override_property (gobject_class, PROP_VADJUSTMENT, "vadjustment");
+  g_object_class_override_property (gobject_class, PROP_HSCROLL_POLICY, "hscroll-policy");
+  g_object_class_override_property (gobject_class, PROP_VSCROLL_POLICY, "vscroll-policy");
+
+  /**
+   * ThunarGridView::item-activated:
+   * @grid_view : a #ThunarGridView.
+   * @path      : the #GtkTreePath of the activated item.
+   *
+   * Emitted when an item is double clicked (or single clicked in
+   * single click mode), or when Return is pressed on the cursor item.
+   **/
+  grid_view_signals[ITEM_ACTIVATED] =
+  g_signal_new (I_ ("item-activated"),
+                G_TYPE_FROM_CLASS (klass),
+                G_SIGNAL_RUN_LAST,
+                G_STRUCT_OFFSET (ThunarGridViewClass, item_activated),
+                NULL, NULL,
+                g_cclosure_marshal_VOID__BOXED,
+                G_TYPE_NONE, 1, GTK_TYPE_TREE_PATH);
+
+  /**
+   * ThunarGridView::selection-changed:
+   * @grid_view : a #ThunarGridView.
+   *
+   * Emitted whenever the set of selected items changes.
+   **/
+  grid_view_signals[SELECTION_CHANGED] =
+  g_signal_new (I_ ("selection-changed"),
+                G_TYPE_FROM_CLASS (klass),
+                G_SIGNAL_RUN_FIRST,
+                G_STRUCT_OFFSET (ThunarGridViewClass, selection_changed),
+                NULL, NULL,
+                g_cclosure_marshal_VOID__VOID,
+                G_TYPE_NONE, 0);
+}
+
+
+
+static void
+thunar_grid_view_cell_layout_init (GtkCellLayoutIface *iface)
+{
+  iface->pack_start = thunar_grid_view_cell_layout_pack_start;
+  iface->pack_end = thunar_grid_view_cell_layout_pack_start;
+  iface->clear = thunar_grid_view_cell_layout_clear;
+  iface->add_attribute = thunar_grid_view_cell_layout_add_attribute;
+  iface->set_cell_data_func = thunar_grid_view_cell_layout_set_cell_data_func;
+  iface->clear_attributes = thunar_grid_view_cell_layout_clear_attributes;
+  iface->reorder = thunar_grid_view_cell_layout_reorder;
+  iface->get_cells = thunar_grid_view_cell_layout_get_cells;
+}
+
+
+
+static void
+thunar_grid_view_init (ThunarGridView *grid_view)
+{
+  grid_view->items = g_sequence_new (NULL);
+  grid_view->selection_delta = g_array_new (FALSE, FALSE, sizeof (gint));
+  grid_view->orientation = GTK_ORIENTATION_VERTICAL;
+  grid_view->layout_mode = THUNAR_GRID_VIEW_LAYOUT_ROWS;
+  grid_view->item_width = -1;
+  grid_view->margin = 6;
+  grid_view->row_spacing = 6;
+  grid_view->column_spacing = 6;
+  grid_view->n_columns = 1;
+  grid_view->n_rows = 1;
+  grid_view->item_breadth = 1;
+  grid_view->line_estimate = 1;
+  grid_view->lines = g_array_new (FALSE, FALSE, sizeof (ThunarGridViewLine));
+  grid_view->measured = g_hash_table_new (g_direct_hash, g_direct_equal);
+  grid_view->cursor = -1;
+  grid_view->anchor = -1;
+  grid_view->prelit = -1;
+  grid_view->pressed = -1;
+  grid_view->drag_dest = -1;
+  grid_view->search_column = -1;
+
+  gtk_widget_set_has_window (GTK_WIDGET (grid_view), TRUE);
+  gtk_widget_set_can_focus (GTK_WIDGET (grid_view), TRUE);
+  gtk_style_context_add_class (gtk_widget_get_style_context (GTK_WIDGET (grid_view)), GTK_STYLE_CLASS_VIEW);
+}
+
+
+
+static void
+thunar_grid_view_dispose (GObject *object)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (object);
+
+  thunar_grid_view_set_model (grid_view, NULL);
+  thunar_grid_view_cell_layout_clear (GTK_CELL_LAYOUT (grid_view));
+
+  if (grid_view->rubberband_scroll_id != 0)
+    {
+      g_source_remove (grid_view->rubberband_scroll_id);
+      grid_view->rubberband_scroll_id = 0;
+    }
+
+  if (grid_view->single_click_timeout_id != 0)
+    {
+      g_source_remove (grid_view->single_click_timeout_id);
+      grid_view->single_click_timeout_id = 0;
+    }
+
+  if (grid_view->search_timeout_id != 0)
+    {
+      g_source_remove (grid_view->search_timeout_id);
+      grid_view->search_timeout_id = 0;
+    }
+
+  if (grid_view->search_window != NULL)
+    {
+      gtk_widget_destroy (grid_view->search_window);
+      grid_view->search_window = NULL;
+      grid_view->search_entry = NULL;
+    }
+
+  if (grid_view->hadjustment != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (grid_view->hadjustment, thunar_grid_view_adjustment_value_changed, grid_view);
+      g_clear_object (&grid_view->hadjustment);
+    }
+
+  if (grid_view->vadjustment != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (grid_view->vadjustment, thunar_grid_view_adjustment_value_changed, grid_view);
+      g_clear_object (&grid_view->vadjustment);
+    }
+
+  (*G_OBJECT_CLASS (thunar_grid_view_parent_class)->dispose) (object);
+}
+
+
+
+static void
+thunar_grid_view_finalize (GObject *object)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (object);
+
+  g_sequence_free (grid_view->items);
+  g_array_free (grid_view->selection_delta, TRUE);
+  g_array_free (grid_view->lines, TRUE);
+  g_hash_table_destroy (grid_view->measured);
+
+  (*G_OBJECT_CLASS (thunar_grid_view_parent_class)->finalize) (object);
+}
+
+
+
+static void
+thunar_grid_view_get_property (GObject    *object,
+                               guint       prop_id,
+                               GValue     *value,
+                               GParamSpec *pspec)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (object);
+
+  switch (prop_id)
+    {
+    case PROP_MODEL:
+      g_value_set_object (value, grid_view->model);
+      break;
+
+    case PROP_SINGLE_CLICK:
+      g_value_set_boolean (value, grid_view->single_click);
+      break;
+
+    case PROP_SINGLE_CLICK_TIMEOUT:
+      g_value_set_uint (value, grid_view->single_click_timeout);
+      break;
+
+    case PROP_HADJUSTMENT:
+      g_value_set_object (value, grid_view->hadjustment);
+      break;
+
+    case PROP_VADJUSTMENT:
+      g_value_set_object (value, grid_view->vadjustment);
+      break;
+
+    case PROP_HSCROLL_POLICY:
+      g_value_set_enum (value, grid_view->hscroll_policy);
+      break;
+
+    case PROP_VSCROLL_POLICY:
+      g_value_set_enum (value, grid_view->vscroll_policy);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+
+
+static void
+thunar_grid_view_set_property (GObject      *object,
+                               guint         prop_id,
+                               const GValue *value,
+                               GParamSpec   *pspec)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (object);
+
+  switch (prop_id)
+    {
+    case PROP_MODEL:
+      thunar_grid_view_set_model (grid_view, g_value_get_object (value));
+      break;
+
+    case PROP_SINGLE_CLICK:
+      grid_view->single_click = g_value_get_boolean (value);
+      break;
+
+    case PROP_SINGLE_CLICK_TIMEOUT:
+      grid_view->single_click_timeout = g_value_get_uint (value);
+      break;
+
+    case PROP_HADJUSTMENT:
+      thunar_grid_view_set_adjustment (grid_view, GTK_ORIENTATION_HORIZONTAL, g_value_get_object (value));
+      break;
+
+    case PROP_VADJUSTMENT:
+      thunar_grid_view_set_adjustment (grid_view, GTK_ORIENTATION_VERTICAL, g_value_get_object (value));
+      break;
+
+    case PROP_HSCROLL_POLICY:
+      grid_view->hscroll_policy = g_value_get_enum (value);
+      gtk_widget_queue_resize (GTK_WIDGET (grid_view));
+      break;
+
+    case PROP_VSCROLL_POLICY:
+      grid_view->vscroll_policy = g_value_get_enum (value);
+      gtk_widget_queue_resize (GTK_WIDGET (grid_view));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+
+
+static inline guint
+thunar_grid_view_item_get_flags (GSequenceIter *item)
+{
+  return GPOINTER_TO_UINT (g_sequence_get (item));
+}
+
+
+
+static inline void
+thunar_grid_view_item_set_flags (GSequenceIter *item,
+                                 guint          flags)
+{
+  g_sequence_set (item, GUINT_TO_POINTER (flags));
+}
+
+
+
+static inline gint
+thunar_grid_view_item_get_size (GSequenceIter *item)
+{
+  return thunar_grid_view_item_get_flags (item) >> THUNAR_GRID_VIEW_ITEM_SIZE_SHIFT;
+}
+
+
+
+static inline void
+thunar_grid_view_item_set_size (GSequenceIter *item,
+                                gint           size)
+{
+  thunar_grid_view_item_set_flags (item, (thunar_grid_view_item_get_flags (item) & THUNAR_GRID_VIEW_ITEM_STATE_MASK)
+                                         | ((guint) size << THUNAR_GRID_VIEW_ITEM_SIZE_SHIFT));
+}
+
+
+
+static inline gboolean
+thunar_grid_view_item_needs_measure (GSequenceIter *item)
+{
+  guint flags = thunar_grid_view_item_get_flags (item);
+
+  return (flags >> THUNAR_GRID_VIEW_ITEM_SIZE_SHIFT) == 0 || (flags & THUNAR_GRID_VIEW_ITEM_STALE) != 0;
+}
+
+
+
+static gboolean
+thunar_grid_view_item_set_selected (ThunarGridView *grid_view,
+                                    GSequenceIter  *item,
+                                    gboolean        selected)
+{
+  guint flags = thunar_grid_view_item_get_flags (item);
+  gint  index;
+
+  if (((flags & THUNAR_GRID_VIEW_ITEM_SELECTED) != 0) == (selected != FALSE))
+    return FALSE;
+
+  index = g_sequence_iter_get_position (item);
+  g_array_append_val (grid_view->selection_delta, index);
+
+  if (selected)
+    {
+      flags |= THUNAR_GRID_VIEW_ITEM_SELECTED;
+      grid_view->n_selected += 1;
+    }
+  else
+    {
+      flags &= ~THUNAR_GRID_VIEW_ITEM_SELECTED;
+      grid_view->n_selected -= 1;
+    }
+
+  thunar_grid_view_item_set_flags (item, flags);
+
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_grid_view_select_range (ThunarGridView *grid_view,
+                               gint            first,
+                               gint            last)
+{
+  GSequenceIter *item;
+  gboolean       changed = FALSE;
+  gint           n;
+
+  item = g_sequence_get_iter_at_pos (grid_view->items, first);
+  for (n = first; n <= last && !g_sequence_iter_is_end (item); ++n, item = g_sequence_iter_next (item))
+    changed |= thunar_grid_view_item_set_selected (grid_view, item, TRUE);
+
+  return changed;
+}
+
+
+
+static gboolean
+thunar_grid_view_unselect_all_internal (ThunarGridView *grid_view)
+{
+  GSequenceIter *item;
+  gboolean       changed = FALSE;
+
+  /* stop as soon as the last selected item was found */
+  for (item = g_sequence_get_begin_iter (grid_view->items);
+       grid_view->n_selected > 0 && !g_sequence_iter_is_end (item);
+       item = g_sequence_iter_next (item))
+    {
+      changed |= thunar_grid_view_item_set_selected (grid_view, item, FALSE);
+    }
+
+  return changed;
+}
+
+
+
+static gboolean
+thunar_grid_view_index_is_selected (ThunarGridView *grid_view,
+                                    gint            index)
+{
+  if (index < 0 || index >= grid_view->n_items)
+    return FALSE;
+
+  return (thunar_grid_view_item_get_flags (g_sequence_get_iter_at_pos (grid_view->items, index)) & THUNAR_GRID_VIEW_ITEM_SELECTED) != 0;
+}
+
+
+
+static gint
+thunar_grid_view_compare_indices (gconstpointer a,
+                                  gconstpointer b)
+{
+  return *(const gint *) a - *(const gint *) b;
+}
+
+
+
+static void
+thunar_grid_view_selection_changed (ThunarGridView *grid_view)
+{
+  gtk_widget_queue_draw (GTK_WIDGET (grid_view));
+  g_signal_emit (G_OBJECT (grid_view), grid_view_signals[SELECTION_CHANGED], 0);
+  thunar_grid_view_accessible_selection_changed (grid_view);
+
+  /* the delta only describes a single emission */
+  g_array_set_size (grid_view->selection_delta, 0);
+  grid_view->selection_delta_lost = FALSE;
+}
+
+
+
+static void
+thunar_grid_view_item_activated (ThunarGridView *grid_view,
+                                 gint            index)
+{
+  GtkTreePath *path;
+
+  path = gtk_tree_path_new_from_indices (index, -1);
+  g_signal_emit (G_OBJECT (grid_view), grid_view_signals[ITEM_ACTIVATED], 0, path);
+  gtk_tree_path_free (path);
+}
+
+
+
+static gint
+thunar_grid_view_index_from_path (ThunarGridView *grid_view,
+                                  GtkTreePath    *path)
+{
+  gint index;
+
+  if (path == NULL || gtk_tree_path_get_depth (path) != 1)
+    return -1;
+
+  index = gtk_tree_path_get_indices (path)[0];
+  return (index >= 0 && index < grid_view->n_items) ? index : -1;
+}
+
+
+
+static inline gint
+thunar_grid_view_get_x_offset (ThunarGridView *grid_view)
+{
+  return (grid_view->hadjustment != NULL) ? (gint) gtk_adjustment_get_value (grid_view->hadjustment) : 0;
+}
+
+
+
+static inline gint
+thunar_grid_view_get_y_offset (ThunarGridView *grid_view)
+{
+  return (grid_view->vadjustment != NULL) ? (gint) gtk_adjustment_get_value (grid_view->vadjustment) : 0;
+}
+
+
+
+static gboolean
+thunar_grid_view_is_rtl (ThunarGridView *grid_view)
+{
+  return gtk_widget_get_direction (GTK_WIDGET (grid_view)) == GTK_TEXT_DIR_RTL;
+}
+
+
+
+/* number of items in a line */
+static inline gint
+thunar_grid_view_get_line_length (ThunarGridView *grid_view)
+{
+  return (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS) ? grid_view->n_columns : grid_view->n_rows;
+}
+
+
+
+static inline gint
+thunar_grid_view_get_n_lines (ThunarGridView *grid_view)
+{
+  return (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS) ? grid_view->n_rows : grid_view->n_columns;
+}
+
+
+
+/* space between the lines */
+static inline gint
+thunar_grid_view_get_line_spacing (ThunarGridView *grid_view)
+{
+  return (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS) ? grid_view->row_spacing : grid_view->column_spacing;
+}
+
+
+
+/* space between the items of a line */
+static inline gint
+thunar_grid_view_get_item_spacing (ThunarGridView *grid_view)
+{
+  return (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS) ? grid_view->column_spacing : grid_view->row_spacing;
+}
+
+
+
+/* position of @line in grid_view->lines, or of the first measured line after it */
+static guint
+thunar_grid_view_find_line (ThunarGridView *grid_view,
+                            gint            line)
+{
+  guint lower = 0;
+  guint upper = grid_view->lines->len;
+  guint middle;
+
+  while (lower < upper)
+    {
+      middle = (lower + upper) / 2;
+      if (g_array_index (grid_view->lines, ThunarGridViewLine, middle).line < line)
+        lower = middle + 1;
+      else
+        upper = middle;
+    }
+
+  return lower;
+}
+
+
+
+/* offset of @line in scroll direction, in content coordinates */
+static gint
+thunar_grid_view_get_line_offset (ThunarGridView *grid_view,
+                                  gint            line)
+{
+  ThunarGridViewLine *before;
+  guint               position;
+  gint                offset;
+
+  offset = grid_view->margin + line * (grid_view->line_estimate + thunar_grid_view_get_line_spacing (grid_view));
+
+  /* add up the differences of the measured lines before */
+  position = thunar_grid_view_find_line (grid_view, line);
+  if (position > 0)
+    {
+      before = &g_array_index (grid_view->lines, ThunarGridViewLine, position - 1);
+      offset += before->offset + before->size - grid_view->line_estimate;
+    }
+
+  return offset;
+}
+
+
+
+static gint
+thunar_grid_view_get_line_size (ThunarGridView *grid_view,
+                                gint            line)
+{
+  ThunarGridViewLine *info;
+  guint               position;
+
+  position = thunar_grid_view_find_line (grid_view, line);
+  if (position < grid_view->lines->len)
+    {
+      info = &g_array_index (grid_view->lines, ThunarGridViewLine, position);
+      if (info->line == line)
+        return info->size;
+    }
+
+  return grid_view->line_estimate;
+}
+
+
+
+/* last line starting at or before @offset in scroll direction */
+static gint
+thunar_grid_view_get_line_at_offset (ThunarGridView *grid_view,
+                                     gint            offset)
+{
+  gint lower = 0;
+  gint upper = thunar_grid_view_get_n_lines (grid_view) - 1;
+  gint middle;
+
+  while (lower < upper)
+    {
+      middle = (lower + upper + 1) / 2;
+      if (thunar_grid_view_get_line_offset (grid_view, middle) <= offset)
+        lower = middle;
+      else
+        upper = middle - 1;
+    }
+
+  return lower;
+}
+
+
+
+/* area of the item at @index, in content coordinates */
+static void
+thunar_grid_view_get_item_box (ThunarGridView *grid_view,
+                               gint            index,
+                               GdkRectangle   *box)
+{
+  gint length = thunar_grid_view_get_line_length (grid_view);
+  gint line = index / length;
+  gint across;
+
+  across = grid_view->margin + (index % length) * (grid_view->item_breadth + thunar_grid_view_get_item_spacing (grid_view));
+
+  if (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS)
+    {
+      box->x = across;
+      box->y = thunar_grid_view_get_line_offset (grid_view, line);
+      box->width = grid_view->item_breadth;
+      box->height = thunar_grid_view_get_line_size (grid_view, line);
+    }
+  else
+    {
+      box->x = thunar_grid_view_get_line_offset (grid_view, line);
+      box->y = across;
+      box->width = thunar_grid_view_get_line_size (grid_view, line);
+      box->height = grid_view->item_breadth;
+    }
+
+  if (thunar_grid_view_is_rtl (grid_view))
+    box->x = grid_view->content_width - box->x - box->width;
+}
+
+
+
+/* index of the item at (@x, @y) in content coordinates, or -1 */
+static gint
+thunar_grid_view_get_index_at_pos (ThunarGridView *grid_view,
+                                   gint            x,
+                                   gint            y)
+{
+  gint stride;
+  gint along;
+  gint across;
+  gint line;
+  gint offset;
+  gint position;
+  gint index;
+
+  if (grid_view->n_items == 0)
+    return -1;
+
+  if (thunar_grid_view_is_rtl (grid_view))
+    x = grid_view->content_width - 1 - x;
+
+  along = (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS) ? y : x;
+  across = ((grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS) ? x : y) - grid_view->margin;
+  if (along < grid_view->margin || across < 0)
+    return -1;
+
+  /* check that we are not in the spacing between items */
+  stride = grid_view->item_breadth + thunar_grid_view_get_item_spacing (grid_view);
+  position = across / stride;
+  if (across - position * stride >= grid_view->item_breadth || position >= thunar_grid_view_get_line_length (grid_view))
+    return -1;
+
+  line = thunar_grid_view_get_line_at_offset (grid_view, along);
+  offset = thunar_grid_view_get_line_offset (grid_view, line);
+  if (along >= offset + thunar_grid_view_get_line_size (grid_view, line))
+    return -1;
+
+  index = line * thunar_grid_view_get_line_length (grid_view) + position;
+  return (index < grid_view->n_items) ? index : -1;
+}
+
+
+
+/* range of item indices which may intersect @area (in content coordinates) */
+static gboolean
+thunar_grid_view_get_range_for_area (ThunarGridView     *grid_view,
+                                     const GdkRectangle *area,
+                                     gint               *first,
+                                     gint               *last)
+{
+  gint x1, x2;
+  gint y1, y2;
+  gint p1, p2;
+  gint l1, l2;
+  gint length;
+  gint stride;
+
+  if (grid_view->n_items == 0 || area->width <= 0 || area->height <= 0)
+    return FALSE;
+
+  x1 = area->x;
+  x2 = area->x + area->width - 1;
+  if (thunar_grid_view_is_rtl (grid_view))
+    {
+      x1 = grid_view->content_width - 1 - (area->x + area->width - 1);
+      x2 = grid_view->content_width - 1 - area->x;
+    }
+
+  y1 = area->y;
+  y2 = area->y + area->height - 1;
+
+  length = thunar_grid_view_get_line_length (grid_view);
+  stride = grid_view->item_breadth + thunar_grid_view_get_item_spacing (grid_view);
+
+  if (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS)
+    {
+      p1 = CLAMP ((x1 - grid_view->margin) / stride, 0, length - 1);
+      p2 = CLAMP ((x2 - grid_view->margin) / stride, 0, length - 1);
+      l1 = thunar_grid_view_get_line_at_offset (grid_view, y1);
+      l2 = thunar_grid_view_get_line_at_offset (grid_view, y2);
+    }
+  else
+    {
+      p1 = CLAMP ((y1 - grid_view->margin) / stride, 0, length - 1);
+      p2 = CLAMP ((y2 - grid_view->margin) / stride, 0, length - 1);
+      l1 = thunar_grid_view_get_line_at_offset (grid_view, x1);
+      l2 = thunar_grid_view_get_line_at_offset (grid_view, x2);
+    }
+
+  *first = l1 * length + p1;
+  *last = MIN (l2 * length + p2, grid_view->n_items - 1);
+
+  return *first <= *last;
+}
+
+
+
+static void
+thunar_grid_view_get_visible_area (ThunarGridView *grid_view,
+                                   GdkRectangle   *area)
+{
+  area->x = thunar_grid_view_get_x_offset (grid_view);
+  area->y = thunar_grid_view_get_y_offset (grid_view);
+  area->width = gtk_widget_get_allocated_width (GTK_WIDGET (grid_view));
+  area->height = gtk_widget_get_allocated_height (GTK_WIDGET (grid_view));
+}
+
+
+
+static void
+thunar_grid_view_queue_draw_item (ThunarGridView *grid_view,
+                                  gint            index)
+{
+  GdkRectangle box;
+
+  if (index < 0 || index >= grid_view->n_items)
+    return;
+
+  thunar_grid_view_get_item_box (grid_view, index, &box);
+  gtk_widget_queue_draw_area (GTK_WIDGET (grid_view),
+                              box.x - thunar_grid_view_get_x_offset (grid_view),
+                              box.y - thunar_grid_view_get_y_offset (grid_view),
+                              box.width, box.height);
+}
+
+
+
+static void
+thunar_grid_view_set_cell_data (ThunarGridView *grid_view,
+                                GtkTreeIter    *iter)
+{
+  ThunarGridViewCell *info;
+  GValue              value = G_VALUE_INIT;
+  GSList             *sp;
+  GList              *lp;
+
+  for (lp = grid_view->cells; lp != NULL; lp = lp->next)
+    {
+      info = lp->data;
+
+      g_object_freeze_notify (G_OBJECT (info->cell));
+
+      for (sp = info->attributes; sp != NULL && sp->next != NULL; sp = sp->next->next)
+        {
+          gtk_tree_model_get_value (grid_view->model, iter, GPOINTER_TO_INT (sp->next->data), &value);
+          g_object_set_property (G_OBJECT (info->cell), sp->data, &value);
+          g_value_unset (&value);
+        }
+
+      if (info->func != NULL)
+        (*info->func) (GTK_CELL_LAYOUT (grid_view), info->cell, grid_view->model, iter, info->func_data);
+
+      g_object_thaw_notify (G_OBJECT (info->cell));
+    }
+}
+
+
+
+/* natural size of @info for the current cell data */
+static void
+thunar_grid_view_get_cell_size (ThunarGridView     *grid_view,
+                                ThunarGridViewCell *info,
+                                gint               *width,
+                                gint               *height)
+{
+  gtk_cell_renderer_get_preferred_width (info->cell, GTK_WIDGET (grid_view), NULL, width);
+
+  /* a fixed item width limits the width of the cells stacked inside */
+  if (grid_view->orientation == GTK_ORIENTATION_VERTICAL && grid_view->item_width > 0)
+    *width = MIN (*width, grid_view->item_width);
+
+  gtk_cell_renderer_get_preferred_height_for_width (info->cell, GTK_WIDGET (grid_view), *width, NULL, height);
+}
+
+
+
+/* records that @line has an item of @size, returns %TRUE if the line grew */
+static gboolean
+thunar_grid_view_add_line (ThunarGridView *grid_view,
+                           gint            line,
+                           gint            size)
+{
+  ThunarGridViewLine *info;
+  ThunarGridViewLine  new_line = { line, size, 0 };
+  guint               position;
+
+  position = thunar_grid_view_find_line (grid_view, line);
+  if (position < grid_view->lines->len)
+    {
+      info = &g_array_index (grid_view->lines, ThunarGridViewLine, position);
+      if (info->line == line)
+        {
+          if (size <= info->size)
+            return FALSE;
+
+          info->size = size;
+          return TRUE;
+        }
+    }
+
+  g_array_insert_val (grid_view->lines, position, new_line);
+
+  return TRUE;
+}
+
+
+
+static gint
+thunar_grid_view_compare_lines (gconstpointer a,
+                                gconstpointer b)
+{
+  const ThunarGridViewLine *line_a = a;
+  const ThunarGridViewLine *line_b = b;
+
+  return line_a->line - line_b->line;
+}
+
+
+
+/* collects the lines from the measured items, after they were regrouped */
+static void
+thunar_grid_view_rebuild_lines (ThunarGridView *grid_view)
+{
+  ThunarGridViewLine *lines;
+  ThunarGridViewLine  line;
+  GHashTableIter      iter;
+  gpointer            item;
+  guint               n;
+  guint               m;
+
+  g_array_set_size (grid_view->lines, 0);
+
+  g_hash_table_iter_init (&iter, grid_view->measured);
+  while (g_hash_table_iter_next (&iter, &item, NULL))
+    {
+      line.line = g_sequence_iter_get_position (item) / grid_view->lines_length;
+      line.size = thunar_grid_view_item_get_size (item);
+      line.offset = 0;
+      g_array_append_val (grid_view->lines, line);
+    }
+
+  /* merge the items of the same line */
+  g_array_sort (grid_view->lines, thunar_grid_view_compare_lines);
+  lines = (ThunarGridViewLine *) grid_view->lines->data;
+  for (n = 0, m = 0; n < grid_view->lines->len; ++n)
+    {
+      if (m > 0 && lines[m - 1].line == lines[n].line)
+        lines[m - 1].size = MAX (lines[m - 1].size, lines[n].size);
+      else
+        lines[m++] = lines[n];
+    }
+  g_array_set_size (grid_view->lines, m);
+
+  grid_view->lines_valid = TRUE;
+}
+
+
+
+/* measures the item at @index, returns %TRUE if this changed the layout */
+static gboolean
+thunar_grid_view_measure_item (ThunarGridView *grid_view,
+                               GSequenceIter  *item,
+                               gint            index,
+                               GtkTreeIter    *iter)
+{
+  ThunarGridViewCell *info;
+  gboolean            changed = FALSE;
+  GList              *lp;
+  gint                cell_width;
+  gint                cell_height;
+  gint                width = 0;
+  gint                height = 0;
+  gint                breadth;
+  gint                size;
+  gint                old_size;
+
+  thunar_grid_view_set_cell_data (grid_view, iter);
+
+  for (lp = grid_view->cells; lp != NULL; lp = lp->next)
+    {
+      info = lp->data;
+      if (!gtk_cell_renderer_get_visible (info->cell))
+        continue;
+
+      thunar_grid_view_get_cell_size (grid_view, info, &cell_width, &cell_height);
+      info->max_width = MAX (info->max_width, cell_width);
+      info->max_height = MAX (info->max_height, cell_height);
+
+      /* all cells but the text get the common size of their column, see thunar_grid_view_place_cells() */
+      if (!GTK_IS_CELL_RENDERER_TEXT (info->cell))
+        {
+          cell_width = info->max_width;
+          cell_height = info->max_height;
+        }
+
+      if (grid_view->orientation == GTK_ORIENTATION_VERTICAL)
+        {
+          width = MAX (width, cell_width);
+          height += cell_height;
+        }
+      else
+        {
+          width += cell_width;
+          height = MAX (height, cell_height);
+        }
+    }
+
+  if (grid_view->item_width > 0)
+    width = grid_view->item_width;
+
+  if (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS)
+    {
+      size = MAX (height, 1);
+      breadth = width;
+    }
+  else
+    {
+      size = MAX (width, 1);
+      breadth = height;
+    }
+
+  if (breadth > grid_view->measured_breadth)
+    {
+      grid_view->measured_breadth = breadth;
+      changed = TRUE;
+    }
+
+  old_size = thunar_grid_view_item_get_size (item);
+  thunar_grid_view_item_set_size (item, size);
+  g_hash_table_add (grid_view->measured, item);
+
+  /* a shrinking item may shrink its line, which is only known after a rebuild */
+  if (!grid_view->lines_valid || size < old_size)
+    {
+      grid_view->lines_valid = FALSE;
+      changed = TRUE;
+    }
+  else
+    {
+      changed |= thunar_grid_view_add_line (grid_view, index / grid_view->lines_length, size);
+    }
+
+  return changed;
+}
+
+
+
+/* whether any visible item was not measured yet */
+static gboolean
+thunar_grid_view_visible_needs_measure (ThunarGridView *grid_view)
+{
+  GSequenceIter *item;
+  GdkRectangle   area;
+  gint           first;
+  gint           last;
+  gint           n;
+
+  thunar_grid_view_get_visible_area (grid_view, &area);
+  if (!thunar_grid_view_get_range_for_area (grid_view, &area, &first, &last))
+    return FALSE;
+
+  item = g_sequence_get_iter_at_pos (grid_view->items, first);
+  for (n = first; n <= last; ++n, item = g_sequence_iter_next (item))
+    if (thunar_grid_view_item_needs_measure (item))
+      return TRUE;
+
+  return FALSE;
+}
+
+
+
+/* measures the visible items which were not measured yet, returns %TRUE if the layout
+ * changed. The sizes only change within thunar_grid_view_relayout(), which knows where
+ * the items were before. */
+static gboolean
+thunar_grid_view_measure_visible (ThunarGridView *grid_view)
+{
+  GSequenceIter *item;
+  GdkRectangle   area;
+  GtkTreeIter    iter;
+  gboolean       changed = FALSE;
+  gint           first;
+  gint           last;
+  gint           n;
+
+  if (grid_view->model == NULL)
+    return FALSE;
+
+  thunar_grid_view_get_visible_area (grid_view, &area);
+  if (!thunar_grid_view_get_range_for_area (grid_view, &area, &first, &last))
+    return FALSE;
+
+  if (!gtk_tree_model_iter_nth_child (grid_view->model, &iter, NULL, first))
+    return FALSE;
+
+  for (n = first, item = g_sequence_get_iter_at_pos (grid_view->items, first);; ++n)
+    {
+      if (thunar_grid_view_item_needs_measure (item))
+        changed |= thunar_grid_view_measure_item (grid_view, item, n, &iter);
+
+      if (n >= last || !gtk_tree_model_iter_next (grid_view->model, &iter))
+        break;
+
+      item = g_sequence_iter_next (item);
+    }
+
+  return changed;
+}
+
+
+
+/* computes the grid from the measured lines and the allocation, without looking at any other item */
+static void
+thunar_grid_view_layout (ThunarGridView *grid_view)
+{
+  ThunarGridViewLine *info;
+  gint                allocated_width;
+  gint                allocated_height;
+  gint                length;
+  gint                n_lines;
+  gint                along;
+  gint                across;
+  gint64              total = 0;
+  gint                offset = 0;
+  guint               n;
+
+  if (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS && grid_view->item_width > 0)
+    grid_view->item_breadth = grid_view->item_width;
+  else
+    grid_view->item_breadth = MAX (grid_view->measured_breadth, 1);
+
+  allocated_width = gtk_widget_get_allocated_width (GTK_WIDGET (grid_view));
+  allocated_height = gtk_widget_get_allocated_height (GTK_WIDGET (grid_view));
+
+  if (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS)
+    {
+      grid_view->n_columns = MAX (1, (allocated_width - 2 * grid_view->margin + grid_view->column_spacing)
+                                     / (grid_view->item_breadth + grid_view->column_spacing));
+      grid_view->n_rows = MAX (1, (grid_view->n_items + grid_view->n_columns - 1) / grid_view->n_columns);
+    }
+  else
+    {
+      grid_view->n_rows = MAX (1, (allocated_height - 2 * grid_view->margin + grid_view->row_spacing)
+                                  / (grid_view->item_breadth + grid_view->row_spacing));
+      grid_view->n_columns = MAX (1, (grid_view->n_items + grid_view->n_rows - 1) / grid_view->n_rows);
+    }
+
+  /* the items moved to other lines */
+  length = thunar_grid_view_get_line_length (grid_view);
+  if (grid_view->lines_length != length)
+    {
+      grid_view->lines_length = length;
+      grid_view->lines_valid = FALSE;
+    }
+
+  if (!grid_view->lines_valid)
+    thunar_grid_view_rebuild_lines (grid_view);
+
+  /* lines without measured items are assumed to be of average size */
+  for (n = 0; n < grid_view->lines->len; ++n)
+    total += g_array_index (grid_view->lines, ThunarGridViewLine, n).size;
+  if (grid_view->lines->len > 0)
+    grid_view->line_estimate = MAX (1, (gint) (total / grid_view->lines->len));
+
+  for (n = 0; n < grid_view->lines->len; ++n)
+    {
+      info = &g_array_index (grid_view->lines, ThunarGridViewLine, n);
+      info->offset = offset;
+      offset += info->size - grid_view->line_estimate;
+    }
+
+  n_lines = thunar_grid_view_get_n_lines (grid_view);
+  along = thunar_grid_view_get_line_offset (grid_view, n_lines) - thunar_grid_view_get_line_spacing (grid_view) + grid_view->margin;
+  across = 2 * grid_view->margin + length * grid_view->item_breadth + (length - 1) * thunar_grid_view_get_item_spacing (grid_view);
+
+  if (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS)
+    {
+      grid_view->content_width = MAX (across, allocated_width);
+      grid_view->content_height = MAX (along, allocated_height);
+    }
+  else
+    {
+      grid_view->content_width = MAX (along, allocated_width);
+      grid_view->content_height = MAX (across, allocated_height);
+    }
+}
+
+
+
+static void
+thunar_grid_view_update_adjustments (ThunarGridView *grid_view)
+{
+  gint width = gtk_widget_get_allocated_width (GTK_WIDGET (grid_view));
+  gint height = gtk_widget_get_allocated_height (GTK_WIDGET (grid_view));
+
+  if (grid_view->hadjustment != NULL)
+    {
+      gtk_adjustment_configure (grid_view->hadjustment,
+                                gtk_adjustment_get_value (grid_view->hadjustment),
+                                0, grid_view->content_width,
+                                width * 0.1, width * 0.9, width);
+    }
+
+  if (grid_view->vadjustment != NULL)
+    {
+      gtk_adjustment_configure (grid_view->vadjustment,
+                                gtk_adjustment_get_value (grid_view->vadjustment),
+                                0, grid_view->content_height,
+                                height * 0.1, height * 0.9, height);
+    }
+}
+
+
+
+static void
+thunar_grid_view_relayout (ThunarGridView *grid_view)
+{
+  GtkAdjustment *adjustment;
+  GdkRectangle   area;
+  GdkRectangle   box;
+  GtkTreeIter    iter;
+  gint           anchor = -1;
+  gint           anchor_offset = 0;
+  gint           last;
+
+  grid_view->in_layout = TRUE;
+
+  /* remember where the first visible item is, according to the previous layout */
+  adjustment = (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS) ? grid_view->vadjustment : grid_view->hadjustment;
+  thunar_grid_view_get_visible_area (grid_view, &area);
+  if (grid_view->layout_valid && adjustment != NULL
+      && thunar_grid_view_get_range_for_area (grid_view, &area, &anchor, &last))
+    {
+      thunar_grid_view_get_item_box (grid_view, anchor, &box);
+      anchor_offset = (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS) ? area.y - box.y : area.x - box.x;
+    }
+
+  /* seed the sizes from the first item, so the first visible range is sane */
+  if (g_hash_table_size (grid_view->measured) == 0 && grid_view->model != NULL
+      && gtk_tree_model_iter_nth_child (grid_view->model, &iter, NULL, 0))
+    {
+      thunar_grid_view_measure_item (grid_view, g_sequence_get_begin_iter (grid_view->items), 0, &iter);
+    }
+
+  /* this terminates, since every pass which changes the layout measures new items */
+  do
+    {
+      thunar_grid_view_layout (grid_view);
+      thunar_grid_view_update_adjustments (grid_view);
+
+      /* keep the first visible item in place when the lines before it changed their size */
+      if (anchor >= 0 && anchor < grid_view->n_items)
+        {
+          thunar_grid_view_get_item_box (grid_view, anchor, &box);
+          gtk_adjustment_set_value (adjustment, ((grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS) ? box.y : box.x) + anchor_offset);
+        }
+    }
+  while (thunar_grid_view_measure_visible (grid_view));
+
+  grid_view->in_layout = FALSE;
+  grid_view->layout_pending = FALSE;
+  grid_view->layout_valid = TRUE;
+}
+
+
+
+static void
+thunar_grid_view_queue_layout (ThunarGridView *grid_view)
+{
+  grid_view->layout_pending = TRUE;
+  gtk_widget_queue_resize (GTK_WIDGET (grid_view));
+}
+
+
+
+static void
+thunar_grid_view_invalidate_sizes (ThunarGridView *grid_view)
+{
+  ThunarGridViewCell *info;
+  GHashTableIter      iter;
+  gpointer            item;
+  GList              *lp;
+
+  for (lp = grid_view->cells; lp != NULL; lp = lp->next)
+    {
+      info = lp->data;
+      info->max_width = 0;
+      info->max_height = 0;
+    }
+
+  /* forget the measured items */
+  g_hash_table_iter_init (&iter, grid_view->measured);
+  while (g_hash_table_iter_next (&iter, &item, NULL))
+    thunar_grid_view_item_set_size (item, 0);
+  g_hash_table_remove_all (grid_view->measured);
+  grid_view->measured_breadth = 0;
+  grid_view->lines_valid = FALSE;
+
+  /* the previous layout does not tell where the items will be */
+  grid_view->layout_valid = FALSE;
+
+  thunar_grid_view_queue_layout (grid_view);
+}
+
+
+
+static void
+thunar_grid_view_realize (GtkWidget *widget)
+{
+  GtkAllocation allocation;
+  GdkWindowAttr attributes;
+  GdkWindow    *window;
+  gint          attributes_mask;
+
+  gtk_widget_set_realized (widget, TRUE);
+  gtk_widget_get_allocation (widget, &allocation);
+
+  attributes.window_type = GDK_WINDOW_CHILD;
+  attributes.x = allocation.x;
+  attributes.y = allocation.y;
+  attributes.width = allocation.width;
+  attributes.height = allocation.height;
+  attributes.wclass = GDK_INPUT_OUTPUT;
+  attributes.visual = gtk_widget_get_visual (widget);
+  attributes.event_mask = gtk_widget_get_events (widget)
+                          | GDK_EXPOSURE_MASK
+                          | GDK_SCROLL_MASK
+                          | GDK_SMOOTH_SCROLL_MASK
+                          | GDK_POINTER_MOTION_MASK
+                          | GDK_BUTTON_PRESS_MASK
+                          | GDK_BUTTON_RELEASE_MASK
+                          | GDK_KEY_PRESS_MASK
+                          | GDK_KEY_RELEASE_MASK
+                          | GDK_LEAVE_NOTIFY_MASK;
+  attributes_mask = GDK_WA_X | GDK_WA_Y | GDK_WA_VISUAL;
+
+  window = gdk_window_new (gtk_widget_get_parent_window (widget), &attributes, attributes_mask);
+  gtk_widget_set_window (widget, window);
+  gtk_widget_register_window (widget, window);
+}
+
+
+
+static void
+thunar_grid_view_get_preferred_width (GtkWidget *widget,
+                                      gint      *minimum,
+                                      gint      *natural)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (widget);
+
+  if (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS)
+    *minimum = *natural = 2 * grid_view->margin + grid_view->item_breadth;
+  else
+    *minimum = *natural = 2 * grid_view->margin + grid_view->line_estimate;
+}
+
+
+
+static void
+thunar_grid_view_get_preferred_height (GtkWidget *widget,
+                                       gint      *minimum,
+                                       gint      *natural)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (widget);
+
+  if (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS)
+    *minimum = *natural = 2 * grid_view->margin + grid_view->line_estimate;
+  else
+    *minimum = *natural = 2 * grid_view->margin + grid_view->item_breadth;
+}
+
+
+
+static void
+thunar_grid_view_size_allocate (GtkWidget     *widget,
+                                GtkAllocation *allocation)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (widget);
+  GtkTreePath    *path;
+
+  gtk_widget_set_allocation (widget, allocation);
+
+  if (gtk_widget_get_realized (widget))
+    gdk_window_move_resize (gtk_widget_get_window (widget), allocation->x, allocation->y, allocation->width, allocation->height);
+
+  thunar_grid_view_relayout (grid_view);
+
+  /* apply a pending scroll_to_path() now that the layout is known */
+  if (grid_view->scroll_to_path != NULL)
+    {
+      path = gtk_tree_row_reference_get_path (grid_view->scroll_to_path);
+      gtk_tree_row_reference_free (grid_view->scroll_to_path);
+      grid_view->scroll_to_path = NULL;
+
+      if (path != NULL)
+        {
+          thunar_grid_view_scroll_to_index (grid_view, thunar_grid_view_index_from_path (grid_view, path),
+                                            grid_view->scroll_to_use_align,
+                                            grid_view->scroll_to_row_align,
+                                            grid_view->scroll_to_col_align);
+          gtk_tree_path_free (path);
+        }
+    }
+}
+
+
+
+static void
+thunar_grid_view_place_cells (ThunarGridView     *grid_view,
+                              const GdkRectangle *box,
+                              GdkRectangle       *areas)
+{
+  ThunarGridViewCell *info;
+  gboolean            rtl = thunar_grid_view_is_rtl (grid_view);
+  gfloat              xalign;
+  GList              *lp;
+  gint                offset = 0;
+  gint                width;
+  gint                height;
+  gint                n;
+
+  for (lp = grid_view->cells, n = 0; lp != NULL; lp = lp->next, ++n)
+    {
+      info = lp->data;
+      if (!gtk_cell_renderer_get_visible (info->cell))
+        continue;
+
+      /* text cells only get the size of their own text, so the selection box
+       * hugs the name, all other cells get the common size of their column */
+      if (GTK_IS_CELL_RENDERER_TEXT (info->cell))
+        thunar_grid_view_get_cell_size (grid_view, info, &width, &height);
+      else
+        {
+          width = info->max_width;
+          height = info->max_height;
+        }
+
+      if (grid_view->orientation == GTK_ORIENTATION_VERTICAL)
+        {
+          width = MIN (width, box->width);
+          height = MIN (height, box->height - offset);
+
+          gtk_cell_renderer_get_alignment (info->cell, &xalign, NULL);
+          if (rtl)
+            xalign = 1.0f - xalign;
+
+          areas[n].x = box->x + (gint) ((box->width - width) * xalign);
+          areas[n].y = box->y + offset;
+          areas[n].width = width;
+          areas[n].height = height;
+
+          offset += (GTK_IS_CELL_RENDERER_TEXT (info->cell)) ? height : info->max_height;
+        }
+      else
+        {
+          width = MIN (width, box->width - offset);
+
+          areas[n].x = rtl ? (box->x + box->width - offset - width) : (box->x + offset);
+          areas[n].y = box->y;
+          areas[n].width = width;
+          areas[n].height = box->height;
+
+          offset += (GTK_IS_CELL_RENDERER_TEXT (info->cell)) ? width : info->max_width;
+        }
+    }
+}
+
+
+
+static void
+thunar_grid_view_paint_item (ThunarGridView     *grid_view,
+                             cairo_t            *cr,
+                             gint                index,
+                             guint               flags,
+                             GtkTreeIter        *iter,
+                             const GdkRectangle *box)
+{
+  ThunarGridViewCell  *info;
+  GtkCellRendererState cell_flags = 0;
+  GtkStyleContext     *context;
+  GtkStateFlags        state;
+  GdkRectangle        *areas;
+  GList               *lp;
+  gint                 n;
+
+  context = gtk_widget_get_style_context (GTK_WIDGET (grid_view));
+  state = gtk_widget_get_state_flags (GTK_WIDGET (grid_view)) & ~(GTK_STATE_FLAG_SELECTED | GTK_STATE_FLAG_PRELIGHT);
+
+  if ((flags & THUNAR_GRID_VIEW_ITEM_SELECTED) != 0)
+    {
+      cell_flags |= GTK_CELL_RENDERER_SELECTED;
+      state |= GTK_STATE_FLAG_SELECTED;
+    }
+
+  if (index == grid_view->prelit)
+    {
+      cell_flags |= GTK_CELL_RENDERER_PRELIT;
+      state |= GTK_STATE_FLAG_PRELIGHT;
+    }
+
+  if (index == grid_view->cursor && gtk_widget_has_visible_focus (GTK_WIDGET (grid_view)))
+    cell_flags |= GTK_CELL_RENDERER_FOCUSED;
+
+  thunar_grid_view_set_cell_data (grid_view, iter);
+
+  areas = g_newa (GdkRectangle, g_list_length (grid_view->cells));
+  thunar_grid_view_place_cells (grid_view, box, areas);
+
+  gtk_style_context_save (context);
+  gtk_style_context_add_class (context, GTK_STYLE_CLASS_CELL);
+  gtk_style_context_set_state (context, state);
+
+  for (lp = grid_view->cells, n = 0; lp != NULL; lp = lp->next, ++n)
+    {
+      info = lp->data;
+      if (!gtk_cell_renderer_get_visible (info->cell))
+        continue;
+
+      /* the icon renderers colorize themselves, the text gets a selection box */
+      if ((flags & THUNAR_GRID_VIEW_ITEM_SELECTED) != 0 && GTK_IS_CELL_RENDERER_TEXT (info->cell))
+        {
+          gtk_render_background (context, cr, areas[n].x, areas[n].y, areas[n].width, areas[n].height);
+          gtk_render_frame (context, cr, areas[n].x, areas[n].y, areas[n].width, areas[n].height);
+        }
+
+      gtk_cell_renderer_render (info->cell, cr, GTK_WIDGET (grid_view), &areas[n], &areas[n], cell_flags);
+    }
+
+  if (index == grid_view->drag_dest)
+    {
+      gtk_style_context_set_state (context, state | GTK_STATE_FLAG_DROP_ACTIVE);
+      gtk_render_frame (context, cr, box->x, box->y, box->width, box->height);
+    }
+
+  if ((cell_flags & GTK_CELL_RENDERER_FOCUSED) != 0)
+    gtk_render_focus (context, cr, box->x, box->y, box->width, box->height);
+
+  gtk_style_context_restore (context);
+}
+
+
+
+static gboolean
+thunar_grid_view_draw (GtkWidget *widget,
+                       cairo_t   *cr)
+{
+  ThunarGridView  *grid_view = THUNAR_GRID_VIEW (widget);
+  GtkStyleContext *context;
+  GSequenceIter   *item;
+  GdkRectangle     clip;
+  GdkRectangle     area;
+  GdkRectangle     box;
+  GtkTreeIter      iter;
+  gint             x_offset;
+  gint             y_offset;
+  gint             first;
+  gint             last;
+  gint             n;
+
+  context = gtk_widget_get_style_context (widget);
+  gtk_render_background (context, cr, 0, 0, gtk_widget_get_allocated_width (widget), gtk_widget_get_allocated_height (widget));
+
+  if (grid_view->model == NULL || !gdk_cairo_get_clip_rectangle (cr, &clip))
+    return FALSE;
+
+  x_offset = thunar_grid_view_get_x_offset (grid_view);
+  y_offset = thunar_grid_view_get_y_offset (grid_view);
+
+  /* only walk the items within the clip area */
+  area = clip;
+  area.x += x_offset;
+  area.y += y_offset;
+  if (thunar_grid_view_get_range_for_area (grid_view, &area, &first, &last)
+      && gtk_tree_model_iter_nth_child (grid_view->model, &iter, NULL, first))
+    {
+      for (n = first, item = g_sequence_get_iter_at_pos (grid_view->items, first);; ++n)
+        {
+          thunar_grid_view_get_item_box (grid_view, n, &box);
+          box.x -= x_offset;
+          box.y -= y_offset;
+
+          if (gdk_rectangle_intersect (&box, &clip, NULL))
+            thunar_grid_view_paint_item (grid_view, cr, n, thunar_grid_view_item_get_flags (item), &iter, &box);
+
+          if (n >= last || !gtk_tree_model_iter_next (grid_view->model, &iter))
+            break;
+
+          item = g_sequence_iter_next (item);
+        }
+    }
+
+  if (grid_view->rubberbanding)
+    {
+      area.x = MIN (grid_view->rubberband_x1, grid_view->rubberband_x2) - x_offset;
+      area.y = MIN (grid_view->rubberband_y1, grid_view->rubberband_y2) - y_offset;
+      area.width = ABS (grid_view->rubberband_x1 - grid_view->rubberband_x2) + 1;
+      area.height = ABS (grid_view->rubberband_y1 - grid_view->rubberband_y2) + 1;
+
+      gtk_style_context_save (context);
+      gtk_style_context_add_class (context, GTK_STYLE_CLASS_RUBBERBAND);
+      gtk_render_background (context, cr, area.x, area.y, area.width, area.height);
+      gtk_render_frame (context, cr, area.x, area.y, area.width, area.height);
+      gtk_style_context_restore (context);
+    }
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_grid_view_set_prelit (ThunarGridView *grid_view,
+                             gint            index)
+{
+  GdkCursor *cursor = NULL;
+  GdkWindow *window;
+
+  if (grid_view->prelit == index)
+    return;
+
+  thunar_grid_view_queue_draw_item (grid_view, grid_view->prelit);
+  grid_view->prelit = index;
+  thunar_grid_view_queue_draw_item (grid_view, grid_view->prelit);
+
+  /* show a hand cursor above items in single click mode */
+  window = gtk_widget_get_window (GTK_WIDGET (grid_view));
+  if (window != NULL)
+    {
+      if (grid_view->single_click && index >= 0)
+        cursor = gdk_cursor_new_from_name (gdk_window_get_display (window), "pointer");
+      gdk_window_set_cursor (window, cursor);
+      if (cursor != NULL)
+        g_object_unref (cursor);
+    }
+}
+
+
+
+static gboolean
+thunar_grid_view_single_click_timeout (gpointer user_data)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (user_data);
+  gboolean        changed;
+
+  grid_view->single_click_timeout_id = 0;
+
+  /* select the item below the pointer */
+  if (grid_view->prelit >= 0 && grid_view->pressed < 0 && !grid_view->rubberbanding)
+    {
+      changed = thunar_grid_view_unselect_all_internal (grid_view);
+      changed |= thunar_grid_view_select_range (grid_view, grid_view->prelit, grid_view->prelit);
+      grid_view->cursor = grid_view->anchor = grid_view->prelit;
+      thunar_grid_view_accessible_cursor_changed (grid_view);
+
+      if (changed)
+        thunar_grid_view_selection_changed (grid_view);
+    }
+
+  return FALSE;
+}
+
+
+
+static gboolean
+thunar_grid_view_button_press_event (GtkWidget      *widget,
+                                     GdkEventButton *event)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (widget);
+  GdkModifierType modifiers;
+  GSequenceIter  *item;
+  gboolean        changed = FALSE;
+  gint            index;
+
+  if (event->window != gtk_widget_get_window (widget))
+    return FALSE;
+
+  if (!gtk_widget_has_focus (widget))
+    gtk_widget_grab_focus (widget);
+
+  if (event->button != 1)
+    return FALSE;
+
+  modifiers = event->state & gtk_accelerator_get_default_mod_mask ();
+  index = thunar_grid_view_get_index_at_pos (grid_view,
+                                             event->x + thunar_grid_view_get_x_offset (grid_view),
+                                             event->y + thunar_grid_view_get_y_offset (grid_view));
+
+  if (event->type == GDK_BUTTON_PRESS)
+    {
+      grid_view->press_deferred = FALSE;
+
+      if (index >= 0)
+        {
+          if ((modifiers & GDK_SHIFT_MASK) != 0)
+            {
+              /* extend the selection from the anchor */
+              if (grid_view->anchor < 0)
+                grid_view->anchor = index;
+              if ((modifiers & GDK_CONTROL_MASK) == 0)
+                changed |= thunar_grid_view_unselect_all_internal (grid_view);
+              changed |= thunar_grid_view_select_range (grid_view, MIN (grid_view->anchor, index), MAX (grid_view->anchor, index));
+            }
+          else if ((modifiers & GDK_CONTROL_MASK) != 0)
+            {
+              /* toggle the item */
+              item = g_sequence_get_iter_at_pos (grid_view->items, index);
+              changed |= thunar_grid_view_item_set_selected (grid_view, item,
+                                                             (thunar_grid_view_item_get_flags (item) & THUNAR_GRID_VIEW_ITEM_SELECTED) == 0);
+              grid_view->anchor = index;
+            }
+          else if (!thunar_grid_view_index_is_selected (grid_view, index))
+            {
+              changed |= thunar_grid_view_unselect_all_internal (grid_view);
+              changed |= thunar_grid_view_select_range (grid_view, index, index);
+              grid_view->anchor = index;
+            }
+          else
+            {
+              /* keep the selection for a possible drag, and collapse it on release */
+              grid_view->press_deferred = TRUE;
+              grid_view->anchor = index;
+            }
+
+          grid_view->cursor = index;
+          grid_view->pressed = index;
+          thunar_grid_view_accessible_cursor_changed (grid_view);
+        }
+      else
+        {
+          if ((modifiers & (GDK_SHIFT_MASK | GDK_CONTROL_MASK)) == 0)
+            changed |= thunar_grid_view_unselect_all_internal (grid_view);
+
+          /* start a rubberband selection; remember the current selection if there is one */
+          grid_view->rubberbanding = TRUE;
+          grid_view->rubberband_modify = (modifiers & GDK_CONTROL_MASK) != 0;
+          grid_view->rubberband_previous = (grid_view->n_selected > 0);
+          grid_view->rubberband_x1 = grid_view->rubberband_x2 = event->x + thunar_grid_view_get_x_offset (grid_view);
+          grid_view->rubberband_y1 = grid_view->rubberband_y2 = event->y + thunar_grid_view_get_y_offset (grid_view);
+          grid_view->pointer_x = event->x;
+          grid_view->pointer_y = event->y;
+
+          if (grid_view->rubberband_previous)
+            {
+              for (item = g_sequence_get_begin_iter (grid_view->items); !g_sequence_iter_is_end (item); item = g_sequence_iter_next (item))
+                {
+                  guint flags = thunar_grid_view_item_get_flags (item) & ~THUNAR_GRID_VIEW_ITEM_PREVIOUS;
+                  if ((flags & THUNAR_GRID_VIEW_ITEM_SELECTED) != 0)
+                    flags |= THUNAR_GRID_VIEW_ITEM_PREVIOUS;
+                  thunar_grid_view_item_set_flags (item, flags);
+                }
+            }
+        }
+
+      gtk_widget_queue_draw (widget);
+
+      if (changed)
+        thunar_grid_view_selection_changed (grid_view);
+    }
+  else if (event->type == GDK_2BUTTON_PRESS && index >= 0 && !grid_view->single_click
+           && (modifiers & (GDK_SHIFT_MASK | GDK_CONTROL_MASK)) == 0)
+    {
+      thunar_grid_view_item_activated (grid_view, index);
+    }
+
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_grid_view_button_release_event (GtkWidget      *widget,
+                                       GdkEventButton *event)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (widget);
+  GdkModifierType modifiers;
+  gboolean        changed;
+  gint            index;
+
+  if (event->button != 1)
+    return FALSE;
+
+  if (grid_view->rubberbanding)
+    {
+      thunar_grid_view_stop_rubberband (grid_view);
+    }
+  else if (grid_view->pressed >= 0)
+    {
+      modifiers = event->state & gtk_accelerator_get_default_mod_mask ();
+      index = thunar_grid_view_get_index_at_pos (grid_view,
+                                                 event->x + thunar_grid_view_get_x_offset (grid_view),
+                                                 event->y + thunar_grid_view_get_y_offset (grid_view));
+      if (index == grid_view->pressed)
+        {
+          if (grid_view->press_deferred)
+            {
+              changed = thunar_grid_view_unselect_all_internal (grid_view);
+              changed |= thunar_grid_view_select_range (grid_view, index, index);
+              if (changed)
+                thunar_grid_view_selection_changed (grid_view);
+            }
+
+          if (grid_view->single_click && (modifiers & (GDK_SHIFT_MASK | GDK_CONTROL_MASK)) == 0)
+            thunar_grid_view_item_activated (grid_view, index);
+        }
+    }
+
+  grid_view->pressed = -1;
+  grid_view->press_deferred = FALSE;
+
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_grid_view_rubberband_scroll (gpointer user_data)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (user_data);
+  gint            width = gtk_widget_get_allocated_width (GTK_WIDGET (grid_view));
+  gint            height = gtk_widget_get_allocated_height (GTK_WIDGET (grid_view));
+  gint            dx = 0;
+  gint            dy = 0;
+
+  if (grid_view->pointer_x < 0)
+    dx = grid_view->pointer_x;
+  else if (grid_view->pointer_x > width)
+    dx = grid_view->pointer_x - width;
+
+  if (grid_view->pointer_y < 0)
+    dy = grid_view->pointer_y;
+  else if (grid_view->pointer_y > height)
+    dy = grid_view->pointer_y - height;
+
+  if (!grid_view->rubberbanding || (dx == 0 && dy == 0))
+    {
+      grid_view->rubberband_scroll_id = 0;
+      return FALSE;
+    }
+
+  /* the rubberband follows in the value-changed handler */
+  if (dx != 0 && grid_view->hadjustment != NULL)
+    gtk_adjustment_set_value (grid_view->hadjustment, gtk_adjustment_get_value (grid_view->hadjustment) + dx);
+  if (dy != 0 && grid_view->vadjustment != NULL)
+    gtk_adjustment_set_value (grid_view->vadjustment, gtk_adjustment_get_value (grid_view->vadjustment) + dy);
+
+  return TRUE;
+}
+
+
+
+static void
+thunar_grid_view_update_rubberband (ThunarGridView *grid_view)
+{
+  GSequenceIter *item;
+  GdkRectangle   old_area;
+  GdkRectangle   new_area;
+  GdkRectangle   area;
+  GdkRectangle   box;
+  gboolean       changed = FALSE;
+  gboolean       previous;
+  guint          flags;
+  gint           first;
+  gint           last;
+  gint           n;
+
+  old_area.x = MIN (grid_view->rubberband_x1, grid_view->rubberband_x2);
+  old_area.y = MIN (grid_view->rubberband_y1, grid_view->rubberband_y2);
+  old_area.width = ABS (grid_view->rubberband_x1 - grid_view->rubberband_x2) + 1;
+  old_area.height = ABS (grid_view->rubberband_y1 - grid_view->rubberband_y2) + 1;
+
+  grid_view->rubberband_x2 = CLAMP (grid_view->pointer_x + thunar_grid_view_get_x_offset (grid_view), 0, grid_view->content_width - 1);
+  grid_view->rubberband_y2 = CLAMP (grid_view->pointer_y + thunar_grid_view_get_y_offset (grid_view), 0, grid_view->content_height - 1);
+
+  new_area.x = MIN (grid_view->rubberband_x1, grid_view->rubberband_x2);
+  new_area.y = MIN (grid_view->rubberband_y1, grid_view->rubberband_y2);
+  new_area.width = ABS (grid_view->rubberband_x1 - grid_view->rubberband_x2) + 1;
+  new_area.height = ABS (grid_view->rubberband_y1 - grid_view->rubberband_y2) + 1;
+
+  /* only the items below the old or the new rubberband can change */
+  gdk_rectangle_union (&old_area, &new_area, &area);
+  if (thunar_grid_view_get_range_for_area (grid_view, &area, &first, &last))
+    {
+      item = g_sequence_get_iter_at_pos (grid_view->items, first);
+      for (n = first; n <= last; ++n, item = g_sequence_iter_next (item))
+        {
+          thunar_grid_view_get_item_box (grid_view, n, &box);
+
+          flags = thunar_grid_view_item_get_flags (item);
+          previous = grid_view->rubberband_previous && (flags & THUNAR_GRID_VIEW_ITEM_PREVIOUS) != 0;
+
+          if (gdk_rectangle_intersect (&box, &new_area, NULL))
+            changed |= thunar_grid_view_item_set_selected (grid_view, item, grid_view->rubberband_modify ? !previous : TRUE);
+          else
+            changed |= thunar_grid_view_item_set_selected (grid_view, item, previous);
+        }
+    }
+
+  gtk_widget_queue_draw (GTK_WIDGET (grid_view));
+
+  if (changed)
+    thunar_grid_view_selection_changed (grid_view);
+}
+
+
+
+static void
+thunar_grid_view_stop_rubberband (ThunarGridView *grid_view)
+{
+  if (!grid_view->rubberbanding)
+    return;
+
+  grid_view->rubberbanding = FALSE;
+
+  if (grid_view->rubberband_scroll_id != 0)
+    {
+      g_source_remove (grid_view->rubberband_scroll_id);
+      grid_view->rubberband_scroll_id = 0;
+    }
+
+  gtk_widget_queue_draw (GTK_WIDGET (grid_view));
+}
+
+
+
+static gboolean
+thunar_grid_view_motion_notify_event (GtkWidget      *widget,
+                                      GdkEventMotion *event)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (widget);
+  gint            index;
+
+  if (grid_view->rubberbanding)
+    {
+      grid_view->pointer_x = event->x;
+      grid_view->pointer_y = event->y;
+      thunar_grid_view_update_rubberband (grid_view);
+
+      /* keep scrolling while the pointer is outside of the view */
+      if (grid_view->rubberband_scroll_id == 0
+          && (event->x < 0 || event->y < 0 || event->x > gtk_widget_get_allocated_width (widget) || event->y > gtk_widget_get_allocated_height (widget)))
+        {
+          grid_view->rubberband_scroll_id = g_timeout_add (THUNAR_GRID_VIEW_SCROLL_INTERVAL, thunar_grid_view_rubberband_scroll, grid_view);
+        }
+
+      return TRUE;
+    }
+
+  index = thunar_grid_view_get_index_at_pos (grid_view,
+                                             event->x + thunar_grid_view_get_x_offset (grid_view),
+                                             event->y + thunar_grid_view_get_y_offset (grid_view));
+  if (index != grid_view->prelit)
+    {
+      thunar_grid_view_set_prelit (grid_view, index);
+
+      if (grid_view->single_click_timeout_id != 0)
+        {
+          g_source_remove (grid_view->single_click_timeout_id);
+          grid_view->single_click_timeout_id = 0;
+        }
+
+      if (grid_view->single_click && grid_view->single_click_timeout > 0 && index >= 0
+          && (event->state & (GDK_BUTTON1_MASK | GDK_BUTTON2_MASK | GDK_BUTTON3_MASK)) == 0)
+        {
+          grid_view->single_click_timeout_id = g_timeout_add (grid_view->single_click_timeout, thunar_grid_view_single_click_timeout, grid_view);
+        }
+    }
+
+  return FALSE;
+}
+
+
+
+static gboolean
+thunar_grid_view_leave_notify_event (GtkWidget        *widget,
+                                     GdkEventCrossing *event)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (widget);
+
+  if (grid_view->single_click_timeout_id != 0)
+    {
+      g_source_remove (grid_view->single_click_timeout_id);
+      grid_view->single_click_timeout_id = 0;
+    }
+
+  thunar_grid_view_set_prelit (grid_view, -1);
+
+  return FALSE;
+}
+
+
+
+/* first item from @start on in the direction of @step (wrapping around) whose search column starts with @prefix */
+static gint
+thunar_grid_view_search (ThunarGridView *grid_view,
+                         const gchar    *prefix,
+                         gint            start,
+                         gint            step)
+{
+  GtkTreeIter iter;
+  gboolean    found;
+  gchar      *name;
+  gchar      *folded;
+  gint        n;
+  gint        index;
+
+  if (grid_view->n_items == 0)
+    return -1;
+
+  start = (start + grid_view->n_items) % grid_view->n_items;
+  if (!gtk_tree_model_iter_nth_child (grid_view->model, &iter, NULL, start))
+    return -1;
+
+  for (n = 0, index = start; n < grid_view->n_items; ++n)
+    {
+      gtk_tree_model_get (grid_view->model, &iter, grid_view->search_column, &name, -1);
+      if (name != NULL)
+        {
+          folded = g_utf8_casefold (name, -1);
+          found = g_str_has_prefix (folded, prefix);
+          g_free (folded);
+          g_free (name);
+
+          if (found)
+            return index;
+        }
+
+      /* wrap around at either end */
+      index += step;
+      if (index < 0 || index >= grid_view->n_items)
+        {
+          index = (index < 0) ? grid_view->n_items - 1 : 0;
+          if (!gtk_tree_model_iter_nth_child (grid_view->model, &iter, NULL, index))
+            break;
+        }
+      else if (!((step > 0) ? gtk_tree_model_iter_next (grid_view->model, &iter) : gtk_tree_model_iter_previous (grid_view->model, &iter)))
+        {
+          break;
+        }
+    }
+
+  return -1;
+}
+
+
+
+/* makes the item at @index the only selected one and moves the cursor there */
+static void
+thunar_grid_view_search_select (ThunarGridView *grid_view,
+                                gint            index)
+{
+  if (thunar_grid_view_unselect_all_internal (grid_view) | thunar_grid_view_select_range (grid_view, index, index))
+    thunar_grid_view_selection_changed (grid_view);
+
+  grid_view->cursor = grid_view->anchor = index;
+  thunar_grid_view_accessible_cursor_changed (grid_view);
+  thunar_grid_view_scroll_to_index (grid_view, index, FALSE, 0.0f, 0.0f);
+  gtk_widget_queue_draw (GTK_WIDGET (grid_view));
+}
+
+
+
+/* the next (or previous) match of the search text after the cursor */
+static void
+thunar_grid_view_search_move (ThunarGridView *grid_view,
+                              gint            step)
+{
+  gchar *prefix;
+  gint   index;
+
+  prefix = g_utf8_casefold (gtk_entry_get_text (GTK_ENTRY (grid_view->search_entry)), -1);
+  index = thunar_grid_view_search (grid_view, prefix, grid_view->cursor + step, step);
+  g_free (prefix);
+
+  if (index >= 0)
+    thunar_grid_view_search_select (grid_view, index);
+  else
+    gtk_widget_error_bell (GTK_WIDGET (grid_view));
+}
+
+
+
+static void
+thunar_grid_view_send_focus_change (GtkWidget *widget,
+                                    gboolean   in)
+{
+  GdkEvent *event;
+  GdkSeat  *seat;
+
+  event = gdk_event_new (GDK_FOCUS_CHANGE);
+  event->focus_change.window = g_object_ref (gtk_widget_get_window (widget));
+  event->focus_change.in = in;
+
+  seat = gdk_display_get_default_seat (gtk_widget_get_display (widget));
+  gdk_event_set_device (event, gdk_seat_get_keyboard (seat));
+
+  gtk_widget_send_focus_change (widget, event);
+  gdk_event_free (event);
+}
+
+
+
+static void
+thunar_grid_view_search_hide (ThunarGridView *grid_view)
+{
+  if (grid_view->search_timeout_id != 0)
+    {
+      g_source_remove (grid_view->search_timeout_id);
+      grid_view->search_timeout_id = 0;
+    }
+
+  if (grid_view->search_window == NULL)
+    return;
+
+  if (gtk_widget_get_visible (grid_view->search_window))
+    {
+      thunar_grid_view_send_focus_change (grid_view->search_entry, FALSE);
+      gtk_widget_hide (grid_view->search_window);
+    }
+
+  /* the next search starts over, without touching the selection */
+  g_signal_handlers_block_by_func (grid_view->search_entry, thunar_grid_view_search_changed, grid_view);
+  gtk_entry_set_text (GTK_ENTRY (grid_view->search_entry), "");
+  g_signal_handlers_unblock_by_func (grid_view->search_entry, thunar_grid_view_search_changed, grid_view);
+}
+
+
+
+static gboolean
+thunar_grid_view_search_timeout (gpointer user_data)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (user_data);
+
+  grid_view->search_timeout_id = 0;
+  thunar_grid_view_search_hide (grid_view);
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_grid_view_search_restart_timeout (ThunarGridView *grid_view)
+{
+  if (grid_view->search_timeout_id != 0)
+    g_source_remove (grid_view->search_timeout_id);
+  grid_view->search_timeout_id = g_timeout_add (THUNAR_GRID_VIEW_SEARCH_DIALOG_TIMEOUT, thunar_grid_view_search_timeout, grid_view);
+}
+
+
+
+static void
+thunar_grid_view_search_changed (GtkEntry       *entry,
+                                 ThunarGridView *grid_view)
+{
+  const gchar *text;
+  gchar       *prefix;
+  gint         index;
+
+  thunar_grid_view_search_restart_timeout (grid_view);
+
+  /* every change starts over at the first item */
+  text = gtk_entry_get_text (entry);
+  if (*text == '\0')
+    {
+      if (thunar_grid_view_unselect_all_internal (grid_view))
+        thunar_grid_view_selection_changed (grid_view);
+      return;
+    }
+
+  prefix = g_utf8_casefold (text, -1);
+  index = thunar_grid_view_search (grid_view, prefix, 0, 1);
+  g_free (prefix);
+
+  if (index >= 0)
+    thunar_grid_view_search_select (grid_view, index);
+  else if (thunar_grid_view_unselect_all_internal (grid_view))
+    thunar_grid_view_selection_changed (grid_view);
+}
+
+
+
+static void
+thunar_grid_view_search_activate (GtkEntry       *entry,
+                                  ThunarGridView *grid_view)
+{
+  thunar_grid_view_search_hide (grid_view);
+
+  if (grid_view->cursor >= 0 && thunar_grid_view_index_is_selected (grid_view, grid_view->cursor))
+    thunar_grid_view_item_activated (grid_view, grid_view->cursor);
+}
+
+
+
+static gboolean
+thunar_grid_view_search_key_press_event (GtkWidget      *window,
+                                         GdkEventKey    *event,
+                                         ThunarGridView *grid_view)
+{
+  switch (event->keyval)
+    {
+    case GDK_KEY_Escape:
+    case GDK_KEY_Tab:
+    case GDK_KEY_KP_Tab:
+    case GDK_KEY_ISO_Left_Tab:
+      thunar_grid_view_search_hide (grid_view);
+      return TRUE;
+
+    case GDK_KEY_Up:
+    case GDK_KEY_KP_Up:
+      thunar_grid_view_search_move (grid_view, -1);
+      thunar_grid_view_search_restart_timeout (grid_view);
+      return TRUE;
+
+    case GDK_KEY_Down:
+    case GDK_KEY_KP_Down:
+      thunar_grid_view_search_move (grid_view, 1);
+      thunar_grid_view_search_restart_timeout (grid_view);
+      return TRUE;
+
+    default:
+      /* everything else goes to the entry */
+      thunar_grid_view_search_restart_timeout (grid_view);
+      return FALSE;
+    }
+}
+
+
+
+static gboolean
+thunar_grid_view_search_button_press_event (GtkWidget      *window,
+                                            GdkEventButton *event,
+                                            ThunarGridView *grid_view)
+{
+  /* a click outside of the entry ends the search */
+  thunar_grid_view_search_hide (grid_view);
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_grid_view_search_scroll_event (GtkWidget      *window,
+                                      GdkEventScroll *event,
+                                      ThunarGridView *grid_view)
+{
+  if (event->direction == GDK_SCROLL_UP)
+    thunar_grid_view_search_move (grid_view, -1);
+  else if (event->direction == GDK_SCROLL_DOWN)
+    thunar_grid_view_search_move (grid_view, 1);
+  else
+    return FALSE;
+
+  thunar_grid_view_search_restart_timeout (grid_view);
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_grid_view_search_delete_event (GtkWidget      *window,
+                                      GdkEvent       *event,
+                                      ThunarGridView *grid_view)
+{
+  thunar_grid_view_search_hide (grid_view);
+  return TRUE;
+}
+
+
+
+static void
+thunar_grid_view_search_ensure_window (ThunarGridView *grid_view)
+{
+  GtkWidget *toplevel;
+  GtkWidget *frame;
+  GtkWidget *vbox;
+
+  toplevel = gtk_widget_get_toplevel (GTK_WIDGET (grid_view));
+
+  if (grid_view->search_window != NULL)
+    {
+      /* the view may have been moved to another window */
+      if (GTK_IS_WINDOW (toplevel))
+        {
+          gtk_window_group_add_window (gtk_window_get_group (GTK_WINDOW (toplevel)), GTK_WINDOW (grid_view->search_window));
+          gtk_window_set_transient_for (GTK_WINDOW (grid_view->search_window), GTK_WINDOW (toplevel));
+        }
+      return;
+    }
+
+  grid_view->search_window = gtk_window_new (GTK_WINDOW_POPUP);
+  gtk_window_set_type_hint (GTK_WINDOW (grid_view->search_window), GDK_WINDOW_TYPE_HINT_UTILITY);
+  gtk_window_set_modal (GTK_WINDOW (grid_view->search_window), TRUE);
+  gtk_window_set_screen (GTK_WINDOW (grid_view->search_window), gtk_widget_get_screen (GTK_WIDGET (grid_view)));
+  if (GTK_IS_WINDOW (toplevel))
+    {
+      gtk_window_group_add_window (gtk_window_get_group (GTK_WINDOW (toplevel)), GTK_WINDOW (grid_view->search_window));
+      gtk_window_set_transient_for (GTK_WINDOW (grid_view->search_window), GTK_WINDOW (toplevel));
+    }
+  g_signal_connect (grid_view->search_window, "delete-event", G_CALLBACK (thunar_grid_view_search_delete_event), grid_view);
+  g_signal_connect (grid_view->search_window, "key-press-event", G_CALLBACK (thunar_grid_view_search_key_press_event), grid_view);
+  g_signal_connect (grid_view->search_window, "button-press-event", G_CALLBACK (thunar_grid_view_search_button_press_event), grid_view);
+  g_signal_connect (grid_view->search_window, "scroll-event", G_CALLBACK (thunar_grid_view_search_scroll_event), grid_view);
+
+  frame = gtk_frame_new (NULL);
+  gtk_frame_set_shadow_type (GTK_FRAME (frame), GTK_SHADOW_ETCHED_IN);
+  gtk_container_add (GTK_CONTAINER (grid_view->search_window), frame);
+  gtk_widget_show (frame);
+
+  vbox = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  gtk_container_set_border_width (GTK_CONTAINER (vbox), 3);
+  gtk_container_add (GTK_CONTAINER (frame), vbox);
+  gtk_widget_show (vbox);
+
+  grid_view->search_entry = gtk_entry_new ();
+  g_signal_connect (grid_view->search_entry, "activate", G_CALLBACK (thunar_grid_view_search_activate), grid_view);
+  g_signal_connect (grid_view->search_entry, "changed", G_CALLBACK (thunar_grid_view_search_changed), grid_view);
+  gtk_container_add (GTK_CONTAINER (vbox), grid_view->search_entry);
+  gtk_widget_show (grid_view->search_entry);
+
+  /* keys forwarded to the hidden popup have to reach the entry */
+  gtk_widget_grab_focus (grid_view->search_entry);
+  gtk_widget_realize (grid_view->search_entry);
+}
+
+
+
+/* places the popup below the lower right corner of the view, but on the screen */
+static void
+thunar_grid_view_search_position (ThunarGridView *grid_view)
+{
+  GtkRequisition requisition;
+  GdkRectangle   workarea;
+  GdkMonitor    *monitor;
+  GdkWindow     *window;
+  gint           x;
+  gint           y;
+
+  window = gtk_widget_get_window (GTK_WIDGET (grid_view));
+  gdk_window_get_origin (window, &x, &y);
+  gtk_widget_get_preferred_size (grid_view->search_window, &requisition, NULL);
+
+  monitor = gdk_display_get_monitor_at_window (gdk_window_get_display (window), window);
+  gdk_monitor_get_workarea (monitor, &workarea);
+
+  x += gtk_widget_get_allocated_width (GTK_WIDGET (grid_view)) - requisition.width;
+  y += gtk_widget_get_allocated_height (GTK_WIDGET (grid_view));
+  x = CLAMP (x, workarea.x, workarea.x + workarea.width - requisition.width);
+  y = CLAMP (y, workarea.y, workarea.y + workarea.height - requisition.height);
+
+  gtk_window_move (GTK_WINDOW (grid_view->search_window), x, y);
+}
+
+
+
+/* passes the key to the search entry, and shows the popup if the key changed the search text */
+static gboolean
+thunar_grid_view_search_key_press (ThunarGridView *grid_view,
+                                   GdkEventKey    *event)
+{
+  GdkEvent *new_event;
+  gboolean  handled;
+  gboolean  text_modified;
+  gchar    *old_text;
+
+  if (grid_view->search_column < 0 || !gtk_widget_get_realized (GTK_WIDGET (grid_view)))
+    return FALSE;
+
+  thunar_grid_view_search_ensure_window (grid_view);
+
+  /* the event has to look like it came from the popup */
+  old_text = g_strdup (gtk_entry_get_text (GTK_ENTRY (grid_view->search_entry)));
+  new_event = gdk_event_copy ((GdkEvent *) event);
+  g_object_unref (new_event->key.window);
+  new_event->key.window = g_object_ref (gtk_widget_get_window (grid_view->search_window));
+  handled = gtk_widget_event (grid_view->search_window, new_event);
+  gdk_event_free (new_event);
+
+  text_modified = g_strcmp0 (old_text, gtk_entry_get_text (GTK_ENTRY (grid_view->search_entry))) != 0;
+  g_free (old_text);
+
+  if (!gtk_widget_get_visible (grid_view->search_window))
+    {
+      if (!handled || !text_modified)
+        return handled;
+
+      thunar_grid_view_search_position (grid_view);
+      gtk_widget_show (grid_view->search_window);
+      thunar_grid_view_send_focus_change (grid_view->search_entry, TRUE);
+      gtk_editable_set_position (GTK_EDITABLE (grid_view->search_entry), -1);
+    }
+
+  thunar_grid_view_search_restart_timeout (grid_view);
+
+  return TRUE;
+}
+
+
+
+static gint
+thunar_grid_view_get_line (ThunarGridView *grid_view,
+                           gint            index)
+{
+  if (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS)
+    return index / grid_view->n_columns;
+  else
+    return index / grid_view->n_rows;
+}
+
+
+
+static void
+thunar_grid_view_move_cursor (ThunarGridView *grid_view,
+                              gint            index,
+                              GdkModifierType modifiers)
+{
+  gboolean changed = FALSE;
+
+  if ((modifiers & GDK_SHIFT_MASK) != 0)
+    {
+      if (grid_view->anchor < 0)
+        grid_view->anchor = (grid_view->cursor >= 0) ? grid_view->cursor : index;
+      if ((modifiers & GDK_CONTROL_MASK) == 0)
+        changed |= thunar_grid_view_unselect_all_internal (grid_view);
+      changed |= thunar_grid_view_select_range (grid_view, MIN (grid_view->anchor, index), MAX (grid_view->anchor, index));
+    }
+  else if ((modifiers & GDK_CONTROL_MASK) == 0)
+    {
+      /* plain movement selects only the new cursor item */
+      changed |= thunar_grid_view_unselect_all_internal (grid_view);
+      changed |= thunar_grid_view_select_range (grid_view, index, index);
+      grid_view->anchor = index;
+    }
+
+  grid_view->cursor = index;
+  thunar_grid_view_accessible_cursor_changed (grid_view);
+  thunar_grid_view_scroll_to_index (grid_view, index, FALSE, 0.0f, 0.0f);
+  gtk_widget_queue_draw (GTK_WIDGET (grid_view));
+
+  if (changed)
+    thunar_grid_view_selection_changed (grid_view);
+}
+
+
+
+static gboolean
+thunar_grid_view_key_press_event (GtkWidget   *widget,
+                                  GdkEventKey *event)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (widget);
+  GdkModifierType modifiers;
+  GSequenceIter  *item;
+  gboolean        line_move = FALSE;
+  gint            cursor;
+  gint            index;
+  gint            page;
+
+  /* while the search popup is shown, all keys belong to it */
+  if (grid_view->search_window != NULL && gtk_widget_get_visible (grid_view->search_window))
+    return thunar_grid_view_search_key_press (grid_view, event);
+
+  if (grid_view->model == NULL || grid_view->n_items == 0)
+    return (*GTK_WIDGET_CLASS (thunar_grid_view_parent_class)->key_press_event) (widget, event);
+
+  modifiers = event->state & gtk_accelerator_get_default_mod_mask ();
+  cursor = CLAMP (grid_view->cursor, 0, grid_view->n_items - 1);
+
+  /* number of items on a page, in scroll direction */
+  if (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS)
+    page = MAX (1, gtk_widget_get_allocated_height (widget) / (grid_view->line_estimate + grid_view->row_spacing)) * grid_view->n_columns;
+  else
+    page = MAX (1, gtk_widget_get_allocated_width (widget) / (grid_view->line_estimate + grid_view->column_spacing)) * grid_view->n_rows;
+
+  switch (event->keyval)
+    {
+    case GDK_KEY_Up:
+    case GDK_KEY_KP_Up:
+      index = cursor - ((grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS) ? grid_view->n_columns : 1);
+      line_move = TRUE;
+      break;
+
+    case GDK_KEY_Down:
+    case GDK_KEY_KP_Down:
+      index = cursor + ((grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS) ? grid_view->n_columns : 1);
+      line_move = TRUE;
+      break;
+
+    case GDK_KEY_Left:
+    case GDK_KEY_KP_Left:
+    case GDK_KEY_Right:
+    case GDK_KEY_KP_Right:
+      index = (grid_view->layout_mode == THUNAR_GRID_VIEW_LAYOUT_ROWS) ? 1 : grid_view->n_rows;
+      if ((event->keyval == GDK_KEY_Left || event->keyval == GDK_KEY_KP_Left) != thunar_grid_view_is_rtl (grid_view))
+        index = -index;
+      index += cursor;
+      line_move = TRUE;
+      break;
+
+    case GDK_KEY_Home:
+    case GDK_KEY_KP_Home:
+      index = 0;
+      break;
+
+    case GDK_KEY_End:
+    case GDK_KEY_KP_End:
+      index = grid_view->n_items - 1;
+      break;
+
+    case GDK_KEY_Page_Up:
+    case GDK_KEY_KP_Page_Up:
+      index = MAX (cursor - page, 0);
+      break;
+
+    case GDK_KEY_Page_Down:
+    case GDK_KEY_KP_Page_Down:
+      index = MIN (cursor + page, grid_view->n_items - 1);
+      break;
+
+    case GDK_KEY_space:
+    case GDK_KEY_KP_Space:
+      item = g_sequence_get_iter_at_pos (grid_view->items, cursor);
+      if ((modifiers & GDK_CONTROL_MASK) != 0)
+        thunar_grid_view_item_set_selected (grid_view, item, (thunar_grid_view_item_get_flags (item) & THUNAR_GRID_VIEW_ITEM_SELECTED) == 0);
+      else
+        thunar_grid_view_item_set_selected (grid_view, item, TRUE);
+      grid_view->cursor = grid_view->anchor = cursor;
+      thunar_grid_view_accessible_cursor_changed (grid_view);
+      thunar_grid_view_selection_changed (grid_view);
+      return TRUE;
+
+    case GDK_KEY_Return:
+    case GDK_KEY_ISO_Enter:
+    case GDK_KEY_KP_Enter:
+      if (grid_view->cursor >= 0)
+        thunar_grid_view_item_activated (grid_view, grid_view->cursor);
+      return TRUE;
+
+    default:
+      if ((modifiers & (GDK_CONTROL_MASK | GDK_MOD1_MASK)) == 0 && thunar_grid_view_search_key_press (grid_view, event))
+        return TRUE;
+      return (*GTK_WIDGET_CLASS (thunar_grid_view_parent_class)->key_press_event) (widget, event);
+    }
+
+  /* without a cursor, any movement starts at the first item */
+  if (grid_view->cursor < 0)
+    index = 0;
+
+  if (line_move && index >= grid_view->n_items
+      && thunar_grid_view_get_line (grid_view, grid_view->n_items - 1) > thunar_grid_view_get_line (grid_view, cursor))
+    {
+      /* moving into the incomplete last line stops at the last item */
+      index = grid_view->n_items - 1;
+    }
+
+  if (index < 0 || index >= grid_view->n_items)
+    {
+      gtk_widget_error_bell (widget);
+      return TRUE;
+    }
+
+  thunar_grid_view_move_cursor (grid_view, index, modifiers);
+
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_grid_view_focus_in_event (GtkWidget     *widget,
+                                 GdkEventFocus *event)
+{
+  thunar_grid_view_accessible_cursor_changed (THUNAR_GRID_VIEW (widget));
+  gtk_widget_queue_draw (widget);
+  return FALSE;
+}
+
+
+
+static gboolean
+thunar_grid_view_focus_out_event (GtkWidget     *widget,
+                                  GdkEventFocus *event)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (widget);
+
+  thunar_grid_view_stop_rubberband (grid_view);
+  thunar_grid_view_search_hide (grid_view);
+  thunar_grid_view_accessible_cursor_changed (grid_view);
+  gtk_widget_queue_draw (widget);
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_grid_view_style_updated (GtkWidget *widget)
+{
+  (*GTK_WIDGET_CLASS (thunar_grid_view_parent_class)->style_updated) (widget);
+
+  /* fonts and paddings may have changed */
+  thunar_grid_view_invalidate_sizes (THUNAR_GRID_VIEW (widget));
+}
+
+
+
+static void
+thunar_grid_view_direction_changed (GtkWidget       *widget,
+                                    GtkTextDirection previous_direction)
+{
+  (*GTK_WIDGET_CLASS (thunar_grid_view_parent_class)->direction_changed) (widget, previous_direction);
+
+  thunar_grid_view_queue_layout (THUNAR_GRID_VIEW (widget));
+}
+
+
+
+static void
+thunar_grid_view_drag_begin (GtkWidget      *widget,
+                             GdkDragContext *context)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (widget);
+
+  /* the release event goes to the drag, so keep the selection as is */
+  grid_view->pressed = -1;
+  grid_view->press_deferred = FALSE;
+}
+
+
+
+static ThunarGridViewCell *
+thunar_grid_view_find_cell (ThunarGridView  *grid_view,
+                            GtkCellRenderer *renderer)
+{
+  GList *lp;
+
+  for (lp = grid_view->cells; lp != NULL; lp = lp->next)
+    if (((ThunarGridViewCell *) lp->data)->cell == renderer)
+      return lp->data;
+
+  return NULL;
+}
+
+
+
+static void
+thunar_grid_view_cell_free_attributes (ThunarGridViewCell *info)
+{
+  GSList *sp;
+
+  for (sp = info->attributes; sp != NULL && sp->next != NULL; sp = sp->next->next)
+    g_free (sp->data);
+
+  g_slist_free (info->attributes);
+  info->attributes = NULL;
+}
+
+
+
+static void
+thunar_grid_view_cell_layout_pack_start (GtkCellLayout   *layout,
+                                         GtkCellRenderer *renderer,
+                                         gboolean         expand)
+{
+  ThunarGridView     *grid_view = THUNAR_GRID_VIEW (layout);
+  ThunarGridViewCell *info;
+
+  _thunar_return_if_fail (GTK_IS_CELL_RENDERER (renderer));
+  _thunar_return_if_fail (thunar_grid_view_find_cell (grid_view, renderer) == NULL);
+
+  info = g_new0 (ThunarGridViewCell, 1);
+  info->cell = g_object_ref_sink (renderer);
+  grid_view->cells = g_list_append (grid_view->cells, info);
+
+  thunar_grid_view_invalidate_sizes (grid_view);
+}
+
+
+
+static void
+thunar_grid_view_cell_layout_clear (GtkCellLayout *layout)
+{
+  ThunarGridView     *grid_view = THUNAR_GRID_VIEW (layout);
+  ThunarGridViewCell *info;
+  GList              *lp;
+
+  for (lp = grid_view->cells; lp != NULL; lp = lp->next)
+    {
+      info = lp->data;
+
+      thunar_grid_view_cell_free_attributes (info);
+      if (info->destroy != NULL)
+        (*info->destroy) (info->func_data);
+      g_object_unref (info->cell);
+      g_free (info);
+    }
+
+  g_list_free (grid_view->cells);
+  grid_view->cells = NULL;
+
+  thunar_grid_view_invalidate_sizes (grid_view);
+}
+
+
+
+static void
+thunar_grid_view_cell_layout_add_attribute (GtkCellLayout   *layout,
+                                            GtkCellRenderer *renderer,
+                                            const gchar     *attribute,
+                                            gint             column)
+{
+  ThunarGridView     *grid_view = THUNAR_GRID_VIEW (layout);
+  ThunarGridViewCell *info;
+
+  info = thunar_grid_view_find_cell (grid_view, renderer);
+  _thunar_return_if_fail (info != NULL);
+
+  info->attributes = g_slist_prepend (info->attributes, GINT_TO_POINTER (column));
+  info->attributes = g_slist_prepend (info->attributes, g_strdup (attribute));
+
+  thunar_grid_view_invalidate_sizes (grid_view);
+}
+
+
+
+static void
+thunar_grid_view_cell_layout_set_cell_data_func (GtkCellLayout        *layout,
+                                                 GtkCellRenderer      *renderer,
+                                                 GtkCellLayoutDataFunc func,
+                                                 gpointer              func_data,
+                                                 GDestroyNotify        destroy)
+{
+  ThunarGridView     *grid_view = THUNAR_GRID_VIEW (layout);
+  ThunarGridViewCell *info;
+
+  info = thunar_grid_view_find_cell (grid_view, renderer);
+  _thunar_return_if_fail (info != NULL);
+
+  if (info->destroy != NULL)
+    (*info->destroy) (info->func_data);
+
+  info->func = func;
+  info->func_data = func_data;
+  info->destroy = destroy;
+
+  thunar_grid_view_invalidate_sizes (grid_view);
+}
+
+
+
+static void
+thunar_grid_view_cell_layout_clear_attributes (GtkCellLayout   *layout,
+                                               GtkCellRenderer *renderer)
+{
+  ThunarGridView     *grid_view = THUNAR_GRID_VIEW (layout);
+  ThunarGridViewCell *info;
+
+  info = thunar_grid_view_find_cell (grid_view, renderer);
+  if (info != NULL)
+    {
+      thunar_grid_view_cell_free_attributes (info);
+      thunar_grid_view_invalidate_sizes (grid_view);
+    }
+}
+
+
+
+static void
+thunar_grid_view_cell_layout_reorder (GtkCellLayout   *layout,
+                                      GtkCellRenderer *renderer,
+                                      gint             position)
+{
+  ThunarGridView     *grid_view = THUNAR_GRID_VIEW (layout);
+  ThunarGridViewCell *info;
+
+  info = thunar_grid_view_find_cell (grid_view, renderer);
+  _thunar_return_if_fail (info != NULL);
+
+  grid_view->cells = g_list_remove (grid_view->cells, info);
+  grid_view->cells = g_list_insert (grid_view->cells, info, position);
+
+  gtk_widget_queue_draw (GTK_WIDGET (grid_view));
+}
+
+
+
+static GList *
+thunar_grid_view_cell_layout_get_cells (GtkCellLayout *layout)
+{
+  ThunarGridView *grid_view = THUNAR_GRID_VIEW (layout);
+  GList          *cells = NULL;
+  GList          *lp;
+
+  for (lp = grid_view->cells; lp != NULL; lp = lp->next)
+    cells = g_list_prepend (cells, ((ThunarGridViewCell *) lp->data)->cell);
+
+  return g_list_reverse (cells);
+}
+
+
+
+static void
+thunar_grid_view_set_adjustment (ThunarGridView *grid_view,
+                                 GtkOrientation  orientation,
+                                 GtkAdjustment  *adjustment)
+{
+  GtkAdjustment **location;
+
+  location = (orientation == GTK_ORIENTATION_HORIZONTAL) ? &grid_view->hadjustment : &grid_view->vadjustment;
+
+  if (*location == adjustment && adjustment != NULL)
+    return;
+
+  if (*location != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (*location, thunar_grid_view_adjustment_value_changed, grid_view);
+      g_object_unref (*location);
+      *location = NULL;
+    }
+
+  /* GtkScrollable requires an adjustment even if none is given */
+  if (adjustment == NULL)
+    adjustment = gtk_adjustment_new (0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+
+  *location = g_object_ref_sink (adjustment);
+  g_signal_connect (adjustment, "value-changed", G_CALLBACK (thunar_grid_view_adjustment_value_changed), grid_view);
+
+  g_object_notify (G_OBJECT (grid_view), (orientation == GTK_ORIENTATION_HORIZONTAL) ? "hadjustment" : "vadjustment");
+  thunar_grid_view_queue_layout (grid_view);
+}
+
+
+
+static void
+thunar_grid_view_adjustment_value_changed (GtkAdjustment  *adjustment,
+                                           ThunarGridView *grid_view)
+{
+  if (!gtk_widget_get_realized (GTK_WIDGET (grid_view)))
+    return;
+
+  /* newly exposed items may need larger lines */
+  if (!grid_view->in_layout && thunar_grid_view_visible_needs_measure (grid_view))
+    thunar_grid_view_queue_layout (grid_view);
+
+  if (grid_view->rubberbanding)
+    thunar_grid_view_update_rubberband (grid_view);
+
+  gtk_widget_queue_draw (GTK_WIDGET (grid_view));
+}
+
+
+
+static void
+thunar_grid_view_shift_indices (ThunarGridView *grid_view,
+                                gint            index,
+                                gint            delta)
+{
+  gint *indices[] = { &grid_view->cursor, &grid_view->anchor, &grid_view->prelit, &grid_view->pressed, &grid_view->drag_dest };
+  guint n;
+
+  for (n = 0; n < G_N_ELEMENTS (indices); ++n)
+    {
+      if (*indices[n] < 0)
+        continue;
+
+      if (delta > 0 && *indices[n] >= index)
+        *indices[n] += delta;
+      else if (delta < 0 && *indices[n] == index)
+        *indices[n] = -1;
+      else if (delta < 0 && *indices[n] > index)
+        *indices[n] += delta;
+    }
+}
+
+
+
+static void
+thunar_grid_view_row_changed (GtkTreeModel   *model,
+                              GtkTreePath    *path,
+                              GtkTreeIter    *iter,
+                              ThunarGridView *grid_view)
+{
+  GSequenceIter *item;
+  GdkRectangle   area;
+  GdkRectangle   box;
+  gint           index;
+
+  index = thunar_grid_view_index_from_path (grid_view, path);
+  if (index < 0)
+    return;
+
+  /* the old size stays in place until the item is measured again */
+  item = g_sequence_get_iter_at_pos (grid_view->items, index);
+  if (thunar_grid_view_item_get_size (item) > 0)
+    thunar_grid_view_item_set_flags (item, thunar_grid_view_item_get_flags (item) | THUNAR_GRID_VIEW_ITEM_STALE);
+
+  if (!gtk_widget_get_realized (GTK_WIDGET (grid_view)))
+    return;
+
+  /* visible items are measured with the next layout, so a longer name grows its line */
+  thunar_grid_view_get_visible_area (grid_view, &area);
+  thunar_grid_view_get_item_box (grid_view, index, &box);
+  if (gdk_rectangle_intersect (&area, &box, NULL))
+    {
+      thunar_grid_view_queue_layout (grid_view);
+      thunar_grid_view_queue_draw_item (grid_view, index);
+    }
+}
+
+
+
+static void
+thunar_grid_view_row_inserted (GtkTreeModel   *model,
+                               GtkTreePath    *path,
+                               GtkTreeIter    *iter,
+                               ThunarGridView *grid_view)
+{
+  gint index;
+
+  if (gtk_tree_path_get_depth (path) != 1)
+    return;
+
+  index = gtk_tree_path_get_indices (path)[0];
+  _thunar_return_if_fail (index >= 0 && index <= grid_view->n_items);
+
+  g_sequence_insert_before (g_sequence_get_iter_at_pos (grid_view->items, index), GUINT_TO_POINTER (0));
+  grid_view->n_items += 1;
+
+  /* the items after it moved to other lines */
+  grid_view->lines_valid = FALSE;
+
+  /* pending selection changes are reported by index */
+  if (grid_view->selection_delta->len > 0)
+    grid_view->selection_delta_lost = TRUE;
+
+  thunar_grid_view_shift_indices (grid_view, index, 1);
+  thunar_grid_view_accessible_rows_changed (grid_view, index, 1);
+  thunar_grid_view_queue_layout (grid_view);
+}
+
+
+
+static void
+thunar_grid_view_row_deleted (GtkTreeModel   *model,
+                              GtkTreePath    *path,
+                              ThunarGridView *grid_view)
+{
+  GSequenceIter *item;
+  gboolean       changed;
+  gint           index;
+
+  index = thunar_grid_view_index_from_path (grid_view, path);
+  if (index < 0)
+    return;
+
+  item = g_sequence_get_iter_at_pos (grid_view->items, index);
+  changed = thunar_grid_view_item_set_selected (grid_view, item, FALSE);
+  g_hash_table_remove (grid_view->measured, item);
+  g_sequence_remove (item);
+
+  /* the items after it moved to other lines */
+  grid_view->lines_valid = FALSE;
+
+  /* the removed item cannot be resolved by its index anymore */
+  if (changed)
+    grid_view->selection_delta_lost = TRUE;
+
+  grid_view->n_items -= 1;
+
+  thunar_grid_view_shift_indices (grid_view, index, -1);
+  thunar_grid_view_accessible_rows_changed (grid_view, index, -1);
+
+  /* an emptied view starts over with fresh cell sizes */
+  if (grid_view->n_items == 0)
+    thunar_grid_view_invalidate_sizes (grid_view);
+  else
+    thunar_grid_view_queue_layout (grid_view);
+
+  if (changed)
+    thunar_grid_view_selection_changed (grid_view);
+}
+
+
+
+static void
+thunar_grid_view_rows_reordered (GtkTreeModel   *model,
+                                 GtkTreePath    *path,
+                                 GtkTreeIter    *iter,
+                                 gint           *new_order,
+                                 ThunarGridView *grid_view)
+{
+  GSequenceIter *item;
+  guint         *flags;
+  gint          *inverse;
+  gint          *indices[] = { &grid_view->cursor, &grid_view->anchor, &grid_view->prelit, &grid_view->pressed, &grid_view->drag_dest };
+  gint           n;
+
+  if (gtk_tree_path_get_depth (path) != 0 || grid_view->n_items == 0)
+    return;
+
+  flags = g_new (guint, grid_view->n_items);
+  inverse = g_new (gint, grid_view->n_items);
+
+  for (n = 0, item = g_sequence_get_begin_iter (grid_view->items); n < grid_view->n_items; ++n, item = g_sequence_iter_next (item))
+    flags[n] = thunar_grid_view_item_get_flags (item);
+
+  /* new_order[new_position] = old_position, the measured sizes move along */
+  g_hash_table_remove_all (grid_view->measured);
+  for (n = 0, item = g_sequence_get_begin_iter (grid_view->items); n < grid_view->n_items; ++n, item = g_sequence_iter_next (item))
+    {
+      thunar_grid_view_item_set_flags (item, flags[new_order[n]]);
+      inverse[new_order[n]] = n;
+
+      if (thunar_grid_view_item_get_size (item) > 0)
+        g_hash_table_add (grid_view->measured, item);
+    }
+  grid_view->lines_valid = FALSE;
+
+  for (n = 0; n < (gint) G_N_ELEMENTS (indices); ++n)
+    if (*indices[n] >= 0 && *indices[n] < grid_view->n_items)
+      *indices[n] = inverse[*indices[n]];
+
+  thunar_grid_view_accessible_rows_reordered (grid_view, inverse);
+
+  g_free (inverse);
+  g_free (flags);
+
+  if (grid_view->selection_delta->len > 0)
+    grid_view->selection_delta_lost = TRUE;
+
+  thunar_grid_view_queue_layout (grid_view);
+  gtk_widget_queue_draw (GTK_WIDGET (grid_view));
+}
+
+
+
+static void
+thunar_grid_view_scroll_to_index (ThunarGridView *grid_view,
+                                  gint            index,
+                                  gboolean        use_align,
+                                  gfloat          row_align,
+                                  gfloat          col_align)
+{
+  GdkRectangle area;
+  GdkRectangle box;
+  gdouble      x;
+  gdouble      y;
+
+  if (index < 0 || index >= grid_view->n_items)
+    return;
+
+  /* wait for the layout if it is not up to date */
+  if (grid_view->layout_pending || !gtk_widget_get_realized (GTK_WIDGET (grid_view)))
+    {
+      GtkTreePath *path = gtk_tree_path_new_from_indices (index, -1);
+
+      if (grid_view->scroll_to_path != NULL)
+        gtk_tree_row_reference_free (grid_view->scroll_to_path);
+      grid_view->scroll_to_path = gtk_tree_row_reference_new (grid_view->model, path);
+      grid_view->scroll_to_use_align = use_align;
+      grid_view->scroll_to_row_align = row_align;
+      grid_view->scroll_to_col_align = col_align;
+      gtk_tree_path_free (path);
+      return;
+    }
+
+  thunar_grid_view_get_visible_area (grid_view, &area);
+  thunar_grid_view_get_item_box (grid_view, index, &box);
+
+  if (use_align)
+    {
+      x = box.x - col_align * (area.width - box.width);
+      y = box.y - row_align * (area.height - box.height);
+    }
+  else
+    {
+      /* scroll just enough to make the item fully visible */
+      x = area.x;
+      if (box.x < area.x)
+        x = box.x - grid_view->margin;
+      else if (box.x + box.width > area.x + area.width)
+        x = box.x + box.width + grid_view->margin - area.width;
+
+      y = area.y;
+      if (box.y < area.y)
+        y = box.y - grid_view->margin;
+      else if (box.y + box.height > area.y + area.height)
+        y = box.y + box.height + grid_view->margin - area.height;
+    }
+
+  if (grid_view->hadjustment != NULL)
+    gtk_adjustment_set_value (grid_view->hadjustment, x);
+  if (grid_view->vadjustment != NULL)
+    gtk_adjustment_set_value (grid_view->vadjustment, y);
+}
+
+
+
+static void
+thunar_grid_view_accessible_class_init (ThunarGridViewAccessibleClass *klass)
+{
+  GtkAccessibleClass *gtkaccessible_class;
+  AtkObjectClass     *atkobject_class;
+  GObjectClass       *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = thunar_grid_view_accessible_finalize;
+
+  atkobject_class = ATK_OBJECT_CLASS (klass);
+  atkobject_class->initialize = thunar_grid_view_accessible_initialize;
+  atkobject_class->get_n_children = thunar_grid_view_accessible_get_n_children;
+  atkobject_class->ref_child = thunar_grid_view_accessible_ref_child;
+
+  gtkaccessible_class = GTK_ACCESSIBLE_CLASS (klass);
+  gtkaccessible_class->widget_unset = thunar_grid_view_accessible_widget_unset;
+}
+
+
+
+static void
+thunar_grid_view_accessible_init (ThunarGridViewAccessible *accessible)
+{
+  accessible->items = g_hash_table_new_full (NULL, NULL, NULL, g_object_unref);
+  accessible->focus_index = -1;
+}
+
+
+
+static void
+thunar_grid_view_accessible_finalize (GObject *object)
+{
+  ThunarGridViewAccessible *accessible = THUNAR_GRID_VIEW_ACCESSIBLE (object);
+
+  g_hash_table_destroy (accessible->items);
+
+  (*G_OBJECT_CLASS (thunar_grid_view_accessible_parent_class)->finalize) (object);
+}
+
+
+
+static void
+thunar_grid_view_accessible_initialize (AtkObject *object,
+                                        gpointer   data)
+{
+  (*ATK_OBJECT_CLASS (thunar_grid_view_accessible_parent_class)->initialize) (object, data);
+
+  /* the grid view reports its changes through the accessible from now on */
+  THUNAR_GRID_VIEW (data)->accessible = object;
+  atk_object_set_role (object, ATK_ROLE_LAYERED_PANE);
+}
+
+
+
+/* the grid view of @object, or %NULL once the widget is gone */
+static ThunarGridView *
+thunar_grid_view_accessible_get_view (AtkObject *object)
+{
+  GtkWidget *widget;
+
+  widget = gtk_accessible_get_widget (GTK_ACCESSIBLE (object));
+  return (widget != NULL) ? THUNAR_GRID_VIEW (widget) : NULL;
+}
+
+
+
+static gint
+thunar_grid_view_accessible_get_n_children (AtkObject *object)
+{
+  ThunarGridView *grid_view;
+
+  grid_view = thunar_grid_view_accessible_get_view (object);
+  return (grid_view != NULL) ? grid_view->n_items : 0;
+}
+
+
+
+static AtkObject *
+thunar_grid_view_accessible_ref_child (AtkObject *object,
+                                       gint       index)
+{
+  ThunarGridViewItemAccessible *item;
+  ThunarGridViewAccessible     *accessible = THUNAR_GRID_VIEW_ACCESSIBLE (object);
+  ThunarGridView               *grid_view;
+
+  grid_view = thunar_grid_view_accessible_get_view (object);
+  if (grid_view == NULL || index < 0 || index >= grid_view->n_items)
+    return NULL;
+
+  /* the item accessibles are created when they are asked for first */
+  item = g_hash_table_lookup (accessible->items, GINT_TO_POINTER (index));
+  if (item == NULL)
+    {
+      item = g_object_new (THUNAR_TYPE_GRID_VIEW_ITEM_ACCESSIBLE, NULL);
+      item->index = index;
+      item->selected = thunar_grid_view_index_is_selected (grid_view, index);
+      item->focused = (grid_view->cursor == index && gtk_widget_has_focus (GTK_WIDGET (grid_view)));
+      atk_object_set_parent (ATK_OBJECT (item), object);
+      g_hash_table_insert (accessible->items, GINT_TO_POINTER (index), item);
+    }
+
+  return g_object_ref (ATK_OBJECT (item));
+}
+
+
+
+static void
+thunar_grid_view_accessible_item_defunct (ThunarGridViewItemAccessible *item)
+{
+  item->index = -1;
+  atk_object_notify_state_change (ATK_OBJECT (item), ATK_STATE_DEFUNCT, TRUE);
+}
+
+
+
+/* forgets all item accessibles, which also breaks their reference to us */
+static void
+thunar_grid_view_accessible_clear (ThunarGridViewAccessible *accessible)
+{
+  GHashTableIter iter;
+  gpointer       item;
+
+  g_hash_table_iter_init (&iter, accessible->items);
+  while (g_hash_table_iter_next (&iter, NULL, &item))
+    thunar_grid_view_accessible_item_defunct (item);
+
+  g_hash_table_remove_all (accessible->items);
+  accessible->focus_index = -1;
+}
+
+
+
+static void
+thunar_grid_view_accessible_widget_unset (GtkAccessible *accessible)
+{
+  GtkWidget *widget;
+
+  widget = gtk_accessible_get_widget (accessible);
+  if (widget != NULL)
+    THUNAR_GRID_VIEW (widget)->accessible = NULL;
+
+  thunar_grid_view_accessible_clear (THUNAR_GRID_VIEW_ACCESSIBLE (accessible));
+
+  (*GTK_ACCESSIBLE_CLASS (thunar_grid_view_accessible_parent_class)->widget_unset) (accessible);
+}
+
+
+
+/* index of the @nth selected item, or -1 */
+static gint
+thunar_grid_view_accessible_nth_selected (ThunarGridView *grid_view,
+                                          gint            nth)
+{
+  GSequenceIter *item;
+  gint           index;
+
+  if (nth < 0 || nth >= grid_view->n_selected)
+    return -1;
+
+  for (index = 0, item = g_sequence_get_begin_iter (grid_view->items); !g_sequence_iter_is_end (item); ++index, item = g_sequence_iter_next (item))
+    if ((thunar_grid_view_item_get_flags (item) & THUNAR_GRID_VIEW_ITEM_SELECTED) != 0 && nth-- == 0)
+      return index;
+
+  return -1;
+}
+
+
+
+static gboolean
+thunar_grid_view_accessible_add_selection (AtkSelection *selection,
+                                           gint          index)
+{
+  ThunarGridView *grid_view;
+
+  grid_view = thunar_grid_view_accessible_get_view (ATK_OBJECT (selection));
+  if (grid_view == NULL || index < 0 || index >= grid_view->n_items)
+    return FALSE;
+
+  if (thunar_grid_view_select_range (grid_view, index, index))
+    thunar_grid_view_selection_changed (grid_view);
+
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_grid_view_accessible_clear_selection (AtkSelection *selection)
+{
+  ThunarGridView *grid_view;
+
+  grid_view = thunar_grid_view_accessible_get_view (ATK_OBJECT (selection));
+  if (grid_view == NULL)
+    return FALSE;
+
+  thunar_grid_view_unselect_all (grid_view);
+  return TRUE;
+}
+
+
+
+static AtkObject *
+thunar_grid_view_accessible_ref_selection (AtkSelection *selection,
+                                           gint          nth)
+{
+  ThunarGridView *grid_view;
+  gint            index;
+
+  grid_view = thunar_grid_view_accessible_get_view (ATK_OBJECT (selection));
+  if (grid_view == NULL)
+    return NULL;
+
+  index = thunar_grid_view_accessible_nth_selected (grid_view, nth);
+  return (index >= 0) ? thunar_grid_view_accessible_ref_child (ATK_OBJECT (selection), index) : NULL;
+}
+
+
+
+static gint
+thunar_grid_view_accessible_get_selection_count (AtkSelection *selection)
+{
+  ThunarGridView *grid_view;
+
+  grid_view = thunar_grid_view_accessible_get_view (ATK_OBJECT (selection));
+  return (grid_view != NULL) ? grid_view->n_selected : 0;
+}
+
+
+
+static gboolean
+thunar_grid_view_accessible_is_child_selected (AtkSelection *selection,
+                                               gint          index)
+{
+  ThunarGridView *grid_view;
+
+  grid_view = thunar_grid_view_accessible_get_view (ATK_OBJECT (selection));
+  return (grid_view != NULL) && thunar_grid_view_index_is_selected (grid_view, index);
+}
+
+
+
+static gboolean
+thunar_grid_view_accessible_remove_selection (AtkSelection *selection,
+                                              gint          nth)
+{
+  ThunarGridView *grid_view;
+  gint            index;
+
+  grid_view = thunar_grid_view_accessible_get_view (ATK_OBJECT (selection));
+  if (grid_view == NULL)
+    return FALSE;
+
+  index = thunar_grid_view_accessible_nth_selected (grid_view, nth);
+  if (index < 0)
+    return FALSE;
+
+  thunar_grid_view_item_set_selected (grid_view, g_sequence_get_iter_at_pos (grid_view->items, index), FALSE);
+  thunar_grid_view_selection_changed (grid_view);
+
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_grid_view_accessible_select_all_selection (AtkSelection *selection)
+{
+  ThunarGridView *grid_view;
+
+  grid_view = thunar_grid_view_accessible_get_view (ATK_OBJECT (selection));
+  if (grid_view == NULL)
+    return FALSE;
+
+  thunar_grid_view_select_all (grid_view);
+  return TRUE;
+}
+
+
+
+static void
+thunar_grid_view_accessible_selection_init (AtkSelectionIface *iface)
+{
+  iface->add_selection = thunar_grid_view_accessible_add_selection;
+  iface->clear_selection = thunar_grid_view_accessible_clear_selection;
+  iface->ref_selection = thunar_grid_view_accessible_ref_selection;
+  iface->get_selection_count = thunar_grid_view_accessible_get_selection_count;
+  iface->is_child_selected = thunar_grid_view_accessible_is_child_selected;
+  iface->remove_selection = thunar_grid_view_accessible_remove_selection;
+  iface->select_all_selection = thunar_grid_view_accessible_select_all_selection;
+}
+
+
+
+static AtkObject *
+thunar_grid_view_accessible_ref_accessible_at_point (AtkComponent *component,
+                                                     gint          x,
+                                                     gint          y,
+                                                     AtkCoordType  coord_type)
+{
+  ThunarGridView *grid_view;
+  gint            x_view;
+  gint            y_view;
+  gint            index;
+
+  grid_view = thunar_grid_view_accessible_get_view (ATK_OBJECT (component));
+  if (grid_view == NULL)
+    return NULL;
+
+  atk_component_get_extents (component, &x_view, &y_view, NULL, NULL, coord_type);
+  index = thunar_grid_view_get_index_at_pos (grid_view,
+                                             x - x_view + thunar_grid_view_get_x_offset (grid_view),
+                                             y - y_view + thunar_grid_view_get_y_offset (grid_view));
+
+  return (index >= 0) ? thunar_grid_view_accessible_ref_child (ATK_OBJECT (component), index) : NULL;
+}
+
+
+
+static void
+thunar_grid_view_accessible_component_init (AtkComponentIface *iface)
+{
+  /* everything else is inherited from GtkWidgetAccessible */
+  iface->ref_accessible_at_point = thunar_grid_view_accessible_ref_accessible_at_point;
+}
+
+
+
+/* the items at and after @index moved by @delta, which is 1 or -1 */
+static void
+thunar_grid_view_accessible_rows_changed (ThunarGridView *grid_view,
+                                          gint            index,
+                                          gint            delta)
+{
+  ThunarGridViewItemAccessible *item;
+  ThunarGridViewAccessible     *accessible;
+  ThunarGridViewItemAccessible *removed = NULL;
+  GList                        *items;
+  GList                        *lp;
+
+  if (grid_view->accessible == NULL)
+    return;
+
+  accessible = THUNAR_GRID_VIEW_ACCESSIBLE (grid_view->accessible);
+
+  /* the cache is keyed by index, so all items after @index are re-added */
+  items = g_hash_table_get_values (accessible->items);
+  g_hash_table_steal_all (accessible->items);
+  for (lp = items; lp != NULL; lp = lp->next)
+    {
+      item = lp->data;
+      if (delta < 0 && item->index == index)
+        {
+          removed = item;
+          continue;
+        }
+
+      if (item->index >= index)
+        item->index += delta;
+      g_hash_table_insert (accessible->items, GINT_TO_POINTER (item->index), item);
+    }
+  g_list_free (items);
+
+  if (accessible->focus_index >= index)
+    accessible->focus_index = (delta < 0 && accessible->focus_index == index) ? -1 : accessible->focus_index + delta;
+
+  if (delta > 0)
+    {
+      g_signal_emit_by_name (accessible, "children-changed::add", index, NULL, NULL);
+    }
+  else
+    {
+      g_signal_emit_by_name (accessible, "children-changed::remove", index, removed, NULL);
+      if (removed != NULL)
+        {
+          thunar_grid_view_accessible_item_defunct (removed);
+          g_object_unref (removed);
+        }
+    }
+
+  /* a removed cursor item takes the focus with it */
+  thunar_grid_view_accessible_cursor_changed (grid_view);
+}
+
+
+
+/* the item at old index n is now at @inverse[n] */
+static void
+thunar_grid_view_accessible_rows_reordered (ThunarGridView *grid_view,
+                                            const gint     *inverse)
+{
+  ThunarGridViewItemAccessible *item;
+  ThunarGridViewAccessible     *accessible;
+  GList                        *items;
+  GList                        *lp;
+
+  if (grid_view->accessible == NULL)
+    return;
+
+  accessible = THUNAR_GRID_VIEW_ACCESSIBLE (grid_view->accessible);
+
+  items = g_hash_table_get_values (accessible->items);
+  g_hash_table_steal_all (accessible->items);
+  for (lp = items; lp != NULL; lp = lp->next)
+    {
+      item = lp->data;
+      item->index = inverse[item->index];
+      g_hash_table_insert (accessible->items, GINT_TO_POINTER (item->index), item);
+    }
+  g_list_free (items);
+
+  if (accessible->focus_index >= 0)
+    accessible->focus_index = inverse[accessible->focus_index];
+
+  g_signal_emit_by_name (accessible, "visible-data-changed");
+}
+
+
+
+static void
+thunar_grid_view_accessible_model_changed (ThunarGridView *grid_view)
+{
+  if (grid_view->accessible == NULL)
+    return;
+
+  /* none of the old items exist anymore */
+  thunar_grid_view_accessible_clear (THUNAR_GRID_VIEW_ACCESSIBLE (grid_view->accessible));
+  g_signal_emit_by_name (grid_view->accessible, "visible-data-changed");
+}
+
+
+
+static void
+thunar_grid_view_accessible_selection_changed (ThunarGridView *grid_view)
+{
+  ThunarGridViewItemAccessible *item;
+  ThunarGridViewAccessible     *accessible;
+  GHashTableIter                iter;
+  gboolean                      selected;
+
+  if (grid_view->accessible == NULL)
+    return;
+
+  accessible = THUNAR_GRID_VIEW_ACCESSIBLE (grid_view->accessible);
+
+  g_hash_table_iter_init (&iter, accessible->items);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &item))
+    {
+      selected = thunar_grid_view_index_is_selected (grid_view, item->index);
+      if (item->selected != selected)
+        {
+          item->selected = selected;
+          atk_object_notify_state_change (ATK_OBJECT (item), ATK_STATE_SELECTED, selected);
+        }
+    }
+
+  g_signal_emit_by_name (accessible, "selection-changed");
+}
+
+
+
+/* the cursor moved, or the view gained or lost the focus */
+static void
+thunar_grid_view_accessible_cursor_changed (ThunarGridView *grid_view)
+{
+  ThunarGridViewItemAccessible *item;
+  ThunarGridViewAccessible     *accessible;
+  AtkObject                    *child;
+  gboolean                      has_focus;
+  gint                          n;
+  gint                          indices[2];
+
+  if (grid_view->accessible == NULL)
+    return;
+
+  accessible = THUNAR_GRID_VIEW_ACCESSIBLE (grid_view->accessible);
+  has_focus = gtk_widget_has_focus (GTK_WIDGET (grid_view));
+
+  /* only the previous and the new cursor item can change their focus */
+  indices[0] = accessible->focus_index;
+  indices[1] = grid_view->cursor;
+  for (n = 0; n < 2; ++n)
+    {
+      item = g_hash_table_lookup (accessible->items, GINT_TO_POINTER (indices[n]));
+      if (item != NULL && item->focused != (has_focus && item->index == grid_view->cursor))
+        {
+          item->focused = !item->focused;
+          atk_object_notify_state_change (ATK_OBJECT (item), ATK_STATE_FOCUSED, item->focused);
+        }
+    }
+
+  if (accessible->focus_index != grid_view->cursor)
+    {
+      accessible->focus_index = grid_view->cursor;
+      if (grid_view->cursor >= 0)
+        {
+          child = thunar_grid_view_accessible_ref_child (ATK_OBJECT (accessible), grid_view->cursor);
+          g_signal_emit_by_name (accessible, "active-descendant-changed", child);
+          g_object_unref (child);
+        }
+    }
+}
+
+
+
+static void
+thunar_grid_view_item_accessible_class_init (ThunarGridViewItemAccessibleClass *klass)
+{
+  AtkObjectClass *atkobject_class;
+  GObjectClass   *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = thunar_grid_view_item_accessible_finalize;
+
+  atkobject_class = ATK_OBJECT_CLASS (klass);
+  atkobject_class->get_name = thunar_grid_view_item_accessible_get_name;
+  atkobject_class->get_index_in_parent = thunar_grid_view_item_accessible_get_index_in_parent;
+  atkobject_class->ref_state_set = thunar_grid_view_item_accessible_ref_state_set;
+}
+
+
+
+static void
+thunar_grid_view_item_accessible_init (ThunarGridViewItemAccessible *item)
+{
+  item->index = -1;
+  atk_object_set_role (ATK_OBJECT (item), ATK_ROLE_ICON);
+}
+
+
+
+static void
+thunar_grid_view_item_accessible_finalize (GObject *object)
+{
+  ThunarGridViewItemAccessible *item = THUNAR_GRID_VIEW_ITEM_ACCESSIBLE (object);
+
+  g_free (item->name);
+
+  (*G_OBJECT_CLASS (thunar_grid_view_item_accessible_parent_class)->finalize) (object);
+}
+
+
+
+/* the grid view of @item, or %NULL if the item or the view is gone */
+static ThunarGridView *
+thunar_grid_view_item_accessible_get_view (ThunarGridViewItemAccessible *item)
+{
+  ThunarGridView *grid_view;
+  AtkObject      *parent;
+
+  if (item->index < 0)
+    return NULL;
+
+  parent = atk_object_get_parent (ATK_OBJECT (item));
+  if (parent == NULL)
+    return NULL;
+
+  grid_view = thunar_grid_view_accessible_get_view (parent);
+  if (grid_view == NULL || item->index >= grid_view->n_items)
+    return NULL;
+
+  return grid_view;
+}
+
+
+
+static const gchar *
+thunar_grid_view_item_accessible_get_name (AtkObject *object)
+{
+  ThunarGridViewItemAccessible *item = THUNAR_GRID_VIEW_ITEM_ACCESSIBLE (object);
+  ThunarGridView               *grid_view;
+  GtkTreeIter                   iter;
+
+  /* a name set with atk_object_set_name() wins */
+  if (object->name != NULL)
+    return object->name;
+
+  /* the text the interactive search matches is the name of the item */
+  g_clear_pointer (&item->name, g_free);
+  grid_view = thunar_grid_view_item_accessible_get_view (item);
+  if (grid_view != NULL && grid_view->search_column >= 0 && gtk_tree_model_iter_nth_child (grid_view->model, &iter, NULL, item->index))
+    gtk_tree_model_get (grid_view->model, &iter, grid_view->search_column, &item->name, -1);
+
+  return item->name;
+}
+
+
+
+static gint
+thunar_grid_view_item_accessible_get_index_in_parent (AtkObject *object)
+{
+  return THUNAR_GRID_VIEW_ITEM_ACCESSIBLE (object)->index;
+}
+
+
+
+static AtkStateSet *
+thunar_grid_view_item_accessible_ref_state_set (AtkObject *object)
+{
+  ThunarGridViewItemAccessible *item = THUNAR_GRID_VIEW_ITEM_ACCESSIBLE (object);
+  ThunarGridView               *grid_view;
+  AtkStateSet                  *state_set;
+  GdkRectangle                  area;
+  GdkRectangle                  box;
+
+  state_set = atk_state_set_new ();
+
+  grid_view = thunar_grid_view_item_accessible_get_view (item);
+  if (grid_view == NULL)
+    {
+      atk_state_set_add_state (state_set, ATK_STATE_DEFUNCT);
+      return state_set;
+    }
+
+  atk_state_set_add_state (state_set, ATK_STATE_ENABLED);
+  atk_state_set_add_state (state_set, ATK_STATE_SENSITIVE);
+  atk_state_set_add_state (state_set, ATK_STATE_SELECTABLE);
+  atk_state_set_add_state (state_set, ATK_STATE_FOCUSABLE);
+  atk_state_set_add_state (state_set, ATK_STATE_VISIBLE);
+
+  if (thunar_grid_view_index_is_selected (grid_view, item->index))
+    atk_state_set_add_state (state_set, ATK_STATE_SELECTED);
+
+  if (grid_view->cursor == item->index && gtk_widget_has_focus (GTK_WIDGET (grid_view)))
+    atk_state_set_add_state (state_set, ATK_STATE_FOCUSED);
+
+  if (gtk_widget_get_mapped (GTK_WIDGET (grid_view)))
+    {
+      thunar_grid_view_get_visible_area (grid_view, &area);
+      thunar_grid_view_get_item_box (grid_view, item->index, &box);
+      if (gdk_rectangle_intersect (&area, &box, NULL))
+        atk_state_set_add_state (state_set, ATK_STATE_SHOWING);
+    }
+
+  return state_set;
+}
+
+
+
+static void
+thunar_grid_view_item_accessible_get_extents (AtkComponent *component,
+                                              gint         *x,
+                                              gint         *y,
+                                              gint         *width,
+                                              gint         *height,
+                                              AtkCoordType  coord_type)
+{
+  ThunarGridViewItemAccessible *item = THUNAR_GRID_VIEW_ITEM_ACCESSIBLE (component);
+  ThunarGridView               *grid_view;
+  GdkRectangle                  box;
+  gint                          x_view;
+  gint                          y_view;
+
+  grid_view = thunar_grid_view_item_accessible_get_view (item);
+  if (grid_view == NULL)
+    {
+      *x = *y = *width = *height = 0;
+      return;
+    }
+
+  /* the item box is relative to the view */
+  atk_component_get_extents (ATK_COMPONENT (atk_object_get_parent (ATK_OBJECT (item))), &x_view, &y_view, NULL, NULL, coord_type);
+  thunar_grid_view_get_item_box (grid_view, item->index, &box);
+
+  *x = x_view + box.x - thunar_grid_view_get_x_offset (grid_view);
+  *y = y_view + box.y - thunar_grid_view_get_y_offset (grid_view);
+  *width = box.width;
+  *height = box.height;
+}
+
+
+
+static gboolean
+thunar_grid_view_item_accessible_grab_focus (AtkComponent *component)
+{
+  ThunarGridViewItemAccessible *item = THUNAR_GRID_VIEW_ITEM_ACCESSIBLE (component);
+  ThunarGridView               *grid_view;
+
+  grid_view = thunar_grid_view_item_accessible_get_view (item);
+  if (grid_view == NULL)
+    return FALSE;
+
+  gtk_widget_grab_focus (GTK_WIDGET (grid_view));
+
+  thunar_grid_view_queue_draw_item (grid_view, grid_view->cursor);
+  grid_view->cursor = grid_view->anchor = item->index;
+  thunar_grid_view_queue_draw_item (grid_view, grid_view->cursor);
+  thunar_grid_view_accessible_cursor_changed (grid_view);
+
+  thunar_grid_view_scroll_to_index (grid_view, item->index, FALSE, 0.0f, 0.0f);
+
+  return TRUE;
+}
+
+
+
+static void
+thunar_grid_view_item_accessible_component_init (AtkComponentIface *iface)
+{
+  iface->get_extents = thunar_grid_view_item_accessible_get_extents;
+  iface->grab_focus = thunar_grid_view_item_accessible_grab_focus;
+}
+
+
+
+static gint
+thunar_grid_view_item_accessible_get_n_actions (AtkAction *action)
+{
+  return 1;
+}
+
+
+
+static gboolean
+thunar_grid_view_item_accessible_do_action (AtkAction *action,
+                                            gint       n)
+{
+  ThunarGridViewItemAccessible *item = THUNAR_GRID_VIEW_ITEM_ACCESSIBLE (action);
+  ThunarGridView               *grid_view;
+
+  grid_view = thunar_grid_view_item_accessible_get_view (item);
+  if (grid_view == NULL || n != 0)
+    return FALSE;
+
+  thunar_grid_view_item_activated (grid_view, item->index);
+  return TRUE;
+}
+
+
+
+static const gchar *
+thunar_grid_view_item_accessible_get_action_name (AtkAction *action,
+                                                  gint       n)
+{
+  return (n == 0) ? "activate" : NULL;
+}
+
+
+
+static const gchar *
+thunar_grid_view_item_accessible_get_action_description (AtkAction *action,
+                                                         gint       n)
+{
+  return (n == 0) ? _("Activate the item") : NULL;
+}
+
+
+
+static void
+thunar_grid_view_item_accessible_action_init (AtkActionIface *iface)
+{
+  iface->get_n_actions = thunar_grid_view_item_accessible_get_n_actions;
+  iface->do_action = thunar_grid_view_item_accessible_do_action;
+  iface->get_name = thunar_grid_view_item_accessible_get_action_name;
+  iface->get_description = thunar_grid_view_item_accessible_get_action_description;
+}
+
+
+
+/**
+ * thunar_grid_view_new:
+ *
+ * Allocates a new #ThunarGridView instance.
+ *
+ * Return value: the newly allocated #ThunarGridView.
+ **/
+GtkWidget *
+thunar_grid_view_new (void)
+{
+  return g_object_new (THUNAR_TYPE_GRID_VIEW, NULL);
+}
+
+
+
+/**
+ * thunar_grid_view_get_model:
+ * @grid_view : a #ThunarGridView.
+ *
+ * Return value: the #GtkTreeModel displayed by @grid_view, or %NULL.
+ **/
+GtkTreeModel *
+thunar_grid_view_get_model (ThunarGridView *grid_view)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_GRID_VIEW (grid_view), NULL);
+  return grid_view->model;
+}
+
+
+
+/**
+ * thunar_grid_view_set_model:
+ * @grid_view : a #ThunarGridView.
+ * @model     : a #GtkTreeModel or %NULL.
+ *
+ * Displays the toplevel rows of @model in @grid_view.
+ **/
+void
+thunar_grid_view_set_model (ThunarGridView *grid_view,
+                            GtkTreeModel   *model)
+{
+  gint n;
+
+  _thunar_return_if_fail (THUNAR_IS_GRID_VIEW (grid_view));
+  _thunar_return_if_fail (model == NULL || GTK_IS_TREE_MODEL (model));
+
+  if (grid_view->model == model)
+    return;
+
+  if (grid_view->model != NULL)
+    {
+      g_signal_handlers_disconnect_by_data (grid_view->model, grid_view);
+      g_object_unref (grid_view->model);
+    }
+
+  thunar_grid_view_stop_rubberband (grid_view);
+  thunar_grid_view_search_hide (grid_view);
+  g_hash_table_remove_all (grid_view->measured);
+  g_sequence_remove_range (g_sequence_get_begin_iter (grid_view->items), g_sequence_get_end_iter (grid_view->items));
+  grid_view->n_items = 0;
+  grid_view->n_selected = 0;
+  g_array_set_size (grid_view->selection_delta, 0);
+  grid_view->selection_delta_lost = TRUE;
+  grid_view->cursor = grid_view->anchor = grid_view->prelit = grid_view->pressed = grid_view->drag_dest = -1;
+
+  if (grid_view->scroll_to_path != NULL)
+    {
+      gtk_tree_row_reference_free (grid_view->scroll_to_path);
+      grid_view->scroll_to_path = NULL;
+    }
+
+  grid_view->model = model;
+
+  if (model != NULL)
+    {
+      g_object_ref (model);
+      g_signal_connect (model, "row-changed", G_CALLBACK (thunar_grid_view_row_changed), grid_view);
+      g_signal_connect (model, "row-inserted", G_CALLBACK (thunar_grid_view_row_inserted), grid_view);
+      g_signal_connect (model, "row-deleted", G_CALLBACK (thunar_grid_view_row_deleted), grid_view);
+      g_signal_connect (model, "rows-reordered", G_CALLBACK (thunar_grid_view_rows_reordered), grid_view);
+
+      grid_view->n_items = gtk_tree_model_iter_n_children (model, NULL);
+      for (n = 0; n < grid_view->n_items; ++n)
+        g_sequence_append (grid_view->items, GUINT_TO_POINTER (0));
+    }
+
+  thunar_grid_view_accessible_model_changed (grid_view);
+  thunar_grid_view_invalidate_sizes (grid_view);
+  g_object_notify (G_OBJECT (grid_view), "model");
+}
+
+
+
+/**
+ * thunar_grid_view_get_orientation:
+ * @grid_view : a #ThunarGridView.
+ *
+ * Return value: %GTK_ORIENTATION_VERTICAL if the text is placed below the
+ *               icons, %GTK_ORIENTATION_HORIZONTAL if it is beside them.
+ **/
+GtkOrientation
+thunar_grid_view_get_orientation (ThunarGridView *grid_view)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_GRID_VIEW (grid_view), GTK_ORIENTATION_VERTICAL);
+  return grid_view->orientation;
+}
+
+
+
+/**
+ * thunar_grid_view_set_orientation:
+ * @grid_view   : a #ThunarGridView.
+ * @orientation : the new orientation.
+ *
+ * Sets whether the cells of an item are stacked vertically
+ * or placed beside each other.
+ **/
+void
+thunar_grid_view_set_orientation (ThunarGridView *grid_view,
+                                  GtkOrientation  orientation)
+{
+  _thunar_return_if_fail (THUNAR_IS_GRID_VIEW (grid_view));
+
+  if (grid_view->orientation != orientation)
+    {
+      grid_view->orientation = orientation;
+      thunar_grid_view_invalidate_sizes (grid_view);
+    }
+}
+
+
+
+/**
+ * thunar_grid_view_set_layout_mode:
+ * @grid_view   : a #ThunarGridView.
+ * @layout_mode : the new #ThunarGridViewLayoutMode.
+ *
+ * Sets whether @grid_view fills rows or columns first.
+ **/
+void
+thunar_grid_view_set_layout_mode (ThunarGridView          *grid_view,
+                                  ThunarGridViewLayoutMode layout_mode)
+{
+  _thunar_return_if_fail (THUNAR_IS_GRID_VIEW (grid_view));
+
+  if (grid_view->layout_mode != layout_mode)
+    {
+      grid_view->layout_mode = layout_mode;
+
+      /* the items are measured in the other direction now */
+      thunar_grid_view_invalidate_sizes (grid_view);
+    }
+}
+
+
+
+/**
+ * thunar_grid_view_get_item_width:
+ * @grid_view : a #ThunarGridView.
+ *
+ * Return value: the fixed item width, or -1 if the width is measured.
+ **/
+gint
+thunar_grid_view_get_item_width (ThunarGridView *grid_view)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_GRID_VIEW (grid_view), -1);
+  return grid_view->item_width;
+}
+
+
+
+/**
+ * thunar_grid_view_set_item_width:
+ * @grid_view  : a #ThunarGridView.
+ * @item_width : the fixed width of all items, or -1.
+ *
+ * Sets a fixed width for the items. With -1 the width
+ * is derived from the measured cells.
+ **/
+void
+thunar_grid_view_set_item_width (ThunarGridView *grid_view,
+                                 gint            item_width)
+{
+  _thunar_return_if_fail (THUNAR_IS_GRID_VIEW (grid_view));
+
+  if (grid_view->item_width != item_width)
+    {
+      grid_view->item_width = item_width;
+      thunar_grid_view_invalidate_sizes (grid_view);
+    }
+}
+
+
+
+/**
+ * thunar_grid_view_set_margin:
+ * @grid_view : a #ThunarGridView.
+ * @margin    : the space around the grid in pixels.
+ **/
+void
+thunar_grid_view_set_margin (ThunarGridView *grid_view,
+                             gint            margin)
+{
+  _thunar_return_if_fail (THUNAR_IS_GRID_VIEW (grid_view));
+  _thunar_return_if_fail (margin >= 0);
+
+  if (grid_view->margin != margin)
+    {
+      grid_view->margin = margin;
+      thunar_grid_view_queue_layout (grid_view);
+    }
+}
+
+
+
+/**
+ * thunar_grid_view_get_column_spacing:
+ * @grid_view : a #ThunarGridView.
+ *
+ * Return value: the space between columns in pixels.
+ **/
+gint
+thunar_grid_view_get_column_spacing (ThunarGridView *grid_view)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_GRID_VIEW (grid_view), 0);
+  return grid_view->column_spacing;
+}
+
+
+
+/**
+ * thunar_grid_view_set_column_spacing:
+ * @grid_view      : a #ThunarGridView.
+ * @column_spacing : the space between columns in pixels.
+ **/
+void
+thunar_grid_view_set_column_spacing (ThunarGridView *grid_view,
+                                     gint            column_spacing)
+{
+  _thunar_return_if_fail (THUNAR_IS_GRID_VIEW (grid_view));
+  _thunar_return_if_fail (column_spacing >= 0);
+
+  if (grid_view->column_spacing != column_spacing)
+    {
+      grid_view->column_spacing = column_spacing;
+      thunar_grid_view_queue_layout (grid_view);
+    }
+}
+
+
+
+/**
+ * thunar_grid_view_set_row_spacing:
+ * @grid_view   : a #ThunarGridView.
+ * @row_spacing : the space between rows in pixels.
+ **/
+void
+thunar_grid_view_set_row_spacing (ThunarGridView *grid_view,
+                                  gint            row_spacing)
+{
+  _thunar_return_if_fail (THUNAR_IS_GRID_VIEW (grid_view));
+  _thunar_return_if_fail (row_spacing >= 0);
+
+  if (grid_view->row_spacing != row_spacing)
+    {
+      grid_view->row_spacing = row_spacing;
+      thunar_grid_view_queue_layout (grid_view);
+    }
+}
+
+
+
+/**
+ * thunar_grid_view_set_search_column:
+ * @grid_view     : a #ThunarGridView.
+ * @search_column : a string column of the model, or -1.
+ *
+ * Sets the column which is matched by the interactive search, that
+ * pops up when text is typed into the view. A value of -1 disables
+ * the interactive search.
+ **/
+void
+thunar_grid_view_set_search_column (ThunarGridView *grid_view,
+                                    gint            search_column)
+{
+  _thunar_return_if_fail (THUNAR_IS_GRID_VIEW (grid_view));
+  grid_view->search_column = search_column;
+}
+
+
+
+/**
+ * thunar_grid_view_get_selected_items:
+ * @grid_view : a #ThunarGridView.
+ *
+ * The caller is responsible to free the returned list using
+ * g_list_free_full (list, (GDestroyNotify) gtk_tree_path_free).
+ *
+ * Return value: the #GtkTreePath's of the selected items, in model order.
+ **/
+GList *
+thunar_grid_view_get_selected_items (ThunarGridView *grid_view)
+{
+  GSequenceIter *item;
+  GList         *paths = NULL;
+  gint           n_found = 0;
+  gint           n;
+
+  _thunar_return_val_if_fail (THUNAR_IS_GRID_VIEW (grid_view), NULL);
+
+  for (n = 0, item = g_sequence_get_begin_iter (grid_view->items);
+       n_found < grid_view->n_selected && !g_sequence_iter_is_end (item);
+       ++n, item = g_sequence_iter_next (item))
+    {
+      if ((thunar_grid_view_item_get_flags (item) & THUNAR_GRID_VIEW_ITEM_SELECTED) != 0)
+        {
+          paths = g_list_prepend (paths, gtk_tree_path_new_from_indices (n, -1));
+          n_found += 1;
+        }
+    }
+
+  return g_list_reverse (paths);
+}
+
+
+
+/**
+ * thunar_grid_view_get_selection_delta:
+ * @grid_view        : a #ThunarGridView.
+ * @selected_paths   : return location for the #GtkTreePath's of the selected items.
+ * @unselected_paths : return location for the #GtkTreePath's of the unselected items.
+ *
+ * Determines which items were selected and unselected by the change
+ * which is reported by the ThunarGridView::selection-changed signal,
+ * so handlers do not need to look at the whole selection. Must only be
+ * called from handlers of that signal. The paths are in model order. An
+ * item may be reported although its state did not change in the end.
+ *
+ * The caller is responsible to free the returned lists using
+ * g_list_free_full (list, (GDestroyNotify) gtk_tree_path_free).
+ *
+ * Return value: %FALSE if the change cannot be described this way,
+ *               for example because selected rows were deleted, in
+ *               which case thunar_grid_view_get_selected_items() has
+ *               to be used.
+ **/
+gboolean
+thunar_grid_view_get_selection_delta (ThunarGridView *grid_view,
+                                      GList         **selected_paths,
+                                      GList         **unselected_paths)
+{
+  GtkTreePath *path;
+  gint        *indices;
+  guint        n;
+
+  _thunar_return_val_if_fail (THUNAR_IS_GRID_VIEW (grid_view), FALSE);
+  _thunar_return_val_if_fail (selected_paths != NULL, FALSE);
+  _thunar_return_val_if_fail (unselected_paths != NULL, FALSE);
+
+  *selected_paths = NULL;
+  *unselected_paths = NULL;
+
+  if (grid_view->selection_delta_lost)
+    return FALSE;
+
+  /* items which were toggled more than once are reported once, with their current state */
+  g_array_sort (grid_view->selection_delta, thunar_grid_view_compare_indices);
+  indices = (gint *) grid_view->selection_delta->data;
+  for (n = grid_view->selection_delta->len; n-- > 0;)
+    {
+      if (n > 0 && indices[n - 1] == indices[n])
+        continue;
+
+      path = gtk_tree_path_new_from_indices (indices[n], -1);
+      if (thunar_grid_view_index_is_selected (grid_view, indices[n]))
+        *selected_paths = g_list_prepend (*selected_paths, path);
+      else
+        *unselected_paths = g_list_prepend (*unselected_paths, path);
+    }
+
+  return TRUE;
+}
+
+
+
+/**
+ * thunar_grid_view_select_all:
+ * @grid_view : a #ThunarGridView.
+ **/
+void
+thunar_grid_view_select_all (ThunarGridView *grid_view)
+{
+  GSequenceIter *item;
+  gboolean       changed = FALSE;
+
+  _thunar_return_if_fail (THUNAR_IS_GRID_VIEW (grid_view));
+
+  if (grid_view->n_selected == grid_view->n_items)
+    return;
+
+  for (item = g_sequence_get_begin_iter (grid_view->items); !g_sequence_iter_is_end (item); item = g_sequence_iter_next (item))
+    changed |= thunar_grid_view_item_set_selected (grid_view, item, TRUE);
+
+  if (changed)
+    thunar_grid_view_selection_changed (grid_view);
+}
+
+
+
+/**
+ * thunar_grid_view_unselect_all:
+ * @grid_view : a #ThunarGridView.
+ **/
+void
+thunar_grid_view_unselect_all (ThunarGridView *grid_view)
+{
+  _thunar_return_if_fail (THUNAR_IS_GRID_VIEW (grid_view));
+
+  if (thunar_grid_view_unselect_all_internal (grid_view))
+    thunar_grid_view_selection_changed (grid_view);
+}
+
+
+
+/**
+ * thunar_grid_view_selection_invert:
+ * @grid_view : a #ThunarGridView.
+ *
+ * Selects all unselected items and unselects all selected ones.
+ **/
+void
+thunar_grid_view_selection_invert (ThunarGridView *grid_view)
+{
+  GSequenceIter *item;
+
+  _thunar_return_if_fail (THUNAR_IS_GRID_VIEW (grid_view));
+
+  if (grid_view->n_items == 0)
+    return;
+
+  for (item = g_sequence_get_begin_iter (grid_view->items); !g_sequence_iter_is_end (item); item = g_sequence_iter_next (item))
+    thunar_grid_view_item_set_selected (grid_view, item, (thunar_grid_view_item_get_flags (item) & THUNAR_GRID_VIEW_ITEM_SELECTED) == 0);
+
+  thunar_grid_view_selection_changed (grid_view);
+}
+
+
+
+/**
+ * thunar_grid_view_select_path:
+ * @grid_view : a #ThunarGridView.
+ * @path      : the #GtkTreePath of the item to select.
+ **/
+void
+thunar_grid_view_select_path (ThunarGridView *grid_view,
+                              GtkTreePath    *path)
+{
+  gint index;
+
+  _thunar_return_if_fail (THUNAR_IS_GRID_VIEW (grid_view));
+
+  index = thunar_grid_view_index_from_path (grid_view, path);
+  if (index >= 0 && thunar_grid_view_select_range (grid_view, index, index))
+    thunar_grid_view_selection_changed (grid_view);
+}
+
+
+
+/**
+ * thunar_grid_view_path_is_selected:
+ * @grid_view : a #ThunarGridView.
+ * @path      : a #GtkTreePath.
+ *
+ * Return value: %TRUE if the item at @path is selected.
+ **/
+gboolean
+thunar_grid_view_path_is_selected (ThunarGridView *grid_view,
+                                   GtkTreePath    *path)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_GRID_VIEW (grid_view), FALSE);
+  return thunar_grid_view_index_is_selected (grid_view, thunar_grid_view_index_from_path (grid_view, path));
+}
+
+
+
+/**
+ * thunar_grid_view_get_cursor:
+ * @grid_view : a #ThunarGridView.
+ *
+ * The caller is responsible to free the returned path.
+ *
+ * Return value: the #GtkTreePath of the cursor item, or %NULL.
+ **/
+GtkTreePath *
+thunar_grid_view_get_cursor (ThunarGridView *grid_view)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_GRID_VIEW (grid_view), NULL);
+
+  if (grid_view->cursor < 0)
+    return NULL;
+
+  return gtk_tree_path_new_from_indices (grid_view->cursor, -1);
+}
+
+
+
+/**
+ * thunar_grid_view_set_cursor:
+ * @grid_view : a #ThunarGridView.
+ * @path      : the #GtkTreePath of the new cursor item.
+ *
+ * Moves the keyboard cursor to @path and scrolls to it,
+ * without changing the selection.
+ **/
+void
+thunar_grid_view_set_cursor (ThunarGridView *grid_view,
+                             GtkTreePath    *path)
+{
+  gint index;
+
+  _thunar_return_if_fail (THUNAR_IS_GRID_VIEW (grid_view));
+
+  index = thunar_grid_view_index_from_path (grid_view, path);
+  if (index < 0)
+    return;
+
+  thunar_grid_view_queue_draw_item (grid_view, grid_view->cursor);
+  grid_view->cursor = grid_view->anchor = index;
+  thunar_grid_view_queue_draw_item (grid_view, grid_view->cursor);
+  thunar_grid_view_accessible_cursor_changed (grid_view);
+
+  thunar_grid_view_scroll_to_index (grid_view, index, FALSE, 0.0f, 0.0f);
+}
+
+
+
+/**
+ * thunar_grid_view_scroll_to_path:
+ * @grid_view : a #ThunarGridView.
+ * @path      : the #GtkTreePath of the item to scroll to.
+ * @use_align : whether to use the alignment arguments.
+ * @row_align : the vertical alignment of the item.
+ * @col_align : the horizontal alignment of the item.
+ *
+ * Scrolls @grid_view so the item at @path becomes visible. If the
+ * layout is not up to date, scrolling is delayed until it is.
+ **/
+void
+thunar_grid_view_scroll_to_path (ThunarGridView *grid_view,
+                                 GtkTreePath    *path,
+                                 gboolean        use_align,
+                                 gfloat          row_align,
+                                 gfloat          col_align)
+{
+  _thunar_return_if_fail (THUNAR_IS_GRID_VIEW (grid_view));
+
+  thunar_grid_view_scroll_to_index (grid_view, thunar_grid_view_index_from_path (grid_view, path),
+                                    use_align, row_align, col_align);
+}
+
+
+
+/**
+ * thunar_grid_view_get_path_at_pos:
+ * @grid_view : a #ThunarGridView.
+ * @x         : the x position in widget coordinates.
+ * @y         : the y position in widget coordinates.
+ *
+ * The caller is responsible to free the returned path.
+ *
+ * Return value: the #GtkTreePath of the item at (@x, @y), or %NULL.
+ **/
+GtkTreePath *
+thunar_grid_view_get_path_at_pos (ThunarGridView *grid_view,
+                                  gint            x,
+                                  gint            y)
+{
+  gint index;
+
+  _thunar_return_val_if_fail (THUNAR_IS_GRID_VIEW (grid_view), NULL);
+
+  index = thunar_grid_view_get_index_at_pos (grid_view,
+                                             x + thunar_grid_view_get_x_offset (grid_view),
+                                             y + thunar_grid_view_get_y_offset (grid_view));
+  if (index < 0)
+    return NULL;
+
+  return gtk_tree_path_new_from_indices (index, -1);
+}
+
+
+
+/**
+ * thunar_grid_view_get_visible_range:
+ * @grid_view  : a #ThunarGridView.
+ * @start_path : return location for the first visible path, or %NULL.
+ * @end_path   : return location for the last visible path, or %NULL.
+ *
+ * The caller is responsible to free the returned paths.
+ *
+ * Return value: %TRUE if any item is visible.
+ **/
+gboolean
+thunar_grid_view_get_visible_range (ThunarGridView *grid_view,
+                                    GtkTreePath   **start_path,
+                                    GtkTreePath   **end_path)
+{
+  GdkRectangle area;
+  gint         first;
+  gint         last;
+
+  _thunar_return_val_if_fail (THUNAR_IS_GRID_VIEW (grid_view), FALSE);
+
+  thunar_grid_view_get_visible_area (grid_view, &area);
+  if (!thunar_grid_view_get_range_for_area (grid_view, &area, &first, &last))
+    return FALSE;
+
+  if (start_path != NULL)
+    *start_path = gtk_tree_path_new_from_indices (first, -1);
+  if (end_path != NULL)
+    *end_path = gtk_tree_path_new_from_indices (last, -1);
+
+  return TRUE;
+}
+
+
+
+/**
+ * thunar_grid_view_get_item_area:
+ * @grid_view : a #ThunarGridView.
+ * @path      : a #GtkTreePath.
+ * @area      : return location for the item area, in widget coordinates.
+ *
+ * Return value: %TRUE if @path refers to an item of @grid_view.
+ **/
+gboolean
+thunar_grid_view_get_item_area (ThunarGridView *grid_view,
+                                GtkTreePath    *path,
+                                GdkRectangle   *area)
+{
+  gint index;
+
+  _thunar_return_val_if_fail (THUNAR_IS_GRID_VIEW (grid_view), FALSE);
+  _thunar_return_val_if_fail (area != NULL, FALSE);
+
+  index = thunar_grid_view_index_from_path (grid_view, path);
+  if (index < 0)
+    return FALSE;
+
+  thunar_grid_view_get_item_box (grid_view, index, area);
+  area->x -= thunar_grid_view_get_x_offset (grid_view);
+  area->y -= thunar_grid_view_get_y_offset (grid_view);
+
+  return TRUE;
+}
+
+
+
+/**
+ * thunar_grid_view_set_drag_dest_item:
+ * @grid_view : a #ThunarGridView.
+ * @path      : the #GtkTreePath of the drop target, or %NULL.
+ *
+ * Highlights the item at @path as the target of a drop.
+ **/
+void
+thunar_grid_view_set_drag_dest_item (ThunarGridView *grid_view,
+                                     GtkTreePath    *path)
+{
+  gint index;
+
+  _thunar_return_if_fail (THUNAR_IS_GRID_VIEW (grid_view));
+
+  index = thunar_grid_view_index_from_path (grid_view, path);
+  if (index != grid_view->drag_dest)
+    {
+      thunar_grid_view_queue_draw_item (grid_view, grid_view->drag_dest);
+      grid_view->drag_dest = index;
+      thunar_grid_view_queue_draw_item (grid_view, grid_view->drag_dest);
+    }
+}
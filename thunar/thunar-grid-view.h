@@ -0,0 +1,146 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar Development Team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __THUNAR_GRID_VIEW_H__
+#define __THUNAR_GRID_VIEW_H__
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS;
+
+typedef struct _ThunarGridViewClass ThunarGridViewClass;
+typedef struct _ThunarGridView      ThunarGridView;
+
+#define THUNAR_TYPE_GRID_VIEW (thunar_grid_view_get_type ())
+#define THUNAR_GRID_VIEW(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), THUNAR_TYPE_GRID_VIEW, ThunarGridView))
+#define THUNAR_GRID_VIEW_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST ((klass), THUNAR_TYPE_GRID_VIEW, ThunarGridViewClass))
+#define THUNAR_IS_GRID_VIEW(obj) (G_TYPE_CHECK_INSTANCE_TYPE ((obj), THUNAR_TYPE_GRID_VIEW))
+#define THUNAR_IS_GRID_VIEW_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), THUNAR_TYPE_GRID_VIEW))
+#define THUNAR_GRID_VIEW_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj), THUNAR_TYPE_GRID_VIEW, ThunarGridViewClass))
+
+/**
+ * ThunarGridViewLayoutMode:
+ * @THUNAR_GRID_VIEW_LAYOUT_ROWS : items are placed left to right and the view scrolls vertically.
+ * @THUNAR_GRID_VIEW_LAYOUT_COLS : items are placed top to bottom and the view scrolls horizontally.
+ *
+ * Determines the direction in which the #ThunarGridView fills its grid.
+ **/
+typedef enum
+{
+  THUNAR_GRID_VIEW_LAYOUT_ROWS,
+  THUNAR_GRID_VIEW_LAYOUT_COLS,
+} ThunarGridViewLayoutMode;
+
+GType
+thunar_grid_view_get_type (void);
+
+GtkWidget *
+thunar_grid_view_new (void) G_GNUC_MALLOC;
+
+GtkTreeModel *
+thunar_grid_view_get_model (ThunarGridView *grid_view);
+void
+thunar_grid_view_set_model (ThunarGridView *grid_view,
+                            GtkTreeModel   *model);
+
+GtkOrientation
+thunar_grid_view_get_orientation (ThunarGridView *grid_view);
+void
+thunar_grid_view_set_orientation (ThunarGridView *grid_view,
+                                  GtkOrientation  orientation);
+
+void
+thunar_grid_view_set_layout_mode (ThunarGridView          *grid_view,
+                                  ThunarGridViewLayoutMode layout_mode);
+
+gint
+thunar_grid_view_get_item_width (ThunarGridView *grid_view);
+void
+thunar_grid_view_set_item_width (ThunarGridView *grid_view,
+                                 gint            item_width);
+
+void
+thunar_grid_view_set_margin (ThunarGridView *grid_view,
+                             gint            margin);
+
+gint
+thunar_grid_view_get_column_spacing (ThunarGridView *grid_view);
+void
+thunar_grid_view_set_column_spacing (ThunarGridView *grid_view,
+                                     gint            column_spacing);
+void
+thunar_grid_view_set_row_spacing (ThunarGridView *grid_view,
+                                  gint            row_spacing);
+
+void
+thunar_grid_view_set_search_column (ThunarGridView *grid_view,
+                                    gint            search_column);
+
+GList *
+thunar_grid_view_get_selected_items (ThunarGridView *grid_view);
+gboolean
+thunar_grid_view_get_selection_delta (ThunarGridView *grid_view,
+                                      GList         **selected_paths,
+                                      GList         **unselected_paths);
+void
+thunar_grid_view_select_all (ThunarGridView *grid_view);
+void
+thunar_grid_view_unselect_all (ThunarGridView *grid_view);
+void
+thunar_grid_view_selection_invert (ThunarGridView *grid_view);
+void
+thunar_grid_view_select_path (ThunarGridView *grid_view,
+                              GtkTreePath    *path);
+gboolean
+thunar_grid_view_path_is_selected (ThunarGridView *grid_view,
+                                   GtkTreePath    *path);
+
+GtkTreePath *
+thunar_grid_view_get_cursor (ThunarGridView *grid_view);
+void
+thunar_grid_view_set_cursor (ThunarGridView *grid_view,
+                             GtkTreePath    *path);
+
+void
+thunar_grid_view_scroll_to_path (ThunarGridView *grid_view,
+                                 GtkTreePath    *path,
+                                 gboolean        use_align,
+                                 gfloat          row_align,
+                                 gfloat          col_align);
+
+GtkTreePath *
+thunar_grid_view_get_path_at_pos (ThunarGridView *grid_view,
+                                  gint            x,
+                                  gint            y);
+gboolean
+thunar_grid_view_get_visible_range (ThunarGridView *grid_view,
+                                    GtkTreePath   **start_path,
+                                    GtkTreePath   **end_path);
+gboolean
+thunar_grid_view_get_item_area (ThunarGridView *grid_view,
+                                GtkTreePath    *path,
+                                GdkRectangle   *area);
+
+void
+thunar_grid_view_set_drag_dest_item (ThunarGridView *grid_view,
+                                     GtkTreePath    *path);
+
+G_END_DECLS;
+
+#endif /* !__THUNAR_GRID_VIEW_H__ */
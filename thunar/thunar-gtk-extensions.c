@@ -21,6 +21,7 @@
 #include <stdarg.h>
 #endif
 
+#include "thunar/thunar-grid-view.h"
 #include "thunar/thunar-gtk-extensions.h"
 #include "thunar/thunar-private.h"
 #include "thunar/thunar-util.h"
@@ -385,24 +386,19 @@ thunar_gtk_menu_popup_at_focus (GtkMenu  *menu,
     }
 
   /* position menu in files inside icon view */
-  if (XFCE_IS_ICON_VIEW (focus_widget))
+  if (THUNAR_IS_GRID_VIEW (focus_widget))
     {
-      GList *selected_files = xfce_icon_view_get_selected_items (XFCE_ICON_VIEW (focus_widget));
+      GList *selected_files = thunar_grid_view_get_selected_items (THUNAR_GRID_VIEW (focus_widget));
       if (selected_files != NULL)
         {
           GdkRectangle rect;
           GdkWindow   *widget_window;
           GtkTreePath *path = (GtkTreePath *) g_list_last (selected_files)->data;
 
-          xfce_icon_view_get_cell_area (XFCE_ICON_VIEW (focus_widget), path, NULL, &rect);
+          /* the item area is already in widget coordinates */
+          thunar_grid_view_get_item_area (THUNAR_GRID_VIEW (focus_widget), path, &rect);
           g_list_free_full (selected_files, (GDestroyNotify) gtk_tree_path_free);
 
-          /* convert rect coordinates to widget_window coordinates */
-          GtkAdjustment *h_adjustment = gtk_scrollable_get_hadjustment (GTK_SCROLLABLE (focus_widget));
-          GtkAdjustment *v_adjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (focus_widget));
-          rect.x -= (int) gtk_adjustment_get_value (h_adjustment);
-          rect.y -= (int) gtk_adjustment_get_value (v_adjustment);
-
           widget_window = gtk_widget_get_window (focus_widget);
           if (thunar_gtk_popup_menu_at_rect (menu, rect, widget_window))
             return TRUE;
@@ -26,10 +26,12 @@
 #include <string.h>
 #endif
 
+#include "thunar/thunar-gdk-extensions.h"
 #include "thunar/thunar-gobject-extensions.h"
 #include "thunar/thunar-icon-factory.h"
 #include "thunar/thunar-preferences.h"
 #include "thunar/thunar-private.h"
+#include "thunar/thunar-trace.h"
 #include "thunar/thunar-util.h"
 
 #include <libxfce4ui/libxfce4ui.h>
@@ -54,7 +56,8 @@ enum
 
 
 
-typedef struct _ThunarIconKey ThunarIconKey;
+typedef struct _ThunarIconKey    ThunarIconKey;
+typedef struct _ThunarSurfaceKey ThunarSurfaceKey;
 
 
 
@@ -106,6 +109,13 @@ thunar_icon_factory_load_fallback (ThunarIconFactory *factory,
                                    gint               size,
                                    gint               scale_factor,
                                    gboolean           symbolic);
+static guint
+thunar_surface_key_hash (gconstpointer data);
+static gboolean
+thunar_surface_key_equal (gconstpointer a,
+                          gconstpointer b);
+static void
+thunar_surface_key_free (gpointer data);
 
 
 
@@ -150,6 +160,21 @@ struct _ThunarIconKey
   guint    color_hash;
 };
 
+/* the composited surfaces of a file icon pixbuf only differ in these */
+struct _ThunarSurfaceKey
+{
+  gint   cell_width;
+  gint   cell_height;
+  gint   scale_factor;
+  gchar *emblems; /* newline separated emblem names, or NULL */
+};
+
+typedef struct
+{
+  cairo_surface_t *surface;
+  GdkRectangle     area; /* logical area of the surface within the cell */
+} ThunarIconSurface;
+
 typedef struct
 {
   ThunarFileIconState  icon_state;
@@ -161,10 +186,30 @@ typedef struct
   GdkPixbuf           *icon;
 } ThunarIconStore;
 
+/* the composited surface a file was drawn with last, so the next draw with
+ * the same parameters needs neither the icon nor the emblem lookup */
+typedef struct
+{
+  ThunarFileIconState  icon_state;
+  ThunarFileThumbState thumb_state;
+  gint                 icon_size;
+  gint                 scale_factor;
+  gint                 cell_width;
+  gint                 cell_height;
+  guint                stamp;
+  gboolean             thumbnail_draw_frames;
+  gboolean             symbolic;
+  gboolean             emblems;
+  cairo_surface_t     *surface;
+  GdkRectangle         area;
+} ThunarSurfaceStore;
+
 
 
 static GQuark thunar_icon_factory_quark = 0;
 static GQuark thunar_icon_factory_store_quark = 0;
+static GQuark thunar_icon_factory_surfaces_quark = 0;
+static GQuark thunar_icon_factory_surface_store_quark = 0;
 
 
 
@@ -178,6 +223,8 @@ thunar_icon_factory_class_init (ThunarIconFactoryClass *klass)
   GObjectClass *gobject_class;
 
   thunar_icon_factory_store_quark = g_quark_from_static_string ("thunar-icon-factory-store");
+  thunar_icon_factory_surfaces_quark = g_quark_from_static_string ("thunar-icon-factory-surfaces");
+  thunar_icon_factory_surface_store_quark = g_quark_from_static_string ("thunar-icon-factory-surface-store");
 
   gobject_class = G_OBJECT_CLASS (klass);
   gobject_class->dispose = thunar_icon_factory_dispose;
@@ -534,9 +581,12 @@ thunar_icon_factory_load_from_file (ThunarIconFactory *factory,
   gint       width;
   gint       height;
   gint       scaled_size = size * scale_factor;
+  gint64     trace_time;
 
   _thunar_return_val_if_fail (THUNAR_IS_ICON_FACTORY (factory), NULL);
 
+  trace_time = thunar_trace_begin ();
+
   /* try to load the image from the file */
   pixbuf = gdk_pixbuf_new_from_file (path, NULL);
   if (G_LIKELY (pixbuf != NULL))
@@ -585,6 +635,8 @@ thunar_icon_factory_load_from_file (ThunarIconFactory *factory,
         }
     }
 
+  thunar_trace_end_detail (trace_time, "icon", "thunar_icon_factory_load_from_file", "%s", path);
+
   return pixbuf;
 }
 
@@ -606,6 +658,7 @@ thunar_icon_factory_lookup_icon (ThunarIconFactory *factory,
   GdkRGBA            color;
   guint              color_hash = 0;
   GdkPixbuf         *pixbuf = NULL;
+  gint64             trace_time;
 
   _thunar_return_val_if_fail (THUNAR_IS_ICON_FACTORY (factory), NULL);
   _thunar_return_val_if_fail (name != NULL && *name != '\0', NULL);
@@ -637,6 +690,8 @@ thunar_icon_factory_lookup_icon (ThunarIconFactory *factory,
         }
       else
         {
+          trace_time = thunar_trace_begin ();
+
           lookup_flags = GTK_ICON_LOOKUP_FORCE_SIZE;
           if (symbolic)
             lookup_flags |= GTK_ICON_LOOKUP_FORCE_SYMBOLIC;
@@ -660,6 +715,8 @@ thunar_icon_factory_lookup_icon (ThunarIconFactory *factory,
               /* cleanup */
               g_object_unref (icon_info);
             }
+
+          thunar_trace_end_detail (trace_time, "icon", "thunar_icon_factory_lookup_icon", "%s (%dpx)", name, size);
         }
 
       /* use fallback icon if no pixbuf could be loaded */
@@ -766,6 +823,17 @@ thunar_icon_store_free (gpointer data)
 
 
 
+static void
+thunar_surface_store_free (gpointer data)
+{
+  ThunarSurfaceStore *store = data;
+
+  cairo_surface_destroy (store->surface);
+  g_slice_free (ThunarSurfaceStore, store);
+}
+
+
+
 static GdkPixbuf *
 thunar_icon_factory_load_fallback (ThunarIconFactory *factory,
                                    gint               size,
@@ -777,6 +845,184 @@ thunar_icon_factory_load_fallback (ThunarIconFactory *factory,
 
 
 
+static guint
+thunar_surface_key_hash (gconstpointer data)
+{
+  const ThunarSurfaceKey *key = data;
+
+  return ((guint) key->cell_width << 16) ^ ((guint) key->cell_height << 4) ^ (guint) key->scale_factor
+         ^ (key->emblems != NULL ? g_str_hash (key->emblems) : 0);
+}
+
+
+
+static gboolean
+thunar_surface_key_equal (gconstpointer a,
+                          gconstpointer b)
+{
+  const ThunarSurfaceKey *a_key = a;
+  const ThunarSurfaceKey *b_key = b;
+
+  return a_key->cell_width == b_key->cell_width
+         && a_key->cell_height == b_key->cell_height
+         && a_key->scale_factor == b_key->scale_factor
+         && g_strcmp0 (a_key->emblems, b_key->emblems) == 0;
+}
+
+
+
+static void
+thunar_surface_key_free (gpointer data)
+{
+  ThunarSurfaceKey *key = data;
+
+  g_free (key->emblems);
+  g_slice_free (ThunarSurfaceKey, key);
+}
+
+
+
+static void
+thunar_icon_surface_free (gpointer data)
+{
+  ThunarIconSurface *icon_surface = data;
+
+  cairo_surface_destroy (icon_surface->surface);
+  g_slice_free (ThunarIconSurface, icon_surface);
+}
+
+
+
+/* composites @icon and the @emblems (names) into one surface, at the positions
+ * the icon renderer used to paint them within a cell of the given size */
+static ThunarIconSurface *
+thunar_icon_factory_create_surface (ThunarIconFactory *factory,
+                                    GdkPixbuf         *icon,
+                                    GList             *emblems,
+                                    gint               icon_size,
+                                    gint               scale_factor,
+                                    gboolean           symbolic,
+                                    GtkStyleContext   *context,
+                                    gint               cell_width,
+                                    gint               cell_height)
+{
+  ThunarIconSurface *icon_surface;
+  GdkRectangle       emblem_areas[MAX_EMBLEMS_PER_FILE];
+  GdkPixbuf         *emblem_pixbufs[MAX_EMBLEMS_PER_FILE];
+  GdkRectangle       icon_area;
+  GdkRectangle       area;
+  GdkPixbuf         *temp;
+  cairo_t           *cr;
+  GList             *lp;
+  gint               emblem_size;
+  gint               n_emblems = 0;
+  gint               n;
+
+  icon = g_object_ref (icon);
+
+  /* determine the real icon size */
+  icon_area.width = gdk_pixbuf_get_width (icon) / scale_factor;
+  icon_area.height = gdk_pixbuf_get_height (icon) / scale_factor;
+
+  /* scale down the icon on-demand */
+  if (G_UNLIKELY (icon_area.width > cell_width || icon_area.height > cell_height))
+    {
+      temp = xfce_gdk_pixbuf_scale_down (icon, TRUE, MAX (1, cell_width * scale_factor), MAX (1, cell_height * scale_factor));
+      g_object_unref (G_OBJECT (icon));
+      icon = temp;
+
+      icon_area.width = gdk_pixbuf_get_width (icon) / scale_factor;
+      icon_area.height = gdk_pixbuf_get_height (icon) / scale_factor;
+    }
+
+  icon_area.x = (cell_width - icon_area.width) / 2;
+  icon_area.y = (cell_height - icon_area.height) / 2;
+  area = icon_area;
+
+  /* load up to MAX_EMBLEMS_PER_FILE emblems */
+  emblem_size = MIN ((2 * icon_size) / 4, 32);
+  for (lp = emblems; lp != NULL && n_emblems < MAX_EMBLEMS_PER_FILE; lp = lp->next)
+    {
+      /* check if we have the emblem in the icon theme */
+      temp = thunar_icon_factory_load_icon (factory, lp->data, emblem_size, scale_factor, FALSE, symbolic, context);
+      if (G_UNLIKELY (temp == NULL))
+        continue;
+
+      /* shrink insane emblems */
+      if (G_UNLIKELY (MAX (gdk_pixbuf_get_width (temp), gdk_pixbuf_get_height (temp)) / scale_factor > emblem_size))
+        {
+          emblem_pixbufs[n_emblems] = xfce_gdk_pixbuf_scale_ratio (temp, emblem_size * scale_factor);
+          g_object_unref (G_OBJECT (temp));
+        }
+      else
+        {
+          emblem_pixbufs[n_emblems] = temp;
+        }
+
+      emblem_areas[n_emblems].width = gdk_pixbuf_get_width (emblem_pixbufs[n_emblems]) / scale_factor;
+      emblem_areas[n_emblems].height = gdk_pixbuf_get_height (emblem_pixbufs[n_emblems]) / scale_factor;
+
+      /* determine a good position for the emblem, depending on the position index */
+      switch (n_emblems)
+        {
+        case 0: /* right/bottom */
+          emblem_areas[n_emblems].x = MIN (icon_area.x + icon_area.width - emblem_areas[n_emblems].width / 2,
+                                           cell_width - emblem_areas[n_emblems].width);
+          emblem_areas[n_emblems].y = MIN (icon_area.y + icon_area.height - emblem_areas[n_emblems].height / 2,
+                                           cell_height - emblem_areas[n_emblems].height);
+          break;
+
+        case 1: /* left/bottom */
+          emblem_areas[n_emblems].x = MAX (icon_area.x - emblem_areas[n_emblems].width / 2, 0);
+          emblem_areas[n_emblems].y = MIN (icon_area.y + icon_area.height - emblem_areas[n_emblems].height / 2,
+                                           cell_height - emblem_areas[n_emblems].height);
+          break;
+
+        case 2: /* left/top */
+          emblem_areas[n_emblems].x = MAX (icon_area.x - emblem_areas[n_emblems].width / 2, 0);
+          emblem_areas[n_emblems].y = MAX (icon_area.y - emblem_areas[n_emblems].height / 2, 0);
+          break;
+
+        case 3: /* right/top */
+          emblem_areas[n_emblems].x = MIN (icon_area.x + icon_area.width - emblem_areas[n_emblems].width / 2,
+                                           cell_width - emblem_areas[n_emblems].width);
+          emblem_areas[n_emblems].y = MAX (icon_area.y - emblem_areas[n_emblems].height / 2, 0);
+          break;
+
+        default:
+          _thunar_assert_not_reached ();
+        }
+
+      gdk_rectangle_union (&area, &emblem_areas[n_emblems], &area);
+      ++n_emblems;
+    }
+
+  /* paint everything into a device scale surface covering the icon and its emblems */
+  icon_surface = g_slice_new (ThunarIconSurface);
+  icon_surface->area = area;
+  icon_surface->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, MAX (1, area.width * scale_factor), MAX (1, area.height * scale_factor));
+  cairo_surface_set_device_scale (icon_surface->surface, scale_factor, scale_factor);
+
+  cr = cairo_create (icon_surface->surface);
+
+  thunar_gdk_cairo_set_source_pixbuf (cr, icon, icon_area.x - area.x, icon_area.y - area.y, scale_factor);
+  cairo_paint (cr);
+  g_object_unref (G_OBJECT (icon));
+
+  for (n = 0; n < n_emblems; ++n)
+    {
+      thunar_gdk_cairo_set_source_pixbuf (cr, emblem_pixbufs[n], emblem_areas[n].x - area.x, emblem_areas[n].y - area.y, scale_factor);
+      cairo_paint (cr);
+      g_object_unref (G_OBJECT (emblem_pixbufs[n]));
+    }
+
+  cairo_destroy (cr);
+
+  return icon_surface;
+}
+
+
+
 /**
  * thunar_icon_factory_get_default:
  *
@@ -1111,6 +1357,168 @@ thunar_icon_factory_load_file_icon (ThunarIconFactory  *factory,
 
 
 
+/**
+ * thunar_icon_factory_load_file_surface:
+ * @factory      : a #ThunarIconFactory instance.
+ * @file         : a #ThunarFile.
+ * @icon_state   : the desired icon state.
+ * @icon_size    : the desired icon size.
+ * @scale_factor : the UI scale factor.
+ * @symbolic     : load the symbolic version of the icon.
+ * @context      : a #GtkStyleContext instance, can be %NULL.
+ * @emblems      : %TRUE to composite the emblems of @file onto the icon.
+ * @cell_width   : the logical width of the cell the icon is drawn into.
+ * @cell_height  : the logical height of the cell the icon is drawn into.
+ * @area         : return location for the logical area of the surface,
+ *                 relative to the origin of the cell.
+ *
+ * Like thunar_icon_factory_load_file_icon(), but returns a surface at the
+ * device scale, with the icon scaled down to fit into the cell and the
+ * emblems already composited. The surfaces are shared between the files
+ * with the same icon pixbuf and emblems, and @file remembers the surface
+ * it got last, so drawing it again with the same parameters is a single
+ * lookup until the file changes.
+ *
+ * The caller is responsible to free the returned surface using
+ * cairo_surface_destroy() when no longer needed.
+ *
+ * Return value: the icon surface, or %NULL if no icon could be loaded.
+ **/
+cairo_surface_t *
+thunar_icon_factory_load_file_surface (ThunarIconFactory  *factory,
+                                       ThunarFile         *file,
+                                       ThunarFileIconState icon_state,
+                                       gint                icon_size,
+                                       gint                scale_factor,
+                                       gboolean            symbolic,
+                                       GtkStyleContext    *context,
+                                       gboolean            emblems,
+                                       gint                cell_width,
+                                       gint                cell_height,
+                                       GdkRectangle       *area)
+{
+  ThunarSurfaceStore   *store;
+  ThunarFileThumbState  thumb_state;
+  ThunarIconSurface    *icon_surface;
+  ThunarSurfaceKey      lookup_key;
+  ThunarSurfaceKey     *key;
+  cairo_surface_t      *surface;
+  GHashTable           *surfaces;
+  GdkPixbuf            *icon;
+  GString              *names = NULL;
+  GList                *emblem_names = NULL;
+  GList                *lp;
+
+  _thunar_return_val_if_fail (THUNAR_IS_ICON_FACTORY (factory), NULL);
+  _thunar_return_val_if_fail (THUNAR_IS_FILE (file), NULL);
+  _thunar_return_val_if_fail (area != NULL, NULL);
+
+  cell_width = MAX (1, cell_width);
+  cell_height = MAX (1, cell_height);
+
+  /* check if the file was drawn with the same parameters before */
+  thumb_state = thunar_file_get_thumb_state (file, thunar_icon_size_to_thumbnail_size (icon_size * scale_factor));
+  store = g_object_get_qdata (G_OBJECT (file), thunar_icon_factory_surface_store_quark);
+  if (store != NULL
+      && store->icon_state == icon_state
+      && store->icon_size == icon_size
+      && store->scale_factor == scale_factor
+      && store->cell_width == cell_width
+      && store->cell_height == cell_height
+      && store->emblems == emblems
+      && store->stamp == factory->theme_stamp
+      && store->thumbnail_draw_frames == factory->thumbnail_draw_frames
+      && store->thumb_state == thumb_state
+      && store->symbolic == symbolic)
+    {
+      *area = store->area;
+      return cairo_surface_reference (store->surface);
+    }
+
+  icon = thunar_icon_factory_load_file_icon (factory, file, icon_state, icon_size, scale_factor, symbolic, context);
+  if (G_UNLIKELY (icon == NULL))
+    return NULL;
+
+  if (emblems)
+    emblem_names = thunar_file_get_emblem_names (file);
+
+  /* the emblems are part of the key */
+  if (G_UNLIKELY (emblem_names != NULL))
+    {
+      names = g_string_new (NULL);
+      for (lp = emblem_names; lp != NULL; lp = lp->next)
+        {
+          if (lp != emblem_names)
+            g_string_append_c (names, '\n');
+          g_string_append (names, lp->data);
+        }
+    }
+
+  lookup_key.cell_width = cell_width;
+  lookup_key.cell_height = cell_height;
+  lookup_key.scale_factor = scale_factor;
+  lookup_key.emblems = (names != NULL) ? names->str : NULL;
+
+  /* the surfaces live as long as the (shared) icon pixbuf */
+  surfaces = g_object_get_qdata (G_OBJECT (icon), thunar_icon_factory_surfaces_quark);
+  if (surfaces == NULL)
+    {
+      surfaces = g_hash_table_new_full (thunar_surface_key_hash, thunar_surface_key_equal,
+                                        thunar_surface_key_free, thunar_icon_surface_free);
+      g_object_set_qdata_full (G_OBJECT (icon), thunar_icon_factory_surfaces_quark,
+                               surfaces, (GDestroyNotify) g_hash_table_destroy);
+    }
+
+  icon_surface = g_hash_table_lookup (surfaces, &lookup_key);
+  if (icon_surface == NULL)
+    {
+      icon_surface = thunar_icon_factory_create_surface (factory, icon, emblem_names, icon_size, scale_factor, symbolic, context,
+                                                         lookup_key.cell_width, lookup_key.cell_height);
+
+      key = g_slice_new (ThunarSurfaceKey);
+      key->cell_width = lookup_key.cell_width;
+      key->cell_height = lookup_key.cell_height;
+      key->scale_factor = scale_factor;
+      key->emblems = (names != NULL) ? g_string_free (names, FALSE) : NULL;
+      names = NULL;
+
+      g_hash_table_insert (surfaces, key, icon_surface);
+    }
+
+  *area = icon_surface->area;
+  surface = cairo_surface_reference (icon_surface->surface);
+
+  /* symbolic icons are recolored for the style, like in thunar_icon_factory_load_file_icon() */
+  if (!symbolic || context == NULL)
+    {
+      store = g_slice_new (ThunarSurfaceStore);
+      store->icon_state = icon_state;
+      store->thumb_state = thumb_state;
+      store->icon_size = icon_size;
+      store->scale_factor = scale_factor;
+      store->cell_width = cell_width;
+      store->cell_height = cell_height;
+      store->stamp = factory->theme_stamp;
+      store->thumbnail_draw_frames = factory->thumbnail_draw_frames;
+      store->symbolic = symbolic;
+      store->emblems = emblems;
+      store->surface = cairo_surface_reference (surface);
+      store->area = *area;
+
+      g_object_set_qdata_full (G_OBJECT (file), thunar_icon_factory_surface_store_quark,
+                               store, thunar_surface_store_free);
+    }
+
+  if (names != NULL)
+    g_string_free (names, TRUE);
+  g_list_free_full (emblem_names, g_free);
+  g_object_unref (G_OBJECT (icon));
+
+  return surface;
+}
+
+
+
 /**
  * thunar_icon_factory_clear_pixmap_cache:
  * @file : a #ThunarFile.
@@ -1125,4 +1533,24 @@ thunar_icon_factory_clear_pixmap_cache (ThunarFile *file)
   /* unset the data */
   if (thunar_icon_factory_store_quark != 0)
     g_object_set_qdata (G_OBJECT (file), thunar_icon_factory_store_quark, NULL);
+
+  thunar_icon_factory_clear_surface_cache (file);
+}
+
+
+
+/**
+ * thunar_icon_factory_clear_surface_cache:
+ * @file : a #ThunarFile.
+ *
+ * Forget the surface @file was drawn with last, so its emblems are
+ * looked up again on the next draw. The icon itself stays cached.
+ **/
+void
+thunar_icon_factory_clear_surface_cache (ThunarFile *file)
+{
+  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+
+  if (thunar_icon_factory_surface_store_quark != 0)
+    g_object_set_qdata (G_OBJECT (file), thunar_icon_factory_surface_store_quark, NULL);
 }
@@ -66,9 +66,25 @@ thunar_icon_factory_load_file_icon (ThunarIconFactory  *factory,
                                     gboolean            symbolic,
                                     GtkStyleContext    *context);
 
+cairo_surface_t *
+thunar_icon_factory_load_file_surface (ThunarIconFactory  *factory,
+                                       ThunarFile         *file,
+                                       ThunarFileIconState icon_state,
+                                       gint                icon_size,
+                                       gint                scale_factor,
+                                       gboolean            symbolic,
+                                       GtkStyleContext    *context,
+                                       gboolean            emblems,
+                                       gint                cell_width,
+                                       gint                cell_height,
+                                       GdkRectangle       *area);
+
 void
 thunar_icon_factory_clear_pixmap_cache (ThunarFile *file);
 
+void
+thunar_icon_factory_clear_surface_cache (ThunarFile *file);
+
 G_END_DECLS;
 
 #endif /* !__THUNAR_ICON_FACTORY_H__ */
@@ -18,7 +18,6 @@
  */
 
 #include "thunar/thunar-clipboard-manager.h"
-#include "thunar/thunar-gdk-extensions.h"
 #include "thunar/thunar-gobject-extensions.h"
 #include "thunar/thunar-icon-factory.h"
 #include "thunar/thunar-icon-renderer.h"
@@ -140,7 +139,7 @@ thunar_icon_renderer_class_init (ThunarIconRendererClass *klass)
    *
    * Specifies whether the icon renderer should render icons
    * based on the selection state of the items. This is necessary
-   * for #XfceIconView, which doesn't draw any item state indicators
+   * for #ThunarGridView, which doesn't draw any item state indicators
    * itself.
    **/
   g_object_class_install_property (gobject_class,
@@ -481,20 +480,11 @@ thunar_icon_renderer_render (GtkCellRenderer     *renderer,
   ThunarIconFactory      *icon_factory;
   GtkIconTheme           *icon_theme;
   GtkStyleContext        *context = NULL;
-  GdkRectangle            emblem_area;
+  cairo_surface_t        *surface;
   GdkRectangle            icon_area;
   GdkRectangle            clip_area;
-  GdkPixbuf              *emblem;
-  GdkPixbuf              *icon;
-  GdkPixbuf              *temp;
-  GList                  *emblems;
-  GList                  *lp;
   gint                    scale_factor;
-  gint                    position;
   gdouble                 alpha;
-  gint                    emblem_size;
-  gboolean                color_selected;
-  gboolean                color_lighten;
   gboolean                is_expanded;
 
   if (G_UNLIKELY (icon_renderer->file == NULL))
@@ -528,43 +518,23 @@ thunar_icon_renderer_render (GtkCellRenderer     *renderer,
   if (icon_renderer->use_symbolic_icons)
     context = gtk_widget_get_style_context (widget);
 
-  icon = thunar_icon_factory_load_file_icon (icon_factory, icon_renderer->file, icon_state,
-                                             icon_renderer->size, scale_factor,
-                                             icon_renderer->use_symbolic_icons, context);
+  /* the icon comes scaled to the cell and with the emblems composited, cached by the factory */
+  surface = thunar_icon_factory_load_file_surface (icon_factory, icon_renderer->file, icon_state,
+                                                   icon_renderer->size, scale_factor,
+                                                   icon_renderer->use_symbolic_icons, context,
+                                                   icon_renderer->emblems,
+                                                   cell_area->width, cell_area->height, &icon_area);
+  g_object_unref (G_OBJECT (icon_factory));
 
-  if (G_UNLIKELY (icon == NULL))
-    {
-      g_object_unref (G_OBJECT (icon_factory));
-      return;
-    }
+  if (G_UNLIKELY (surface == NULL))
+    return;
 
   /* pre-light the item if we're dragging about it */
   if (G_UNLIKELY (icon_state == THUNAR_FILE_ICON_STATE_DROP))
     flags |= GTK_CELL_RENDERER_PRELIT;
 
-  /* determine the real icon size */
-  icon_area.width = gdk_pixbuf_get_width (icon) / scale_factor;
-  icon_area.height = gdk_pixbuf_get_height (icon) / scale_factor;
-
-  /* scale down the icon on-demand */
-  if (G_UNLIKELY (icon_area.width > cell_area->width || icon_area.height > cell_area->height))
-    {
-      /* scale down to fit */
-      temp = xfce_gdk_pixbuf_scale_down (icon, TRUE, MAX (1, cell_area->width * scale_factor), MAX (1, cell_area->height * scale_factor));
-      g_object_unref (G_OBJECT (icon));
-      icon = temp;
-
-      /* determine the icon dimensions again */
-      icon_area.width = gdk_pixbuf_get_width (icon) / scale_factor;
-      icon_area.height = gdk_pixbuf_get_height (icon) / scale_factor;
-    }
-
-  icon_area.x = cell_area->x + (cell_area->width - icon_area.width) / 2;
-  icon_area.y = cell_area->y + (cell_area->height - icon_area.height) / 2;
-
-  /* bools for cairo transformations */
-  color_selected = (flags & GTK_CELL_RENDERER_SELECTED) != 0 && icon_renderer->follow_state;
-  color_lighten = (flags & GTK_CELL_RENDERER_PRELIT) != 0 && icon_renderer->follow_state;
+  icon_area.x += cell_area->x;
+  icon_area.y += cell_area->y;
 
   /* check whether the icon is affected by the expose event */
   if (gdk_rectangle_intersect (&clip_area, &icon_area, NULL))
@@ -588,7 +558,7 @@ thunar_icon_renderer_render (GtkCellRenderer     *renderer,
       g_object_unref (G_OBJECT (clipboard));
 
       /* render the invalid parts of the icon */
-      thunar_gdk_cairo_set_source_pixbuf (cr, icon, icon_area.x, icon_area.y, scale_factor);
+      cairo_set_source_surface (cr, surface, icon_area.x, icon_area.y);
       cairo_paint_with_alpha (cr, alpha);
 
       /* check if we should render an insensitive icon */
@@ -596,118 +566,15 @@ thunar_icon_renderer_render (GtkCellRenderer     *renderer,
         thunar_icon_renderer_color_insensitive (cr, widget);
 
       /* paint the lighten mask */
-      if (color_lighten)
+      if ((flags & GTK_CELL_RENDERER_PRELIT) != 0 && icon_renderer->follow_state)
         thunar_icon_renderer_color_lighten (cr, widget);
 
       /* paint the selected mask */
-      if (color_selected)
+      if ((flags & GTK_CELL_RENDERER_SELECTED) != 0 && icon_renderer->follow_state)
         thunar_icon_renderer_color_selected (cr, widget);
     }
 
-  /* release the file's icon */
-  g_object_unref (G_OBJECT (icon));
-
-  /* check if we should render emblems as well */
-  if (G_LIKELY (icon_renderer->emblems))
-    {
-      /* display the primary emblem as well (if any) */
-      emblems = thunar_file_get_emblem_names (icon_renderer->file);
-      if (G_UNLIKELY (emblems != NULL))
-        {
-          /* render up to MAX_EMBLEMS_PER_FILE emblems */
-          for (lp = emblems, position = 0; lp != NULL && position < MAX_EMBLEMS_PER_FILE; lp = lp->next)
-            {
-              /* calculate the emblem size */
-              emblem_size = MIN ((2 * icon_renderer->size) / 4, 32);
-
-              /* check if we have the emblem in the icon theme */
-              emblem = thunar_icon_factory_load_icon (icon_factory, lp->data, emblem_size, scale_factor, FALSE,
-                                                      icon_renderer->use_symbolic_icons, context);
-              if (G_UNLIKELY (emblem == NULL))
-                continue;
-
-              /* determine the dimensions of the emblem */
-              emblem_area.width = gdk_pixbuf_get_width (emblem) / scale_factor;
-              emblem_area.height = gdk_pixbuf_get_height (emblem) / scale_factor;
-
-              /* shrink insane emblems */
-              if (G_UNLIKELY (MAX (emblem_area.width, emblem_area.height) > emblem_size))
-                {
-                  /* scale down the emblem */
-                  temp = xfce_gdk_pixbuf_scale_ratio (emblem, emblem_size * scale_factor);
-                  g_object_unref (G_OBJECT (emblem));
-                  emblem = temp;
-
-                  /* determine the size again */
-                  emblem_area.width = gdk_pixbuf_get_width (emblem) / scale_factor;
-                  emblem_area.height = gdk_pixbuf_get_height (emblem) / scale_factor;
-                }
-
-              /* determine a good position for the emblem, depending on the position index */
-              switch (position)
-                {
-                case 0: /* right/bottom */
-                  emblem_area.x = MIN (icon_area.x + icon_area.width - emblem_area.width / 2,
-                                       cell_area->x + cell_area->width - emblem_area.width);
-                  emblem_area.y = MIN (icon_area.y + icon_area.height - emblem_area.height / 2,
-                                       cell_area->y + cell_area->height - emblem_area.height);
-                  break;
-
-                case 1: /* left/bottom */
-                  emblem_area.x = MAX (icon_area.x - emblem_area.width / 2,
-                                       cell_area->x);
-                  emblem_area.y = MIN (icon_area.y + icon_area.height - emblem_area.height / 2,
-                                       cell_area->y + cell_area->height - emblem_area.height);
-                  break;
-
-                case 2: /* left/top */
-                  emblem_area.x = MAX (icon_area.x - emblem_area.width / 2,
-                                       cell_area->x);
-                  emblem_area.y = MAX (icon_area.y - emblem_area.height / 2,
-                                       cell_area->y);
-                  break;
-
-                case 3: /* right/top */
-                  emblem_area.x = MIN (icon_area.x + icon_area.width - emblem_area.width / 2,
-                                       cell_area->x + cell_area->width - emblem_area.width);
-                  emblem_area.y = MAX (icon_area.y - emblem_area.height / 2,
-                                       cell_area->y);
-                  break;
-
-                default:
-                  _thunar_assert_not_reached ();
-                }
-
-              /* render the emblem */
-              if (gdk_rectangle_intersect (&clip_area, &emblem_area, NULL))
-                {
-                  /* render the invalid parts of the icon */
-                  thunar_gdk_cairo_set_source_pixbuf (cr, emblem, emblem_area.x, emblem_area.y, scale_factor);
-                  cairo_paint (cr);
-
-                  /* paint the lighten mask */
-                  if (color_lighten)
-                    thunar_icon_renderer_color_lighten (cr, widget);
-
-                  /* paint the selected mask */
-                  if (color_selected)
-                    thunar_icon_renderer_color_selected (cr, widget);
-                }
-
-              /* release the emblem */
-              g_object_unref (G_OBJECT (emblem));
-
-              /* advance the position index */
-              ++position;
-            }
-
-          /* release the emblem name list */
-          g_list_free_full (emblems, g_free);
-        }
-    }
-
-  /* release our reference on the icon factory */
-  g_object_unref (G_OBJECT (icon_factory));
+  cairo_surface_destroy (surface);
 }
 
 
@@ -17,6 +17,7 @@
  * Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include "thunar/thunar-grid-view.h"
 #include "thunar/thunar-icon-view.h"
 #include "thunar/thunar-private.h"
 
@@ -136,7 +137,7 @@ thunar_icon_view_set_property (GObject      *object,
     case PROP_TEXT_BESIDE_ICONS:
       if (G_UNLIKELY (g_value_get_boolean (value)))
         {
-          xfce_icon_view_set_orientation (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), GTK_ORIENTATION_HORIZONTAL);
+          thunar_grid_view_set_orientation (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), GTK_ORIENTATION_HORIZONTAL);
           g_object_set (G_OBJECT (standard_view->name_renderer), "wrap-width", 128, "yalign", 0.5f, "xalign", 0.0f, "alignment", PANGO_ALIGN_LEFT, NULL);
 
           /* disconnect the "zoom-level" signal handler, since we're using a fixed wrap-width here */
@@ -147,7 +148,7 @@ thunar_icon_view_set_property (GObject      *object,
         }
       else
         {
-          xfce_icon_view_set_orientation (XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), GTK_ORIENTATION_VERTICAL);
+          thunar_grid_view_set_orientation (THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (standard_view))), GTK_ORIENTATION_VERTICAL);
           g_object_set (G_OBJECT (standard_view->name_renderer), "yalign", 0.0f, "xalign", 0.5f, "alignment", PANGO_ALIGN_CENTER, NULL);
 
           /* connect the "zoom-level" signal handler as the wrap-width is now synced with the "zoom-level" */
@@ -202,25 +203,25 @@ static void
 thunar_icon_view_set_consistent_horizontal_spacing (ThunarIconView *icon_view)
 {
   ThunarStandardView *standard_view = THUNAR_STANDARD_VIEW (icon_view);
-  XfceIconView       *xfce_icon_view = XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (standard_view)));
+  ThunarGridView     *grid_view = THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (standard_view)));
   gint                wrap_width;
   gint                xpad;
   gint                column_spacing;
 
-  if (xfce_icon_view_get_orientation (xfce_icon_view) == GTK_ORIENTATION_HORIZONTAL)
+  if (thunar_grid_view_get_orientation (grid_view) == GTK_ORIENTATION_HORIZONTAL)
     {
       /* reset consistent horizontal spacing if text is beside icon */
-      xfce_icon_view_set_item_width (xfce_icon_view, -1);
+      thunar_grid_view_set_item_width (grid_view, -1);
       return;
     }
 
   g_object_get (G_OBJECT (standard_view->name_renderer), "wrap-width", &wrap_width, NULL);
   gtk_cell_renderer_get_padding (standard_view->name_renderer, &xpad, NULL);
 
-  column_spacing = xfce_icon_view_get_column_spacing (xfce_icon_view);
+  column_spacing = thunar_grid_view_get_column_spacing (grid_view);
 
   /* set consistent horizontal spacing */
-  xfce_icon_view_set_item_width (xfce_icon_view, wrap_width + MAX (0, xpad * 2 - column_spacing));
+  thunar_grid_view_set_item_width (grid_view, wrap_width + MAX (0, xpad * 2 - column_spacing));
 }
 
 
@@ -229,12 +230,12 @@ static void
 thunar_icon_view_zoom_level_changed (ThunarStandardView *standard_view)
 {
   gint            wrap_width;
-  XfceIconView   *xfce_icon_view;
+  ThunarGridView *grid_view;
   ThunarZoomLevel zoom_level;
 
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
 
-  xfce_icon_view = XFCE_ICON_VIEW (gtk_bin_get_child (GTK_BIN (standard_view)));
+  grid_view = THUNAR_GRID_VIEW (gtk_bin_get_child (GTK_BIN (standard_view)));
   zoom_level = thunar_view_get_zoom_level (THUNAR_VIEW (standard_view));
 
   /* determine the "wrap-width" depending on the "zoom-level" */
@@ -269,5 +270,5 @@ thunar_icon_view_zoom_level_changed (ThunarStandardView *standard_view)
 
   /* Like that rubber band selection can be done properly on high zoom levels */
   /* Without margin adjustment it would be almost impossible to start the selection on the left */
-  xfce_icon_view_set_margin (xfce_icon_view, thunar_zoom_level_to_view_margin (zoom_level));
+  thunar_grid_view_set_margin (grid_view, thunar_zoom_level_to_view_margin (zoom_level));
 }
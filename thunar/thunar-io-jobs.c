@@ -18,9 +18,28 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
 #ifdef HAVE_ERRNO_H
 #include <errno.h>
 #endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 
 #include "thunar/thunar-application.h"
 #include "thunar/thunar-enum-types.h"
@@ -36,6 +55,7 @@
 #include "thunar/thunar-simple-job.h"
 #include "thunar/thunar-thumbnail-cache.h"
 #include "thunar/thunar-transfer-job.h"
+#include "thunar/thunar-trash-accounting.h"
 
 #include <gio/gio.h>
 #include <glib/gstdio.h>
@@ -986,6 +1006,418 @@ thunar_io_jobs_link_files (GList *source_file_list,
 
 
 
+/* number of files which are moved to the home trash before their trash info files are flushed to disk */
+#define TRASH_BATCH_SIZE 256
+
+
+
+typedef struct
+{
+  GFile *file;
+  gchar *path;
+  gchar *trash_name;
+  gchar *info_path;
+  gint   info_fd;
+  guint  is_symlink : 1;
+} TrashItem;
+
+
+
+static TrashItem *
+_tij_trash_item_new (GFile   *file,
+                     gchar   *path,
+                     gboolean is_symlink)
+{
+  TrashItem *item;
+
+  item = g_slice_new0 (TrashItem);
+  item->file = g_object_ref (file);
+  item->path = path;
+  item->info_fd = -1;
+  item->is_symlink = is_symlink;
+
+  return item;
+}
+
+
+
+static void
+_tij_trash_item_free (gpointer data)
+{
+  TrashItem *item = data;
+
+  if (item->info_fd >= 0)
+    close (item->info_fd);
+
+  g_object_unref (item->file);
+  g_free (item->path);
+  g_free (item->trash_name);
+  g_free (item->info_path);
+  g_slice_free (TrashItem, item);
+}
+
+
+
+/* returns the home trash directory, creating it if necessary. Only files on the
+ * same device are moved there natively, everything else is left to g_file_trash() */
+static gchar *
+_tij_trash_get_home_dir (dev_t *device)
+{
+  GStatBuf statb;
+  gchar   *trash_dir;
+  gchar   *files_dir;
+  gchar   *info_dir;
+  gboolean succeed;
+
+  trash_dir = g_build_filename (g_get_user_data_dir (), "Trash", NULL);
+  files_dir = g_build_filename (trash_dir, "files", NULL);
+  info_dir = g_build_filename (trash_dir, "info", NULL);
+
+  succeed = g_mkdir_with_parents (files_dir, 0700) == 0
+            && g_mkdir_with_parents (info_dir, 0700) == 0
+            && g_stat (trash_dir, &statb) == 0;
+
+  g_free (files_dir);
+  g_free (info_dir);
+
+  if (!succeed)
+    {
+      g_free (trash_dir);
+      return NULL;
+    }
+
+  *device = statb.st_dev;
+  return trash_dir;
+}
+
+
+
+/* whether @path is @ancestor or lies below it, unlike g_str_has_prefix() this
+ * does not take "/a/bc" for a child of "/a/b" */
+static gboolean
+_tij_trash_path_is_below (const gchar *path,
+                          const gchar *ancestor)
+{
+  gsize length = strlen (ancestor);
+
+  if (strncmp (path, ancestor, length) != 0)
+    return FALSE;
+
+  return path[length] == '\0'
+         || path[length] == G_DIR_SEPARATOR
+         || (length > 0 && ancestor[length - 1] == G_DIR_SEPARATOR);
+}
+
+
+
+static TrashItem *
+_tij_trash_item_new_for_home_trash (GFile       *file,
+                                    const gchar *trash_dir,
+                                    dev_t        trash_device)
+{
+  GStatBuf statb;
+  gchar   *path;
+
+  if (!g_file_is_native (file))
+    return NULL;
+
+  path = g_file_get_path (file);
+  if (G_UNLIKELY (path == NULL))
+    return NULL;
+
+  /* leave the trash itself and its parents to g_file_trash(), which knows how to refuse them.
+   * Files on other devices go to the trash of their own mount point */
+  if (_tij_trash_path_is_below (path, trash_dir)
+      || _tij_trash_path_is_below (trash_dir, path)
+      || g_lstat (path, &statb) != 0
+      || statb.st_dev != trash_device)
+    {
+      g_free (path);
+      return NULL;
+    }
+
+  return _tij_trash_item_new (file, path, S_ISLNK (statb.st_mode));
+}
+
+
+
+/* same naming scheme as g_file_trash(), so the trash looks the same either way */
+static gchar *
+_tij_trash_unique_name (const gchar *basename,
+                        guint        n)
+{
+  const gchar *dot;
+
+  if (n == 1)
+    return g_strdup (basename);
+
+  dot = strchr (basename, '.');
+  if (dot != NULL)
+    return g_strdup_printf ("%.*s.%u%s", (gint) (dot - basename), basename, n, dot);
+
+  return g_strdup_printf ("%s.%u", basename, n);
+}
+
+
+
+static gboolean
+_tij_trash_write_all (gint         fd,
+                      const gchar *data,
+                      gsize        length)
+{
+  gssize n;
+
+  while (length > 0)
+    {
+      n = write (fd, data, length);
+      if (n < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return FALSE;
+        }
+
+      data += n;
+      length -= n;
+    }
+
+  return TRUE;
+}
+
+
+
+/* reserves a name in the trash for @item and writes its trash info file, without
+ * syncing it. On failure the item is left to g_file_trash() */
+static void
+_tij_trash_item_write_info (TrashItem   *item,
+                            const gchar *files_dir,
+                            const gchar *info_dir,
+                            const gchar *deletion_date)
+{
+  GStatBuf statb;
+  gchar   *basename;
+  gchar   *trash_name;
+  gchar   *info_path;
+  gchar   *trash_path;
+  gchar   *escaped_path;
+  gchar   *contents;
+  gint     fd;
+  guint    n;
+
+  basename = g_path_get_basename (item->path);
+
+  for (n = 1;; n++)
+    {
+      trash_name = _tij_trash_unique_name (basename, n);
+      info_path = g_strconcat (info_dir, G_DIR_SEPARATOR_S, trash_name, ".trashinfo", NULL);
+
+      fd = g_open (info_path, O_CREAT | O_EXCL | O_WRONLY, 0600);
+      if (fd >= 0)
+        {
+          /* do not overwrite orphaned files which have no trash info */
+          trash_path = g_build_filename (files_dir, trash_name, NULL);
+          if (g_lstat (trash_path, &statb) != 0)
+            {
+              g_free (trash_path);
+              break;
+            }
+
+          g_free (trash_path);
+          close (fd);
+          g_unlink (info_path);
+        }
+      else if (errno != EEXIST)
+        {
+          g_free (trash_name);
+          g_free (info_path);
+          g_free (basename);
+          return;
+        }
+
+      g_free (trash_name);
+      g_free (info_path);
+    }
+
+  g_free (basename);
+
+  escaped_path = g_uri_escape_string (item->path, "/", FALSE);
+  contents = g_strdup_printf ("[Trash Info]\nPath=%s\nDeletionDate=%s\n", escaped_path, deletion_date);
+  g_free (escaped_path);
+
+  if (_tij_trash_write_all (fd, contents, strlen (contents)))
+    {
+      item->trash_name = trash_name;
+      item->info_path = info_path;
+      item->info_fd = fd;
+    }
+  else
+    {
+      close (fd);
+      g_unlink (info_path);
+      g_free (trash_name);
+      g_free (info_path);
+    }
+
+  g_free (contents);
+}
+
+
+
+/* handles the outcome of trashing @file. Returns FALSE if the job has to stop, either
+ * because the user cancelled or because @error was set */
+static gboolean
+_tij_trash_file_finished (ThunarJob            *job,
+                          GFile                *file,
+                          GError               *trash_error,
+                          ThunarThumbnailCache *thumbnail_cache,
+                          ThunarJobOperation   *operation,
+                          GError              **error)
+{
+  ThunarJobResponse response;
+  GError           *err = NULL;
+
+  if (trash_error != NULL)
+    {
+      response = thunar_job_ask_delete (job, "%s", trash_error->message);
+
+      if (response == THUNAR_JOB_RESPONSE_CANCEL)
+        return FALSE;
+
+      if (response == THUNAR_JOB_RESPONSE_YES)
+        _tij_delete_file (job, file, thumbnail_cache, thunar_job_get_cancellable (THUNAR_JOB (job)), &err);
+
+      if (err != NULL)
+        {
+          g_propagate_error (error, err);
+          return FALSE;
+        }
+    }
+
+  if (operation != NULL)
+    thunar_job_operation_add (operation, file, NULL);
+
+  return TRUE;
+}
+
+
+
+/* moves all files in @batch into the home trash. The trash info files of the whole
+ * batch are written first and synced together, so that the journal of the file
+ * system is committed once per batch instead of once per file */
+static gboolean
+_tij_trash_batch_flush (ThunarJob            *job,
+                        GPtrArray            *batch,
+                        const gchar          *trash_dir,
+                        ThunarThumbnailCache *thumbnail_cache,
+                        ThunarJobOperation   *operation,
+                        GError              **error)
+{
+  TrashItem *item;
+  GDateTime *now;
+  GError    *trash_error;
+  GList     *source_files = NULL;
+  GList     *target_files = NULL;
+  gchar     *files_dir;
+  gchar     *info_dir;
+  gchar     *trash_path;
+  gchar     *deletion_date;
+  gboolean   proceed = TRUE;
+  guint      n;
+
+  if (batch->len == 0)
+    return TRUE;
+
+  files_dir = g_build_filename (trash_dir, "files", NULL);
+  info_dir = g_build_filename (trash_dir, "info", NULL);
+
+  now = g_date_time_new_now_local ();
+  deletion_date = g_date_time_format (now, "%Y-%m-%dT%H:%M:%S");
+  g_date_time_unref (now);
+
+  for (n = 0; n < batch->len; n++)
+    _tij_trash_item_write_info (g_ptr_array_index (batch, n), files_dir, info_dir, deletion_date);
+
+  /* once the first fsync() has committed the pending metadata of the
+   * batch, the remaining ones usually return without further I/O */
+  for (n = 0; n < batch->len; n++)
+    {
+      item = g_ptr_array_index (batch, n);
+      if (item->info_fd < 0)
+        continue;
+
+      if (fsync (item->info_fd) != 0)
+        {
+          g_unlink (item->info_path);
+          g_clear_pointer (&item->info_path, g_free);
+        }
+
+      close (item->info_fd);
+      item->info_fd = -1;
+    }
+
+  for (n = 0; n < batch->len; n++)
+    {
+      item = g_ptr_array_index (batch, n);
+
+      if (!proceed || thunar_job_is_cancelled (job))
+        {
+          /* drop the reserved trash info of the files we won't trash */
+          if (item->info_path != NULL)
+            g_unlink (item->info_path);
+          proceed = FALSE;
+          continue;
+        }
+
+      trash_error = NULL;
+
+      if (item->info_path != NULL)
+        {
+          trash_path = g_build_filename (files_dir, item->trash_name, NULL);
+
+          if (g_rename (item->path, trash_path) == 0)
+            {
+              thunar_trash_accounting_item_added (trash_dir, item->trash_name);
+
+              if (!item->is_symlink)
+                {
+                  source_files = g_list_prepend (source_files, g_object_ref (item->file));
+                  target_files = g_list_prepend (target_files, g_file_new_for_path (trash_path));
+                }
+            }
+          else
+            {
+              g_unlink (item->info_path);
+              g_clear_pointer (&item->info_path, g_free);
+            }
+
+          g_free (trash_path);
+        }
+
+      /* let gio try (and report) whatever we could not handle natively */
+      if (item->info_path == NULL)
+        g_file_trash (item->file, thunar_job_get_cancellable (job), &trash_error);
+
+      thunar_job_set_current_file (job, item->file);
+      proceed = _tij_trash_file_finished (job, item->file, trash_error, thumbnail_cache, operation, error);
+      g_clear_error (&trash_error);
+    }
+
+  /* move the thumbnails of the whole batch along with the files */
+  thunar_thumbnail_cache_move_files (thumbnail_cache, source_files, target_files);
+  thunar_g_list_free_full (source_files);
+  thunar_g_list_free_full (target_files);
+
+  g_ptr_array_set_size (batch, 0);
+
+  g_free (deletion_date);
+  g_free (files_dir);
+  g_free (info_dir);
+
+  return proceed;
+}
+
+
+
 static gboolean
 _thunar_io_jobs_trash (ThunarJob *job,
                        GArray    *param_values,
@@ -994,11 +1426,16 @@ _thunar_io_jobs_trash (ThunarJob *job,
   g_autoptr (ThunarApplication) application = NULL;
   g_autoptr (ThunarThumbnailCache) thumbnail_cache = NULL;
   ThunarJobOperation    *operation = NULL;
-  ThunarJobResponse      response;
   ThunarOperationLogMode log_mode;
+  TrashItem             *item;
+  GPtrArray             *batch;
+  GError                *trash_error;
   GError                *err = NULL;
   GList                 *file_list;
   GList                 *lp;
+  gchar                 *trash_dir;
+  dev_t                  trash_device = 0;
+  gboolean               proceed = TRUE;
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
   _thunar_return_val_if_fail (param_values != NULL, FALSE);
@@ -1018,30 +1455,49 @@ _thunar_io_jobs_trash (ThunarJob *job,
   if (log_mode != THUNAR_OPERATION_LOG_NO_OPERATIONS)
     operation = thunar_job_operation_new (THUNAR_JOB_OPERATION_KIND_TRASH);
 
-  for (lp = file_list; err == NULL && lp != NULL; lp = lp->next)
+  /* files on the device of the home trash are moved there natively in batches */
+  trash_dir = _tij_trash_get_home_dir (&trash_device);
+  batch = g_ptr_array_new_with_free_func (_tij_trash_item_free);
+
+  for (lp = file_list; proceed && lp != NULL; lp = lp->next)
     {
       _thunar_assert (G_IS_FILE (lp->data));
 
-      /* trash the file or folder */
-      g_file_trash (lp->data, thunar_job_get_cancellable (THUNAR_JOB (job)), &err);
+      item = NULL;
+      if (trash_dir != NULL)
+        item = _tij_trash_item_new_for_home_trash (lp->data, trash_dir, trash_device);
 
-      if (err != NULL)
+      if (item != NULL)
         {
-          response = thunar_job_ask_delete (job, "%s", err->message);
-
-          g_clear_error (&err);
+          g_ptr_array_add (batch, item);
+          if (batch->len >= TRASH_BATCH_SIZE)
+            proceed = _tij_trash_batch_flush (job, batch, trash_dir, thumbnail_cache, operation, &err);
+          continue;
+        }
 
-          if (response == THUNAR_JOB_RESPONSE_CANCEL)
-            break;
+      /* keep the order of the files */
+      proceed = _tij_trash_batch_flush (job, batch, trash_dir, thumbnail_cache, operation, &err);
+      if (!proceed)
+        break;
 
-          if (response == THUNAR_JOB_RESPONSE_YES)
-            _tij_delete_file (job, lp->data, thumbnail_cache, thunar_job_get_cancellable (THUNAR_JOB (job)), &err);
-        }
+      /* trash the file or folder */
+      trash_error = NULL;
+      g_file_trash (lp->data, thunar_job_get_cancellable (THUNAR_JOB (job)), &trash_error);
 
-      if (err == NULL && log_mode != THUNAR_OPERATION_LOG_NO_OPERATIONS)
-        thunar_job_operation_add (operation, lp->data, NULL);
+      proceed = _tij_trash_file_finished (job, lp->data, trash_error, thumbnail_cache, operation, &err);
+      g_clear_error (&trash_error);
     }
 
+  /* trash what is left in the last batch */
+  if (proceed)
+    _tij_trash_batch_flush (job, batch, trash_dir, thumbnail_cache, operation, &err);
+
+  g_ptr_array_unref (batch);
+  g_free (trash_dir);
+
+  /* g_file_trash() may have created the trash directory of a volume */
+  thunar_trash_accounting_files_trashed ();
+
   if (log_mode == THUNAR_OPERATION_LOG_OPERATIONS)
     {
       thunar_job_operation_history_commit (operation);
@@ -1104,6 +1560,350 @@ thunar_io_jobs_restore_files (GList *source_file_list,
 
 
 
+/* upper limit for the number of threads which walk a tree for a recursive chmod/chown */
+#define ATTRS_WALK_MAX_THREADS 8
+
+
+
+typedef struct
+{
+  ThunarJob     *job;
+  GThreadPool   *pool;
+
+  /* the ownership to set, -1 to leave unchanged */
+  gint uid;
+  gint gid;
+
+  /* the mode to set, if change_mode is TRUE */
+  gboolean       change_mode;
+  ThunarFileMode dir_mask;
+  ThunarFileMode dir_mode;
+  ThunarFileMode file_mask;
+  ThunarFileMode file_mode;
+
+  /* protected by lock */
+  GMutex lock;
+  GCond  cond;
+  guint  n_pending;
+  guint  n_dirs_seen;
+  guint  n_dirs_done;
+  gchar *current_path;
+  GList *directories;
+  GList *failed;
+} AttrsWalk;
+
+typedef struct
+{
+  gchar *path;
+  gint   errnum;
+} AttrsFailure;
+
+
+
+static void
+_tij_attrs_failure_free (gpointer data)
+{
+  AttrsFailure *failure = data;
+
+  g_free (failure->path);
+  g_slice_free (AttrsFailure, failure);
+}
+
+
+
+static void
+_tij_attrs_walk_failed (AttrsWalk   *walk,
+                        const gchar *path,
+                        gint         errnum)
+{
+  AttrsFailure *failure;
+
+  failure = g_slice_new (AttrsFailure);
+  failure->path = g_strdup (path);
+  failure->errnum = errnum;
+
+  g_mutex_lock (&walk->lock);
+  walk->failed = g_list_prepend (walk->failed, failure);
+  g_mutex_unlock (&walk->lock);
+}
+
+
+
+/* applies the requested change to @name in @dir_fd, unless it already matches. Returns 0
+ * on success, else the errno of the failed syscall */
+static gint
+_tij_attrs_walk_apply (AttrsWalk         *walk,
+                       gint               dir_fd,
+                       const gchar       *name,
+                       const struct stat *statb)
+{
+  ThunarFileMode mask;
+  ThunarFileMode mode;
+  ThunarFileMode new_mode;
+
+  if (walk->change_mode)
+    {
+      /* permissions of symlinks are meaningless */
+      if (S_ISLNK (statb->st_mode))
+        return 0;
+
+      if (S_ISDIR (statb->st_mode))
+        {
+          mask = walk->dir_mask;
+          mode = walk->dir_mode;
+        }
+      else
+        {
+          mask = walk->file_mask;
+          mode = walk->file_mode;
+        }
+
+      new_mode = ((statb->st_mode & ~mask) | mode) & 07777;
+      if ((statb->st_mode & 07777) != new_mode && fchmodat (dir_fd, name, new_mode, 0) != 0)
+        return errno;
+    }
+  else
+    {
+      if ((walk->uid < 0 || statb->st_uid == (uid_t) walk->uid)
+          && (walk->gid < 0 || statb->st_gid == (gid_t) walk->gid))
+        return 0;
+
+      if (fchownat (dir_fd, name, (uid_t) walk->uid, (gid_t) walk->gid, AT_SYMLINK_NOFOLLOW) != 0)
+        return errno;
+    }
+
+  return 0;
+}
+
+
+
+static void
+_tij_attrs_walk_push (AttrsWalk   *walk,
+                      const gchar *path)
+{
+  g_mutex_lock (&walk->lock);
+  walk->n_pending++;
+  walk->n_dirs_seen++;
+
+  /* children are always queued after their parent, so the prepended list
+   * has them in front of their parents when the job changes the directories */
+  walk->directories = g_list_prepend (walk->directories, g_strdup (path));
+  g_mutex_unlock (&walk->lock);
+
+  g_thread_pool_push (walk->pool, g_strdup (path), NULL);
+}
+
+
+
+/* worker of the thread pool: changes all entries of the directory @data relative to
+ * its file descriptor and queues the subdirectories for the other workers. The
+ * directory itself is changed by the job once the walk is done, so restrictive
+ * modes cannot lock the workers out of the tree */
+static void
+_tij_attrs_walk_directory (gpointer data,
+                           gpointer user_data)
+{
+  AttrsWalk     *walk = user_data;
+  gchar         *path = data;
+  gchar         *child_path;
+  struct dirent *entry;
+  struct stat    statb;
+  DIR           *dir = NULL;
+  gint           fd;
+  gint           errnum;
+
+  if (thunar_job_is_cancelled (walk->job))
+    goto done;
+
+  fd = g_open (path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW, 0);
+  if (fd < 0 && errno == EACCES && g_lstat (path, &statb) == 0)
+    {
+      /* the new mode might be what makes the directory readable */
+      if (_tij_attrs_walk_apply (walk, AT_FDCWD, path, &statb) == 0)
+        fd = g_open (path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW, 0);
+      else
+        errno = EACCES;
+    }
+
+  if (fd < 0 || (dir = fdopendir (fd)) == NULL)
+    {
+      _tij_attrs_walk_failed (walk, path, errno);
+      if (fd >= 0)
+        close (fd);
+      goto done;
+    }
+
+  while (!thunar_job_is_cancelled (walk->job))
+    {
+      errno = 0;
+      entry = readdir (dir);
+      if (entry == NULL)
+        {
+          if (errno != 0)
+            _tij_attrs_walk_failed (walk, path, errno);
+          break;
+        }
+
+      if (strcmp (entry->d_name, ".") == 0 || strcmp (entry->d_name, "..") == 0)
+        continue;
+
+      child_path = g_build_filename (path, entry->d_name, NULL);
+
+      if (fstatat (fd, entry->d_name, &statb, AT_SYMLINK_NOFOLLOW) != 0)
+        _tij_attrs_walk_failed (walk, child_path, errno);
+      else if (S_ISDIR (statb.st_mode))
+        _tij_attrs_walk_push (walk, child_path);
+      else if ((errnum = _tij_attrs_walk_apply (walk, fd, entry->d_name, &statb)) != 0)
+        _tij_attrs_walk_failed (walk, child_path, errnum);
+
+      g_free (child_path);
+    }
+
+  closedir (dir);
+
+done:
+  g_mutex_lock (&walk->lock);
+
+  g_free (walk->current_path);
+  walk->current_path = path;
+
+  walk->n_dirs_done++;
+  if (--walk->n_pending == 0)
+    g_cond_signal (&walk->cond);
+
+  g_mutex_unlock (&walk->lock);
+}
+
+
+
+/* recursively changes the ownership or the mode of the local files in @file_list, walking
+ * the trees with a pool of threads. Failures are collected during the walk and handed to
+ * the user once it is done, just like the sequential implementation does */
+static gboolean
+_tij_attrs_walk (AttrsWalk *walk,
+                 GList     *file_list,
+                 GError   **error)
+{
+  ThunarJobResponse response;
+  AttrsFailure     *failure;
+  struct stat       statb;
+  const gchar      *message;
+  gint64            end_time;
+  gchar            *path;
+  gchar            *display_name;
+  gint              errnum;
+  gdouble           percent;
+  GList            *lp;
+
+  g_mutex_init (&walk->lock);
+  g_cond_init (&walk->cond);
+
+  walk->pool = g_thread_pool_new (_tij_attrs_walk_directory, walk,
+                                  CLAMP (g_get_num_processors (), 2, ATTRS_WALK_MAX_THREADS),
+                                  FALSE, NULL);
+
+  for (lp = file_list; lp != NULL; lp = lp->next)
+    {
+      path = g_file_get_path (lp->data);
+
+      if (g_lstat (path, &statb) != 0)
+        _tij_attrs_walk_failed (walk, path, errno);
+      else if (S_ISDIR (statb.st_mode))
+        _tij_attrs_walk_push (walk, path);
+      else if ((errnum = _tij_attrs_walk_apply (walk, AT_FDCWD, path, &statb)) != 0)
+        _tij_attrs_walk_failed (walk, path, errnum);
+
+      g_free (path);
+    }
+
+  /* report the progress while the workers are busy */
+  g_mutex_lock (&walk->lock);
+  while (walk->n_pending > 0)
+    {
+      end_time = g_get_monotonic_time () + 100 * G_TIME_SPAN_MILLISECOND;
+      if (g_cond_wait_until (&walk->cond, &walk->lock, end_time) || walk->current_path == NULL)
+        continue;
+
+      display_name = g_filename_display_basename (walk->current_path);
+      percent = (walk->n_dirs_done * 100.0) / walk->n_dirs_seen;
+      g_mutex_unlock (&walk->lock);
+
+      thunar_job_info_message (walk->job, "%s", display_name);
+      thunar_job_percent (walk->job, percent);
+      g_free (display_name);
+
+      g_mutex_lock (&walk->lock);
+    }
+  g_mutex_unlock (&walk->lock);
+
+  g_thread_pool_free (walk->pool, FALSE, TRUE);
+
+  /* change the directories, deepest first */
+  for (lp = walk->directories; lp != NULL && !thunar_job_is_cancelled (walk->job); lp = lp->next)
+    {
+      if (g_lstat (lp->data, &statb) != 0)
+        _tij_attrs_walk_failed (walk, lp->data, errno);
+      else if ((errnum = _tij_attrs_walk_apply (walk, AT_FDCWD, lp->data, &statb)) != 0)
+        _tij_attrs_walk_failed (walk, lp->data, errnum);
+    }
+
+  /* let the user decide about the files we failed to change */
+  if (walk->change_mode)
+    message = _("Failed to change the permissions of \"%s\": %s");
+  else if (walk->uid >= 0)
+    message = _("Failed to change the owner of \"%s\": %s");
+  else
+    message = _("Failed to change the group of \"%s\": %s");
+
+  for (lp = g_list_reverse (walk->failed), walk->failed = lp; lp != NULL; lp = lp->next)
+    {
+      failure = lp->data;
+
+      for (errnum = failure->errnum; errnum != 0;)
+        {
+          if (thunar_job_is_cancelled (walk->job))
+            break;
+
+          display_name = g_filename_display_basename (failure->path);
+          response = thunar_job_ask_skip (walk->job, message, display_name, g_strerror (errnum));
+          g_free (display_name);
+
+          if (response != THUNAR_JOB_RESPONSE_RETRY)
+            break;
+
+          if (g_lstat (failure->path, &statb) != 0)
+            errnum = errno;
+          else
+            errnum = _tij_attrs_walk_apply (walk, AT_FDCWD, failure->path, &statb);
+        }
+    }
+
+  g_list_free_full (walk->directories, g_free);
+  g_list_free_full (walk->failed, _tij_attrs_failure_free);
+  g_free (walk->current_path);
+
+  g_cond_clear (&walk->cond);
+  g_mutex_clear (&walk->lock);
+
+  return !thunar_job_set_error_if_cancelled (walk->job, error);
+}
+
+
+
+static gboolean
+_tij_attrs_walk_supported (GList *file_list)
+{
+  GList *lp;
+
+  for (lp = file_list; lp != NULL; lp = lp->next)
+    if (!g_file_is_native (lp->data))
+      return FALSE;
+
+  return TRUE;
+}
+
+
+
 static gboolean
 _thunar_io_jobs_chown (ThunarJob *job,
                        GArray    *param_values,
@@ -1132,6 +1932,18 @@ _thunar_io_jobs_chown (ThunarJob *job,
 
   _thunar_assert ((uid >= 0 || gid >= 0) && !(uid >= 0 && gid >= 0));
 
+  /* local trees are walked in parallel, without collecting them first */
+  if (recursive && _tij_attrs_walk_supported (file_list))
+    {
+      AttrsWalk walk = { 0 };
+
+      walk.job = job;
+      walk.uid = uid;
+      walk.gid = gid;
+
+      return _tij_attrs_walk (&walk, file_list, error);
+    }
+
   /* collect the files for the chown operation */
   if (recursive)
     file_list = _tij_collect_nofollow (job, file_list, FALSE, &err);
@@ -1275,6 +2087,23 @@ _thunar_io_jobs_chmod (ThunarJob *job,
   file_mode = g_value_get_flags (&g_array_index (param_values, GValue, 4));
   recursive = g_value_get_boolean (&g_array_index (param_values, GValue, 5));
 
+  /* local trees are walked in parallel, without collecting them first */
+  if (recursive && _tij_attrs_walk_supported (file_list))
+    {
+      AttrsWalk walk = { 0 };
+
+      walk.job = job;
+      walk.uid = -1;
+      walk.gid = -1;
+      walk.change_mode = TRUE;
+      walk.dir_mask = dir_mask;
+      walk.dir_mode = dir_mode;
+      walk.file_mask = file_mask;
+      walk.file_mode = file_mode;
+
+      return _tij_attrs_walk (&walk, file_list, error);
+    }
+
   /* collect the files for the chown operation */
   if (recursive)
     file_list = _tij_collect_nofollow (job, file_list, FALSE, &err);
@@ -1326,7 +2155,7 @@ retry_chown:
        * information) into account */
       new_mode = ((old_mode & ~mask) | mode) & 07777;
 
-      if (old_mode != new_mode)
+      if ((old_mode & 07777) != new_mode)
         {
           /* try to change the file mode */
           g_file_set_attribute_uint32 (lp->data,
@@ -1403,9 +2232,10 @@ _thunar_io_jobs_ls (ThunarJob *job,
                     GArray    *param_values,
                     GError   **error)
 {
-  GError *err = NULL;
-  GFile  *directory;
-  GList  *file_list = NULL;
+  GFileInfo *info;
+  GError    *err = NULL;
+  GFile     *directory;
+  GList     *file_list = NULL;
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
   _thunar_return_val_if_fail (param_values != NULL, FALSE);
@@ -1421,6 +2251,17 @@ _thunar_io_jobs_ls (ThunarJob *job,
   /* make sure the object is valid */
   _thunar_assert (G_IS_FILE (directory));
 
+  /* remember the etag/mtime of remote directories before they are listed, so the
+   * listing can be revalidated on the next visit, see thunar_folder_listing_store() */
+  if (!g_file_is_native (directory))
+    {
+      info = g_file_query_info (directory,
+                                G_FILE_ATTRIBUTE_ETAG_VALUE "," G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                                G_FILE_QUERY_INFO_NONE, thunar_job_get_cancellable (THUNAR_JOB (job)), NULL);
+      if (info != NULL)
+        g_object_set_data_full (G_OBJECT (job), "directory-info", info, g_object_unref);
+    }
+
   /* collect directory contents (non-recursively) */
   file_list = thunar_io_scan_directory (job, directory,
                                         G_FILE_QUERY_INFO_NONE,
@@ -1468,9 +2309,15 @@ _thunar_io_jobs_ls (ThunarJob *job,
 ThunarJob *
 thunar_io_jobs_list_directory (GFile *directory)
 {
+  ThunarJob *job;
+
   _thunar_return_val_if_fail (G_IS_FILE (directory), NULL);
 
-  return thunar_simple_job_new (_thunar_io_jobs_ls, 1, G_TYPE_FILE, directory);
+  /* the user is waiting for the folder contents */
+  job = thunar_simple_job_new (_thunar_io_jobs_ls, 1, G_TYPE_FILE, directory);
+  thunar_job_set_priority (job, THUNAR_JOB_PRIORITY_INTERACTIVE);
+
+  return job;
 }
 
 
@@ -1627,10 +2474,16 @@ _thunar_io_jobs_count (ThunarJob *job,
 ThunarJob *
 thunar_io_jobs_count_files (ThunarFile *file)
 {
+  ThunarJob *job;
+
   _thunar_return_val_if_fail (THUNAR_IS_FILE (file), NULL);
 
-  return thunar_simple_job_new (_thunar_io_jobs_count, 1,
-                                THUNAR_TYPE_FILE, file);
+  /* the count is shown for the visible rows of the views */
+  job = thunar_simple_job_new (_thunar_io_jobs_count, 1,
+                               THUNAR_TYPE_FILE, file);
+  thunar_job_set_priority (job, THUNAR_JOB_PRIORITY_VISIBLE);
+
+  return job;
 }
 
 
@@ -1641,16 +2494,83 @@ _thunar_search_folder (ThunarTreeViewModel           *model,
                        gchar                         *uri,
                        gchar                        **search_query_c_terms,
                        enum ThunarTreeViewModelSearch search_type,
-                       gboolean                       show_hidden)
+                       gboolean                       show_hidden);
+
+
+
+/* checks if @file matches the search, takes the references of @file and @info */
+static GList *
+_thunar_search_folder_match (ThunarTreeViewModel           *model,
+                             ThunarJob                     *job,
+                             GFile                         *file,
+                             GFileInfo                     *info,
+                             gchar                        **search_query_c_terms,
+                             enum ThunarTreeViewModelSearch search_type,
+                             gboolean                       show_hidden,
+                             GList                         *files_found)
 {
-  GCancellable    *cancellable;
-  GFileEnumerator *enumerator;
-  GFile           *directory;
-  GList           *files_found = NULL; /* contains the matching files in this folder only */
-  const gchar *namespace;
+  GFileType    type;
   const gchar *display_name;
   gchar       *display_name_c; /* converted to ignore case */
 
+  /* respect last-show-hidden */
+  if (show_hidden == FALSE)
+    {
+      /* same logic as thunar_file_is_hidden() */
+      if (g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN)
+          || g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP))
+        {
+          g_object_unref (file);
+          g_object_unref (info);
+          return files_found;
+        }
+    }
+
+  type = g_file_info_get_file_type (info);
+
+  /* handle directories */
+  if (type == G_FILE_TYPE_DIRECTORY && search_type == THUNAR_TREE_VIEW_MODEL_SEARCH_RECURSIVE)
+    {
+      gchar *file_uri = g_file_get_uri (file);
+      _thunar_search_folder (model, job, file_uri, search_query_c_terms, search_type, show_hidden);
+      g_free (file_uri);
+    }
+
+  /* prepare entry display name */
+  display_name = g_file_info_get_display_name (info);
+  display_name_c = thunar_g_utf8_normalize_for_search (display_name, TRUE, TRUE);
+
+  /* search for all substrings */
+  if (thunar_util_search_terms_match (search_query_c_terms, display_name_c))
+    files_found = g_list_prepend (files_found, thunar_file_get (file, NULL));
+
+  /* free memory */
+  g_free (display_name_c);
+  g_object_unref (file);
+  g_object_unref (info);
+
+  return files_found;
+}
+
+
+
+static void
+_thunar_search_folder (ThunarTreeViewModel           *model,
+                       ThunarJob                     *job,
+                       gchar                         *uri,
+                       gchar                        **search_query_c_terms,
+                       enum ThunarTreeViewModelSearch search_type,
+                       gboolean                       show_hidden)
+{
+  GCancellable        *cancellable;
+  GFileEnumerator     *enumerator;
+  GFile               *directory;
+  GList               *files_found = NULL; /* contains the matching files in this folder only */
+  GArray              *items = NULL;
+  ThunarFileInfoEntry *entry;
+  const gchar         *namespace;
+  guint                n;
+
   cancellable = thunar_job_get_cancellable (THUNAR_JOB (job));
   directory = g_file_new_for_uri (uri);
   namespace = G_FILE_ATTRIBUTE_STANDARD_TYPE "," G_FILE_ATTRIBUTE_STANDARD_TARGET_URI "," G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME "," G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP "," G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN "," G_FILE_ATTRIBUTE_STANDARD_NAME ", recent::*";
@@ -1668,67 +2588,53 @@ _thunar_search_folder (ThunarTreeViewModel           *model,
       return;
     }
 
+  /* the targets of `recent:///` are resolved together, see thunar_io_scan_recent_targets() */
+  if (g_file_has_uri_scheme (directory, "recent"))
+    items = g_array_new (FALSE, TRUE, sizeof (ThunarFileInfoEntry));
+
   /* go through every file in the folder and check if it matches */
   while (thunar_job_is_cancelled (THUNAR_JOB (job)) == FALSE)
     {
       GFile     *file;
       GFileInfo *info;
-      GFileType  type;
 
       /* get GFile and GFileInfo */
       info = g_file_enumerator_next_file (enumerator, cancellable, NULL);
       if (G_UNLIKELY (info == NULL))
         break;
 
-      if (g_file_has_uri_scheme (directory, "recent"))
+      if (items != NULL)
         {
-          file = g_file_new_for_uri (g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_STANDARD_TARGET_URI));
-          g_object_unref (info);
-          info = g_file_query_info (file, namespace, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS, cancellable, NULL);
-          if (G_UNLIKELY (info == NULL))
-            {
-              g_object_unref (file);
-              break;
-            }
+          g_array_set_size (items, items->len + 1);
+          g_array_index (items, ThunarFileInfoEntry, items->len - 1).recent_info = info;
+          continue;
         }
-      else
-        file = g_file_get_child (directory, g_file_info_get_name (info));
 
-      /* respect last-show-hidden */
-      if (show_hidden == FALSE)
-        {
-          /* same logic as thunar_file_is_hidden() */
-          if (g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN)
-              || g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP))
-            {
-              g_object_unref (file);
-              g_object_unref (info);
-              continue;
-            }
-        }
+      file = g_file_get_child (directory, g_file_info_get_name (info));
+      files_found = _thunar_search_folder_match (model, job, file, info, search_query_c_terms,
+                                                 search_type, show_hidden, files_found);
+    }
 
-      type = g_file_info_get_file_type (info);
+  if (items != NULL)
+    {
+      thunar_io_scan_recent_targets (job, (ThunarFileInfoEntry *) items->data, items->len,
+                                     namespace, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS);
 
-      /* handle directories */
-      if (type == G_FILE_TYPE_DIRECTORY && search_type == THUNAR_TREE_VIEW_MODEL_SEARCH_RECURSIVE)
+      for (n = 0; n < items->len; ++n)
         {
-          gchar *file_uri = g_file_get_uri (file);
-          _thunar_search_folder (model, job, file_uri, search_query_c_terms, search_type, show_hidden);
-          g_free (file_uri);
+          entry = &g_array_index (items, ThunarFileInfoEntry, n);
+          if (entry->gfile != NULL && !thunar_job_is_cancelled (THUNAR_JOB (job)))
+            files_found = _thunar_search_folder_match (model, job, entry->gfile, entry->info, search_query_c_terms,
+                                                       search_type, show_hidden, files_found);
+          else if (entry->gfile != NULL)
+            {
+              g_object_unref (entry->gfile);
+              g_object_unref (entry->info);
+            }
+          g_object_unref (entry->recent_info);
         }
 
-      /* prepare entry display name */
-      display_name = g_file_info_get_display_name (info);
-      display_name_c = thunar_g_utf8_normalize_for_search (display_name, TRUE, TRUE);
-
-      /* search for all substrings */
-      if (thunar_util_search_terms_match (search_query_c_terms, display_name_c))
-        files_found = g_list_prepend (files_found, thunar_file_get (file, NULL));
-
-      /* free memory */
-      g_free (display_name_c);
-      g_object_unref (file);
-      g_object_unref (info);
+      g_array_free (items, TRUE);
     }
 
   g_object_unref (enumerator);
@@ -1799,6 +2705,7 @@ thunar_io_jobs_search_directory (ThunarTreeViewModel *model,
   ThunarPreferences        *preferences;
   ThunarRecursiveSearchMode mode;
   gboolean                  show_hidden;
+  ThunarJob                *job;
 
   preferences = thunar_preferences_get ();
 
@@ -1807,12 +2714,15 @@ thunar_io_jobs_search_directory (ThunarTreeViewModel *model,
   g_object_get (G_OBJECT (preferences), "last-show-hidden", &show_hidden, NULL);
 
   g_object_unref (preferences);
-  return thunar_simple_job_new (_thunar_job_search_directory, 5,
-                                THUNAR_TYPE_TREE_VIEW_MODEL, model,
-                                G_TYPE_STRING, search_query,
-                                THUNAR_TYPE_FILE, directory,
-                                G_TYPE_ENUM, mode,
-                                G_TYPE_BOOLEAN, show_hidden);
+  job = thunar_simple_job_new (_thunar_job_search_directory, 5,
+                               THUNAR_TYPE_TREE_VIEW_MODEL, model,
+                               G_TYPE_STRING, search_query,
+                               THUNAR_TYPE_FILE, directory,
+                               G_TYPE_ENUM, mode,
+                               G_TYPE_BOOLEAN, show_hidden);
+  thunar_job_set_priority (job, THUNAR_JOB_PRIORITY_BACKGROUND);
+
+  return job;
 }
 
 
@@ -2057,6 +2967,7 @@ thunar_io_jobs_load_content_types (GHashTable *files)
 
   ThunarJob *job = thunar_simple_job_new (_thunar_job_load_content_types, 1,
                                           THUNAR_TYPE_G_FILE_HASH_TABLE, g_files);
+  thunar_job_set_priority (job, THUNAR_JOB_PRIORITY_BACKGROUND);
 
   g_signal_connect (job, "finished", G_CALLBACK (thunar_io_jobs_load_content_types_finished), g_files);
 
@@ -2159,6 +3070,7 @@ thunar_io_jobs_check_empty (GHashTable *map)
   ThunarJob *job = thunar_simple_job_new (_thunar_job_check_empty, 2,
                                           G_TYPE_POINTER, map,
                                           G_TYPE_POINTER, g_file_map);
+  thunar_job_set_priority (job, THUNAR_JOB_PRIORITY_BACKGROUND);
 
   return job;
 }
@@ -2287,6 +3199,7 @@ thunar_io_jobs_load_statusbar_text_for_folder (ThunarStandardView *standard_view
                                           THUNAR_TYPE_DATE_STYLE, date_style,
                                           G_TYPE_STRING, date_custom_style,
                                           G_TYPE_UINT, status_bar_active_info);
+  thunar_job_set_priority (job, THUNAR_JOB_PRIORITY_VISIBLE);
   g_free (date_custom_style);
   g_hash_table_destroy (g_files);
 
@@ -2294,37 +3207,3 @@ thunar_io_jobs_load_statusbar_text_for_folder (ThunarStandardView *standard_view
   g_signal_connect_swapped (job, "finished", G_CALLBACK (g_object_unref), standard_view);
   return job;
 }
-
-
-
-ThunarJob *
-thunar_io_jobs_load_statusbar_text_for_selection (ThunarStandardView *standard_view, GHashTable *selected_g_files)
-{
-  ThunarPreferences *preferences;
-  gboolean           show_hidden;
-  gboolean           show_file_size_binary_format;
-  ThunarDateStyle    date_style;
-  gchar             *date_custom_style;
-  guint              status_bar_active_info;
-
-  preferences = thunar_preferences_get ();
-  g_object_get (G_OBJECT (preferences), "last-show-hidden", &show_hidden,
-                "misc-date-style", &date_style,
-                "misc-date-custom-style", &date_custom_style,
-                "misc-file-size-binary", &show_file_size_binary_format,
-                "misc-status-bar-active-info", &status_bar_active_info, NULL);
-
-  ThunarJob *job = thunar_simple_job_new (_thunar_job_load_statusbar_text, 8,
-                                          THUNAR_TYPE_STANDARD_VIEW, g_object_ref (standard_view),
-                                          THUNAR_TYPE_FILE, NULL,
-                                          THUNAR_TYPE_G_FILE_HASH_TABLE, selected_g_files,
-                                          G_TYPE_BOOLEAN, show_hidden,
-                                          G_TYPE_BOOLEAN, show_file_size_binary_format,
-                                          THUNAR_TYPE_DATE_STYLE, date_style,
-                                          G_TYPE_STRING, date_custom_style,
-                                          G_TYPE_UINT, status_bar_active_info);
-  g_free (date_custom_style);
-
-  g_signal_connect_swapped (job, "finished", G_CALLBACK (g_object_unref), standard_view);
-  return job;
-}
@@ -86,9 +86,6 @@ thunar_io_jobs_check_empty (GHashTable *files) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_
 ThunarJob *
 thunar_io_jobs_load_statusbar_text_for_folder (ThunarStandardView *standard_view,
                                                ThunarFolder       *folder);
-ThunarJob *
-thunar_io_jobs_load_statusbar_text_for_selection (ThunarStandardView *standard_view,
-                                                  GHashTable         *selected_g_files);
 G_END_DECLS
 
 #endif /* !__THUNAR_IO_JOBS_H__ */
@@ -26,6 +26,720 @@
 #include <gio/gio.h>
 
 
+
+/* number of scanned files which are added to the file cache at once */
+#define THUNAR_IO_SCAN_BATCH_SIZE (256)
+
+/* number of file infos requested from a remote backend at once */
+#define THUNAR_IO_SCAN_REMOTE_BATCH_SIZE (1024)
+
+
+
+/* number of targets of `recent:///` items which are queried at the same time */
+#define THUNAR_IO_SCAN_RECENT_MAX_PENDING (16)
+
+/* time (in ms) after which a target is shown as placeholder, e.g. on a dead mount */
+#define THUNAR_IO_SCAN_RECENT_TIMEOUT (2000)
+
+/* time (in us) for which resolved and unreachable targets are cached */
+#define THUNAR_IO_SCAN_RECENT_CACHE_TTL             (5 * 60 * G_USEC_PER_SEC)
+#define THUNAR_IO_SCAN_RECENT_CACHE_TTL_UNREACHABLE (30 * G_USEC_PER_SEC)
+
+/* maximum number of cached targets */
+#define THUNAR_IO_SCAN_RECENT_CACHE_SIZE (4096)
+
+
+
+/* state of a pending g_file_enumerator_next_files_async() request */
+typedef struct
+{
+  GMainContext *context;
+  GList        *infos;
+  GError       *error;
+  gboolean      done;
+} ThunarIoScanRequest;
+
+typedef struct _ThunarIoScanRecentScan ThunarIoScanRecentScan;
+
+/* state of the target query of a `recent:///` item */
+typedef struct
+{
+  ThunarIoScanRecentScan *scan;
+  ThunarFileInfoEntry    *entry;
+  GCancellable           *cancellable;
+  GSource                *timeout;
+  gchar                  *cache_key;
+  gboolean                in_flight;
+  gboolean                done;
+} ThunarIoScanRecentQuery;
+
+/* state of the target queries of one listing of `recent:///`, it is released
+ * once the callbacks of all queries ran, which can be after the listing */
+struct _ThunarIoScanRecentScan
+{
+  GMainContext            *context;
+  ThunarIoScanRecentQuery *queries;
+  guint                    n_queries;
+
+  /* queries which are neither finished nor timed out */
+  guint n_pending;
+
+  /* queries whose callback did not run yet, including the timed out ones */
+  guint n_in_flight;
+};
+
+/* cached target of a `recent:///` item, info is NULL for unreachable targets */
+typedef struct
+{
+  GFileInfo *info;
+  gboolean   not_mounted;
+  gint64     expires;
+} ThunarIoScanRecentTarget;
+
+
+
+G_LOCK_DEFINE_STATIC (recent_cache);
+static GHashTable *recent_cache = NULL;
+
+/* scans whose queries are stuck beyond the listing, see thunar_io_scan_recent_scan_release() */
+G_LOCK_DEFINE_STATIC (recent_stuck_scans);
+static GSList *recent_stuck_scans = NULL;
+
+
+
+/* adds the batched files to the file cache and prepends them to @files */
+static GList *
+thunar_io_scan_directory_flush (ThunarFileInfoEntry *batch,
+                                guint               *n_batch,
+                                GList               *files)
+{
+  guint n;
+
+  thunar_file_get_with_infos (batch, *n_batch);
+
+  for (n = 0; n < *n_batch; ++n)
+    {
+      /* the list takes the reference of the file */
+      files = g_list_prepend (files, batch[n].file);
+
+      g_object_unref (batch[n].gfile);
+      g_object_unref (batch[n].info);
+      if (batch[n].recent_info != NULL)
+        g_object_unref (batch[n].recent_info);
+    }
+
+  *n_batch = 0;
+
+  return files;
+}
+
+
+
+static void
+thunar_io_scan_directory_next_files_ready (GObject      *object,
+                                           GAsyncResult *result,
+                                           gpointer      user_data)
+{
+  ThunarIoScanRequest *request = user_data;
+
+  request->infos = g_file_enumerator_next_files_finish (G_FILE_ENUMERATOR (object), result, &request->error);
+  request->done = TRUE;
+}
+
+
+
+static void
+thunar_io_scan_directory_next_files (GFileEnumerator     *enumerator,
+                                     GCancellable        *cancellable,
+                                     ThunarIoScanRequest *request)
+{
+  request->done = FALSE;
+  g_file_enumerator_next_files_async (enumerator, THUNAR_IO_SCAN_REMOTE_BATCH_SIZE,
+                                      G_PRIORITY_DEFAULT, cancellable,
+                                      thunar_io_scan_directory_next_files_ready, request);
+}
+
+
+
+/* scans a remote folder (non-recursively). The infos are requested from the backend in large
+ * batches and the next batch is already in flight while the previous one is turned into files,
+ * so the round trips to the server overlap with the work on our side */
+static GList *
+thunar_io_scan_directory_remote (ThunarJob       *job,
+                                 GFile           *file,
+                                 GFileEnumerator *enumerator,
+                                 gboolean         return_thunar_files,
+                                 guint           *n_files_max,
+                                 GCancellable    *cancellable,
+                                 GError         **error)
+{
+  ThunarIoScanRequest  request = { NULL, };
+  ThunarFileInfoEntry *batch = NULL;
+  guint                n_batch = 0;
+  GFileInfo           *info;
+  GFile               *child_file;
+  GList               *infos;
+  GList               *files = NULL;
+  GList               *lp;
+  gboolean             pending;
+
+  /* the async results are dispatched in this (worker) thread */
+  request.context = g_main_context_new ();
+  g_main_context_push_thread_default (request.context);
+
+  if (return_thunar_files)
+    batch = g_new (ThunarFileInfoEntry, THUNAR_IO_SCAN_BATCH_SIZE);
+
+  thunar_io_scan_directory_next_files (enumerator, cancellable, &request);
+  for (pending = TRUE; pending;)
+    {
+      while (!request.done)
+        g_main_context_iteration (request.context, TRUE);
+
+      /* stop at the end of the enumerator or on errors (including cancellation) */
+      infos = g_steal_pointer (&request.infos);
+      if (infos == NULL || request.error != NULL)
+        {
+          g_list_free_full (infos, g_object_unref);
+          break;
+        }
+
+      /* keep the next request in flight, unless we already have enough files */
+      pending = (n_files_max == NULL || *n_files_max > g_list_length (infos));
+      if (pending && (job == NULL || !thunar_job_is_cancelled (THUNAR_JOB (job))))
+        thunar_io_scan_directory_next_files (enumerator, cancellable, &request);
+      else
+        pending = FALSE;
+
+      for (lp = infos; lp != NULL; lp = lp->next)
+        {
+          info = G_FILE_INFO (lp->data);
+
+          if (G_UNLIKELY (n_files_max != NULL))
+            {
+              if (*n_files_max == 0)
+                break;
+              else
+                (*n_files_max)--;
+            }
+
+          child_file = g_file_get_child (file, g_file_info_get_name (info));
+
+          if (return_thunar_files)
+            {
+              /* Queue the ThunarFile, the batch takes the references */
+              batch[n_batch].gfile = child_file;
+              batch[n_batch].info = g_object_ref (info);
+              batch[n_batch].recent_info = NULL;
+              batch[n_batch].not_mounted = FALSE;
+              batch[n_batch].file = NULL;
+
+              if (++n_batch == THUNAR_IO_SCAN_BATCH_SIZE)
+                files = thunar_io_scan_directory_flush (batch, &n_batch, files);
+            }
+          else
+            {
+              /* the list takes the reference of the file */
+              files = g_list_prepend (files, child_file);
+            }
+        }
+
+      g_list_free_full (infos, g_object_unref);
+    }
+
+  /* add the remaining files */
+  if (batch != NULL)
+    {
+      files = thunar_io_scan_directory_flush (batch, &n_batch, files);
+      g_free (batch);
+    }
+
+  g_main_context_pop_thread_default (request.context);
+  g_main_context_unref (request.context);
+
+  if (G_UNLIKELY (request.error != NULL))
+    {
+      g_propagate_error (error, request.error);
+      thunar_g_list_free_full (files);
+      return NULL;
+    }
+
+  return files;
+}
+
+
+
+static void
+thunar_io_scan_recent_target_free (gpointer data)
+{
+  ThunarIoScanRecentTarget *target = data;
+
+  if (target->info != NULL)
+    g_object_unref (target->info);
+  g_slice_free (ThunarIoScanRecentTarget, target);
+}
+
+
+
+/* the info shown for a target which could not be queried, based on the info of the `recent:///` item */
+static GFileInfo *
+thunar_io_scan_recent_placeholder (GFileInfo *recent_info)
+{
+  GFileInfo *info;
+
+  info = g_file_info_dup (recent_info);
+  if (!g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_TYPE))
+    g_file_info_set_file_type (info, G_FILE_TYPE_REGULAR);
+
+  return info;
+}
+
+
+
+/* looks up the cached info of a target, returns FALSE if it needs to be queried */
+static gboolean
+thunar_io_scan_recent_cache_lookup (const gchar         *cache_key,
+                                    ThunarFileInfoEntry *entry)
+{
+  ThunarIoScanRecentTarget *target = NULL;
+
+  G_LOCK (recent_cache);
+
+  if (recent_cache != NULL)
+    target = g_hash_table_lookup (recent_cache, cache_key);
+
+  if (target != NULL && target->expires < g_get_monotonic_time ())
+    {
+      g_hash_table_remove (recent_cache, cache_key);
+      target = NULL;
+    }
+
+  if (target != NULL)
+    {
+      /* the files may change their info, so every file gets its own copy */
+      entry->info = target->info != NULL ? g_file_info_dup (target->info) : thunar_io_scan_recent_placeholder (entry->recent_info);
+      entry->not_mounted = target->not_mounted;
+    }
+
+  G_UNLOCK (recent_cache);
+
+  return target != NULL;
+}
+
+
+
+static void
+thunar_io_scan_recent_cache_insert (const gchar *cache_key,
+                                    GFileInfo   *info,
+                                    gboolean     not_mounted)
+{
+  ThunarIoScanRecentTarget *target;
+
+  target = g_slice_new (ThunarIoScanRecentTarget);
+  target->info = info != NULL ? g_file_info_dup (info) : NULL;
+  target->not_mounted = not_mounted;
+  target->expires = g_get_monotonic_time () + (info != NULL ? THUNAR_IO_SCAN_RECENT_CACHE_TTL : THUNAR_IO_SCAN_RECENT_CACHE_TTL_UNREACHABLE);
+
+  G_LOCK (recent_cache);
+
+  if (G_UNLIKELY (recent_cache == NULL))
+    recent_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, thunar_io_scan_recent_target_free);
+
+  /* a simple bound is enough here, the recent files store is limited anyway */
+  if (g_hash_table_size (recent_cache) >= THUNAR_IO_SCAN_RECENT_CACHE_SIZE)
+    g_hash_table_remove_all (recent_cache);
+
+  g_hash_table_replace (recent_cache, g_strdup (cache_key), target);
+
+  G_UNLOCK (recent_cache);
+}
+
+
+
+/* finishes a query, either with the queried @info or as placeholder */
+static void
+thunar_io_scan_recent_query_done (ThunarIoScanRecentQuery *query,
+                                  GFileInfo               *info,
+                                  gboolean                 not_mounted,
+                                  gboolean                 cache)
+{
+  query->done = TRUE;
+  query->scan->n_pending--;
+
+  if (query->timeout != NULL)
+    {
+      g_source_destroy (query->timeout);
+      g_source_unref (query->timeout);
+      query->timeout = NULL;
+    }
+
+  if (cache)
+    thunar_io_scan_recent_cache_insert (query->cache_key, info, not_mounted);
+
+  query->entry->info = info != NULL ? g_object_ref (info) : thunar_io_scan_recent_placeholder (query->entry->recent_info);
+  query->entry->not_mounted = not_mounted;
+}
+
+
+
+static void
+thunar_io_scan_recent_query_ready (GObject      *object,
+                                   GAsyncResult *result,
+                                   gpointer      user_data)
+{
+  ThunarIoScanRecentQuery *query = user_data;
+  GFileInfo               *info;
+  GError                  *error = NULL;
+
+  info = g_file_query_info_finish (G_FILE (object), result, &error);
+
+  query->in_flight = FALSE;
+  query->scan->n_in_flight--;
+
+  /* the query already timed out, a cancelled query (e.g. of a cancelled job) says nothing about the target */
+  if (!query->done)
+    thunar_io_scan_recent_query_done (query, info, g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_MOUNTED),
+                                      !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED));
+
+  if (info != NULL)
+    g_object_unref (info);
+  g_clear_error (&error);
+}
+
+
+
+static gboolean
+thunar_io_scan_recent_query_timeout (gpointer user_data)
+{
+  ThunarIoScanRecentQuery *query = user_data;
+
+  /* the source is destroyed by the caller, see thunar_io_scan_recent_query_done(). The
+   * query stays in flight until its callback ran, the target is cached as unreachable */
+  g_cancellable_cancel (query->cancellable);
+  thunar_io_scan_recent_query_done (query, NULL, FALSE, TRUE);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+
+static gboolean
+thunar_io_scan_recent_grace_timeout (gpointer user_data)
+{
+  gboolean *expired = user_data;
+
+  *expired = TRUE;
+
+  return G_SOURCE_REMOVE;
+}
+
+
+
+static void
+thunar_io_scan_recent_scan_free (ThunarIoScanRecentScan *scan)
+{
+  guint n;
+
+  for (n = 0; n < scan->n_queries; ++n)
+    {
+      if (scan->queries[n].cancellable != NULL)
+        g_object_unref (scan->queries[n].cancellable);
+      g_free (scan->queries[n].cache_key);
+    }
+  g_free (scan->queries);
+
+  g_main_context_unref (scan->context);
+  g_slice_free (ThunarIoScanRecentScan, scan);
+}
+
+
+
+/* dispatches the callbacks which arrived for scans released with stuck queries */
+static void
+thunar_io_scan_recent_drain_stuck_scans (void)
+{
+  ThunarIoScanRecentScan *scan;
+  GSList                 *scans;
+  GSList                 *lp;
+
+  G_LOCK (recent_stuck_scans);
+  scans = recent_stuck_scans;
+  recent_stuck_scans = NULL;
+  G_UNLOCK (recent_stuck_scans);
+
+  for (lp = scans; lp != NULL; lp = lp->next)
+    {
+      scan = lp->data;
+      while (scan->n_in_flight > 0 && g_main_context_iteration (scan->context, FALSE))
+        ;
+
+      if (scan->n_in_flight == 0)
+        {
+          thunar_io_scan_recent_scan_free (scan);
+          lp->data = NULL;
+        }
+    }
+  scans = g_slist_remove_all (scans, NULL);
+
+  G_LOCK (recent_stuck_scans);
+  recent_stuck_scans = g_slist_concat (scans, recent_stuck_scans);
+  G_UNLOCK (recent_stuck_scans);
+}
+
+
+
+/* cancels the queries still in flight and waits a while for their callbacks, the queries,
+ * their entries and the context must stay alive until then. Queries which are stuck beyond
+ * that (e.g. in a blocking stat() on a dead mount) keep the scan alive, and it is released
+ * by a later listing once their callbacks arrived */
+static void
+thunar_io_scan_recent_scan_release (ThunarIoScanRecentScan *scan)
+{
+  GSource *grace;
+  gboolean expired = FALSE;
+  guint    n;
+
+  for (n = 0; n < scan->n_queries; ++n)
+    if (scan->queries[n].in_flight)
+      g_cancellable_cancel (scan->queries[n].cancellable);
+
+  if (scan->n_in_flight > 0)
+    {
+      grace = g_timeout_source_new (THUNAR_IO_SCAN_RECENT_TIMEOUT);
+      g_source_set_callback (grace, thunar_io_scan_recent_grace_timeout, &expired, NULL);
+      g_source_attach (grace, scan->context);
+
+      while (scan->n_in_flight > 0 && !expired)
+        g_main_context_iteration (scan->context, TRUE);
+
+      g_source_destroy (grace);
+      g_source_unref (grace);
+    }
+
+  if (scan->n_in_flight == 0)
+    {
+      thunar_io_scan_recent_scan_free (scan);
+      return;
+    }
+
+  /* the entries belong to the caller, all queries are done so their callbacks won't touch them */
+  for (n = 0; n < scan->n_queries; ++n)
+    scan->queries[n].entry = NULL;
+
+  G_LOCK (recent_stuck_scans);
+  recent_stuck_scans = g_slist_prepend (recent_stuck_scans, scan);
+  G_UNLOCK (recent_stuck_scans);
+}
+
+
+
+/**
+ * thunar_io_scan_recent_targets:
+ * @job       : a #ThunarJob instance or %NULL.
+ * @entries   : an array of #ThunarFileInfoEntry<!---->s, with the infos of `recent:///` items as @recent_info.
+ * @n_entries : the number of @entries.
+ * @namespace : the attributes to query for the targets.
+ * @flags     : the #GFileQueryInfoFlags for the targets.
+ *
+ * Sets the @gfile and @info of the @entries to the target of their `recent:///` item.
+ * Several targets are queried at the same time, and targets which cannot be queried in
+ * time (e.g. on a dead mount) get a placeholder info based on the @recent_info. The
+ * results are cached for a while, so the next listing of `recent:///` does not need
+ * to query them again.
+ *
+ * Entries without a target are left untouched, their @gfile is %NULL.
+ **/
+void
+thunar_io_scan_recent_targets (ThunarJob           *job,
+                               ThunarFileInfoEntry *entries,
+                               guint                n_entries,
+                               const gchar         *namespace,
+                               GFileQueryInfoFlags  flags)
+{
+  ThunarIoScanRecentScan  *scan;
+  ThunarIoScanRecentQuery *query;
+  const gchar             *target_uri;
+  guint                    n;
+  guint                    i;
+
+  _thunar_return_if_fail (entries != NULL || n_entries == 0);
+
+  thunar_io_scan_recent_drain_stuck_scans ();
+
+  /* the async results are dispatched in this (worker) thread */
+  scan = g_slice_new0 (ThunarIoScanRecentScan);
+  scan->context = g_main_context_new ();
+  scan->queries = g_new0 (ThunarIoScanRecentQuery, n_entries);
+  scan->n_queries = n_entries;
+  g_main_context_push_thread_default (scan->context);
+
+  for (n = 0;;)
+    {
+      /* keep a number of queries in flight */
+      for (; n < n_entries && scan->n_pending < THUNAR_IO_SCAN_RECENT_MAX_PENDING; ++n)
+        {
+          if (job != NULL && thunar_job_is_cancelled (THUNAR_JOB (job)))
+            break;
+
+          target_uri = g_file_info_get_attribute_string (entries[n].recent_info, G_FILE_ATTRIBUTE_STANDARD_TARGET_URI);
+          if (G_UNLIKELY (target_uri == NULL))
+            continue;
+
+          query = &scan->queries[n];
+          query->scan = scan;
+          query->entry = &entries[n];
+          query->entry->gfile = g_file_new_for_uri (target_uri);
+          query->cache_key = g_strdup_printf ("%s:%x:%s", namespace, flags, target_uri);
+
+          if (thunar_io_scan_recent_cache_lookup (query->cache_key, query->entry))
+            continue;
+
+          query->cancellable = g_cancellable_new ();
+          query->timeout = g_timeout_source_new (THUNAR_IO_SCAN_RECENT_TIMEOUT);
+          g_source_set_callback (query->timeout, thunar_io_scan_recent_query_timeout, query, NULL);
+          g_source_attach (query->timeout, scan->context);
+          query->in_flight = TRUE;
+          scan->n_pending++;
+          scan->n_in_flight++;
+
+          g_file_query_info_async (query->entry->gfile, namespace, flags, G_PRIORITY_DEFAULT,
+                                   query->cancellable, thunar_io_scan_recent_query_ready, query);
+        }
+
+      if (job != NULL && thunar_job_is_cancelled (THUNAR_JOB (job)))
+        {
+          /* no need to wait for the timeouts of the pending queries */
+          for (i = 0; i < n; ++i)
+            if (scan->queries[i].in_flight && !scan->queries[i].done)
+              g_cancellable_cancel (scan->queries[i].cancellable);
+
+          if (scan->n_pending == 0)
+            break;
+        }
+      else if (scan->n_pending == 0 && n == n_entries)
+        break;
+
+      g_main_context_iteration (scan->context, TRUE);
+    }
+
+  /* entries which were not queried because the job was cancelled */
+  for (n = 0; n < n_entries; ++n)
+    if (entries[n].gfile != NULL && entries[n].info == NULL)
+      entries[n].info = thunar_io_scan_recent_placeholder (entries[n].recent_info);
+
+  g_main_context_pop_thread_default (scan->context);
+  thunar_io_scan_recent_scan_release (scan);
+}
+
+
+
+/* lists `recent:///` (non-recursively), resolving the targets of the items concurrently */
+static GList *
+thunar_io_scan_directory_recent (ThunarJob          *job,
+                                 GFileEnumerator    *enumerator,
+                                 const gchar        *namespace,
+                                 GFileQueryInfoFlags flags,
+                                 gboolean            return_thunar_files,
+                                 guint              *n_files_max,
+                                 GCancellable       *cancellable,
+                                 GError            **error)
+{
+  ThunarFileInfoEntry *entries;
+  GFileInfo           *info;
+  GArray              *items;
+  GList               *files = NULL;
+  GError              *err = NULL;
+  guint                n_entries;
+  guint                n_targets;
+  guint                n;
+
+  items = g_array_new (FALSE, TRUE, sizeof (ThunarFileInfoEntry));
+
+  while (job == NULL || !thunar_job_is_cancelled (THUNAR_JOB (job)))
+    {
+      info = g_file_enumerator_next_file (enumerator, cancellable, &err);
+
+      /* skip broken items, like thunar_io_scan_directory() does for other folders */
+      if (G_UNLIKELY (err != NULL && g_error_matches (err, G_IO_ERROR, G_IO_ERROR_FAILED)))
+        {
+          g_warning ("Error while scanning recent files: %s", err->message);
+          g_clear_error (&err);
+          if (info != NULL)
+            g_object_unref (info);
+          continue;
+        }
+
+      if (info == NULL || err != NULL)
+        {
+          if (info != NULL)
+            g_object_unref (info);
+          break;
+        }
+
+      if (G_UNLIKELY (n_files_max != NULL))
+        {
+          if (*n_files_max == 0)
+            {
+              g_object_unref (info);
+              break;
+            }
+          else
+            (*n_files_max)--;
+        }
+
+      g_array_set_size (items, items->len + 1);
+      g_array_index (items, ThunarFileInfoEntry, items->len - 1).recent_info = info;
+    }
+
+  n_entries = items->len;
+  entries = (ThunarFileInfoEntry *) g_array_free (items, FALSE);
+
+  if (err == NULL)
+    thunar_io_scan_recent_targets (job, entries, n_entries, namespace, flags);
+
+  /* drop the items without a target */
+  for (n = 0, n_targets = 0; n < n_entries; ++n)
+    {
+      if (entries[n].gfile != NULL)
+        entries[n_targets++] = entries[n];
+      else
+        g_object_unref (entries[n].recent_info);
+    }
+  n_entries = n_targets;
+
+  if (return_thunar_files)
+    {
+      /* the entries take the references, like the batches of thunar_io_scan_directory() */
+      for (n = 0; n < n_entries; n += THUNAR_IO_SCAN_BATCH_SIZE)
+        {
+          guint n_batch = MIN (THUNAR_IO_SCAN_BATCH_SIZE, n_entries - n);
+          files = thunar_io_scan_directory_flush (entries + n, &n_batch, files);
+        }
+    }
+  else
+    {
+      /* the list takes the references of the GFiles */
+      for (n = 0; n < n_entries; ++n)
+        {
+          files = g_list_prepend (files, entries[n].gfile);
+          g_object_unref (entries[n].info);
+          g_object_unref (entries[n].recent_info);
+        }
+    }
+
+  g_free (entries);
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_propagate_error (error, err);
+      return NULL;
+    }
+
+  return files;
+}
+
+
+
 /**
  * thunar_io_scan_directory:
  * @job                 : a #ThunarJob instance
@@ -60,9 +774,10 @@ thunar_io_scan_directory (ThunarJob          *job,
   GList           *child_files = NULL;
   GList           *files = NULL;
   const gchar *namespace;
-  ThunarFile   *thunar_file;
-  gboolean      is_mounted;
-  GCancellable *cancellable = NULL;
+  ThunarFileInfoEntry *batch = NULL;
+  guint                n_batch = 0;
+  gboolean             is_mounted;
+  GCancellable        *cancellable = NULL;
 
   _thunar_return_val_if_fail (G_IS_FILE (file), NULL);
   _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
@@ -113,6 +828,54 @@ thunar_io_scan_directory (ThunarJob          *job,
       return NULL;
     }
 
+  /* resolve the targets of `recent:///` concurrently, see above */
+  if (!recursively && g_file_has_uri_scheme (file, "recent"))
+    {
+      files = thunar_io_scan_directory_recent (job, enumerator, namespace, flags, return_thunar_files,
+                                               n_files_max, cancellable, &err);
+      g_object_unref (enumerator);
+
+      if (G_UNLIKELY (err != NULL))
+        {
+          g_propagate_error (error, err);
+          return NULL;
+        }
+      else if (job != NULL && thunar_job_set_error_if_cancelled (THUNAR_JOB (job), &err))
+        {
+          g_propagate_error (error, err);
+          thunar_g_list_free_full (files);
+          return NULL;
+        }
+
+      return files;
+    }
+
+  /* pipeline the listing of remote folders (sftp://, smb://, ...), see above */
+  if (!recursively && !g_file_is_native (file) && !g_file_has_uri_scheme (file, "recent"))
+    {
+      files = thunar_io_scan_directory_remote (job, file, enumerator, return_thunar_files,
+                                               n_files_max, cancellable, &err);
+      g_object_unref (enumerator);
+
+      if (G_UNLIKELY (err != NULL))
+        {
+          g_propagate_error (error, err);
+          return NULL;
+        }
+      else if (job != NULL && thunar_job_set_error_if_cancelled (THUNAR_JOB (job), &err))
+        {
+          g_propagate_error (error, err);
+          thunar_g_list_free_full (files);
+          return NULL;
+        }
+
+      return files;
+    }
+
+  /* the ThunarFiles are created in batches, to lock the file cache less often */
+  if (return_thunar_files)
+    batch = g_new (ThunarFileInfoEntry, THUNAR_IO_SCAN_BATCH_SIZE);
+
   /* iterate over children one by one */
   while (job == NULL || !thunar_job_is_cancelled (THUNAR_JOB (job)))
     {
@@ -190,10 +953,16 @@ thunar_io_scan_directory (ThunarJob          *job,
 
       if (return_thunar_files)
         {
-          /* Prepend the ThunarFile */
-          thunar_file = thunar_file_get_with_info (child_file, info, recent_info, !is_mounted);
-          files = thunar_g_list_prepend_deep (files, thunar_file);
-          g_object_unref (G_OBJECT (thunar_file));
+          /* Queue the ThunarFile, the batch takes the references */
+          batch[n_batch].gfile = g_object_ref (child_file);
+          batch[n_batch].info = g_object_ref (info);
+          batch[n_batch].recent_info = recent_info;
+          batch[n_batch].not_mounted = !is_mounted;
+          batch[n_batch].file = NULL;
+          recent_info = NULL;
+
+          if (++n_batch == THUNAR_IO_SCAN_BATCH_SIZE)
+            files = thunar_io_scan_directory_flush (batch, &n_batch, files);
         }
       else
         {
@@ -206,6 +975,10 @@ thunar_io_scan_directory (ThunarJob          *job,
           && is_mounted
           && g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
         {
+          /* keep the order of the list, the children come first */
+          if (n_batch > 0)
+            files = thunar_io_scan_directory_flush (batch, &n_batch, files);
+
           child_files = thunar_io_scan_directory (job, child_file, flags, recursively,
                                                   unlinking, return_thunar_files, n_files_max, &err);
 
@@ -218,6 +991,13 @@ thunar_io_scan_directory (ThunarJob          *job,
       g_object_unref (info);
     }
 
+  /* add the remaining files */
+  if (batch != NULL)
+    {
+      files = thunar_io_scan_directory_flush (batch, &n_batch, files);
+      g_free (batch);
+    }
+
   /* release the enumerator */
   g_object_unref (enumerator);
 
@@ -21,6 +21,7 @@
 #ifndef __THUNAR_IO_SCAN_DIRECTORY_H__
 #define __THUNAR_IO_SCAN_DIRECTORY_H__
 
+#include "thunar/thunar-file.h"
 #include "thunar/thunar-job.h"
 #include "thunar/thunar-private.h"
 
@@ -36,6 +37,13 @@ thunar_io_scan_directory (ThunarJob          *job,
                           guint              *n_files_max,
                           GError            **error);
 
+void
+thunar_io_scan_recent_targets (ThunarJob           *job,
+                               ThunarFileInfoEntry *entries,
+                               guint                n_entries,
+                               const gchar         *namespace,
+                               GFileQueryInfoFlags  flags);
+
 G_END_DECLS
 
 #endif /* !__THUNAR_IO_SCAN_DIRECTORY_H__ */
@@ -16,6 +16,10 @@
  * this program; if not, see <http://www.gnu.org/licenses/>.
  */
 
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
 #include "thunar/thunar-job-operation-history.h"
 
 #include "thunar/thunar-dialogs.h"
@@ -24,6 +28,7 @@
 #include "thunar/thunar-preferences.h"
 #include "thunar/thunar-private.h"
 
+#include <glib/gstdio.h>
 #include <libxfce4ui/libxfce4ui.h>
 
 /**
@@ -31,8 +36,22 @@
  * @Short_description: Manages the logging of job operations (copy, move etc.) and undoing and redoing them
  * @Title: ThunarJobOperationHistory
  *
- * The single #ThunarJobOperationHistory instance stores all job operations in a #GList
- * and manages tools to manage the list and the next/previous operations which can be undone/redone */
+ * The single #ThunarJobOperationHistory instance stores all job operations in a #GQueue
+ * and manages tools to manage the list and the next/previous operations which can be undone/redone
+ *
+ * If the "misc-undo-redo-history-persistent" preference is set, every change of the history
+ * is appended to a journal file in the user state directory. The journal is replayed and
+ * rewritten in compacted form on startup, so the history survives restarts. */
+
+/* journal record tags */
+#define JOURNAL_RECORD_COMMIT ('C') /* a serialized ThunarJobOperation follows */
+#define JOURNAL_RECORD_UNDO   ('U') /* the undo pointer moved back by one operation */
+#define JOURNAL_RECORD_REDO   ('R') /* the undo pointer moved forward by one operation */
+#define JOURNAL_RECORD_TRASH  ('T') /* new timestamps of the operation which can be undone follow */
+
+/* size of the record header: tag byte and payload length (32 bit, little endian) */
+#define JOURNAL_RECORD_HEADER_SIZE (5)
+
 
 /* property identifiers */
 enum
@@ -50,6 +69,12 @@ thunar_job_operation_history_get_property (GObject    *object,
                                            guint       prop_id,
                                            GValue     *value,
                                            GParamSpec *pspec);
+static void
+thunar_job_operation_history_journal_load (ThunarJobOperationHistory *history);
+static void
+thunar_job_operation_history_journal_append (ThunarJobOperationHistory *history,
+                                             guint8                     tag,
+                                             GByteArray                *payload);
 
 
 
@@ -57,8 +82,8 @@ struct _ThunarJobOperationHistory
 {
   GObject __parent__;
 
-  /* List of job operations which were logged */
-  GList *job_operation_list;
+  /* Queue of job operations which were logged, oldest first */
+  GQueue job_operation_list;
   gint   job_operation_list_max_size;
 
   /* since the job operation list, lp_undo and lp_redo all refer to the same memory locations,
@@ -70,6 +95,10 @@ struct _ThunarJobOperationHistory
 
   /* List pointer to the operation which can be redone */
   GList *lp_redo;
+
+  /* journal the history is persisted to, or %NULL */
+  gchar         *journal_path;
+  GOutputStream *journal;
 };
 
 static ThunarJobOperationHistory *job_operation_history;
@@ -110,16 +139,27 @@ static void
 thunar_job_operation_history_init (ThunarJobOperationHistory *self)
 {
   ThunarPreferences *preferences;
+  gboolean           persistent;
 
-  self->job_operation_list = NULL;
+  g_queue_init (&self->job_operation_list);
   self->lp_undo = NULL;
   self->lp_redo = NULL;
+  self->journal = NULL;
 
   preferences = thunar_preferences_get ();
-  g_object_get (G_OBJECT (preferences), "misc-undo-redo-history-size", &(self->job_operation_list_max_size), NULL);
+  g_object_get (G_OBJECT (preferences),
+                "misc-undo-redo-history-size", &(self->job_operation_list_max_size),
+                "misc-undo-redo-history-persistent", &persistent,
+                NULL);
   g_object_unref (preferences);
 
   g_mutex_init (&self->job_operation_list_mutex);
+
+  self->journal_path = g_build_filename (g_get_user_state_dir (), "Thunar", "undo-journal", NULL);
+  if (persistent)
+    thunar_job_operation_history_journal_load (self);
+  else
+    g_unlink (self->journal_path);
 }
 
 
@@ -131,7 +171,14 @@ thunar_job_operation_history_finalize (GObject *object)
 
   _thunar_return_if_fail (THUNAR_IS_JOB_OPERATION_HISTORY (history));
 
-  g_list_free_full (history->job_operation_list, g_object_unref);
+  if (history->journal != NULL)
+    {
+      g_output_stream_close (history->journal, NULL, NULL);
+      g_object_unref (history->journal);
+    }
+  g_free (history->journal_path);
+
+  g_queue_clear_full (&history->job_operation_list, g_object_unref);
 
   g_mutex_clear (&history->job_operation_list_mutex);
 
@@ -164,6 +211,262 @@ thunar_job_operation_history_get_property (GObject    *object,
 
 
 
+/* appends @job_operation to the history, dropping all operations which were undone
+ * before and the oldest operations exceeding the size limit. The caller has to hold the mutex */
+static void
+thunar_job_operation_history_push (ThunarJobOperationHistory *history,
+                                   ThunarJobOperation        *job_operation)
+{
+  GQueue *queue = &history->job_operation_list;
+  GList  *link;
+
+  /* When a new operation is added, drop all previous operations which were undone from the list */
+  while (history->lp_redo != NULL)
+    {
+      link = g_queue_peek_tail_link (queue);
+      if (link == history->lp_redo)
+        history->lp_redo = NULL;
+      g_object_unref (link->data);
+      g_queue_delete_link (queue, link);
+    }
+
+  /* Add the new operation to our list, we don't need the lookup tables of the operation anymore */
+  thunar_job_operation_compact (job_operation);
+  g_queue_push_tail (queue, g_object_ref (job_operation));
+
+  /* reset the undo pointer to latest operation */
+  history->lp_undo = g_queue_peek_tail_link (queue);
+
+  /* Limit the size of the list */
+  while (history->job_operation_list_max_size != -1 && queue->length > (guint) history->job_operation_list_max_size)
+    {
+      link = g_queue_peek_head_link (queue);
+      if (link == history->lp_undo)
+        history->lp_undo = NULL;
+      g_object_unref (link->data);
+      g_queue_delete_link (queue, link);
+    }
+}
+
+
+
+/* moves the undo/redo pointers one operation back. The caller has to hold the mutex */
+static gboolean
+thunar_job_operation_history_step_back (ThunarJobOperationHistory *history)
+{
+  if (history->lp_undo == NULL)
+    return FALSE;
+
+  history->lp_redo = history->lp_undo;
+  history->lp_undo = g_list_previous (history->lp_undo);
+  return TRUE;
+}
+
+
+
+/* moves the undo/redo pointers one operation forward. The caller has to hold the mutex */
+static gboolean
+thunar_job_operation_history_step_forward (ThunarJobOperationHistory *history)
+{
+  if (history->lp_redo == NULL)
+    return FALSE;
+
+  history->lp_undo = history->lp_redo;
+  history->lp_redo = g_list_next (history->lp_redo);
+  return TRUE;
+}
+
+
+
+static void
+thunar_job_operation_history_journal_put_record (GByteArray *data,
+                                                 guint8      tag,
+                                                 GByteArray *payload)
+{
+  guint32 length = payload != NULL ? payload->len : 0;
+  guint8  header[JOURNAL_RECORD_HEADER_SIZE];
+
+  header[0] = tag;
+  header[1] = length & 0xff;
+  header[2] = (length >> 8) & 0xff;
+  header[3] = (length >> 16) & 0xff;
+  header[4] = (length >> 24) & 0xff;
+
+  g_byte_array_append (data, header, sizeof (header));
+  if (payload != NULL)
+    g_byte_array_append (data, payload->data, payload->len);
+}
+
+
+
+static GByteArray *
+thunar_job_operation_history_journal_timestamps (ThunarJobOperation *job_operation)
+{
+  GByteArray *payload = g_byte_array_new ();
+  gint64      timestamps[2];
+
+  thunar_job_operation_get_timestamps (job_operation, &timestamps[0], &timestamps[1]);
+  timestamps[0] = GINT64_TO_LE (timestamps[0]);
+  timestamps[1] = GINT64_TO_LE (timestamps[1]);
+  g_byte_array_append (payload, (const guint8 *) timestamps, sizeof (timestamps));
+
+  return payload;
+}
+
+
+
+/* replays a single journal record, returns %FALSE if the record is corrupt */
+static gboolean
+thunar_job_operation_history_journal_replay (ThunarJobOperationHistory *history,
+                                             guint8                     tag,
+                                             const guint8              *payload,
+                                             gsize                      length)
+{
+  ThunarJobOperation *operation;
+  const guint8       *p = payload;
+  gint64              timestamps[2];
+
+  switch (tag)
+    {
+    case JOURNAL_RECORD_COMMIT:
+      operation = thunar_job_operation_new_from_data (&p, payload + length);
+      if (operation == NULL || p != payload + length)
+        {
+          if (operation != NULL)
+            g_object_unref (operation);
+          return FALSE;
+        }
+      thunar_job_operation_history_push (history, operation);
+      g_object_unref (operation);
+      return TRUE;
+
+    case JOURNAL_RECORD_UNDO:
+      return length == 0 && thunar_job_operation_history_step_back (history);
+
+    case JOURNAL_RECORD_REDO:
+      return length == 0 && thunar_job_operation_history_step_forward (history);
+
+    case JOURNAL_RECORD_TRASH:
+      if (length != sizeof (timestamps) || history->lp_undo == NULL)
+        return FALSE;
+      memcpy (timestamps, payload, sizeof (timestamps));
+      thunar_job_operation_set_start_timestamp (history->lp_undo->data, GINT64_FROM_LE (timestamps[0]));
+      thunar_job_operation_set_end_timestamp (history->lp_undo->data, GINT64_FROM_LE (timestamps[1]));
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+
+
+/* restores the history from the journal and rewrites the journal in compacted form */
+static void
+thunar_job_operation_history_journal_load (ThunarJobOperationHistory *history)
+{
+  GByteArray   *data;
+  GByteArray   *payload;
+  GFile        *file;
+  gchar        *contents = NULL;
+  gchar        *dirname;
+  gsize         length = 0;
+  const guint8 *p;
+  const guint8 *end;
+  guint32       record_length;
+  guint         n_undone = 0;
+  GError       *error = NULL;
+
+  if (g_file_get_contents (history->journal_path, &contents, &length, NULL))
+    {
+      /* replay all records up to the first incomplete or corrupt one, which is where
+       * an earlier session was interrupted while writing */
+      for (p = (const guint8 *) contents, end = p + length; end - p >= JOURNAL_RECORD_HEADER_SIZE; p += record_length)
+        {
+          record_length = p[1] | (p[2] << 8) | (p[3] << 16) | ((guint32) p[4] << 24);
+          p += JOURNAL_RECORD_HEADER_SIZE;
+          if (record_length > (gsize) (end - p)
+              || !thunar_job_operation_history_journal_replay (history, p[-JOURNAL_RECORD_HEADER_SIZE], p, record_length))
+            {
+              g_warning ("Ignoring corrupt record in undo journal \"%s\"", history->journal_path);
+              break;
+            }
+        }
+      g_free (contents);
+    }
+
+  /* rewrite the journal with the current state only */
+  data = g_byte_array_new ();
+  for (GList *lp = history->job_operation_list.head; lp != NULL; lp = lp->next)
+    {
+      payload = g_byte_array_new ();
+      thunar_job_operation_serialize (lp->data, payload);
+      thunar_job_operation_history_journal_put_record (data, JOURNAL_RECORD_COMMIT, payload);
+      g_byte_array_unref (payload);
+    }
+  for (GList *lp = history->lp_redo; lp != NULL; lp = lp->next)
+    ++n_undone;
+  for (; n_undone > 0; --n_undone)
+    thunar_job_operation_history_journal_put_record (data, JOURNAL_RECORD_UNDO, NULL);
+
+  dirname = g_path_get_dirname (history->journal_path);
+  g_mkdir_with_parents (dirname, 0700);
+  g_free (dirname);
+
+  if (!g_file_set_contents_full (history->journal_path, (const gchar *) data->data, data->len,
+                                 G_FILE_SET_CONTENTS_CONSISTENT, 0600, &error))
+    {
+      g_warning ("Failed to write undo journal: %s", error->message);
+      g_clear_error (&error);
+      g_byte_array_unref (data);
+      return;
+    }
+  g_byte_array_unref (data);
+
+  /* open the journal to append further changes */
+  file = g_file_new_for_path (history->journal_path);
+  history->journal = G_OUTPUT_STREAM (g_file_append_to (file, G_FILE_CREATE_PRIVATE, NULL, &error));
+  g_object_unref (file);
+
+  if (history->journal == NULL)
+    {
+      g_warning ("Failed to open undo journal: %s", error->message);
+      g_clear_error (&error);
+    }
+}
+
+
+
+/* appends a record to the journal, if the history is persistent. The caller has to hold the mutex */
+static void
+thunar_job_operation_history_journal_append (ThunarJobOperationHistory *history,
+                                             guint8                     tag,
+                                             GByteArray                *payload)
+{
+  GByteArray *data;
+  GError     *error = NULL;
+
+  if (history->journal == NULL)
+    return;
+
+  data = g_byte_array_new ();
+  thunar_job_operation_history_journal_put_record (data, tag, payload);
+
+  if (!g_output_stream_write_all (history->journal, data->data, data->len, NULL, NULL, &error)
+      || !g_output_stream_flush (history->journal, NULL, &error))
+    {
+      /* stop journaling, the journal is replayed up to the last complete record */
+      g_warning ("Failed to write undo journal: %s", error->message);
+      g_clear_error (&error);
+      g_output_stream_close (history->journal, NULL, NULL);
+      g_clear_object (&history->journal);
+    }
+
+  g_byte_array_unref (data);
+}
+
+
+
 /**
  * thunar_job_operation_history_get_default:
  *
@@ -206,7 +509,7 @@ thunar_job_operation_history_get_default (void)
 void
 thunar_job_operation_history_commit (ThunarJobOperation *job_operation)
 {
-  GList *new_list = NULL;
+  GByteArray *payload;
 
   _thunar_return_if_fail (THUNAR_IS_JOB_OPERATION (job_operation));
 
@@ -219,30 +522,14 @@ thunar_job_operation_history_commit (ThunarJobOperation *job_operation)
 
   g_mutex_lock (&job_operation_history->job_operation_list_mutex);
 
-  /* When a new operation is added, drop all previous operations which were undone from the list */
-  if (job_operation_history->lp_redo != NULL)
-    {
-      for (GList *lp = job_operation_history->job_operation_list;
-           lp != NULL && lp != job_operation_history->lp_redo;
-           lp = lp->next)
-        new_list = g_list_append (new_list, g_object_ref (lp->data));
-      g_list_free_full (job_operation_history->job_operation_list, g_object_unref);
-      job_operation_history->job_operation_list = new_list;
-    }
-
-  /* Add the new operation to our list */
-  job_operation_history->job_operation_list = g_list_append (job_operation_history->job_operation_list, g_object_ref (job_operation));
+  thunar_job_operation_history_push (job_operation_history, job_operation);
 
-  /* reset the undo pointer to latest operation and clear the redo pointer */
-  job_operation_history->lp_undo = g_list_last (job_operation_history->job_operation_list);
-  job_operation_history->lp_redo = NULL;
-
-  /* Limit the size of the list */
-  if (job_operation_history->job_operation_list_max_size != -1 && g_list_length (job_operation_history->job_operation_list) > (guint) (job_operation_history->job_operation_list_max_size))
+  if (job_operation_history->journal != NULL)
     {
-      GList *first = g_list_first (job_operation_history->job_operation_list);
-      job_operation_history->job_operation_list = g_list_remove_link (job_operation_history->job_operation_list, first);
-      g_list_free_full (first, g_object_unref);
+      payload = g_byte_array_new ();
+      thunar_job_operation_serialize (job_operation, payload);
+      thunar_job_operation_history_journal_append (job_operation_history, JOURNAL_RECORD_COMMIT, payload);
+      g_byte_array_unref (payload);
     }
 
   g_mutex_unlock (&job_operation_history->job_operation_list_mutex);
@@ -290,6 +577,13 @@ thunar_job_operation_history_update_trash_timestamps (ThunarJobOperation *job_op
 
       thunar_job_operation_set_start_timestamp (THUNAR_JOB_OPERATION (job_operation_history->lp_undo->data), start_timestamp);
       thunar_job_operation_set_end_timestamp (THUNAR_JOB_OPERATION (job_operation_history->lp_undo->data), end_timestamp);
+
+      if (job_operation_history->journal != NULL)
+        {
+          GByteArray *payload = thunar_job_operation_history_journal_timestamps (job_operation_history->lp_undo->data);
+          thunar_job_operation_history_journal_append (job_operation_history, JOURNAL_RECORD_TRASH, payload);
+          g_byte_array_unref (payload);
+        }
     }
 
   g_mutex_unlock (&job_operation_history->job_operation_list_mutex);
@@ -331,8 +625,8 @@ thunar_job_operation_history_undo (GtkWindow *parent)
   operation_marker = job_operation_history->lp_undo->data;
 
   /* fix position undo/redo pointers */
-  job_operation_history->lp_redo = job_operation_history->lp_undo;
-  job_operation_history->lp_undo = g_list_previous (job_operation_history->lp_undo);
+  thunar_job_operation_history_step_back (job_operation_history);
+  thunar_job_operation_history_journal_append (job_operation_history, JOURNAL_RECORD_UNDO, NULL);
 
   /* warn the user if the previous operation is empty, since then there is nothing to undo */
   if (thunar_job_operation_empty (operation_marker))
@@ -427,8 +721,8 @@ thunar_job_operation_history_redo (GtkWindow *parent)
   operation_marker = job_operation_history->lp_redo->data;
 
   /* fix position undo/redo pointers */
-  job_operation_history->lp_undo = job_operation_history->lp_redo;
-  job_operation_history->lp_redo = g_list_next (job_operation_history->lp_redo);
+  thunar_job_operation_history_step_forward (job_operation_history);
+  thunar_job_operation_history_journal_append (job_operation_history, JOURNAL_RECORD_REDO, NULL);
 
   /* warn the user if the previous operation is empty, since then there is nothing to undo */
   if (thunar_job_operation_empty (operation_marker))
@@ -16,6 +16,10 @@
  * this program; if not, see <http://www.gnu.org/licenses/>.
  */
 
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
 #include "thunar/thunar-job-operation.h"
 
 #include "thunar/thunar-application.h"
@@ -30,13 +34,25 @@
  * The #ThunarJobOperation class represents a single 'job operation', a file operation like copying, moving
  * trashing, renaming etc. and its source/target locations.
  *
+ * Since operations may involve a huge number of files and are kept around in the
+ * #ThunarJobOperationHistory, the locations are not stored as #GFile<!---->s, but as
+ * front-coded URI lists, and only turned into #GFile<!---->s when the operation is executed.
  */
 
+/* A list of URIs, front-coded: each record holds the length of the prefix shared with
+ * the previous URI, the length of the remaining suffix and the suffix itself. Equal
+ * lists always have equal data. */
+typedef struct
+{
+  GByteArray *data;
+  guint       length;
+  gchar      *last_uri;
+} ThunarJobOperationUris;
+
+
+
 static void
 thunar_job_operation_finalize (GObject *object);
-static gint
-thunar_job_operation_is_ancestor (gconstpointer descendant,
-                                  gconstpointer ancestor);
 static void
 thunar_job_operation_restore_from_trash (ThunarJobOperation *operation,
                                          GError            **error);
@@ -48,8 +64,11 @@ struct _ThunarJobOperation
   GObject __parent__;
 
   ThunarJobOperationKind operation_kind;
-  GList                 *source_file_list;
-  GList                 *target_file_list;
+  ThunarJobOperationUris source_uris;
+  ThunarJobOperationUris target_uris;
+
+  /* set of the source URIs, only used while files are added */
+  GHashTable *source_uri_set;
 
   /* Files overwritten as a part of an operation */
   GList *overwritten_files;
@@ -66,6 +85,224 @@ G_DEFINE_TYPE (ThunarJobOperation, thunar_job_operation, G_TYPE_OBJECT)
 
 
 
+static void
+thunar_job_operation_put_uint (GByteArray *data,
+                               guint64     value)
+{
+  guint8 byte;
+
+  do
+    {
+      byte = value & 0x7f;
+      value >>= 7;
+      if (value != 0)
+        byte |= 0x80;
+      g_byte_array_append (data, &byte, 1);
+    }
+  while (value != 0);
+}
+
+
+
+static gboolean
+thunar_job_operation_get_uint (const guint8 **data,
+                               const guint8  *end,
+                               guint64       *value)
+{
+  guint8 byte;
+  guint  shift;
+
+  for (*value = 0, shift = 0; *data < end && shift < 64; shift += 7)
+    {
+      byte = *(*data)++;
+      *value |= (guint64) (byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_job_operation_uris_init (ThunarJobOperationUris *uris)
+{
+  uris->data = g_byte_array_new ();
+  uris->length = 0;
+  uris->last_uri = NULL;
+}
+
+
+
+static void
+thunar_job_operation_uris_clear (ThunarJobOperationUris *uris)
+{
+  g_byte_array_unref (uris->data);
+  g_free (uris->last_uri);
+}
+
+
+
+static void
+thunar_job_operation_uris_copy (ThunarJobOperationUris       *dest,
+                                const ThunarJobOperationUris *src)
+{
+  thunar_job_operation_uris_clear (dest);
+
+  dest->data = g_byte_array_sized_new (src->data->len);
+  g_byte_array_append (dest->data, src->data->data, src->data->len);
+  dest->length = src->length;
+  dest->last_uri = g_strdup (src->last_uri);
+}
+
+
+
+static void
+thunar_job_operation_uris_append (ThunarJobOperationUris *uris,
+                                  const gchar            *uri)
+{
+  gsize prefix = 0;
+  gsize suffix;
+
+  if (uris->last_uri != NULL)
+    while (uri[prefix] != '\0' && uri[prefix] == uris->last_uri[prefix])
+      ++prefix;
+
+  suffix = strlen (uri + prefix);
+
+  thunar_job_operation_put_uint (uris->data, prefix);
+  thunar_job_operation_put_uint (uris->data, suffix);
+  g_byte_array_append (uris->data, (const guint8 *) uri + prefix, suffix);
+
+  g_free (uris->last_uri);
+  uris->last_uri = g_strdup (uri);
+  uris->length++;
+}
+
+
+
+static void
+thunar_job_operation_uris_append_file (ThunarJobOperationUris *uris,
+                                       GFile                  *file)
+{
+  gchar *uri;
+
+  uri = g_file_get_uri (file);
+  thunar_job_operation_uris_append (uris, uri);
+  g_free (uri);
+}
+
+
+
+/* decodes the URI at @data into @uri, which has to hold the previous URI of the list */
+static gboolean
+thunar_job_operation_uris_next (const guint8 **data,
+                                const guint8  *end,
+                                GString       *uri)
+{
+  guint64 prefix;
+  guint64 suffix;
+
+  if (!thunar_job_operation_get_uint (data, end, &prefix)
+      || !thunar_job_operation_get_uint (data, end, &suffix)
+      || prefix > uri->len
+      || suffix > (guint64) (end - *data))
+    return FALSE;
+
+  g_string_truncate (uri, prefix);
+  g_string_append_len (uri, (const gchar *) *data, suffix);
+  *data += suffix;
+
+  return TRUE;
+}
+
+
+
+/* returns the list as #GFile<!---->s, which have to be released with thunar_g_list_free_full() */
+static GList *
+thunar_job_operation_uris_get_files (const ThunarJobOperationUris *uris)
+{
+  const guint8 *data = uris->data->data;
+  const guint8 *end = data + uris->data->len;
+  GString      *uri;
+  GList        *file_list = NULL;
+
+  uri = g_string_new (NULL);
+  while (data < end && thunar_job_operation_uris_next (&data, end, uri))
+    file_list = g_list_prepend (file_list, g_file_new_for_uri (uri->str));
+  g_string_free (uri, TRUE);
+
+  return g_list_reverse (file_list);
+}
+
+
+
+static gboolean
+thunar_job_operation_uris_equal (const ThunarJobOperationUris *a,
+                                 const ThunarJobOperationUris *b)
+{
+  return a->length == b->length
+         && a->data->len == b->data->len
+         && memcmp (a->data->data, b->data->data, a->data->len) == 0;
+}
+
+
+
+static void
+thunar_job_operation_uris_serialize (const ThunarJobOperationUris *uris,
+                                     GByteArray                   *data)
+{
+  thunar_job_operation_put_uint (data, uris->length);
+  thunar_job_operation_put_uint (data, uris->data->len);
+  g_byte_array_append (data, uris->data->data, uris->data->len);
+}
+
+
+
+static gboolean
+thunar_job_operation_uris_deserialize (ThunarJobOperationUris *uris,
+                                       const guint8          **data,
+                                       const guint8           *end)
+{
+  const guint8 *list_data;
+  const guint8 *list_end;
+  guint64       length;
+  guint64       n_bytes;
+  GString      *uri;
+  guint         n;
+
+  if (!thunar_job_operation_get_uint (data, end, &length)
+      || !thunar_job_operation_get_uint (data, end, &n_bytes)
+      || n_bytes > (guint64) (end - *data)
+      || length > G_MAXUINT)
+    return FALSE;
+
+  /* validate the records and recover the last URI, needed to append to the list */
+  list_data = *data;
+  list_end = *data + n_bytes;
+  uri = g_string_new (NULL);
+  for (n = 0; n < length; ++n)
+    if (!thunar_job_operation_uris_next (&list_data, list_end, uri))
+      break;
+
+  if (n < length || list_data != list_end)
+    {
+      g_string_free (uri, TRUE);
+      return FALSE;
+    }
+
+  g_byte_array_append (uris->data, *data, n_bytes);
+  uris->length = length;
+  g_free (uris->last_uri);
+  uris->last_uri = length > 0 ? g_string_free (uri, FALSE) : (g_string_free (uri, TRUE), NULL);
+
+  *data = list_end;
+  return TRUE;
+}
+
+
+
 static void
 thunar_job_operation_class_init (ThunarJobOperationClass *klass)
 {
@@ -81,8 +318,9 @@ static void
 thunar_job_operation_init (ThunarJobOperation *self)
 {
   self->operation_kind = THUNAR_JOB_OPERATION_KIND_COPY;
-  self->source_file_list = NULL;
-  self->target_file_list = NULL;
+  thunar_job_operation_uris_init (&self->source_uris);
+  thunar_job_operation_uris_init (&self->target_uris);
+  self->source_uri_set = NULL;
   self->overwritten_files = NULL;
 }
 
@@ -95,8 +333,10 @@ thunar_job_operation_finalize (GObject *object)
 
   op = THUNAR_JOB_OPERATION (object);
 
-  g_list_free_full (op->source_file_list, g_object_unref);
-  g_list_free_full (op->target_file_list, g_object_unref);
+  thunar_job_operation_uris_clear (&op->source_uris);
+  thunar_job_operation_uris_clear (&op->target_uris);
+  if (op->source_uri_set != NULL)
+    g_hash_table_destroy (op->source_uri_set);
   g_list_free_full (op->overwritten_files, g_object_unref);
 
   (*G_OBJECT_CLASS (thunar_job_operation_parent_class)->finalize) (object);
@@ -128,6 +368,37 @@ thunar_job_operation_new (ThunarJobOperationKind kind)
 
 
 
+/* checks whether @uri or one of its parents is a source of @job_operation */
+static gboolean
+thunar_job_operation_has_source_ancestor (ThunarJobOperation *job_operation,
+                                          gchar              *uri)
+{
+  gboolean found;
+  gchar    saved;
+  gsize    n;
+
+  /* check the URI itself and each of its parents, with and without trailing slash */
+  found = g_hash_table_contains (job_operation->source_uri_set, uri);
+  for (n = strlen (uri); !found && n-- > 0;)
+    {
+      if (uri[n] != '/')
+        continue;
+
+      saved = uri[n + 1];
+      uri[n + 1] = '\0';
+      found = g_hash_table_contains (job_operation->source_uri_set, uri);
+      uri[n + 1] = saved;
+
+      uri[n] = '\0';
+      found = found || g_hash_table_contains (job_operation->source_uri_set, uri);
+      uri[n] = '/';
+    }
+
+  return found;
+}
+
+
+
 /**
  * thunar_job_operation_add:
  * @job_operation: a #ThunarJobOperation
@@ -141,6 +412,11 @@ thunar_job_operation_add (ThunarJobOperation *job_operation,
                           GFile              *source_file,
                           GFile              *target_file)
 {
+  const guint8 *data;
+  const guint8 *end;
+  GString      *uri;
+  gchar        *source_uri = NULL;
+
   _thunar_return_if_fail (THUNAR_IS_JOB_OPERATION (job_operation));
   _thunar_return_if_fail (source_file == NULL || G_IS_FILE (source_file));
   _thunar_return_if_fail (target_file == NULL || G_IS_FILE (target_file));
@@ -152,14 +428,143 @@ thunar_job_operation_add (ThunarJobOperation *job_operation,
    *
    * So to avoid such issues on executing a job operation, if the source file is
    * a descendant of an existing file, do not add it to the job operation. */
-  if (g_list_find_custom (job_operation->source_file_list, source_file, thunar_job_operation_is_ancestor) != NULL)
-    return;
-
-  /* Don't add NULL files to the list, since it causes memory management issues on object destruction */
   if (source_file != NULL)
-    job_operation->source_file_list = g_list_append (job_operation->source_file_list, g_object_ref (source_file));
+    {
+      /* (re)build the set of source URIs, it is dropped by thunar_job_operation_compact() */
+      if (job_operation->source_uri_set == NULL)
+        {
+          job_operation->source_uri_set = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+          data = job_operation->source_uris.data->data;
+          end = data + job_operation->source_uris.data->len;
+          uri = g_string_new (NULL);
+          while (data < end && thunar_job_operation_uris_next (&data, end, uri))
+            g_hash_table_add (job_operation->source_uri_set, g_strdup (uri->str));
+          g_string_free (uri, TRUE);
+        }
+
+      source_uri = g_file_get_uri (source_file);
+      if (thunar_job_operation_has_source_ancestor (job_operation, source_uri))
+        {
+          g_free (source_uri);
+          return;
+        }
+
+      thunar_job_operation_uris_append (&job_operation->source_uris, source_uri);
+      g_hash_table_add (job_operation->source_uri_set, source_uri);
+    }
+
   if (target_file != NULL)
-    job_operation->target_file_list = g_list_append (job_operation->target_file_list, g_object_ref (target_file));
+    thunar_job_operation_uris_append_file (&job_operation->target_uris, target_file);
+}
+
+
+
+/**
+ * thunar_job_operation_compact:
+ * @job_operation: a #ThunarJobOperation
+ *
+ * Releases the data which is only needed while files are added to
+ * @job_operation. Called once the operation is complete.
+ **/
+void
+thunar_job_operation_compact (ThunarJobOperation *job_operation)
+{
+  _thunar_return_if_fail (THUNAR_IS_JOB_OPERATION (job_operation));
+
+  g_clear_pointer (&job_operation->source_uri_set, g_hash_table_destroy);
+}
+
+
+
+/**
+ * thunar_job_operation_serialize:
+ * @job_operation: a #ThunarJobOperation
+ * @data:          a #GByteArray
+ *
+ * Appends a compact representation of @job_operation to @data, which can be
+ * turned back into an operation using thunar_job_operation_new_from_data().
+ **/
+void
+thunar_job_operation_serialize (ThunarJobOperation *job_operation,
+                                GByteArray         *data)
+{
+  ThunarJobOperationUris overwritten_uris;
+
+  _thunar_return_if_fail (THUNAR_IS_JOB_OPERATION (job_operation));
+
+  thunar_job_operation_put_uint (data, job_operation->operation_kind);
+  thunar_job_operation_put_uint (data, MAX (job_operation->start_timestamp, 0));
+  thunar_job_operation_put_uint (data, MAX (job_operation->end_timestamp, 0));
+  thunar_job_operation_uris_serialize (&job_operation->source_uris, data);
+  thunar_job_operation_uris_serialize (&job_operation->target_uris, data);
+
+  thunar_job_operation_uris_init (&overwritten_uris);
+  for (GList *lp = job_operation->overwritten_files; lp != NULL; lp = lp->next)
+    thunar_job_operation_uris_append_file (&overwritten_uris, lp->data);
+  thunar_job_operation_uris_serialize (&overwritten_uris, data);
+  thunar_job_operation_uris_clear (&overwritten_uris);
+}
+
+
+
+/**
+ * thunar_job_operation_new_from_data:
+ * @data: pointer to the data written by thunar_job_operation_serialize(), advanced past it on success
+ * @end:  end of the available data
+ *
+ * Restores a #ThunarJobOperation from its serialized representation.
+ *
+ * Return value: (transfer full): the restored #ThunarJobOperation or %NULL if @data is invalid
+ **/
+ThunarJobOperation *
+thunar_job_operation_new_from_data (const guint8 **data,
+                                    const guint8  *end)
+{
+  ThunarJobOperation    *operation;
+  ThunarJobOperationUris overwritten_uris;
+  const guint8          *p = *data;
+  GEnumClass            *enum_class;
+  guint64                kind;
+  guint64                start_timestamp;
+  guint64                end_timestamp;
+  gboolean               valid;
+
+  if (!thunar_job_operation_get_uint (&p, end, &kind)
+      || !thunar_job_operation_get_uint (&p, end, &start_timestamp)
+      || !thunar_job_operation_get_uint (&p, end, &end_timestamp)
+      || kind > G_MAXINT
+      || start_timestamp > G_MAXINT64
+      || end_timestamp > G_MAXINT64)
+    return NULL;
+
+  enum_class = g_type_class_ref (THUNAR_TYPE_JOB_OPERATION_KIND);
+  valid = g_enum_get_value (enum_class, kind) != NULL;
+  g_type_class_unref (enum_class);
+  if (!valid)
+    return NULL;
+
+  operation = g_object_new (THUNAR_TYPE_JOB_OPERATION, NULL);
+  operation->operation_kind = kind;
+  operation->start_timestamp = start_timestamp;
+  operation->end_timestamp = end_timestamp;
+
+  thunar_job_operation_uris_init (&overwritten_uris);
+  valid = thunar_job_operation_uris_deserialize (&operation->source_uris, &p, end)
+          && thunar_job_operation_uris_deserialize (&operation->target_uris, &p, end)
+          && thunar_job_operation_uris_deserialize (&overwritten_uris, &p, end);
+  if (valid)
+    operation->overwritten_files = thunar_job_operation_uris_get_files (&overwritten_uris);
+  thunar_job_operation_uris_clear (&overwritten_uris);
+
+  if (!valid)
+    {
+      g_object_unref (operation);
+      return NULL;
+    }
+
+  *data = p;
+  return operation;
 }
 
 
@@ -278,7 +683,7 @@ thunar_job_operation_empty (ThunarJobOperation *job_operation)
 {
   _thunar_return_val_if_fail (THUNAR_IS_JOB_OPERATION (job_operation), TRUE);
 
-  if (job_operation->source_file_list == NULL && job_operation->target_file_list == NULL)
+  if (job_operation->source_uris.length == 0 && job_operation->target_uris.length == 0)
     return TRUE;
 
   return FALSE;
@@ -327,27 +732,27 @@ thunar_job_operation_new_invert (ThunarJobOperation *job_operation)
     case THUNAR_JOB_OPERATION_KIND_COPY:
       inverted_operation = g_object_new (THUNAR_TYPE_JOB_OPERATION, NULL);
       inverted_operation->operation_kind = THUNAR_JOB_OPERATION_KIND_DELETE;
-      inverted_operation->source_file_list = thunar_g_list_copy_deep (job_operation->target_file_list);
+      thunar_job_operation_uris_copy (&inverted_operation->source_uris, &job_operation->target_uris);
       break;
 
     case THUNAR_JOB_OPERATION_KIND_MOVE:
       inverted_operation = g_object_new (THUNAR_TYPE_JOB_OPERATION, NULL);
       inverted_operation->operation_kind = THUNAR_JOB_OPERATION_KIND_MOVE;
-      inverted_operation->source_file_list = thunar_g_list_copy_deep (job_operation->target_file_list);
-      inverted_operation->target_file_list = thunar_g_list_copy_deep (job_operation->source_file_list);
+      thunar_job_operation_uris_copy (&inverted_operation->source_uris, &job_operation->target_uris);
+      thunar_job_operation_uris_copy (&inverted_operation->target_uris, &job_operation->source_uris);
       break;
 
     case THUNAR_JOB_OPERATION_KIND_RENAME:
       inverted_operation = g_object_new (THUNAR_TYPE_JOB_OPERATION, NULL);
       inverted_operation->operation_kind = THUNAR_JOB_OPERATION_KIND_RENAME;
-      inverted_operation->source_file_list = thunar_g_list_copy_deep (job_operation->target_file_list);
-      inverted_operation->target_file_list = thunar_g_list_copy_deep (job_operation->source_file_list);
+      thunar_job_operation_uris_copy (&inverted_operation->source_uris, &job_operation->target_uris);
+      thunar_job_operation_uris_copy (&inverted_operation->target_uris, &job_operation->source_uris);
       break;
 
     case THUNAR_JOB_OPERATION_KIND_TRASH:
       inverted_operation = g_object_new (THUNAR_TYPE_JOB_OPERATION, NULL);
       inverted_operation->operation_kind = THUNAR_JOB_OPERATION_KIND_RESTORE;
-      inverted_operation->target_file_list = thunar_g_list_copy_deep (job_operation->source_file_list);
+      thunar_job_operation_uris_copy (&inverted_operation->target_uris, &job_operation->source_uris);
       inverted_operation->start_timestamp = job_operation->start_timestamp;
       inverted_operation->end_timestamp = job_operation->end_timestamp;
       break;
@@ -356,14 +761,14 @@ thunar_job_operation_new_invert (ThunarJobOperation *job_operation)
     case THUNAR_JOB_OPERATION_KIND_CREATE_FOLDER:
       inverted_operation = g_object_new (THUNAR_TYPE_JOB_OPERATION, NULL);
       inverted_operation->operation_kind = THUNAR_JOB_OPERATION_KIND_DELETE;
-      inverted_operation->source_file_list = thunar_g_list_copy_deep (job_operation->target_file_list);
+      thunar_job_operation_uris_copy (&inverted_operation->source_uris, &job_operation->target_uris);
       break;
 
     case THUNAR_JOB_OPERATION_KIND_LINK:
       inverted_operation = g_object_new (THUNAR_TYPE_JOB_OPERATION, NULL);
       inverted_operation->operation_kind = THUNAR_JOB_OPERATION_KIND_UNLINK;
-      inverted_operation->source_file_list = thunar_g_list_copy_deep (job_operation->target_file_list);
-      inverted_operation->target_file_list = thunar_g_list_copy_deep (job_operation->source_file_list);
+      thunar_job_operation_uris_copy (&inverted_operation->source_uris, &job_operation->target_uris);
+      thunar_job_operation_uris_copy (&inverted_operation->target_uris, &job_operation->source_uris);
       break;
 
     default:
@@ -397,17 +802,22 @@ thunar_job_operation_execute (ThunarJobOperation *job_operation,
   gchar             *display_name;
   GFile             *template_file;
   gboolean           operation_canceled = FALSE;
+  GList             *source_file_list;
+  GList             *target_file_list;
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB_OPERATION (job_operation), FALSE);
 
   application = thunar_application_get ();
 
+  source_file_list = thunar_job_operation_uris_get_files (&job_operation->source_uris);
+  target_file_list = thunar_job_operation_uris_get_files (&job_operation->target_uris);
+
   switch (job_operation->operation_kind)
     {
     case THUNAR_JOB_OPERATION_KIND_DELETE:
     case THUNAR_JOB_OPERATION_KIND_UNLINK:
     case THUNAR_JOB_OPERATION_KIND_TRASH:
-      for (GList *lp = job_operation->source_file_list; lp != NULL; lp = lp->next)
+      for (GList *lp = source_file_list; lp != NULL; lp = lp->next)
         {
           if (!G_IS_FILE (lp->data))
             {
@@ -458,7 +868,7 @@ thunar_job_operation_execute (ThunarJobOperation *job_operation,
 
     case THUNAR_JOB_OPERATION_KIND_MOVE:
       /* ensure that all the targets have parent directories which exist */
-      for (GList *lp = job_operation->target_file_list; lp != NULL; lp = lp->next)
+      for (GList *lp = target_file_list; lp != NULL; lp = lp->next)
         {
           parent_dir = g_file_get_parent (lp->data);
           g_file_make_directory_with_parents (parent_dir, NULL, &err);
@@ -478,18 +888,20 @@ thunar_job_operation_execute (ThunarJobOperation *job_operation,
                          "Aborting operation\n",
                          err->message);
               g_propagate_error (error, err);
+              thunar_g_list_free_full (source_file_list);
+              thunar_g_list_free_full (target_file_list);
               g_object_unref (application);
               return operation_canceled;
             }
         }
 
       thunar_application_move_files (application, NULL,
-                                     job_operation->source_file_list, job_operation->target_file_list,
+                                     source_file_list, target_file_list,
                                      THUNAR_OPERATION_LOG_NO_OPERATIONS, NULL);
       break;
 
     case THUNAR_JOB_OPERATION_KIND_RENAME:
-      for (GList *slp = job_operation->source_file_list, *tlp = job_operation->target_file_list;
+      for (GList *slp = source_file_list, *tlp = target_file_list;
            slp != NULL && tlp != NULL;
            slp = slp->next, tlp = tlp->next)
         {
@@ -531,32 +943,32 @@ thunar_job_operation_execute (ThunarJobOperation *job_operation,
 
     case THUNAR_JOB_OPERATION_KIND_COPY:
       thunar_application_copy_to (application, NULL,
-                                  job_operation->source_file_list, job_operation->target_file_list,
+                                  source_file_list, target_file_list,
                                   THUNAR_OPERATION_LOG_NO_OPERATIONS, NULL);
       break;
 
     case THUNAR_JOB_OPERATION_KIND_CREATE_FILE:
       template_file = NULL;
-      if (job_operation->source_file_list != NULL)
-        template_file = job_operation->source_file_list->data;
+      if (source_file_list != NULL)
+        template_file = source_file_list->data;
       thunar_application_creat (application, NULL,
-                                job_operation->target_file_list,
+                                target_file_list,
                                 template_file,
                                 NULL, THUNAR_OPERATION_LOG_NO_OPERATIONS);
       break;
 
     case THUNAR_JOB_OPERATION_KIND_CREATE_FOLDER:
       thunar_application_mkdir (application, NULL,
-                                job_operation->target_file_list,
+                                target_file_list,
                                 NULL, THUNAR_OPERATION_LOG_NO_OPERATIONS);
       break;
 
     case THUNAR_JOB_OPERATION_KIND_LINK:
-      for (GList *target_file = job_operation->target_file_list; target_file != NULL; target_file = target_file->next)
+      for (GList *target_file = target_file_list; target_file != NULL; target_file = target_file->next)
         {
           GFile *target_folder = g_file_get_parent (target_file->data);
           thunar_application_link_into (application, NULL,
-                                        job_operation->source_file_list, target_folder,
+                                        source_file_list, target_folder,
                                         THUNAR_OPERATION_LOG_NO_OPERATIONS, NULL);
           g_object_unref (target_folder);
         }
@@ -567,33 +979,14 @@ thunar_job_operation_execute (ThunarJobOperation *job_operation,
       break;
     }
 
+  thunar_g_list_free_full (source_file_list);
+  thunar_g_list_free_full (target_file_list);
   g_object_unref (application);
   return operation_canceled;
 }
 
 
 
-/* thunar_job_operation_is_ancestor:
- * @ancestor:     potential ancestor of @descendant. A #GFile
- * @descendant:   potential descendant of @ancestor. A #GFile
- *
- * Helper function for #g_list_find_custom.
- *
- * Return value: %0 if @ancestor is actually the ancestor of @descendant,
- *               %1 otherwise
- **/
-static gint
-thunar_job_operation_is_ancestor (gconstpointer ancestor,
-                                  gconstpointer descendant)
-{
-  if (thunar_g_file_is_descendant (G_FILE (descendant), G_FILE (ancestor)))
-    return 0;
-  else
-    return 1;
-}
-
-
-
 /* thunar_job_operation_compare:
  * @operation1: First operation for comparison
  * @operation2: Second operation for comparison
@@ -611,27 +1004,12 @@ thunar_job_operation_compare (ThunarJobOperation *operation1,
   if (operation1->operation_kind != operation2->operation_kind)
     return 1;
 
-  if (g_list_length (operation1->source_file_list) != g_list_length (operation2->source_file_list))
+  if (!thunar_job_operation_uris_equal (&operation1->source_uris, &operation2->source_uris))
     return 1;
 
-  if (g_list_length (operation1->target_file_list) != g_list_length (operation2->target_file_list))
+  if (!thunar_job_operation_uris_equal (&operation1->target_uris, &operation2->target_uris))
     return 1;
 
-  for (GList *lp1 = operation1->source_file_list, *lp2 = operation2->source_file_list;
-       lp1 != NULL && lp2 != NULL;
-       lp1 = lp1->next, lp2 = lp2->next)
-    {
-      if (!g_file_equal (lp1->data, lp2->data))
-        return 1;
-    }
-
-  for (GList *lp1 = operation1->target_file_list, *lp2 = operation2->target_file_list;
-       lp1 != NULL && lp2 != NULL;
-       lp1 = lp1->next, lp2 = lp2->next)
-    {
-      if (!g_file_equal (lp1->data, lp2->data))
-        return 1;
-    }
   return 0;
 }
 
@@ -661,6 +1039,7 @@ thunar_job_operation_restore_from_trash (ThunarJobOperation *operation,
   ThunarApplication *application;
   GList             *source_file_list = NULL;
   GList             *target_file_list = NULL;
+  GList             *original_file_list;
 
 
   /* enumerate over the files in the trash */
@@ -684,7 +1063,8 @@ thunar_job_operation_restore_from_trash (ThunarJobOperation *operation,
 
   /* add all the files that were deleted in the hash table so we can check if a file
    * was deleted as a part of this operation or not in constant time. */
-  for (GList *lp = operation->target_file_list; lp != NULL; lp = lp->next)
+  original_file_list = thunar_job_operation_uris_get_files (&operation->target_uris);
+  for (GList *lp = original_file_list; lp != NULL; lp = lp->next)
     {
       GFile *parent = g_file_get_parent (lp->data);
       gchar *real_path = NULL;
@@ -713,6 +1093,7 @@ thunar_job_operation_restore_from_trash (ThunarJobOperation *operation,
         g_hash_table_add (files_trashed, g_object_ref (lp->data));
       g_free (real_path);
     }
+  thunar_g_list_free_full (original_file_list);
 
   /* iterate over the files in the trash, adding them to source and target lists of
    * the files which are to be restored and their original paths */
@@ -747,8 +1128,8 @@ thunar_job_operation_restore_from_trash (ThunarJobOperation *operation,
         {
           trashed_file = g_file_get_child (trash, g_file_info_get_name (info));
 
-          source_file_list = thunar_g_list_append_deep (source_file_list, trashed_file);
-          target_file_list = thunar_g_list_append_deep (target_file_list, original_file);
+          source_file_list = thunar_g_list_prepend_deep (source_file_list, trashed_file);
+          target_file_list = thunar_g_list_prepend_deep (target_file_list, original_file);
 
           g_object_unref (trashed_file);
         }
@@ -787,6 +1168,6 @@ thunar_job_operation_restore_from_trash (ThunarJobOperation *operation,
 gchar *
 thunar_job_operation_get_action_text (ThunarJobOperation *job_operation)
 {
-  guint files_count = job_operation->source_file_list == NULL ? 0 : g_list_length (job_operation->source_file_list);
+  guint files_count = job_operation->source_uris.length;
   return g_strdup_printf (ngettext ("%d file", "%d files", files_count), files_count);
 }
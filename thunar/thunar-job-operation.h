@@ -36,6 +36,14 @@ thunar_job_operation_add (ThunarJobOperation *job_operation,
                           GFile              *source_file,
                           GFile              *target_file);
 void
+thunar_job_operation_compact (ThunarJobOperation *job_operation);
+void
+thunar_job_operation_serialize (ThunarJobOperation *job_operation,
+                                GByteArray         *data);
+ThunarJobOperation *
+thunar_job_operation_new_from_data (const guint8 **data,
+                                    const guint8  *end);
+void
 thunar_job_operation_overwrite (ThunarJobOperation *job_operation,
                                 GFile              *overwritten_file);
 ThunarJobOperation *
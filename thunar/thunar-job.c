@@ -26,14 +26,25 @@
 #endif
 
 #include "thunar/thunar-enum-types.h"
+#include "thunar/thunar-gio-extensions.h"
 #include "thunar/thunar-job.h"
 #include "thunar/thunar-marshal.h"
 #include "thunar/thunar-private.h"
+#include "thunar/thunar-trace.h"
 
+#include <gobject/gvaluecollector.h>
 #include <libxfce4util/libxfce4util.h>
 
 
 
+/* number of different signals a job may emit through thunar_job_emit_coalesced() */
+#define THUNAR_JOB_N_EVENT_SLOTS (4)
+
+/* interval in which pending events are delivered to the main loop, about once per frame */
+#define THUNAR_JOB_EVENT_INTERVAL (1000 / 60)
+
+
+
 /* Signal identifiers */
 enum
 {
@@ -50,7 +61,9 @@ enum
   LAST_SIGNAL,
 };
 
-typedef struct _ThunarJobSignalData ThunarJobSignalData;
+typedef struct _ThunarJobSignalData   ThunarJobSignalData;
+typedef struct _ThunarJobMainloopCall ThunarJobMainloopCall;
+typedef struct _ThunarJobEvent        ThunarJobEvent;
 
 static void
 thunar_job_finalize (GObject *object);
@@ -67,17 +80,34 @@ static ThunarJobResponse
 thunar_job_real_ask_for_action (ThunarJob  *job,
                                 ThunarFile *source_file,
                                 ThunarFile *target_file);
+static void
+thunar_job_flush_events (ThunarJob *job);
 
 
 
 struct _ThunarJobPrivate
 {
-  GIOSchedulerJob *scheduler_job;
-  GCancellable    *cancellable;
-  guint            running : 1;
-  GError          *error;
-  gboolean         failed;
-  GMainContext    *context;
+  GCancellable *cancellable;
+  guint         running : 1;
+  GError       *error;
+  gboolean      failed;
+  GMainContext *context;
+
+  /* the lane of the job in the scheduler and its link in there while it is
+   * queued, both protected by the scheduler lock */
+  ThunarJobPriority priority;
+  GList            *scheduler_link;
+
+  /* the lane of the worker running the job and whether the job is blocked in
+   * there waiting for the user, both protected by the scheduler lock */
+  ThunarJobPriority worker_lane;
+  guint             n_blocks;
+
+  /* latest pending event per signal, posted by the job thread without locking and
+   * delivered to the main loop by thunar_job_flush_events() */
+  gpointer event_slots[THUNAR_JOB_N_EVENT_SLOTS];
+  guint    event_slot_signals[THUNAR_JOB_N_EVENT_SLOTS];
+  gint     events_scheduled;
 
   ThunarJobResponse      earlier_ask_create_response;
   ThunarJobResponse      earlier_ask_overwrite_response_file;
@@ -85,6 +115,10 @@ struct _ThunarJobPrivate
   ThunarJobResponse      earlier_ask_delete_response;
   ThunarJobResponse      earlier_ask_skip_response;
 
+  /* the file the job is working on, set by the job thread */
+  GMutex current_file_lock;
+  GFile *current_file;
+
   guint                  n_total_files;
   gboolean               pausable;
   gboolean               paused; /* the job has been manually paused using the UI */
@@ -104,10 +138,62 @@ struct _ThunarJobSignalData
   va_list  var_args;
 };
 
+struct _ThunarJobMainloopCall
+{
+  ThunarJob     *job;
+  GSourceFunc    func;
+  gpointer       user_data;
+  GDestroyNotify destroy_notify;
+  gboolean       result;
+  gboolean       done;
+  GMutex         lock;
+  GCond          cond;
+};
+
+struct _ThunarJobEvent
+{
+  guint          signal_id;
+  GQuark         signal_detail;
+  GType          return_type;
+  guint          n_values;
+  GValue        *values; /* the instance, followed by the signal parameters */
+  GDestroyNotify pointer_notify; /* releases the pointer parameter if no handler took it over */
+};
+
 static guint job_signals[LAST_SIGNAL];
 
 
 
+/* Jobs are executed by a pool of worker threads owned by Thunar. Every priority has its
+ * own queue (lane) and its own workers, which limits how many jobs of a lane run in
+ * parallel. Workers which have nothing to do in their own lane help out with the lanes
+ * of higher priority, but never with lower ones, so background work can never occupy
+ * the workers needed for a folder listing the user is waiting for. Workers whose job
+ * waits for the user (a question dialog or a paused operation) do not count against
+ * the limit, so they can never hold back the jobs queued behind them. */
+static const guint thunar_job_lane_max_workers[THUNAR_JOB_N_PRIORITIES] =
+{
+  4, /* THUNAR_JOB_PRIORITY_INTERACTIVE */
+  4, /* THUNAR_JOB_PRIORITY_VISIBLE */
+  8, /* THUNAR_JOB_PRIORITY_FILE_OPERATION */
+  2, /* THUNAR_JOB_PRIORITY_BACKGROUND */
+};
+
+/* time after which an idle worker thread exits */
+#define THUNAR_JOB_WORKER_IDLE_TIMEOUT (15 * G_TIME_SPAN_SECOND)
+
+static struct
+{
+  GMutex lock;
+  GCond  cond;
+  GQueue lanes[THUNAR_JOB_N_PRIORITIES];
+  guint  n_workers[THUNAR_JOB_N_PRIORITIES];
+  guint  n_idle_workers[THUNAR_JOB_N_PRIORITIES];
+  guint  n_blocked_workers[THUNAR_JOB_N_PRIORITIES];
+} job_scheduler;
+
+
+
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (ThunarJob, thunar_job, G_TYPE_OBJECT)
 
 
@@ -355,7 +441,11 @@ thunar_job_init (ThunarJob *job)
 
   job->priv->cancellable = g_cancellable_new ();
   job->priv->running = FALSE;
-  job->priv->scheduler_job = NULL;
+  job->priv->priority = THUNAR_JOB_PRIORITY_FILE_OPERATION;
+  job->priv->scheduler_link = NULL;
+  job->priv->worker_lane = THUNAR_JOB_N_PRIORITIES;
+  job->priv->n_blocks = 0;
+  job->priv->events_scheduled = FALSE;
   job->priv->error = NULL;
   job->priv->failed = FALSE;
   job->priv->context = NULL;
@@ -364,6 +454,8 @@ thunar_job_init (ThunarJob *job)
   job->priv->earlier_ask_overwrite_response_folder = 0;
   job->priv->earlier_ask_delete_response = 0;
   job->priv->earlier_ask_skip_response = 0;
+  job->priv->current_file = NULL;
+  g_mutex_init (&job->priv->current_file_lock);
   job->priv->n_total_files = 0;
   job->priv->pausable = FALSE;
   job->priv->paused = FALSE;
@@ -375,6 +467,37 @@ thunar_job_init (ThunarJob *job)
 
 
 
+static void
+thunar_job_event_free (ThunarJobEvent *event)
+{
+  if (event->pointer_notify != NULL)
+    (*event->pointer_notify) (g_value_get_pointer (&event->values[1]));
+
+  for (guint n = 0; n < event->n_values; ++n)
+    g_value_unset (&event->values[n]);
+  g_free (event->values);
+
+  g_slice_free (ThunarJobEvent, event);
+}
+
+
+
+/* atomically replaces the event in @slot by @event and returns the previous one */
+static ThunarJobEvent *
+thunar_job_event_exchange (gpointer       *slot,
+                           ThunarJobEvent *event)
+{
+  gpointer old_event;
+
+  do
+    old_event = g_atomic_pointer_get (slot);
+  while (!g_atomic_pointer_compare_and_exchange (slot, old_event, event));
+
+  return old_event;
+}
+
+
+
 static void
 thunar_job_finalize (GObject *object)
 {
@@ -383,6 +506,11 @@ thunar_job_finalize (GObject *object)
   if (job->priv->running)
     thunar_job_cancel (job);
 
+  /* drop events which were never delivered */
+  for (guint slot = 0; slot < THUNAR_JOB_N_EVENT_SLOTS; ++slot)
+    if (job->priv->event_slots[slot] != NULL)
+      thunar_job_event_free (job->priv->event_slots[slot]);
+
   if (job->priv->error != NULL)
     g_error_free (job->priv->error);
 
@@ -391,6 +519,9 @@ thunar_job_finalize (GObject *object)
   if (job->priv->context != NULL)
     g_main_context_unref (job->priv->context);
 
+  g_clear_object (&job->priv->current_file);
+  g_mutex_clear (&job->priv->current_file_lock);
+
   (*G_OBJECT_CLASS (thunar_job_parent_class)->finalize) (object);
 }
 
@@ -401,7 +532,7 @@ thunar_job_finalize (GObject *object)
  * @object : a #ThunarJob.
  * @result : the #GAsyncResult of the job.
  *
- * This function is called by the #GIOScheduler at the end of the
+ * This function is called in the main loop at the end of the
  * operation. It checks if there were errors during the operation
  * and emits "error" and "finished" signals.
  **/
@@ -409,9 +540,15 @@ static gboolean
 thunar_job_async_ready (gpointer user_data)
 {
   ThunarJob *job = THUNAR_JOB (user_data);
+  gint64     trace_time;
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
 
+  trace_time = thunar_trace_begin ();
+
+  /* deliver the remaining progress before the job finishes */
+  thunar_job_flush_events (job);
+
   if (job->priv->failed)
     {
       g_assert (job->priv->error != NULL);
@@ -429,36 +566,58 @@ thunar_job_async_ready (gpointer user_data)
 
   job->priv->running = FALSE;
 
+  thunar_trace_end_detail (trace_time, "job", "thunar_job_async_ready", "%s", G_OBJECT_TYPE_NAME (job));
+
   return FALSE;
 }
 
 
 /**
- * thunar_job_scheduler_job_func:
- * @scheduler_job : the #GIOSchedulerJob running the operation.
- * @cancellable   : the #GCancellable associated with the job.
- * @user_data     : a #ThunarJob.
- *
- * This function is called by the #GIOScheduler to execute the
- * operation associated with the job. It basically calls the
- * execute() function of #ThunarJobClass.
+ * thunar_job_complete:
+ * @job : a #ThunarJob.
  *
- * Returns: %FALSE, to stop the thread at the end of the operation.
+ * Schedules thunar_job_async_ready() in the context the @job was
+ * launched from, taking over a reference on @job.
  **/
-static gboolean
-thunar_job_scheduler_job_func (GIOSchedulerJob *scheduler_job,
-                               GCancellable    *cancellable,
-                               gpointer         user_data)
+static void
+thunar_job_complete (ThunarJob *job)
 {
-  ThunarJob *job = THUNAR_JOB (user_data);
-  GError    *error = NULL;
-  gboolean   success;
-  GSource   *source;
+  GSource *source;
 
-  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
-  _thunar_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+  /* the worker is done with the job, even if it is still paused */
+  g_mutex_lock (&job_scheduler.lock);
+  if (G_UNLIKELY (job->priv->n_blocks > 0))
+    job_scheduler.n_blocked_workers[job->priv->worker_lane]--;
+  job->priv->n_blocks = 0;
+  job->priv->worker_lane = THUNAR_JOB_N_PRIORITIES;
+  g_mutex_unlock (&job_scheduler.lock);
+
+  /* idle completion in the thread ThunarJob was started from */
+  source = g_idle_source_new ();
+  g_source_set_priority (source, G_PRIORITY_DEFAULT);
+  g_source_set_callback (source, thunar_job_async_ready, job, g_object_unref);
+  g_source_attach (source, job->priv->context);
+  g_source_unref (source);
+}
+
+
+
+/**
+ * thunar_job_run:
+ * @job : a #ThunarJob.
+ *
+ * Called in a worker thread to execute the operation associated with
+ * the @job. It basically calls the execute() function of
+ * #ThunarJobClass and takes over the reference the scheduler held
+ * on @job.
+ **/
+static void
+thunar_job_run (ThunarJob *job)
+{
+  GError  *error = NULL;
+  gboolean success;
 
-  job->priv->scheduler_job = scheduler_job;
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
 
   success = (*THUNAR_JOB_GET_CLASS (job)->execute) (job, &error);
 
@@ -474,13 +633,163 @@ thunar_job_scheduler_job_func (GIOSchedulerJob *scheduler_job,
 
   job->priv->failed = !success;
 
-  /* idle completion in the thread ThunarJob was started from */
-  source = g_idle_source_new ();
-  g_source_set_priority (source, G_PRIORITY_DEFAULT);
-  g_source_set_callback (source, thunar_job_async_ready, g_object_ref (job),
-                         g_object_unref);
-  g_source_attach (source, job->priv->context);
-  g_source_unref (source);
+  thunar_job_complete (job);
+}
+
+
+
+/* returns the next job for a worker of the @home lane, called with the scheduler lock held */
+static ThunarJob *
+thunar_job_scheduler_pop (ThunarJobPriority home)
+{
+  ThunarJob *job;
+  guint      lane;
+
+  /* own lane first, then help out with the lanes of higher priority */
+  job = g_queue_pop_head (&job_scheduler.lanes[home]);
+  for (lane = 0; job == NULL && lane < home; ++lane)
+    job = g_queue_pop_head (&job_scheduler.lanes[lane]);
+
+  if (job != NULL)
+    {
+      job->priv->scheduler_link = NULL;
+      job->priv->worker_lane = home;
+    }
+
+  return job;
+}
+
+
+
+static gpointer
+thunar_job_scheduler_worker (gpointer user_data)
+{
+  ThunarJobPriority home = GPOINTER_TO_UINT (user_data);
+  ThunarJob        *job;
+  gint64            end_time;
+
+  g_mutex_lock (&job_scheduler.lock);
+
+  for (;;)
+    {
+      /* wait for new jobs, or exit once we were idle for a while */
+      end_time = g_get_monotonic_time () + THUNAR_JOB_WORKER_IDLE_TIMEOUT;
+      job_scheduler.n_idle_workers[home]++;
+      while ((job = thunar_job_scheduler_pop (home)) == NULL)
+        if (!g_cond_wait_until (&job_scheduler.cond, &job_scheduler.lock, end_time))
+          {
+            job = thunar_job_scheduler_pop (home);
+            break;
+          }
+      job_scheduler.n_idle_workers[home]--;
+
+      if (job == NULL)
+        break;
+
+      g_mutex_unlock (&job_scheduler.lock);
+      thunar_job_run (job);
+      g_mutex_lock (&job_scheduler.lock);
+    }
+
+  job_scheduler.n_workers[home]--;
+
+  g_mutex_unlock (&job_scheduler.lock);
+
+  return NULL;
+}
+
+
+
+/* wakes up or spawns a worker for a job queued in @lane, called with the scheduler lock held */
+static void
+thunar_job_scheduler_wakeup (ThunarJobPriority lane)
+{
+  GThread *thread;
+  GError  *error = NULL;
+  guint    n_idle_workers = 0;
+  guint    home;
+
+  /* wake up the idle workers which may take jobs of the lane */
+  for (home = lane; home < THUNAR_JOB_N_PRIORITIES; ++home)
+    n_idle_workers += job_scheduler.n_idle_workers[home];
+  if (n_idle_workers > 0)
+    g_cond_broadcast (&job_scheduler.cond);
+
+  /* start a new worker if there are not enough of them, unless the lane is at its limit already */
+  if (n_idle_workers >= job_scheduler.lanes[lane].length
+      || job_scheduler.n_workers[lane] - job_scheduler.n_blocked_workers[lane] >= thunar_job_lane_max_workers[lane])
+    return;
+
+  thread = g_thread_try_new ("ThunarJob", thunar_job_scheduler_worker, GUINT_TO_POINTER (lane), &error);
+  if (G_UNLIKELY (thread == NULL))
+    {
+      g_warning ("Failed to start job worker thread: %s", error->message);
+      g_error_free (error);
+      return;
+    }
+
+  job_scheduler.n_workers[lane]++;
+  g_thread_unref (thread);
+}
+
+
+
+/* marks the worker running @job as waiting for the user, so the lane may start another one */
+static void
+thunar_job_scheduler_block (ThunarJob *job)
+{
+  ThunarJobPriority lane;
+
+  g_mutex_lock (&job_scheduler.lock);
+
+  lane = job->priv->worker_lane;
+  if (lane < THUNAR_JOB_N_PRIORITIES && job->priv->n_blocks++ == 0)
+    {
+      job_scheduler.n_blocked_workers[lane]++;
+      if (job_scheduler.lanes[lane].length > 0)
+        thunar_job_scheduler_wakeup (lane);
+    }
+
+  g_mutex_unlock (&job_scheduler.lock);
+}
+
+
+
+static void
+thunar_job_scheduler_unblock (ThunarJob *job)
+{
+  ThunarJobPriority lane;
+
+  g_mutex_lock (&job_scheduler.lock);
+
+  lane = job->priv->worker_lane;
+  if (lane < THUNAR_JOB_N_PRIORITIES && job->priv->n_blocks > 0 && --job->priv->n_blocks == 0)
+    job_scheduler.n_blocked_workers[lane]--;
+
+  g_mutex_unlock (&job_scheduler.lock);
+}
+
+
+
+static gboolean
+thunar_job_mainloop_call_dispatch (gpointer user_data)
+{
+  ThunarJobMainloopCall *call = user_data;
+  gboolean               result;
+
+  /* the pending progress was posted before, so deliver it first */
+  thunar_job_flush_events (call->job);
+
+  result = (*call->func) (call->user_data);
+  if (call->destroy_notify != NULL)
+    (*call->destroy_notify) (call->user_data);
+
+  /* wake up the waiting job, @call is gone as soon as the lock is released */
+  g_mutex_lock (&call->lock);
+  call->result = result;
+  call->done = TRUE;
+  g_cond_signal (&call->cond);
+  g_mutex_unlock (&call->lock);
 
   return FALSE;
 }
@@ -531,7 +840,7 @@ thunar_job_emit_valist (ThunarJob *job,
   ThunarJobSignalData data;
 
   _thunar_return_if_fail (THUNAR_IS_JOB (job));
-  _thunar_return_if_fail (job->priv->scheduler_job != NULL);
+  _thunar_return_if_fail (job->priv->running);
 
   data.instance = job;
   data.signal_id = signal_id;
@@ -550,6 +859,157 @@ thunar_job_emit_valist (ThunarJob *job,
 
 
 
+/**
+ * thunar_job_flush_events:
+ * @job : a #ThunarJob.
+ *
+ * Emits the events posted by thunar_job_emit_coalesced() which were not
+ * delivered yet. Must be called from the main loop of the application.
+ **/
+static void
+thunar_job_flush_events (ThunarJob *job)
+{
+  ThunarJobEvent *event;
+  GValue          return_value = G_VALUE_INIT;
+
+  for (guint slot = 0; slot < THUNAR_JOB_N_EVENT_SLOTS; ++slot)
+    {
+      event = thunar_job_event_exchange (&job->priv->event_slots[slot], NULL);
+      if (event == NULL)
+        continue;
+
+      if (event->return_type != G_TYPE_NONE)
+        {
+          g_value_init (&return_value, event->return_type);
+          g_signal_emitv (event->values, event->signal_id, event->signal_detail, &return_value);
+
+          /* a handler took over the file list of "files-ready" */
+          if (event->return_type == G_TYPE_BOOLEAN && g_value_get_boolean (&return_value))
+            event->pointer_notify = NULL;
+
+          g_value_unset (&return_value);
+        }
+      else
+        {
+          g_signal_emitv (event->values, event->signal_id, event->signal_detail, NULL);
+        }
+
+      thunar_job_event_free (event);
+    }
+}
+
+
+
+static gboolean
+thunar_job_events_timeout (gpointer user_data)
+{
+  ThunarJob *job = THUNAR_JOB (user_data);
+
+  /* reset first, so events posted from now on schedule a new delivery */
+  g_atomic_int_set (&job->priv->events_scheduled, FALSE);
+  thunar_job_flush_events (job);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+
+/**
+ * thunar_job_emit_coalesced_valist:
+ * @job           : a #ThunarJob.
+ * @signal_id     : the signal id.
+ * @signal_detail : the signal detail.
+ * @var_args      : a list of parameters to be passed to the signal.
+ *
+ * Posts the signal with the given @signal_id to the main loop of the
+ * application without waiting for it. See thunar_job_emit_coalesced().
+ **/
+static void
+thunar_job_emit_coalesced_valist (ThunarJob *job,
+                                  guint      signal_id,
+                                  GQuark     signal_detail,
+                                  va_list    var_args)
+{
+  ThunarJobEvent *event;
+  ThunarJobEvent *old_event;
+  GSignalQuery    query;
+  GSource        *source;
+  gchar          *error_message = NULL;
+  GList          *file_list;
+  guint           slot;
+
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+  _thunar_return_if_fail (job->priv->running);
+
+  g_signal_query (signal_id, &query);
+
+  /* find the slot of the signal, or claim a new one */
+  for (slot = 0; slot < THUNAR_JOB_N_EVENT_SLOTS; ++slot)
+    if (job->priv->event_slot_signals[slot] == signal_id || job->priv->event_slot_signals[slot] == 0)
+      break;
+
+  if (G_UNLIKELY (slot == THUNAR_JOB_N_EVENT_SLOTS))
+    {
+      /* out of slots, fall back to a synchronous emission */
+      thunar_job_emit_valist (job, signal_id, signal_detail, var_args);
+      return;
+    }
+  job->priv->event_slot_signals[slot] = signal_id;
+
+  /* collect the parameters */
+  event = g_slice_new0 (ThunarJobEvent);
+  event->signal_id = signal_id;
+  event->signal_detail = signal_detail;
+  event->return_type = query.return_type & ~G_SIGNAL_TYPE_STATIC_SCOPE;
+  event->n_values = query.n_params + 1;
+  event->values = g_new0 (GValue, event->n_values);
+  g_value_init_from_instance (&event->values[0], job);
+  for (guint n = 0; n < query.n_params; ++n)
+    {
+      G_VALUE_COLLECT_INIT (&event->values[n + 1], query.param_types[n] & ~G_SIGNAL_TYPE_STATIC_SCOPE,
+                            var_args, 0, &error_message);
+      if (G_UNLIKELY (error_message != NULL))
+        {
+          g_warning ("%s: %s", G_STRLOC, error_message);
+          g_free (error_message);
+          event->n_values = n + 1;
+          thunar_job_event_free (event);
+          return;
+        }
+    }
+
+  if (signal_id == job_signals[FILES_READY])
+    {
+      /* file lists are not replaced, but appended to the pending one */
+      event->pointer_notify = (GDestroyNotify) thunar_g_list_free_full;
+      old_event = thunar_job_event_exchange (&job->priv->event_slots[slot], NULL);
+      if (old_event != NULL)
+        {
+          file_list = g_list_concat (g_value_get_pointer (&old_event->values[1]), g_value_get_pointer (&event->values[1]));
+          g_value_set_pointer (&event->values[1], file_list);
+          old_event->pointer_notify = NULL;
+          thunar_job_event_free (old_event);
+        }
+    }
+
+  /* replace the pending event of the signal, if any */
+  old_event = thunar_job_event_exchange (&job->priv->event_slots[slot], event);
+  if (old_event != NULL)
+    thunar_job_event_free (old_event);
+
+  /* schedule the delivery, unless it is already scheduled */
+  if (g_atomic_int_compare_and_exchange (&job->priv->events_scheduled, FALSE, TRUE))
+    {
+      source = g_timeout_source_new (THUNAR_JOB_EVENT_INTERVAL);
+      g_source_set_priority (source, G_PRIORITY_DEFAULT);
+      g_source_set_callback (source, thunar_job_events_timeout, g_object_ref (job), g_object_unref);
+      g_source_attach (source, job->priv->context);
+      g_source_unref (source);
+    }
+}
+
+
+
 /**
  * thunar_job_error:
  * @job   : a #ThunarJob.
@@ -595,9 +1055,10 @@ thunar_job_finished (ThunarJob *job)
  * @job : a #ThunarJob.
  *
  * This functions schedules the @job to be run as soon as possible, in
- * a separate thread. The caller can connect to signals of the @job prior
- * or after this call in order to be notified on errors, progress updates
- * and the end of the operation.
+ * a separate thread. Jobs are started in the order of their priority,
+ * see thunar_job_set_priority(). The caller can connect to signals of
+ * the @job prior or after this call in order to be notified on errors,
+ * progress updates and the end of the operation.
  *
  * Returns: the @job itself.
  **/
@@ -613,17 +1074,79 @@ thunar_job_launch (ThunarJob *job)
 
   job->priv->context = g_main_context_ref_thread_default ();
 
-  G_GNUC_BEGIN_IGNORE_DEPRECATIONS
-  g_io_scheduler_push_job (thunar_job_scheduler_job_func, g_object_ref (job),
-                           (GDestroyNotify) g_object_unref,
-                           G_PRIORITY_HIGH, job->priv->cancellable);
-  G_GNUC_END_IGNORE_DEPRECATIONS
+  /* queue the job, the scheduler holds a reference until it has been executed */
+  g_mutex_lock (&job_scheduler.lock);
+  g_queue_push_tail (&job_scheduler.lanes[job->priv->priority], g_object_ref (job));
+  job->priv->scheduler_link = g_queue_peek_tail_link (&job_scheduler.lanes[job->priv->priority]);
+  thunar_job_scheduler_wakeup (job->priv->priority);
+  g_mutex_unlock (&job_scheduler.lock);
 
   return job;
 }
 
 
 
+/**
+ * thunar_job_set_priority:
+ * @job      : a #ThunarJob.
+ * @priority : the new #ThunarJobPriority.
+ *
+ * Sets the priority of @job, which defaults to
+ * %THUNAR_JOB_PRIORITY_FILE_OPERATION. If @job was launched but did not
+ * start to run yet, it is moved to the end of the queue of @priority, so
+ * views can demote the work for content the user navigated away from, or
+ * promote it once it becomes visible again.
+ *
+ * The priority of a job which is already running has no effect.
+ **/
+void
+thunar_job_set_priority (ThunarJob        *job,
+                         ThunarJobPriority priority)
+{
+  GList *link;
+
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+  _thunar_return_if_fail (priority < THUNAR_JOB_N_PRIORITIES);
+
+  g_mutex_lock (&job_scheduler.lock);
+
+  link = job->priv->scheduler_link;
+  if (link != NULL && job->priv->priority != priority)
+    {
+      g_queue_unlink (&job_scheduler.lanes[job->priv->priority], link);
+      g_queue_push_tail_link (&job_scheduler.lanes[priority], link);
+      thunar_job_scheduler_wakeup (priority);
+    }
+
+  job->priv->priority = priority;
+
+  g_mutex_unlock (&job_scheduler.lock);
+}
+
+
+
+/**
+ * thunar_job_get_priority:
+ * @job : a #ThunarJob.
+ *
+ * Returns: the #ThunarJobPriority of @job.
+ **/
+ThunarJobPriority
+thunar_job_get_priority (ThunarJob *job)
+{
+  ThunarJobPriority priority;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), THUNAR_JOB_PRIORITY_FILE_OPERATION);
+
+  g_mutex_lock (&job_scheduler.lock);
+  priority = job->priv->priority;
+  g_mutex_unlock (&job_scheduler.lock);
+
+  return priority;
+}
+
+
+
 /**
  * thunar_job_cancel:
  * @job : a #ThunarJob.
@@ -633,16 +1156,44 @@ thunar_job_launch (ThunarJob *job)
  * must take care of disconnecting all handlers appropriately if you
  * cannot handle signals after cancellation.
  *
+ * If the @job is still waiting to be run, it is dropped from the queue
+ * and finishes without being executed at all.
+ *
  * Calling this function when the @job has not been launched yet or
  * when it has already finished will have no effect.
  **/
 void
 thunar_job_cancel (ThunarJob *job)
 {
+  GList *link;
+
   _thunar_return_if_fail (THUNAR_IS_JOB (job));
 
-  if (job->priv->running)
-    g_cancellable_cancel (job->priv->cancellable);
+  if (!job->priv->running)
+    return;
+
+  g_cancellable_cancel (job->priv->cancellable);
+
+  /* drop the job from the queue if it did not start yet */
+  g_mutex_lock (&job_scheduler.lock);
+  link = job->priv->scheduler_link;
+  if (link != NULL)
+    {
+      g_queue_unlink (&job_scheduler.lanes[job->priv->priority], link);
+      job->priv->scheduler_link = NULL;
+    }
+  g_mutex_unlock (&job_scheduler.lock);
+
+  if (link != NULL)
+    {
+      job->priv->failed = TRUE;
+      if (job->priv->error == NULL)
+        g_cancellable_set_error_if_cancelled (job->priv->cancellable, &job->priv->error);
+
+      /* the reference of the queue is passed on to the completion */
+      thunar_job_complete (link->data);
+      g_list_free_1 (link);
+    }
 }
 
 
@@ -720,7 +1271,8 @@ thunar_job_set_error_if_cancelled (ThunarJob *job,
  *                  value location can be omitted.
  *
  * Sends the signal with @signal_id and @signal_detail to the application's
- * main loop and waits for listeners to handle it.
+ * main loop and waits for listeners to handle it. Progress reports, which
+ * need no answer, should use thunar_job_emit_coalesced() instead.
  **/
 void
 thunar_job_emit (ThunarJob *job,
@@ -739,14 +1291,48 @@ thunar_job_emit (ThunarJob *job,
 
 
 
+/**
+ * thunar_job_emit_coalesced:
+ * @job           : a #ThunarJob.
+ * @signal_id     : the signal id, of a signal without return value or "files-ready".
+ * @signal_detail : the signal detail.
+ * @...           : a list of parameters to be passed to the signal.
+ *
+ * Posts the signal with @signal_id to the application's main loop without
+ * waiting for listeners to handle it. The main loop delivers pending signals
+ * about once per frame, only the latest emission of each signal is delivered.
+ * The file lists of "files-ready" are appended to each other instead.
+ *
+ * Use this for progress reports, which may become outdated anyway. All pending
+ * signals are delivered before the job finishes or asks the user.
+ *
+ * Must be called from the thread running @job.
+ **/
+void
+thunar_job_emit_coalesced (ThunarJob *job,
+                           guint      signal_id,
+                           GQuark     signal_detail,
+                           ...)
+{
+  va_list var_args;
+
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+
+  va_start (var_args, signal_detail);
+  thunar_job_emit_coalesced_valist (job, signal_id, signal_detail, var_args);
+  va_end (var_args);
+}
+
+
+
 /**
  * thunar_job_info_message:
  * @job     : a #ThunarJob.
  * @format  : a format string.
  * @...     : parameters for the format string.
  *
- * Generates and emits an "info-message" signal and sends it to the
- * application's main loop.
+ * Generates and emits an "info-message" signal and posts it to the
+ * application's main loop, without waiting for it to be handled.
  **/
 void
 thunar_job_info_message (ThunarJob   *job,
@@ -762,7 +1348,7 @@ thunar_job_info_message (ThunarJob   *job,
   va_start (var_args, format);
   message = g_strdup_vprintf (format, var_args);
 
-  thunar_job_emit (job, job_signals[INFO_MESSAGE], 0, message);
+  thunar_job_emit_coalesced (job, job_signals[INFO_MESSAGE], 0, message);
 
   g_free (message);
   va_end (var_args);
@@ -775,8 +1361,9 @@ thunar_job_info_message (ThunarJob   *job,
  * @job     : a #ThunarJob.
  * @percent : percentage of completeness of the operation.
  *
- * Emits a "percent" signal and sends it to the application's main
- * loop. Also makes sure that @percent is between 0.0 and 100.0.
+ * Emits a "percent" signal and posts it to the application's main
+ * loop, without waiting for it to be handled. Also makes sure that
+ * @percent is between 0.0 and 100.0.
  **/
 void
 thunar_job_percent (ThunarJob *job,
@@ -785,7 +1372,7 @@ thunar_job_percent (ThunarJob *job,
   _thunar_return_if_fail (THUNAR_IS_JOB (job));
 
   percent = CLAMP (percent, 0.0, 100.0);
-  thunar_job_emit (job, job_signals[PERCENT], 0, percent);
+  thunar_job_emit_coalesced (job, job_signals[PERCENT], 0, percent);
 }
 
 
@@ -808,13 +1395,39 @@ thunar_job_send_to_mainloop (ThunarJob     *job,
                              gpointer       user_data,
                              GDestroyNotify destroy_notify)
 {
+  ThunarJobMainloopCall call;
+  GSource              *source;
+
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
-  _thunar_return_val_if_fail (job->priv->scheduler_job != NULL, FALSE);
+  _thunar_return_val_if_fail (job->priv->running, FALSE);
+
+  call.job = job;
+  call.func = func;
+  call.user_data = user_data;
+  call.destroy_notify = destroy_notify;
+  call.result = FALSE;
+  call.done = FALSE;
+  g_mutex_init (&call.lock);
+  g_cond_init (&call.cond);
+
+  source = g_idle_source_new ();
+  g_source_set_priority (source, G_PRIORITY_DEFAULT);
+  g_source_set_callback (source, thunar_job_mainloop_call_dispatch, &call, NULL);
+  g_source_attach (source, job->priv->context);
+  g_source_unref (source);
+
+  /* wait for the main loop to run the function */
+  thunar_job_scheduler_block (job);
+  g_mutex_lock (&call.lock);
+  while (!call.done)
+    g_cond_wait (&call.cond, &call.lock);
+  g_mutex_unlock (&call.lock);
+  thunar_job_scheduler_unblock (job);
+
+  g_mutex_clear (&call.lock);
+  g_cond_clear (&call.cond);
 
-  G_GNUC_BEGIN_IGNORE_DEPRECATIONS
-  return g_io_scheduler_job_send_to_mainloop (job->priv->scheduler_job, func, user_data,
-                                              destroy_notify);
-  G_GNUC_END_IGNORE_DEPRECATIONS
+  return call.result;
 }
 
 static ThunarJobResponse
@@ -1228,12 +1841,11 @@ gboolean
 thunar_job_files_ready (ThunarJob *job,
                         GList     *file_list)
 {
-  gboolean handled = FALSE;
-
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
 
-  thunar_job_emit (THUNAR_JOB (job), job_signals[FILES_READY], 0, file_list, &handled);
-  return handled;
+  /* the list is released after the emission, unless a handler takes it over */
+  thunar_job_emit_coalesced (THUNAR_JOB (job), job_signals[FILES_READY], 0, file_list);
+  return TRUE;
 }
 
 
@@ -1306,7 +1918,12 @@ void
 thunar_job_pause (ThunarJob *job)
 {
   _thunar_return_if_fail (THUNAR_IS_JOB (job));
-  job->priv->paused = TRUE;
+
+  if (!job->priv->paused)
+    {
+      job->priv->paused = TRUE;
+      thunar_job_scheduler_block (job);
+    }
 }
 
 
@@ -1315,7 +1932,12 @@ void
 thunar_job_resume (ThunarJob *job)
 {
   _thunar_return_if_fail (THUNAR_IS_JOB (job));
-  job->priv->paused = FALSE;
+
+  if (job->priv->paused)
+    {
+      job->priv->paused = FALSE;
+      thunar_job_scheduler_unblock (job);
+    }
 }
 
 
@@ -1369,6 +1991,8 @@ thunar_job_processing_file (ThunarJob *job,
   _thunar_return_if_fail (THUNAR_IS_JOB (job));
   _thunar_return_if_fail (current_file != NULL);
 
+  thunar_job_set_current_file (job, current_file->data);
+
   /* emit only if n_processed is a multiple of 8 */
   if ((n_processed % 8) != 0)
     return;
@@ -1387,6 +2011,64 @@ thunar_job_processing_file (ThunarJob *job,
 
 
 
+/**
+ * thunar_job_set_current_file:
+ * @job  : a #ThunarJob.
+ * @file : the #GFile the @job is working on, or %NULL.
+ *
+ * Remembers the file the @job is working on, so the handlers of the
+ * "ask" and "error" signals can tell which file they are about. May
+ * be called from the thread of the @job.
+ **/
+void
+thunar_job_set_current_file (ThunarJob *job,
+                             GFile     *file)
+{
+  GFile *old_file;
+
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+  _thunar_return_if_fail (file == NULL || G_IS_FILE (file));
+
+  if (file != NULL)
+    g_object_ref (file);
+
+  g_mutex_lock (&job->priv->current_file_lock);
+  old_file = job->priv->current_file;
+  job->priv->current_file = file;
+  g_mutex_unlock (&job->priv->current_file_lock);
+
+  if (old_file != NULL)
+    g_object_unref (old_file);
+}
+
+
+
+/**
+ * thunar_job_dup_current_file:
+ * @job : a #ThunarJob.
+ *
+ * Returns the file the @job is working on, see thunar_job_set_current_file().
+ *
+ * Return value: (transfer full) (nullable): the #GFile, to be released
+ *               with g_object_unref(), or %NULL.
+ **/
+GFile *
+thunar_job_dup_current_file (ThunarJob *job)
+{
+  GFile *file = NULL;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), NULL);
+
+  g_mutex_lock (&job->priv->current_file_lock);
+  if (job->priv->current_file != NULL)
+    file = g_object_ref (job->priv->current_file);
+  g_mutex_unlock (&job->priv->current_file_lock);
+
+  return file;
+}
+
+
+
 void
 thunar_job_set_log_mode (ThunarJob             *job,
                          ThunarOperationLogMode log_mode)
@@ -30,6 +30,24 @@
 
 G_BEGIN_DECLS
 
+/**
+ * ThunarJobPriority:
+ * @THUNAR_JOB_PRIORITY_INTERACTIVE    : work the user is waiting for, like listing a folder.
+ * @THUNAR_JOB_PRIORITY_VISIBLE        : work for content which is currently visible.
+ * @THUNAR_JOB_PRIORITY_FILE_OPERATION : file operations started by the user (the default).
+ * @THUNAR_JOB_PRIORITY_BACKGROUND     : background work like deep counts or recursive searches.
+ *
+ * The priority classes (lanes) of the job scheduler, from high to low.
+ **/
+typedef enum
+{
+  THUNAR_JOB_PRIORITY_INTERACTIVE,
+  THUNAR_JOB_PRIORITY_VISIBLE,
+  THUNAR_JOB_PRIORITY_FILE_OPERATION,
+  THUNAR_JOB_PRIORITY_BACKGROUND,
+  THUNAR_JOB_N_PRIORITIES,
+} ThunarJobPriority;
+
 typedef struct _ThunarJobPrivate ThunarJobPrivate;
 typedef struct _ThunarJobClass   ThunarJobClass;
 typedef struct _ThunarJob        ThunarJob;
@@ -79,6 +97,11 @@ thunar_job_get_type (void);
 ThunarJob *
 thunar_job_launch (ThunarJob *job);
 void
+thunar_job_set_priority (ThunarJob        *job,
+                         ThunarJobPriority priority);
+ThunarJobPriority
+thunar_job_get_priority (ThunarJob *job);
+void
 thunar_job_cancel (ThunarJob *job);
 gboolean
 thunar_job_is_cancelled (const ThunarJob *job);
@@ -93,6 +116,11 @@ thunar_job_emit (ThunarJob *job,
                  GQuark     signal_detail,
                  ...);
 void
+thunar_job_emit_coalesced (ThunarJob *job,
+                           guint      signal_id,
+                           GQuark     signal_detail,
+                           ...);
+void
 thunar_job_info_message (ThunarJob   *job,
                          const gchar *format,
                          ...);
@@ -131,6 +159,11 @@ void
 thunar_job_processing_file (ThunarJob *job,
                             GList     *current_file,
                             guint      n_processed);
+void
+thunar_job_set_current_file (ThunarJob *job,
+                             GFile     *file);
+GFile *
+thunar_job_dup_current_file (ThunarJob *job);
 
 ThunarJobResponse
 thunar_job_ask_create (ThunarJob   *job,
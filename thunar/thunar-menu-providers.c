@@ -0,0 +1,439 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include "thunar/thunar-menu-providers.h"
+
+#include "thunar/thunar-gio-extensions.h"
+#include "thunar/thunar-private.h"
+#include "thunar/thunar-trace.h"
+
+#include <thunarx/thunarx.h>
+
+/**
+ * SECTION:thunar-menu-providers
+ * @Short_description: Collects the menu items of the #ThunarxMenuProvider<!---->s
+ * @Title: ThunarMenuProviders
+ *
+ * The menu providers are queried whenever a context menu is shown, a file is
+ * dropped or a key is pressed in the window (to check for custom action
+ * shortcuts). The results of every provider are cached per query, and stay
+ * valid until the selection changes or one of the files involved is changed.
+ *
+ * Providers are called on the main thread, so a slow provider can't be
+ * interrupted. Instead, providers which were slow the last time, or which are
+ * called once the time budget for the menu is used up, are queried from an
+ * idle source after the menu is shown, and their items are handed to the
+ * caller asynchronously.
+ *
+ * The time spent in every provider is logged with g_debug(), use
+ * G_MESSAGES_DEBUG=all to find slow plugins.
+ */
+
+
+
+/* time to spend in the menu providers before deferring the remaining ones */
+#define THUNAR_MENU_PROVIDERS_BUDGET (50 * G_TIME_SPAN_MILLISECOND)
+
+/* providers which took longer than this are deferred the next time */
+#define THUNAR_MENU_PROVIDERS_SLOW (20 * G_TIME_SPAN_MILLISECOND)
+
+/* providers may change their items for other reasons than file changes
+ * (e.g. the custom actions were edited), so cached items expire */
+#define THUNAR_MENU_PROVIDERS_CACHE_TTL (5 * G_TIME_SPAN_SECOND)
+
+
+
+typedef struct _ThunarMenuProvidersEntry    ThunarMenuProvidersEntry;
+typedef struct _ThunarMenuProvidersState    ThunarMenuProvidersState;
+typedef struct _ThunarMenuProvidersDeferred ThunarMenuProvidersDeferred;
+
+
+
+static gboolean
+thunar_menu_providers_file_changed (GSignalInvocationHint *ihint,
+                                    guint                  n_param_values,
+                                    const GValue          *param_values,
+                                    gpointer               user_data);
+
+
+
+struct _ThunarMenuProvidersEntry
+{
+  gboolean    valid;
+  gint64      time;
+  GtkWidget  *window; /* weak pointer */
+  ThunarFile *folder;
+  GList      *files;
+  GHashTable *file_set;
+  GList      *items;
+};
+
+struct _ThunarMenuProvidersState
+{
+  ThunarxMenuProvider     *provider;
+  gint64                   last_duration;
+  ThunarMenuProvidersEntry entries[THUNAR_MENU_PROVIDERS_N_QUERIES];
+};
+
+struct _ThunarMenuProvidersDeferred
+{
+  ThunarMenuProvidersQuery query;
+  GtkWidget               *window;
+  ThunarFile              *folder;
+  GList                   *files;
+  GList                   *providers;
+  ThunarMenuProvidersFunc  func;
+  gpointer                 user_data;
+  GCancellable            *cancellable;
+};
+
+
+
+static GQuark  thunar_menu_providers_quark = 0;
+static GList  *thunar_menu_providers_states = NULL;
+
+
+
+static void
+thunar_menu_providers_entry_clear (ThunarMenuProvidersEntry *entry)
+{
+  if (entry->window != NULL)
+    g_object_remove_weak_pointer (G_OBJECT (entry->window), (gpointer *) &entry->window);
+  if (entry->folder != NULL)
+    g_object_unref (entry->folder);
+  if (entry->file_set != NULL)
+    g_hash_table_destroy (entry->file_set);
+  thunar_g_list_free_full (entry->files);
+  g_list_free_full (entry->items, g_object_unref);
+
+  memset (entry, 0, sizeof (*entry));
+}
+
+
+
+static void
+thunar_menu_providers_state_free (gpointer data)
+{
+  ThunarMenuProvidersState *state = data;
+  guint                     n;
+
+  thunar_menu_providers_states = g_list_remove (thunar_menu_providers_states, state);
+
+  for (n = 0; n < THUNAR_MENU_PROVIDERS_N_QUERIES; ++n)
+    thunar_menu_providers_entry_clear (&state->entries[n]);
+  g_slice_free (ThunarMenuProvidersState, state);
+}
+
+
+
+static ThunarMenuProvidersState *
+thunar_menu_providers_get_state (ThunarxMenuProvider *provider)
+{
+  ThunarMenuProvidersState *state;
+  guint                     signal_id;
+
+  /* watch all files for changes, to invalidate the cached items */
+  if (G_UNLIKELY (thunar_menu_providers_quark == 0))
+    {
+      thunar_menu_providers_quark = g_quark_from_static_string ("thunar-menu-providers-state");
+
+      signal_id = g_signal_lookup ("changed", THUNARX_TYPE_FILE_INFO);
+      g_signal_add_emission_hook (signal_id, 0, thunar_menu_providers_file_changed, NULL, NULL);
+      signal_id = g_signal_lookup ("renamed", THUNARX_TYPE_FILE_INFO);
+      g_signal_add_emission_hook (signal_id, 0, thunar_menu_providers_file_changed, NULL, NULL);
+    }
+
+  state = g_object_get_qdata (G_OBJECT (provider), thunar_menu_providers_quark);
+  if (G_UNLIKELY (state == NULL))
+    {
+      state = g_slice_new0 (ThunarMenuProvidersState);
+      state->provider = provider;
+      g_object_set_qdata_full (G_OBJECT (provider), thunar_menu_providers_quark, state, thunar_menu_providers_state_free);
+      thunar_menu_providers_states = g_list_prepend (thunar_menu_providers_states, state);
+    }
+
+  return state;
+}
+
+
+
+static gboolean
+thunar_menu_providers_file_changed (GSignalInvocationHint *ihint,
+                                    guint                  n_param_values,
+                                    const GValue          *param_values,
+                                    gpointer               user_data)
+{
+  ThunarMenuProvidersEntry *entry;
+  ThunarMenuProvidersState *state;
+  gpointer                  file;
+  GList                    *lp;
+  guint                     n;
+
+  file = g_value_get_object (&param_values[0]);
+
+  /* drop all cached items which involve the file */
+  for (lp = thunar_menu_providers_states; lp != NULL; lp = lp->next)
+    {
+      state = lp->data;
+      for (n = 0; n < THUNAR_MENU_PROVIDERS_N_QUERIES; ++n)
+        {
+          entry = &state->entries[n];
+          if (entry->valid && (entry->folder == file || g_hash_table_contains (entry->file_set, file)))
+            thunar_menu_providers_entry_clear (entry);
+        }
+    }
+
+  /* keep the emission hook */
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_menu_providers_entry_matches (ThunarMenuProvidersEntry *entry,
+                                     GtkWidget                *window,
+                                     ThunarFile               *folder,
+                                     GList                    *files)
+{
+  GList *lp, *lq;
+
+  if (!entry->valid || entry->window != window || entry->folder != folder)
+    return FALSE;
+
+  if (g_get_monotonic_time () - entry->time > THUNAR_MENU_PROVIDERS_CACHE_TTL)
+    return FALSE;
+
+  /* the selection must be the same, in the same order */
+  for (lp = entry->files, lq = files; lp != NULL && lq != NULL; lp = lp->next, lq = lq->next)
+    if (lp->data != lq->data)
+      return FALSE;
+
+  return (lp == NULL && lq == NULL);
+}
+
+
+
+static GList *
+thunar_menu_providers_query (ThunarxMenuProvider     *provider,
+                             ThunarMenuProvidersQuery query,
+                             GtkWidget               *window,
+                             ThunarFile              *folder,
+                             GList                   *files)
+{
+  ThunarMenuProvidersEntry *entry;
+  ThunarMenuProvidersState *state;
+  GList                    *items = NULL;
+  GList                    *lp;
+  gint64                    start_time;
+  gint64                    trace_time;
+
+  state = thunar_menu_providers_get_state (provider);
+  entry = &state->entries[query];
+
+  /* reuse the items of the previous query for the same files */
+  if (thunar_menu_providers_entry_matches (entry, window, folder, files))
+    return g_list_copy_deep (entry->items, (GCopyFunc) (void (*) (void)) g_object_ref, NULL);
+
+  start_time = g_get_monotonic_time ();
+  trace_time = thunar_trace_begin ();
+
+  switch (query)
+    {
+    case THUNAR_MENU_PROVIDERS_FILE_ITEMS:
+      items = thunarx_menu_provider_get_file_menu_items (provider, window, files);
+      break;
+
+    case THUNAR_MENU_PROVIDERS_FOLDER_ITEMS:
+      items = thunarx_menu_provider_get_folder_menu_items (provider, window, THUNARX_FILE_INFO (folder));
+      break;
+
+    case THUNAR_MENU_PROVIDERS_DND_ITEMS:
+      items = thunarx_menu_provider_get_dnd_menu_items (provider, window, THUNARX_FILE_INFO (folder), files);
+      break;
+
+    default:
+      _thunar_assert_not_reached ();
+    }
+
+  thunar_trace_end_detail (trace_time, "provider", "thunar_menu_providers_query", "%s", G_OBJECT_TYPE_NAME (provider));
+
+  state->last_duration = g_get_monotonic_time () - start_time;
+  g_debug ("Menu provider %s took %.1f ms for %u files",
+           G_OBJECT_TYPE_NAME (provider), state->last_duration / 1000.0, g_list_length (files));
+
+  /* remember the items for the next query */
+  thunar_menu_providers_entry_clear (entry);
+  entry->valid = TRUE;
+  entry->time = g_get_monotonic_time ();
+  entry->window = window;
+  if (window != NULL)
+    g_object_add_weak_pointer (G_OBJECT (window), (gpointer *) &entry->window);
+  entry->folder = (folder != NULL) ? g_object_ref (folder) : NULL;
+  entry->files = thunar_g_list_copy_deep (files);
+  entry->file_set = g_hash_table_new (g_direct_hash, g_direct_equal);
+  for (lp = files; lp != NULL; lp = lp->next)
+    g_hash_table_add (entry->file_set, lp->data);
+  entry->items = g_list_copy_deep (items, (GCopyFunc) (void (*) (void)) g_object_ref, NULL);
+
+  return items;
+}
+
+
+
+static void
+thunar_menu_providers_deferred_free (gpointer data)
+{
+  ThunarMenuProvidersDeferred *deferred = data;
+
+  if (deferred->window != NULL)
+    g_object_unref (deferred->window);
+  if (deferred->folder != NULL)
+    g_object_unref (deferred->folder);
+  if (deferred->cancellable != NULL)
+    g_object_unref (deferred->cancellable);
+  thunar_g_list_free_full (deferred->files);
+  g_list_free_full (deferred->providers, g_object_unref);
+  g_slice_free (ThunarMenuProvidersDeferred, deferred);
+}
+
+
+
+static gboolean
+thunar_menu_providers_deferred_idle (gpointer user_data)
+{
+  ThunarMenuProvidersDeferred *deferred = user_data;
+  ThunarxMenuProvider         *provider;
+  GList                       *items;
+
+  /* stop if the menu is gone */
+  if (g_cancellable_is_cancelled (deferred->cancellable) || deferred->providers == NULL)
+    return FALSE;
+
+  /* query one provider per iteration, to keep the menu responsive */
+  provider = deferred->providers->data;
+  deferred->providers = g_list_delete_link (deferred->providers, deferred->providers);
+
+  items = thunar_menu_providers_query (provider, deferred->query, deferred->window, deferred->folder, deferred->files);
+  g_object_unref (provider);
+
+  if (items != NULL)
+    (*deferred->func) (items, deferred->user_data);
+
+  return (deferred->providers != NULL);
+}
+
+
+
+/**
+ * thunar_menu_providers_get_items:
+ * @query         : the kind of menu items to collect.
+ * @window        : the toplevel window the menu belongs to.
+ * @folder        : the folder for @THUNAR_MENU_PROVIDERS_FOLDER_ITEMS and
+ *                  @THUNAR_MENU_PROVIDERS_DND_ITEMS, or %NULL.
+ * @files         : the #ThunarFile<!---->s for @THUNAR_MENU_PROVIDERS_FILE_ITEMS
+ *                  and @THUNAR_MENU_PROVIDERS_DND_ITEMS.
+ * @deferred_func : the function to call with the items of deferred providers,
+ *                  or %NULL to query all providers right away.
+ * @user_data     : user data for @deferred_func.
+ * @cancellable   : a #GCancellable to stop querying deferred providers, for
+ *                  example when the menu is destroyed. Required when
+ *                  @deferred_func is not %NULL.
+ *
+ * Collects the menu items of all #ThunarxMenuProvider<!---->s for @query.
+ *
+ * If @deferred_func is not %NULL, providers which were slow the last time, or
+ * which are reached after the time budget is used up, are queried later from
+ * an idle source and their items are passed to @deferred_func.
+ *
+ * The caller is responsible to free the returned list using
+ * thunarx_menu_item_list_free().
+ *
+ * Return value: the list of #ThunarxMenuItem<!---->s.
+ **/
+GList *
+thunar_menu_providers_get_items (ThunarMenuProvidersQuery query,
+                                 GtkWidget               *window,
+                                 ThunarFile              *folder,
+                                 GList                   *files,
+                                 ThunarMenuProvidersFunc  deferred_func,
+                                 gpointer                 user_data,
+                                 GCancellable            *cancellable)
+{
+  ThunarMenuProvidersDeferred *deferred = NULL;
+  ThunarMenuProvidersState    *state;
+  ThunarxProviderFactory      *provider_factory;
+  GList                       *providers;
+  GList                       *items = NULL;
+  GList                       *lp;
+  gint64                       end_time;
+
+  _thunar_return_val_if_fail (query < THUNAR_MENU_PROVIDERS_N_QUERIES, NULL);
+  _thunar_return_val_if_fail (deferred_func == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+
+  /* load the menu providers from the provider factory */
+  provider_factory = thunarx_provider_factory_get_default ();
+  providers = thunarx_provider_factory_list_providers (provider_factory, THUNARX_TYPE_MENU_PROVIDER);
+  g_object_unref (provider_factory);
+
+  end_time = g_get_monotonic_time () + THUNAR_MENU_PROVIDERS_BUDGET;
+
+  for (lp = providers; lp != NULL; lp = lp->next)
+    {
+      state = thunar_menu_providers_get_state (lp->data);
+
+      /* defer slow providers, unless their items are cached */
+      if (deferred_func != NULL
+          && !thunar_menu_providers_entry_matches (&state->entries[query], window, folder, files)
+          && (state->last_duration > THUNAR_MENU_PROVIDERS_SLOW || g_get_monotonic_time () > end_time))
+        {
+          if (deferred == NULL)
+            {
+              deferred = g_slice_new0 (ThunarMenuProvidersDeferred);
+              deferred->query = query;
+              deferred->window = (window != NULL) ? g_object_ref (window) : NULL;
+              deferred->folder = (folder != NULL) ? g_object_ref (folder) : NULL;
+              deferred->files = thunar_g_list_copy_deep (files);
+              deferred->func = deferred_func;
+              deferred->user_data = user_data;
+              deferred->cancellable = g_object_ref (cancellable);
+            }
+
+          g_debug ("Deferring menu provider %s", G_OBJECT_TYPE_NAME (lp->data));
+          deferred->providers = g_list_prepend (deferred->providers, g_object_ref (lp->data));
+          continue;
+        }
+
+      items = g_list_concat (items, thunar_menu_providers_query (lp->data, query, window, folder, files));
+    }
+  g_list_free_full (providers, g_object_unref);
+
+  /* query the deferred providers after the menu is shown */
+  if (deferred != NULL)
+    {
+      deferred->providers = g_list_reverse (deferred->providers);
+      g_idle_add_full (G_PRIORITY_LOW, thunar_menu_providers_deferred_idle, deferred, thunar_menu_providers_deferred_free);
+    }
+
+  return items;
+}
@@ -0,0 +1,67 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __THUNAR_MENU_PROVIDERS_H__
+#define __THUNAR_MENU_PROVIDERS_H__
+
+#include "thunar/thunar-file.h"
+
+G_BEGIN_DECLS;
+
+/**
+ * ThunarMenuProvidersQuery:
+ * @THUNAR_MENU_PROVIDERS_FILE_ITEMS   : thunarx_menu_provider_get_file_menu_items().
+ * @THUNAR_MENU_PROVIDERS_FOLDER_ITEMS : thunarx_menu_provider_get_folder_menu_items().
+ * @THUNAR_MENU_PROVIDERS_DND_ITEMS    : thunarx_menu_provider_get_dnd_menu_items().
+ *
+ * The kind of menu items to ask the #ThunarxMenuProvider<!---->s for.
+ **/
+typedef enum
+{
+  THUNAR_MENU_PROVIDERS_FILE_ITEMS,
+  THUNAR_MENU_PROVIDERS_FOLDER_ITEMS,
+  THUNAR_MENU_PROVIDERS_DND_ITEMS,
+  THUNAR_MENU_PROVIDERS_N_QUERIES,
+} ThunarMenuProvidersQuery;
+
+/**
+ * ThunarMenuProvidersFunc:
+ * @items     : the #ThunarxMenuItem<!---->s of a deferred provider.
+ * @user_data : the user data passed to thunar_menu_providers_get_items().
+ *
+ * Receives the menu items of a provider that was queried after
+ * thunar_menu_providers_get_items() returned. The callback owns
+ * the @items and must free them using thunarx_menu_item_list_free().
+ **/
+typedef void (*ThunarMenuProvidersFunc) (GList   *items,
+                                         gpointer user_data);
+
+GList *
+thunar_menu_providers_get_items (ThunarMenuProvidersQuery query,
+                                 GtkWidget               *window,
+                                 ThunarFile              *folder,
+                                 GList                   *files,
+                                 ThunarMenuProvidersFunc  deferred_func,
+                                 gpointer                 user_data,
+                                 GCancellable            *cancellable) G_GNUC_WARN_UNUSED_RESULT;
+
+G_END_DECLS;
+
+#endif /* !__THUNAR_MENU_PROVIDERS_H__ */
@@ -251,7 +251,8 @@ thunar_menu_remove_all_separators (ThunarMenu *menu)
     {
       GtkWidget *item = GTK_WIDGET (l->data);
 
-      if (GTK_IS_SEPARATOR_MENU_ITEM (item))
+      /* keep the anchor for the deferred custom actions, which only looks like a separator */
+      if (GTK_IS_SEPARATOR_MENU_ITEM (item) && g_strcmp0 (g_object_get_data (G_OBJECT (item), "id"), "deferred-custom-actions-anchor") != 0)
         gtk_container_remove (GTK_CONTAINER (menu), item);
     }
 
@@ -285,6 +286,8 @@ thunar_menu_insert_separators (ThunarMenu *menu,
             {
               GtkWidget *separator = gtk_separator_menu_item_new ();
 
+              /* the menu may already be visible when it is sorted again */
+              gtk_widget_show (separator);
               gtk_menu_shell_insert (GTK_MENU_SHELL (menu), separator, index++);
               allow_separator = FALSE;
             }
@@ -343,7 +346,8 @@ thunar_menu_reorder (ThunarMenu *menu,
           GtkWidget   *child = li->data;
           const gchar *child_id = g_object_get_data (G_OBJECT (child), "id");
 
-          if (child_id != NULL && g_str_has_prefix (child_id, "custom-action-"))
+          /* the anchor for the deferred custom actions moves along with the custom actions */
+          if (child_id != NULL && (g_str_has_prefix (child_id, "custom-action-") || g_strcmp0 (child_id, "deferred-custom-actions-anchor") == 0))
             {
               gboolean unlisted = TRUE;
 
@@ -433,7 +437,6 @@ thunar_menu_add_sections (ThunarMenu        *menu,
   GtkWidget *window;
   gboolean   item_added;
   gboolean   force = menu->type == THUNAR_MENU_TYPE_WINDOW || menu->type == THUNAR_MENU_TYPE_CONTEXT_TREE_VIEW || menu->type == THUNAR_MENU_TYPE_CONTEXT_SHORTCUTS_VIEW;
-  gboolean   apply_context_menu_order;
 
   _thunar_return_val_if_fail (THUNAR_IS_MENU (menu), FALSE);
 
@@ -550,32 +553,57 @@ thunar_menu_add_sections (ThunarMenu        *menu,
   if (menu_sections & THUNAR_MENU_SECTION_PROPERTIES)
     thunar_action_manager_append_menu_item (menu->action_mgr, GTK_MENU_SHELL (menu), THUNAR_ACTION_MANAGER_ACTION_PROPERTIES, FALSE);
 
-  /* if this is a right-click context menu, then change the order and visibility of the elements to custom ones */
+  thunar_menu_apply_context_menu_order (menu);
+
+  return TRUE;
+}
+
+
+
+/**
+ * thunar_menu_apply_context_menu_order:
+ * @menu : a #ThunarMenu instance
+ *
+ * If @menu is a right-click context menu, changes the order and visibility of
+ * its #GtkMenuItems to the ones configured by the user. This is done again for
+ * menu items which are added after the menu was built.
+ *
+ * Return value: TRUE if the @menu follows the configured order
+ **/
+gboolean
+thunar_menu_apply_context_menu_order (ThunarMenu *menu)
+{
+  ThunarContextMenuOrderModel *order_model;
+  GList                       *new_order;
+  gboolean                     apply_context_menu_order;
+
+  /* a list of custom action menu items that are missing from the "new_order" list. This may happen because the
+   * plugin that provides custom actions does not support passing information about menu items to the model, or
+   * because the model is not updated for some reason */
+  GList *unlisted_custom_actions = NULL;
+
+  _thunar_return_val_if_fail (THUNAR_IS_MENU (menu), FALSE);
+
   apply_context_menu_order = FALSE;
   apply_context_menu_order |= menu->type == THUNAR_MENU_TYPE_CONTEXT_STANDARD_VIEW;
   apply_context_menu_order |= menu->type == THUNAR_MENU_TYPE_CONTEXT_TREE_VIEW;
   apply_context_menu_order |= menu->type == THUNAR_MENU_TYPE_CONTEXT_SHORTCUTS_VIEW;
   apply_context_menu_order |= menu->type == THUNAR_MENU_TYPE_CONTEXT_LOCATION_BUTTONS;
-  if (apply_context_menu_order)
-    {
-      ThunarContextMenuOrderModel *order_model = thunar_context_menu_order_model_get_default ();
-      GList                       *new_order = thunar_context_menu_order_model_get_items (order_model);
+  if (!apply_context_menu_order)
+    return FALSE;
 
-      /* a list of custom action menu items that are missing from the "new_order" list. This may happen because the
-       * plugin that provides custom actions does not support passing information about menu items to the model, or
-       * because the model is not updated for some reason */
-      GList *unlisted_custom_actions = NULL;
+  order_model = thunar_context_menu_order_model_get_default ();
+  new_order = thunar_context_menu_order_model_get_items (order_model);
 
-      /* we will insert our own separators later, so let's remove all current separators */
-      thunar_menu_remove_all_separators (menu);
+  /* we will insert our own separators later, so let's remove all current separators */
+  thunar_menu_remove_all_separators (menu);
 
-      thunar_menu_reorder (menu, new_order, &unlisted_custom_actions);
-      thunar_menu_insert_separators (menu, new_order, unlisted_custom_actions);
+  thunar_menu_reorder (menu, new_order, &unlisted_custom_actions);
+  thunar_menu_insert_separators (menu, new_order, unlisted_custom_actions);
 
-      g_list_free (new_order);
-      g_object_unref (order_model);
-      g_list_free (unlisted_custom_actions);
-    }
+  g_list_free (new_order);
+  g_object_unref (order_model);
+  g_list_free (unlisted_custom_actions);
 
   return TRUE;
 }
@@ -74,6 +74,8 @@ thunar_menu_get_type (void);
 gboolean
 thunar_menu_add_sections (ThunarMenu        *menu,
                           ThunarMenuSections menu_sections);
+gboolean
+thunar_menu_apply_context_menu_order (ThunarMenu *menu);
 GtkWidget *
 thunar_menu_get_action_manager (ThunarMenu *menu);
 
@@ -138,6 +138,7 @@ enum
   PROP_MISC_COMPACT_VIEW_MAX_CHARS,
   PROP_MISC_HIGHLIGHTING_ENABLED,
   PROP_MISC_UNDO_REDO_HISTORY_SIZE,
+  PROP_MISC_UNDO_REDO_HISTORY_PERSISTENT,
   PROP_MISC_CONFIRM_MOVE_TO_TRASH,
   PROP_MISC_MAX_NUMBER_OF_TEMPLATES,
   PROP_MISC_DISPLAY_LAUNCHER_NAME_AS_FILENAME,
@@ -149,6 +150,7 @@ enum
   PROP_MISC_SUPPORT_OVERLAY_SCROLLING,
   PROP_SMART_SORT,
   PROP_MISC_FILE_DRAG_MODE,
+  PROP_MISC_FOLDER_SNAPSHOTS,
 #ifdef HAVE_VTE
   PROP_TERMINAL_HEIGHT,
   PROP_TERMINAL_VISIBLE,
@@ -1402,6 +1404,19 @@ thunar_preferences_class_init (ThunarPreferencesClass *klass)
                     10,
                     G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * ThunarPreferences:misc-undo-redo-history-persistent:
+   *
+   * If true the undo/redo history is kept in a journal file
+   * and restored the next time Thunar starts
+   **/
+  preferences_props[PROP_MISC_UNDO_REDO_HISTORY_PERSISTENT] =
+  g_param_spec_boolean ("misc-undo-redo-history-persistent",
+                        "MiscUndoRedoHistoryPersistent",
+                        NULL,
+                        FALSE,
+                        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
   /**
    * ThunarPreferences:misc-confirm-move-to-trash:
    *
@@ -1529,6 +1544,20 @@ thunar_preferences_class_init (ThunarPreferencesClass *klass)
                      THUNAR_FILE_DRAG_MODE_MENU_ALWAYS,
                      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * ThunarPreferences:misc-folder-snapshots:
+   *
+   * If true the contents of local folders are stored in the user cache
+   * directory, so reopened folders can be shown before they are scanned.
+   * Switching it off removes the stored contents.
+   **/
+  preferences_props[PROP_MISC_FOLDER_SNAPSHOTS] =
+  g_param_spec_boolean ("misc-folder-snapshots",
+                        "MiscFolderSnapshots",
+                        NULL,
+                        FALSE,
+                        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
 #ifdef HAVE_VTE
   /**
    * ThunarPreferences:terminal-height:
@@ -156,6 +156,9 @@ thunar_renamer_dialog_row_activated (GtkTreeView         *tree_view,
 static void
 thunar_renamer_dialog_selection_changed (GtkTreeSelection    *selection,
                                          ThunarRenamerDialog *renamer_dialog);
+static void
+thunar_renamer_dialog_scrolled (GtkAdjustment       *adjustment,
+                                ThunarRenamerDialog *renamer_dialog);
 static ThunarFile *
 thunar_renamer_dialog_get_current_directory (ThunarRenamerDialog *renamer_dialog);
 static void
@@ -360,6 +363,7 @@ thunar_renamer_dialog_init (ThunarRenamerDialog *renamer_dialog)
   GtkWidget              *rbox;
   GtkWidget              *vbox;
   GtkWidget              *swin;
+  GtkAdjustment          *adjustment;
   GtkWidget              *infobar;
   XfceRc                 *rc;
   gchar                 **entries;
@@ -469,6 +473,11 @@ thunar_renamer_dialog_init (ThunarRenamerDialog *renamer_dialog)
   gtk_container_add (GTK_CONTAINER (swin), renamer_dialog->tree_view);
   gtk_widget_show (renamer_dialog->tree_view);
 
+  /* let the model compute the new names of the visible rows first */
+  adjustment = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (swin));
+  g_signal_connect (G_OBJECT (adjustment), "value-changed", G_CALLBACK (thunar_renamer_dialog_scrolled), renamer_dialog);
+  g_signal_connect (G_OBJECT (adjustment), "changed", G_CALLBACK (thunar_renamer_dialog_scrolled), renamer_dialog);
+
   /* create the tree view column for the old file name */
   renamer_dialog->name_column = column = gtk_tree_view_column_new ();
   gtk_tree_view_column_set_spacing (column, 2);
@@ -1676,6 +1685,31 @@ thunar_renamer_dialog_row_activated (GtkTreeView         *tree_view,
 
 
 
+static void
+thunar_renamer_dialog_scrolled (GtkAdjustment       *adjustment,
+                                ThunarRenamerDialog *renamer_dialog)
+{
+  GtkTreePath *start_path;
+  GtkTreePath *end_path;
+
+  _thunar_return_if_fail (THUNAR_IS_RENAMER_DIALOG (renamer_dialog));
+
+  if (gtk_tree_view_get_visible_range (GTK_TREE_VIEW (renamer_dialog->tree_view), &start_path, &end_path))
+    {
+      thunar_renamer_model_set_visible_range (renamer_dialog->model,
+                                              gtk_tree_path_get_indices (start_path)[0],
+                                              gtk_tree_path_get_indices (end_path)[0]);
+      gtk_tree_path_free (start_path);
+      gtk_tree_path_free (end_path);
+    }
+  else
+    {
+      thunar_renamer_model_set_visible_range (renamer_dialog->model, -1, -1);
+    }
+}
+
+
+
 static void
 thunar_renamer_dialog_selection_changed (GtkTreeSelection    *selection,
                                          ThunarRenamerDialog *renamer_dialog)
@@ -34,6 +34,15 @@
 
 #define THUNAR_RENAMER_MODEL_ITEM(item) ((ThunarRenamerModelItem *) (item))
 
+/* time the update idle source may spend per iteration */
+#define THUNAR_RENAMER_MODEL_UPDATE_BUDGET (8 * G_TIME_SPAN_MILLISECOND)
+
+/* number of items passed to the renamer at once, at most */
+#define THUNAR_RENAMER_MODEL_BATCH_SIZE (256)
+
+/* number of items in the first batch of a time slice, before the cost of an item is known */
+#define THUNAR_RENAMER_MODEL_FIRST_BATCH_SIZE (8)
+
 
 
 /* Property identifiers */
@@ -56,6 +65,7 @@ typedef struct
 
 
 typedef struct _ThunarRenamerModelItem ThunarRenamerModelItem;
+typedef struct _ThunarRenamerModelDir  ThunarRenamerModelDir;
 
 
 
@@ -125,13 +135,20 @@ thunar_renamer_model_invalidate_all (ThunarRenamerModel *renamer_model);
 static void
 thunar_renamer_model_invalidate_item (ThunarRenamerModel     *renamer_model,
                                       ThunarRenamerModelItem *item);
+static void
+thunar_renamer_model_item_set_target (ThunarRenamerModel     *renamer_model,
+                                      ThunarRenamerModelItem *item,
+                                      const gchar            *target);
 static gboolean
-thunar_renamer_model_conflict_item (ThunarRenamerModel     *renamer_model,
-                                    ThunarRenamerModelItem *item);
-static gchar *
-thunar_renamer_model_process_item (ThunarRenamerModel     *renamer_model,
-                                   ThunarRenamerModelItem *item,
-                                   guint                   idx);
+thunar_renamer_model_item_conflicts (ThunarRenamerModelItem *item);
+static gint
+thunar_renamer_model_item_get_index (ThunarRenamerModel     *renamer_model,
+                                     ThunarRenamerModelItem *item);
+static void
+thunar_renamer_model_process_batch (ThunarRenamerModel *renamer_model,
+                                    GList             **links,
+                                    const guint        *indices,
+                                    guint               n_links);
 static gboolean
 thunar_renamer_model_update_idle (gpointer user_data);
 static void
@@ -180,21 +197,56 @@ struct _ThunarRenamerModel
   ThunarxRenamer   *renamer;
   GList            *items;
 
+  /* whether the index of each item is up to date, see thunar_renamer_model_item_get_index() */
+  gboolean indices_valid;
+
   /* TRUE if the model is currently frozen */
   gboolean frozen;
 
   /* the idle source used to update the model */
   guint update_idle_id;
+
+  /* the number of dirty items and the position of the
+   * update idle source in the list of items */
+  guint  n_dirty;
+  GList *update_lp;
+  guint  update_idx;
+
+  /* the range of rows visible in the view, which are updated first */
+  gint visible_start;
+  gint visible_end;
+
+  /* the parent directories of the items (GFile -> ThunarRenamerModelDir) */
+  GHashTable   *directories;
+  GCancellable *directories_cancellable;
 };
 
 struct _ThunarRenamerModelItem
 {
-  ThunarFile *file;
-  gchar      *name;
-  guint64     date_changed;
-  guint       changed : 1;  /* if the file changed */
-  guint       conflict : 1; /* if the item conflicts with another item */
-  guint       dirty : 1;    /* if the item must be updated */
+  ThunarFile            *file;
+  gchar                 *name;
+  guint64                date_changed;
+  guint                  changed : 1;  /* if the file changed */
+  guint                  conflict : 1; /* if the item conflicts with another item */
+  guint                  dirty : 1;    /* if the item must be updated */
+  ThunarRenamerModelDir *dir;          /* the parent directory, or %NULL */
+  gchar                 *basename;     /* the basename registered in the directory */
+  gchar                 *target;       /* the name after renaming registered in the directory */
+  GList                 *target_link;  /* the item's link in the queue of items for @target */
+  GList                 *link;         /* the item's link in the list of items */
+  gint                   index;        /* the item's position in the list of items */
+};
+
+/* Conflicts are detected per directory: an item conflicts if another item in the
+ * same directory would get the same name, or if its new name is taken by a file
+ * in the directory which is not part of the model. */
+struct _ThunarRenamerModelDir
+{
+  GFile      *directory;
+  guint       n_items;
+  GHashTable *targets;   /* name -> GQueue of the items which would get the name */
+  GHashTable *basenames; /* name -> number of items with that current name */
+  GHashTable *entries;   /* names of the files in the directory, %NULL while loading */
 };
 
 
@@ -293,6 +345,176 @@ thunar_renamer_model_tree_model_init (GtkTreeModelIface *iface)
 
 
 
+static void
+thunar_renamer_model_dir_free (gpointer data)
+{
+  ThunarRenamerModelDir *dir = data;
+
+  g_object_unref (dir->directory);
+  g_hash_table_destroy (dir->targets);
+  g_hash_table_destroy (dir->basenames);
+  if (dir->entries != NULL)
+    g_hash_table_destroy (dir->entries);
+  g_slice_free (ThunarRenamerModelDir, dir);
+}
+
+
+
+static void
+thunar_renamer_model_dir_load_thread (GTask        *task,
+                                      gpointer      source_object,
+                                      gpointer      task_data,
+                                      GCancellable *cancellable)
+{
+  GFileEnumerator *enumerator;
+  GFileInfo       *info;
+  GHashTable      *entries;
+  GError          *error = NULL;
+
+  enumerator = g_file_enumerate_children (task_data, G_FILE_ATTRIBUTE_STANDARD_NAME,
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS, cancellable, &error);
+  if (enumerator == NULL)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  while ((info = g_file_enumerator_next_file (enumerator, cancellable, &error)) != NULL)
+    {
+      g_hash_table_add (entries, g_strdup (g_file_info_get_name (info)));
+      g_object_unref (info);
+    }
+  g_object_unref (enumerator);
+
+  if (error != NULL)
+    {
+      g_hash_table_destroy (entries);
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_task_return_pointer (task, entries, (GDestroyNotify) g_hash_table_destroy);
+}
+
+
+
+static void
+thunar_renamer_model_dir_loaded (GObject      *object,
+                                 GAsyncResult *result,
+                                 gpointer      user_data)
+{
+  ThunarRenamerModelItem *item;
+  ThunarRenamerModelDir  *dir;
+  ThunarRenamerModel     *renamer_model;
+  GtkTreePath            *path;
+  GtkTreeIter             iter;
+  GHashTable             *entries;
+  gboolean                conflict;
+  GList                  *lp;
+  gint                    idx;
+
+  /* on cancellation the model is gone already */
+  entries = g_task_propagate_pointer (G_TASK (result), NULL);
+  if (entries == NULL)
+    return;
+
+  renamer_model = THUNAR_RENAMER_MODEL (user_data);
+
+  /* the directory may have been dropped in the meantime */
+  dir = g_hash_table_lookup (renamer_model->directories, g_task_get_task_data (G_TASK (result)));
+  if (dir == NULL || dir->entries != NULL)
+    {
+      g_hash_table_destroy (entries);
+      return;
+    }
+  dir->entries = entries;
+
+  /* check the items of the directory against the entries */
+  for (lp = renamer_model->items, idx = 0; lp != NULL; lp = lp->next, ++idx)
+    {
+      item = THUNAR_RENAMER_MODEL_ITEM (lp->data);
+      if (item->dir != dir || item->dirty)
+        continue;
+
+      conflict = thunar_renamer_model_item_conflicts (item);
+      if (item->conflict != conflict)
+        {
+          item->conflict = conflict;
+
+          GTK_TREE_ITER_INIT (iter, renamer_model->stamp, lp);
+          path = gtk_tree_path_new_from_indices (idx, -1);
+          gtk_tree_model_row_changed (GTK_TREE_MODEL (renamer_model), path, &iter);
+          gtk_tree_path_free (path);
+        }
+    }
+
+  g_object_notify (G_OBJECT (renamer_model), "can-rename");
+}
+
+
+
+static ThunarRenamerModelDir *
+thunar_renamer_model_dir_acquire (ThunarRenamerModel *renamer_model,
+                                  ThunarFile         *file)
+{
+  ThunarRenamerModelDir *dir;
+  GFile                 *parent;
+  GTask                 *task;
+
+  parent = g_file_get_parent (thunar_file_get_file (file));
+  if (parent == NULL)
+    return NULL;
+
+  dir = g_hash_table_lookup (renamer_model->directories, parent);
+  if (dir == NULL)
+    {
+      dir = g_slice_new0 (ThunarRenamerModelDir);
+      dir->directory = g_object_ref (parent);
+      dir->targets = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_queue_free);
+      dir->basenames = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+      g_hash_table_insert (renamer_model->directories, dir->directory, dir);
+
+      /* load the names of the files in the directory in the background */
+      task = g_task_new (NULL, renamer_model->directories_cancellable, thunar_renamer_model_dir_loaded, renamer_model);
+      g_task_set_task_data (task, g_object_ref (parent), g_object_unref);
+      g_task_run_in_thread (task, thunar_renamer_model_dir_load_thread);
+      g_object_unref (task);
+    }
+
+  dir->n_items++;
+  g_object_unref (parent);
+
+  return dir;
+}
+
+
+
+static void
+thunar_renamer_model_dir_set_basename (ThunarRenamerModelDir *dir,
+                                       const gchar           *old_basename,
+                                       const gchar           *new_basename)
+{
+  guint n;
+
+  if (old_basename != NULL)
+    {
+      n = GPOINTER_TO_UINT (g_hash_table_lookup (dir->basenames, old_basename));
+      if (n > 1)
+        g_hash_table_insert (dir->basenames, g_strdup (old_basename), GUINT_TO_POINTER (n - 1));
+      else
+        g_hash_table_remove (dir->basenames, old_basename);
+    }
+
+  if (new_basename != NULL)
+    {
+      n = GPOINTER_TO_UINT (g_hash_table_lookup (dir->basenames, new_basename));
+      g_hash_table_insert (dir->basenames, g_strdup (new_basename), GUINT_TO_POINTER (n + 1));
+    }
+}
+
+
+
 static void
 thunar_renamer_model_init (ThunarRenamerModel *renamer_model)
 {
@@ -300,6 +522,12 @@ thunar_renamer_model_init (ThunarRenamerModel *renamer_model)
 #ifndef NDEBUG
   renamer_model->stamp = g_random_int ();
 #endif
+
+  renamer_model->visible_start = -1;
+  renamer_model->visible_end = -1;
+  renamer_model->directories = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal,
+                                                      NULL, thunar_renamer_model_dir_free);
+  renamer_model->directories_cancellable = g_cancellable_new ();
 }
 
 
@@ -313,11 +541,19 @@ thunar_renamer_model_finalize (GObject *object)
   /* reset the renamer property (must be first!) */
   thunar_renamer_model_set_renamer (renamer_model, NULL);
 
-  /* release all items */
+  /* stop loading directory entries */
+  g_cancellable_cancel (renamer_model->directories_cancellable);
+  g_object_unref (renamer_model->directories_cancellable);
+
+  /* release all items, no need to track conflicts anymore */
   for (lp = renamer_model->items; lp != NULL; lp = lp->next)
-    thunar_renamer_model_release_item (renamer_model, lp->data);
+    {
+      THUNAR_RENAMER_MODEL_ITEM (lp->data)->dir = NULL;
+      thunar_renamer_model_release_item (renamer_model, lp->data);
+    }
 
   g_list_free (renamer_model->items);
+  g_hash_table_destroy (renamer_model->directories);
 
   /* be sure to cancel any pending update idle source (must be last!) */
   if (G_UNLIKELY (renamer_model->update_idle_id != 0))
@@ -471,7 +707,7 @@ thunar_renamer_model_get_path (GtkTreeModel *tree_model,
   _thunar_return_val_if_fail (iter->stamp == renamer_model->stamp, NULL);
 
   /* determine the idx of the item */
-  idx = g_list_position (renamer_model->items, iter->user_data);
+  idx = thunar_renamer_model_item_get_index (renamer_model, THUNAR_RENAMER_MODEL_ITEM (((GList *) iter->user_data)->data));
   if (G_UNLIKELY (idx < 0))
     return NULL;
 
@@ -691,6 +927,7 @@ thunar_renamer_model_file_destroyed (ThunarRenamerModel *renamer_model,
 
         /* drop the item from the list */
         renamer_model->items = g_list_delete_link (renamer_model->items, lp);
+        renamer_model->indices_valid = FALSE;
 
         /* tell the view that the item is gone */
         path = gtk_tree_path_new_from_indices (idx, -1);
@@ -710,6 +947,9 @@ thunar_renamer_model_invalidate_all (ThunarRenamerModel *renamer_model)
 {
   GList *lp;
 
+  /* restart the update from the visible rows, any progress with the previous settings is stale now */
+  renamer_model->update_lp = NULL;
+
   /* invalidate all items in the model */
   for (lp = renamer_model->items; lp != NULL; lp = lp->next)
     thunar_renamer_model_invalidate_item (renamer_model, lp->data);
@@ -722,6 +962,8 @@ thunar_renamer_model_invalidate_item (ThunarRenamerModel     *renamer_model,
                                       ThunarRenamerModelItem *item)
 {
   /* mark the item as dirty */
+  if (!item->dirty)
+    renamer_model->n_dirty++;
   item->dirty = TRUE;
 
   /* check if the update idle source is already running and not frozen */
@@ -739,160 +981,325 @@ thunar_renamer_model_invalidate_item (ThunarRenamerModel     *renamer_model,
 
 
 static gboolean
-trm_same_directory (ThunarFile *a,
-                    ThunarFile *b)
+thunar_renamer_model_item_conflicts (ThunarRenamerModelItem *item)
 {
-  GFile   *parent_a;
-  GFile   *parent_b;
-  gboolean result;
+  ThunarRenamerModelDir *dir = item->dir;
+  GQueue                *items;
+
+  /* items can only conflict within the same directory */
+  if (dir == NULL || item->target == NULL)
+    return FALSE;
+
+  /* check if another item would get the same name */
+  items = g_hash_table_lookup (dir->targets, item->target);
+  if (items != NULL && items->length > 1)
+    return TRUE;
+
+  /* check if the new name is taken by a file which is not part of the model */
+  return item->name != NULL
+         && dir->entries != NULL
+         && g_hash_table_contains (dir->entries, item->name)
+         && !g_hash_table_contains (dir->basenames, item->name);
+}
 
-  /* determine the parent paths for both files */
-  parent_a = g_file_get_parent (thunar_file_get_file (a));
-  parent_b = g_file_get_parent (thunar_file_get_file (b));
 
-  /* check if both files have the same parent */
-  result = (parent_a != NULL && parent_b != NULL && g_file_equal (parent_a, parent_b));
 
-  if (parent_a != NULL)
-    g_object_unref (parent_a);
-  if (parent_b != NULL)
-    g_object_unref (parent_b);
+static gint
+thunar_renamer_model_item_get_index (ThunarRenamerModel     *renamer_model,
+                                     ThunarRenamerModelItem *item)
+{
+  GList *lp;
+  gint   idx;
+
+  /* renumber the items once after the list changed, instead of searching the list for each lookup */
+  if (!renamer_model->indices_valid)
+    {
+      for (lp = renamer_model->items, idx = 0; lp != NULL; lp = lp->next, ++idx)
+        THUNAR_RENAMER_MODEL_ITEM (lp->data)->index = idx;
+      renamer_model->indices_valid = TRUE;
+    }
 
-  return result;
+  return item->index;
 }
 
 
 
-static gboolean
-thunar_renamer_model_conflict_item (ThunarRenamerModel     *renamer_model,
-                                    ThunarRenamerModelItem *item)
+static void
+thunar_renamer_model_update_conflict (ThunarRenamerModel     *renamer_model,
+                                      ThunarRenamerModelItem *item)
 {
-  ThunarRenamerModelItem *oitem;
-  GtkTreePath            *path;
-  GtkTreeIter             iter;
-  gboolean                conflict = FALSE;
-  GList                  *lp;
+  GtkTreePath *path;
+  GtkTreeIter  iter;
+  gboolean     conflict;
 
-  for (lp = renamer_model->items; lp != NULL; lp = lp->next)
+  /* dirty items are checked when they are updated */
+  if (item->dirty)
+    return;
+
+  conflict = thunar_renamer_model_item_conflicts (item);
+  if (item->conflict != conflict)
     {
-      /* check if this item is dirty or the item we're about to check */
-      oitem = THUNAR_RENAMER_MODEL_ITEM (lp->data);
-      if (G_UNLIKELY (oitem == item || oitem->dirty))
-        continue;
+      item->conflict = conflict;
 
-      /* check if this other item conflicts with the item in question (can only conflict if in same directory) */
-      if (trm_same_directory (item->file, oitem->file)
-          && ((item->name != NULL && oitem->name == NULL && strcmp (item->name, thunar_file_get_basename (oitem->file)) == 0)
-              || (item->name == NULL && oitem->name != NULL && strcmp (thunar_file_get_basename (item->file), oitem->name) == 0)
-              || (item->name != NULL && oitem->name != NULL && strcmp (item->name, oitem->name) == 0)))
-        {
-          /* check if the other item is already in conflict state */
-          if (G_LIKELY (!oitem->conflict))
-            {
-              /* set to conflict state */
-              oitem->conflict = TRUE;
+      /* emit "row-changed" for the item */
+      GTK_TREE_ITER_INIT (iter, renamer_model->stamp, item->link);
+      path = gtk_tree_path_new_from_indices (thunar_renamer_model_item_get_index (renamer_model, item), -1);
+      gtk_tree_model_row_changed (GTK_TREE_MODEL (renamer_model), path, &iter);
+      gtk_tree_path_free (path);
+    }
+}
 
-              /* determine iter for other item */
-              GTK_TREE_ITER_INIT (iter, renamer_model->stamp, lp);
 
-              /* emit "row-changed" for the other item */
-              path = gtk_tree_model_get_path (GTK_TREE_MODEL (renamer_model), &iter);
-              gtk_tree_model_row_changed (GTK_TREE_MODEL (renamer_model), path, &iter);
-              gtk_tree_path_free (path);
-            }
 
-          /* this item conflicts */
-          conflict = TRUE;
-        }
+static void
+thunar_renamer_model_item_set_target (ThunarRenamerModel     *renamer_model,
+                                      ThunarRenamerModelItem *item,
+                                      const gchar            *target)
+{
+  ThunarRenamerModelDir *dir = item->dir;
+  GQueue                *items;
+
+  if (dir == NULL || g_strcmp0 (item->target, target) == 0)
+    return;
+
+  /* unregister the previous name, only the last item left with it can change its conflict state */
+  if (item->target != NULL)
+    {
+      items = g_hash_table_lookup (dir->targets, item->target);
+      g_queue_delete_link (items, item->target_link);
+      item->target_link = NULL;
+
+      if (items->length == 1)
+        thunar_renamer_model_update_conflict (renamer_model, g_queue_peek_head (items));
+      else if (items->length == 0)
+        g_hash_table_remove (dir->targets, item->target);
     }
 
-  return conflict;
+  /* register the new name, only an item which had it alone can change its conflict state;
+   * the conflict state of @item is updated by the caller */
+  g_free (item->target);
+  item->target = g_strdup (target);
+  if (target != NULL)
+    {
+      items = g_hash_table_lookup (dir->targets, target);
+      if (items == NULL)
+        {
+          items = g_queue_new ();
+          g_hash_table_insert (dir->targets, g_strdup (target), items);
+        }
+
+      g_queue_push_head (items, item);
+      item->target_link = items->head;
+
+      if (items->length == 2)
+        thunar_renamer_model_update_conflict (renamer_model, g_queue_peek_nth (items, 1));
+    }
 }
 
 
 
-static gchar *
-thunar_renamer_model_process_item (ThunarRenamerModel     *renamer_model,
-                                   ThunarRenamerModelItem *item,
-                                   guint                   idx)
+static gboolean
+thunar_renamer_model_get_range (ThunarRenamerModel *renamer_model,
+                                const gchar        *file_name,
+                                gsize              *start,
+                                gsize              *end)
 {
   ThunarRenamerMode mode;
-  const gchar      *file_name;
   const gchar      *dot;
-  gchar            *name = NULL;
-  gchar            *prefix;
-  gchar            *extension;
-  gchar            *text;
-
-  /* no new name if no renamer is set */
-  if (G_UNLIKELY (renamer_model->renamer == NULL))
-    return NULL;
-
-  /* determine the current file name of the file */
-  file_name = thunar_file_get_basename (item->file);
 
   /* determine the extension in the filename */
   dot = thunar_util_str_get_extension (file_name);
 
   /* if we don't have a dot, then no "Extension only" rename can take place */
-  if (G_LIKELY (dot != NULL || renamer_model->mode != THUNAR_RENAMER_MODE_EXTENSION))
+  if (G_UNLIKELY (dot == NULL && renamer_model->mode == THUNAR_RENAMER_MODE_EXTENSION))
+    return FALSE;
+
+  /* now, for "Name only", we need a dot, otherwise treat everything as name */
+  if (renamer_model->mode == THUNAR_RENAMER_MODE_NAME && dot == NULL)
+    mode = THUNAR_RENAMER_MODE_BOTH;
+  else
+    mode = renamer_model->mode;
+
+  /* determine the part of the file name the renamer is applied to */
+  switch (mode)
     {
-      /* now, for "Name only", we need a dot, otherwise treat everything as name */
-      if (renamer_model->mode == THUNAR_RENAMER_MODE_NAME && dot == NULL)
-        mode = THUNAR_RENAMER_MODE_BOTH;
-      else
-        mode = renamer_model->mode;
+    case THUNAR_RENAMER_MODE_NAME:
+      *start = 0;
+      *end = dot - file_name;
+      break;
 
-      /* determine the new name according to the mode */
-      switch (mode)
-        {
-        case THUNAR_RENAMER_MODE_NAME:
-          /* determine the name part of the display name */
-          text = g_strndup (file_name, (dot - file_name));
+    case THUNAR_RENAMER_MODE_EXTENSION:
+      *start = (dot + 1) - file_name;
+      *end = strlen (file_name);
+      break;
 
-          /* determine the new name */
-          prefix = thunarx_renamer_process (renamer_model->renamer, THUNARX_FILE_INFO (item->file), text, idx);
+    case THUNAR_RENAMER_MODE_BOTH:
+      *start = 0;
+      *end = strlen (file_name);
+      break;
 
-          /* determine the new full name */
-          name = g_strconcat (prefix, dot, NULL);
+    default:
+      _thunar_assert_not_reached ();
+      return FALSE;
+    }
 
-          /* release the temporary strings */
-          g_free (prefix);
-          g_free (text);
-          break;
+  return TRUE;
+}
 
-        case THUNAR_RENAMER_MODE_EXTENSION:
-          /* determine the new extension */
-          extension = thunarx_renamer_process (renamer_model->renamer, THUNARX_FILE_INFO (item->file), dot + 1, idx);
 
-          prefix = g_strndup (file_name, (dot - file_name) + 1);
-          name = g_strconcat (prefix, extension, NULL);
-          g_free (prefix);
 
-          /* release the extension */
-          g_free (extension);
-          break;
+static void
+thunar_renamer_model_update_item (ThunarRenamerModel *renamer_model,
+                                  GList              *lp,
+                                  guint               idx,
+                                  gchar              *name)
+{
+  ThunarRenamerModelItem *item = THUNAR_RENAMER_MODEL_ITEM (lp->data);
+  GtkTreePath            *path;
+  GtkTreeIter             iter;
+  const gchar            *basename;
+  gboolean                changed;
+  gboolean                conflict;
 
-        case THUNAR_RENAMER_MODE_BOTH:
-          /* determine the new full name */
-          name = thunarx_renamer_process (renamer_model->renamer, THUNARX_FILE_INFO (item->file), file_name, idx);
-          break;
+  /* check if the file changed */
+  changed = item->changed;
 
-        default:
-          _thunar_assert_not_reached ();
-          break;
+  /* mark as valid, since we're updating right now */
+  item->changed = FALSE;
+  item->dirty = FALSE;
+  renamer_model->n_dirty--;
+
+  /* check if the item has a new name */
+  if (g_strcmp0 (item->name, name) != 0)
+    {
+      /* apply new name */
+      g_free (item->name);
+      item->name = name;
+
+      /* the item changed */
+      changed = TRUE;
+    }
+  else
+    {
+      /* release temporary name */
+      g_free (name);
+    }
+
+  /* update the registered names, in case the file was renamed meanwhile */
+  basename = thunar_file_get_basename (item->file);
+  if (item->dir != NULL && g_strcmp0 (item->basename, basename) != 0)
+    {
+      thunar_renamer_model_dir_set_basename (item->dir, item->basename, basename);
+      g_free (item->basename);
+      item->basename = g_strdup (basename);
+    }
+  thunar_renamer_model_item_set_target (renamer_model, item, item->name != NULL ? item->name : basename);
+
+  /* check if this item conflicts with any other item */
+  conflict = thunar_renamer_model_item_conflicts (item);
+  if (item->conflict != conflict)
+    {
+      /* apply the new state */
+      item->conflict = conflict;
+
+      /* the item changed */
+      changed = TRUE;
+    }
+
+  /* check if the item changed */
+  if (G_LIKELY (changed))
+    {
+      /* generate the iter for the item */
+      GTK_TREE_ITER_INIT (iter, renamer_model->stamp, lp);
+
+      /* emit "row-changed" for this item */
+      path = gtk_tree_path_new_from_indices (idx, -1);
+      gtk_tree_model_row_changed (GTK_TREE_MODEL (renamer_model), path, &iter);
+      gtk_tree_path_free (path);
+    }
+}
+
+
+
+static void
+thunar_renamer_model_process_batch (ThunarRenamerModel *renamer_model,
+                                    GList             **links,
+                                    const guint        *indices,
+                                    guint               n_links)
+{
+  ThunarRenamerModelItem *item;
+  ThunarxFileInfo        *files[THUNAR_RENAMER_MODEL_BATCH_SIZE];
+  const gchar            *file_name;
+  gchar                  *texts[THUNAR_RENAMER_MODEL_BATCH_SIZE];
+  gchar                  *head;
+  gchar                  *name;
+  gchar                 **results = NULL;
+  guint                   batch_indices[THUNAR_RENAMER_MODEL_BATCH_SIZE];
+  gint                    slots[THUNAR_RENAMER_MODEL_BATCH_SIZE];
+  gsize                   starts[THUNAR_RENAMER_MODEL_BATCH_SIZE];
+  gsize                   ends[THUNAR_RENAMER_MODEL_BATCH_SIZE];
+  guint                   n_texts = 0;
+  guint                   n;
+
+  _thunar_assert (n_links <= THUNAR_RENAMER_MODEL_BATCH_SIZE);
+
+  /* collect the parts of the file names the renamer is applied to */
+  for (n = 0; n < n_links; ++n)
+    {
+      item = THUNAR_RENAMER_MODEL_ITEM (links[n]->data);
+      file_name = thunar_file_get_basename (item->file);
+
+      /* no new name if no renamer is set */
+      if (renamer_model->renamer == NULL || !thunar_renamer_model_get_range (renamer_model, file_name, &starts[n], &ends[n]))
+        {
+          slots[n] = -1;
+          continue;
         }
+
+      slots[n] = n_texts;
+      files[n_texts] = THUNARX_FILE_INFO (item->file);
+      texts[n_texts] = g_strndup (file_name + starts[n], ends[n] - starts[n]);
+      batch_indices[n_texts] = indices[n];
+      n_texts++;
     }
 
-  /* check if the new name is equal to the old one */
-  if (g_strcmp0 (name, file_name) == 0)
+  /* let the renamer process all texts at once */
+  if (n_texts > 0)
+    results = thunarx_renamer_process_batch (renamer_model->renamer, n_texts, files, (const gchar *const *) texts, batch_indices);
+
+  /* apply the new names */
+  for (n = 0; n < n_links; ++n)
     {
-      /* just return NULL then */
-      g_free (name);
+      item = THUNAR_RENAMER_MODEL_ITEM (links[n]->data);
+      file_name = thunar_file_get_basename (item->file);
+
       name = NULL;
+      if (slots[n] >= 0 && results != NULL && results[slots[n]] != NULL)
+        {
+          /* determine the new full name */
+          head = g_strndup (file_name, starts[n]);
+          name = g_strconcat (head, results[slots[n]], file_name + ends[n], NULL);
+          g_free (head);
+
+          /* check if the new name is equal to the old one */
+          if (strcmp (name, file_name) == 0)
+            {
+              g_free (name);
+              name = NULL;
+            }
+        }
+
+      thunar_renamer_model_update_item (renamer_model, links[n], indices[n], name);
     }
 
-  return name;
+  /* release the temporary strings, @results may contain %NULL entries */
+  for (n = 0; n < n_texts; ++n)
+    {
+      g_free (texts[n]);
+      if (results != NULL)
+        g_free (results[n]);
+    }
+  g_free (results);
 }
 
 
@@ -900,78 +1307,111 @@ thunar_renamer_model_process_item (ThunarRenamerModel     *renamer_model,
 static gboolean
 thunar_renamer_model_update_idle (gpointer user_data)
 {
-  ThunarRenamerModelItem *item;
-  ThunarRenamerModel     *renamer_model = THUNAR_RENAMER_MODEL (user_data);
-  GtkTreePath            *path;
-  GtkTreeIter             iter;
-  gboolean                changed = FALSE;
-  gboolean                conflict;
-  guint                   idx;
-  gchar                  *name;
-  GList                  *lp;
+  ThunarRenamerModel *renamer_model = THUNAR_RENAMER_MODEL (user_data);
+  gboolean            wrapped = FALSE;
+  gint64              end_time;
+  gint64              batch_time;
+  gint64              now;
+  GList              *links[THUNAR_RENAMER_MODEL_BATCH_SIZE];
+  GList              *lp;
+  guint               indices[THUNAR_RENAMER_MODEL_BATCH_SIZE];
+  guint               n_links = 0;
+  guint               batch_size = THUNAR_RENAMER_MODEL_FIRST_BATCH_SIZE;
+  gint                idx;
 
   /* don't do anything if the model is frozen */
-  if (G_LIKELY (!renamer_model->frozen))
+  if (G_UNLIKELY (renamer_model->frozen))
+    return FALSE;
+
+  end_time = g_get_monotonic_time () + THUNAR_RENAMER_MODEL_UPDATE_BUDGET;
+
+  /* update the rows the user is looking at first */
+  if (renamer_model->visible_start >= 0)
     {
-      /* process the first dirty item */
-      for (idx = 0, lp = renamer_model->items; !changed && lp != NULL; ++idx, lp = lp->next)
+      for (idx = renamer_model->visible_start, lp = g_list_nth (renamer_model->items, idx);
+           lp != NULL && idx <= renamer_model->visible_end;
+           ++idx, lp = lp->next)
         {
-          /* check if this item is dirty */
-          item = THUNAR_RENAMER_MODEL_ITEM (lp->data);
-          if (G_LIKELY (!item->dirty))
+          if (!THUNAR_RENAMER_MODEL_ITEM (lp->data)->dirty)
             continue;
 
-          /* check if the file changed */
-          changed = item->changed;
+          links[n_links] = lp;
+          indices[n_links++] = idx;
 
-          /* mark as valid, since we're updating right now */
-          item->changed = FALSE;
-          item->dirty = FALSE;
-
-          /* determine the new name for the item */
-          name = thunar_renamer_model_process_item (renamer_model, item, idx);
-          if (g_strcmp0 (item->name, name) != 0)
+          if (n_links == THUNAR_RENAMER_MODEL_BATCH_SIZE)
             {
-              /* apply new name */
-              g_free (item->name);
-              item->name = name;
-
-              /* the item changed */
-              changed = TRUE;
+              thunar_renamer_model_process_batch (renamer_model, links, indices, n_links);
+              n_links = 0;
             }
-          else
+        }
+
+      if (n_links > 0)
+        {
+          thunar_renamer_model_process_batch (renamer_model, links, indices, n_links);
+          n_links = 0;
+        }
+    }
+
+  /* continue with the remaining dirty items, until the time slice is used up */
+  batch_time = g_get_monotonic_time ();
+  while (renamer_model->n_dirty > n_links)
+    {
+      if (renamer_model->update_lp == NULL)
+        {
+          /* finish the pending items before starting over */
+          if (n_links > 0)
             {
-              /* release temporary name */
-              g_free (name);
+              thunar_renamer_model_process_batch (renamer_model, links, indices, n_links);
+              n_links = 0;
             }
 
-          /* check if this item conflicts with any other item */
-          conflict = thunar_renamer_model_conflict_item (renamer_model, item);
-          if (item->conflict != conflict)
+          /* safety net, in case the dirty count got out of sync */
+          if (G_UNLIKELY (wrapped))
             {
-              /* apply the new state */
-              item->conflict = conflict;
-
-              /* the item changed */
-              changed = TRUE;
+              renamer_model->n_dirty = 0;
+              break;
             }
 
-          /* check if the item changed */
-          if (G_LIKELY (changed))
-            {
-              /* generate the iter for the item */
-              GTK_TREE_ITER_INIT (iter, renamer_model->stamp, lp);
+          renamer_model->update_lp = renamer_model->items;
+          renamer_model->update_idx = 0;
+          wrapped = TRUE;
+          continue;
+        }
 
-              /* emit "row-changed" for this item */
-              path = gtk_tree_path_new_from_indices (idx, -1);
-              gtk_tree_model_row_changed (GTK_TREE_MODEL (renamer_model), path, &iter);
-              gtk_tree_path_free (path);
+      if (THUNAR_RENAMER_MODEL_ITEM (renamer_model->update_lp->data)->dirty)
+        {
+          links[n_links] = renamer_model->update_lp;
+          indices[n_links++] = renamer_model->update_idx;
+        }
+
+      renamer_model->update_lp = renamer_model->update_lp->next;
+      renamer_model->update_idx++;
+
+      if (n_links == batch_size)
+        {
+          thunar_renamer_model_process_batch (renamer_model, links, indices, n_links);
+
+          now = g_get_monotonic_time ();
+          if (now >= end_time)
+            {
+              n_links = 0;
+              break;
             }
+
+          /* size the next batch to what fits into the rest of the time slice,
+           * so slow renamers cannot overrun it by a whole large batch */
+          batch_size = CLAMP ((end_time - now) * n_links / MAX (now - batch_time, 1), 1, THUNAR_RENAMER_MODEL_BATCH_SIZE);
+          batch_time = now;
+          n_links = 0;
         }
     }
 
-  /* keep the idle source as long as any item changed */
-  return changed;
+  /* process the remaining pending items */
+  if (n_links > 0)
+    thunar_renamer_model_process_batch (renamer_model, links, indices, n_links);
+
+  /* keep the idle source as long as there are dirty items */
+  return renamer_model->n_dirty > 0;
 }
 
 
@@ -998,6 +1438,15 @@ thunar_renamer_model_item_new (ThunarRenamerModel *renamer_model,
   item->file = THUNAR_FILE (g_object_ref (G_OBJECT (file)));
   item->date_changed = thunar_file_get_date (file, THUNAR_FILE_DATE_CHANGED);
   item->dirty = TRUE;
+  renamer_model->n_dirty++;
+
+  /* register the item with its directory */
+  item->dir = thunar_renamer_model_dir_acquire (renamer_model, file);
+  if (item->dir != NULL)
+    {
+      item->basename = g_strdup (thunar_file_get_basename (file));
+      thunar_renamer_model_dir_set_basename (item->dir, NULL, item->basename);
+    }
 
   /* enable file watch for the file */
   thunar_file_watch (item->file);
@@ -1018,6 +1467,21 @@ thunar_renamer_model_release_item (ThunarRenamerModel     *renamer_model,
   thunar_file_unwatch (item->file);
   g_signal_handlers_disconnect_by_data (item->file, renamer_model);
 
+  if (item->dirty)
+    renamer_model->n_dirty--;
+
+  /* unregister the item from its directory */
+  if (item->dir != NULL)
+    {
+      thunar_renamer_model_item_set_target (renamer_model, item, NULL);
+      thunar_renamer_model_dir_set_basename (item->dir, item->basename, NULL);
+      if (--item->dir->n_items == 0)
+        g_hash_table_remove (renamer_model->directories, item->dir->directory);
+    }
+
+  g_free (item->basename);
+  g_free (item->target);
+
   g_object_unref (G_OBJECT (item->file));
   g_free (item->name);
   g_slice_free (ThunarRenamerModelItem, item);
@@ -1298,6 +1762,28 @@ thunar_renamer_model_set_renamer (ThunarRenamerModel *renamer_model,
 
 
 
+/**
+ * thunar_renamer_model_set_visible_range:
+ * @renamer_model : a #ThunarRenamerModel.
+ * @start         : index of the first visible row, or -1.
+ * @end           : index of the last visible row, or -1.
+ *
+ * Tells the @renamer_model which rows are currently visible in the
+ * view, so the new names for these rows are computed first.
+ **/
+void
+thunar_renamer_model_set_visible_range (ThunarRenamerModel *renamer_model,
+                                        gint                start,
+                                        gint                end)
+{
+  _thunar_return_if_fail (THUNAR_IS_RENAMER_MODEL (renamer_model));
+
+  renamer_model->visible_start = MAX (start, -1);
+  renamer_model->visible_end = MAX (end, start);
+}
+
+
+
 /**
  * thunar_renamer_model_insert:
  * @renamer_model : a #ThunarRenamerModel.
@@ -1329,9 +1815,14 @@ thunar_renamer_model_insert (ThunarRenamerModel *renamer_model,
 
   /* append the item to the model */
   renamer_model->items = g_list_insert (renamer_model->items, item, position);
+  item->link = g_list_find (renamer_model->items, item);
+  renamer_model->indices_valid = FALSE;
+
+  /* the position of the update idle source may have shifted */
+  renamer_model->update_lp = NULL;
 
   /* determine the iterator for the new item */
-  GTK_TREE_ITER_INIT (iter, renamer_model->stamp, g_list_find (renamer_model->items, item));
+  GTK_TREE_ITER_INIT (iter, renamer_model->stamp, item->link);
 
   /* emit the "row-inserted" signal */
   path = gtk_tree_model_get_path (GTK_TREE_MODEL (renamer_model), &iter);
@@ -1434,6 +1925,8 @@ thunar_renamer_model_reorder (ThunarRenamerModel *renamer_model,
       lprev = lp;
     }
 
+  renamer_model->indices_valid = FALSE;
+
   /* tell the view about the new item order */
   path = gtk_tree_path_new ();
   gtk_tree_model_rows_reordered (GTK_TREE_MODEL (renamer_model), path, NULL, new_order);
@@ -1529,6 +2022,7 @@ thunar_renamer_model_remove (ThunarRenamerModel *renamer_model,
 
   /* drop the item from the list */
   renamer_model->items = g_list_delete_link (renamer_model->items, lp);
+  renamer_model->indices_valid = FALSE;
 
   /* tell the view that the item is gone */
   gtk_tree_model_row_deleted (GTK_TREE_MODEL (renamer_model), path);
@@ -70,6 +70,11 @@ void
 thunar_renamer_model_set_renamer (ThunarRenamerModel *renamer_model,
                                   ThunarxRenamer     *renamer);
 
+void
+thunar_renamer_model_set_visible_range (ThunarRenamerModel *renamer_model,
+                                        gint                start,
+                                        gint                end);
+
 void
 thunar_renamer_model_insert (ThunarRenamerModel *renamer_model,
                              ThunarFile         *file,
@@ -26,6 +26,7 @@
 #include <locale.h>
 #endif
 
+#include "thunar/thunar-application.h"
 #include "thunar/thunar-deep-count-job.h"
 #include "thunar/thunar-gtk-extensions.h"
 #include "thunar/thunar-preferences.h"
@@ -65,6 +66,8 @@ thunar_size_label_button_press_event (GtkWidget       *ebox,
                                       ThunarSizeLabel *size_label);
 static void
 thunar_size_label_files_changed (ThunarSizeLabel *size_label);
+static gboolean
+thunar_size_label_trash_usage (ThunarSizeLabel *size_label);
 static void
 thunar_size_label_error (ThunarJob       *job,
                          const GError    *error,
@@ -348,9 +351,17 @@ thunar_size_label_files_changed (ThunarSizeLabel *size_label)
       size_label->job = NULL;
     }
 
+  /* the trash root is accounted, no need to walk it */
+  if (size_label->files->next == NULL
+      && thunar_file_is_trash (THUNAR_FILE (size_label->files->data))
+      && thunar_size_label_trash_usage (size_label))
+    {
+      gtk_spinner_stop (GTK_SPINNER (size_label->spinner));
+      gtk_widget_hide (size_label->spinner);
+    }
   /* check if there are multiple files or the single file is a directory */
-  if (size_label->files->next != NULL
-      || thunar_file_is_directory (THUNAR_FILE (size_label->files->data)))
+  else if (size_label->files->next != NULL
+           || thunar_file_is_directory (THUNAR_FILE (size_label->files->data)))
     {
       /* schedule a new job to determine the total size of the directory (not following symlinks) */
       size_label->job = thunar_deep_count_job_new (size_label->files, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS);
@@ -398,6 +409,44 @@ thunar_size_label_files_changed (ThunarSizeLabel *size_label)
 
 
 
+/* shows the size or the number of items of the trash, if it was measured by the trash accounting already */
+static gboolean
+thunar_size_label_trash_usage (ThunarSizeLabel *size_label)
+{
+  ThunarApplication     *application;
+  ThunarTrashAccounting *accounting;
+  gboolean               measured;
+  guint64                n_items;
+  guint64                size;
+  gchar                 *text;
+
+  /* the accounting does not know the allocated size */
+  if (size_label->type == THUNAR_SIZE_LABEL_SIZE_ON_DISK)
+    return FALSE;
+
+  /* the first request starts the measuring, the next ones may use it */
+  application = thunar_application_get ();
+  accounting = thunar_application_get_trash_accounting (application);
+  measured = thunar_trash_accounting_get_usage (accounting, &n_items, &size);
+  g_object_unref (accounting);
+  g_object_unref (application);
+
+  if (!measured)
+    return FALSE;
+
+  if (size_label->type == THUNAR_SIZE_LABEL_SIZE)
+    text = g_format_size_full (size, G_FORMAT_SIZE_LONG_FORMAT | (size_label->file_size_binary ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT));
+  else /* if (size_label->type == THUNAR_SIZE_LABEL_CONTENT) */
+    text = g_strdup_printf (ngettext ("%" G_GUINT64_FORMAT " item", "%" G_GUINT64_FORMAT " items", n_items), n_items);
+
+  gtk_label_set_text (GTK_LABEL (size_label->label), text);
+  g_free (text);
+
+  return TRUE;
+}
+
+
+
 static void
 thunar_size_label_error (ThunarJob       *job,
                          const GError    *error,
@@ -57,8 +57,6 @@
 #include <gdk/gdkx.h>
 #endif
 
-#define THUNAR_STANDARD_VIEW_SELECTION_CHANGED_DELAY_MS 10
-
 
 
 /* Property identifiers */
@@ -307,6 +305,11 @@ thunar_standard_view_rows_reordered (ThunarTreeViewModel *model,
                                      gpointer             new_order,
                                      ThunarStandardView  *standard_view);
 static void
+thunar_standard_view_row_changed (ThunarTreeViewModel *model,
+                                  GtkTreePath         *path,
+                                  GtkTreeIter         *iter,
+                                  ThunarStandardView  *standard_view);
+static void
 thunar_standard_view_error (ThunarTreeViewModel *model,
                             const GError        *error,
                             ThunarStandardView  *standard_view);
@@ -378,6 +381,26 @@ thunar_standard_view_update_selected_files (ThunarStandardView *standard_view,
                                             GList              *files_to_select);
 static void
 thunar_standard_view_update_file_drag_mode (ThunarStandardView *standard_view);
+static GList *
+thunar_standard_view_get_selection (ThunarStandardView *standard_view);
+static void
+thunar_standard_view_selection_clear (ThunarStandardView *standard_view);
+static void
+thunar_standard_view_selection_refresh (ThunarStandardView *standard_view,
+                                        ThunarFile         *file);
+static guint64
+thunar_standard_view_selection_last_modified (ThunarStandardView *standard_view);
+
+/* what a selected file added to the selection summary, so
+ * it can be taken out again even if the file changed meanwhile */
+typedef struct
+{
+  GList  *link;
+  guint64 size;
+  guint64 date_modified;
+  guint   is_directory : 1;
+  guint   is_hidden : 1;
+} ThunarStandardViewSelectedFile;
 
 struct _ThunarStandardViewPrivate
 {
@@ -445,9 +468,13 @@ struct _ThunarStandardViewPrivate
   gfloat      scroll_to_row_align;
   gfloat      scroll_to_col_align;
 
-  /* #GList of currently selected #ThunarFile<!---->s */
-  GList *selected_files;
-  guint  restore_selection_idle_id;
+  /* currently selected #ThunarFile<!---->s, the queue holds the references and
+   * the table maps them to their #ThunarStandardViewSelectedFile<!---->s */
+  GQueue            selected_files;
+  GHashTable       *selected_files_map;
+  ThunarFileSummary selection_summary;
+  gboolean          selection_summary_date_stale;
+  guint             restore_selection_idle_id;
 
   /* #GList of #ThunarFile<!---->s which are to select when loading the folder finished */
   GList *files_to_select;
@@ -487,9 +514,10 @@ struct _ThunarStandardViewPrivate
 
   GType model_type;
 
-  /* Used in order to throttle selection changes to prevent lag */
-  gboolean selection_changed_requested;
-  guint    selection_changed_timeout_source;
+  /* selection changes are applied right away, but only announced once per frame;
+   * if the view could not tell what changed, the selection is rebuilt lazily */
+  gboolean selection_resync;
+  guint    selection_tick_id;
 
   /* Whether XXL thumbnails near the selection should be requested */
   gboolean preload_preview_images;
@@ -1034,10 +1062,13 @@ thunar_standard_view_init (ThunarStandardView *standard_view)
 {
   standard_view->priv = thunar_standard_view_get_instance_private (standard_view);
 
-  standard_view->priv->selection_changed_timeout_source = 0;
-  standard_view->priv->selection_changed_requested = FALSE;
+  standard_view->priv->selection_resync = FALSE;
+  standard_view->priv->selection_tick_id = 0;
   standard_view->priv->zoom_level_binding = NULL;
 
+  g_queue_init (&standard_view->priv->selected_files);
+  standard_view->priv->selected_files_map = g_hash_table_new (g_direct_hash, NULL);
+
   /* allocate the scroll_to_files mapping (directory GFile -> first visible child GFile) */
   standard_view->priv->scroll_to_files = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal, g_object_unref, g_object_unref);
 
@@ -1205,6 +1236,7 @@ thunar_standard_view_constructed (GObject *object)
 
   standard_view->priv->row_deleted_id = g_signal_connect_after (G_OBJECT (standard_view->model), "row-deleted", G_CALLBACK (thunar_standard_view_select_after_row_deleted), standard_view);
   g_signal_connect (G_OBJECT (standard_view->model), "rows-reordered", G_CALLBACK (thunar_standard_view_rows_reordered), standard_view);
+  g_signal_connect (G_OBJECT (standard_view->model), "row-changed", G_CALLBACK (thunar_standard_view_row_changed), standard_view);
   g_signal_connect (G_OBJECT (standard_view->model), "error", G_CALLBACK (thunar_standard_view_error), standard_view);
   g_signal_connect (G_OBJECT (standard_view->model), "search-done", G_CALLBACK (thunar_standard_view_search_done), standard_view);
   g_object_bind_property (G_OBJECT (standard_view->preferences), "misc-case-sensitive", G_OBJECT (standard_view->model), "case-sensitive", G_BINDING_SYNC_CREATE);
@@ -1273,10 +1305,10 @@ thunar_standard_view_dispose (GObject *object)
     }
 #endif
 
-  if (standard_view->priv->selection_changed_timeout_source != 0)
+  if (standard_view->priv->selection_tick_id != 0)
     {
-      g_source_remove (standard_view->priv->selection_changed_timeout_source);
-      standard_view->priv->selection_changed_timeout_source = 0;
+      gtk_widget_remove_tick_callback (GTK_WIDGET (standard_view), standard_view->priv->selection_tick_id);
+      standard_view->priv->selection_tick_id = 0;
     }
 
   if (standard_view->priv->restore_selection_idle_id != 0)
@@ -1337,8 +1369,9 @@ thunar_standard_view_finalize (GObject *object)
   if (G_UNLIKELY (standard_view->priv->css_provider != NULL))
     g_object_unref (G_OBJECT (standard_view->priv->css_provider));
 
-  /* release the selected_files list and the files to select (if any) */
-  thunar_g_list_free_full (standard_view->priv->selected_files);
+  /* release the selected files and the files to select (if any) */
+  thunar_standard_view_selection_clear (standard_view);
+  g_hash_table_destroy (standard_view->priv->selected_files_map);
   thunar_g_list_free_full (standard_view->priv->files_to_select);
 
   /* release the drag path list (just in case the drag-end wasn't fired before) */
@@ -1673,7 +1706,7 @@ thunar_standard_view_draw (GtkWidget *widget,
 static GList *
 thunar_standard_view_get_selected_files_component (ThunarComponent *component)
 {
-  return THUNAR_STANDARD_VIEW (component)->priv->selected_files;
+  return thunar_standard_view_get_selection (THUNAR_STANDARD_VIEW (component));
 }
 
 
@@ -1681,7 +1714,7 @@ thunar_standard_view_get_selected_files_component (ThunarComponent *component)
 static GList *
 thunar_standard_view_get_selected_files_view (ThunarView *view)
 {
-  return THUNAR_STANDARD_VIEW (view)->priv->selected_files;
+  return thunar_standard_view_get_selection (THUNAR_STANDARD_VIEW (view));
 }
 
 
@@ -1756,12 +1789,9 @@ thunar_standard_view_set_selected_files_component (ThunarComponent *component,
   if (selected_files == NULL)
     return;
 
-  /* clear the current selection */
-  if (standard_view->priv->selected_files != NULL)
-    {
-      thunar_g_list_free_full (standard_view->priv->selected_files);
-      standard_view->priv->selected_files = NULL;
-    }
+  /* clear the current selection, whatever the view still shows is picked up again when needed */
+  thunar_standard_view_selection_clear (standard_view);
+  standard_view->priv->selection_resync = TRUE;
 
   /* The selection will either be updated directly, or after loading the folder got finished */
   if (thunar_view_get_loading (THUNAR_VIEW (standard_view)))
@@ -1900,6 +1930,7 @@ thunar_standard_view_set_current_directory (ThunarNavigator *navigator,
       folder = thunar_folder_get_for_file (standard_view->priv->current_directory);
       g_signal_handlers_disconnect_by_data (standard_view->priv->current_directory, standard_view);
       g_signal_handlers_disconnect_by_data (folder, standard_view);
+      thunar_folder_set_displayed (folder, FALSE);
       g_object_unref (folder);
       g_object_unref (standard_view->priv->current_directory);
     }
@@ -1950,6 +1981,7 @@ thunar_standard_view_set_current_directory (ThunarNavigator *navigator,
   /* open the new directory as folder */
   folder = thunar_folder_get_for_file (current_directory);
   g_signal_connect_swapped (folder, "thumbnails-updated", G_CALLBACK (thunar_standard_view_queue_redraw), standard_view);
+  thunar_folder_set_displayed (folder, TRUE);
 
   /* disconnect any old bindings */
   if (G_UNLIKELY (standard_view->loading_binding != NULL))
@@ -2739,8 +2771,7 @@ static gboolean
 thunar_standard_view_update_statusbar_text_idle (gpointer data)
 {
   ThunarStandardView *standard_view = THUNAR_STANDARD_VIEW (data);
-  GList              *selected_items_tree_path_list;
-  GtkTreeIter         iter;
+  GList              *selected_files;
   ThunarFile         *file;
   gchar              *statusbar_text;
 
@@ -2757,10 +2788,10 @@ thunar_standard_view_update_statusbar_text_idle (gpointer data)
       standard_view->priv->statusbar_job = NULL;
     }
 
-  /* query the selected items */
-  selected_items_tree_path_list = THUNAR_STANDARD_VIEW_GET_CLASS (standard_view)->get_selected_items (standard_view);
+  /* query the selected files */
+  selected_files = thunar_standard_view_get_selection (standard_view);
 
-  if (selected_items_tree_path_list == NULL) /* nothing selected */
+  if (selected_files == NULL) /* nothing selected */
     {
       if (thunar_tree_view_model_get_folder (standard_view->model) == NULL)
         return FALSE;
@@ -2788,16 +2819,9 @@ thunar_standard_view_update_statusbar_text_idle (gpointer data)
 
       thunar_job_launch (THUNAR_JOB (standard_view->priv->statusbar_job));
     }
-  else if (selected_items_tree_path_list->next == NULL) /* only one item selected */
+  else if (selected_files->next == NULL) /* only one item selected */
     {
-      /* resolve the iter for the single path */
-      gtk_tree_model_get_iter (GTK_TREE_MODEL (standard_view->model), &iter, selected_items_tree_path_list->data);
-
-      /* get the file for the given iter */
-      file = thunar_tree_view_model_get_file (standard_view->model, &iter);
-
-      if (file == NULL)
-        return FALSE;
+      file = THUNAR_FILE (selected_files->data);
 
       /* For a single file we load the text without using a separate job */
       statusbar_text = thunar_util_get_statusbar_text_for_single_file (file);
@@ -2805,42 +2829,37 @@ thunar_standard_view_update_statusbar_text_idle (gpointer data)
         thunar_standard_view_set_statusbar_text (standard_view, statusbar_text);
       g_free (statusbar_text);
 
-      g_object_unref (file);
       g_object_notify_by_pspec (G_OBJECT (standard_view), standard_view_props[PROP_STATUSBAR_TEXT]);
     }
   else /* more than one item selected */
     {
-      GHashTable *selected_g_files = g_hash_table_new (g_direct_hash, NULL);
-      GList      *lp;
-
-      /* clear information from the statusbar */
-      statusbar_text = g_strdup (_("Loading selection information..."));
+      ThunarFileSummary summary = standard_view->priv->selection_summary;
+      gboolean          show_hidden;
+      gboolean          show_file_size_binary_format;
+      ThunarDateStyle   date_style;
+      gchar            *date_custom_style;
+      guint             status_bar_active_info;
+      gchar            *text_for_files;
+
+      g_object_get (G_OBJECT (standard_view->preferences), "last-show-hidden", &show_hidden,
+                    "misc-date-style", &date_style,
+                    "misc-date-custom-style", &date_custom_style,
+                    "misc-file-size-binary", &show_file_size_binary_format,
+                    "misc-status-bar-active-info", &status_bar_active_info, NULL);
+
+      /* the selection keeps its totals up to date, so no need to look at each file */
+      summary.last_modified = thunar_standard_view_selection_last_modified (standard_view);
+      text_for_files = thunar_util_get_statusbar_text_for_summary (&summary, show_hidden, show_file_size_binary_format,
+                                                                   date_style, date_custom_style, status_bar_active_info);
+      statusbar_text = g_strdup_printf (_("Selection: %s"), text_for_files);
       thunar_standard_view_set_statusbar_text (standard_view, statusbar_text);
       g_free (statusbar_text);
-      g_object_notify_by_pspec (G_OBJECT (standard_view), standard_view_props[PROP_STATUSBAR_TEXT]);
-
-      /* build GList of files from selection */
-      for (lp = selected_items_tree_path_list; lp != NULL; lp = lp->next)
-        {
-          gtk_tree_model_get_iter (GTK_TREE_MODEL (standard_view->model), &iter, lp->data);
-          file = thunar_tree_view_model_get_file (standard_view->model, &iter);
-          if (file != NULL)
-            {
-              g_hash_table_add (selected_g_files, thunar_file_get_file (file));
-              g_object_unref (file);
-            }
-        }
-
-      standard_view->priv->statusbar_job = thunar_io_jobs_load_statusbar_text_for_selection (standard_view, selected_g_files);
-      g_signal_connect (standard_view->priv->statusbar_job, "error", G_CALLBACK (thunar_standard_view_update_statusbar_text_error), standard_view);
-      g_signal_connect (standard_view->priv->statusbar_job, "finished", G_CALLBACK (thunar_standard_view_load_statusbar_text_finished), standard_view);
-      g_hash_table_destroy (selected_g_files);
+      g_free (text_for_files);
+      g_free (date_custom_style);
 
-      thunar_job_launch (THUNAR_JOB (standard_view->priv->statusbar_job));
+      g_object_notify_by_pspec (G_OBJECT (standard_view), standard_view_props[PROP_STATUSBAR_TEXT]);
     }
 
-  g_list_free_full (selected_items_tree_path_list, (GDestroyNotify) gtk_tree_path_free);
-
   return FALSE;
 }
 
@@ -4073,7 +4092,7 @@ thunar_standard_view_drag_begin (GtkWidget          *view,
   thunar_g_list_free_full (standard_view->priv->drag_g_file_list);
 
   /* query the list of selected URIs */
-  standard_view->priv->drag_g_file_list = thunar_file_list_to_thunar_g_file_list (standard_view->priv->selected_files);
+  standard_view->priv->drag_g_file_list = thunar_file_list_to_thunar_g_file_list (thunar_standard_view_get_selection (standard_view));
   if (G_LIKELY (standard_view->priv->drag_g_file_list != NULL))
     {
       /* determine the first selected file */
@@ -4128,7 +4147,7 @@ thunar_standard_view_drag_data_delete (GtkWidget          *view,
                                        GdkDragContext     *context,
                                        ThunarStandardView *standard_view)
 {
-  /* make sure the default handler of XfceIconView/GtkTreeView is never run */
+  /* make sure the default handler of ThunarGridView/GtkTreeView is never run */
   g_signal_stop_emission_by_name (G_OBJECT (view), "drag-data-delete");
 }
 
@@ -4171,7 +4190,7 @@ thunar_standard_view_restore_selection_idle (gpointer user_data)
   g_object_set (G_OBJECT (vadjustment), "lower", v, "upper", v, NULL);
 
   /* restore the selected files */
-  thunar_standard_view_update_selected_files (standard_view, standard_view->priv->selected_files);
+  thunar_standard_view_update_selected_files (standard_view, thunar_standard_view_get_selection (standard_view));
 
   standard_view->priv->restore_selection_idle_id = 0;
 
@@ -4209,6 +4228,36 @@ thunar_standard_view_rows_reordered (ThunarTreeViewModel *model,
 
 
 
+static void
+thunar_standard_view_row_changed (ThunarTreeViewModel *model,
+                                  GtkTreePath         *path,
+                                  GtkTreeIter         *iter,
+                                  ThunarStandardView  *standard_view)
+{
+  ThunarFile *file;
+
+  _thunar_return_if_fail (THUNAR_IS_TREE_VIEW_MODEL (model));
+  _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
+
+  /* a pending rebuild will pick up the change anyway */
+  if (standard_view->priv->selection_resync || g_hash_table_size (standard_view->priv->selected_files_map) == 0)
+    return;
+
+  /* a selected file changed, e.g. its size, so the totals of the statusbar are outdated */
+  file = thunar_tree_view_model_get_file (model, iter);
+  if (file != NULL)
+    {
+      if (g_hash_table_contains (standard_view->priv->selected_files_map, file))
+        {
+          thunar_standard_view_selection_refresh (standard_view, file);
+          thunar_standard_view_update_statusbar_text (standard_view);
+        }
+      g_object_unref (file);
+    }
+}
+
+
+
 static void
 thunar_standard_view_select_after_row_deleted (ThunarTreeViewModel *model,
                                                GtkTreePath         *path,
@@ -4222,7 +4271,7 @@ thunar_standard_view_select_after_row_deleted (ThunarTreeViewModel *model,
     return;
 
   /* ignore if we have selected files */
-  if (standard_view->priv->selected_files != NULL)
+  if (thunar_standard_view_get_selection (standard_view) != NULL)
     return;
 
   /* select the path */
@@ -4632,76 +4681,258 @@ thunar_standard_view_queue_popup (ThunarStandardView *standard_view,
 
 
 
+/* reads the state of @file into @selected_file and adds it to the selection summary */
+static void
+thunar_standard_view_selection_account (ThunarStandardView             *standard_view,
+                                        ThunarStandardViewSelectedFile *selected_file,
+                                        ThunarFile                     *file)
+{
+  ThunarFileSummary *summary = &standard_view->priv->selection_summary;
+
+  selected_file->size = 0;
+  selected_file->date_modified = thunar_file_get_date (file, THUNAR_FILE_DATE_MODIFIED);
+  selected_file->is_directory = thunar_file_is_directory (file);
+  selected_file->is_hidden = thunar_file_is_hidden (file);
+
+  if (selected_file->is_directory)
+    {
+      summary->folder_count++;
+      if (selected_file->is_hidden)
+        summary->hidden_folder_count++;
+    }
+  else
+    {
+      selected_file->size = thunar_file_get_size (file);
+      summary->size += selected_file->size;
+      summary->file_count++;
+      if (selected_file->is_hidden)
+        summary->hidden_file_count++;
+    }
+
+  if (summary->last_modified < selected_file->date_modified)
+    summary->last_modified = selected_file->date_modified;
+}
+
+
+
+/* takes back exactly what @selected_file added to the selection summary */
+static void
+thunar_standard_view_selection_unaccount (ThunarStandardView             *standard_view,
+                                          ThunarStandardViewSelectedFile *selected_file)
+{
+  ThunarFileSummary *summary = &standard_view->priv->selection_summary;
+
+  if (selected_file->is_directory)
+    {
+      summary->folder_count--;
+      if (selected_file->is_hidden)
+        summary->hidden_folder_count--;
+    }
+  else
+    {
+      summary->size -= selected_file->size;
+      summary->file_count--;
+      if (selected_file->is_hidden)
+        summary->hidden_file_count--;
+    }
+
+  /* the latest modification date is only searched again when it is needed */
+  if (selected_file->date_modified >= summary->last_modified)
+    standard_view->priv->selection_summary_date_stale = TRUE;
+}
+
+
+
+static void
+thunar_standard_view_selection_add (ThunarStandardView *standard_view,
+                                    ThunarFile         *file)
+{
+  ThunarStandardViewSelectedFile *selected_file;
+
+  if (g_hash_table_contains (standard_view->priv->selected_files_map, file))
+    return;
+
+  selected_file = g_slice_new0 (ThunarStandardViewSelectedFile);
+  g_queue_push_tail (&standard_view->priv->selected_files, g_object_ref (file));
+  selected_file->link = standard_view->priv->selected_files.tail;
+  g_hash_table_insert (standard_view->priv->selected_files_map, file, selected_file);
+
+  thunar_standard_view_selection_account (standard_view, selected_file, file);
+}
+
+
+
+static void
+thunar_standard_view_selection_remove (ThunarStandardView *standard_view,
+                                       ThunarFile         *file)
+{
+  ThunarStandardViewSelectedFile *selected_file;
+
+  selected_file = g_hash_table_lookup (standard_view->priv->selected_files_map, file);
+  if (selected_file == NULL)
+    return;
+
+  thunar_standard_view_selection_unaccount (standard_view, selected_file);
+
+  g_hash_table_remove (standard_view->priv->selected_files_map, file);
+  g_queue_delete_link (&standard_view->priv->selected_files, selected_file->link);
+  g_slice_free (ThunarStandardViewSelectedFile, selected_file);
+  g_object_unref (file);
+}
+
+
+
+/* accounts the current state of the selected @file, keeping its place in the selection */
+static void
+thunar_standard_view_selection_refresh (ThunarStandardView *standard_view,
+                                        ThunarFile         *file)
+{
+  ThunarStandardViewSelectedFile *selected_file;
+
+  selected_file = g_hash_table_lookup (standard_view->priv->selected_files_map, file);
+  if (selected_file == NULL)
+    return;
+
+  thunar_standard_view_selection_unaccount (standard_view, selected_file);
+  thunar_standard_view_selection_account (standard_view, selected_file, file);
+}
+
+
+
+static void
+thunar_standard_view_selection_clear (ThunarStandardView *standard_view)
+{
+  GHashTableIter iter;
+  gpointer       selected_file;
+
+  g_hash_table_iter_init (&iter, standard_view->priv->selected_files_map);
+  while (g_hash_table_iter_next (&iter, NULL, &selected_file))
+    g_slice_free (ThunarStandardViewSelectedFile, selected_file);
+  g_hash_table_remove_all (standard_view->priv->selected_files_map);
+
+  g_queue_clear_full (&standard_view->priv->selected_files, g_object_unref);
+
+  memset (&standard_view->priv->selection_summary, 0, sizeof (ThunarFileSummary));
+  standard_view->priv->selection_summary_date_stale = FALSE;
+}
+
+
+
+static guint64
+thunar_standard_view_selection_last_modified (ThunarStandardView *standard_view)
+{
+  ThunarStandardViewSelectedFile *selected_file;
+  ThunarFileSummary              *summary = &standard_view->priv->selection_summary;
+  GHashTableIter                  iter;
+
+  if (standard_view->priv->selection_summary_date_stale)
+    {
+      summary->last_modified = 0;
+      g_hash_table_iter_init (&iter, standard_view->priv->selected_files_map);
+      while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &selected_file))
+        if (summary->last_modified < selected_file->date_modified)
+          summary->last_modified = selected_file->date_modified;
+
+      standard_view->priv->selection_summary_date_stale = FALSE;
+    }
+
+  return summary->last_modified;
+}
+
+
+
 static void
-_thunar_standard_view_selection_changed (ThunarStandardView *standard_view)
+thunar_standard_view_selection_resync (ThunarStandardView *standard_view)
 {
   GtkTreeIter iter;
-  GList      *lp, *selected_thunar_files, *next;
+  GList      *selected_items;
+  GList      *lp;
   ThunarFile *file;
 
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
 
-  /* drop any existing "new-files" closure */
-  if (G_UNLIKELY (standard_view->priv->new_files_closure != NULL))
-    {
-      g_closure_invalidate (standard_view->priv->new_files_closure);
-      g_closure_unref (standard_view->priv->new_files_closure);
-      standard_view->priv->new_files_closure = NULL;
-    }
+  standard_view->priv->selection_resync = FALSE;
 
   /* release the previously selected files */
-  thunar_g_list_free_full (standard_view->priv->selected_files);
+  thunar_standard_view_selection_clear (standard_view);
 
-  /* determine the new list of selected files (replacing GtkTreePath's with ThunarFile's) */
-  selected_thunar_files = (*THUNAR_STANDARD_VIEW_GET_CLASS (standard_view)->get_selected_items) (standard_view);
-  for (lp = selected_thunar_files; lp != NULL; lp = next)
+  /* determine the new selected files (replacing GtkTreePath's with ThunarFile's) */
+  selected_items = (*THUNAR_STANDARD_VIEW_GET_CLASS (standard_view)->get_selected_items) (standard_view);
+  for (lp = selected_items; lp != NULL; lp = lp->next)
     {
-      next = lp->next;
       /* determine the iterator for the path */
       if (!gtk_tree_model_get_iter (GTK_TREE_MODEL (standard_view->model), &iter, lp->data))
         {
           g_assert (FALSE);
         }
 
-      gtk_tree_path_free (lp->data);
-
+      /* items which are not files are skipped */
       file = thunar_tree_view_model_get_file (standard_view->model, &iter);
-
       if (file != NULL)
         {
-          /* ...and replace it with the file */
-          lp->data = file;
-        }
-      else
-        {
-          /* If item is not a file, remove from list */
-          selected_thunar_files = g_list_delete_link (selected_thunar_files, lp);
+          thunar_standard_view_selection_add (standard_view, file);
+          g_object_unref (file);
         }
     }
 
-  /* and setup the new selected files list */
-  standard_view->priv->selected_files = selected_thunar_files;
+  g_list_free_full (selected_items, (GDestroyNotify) gtk_tree_path_free);
+}
+
+
+
+static GList *
+thunar_standard_view_get_selection (ThunarStandardView *standard_view)
+{
+  if (standard_view->priv->selection_resync)
+    thunar_standard_view_selection_resync (standard_view);
+
+  return standard_view->priv->selected_files.head;
+}
+
+
+
+static gboolean
+thunar_standard_view_selection_tick (GtkWidget     *widget,
+                                     GdkFrameClock *frame_clock,
+                                     gpointer       user_data)
+{
+  ThunarStandardView *standard_view = THUNAR_STANDARD_VIEW (widget);
+
+  standard_view->priv->selection_tick_id = 0;
+
+  if (standard_view->priv->selection_resync)
+    thunar_standard_view_selection_resync (standard_view);
 
   /* update the statusbar text */
   thunar_standard_view_update_statusbar_text (standard_view);
 
   /* emit notification for "selected-files" */
   g_object_notify_by_pspec (G_OBJECT (standard_view), standard_view_props[PROP_SELECTED_FILES]);
+
+  return G_SOURCE_REMOVE;
 }
 
 
 
-static gboolean
-thunar_standard_view_selection_changed_timeout (ThunarStandardView *standard_view)
+static void
+thunar_standard_view_queue_selection_changed (ThunarStandardView *standard_view)
 {
-  _thunar_return_val_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view), FALSE);
+  /* drop any existing "new-files" closure */
+  if (G_UNLIKELY (standard_view->priv->new_files_closure != NULL))
+    {
+      g_closure_invalidate (standard_view->priv->new_files_closure);
+      g_closure_unref (standard_view->priv->new_files_closure);
+      standard_view->priv->new_files_closure = NULL;
+    }
 
-  if (standard_view->priv->selection_changed_requested)
-    _thunar_standard_view_selection_changed (standard_view);
+  if (standard_view->priv->selection_tick_id != 0)
+    return;
 
-  standard_view->priv->selection_changed_timeout_source = 0;
-  standard_view->priv->selection_changed_requested = FALSE;
-  return FALSE;
+  /* announce all changes of a frame at once, without a frame clock there is nothing to wait for */
+  if (gtk_widget_get_realized (GTK_WIDGET (standard_view)))
+    standard_view->priv->selection_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (standard_view), thunar_standard_view_selection_tick, NULL, NULL);
+  else
+    thunar_standard_view_selection_tick (GTK_WIDGET (standard_view), NULL, NULL);
 }
 
 
@@ -4711,7 +4942,7 @@ thunar_standard_view_selection_changed_timeout (ThunarStandardView *standard_vie
  * @standard_view : a #ThunarStandardView instance.
  *
  * Called by derived classes (and only by derived classes!) whenever the file
- * selection changes.
+ * selection changes, and they cannot tell which items changed.
  *
  * Note, that this is also called internally whenever the number of
  * files in the @standard_view<!---->s model changes.
@@ -4719,22 +4950,64 @@ thunar_standard_view_selection_changed_timeout (ThunarStandardView *standard_vie
 void
 thunar_standard_view_selection_changed (ThunarStandardView *standard_view)
 {
-  /* in case a timeout is running, the selection-change will be delayed (performance) */
-  if (standard_view->priv->selection_changed_timeout_source != 0)
-    {
-      standard_view->priv->selection_changed_requested = TRUE;
-      return;
-    }
+  _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
+
+  /* the selected files are determined again when needed next */
+  standard_view->priv->selection_resync = TRUE;
+  thunar_standard_view_queue_selection_changed (standard_view);
+}
+
 
-  /* handle the first request directly */
-  _thunar_standard_view_selection_changed (standard_view);
 
-  /* throttle consecutive requests if multiple files are selected */
-  if (standard_view->priv->selected_files != NULL && g_list_length (standard_view->priv->selected_files) > 1)
+/**
+ * thunar_standard_view_selection_delta:
+ * @standard_view    : a #ThunarStandardView instance.
+ * @selected_paths   : #GtkTreePath<!---->s of the items which were selected.
+ * @unselected_paths : #GtkTreePath<!---->s of the items which were unselected.
+ *
+ * Like thunar_standard_view_selection_changed(), but for derived classes
+ * which know the items whose selection changed. This only costs time for
+ * the changed items, instead of for all selected items. Reporting an
+ * item whose state did not change is harmless.
+ **/
+void
+thunar_standard_view_selection_delta (ThunarStandardView *standard_view,
+                                      GList              *selected_paths,
+                                      GList              *unselected_paths)
+{
+  GtkTreeIter iter;
+  ThunarFile *file;
+  GList      *lp;
+
+  _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
+
+  /* a pending rebuild will pick up the changes anyway */
+  if (!standard_view->priv->selection_resync)
     {
-      standard_view->priv->selection_changed_timeout_source =
-      g_timeout_add (THUNAR_STANDARD_VIEW_SELECTION_CHANGED_DELAY_MS, (GSourceFunc) thunar_standard_view_selection_changed_timeout, standard_view);
+      for (lp = unselected_paths; lp != NULL; lp = lp->next)
+        if (gtk_tree_model_get_iter (GTK_TREE_MODEL (standard_view->model), &iter, lp->data))
+          {
+            file = thunar_tree_view_model_get_file (standard_view->model, &iter);
+            if (file != NULL)
+              {
+                thunar_standard_view_selection_remove (standard_view, file);
+                g_object_unref (file);
+              }
+          }
+
+      for (lp = selected_paths; lp != NULL; lp = lp->next)
+        if (gtk_tree_model_get_iter (GTK_TREE_MODEL (standard_view->model), &iter, lp->data))
+          {
+            file = thunar_tree_view_model_get_file (standard_view->model, &iter);
+            if (file != NULL)
+              {
+                thunar_standard_view_selection_add (standard_view, file);
+                g_object_unref (file);
+              }
+          }
     }
+
+  thunar_standard_view_queue_selection_changed (standard_view);
 }
 
 
@@ -4881,7 +5154,7 @@ thunar_standard_view_append_menu_item (ThunarStandardView      *standard_view,
   item = xfce_gtk_menu_item_new_from_action_entry (get_action_entry (action), G_OBJECT (standard_view), GTK_MENU_SHELL (menu));
 
   if (action == THUNAR_STANDARD_VIEW_ACTION_UNSELECT_ALL_FILES)
-    gtk_widget_set_sensitive (item, standard_view->priv->selected_files != NULL);
+    gtk_widget_set_sensitive (item, thunar_standard_view_get_selection (standard_view) != NULL);
 
   return item;
 }
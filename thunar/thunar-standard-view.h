@@ -195,6 +195,10 @@ thunar_standard_view_queue_popup (ThunarStandardView *standard_view,
 void
 thunar_standard_view_selection_changed (ThunarStandardView *standard_view);
 void
+thunar_standard_view_selection_delta (ThunarStandardView *standard_view,
+                                      GList              *selected_paths,
+                                      GList              *unselected_paths);
+void
 thunar_standard_view_set_history (ThunarStandardView *standard_view,
                                   ThunarHistory      *history);
 ThunarHistory *
@@ -49,6 +49,10 @@ thunar_thumbnail_cache_move_file (ThunarThumbnailCache *cache,
                                   GFile                *source_file,
                                   GFile                *target_file);
 void
+thunar_thumbnail_cache_move_files (ThunarThumbnailCache *cache,
+                                   GList                *source_files,
+                                   GList                *target_files);
+void
 thunar_thumbnail_cache_copy_file (ThunarThumbnailCache *cache,
                                   GFile                *source_file,
                                   GFile                *target_file);
@@ -0,0 +1,474 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_STDARG_H
+#include <stdarg.h>
+#endif
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "thunar/thunar-trace.h"
+
+#include <glib/gstdio.h>
+
+/**
+ * SECTION:thunar-trace
+ * @Short_description: Records main loop stalls as Chrome trace events
+ * @Title: ThunarTrace
+ *
+ * When Thunar is started with THUNAR_TRACE set to a file name, every main
+ * loop iteration and every instrumented code path (jobs, folder updates,
+ * tree model values, icon loads, extension providers) which takes longer
+ * than THUNAR_TRACE_THRESHOLD milliseconds (16 by default) is written to
+ * that file.
+ *
+ * The file uses the JSON array format of the Chrome trace event format, and
+ * can be loaded into chrome://tracing or https://ui.perfetto.dev. Events are
+ * written as soon as they are recorded, so the file stays usable even if
+ * Thunar has to be killed.
+ *
+ * The "dispatch" events of the main loop name the slowest idle or timeout
+ * source dispatched in that iteration (its name and id), if any.
+ *
+ * If THUNAR_TRACE is not set, thunar_trace_begin() returns 0 and the
+ * thunar_trace_end() functions return right away, so the instrumentation
+ * stays cheap enough for the hot paths.
+ */
+
+
+
+/* default threshold for recording events (in milliseconds) */
+#define THUNAR_TRACE_DEFAULT_THRESHOLD (16.0)
+
+
+
+/* the dispatch function of a GSourceFuncs, see thunar_trace_dispatch() */
+typedef gboolean (*ThunarTraceDispatchFunc) (GSource    *source,
+                                             GSourceFunc callback,
+                                             gpointer    user_data);
+
+
+
+static gint
+thunar_trace_poll (GPollFD *ufds,
+                   guint    nfds,
+                   gint     timeout);
+static gboolean
+thunar_trace_dispatch (GSource                *source,
+                       GSourceFunc             callback,
+                       gpointer                user_data,
+                       ThunarTraceDispatchFunc dispatch);
+static gboolean
+thunar_trace_idle_dispatch (GSource    *source,
+                            GSourceFunc callback,
+                            gpointer    user_data);
+static gboolean
+thunar_trace_timeout_dispatch (GSource    *source,
+                               GSourceFunc callback,
+                               gpointer    user_data);
+static gint
+thunar_trace_get_tid (void);
+static void
+thunar_trace_append_escaped (GString     *string,
+                             const gchar *text);
+static void
+thunar_trace_write (gint64       begin_time,
+                    gint64       duration,
+                    const gchar *category,
+                    const gchar *name,
+                    const gchar *detail,
+                    const gchar *source_name,
+                    guint        source_id);
+
+
+
+static FILE                   *thunar_trace_file = NULL;
+static GMutex                  thunar_trace_mutex;
+static gint64                  thunar_trace_threshold;
+static gint                    thunar_trace_pid;
+static gint                    thunar_trace_next_tid = 0;
+static GPrivate                thunar_trace_tid;
+static GPollFunc               thunar_trace_default_poll = NULL;
+static gint64                  thunar_trace_dispatch_time = 0;
+static ThunarTraceDispatchFunc thunar_trace_default_idle_dispatch = NULL;
+static ThunarTraceDispatchFunc thunar_trace_default_timeout_dispatch = NULL;
+
+/* the slowest source dispatched since the last poll, main thread only */
+static gint64 thunar_trace_source_duration = 0;
+static gchar *thunar_trace_source_name = NULL;
+static guint  thunar_trace_source_id = 0;
+
+
+
+static gint
+thunar_trace_poll (GPollFD *ufds,
+                   guint    nfds,
+                   gint     timeout)
+{
+  gint64 duration;
+  gint   result;
+
+  /* everything since the last poll returned was spent dispatching sources */
+  if (G_LIKELY (thunar_trace_dispatch_time != 0))
+    {
+      duration = g_get_monotonic_time () - thunar_trace_dispatch_time;
+      if (G_UNLIKELY (duration >= thunar_trace_threshold))
+        {
+          thunar_trace_write (thunar_trace_dispatch_time, duration, "main-loop", "dispatch", NULL,
+                              thunar_trace_source_name, thunar_trace_source_id);
+        }
+    }
+
+  g_clear_pointer (&thunar_trace_source_name, g_free);
+  thunar_trace_source_id = 0;
+  thunar_trace_source_duration = 0;
+
+  result = (*thunar_trace_default_poll) (ufds, nfds, timeout);
+
+  thunar_trace_dispatch_time = g_get_monotonic_time ();
+
+  return result;
+}
+
+
+
+static gboolean
+thunar_trace_dispatch (GSource                *source,
+                       GSourceFunc             callback,
+                       gpointer                user_data,
+                       ThunarTraceDispatchFunc dispatch)
+{
+  gboolean result;
+  gint64   begin_time;
+  gint64   duration;
+  guint    source_id;
+  gchar   *source_name;
+
+  /* only the main loop is traced, see thunar_trace_poll() */
+  if (g_source_get_context (source) != g_main_context_default ())
+    return (*dispatch) (source, callback, user_data);
+
+  /* the source may be destroyed by the dispatch */
+  source_id = g_source_get_id (source);
+  source_name = g_strdup (g_source_get_name (source));
+
+  begin_time = g_get_monotonic_time ();
+  result = (*dispatch) (source, callback, user_data);
+  duration = g_get_monotonic_time () - begin_time;
+
+  if (duration > thunar_trace_source_duration)
+    {
+      g_free (thunar_trace_source_name);
+      thunar_trace_source_name = g_steal_pointer (&source_name);
+      thunar_trace_source_id = source_id;
+      thunar_trace_source_duration = duration;
+    }
+
+  g_free (source_name);
+
+  return result;
+}
+
+
+
+static gboolean
+thunar_trace_idle_dispatch (GSource    *source,
+                            GSourceFunc callback,
+                            gpointer    user_data)
+{
+  return thunar_trace_dispatch (source, callback, user_data, thunar_trace_default_idle_dispatch);
+}
+
+
+
+static gboolean
+thunar_trace_timeout_dispatch (GSource    *source,
+                               GSourceFunc callback,
+                               gpointer    user_data)
+{
+  return thunar_trace_dispatch (source, callback, user_data, thunar_trace_default_timeout_dispatch);
+}
+
+
+
+static gint
+thunar_trace_get_tid (void)
+{
+  gint tid;
+
+  /* hand out small thread ids, the main thread gets the first one */
+  tid = GPOINTER_TO_INT (g_private_get (&thunar_trace_tid));
+  if (G_UNLIKELY (tid == 0))
+    {
+      tid = g_atomic_int_add (&thunar_trace_next_tid, 1) + 1;
+      g_private_set (&thunar_trace_tid, GINT_TO_POINTER (tid));
+    }
+
+  return tid;
+}
+
+
+
+static void
+thunar_trace_append_escaped (GString     *string,
+                             const gchar *text)
+{
+  const gchar *p;
+  gchar       *valid;
+
+  valid = g_utf8_make_valid (text, -1);
+
+  for (p = valid; *p != '\0'; ++p)
+    {
+      if (*p == '"' || *p == '\\')
+        g_string_append_printf (string, "\\%c", *p);
+      else if ((guchar) *p < 0x20)
+        g_string_append_printf (string, "\\u%04x", (guint) (guchar) *p);
+      else
+        g_string_append_c (string, *p);
+    }
+
+  g_free (valid);
+}
+
+
+
+static void
+thunar_trace_write (gint64       begin_time,
+                    gint64       duration,
+                    const gchar *category,
+                    const gchar *name,
+                    const gchar *detail,
+                    const gchar *source_name,
+                    guint        source_id)
+{
+  GString *event;
+
+  event = g_string_sized_new (128);
+  g_string_append (event, ",\n{\"name\":\"");
+  thunar_trace_append_escaped (event, name);
+  g_string_append (event, "\",\"cat\":\"");
+  thunar_trace_append_escaped (event, category);
+  g_string_append_printf (event, "\",\"ph\":\"X\",\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT ",\"pid\":%d,\"tid\":%d",
+                          begin_time, duration, thunar_trace_pid, thunar_trace_get_tid ());
+
+  if (detail != NULL || source_id != 0)
+    {
+      g_string_append (event, ",\"args\":{");
+      if (detail != NULL)
+        {
+          g_string_append (event, "\"detail\":\"");
+          thunar_trace_append_escaped (event, detail);
+          g_string_append (event, source_id != 0 ? "\"," : "\"");
+        }
+      if (source_id != 0)
+        {
+          g_string_append (event, "\"source\":\"");
+          thunar_trace_append_escaped (event, source_name != NULL ? source_name : "");
+          g_string_append_printf (event, "\",\"source_id\":%u", source_id);
+        }
+      g_string_append_c (event, '}');
+    }
+
+  g_string_append_c (event, '}');
+
+  g_mutex_lock (&thunar_trace_mutex);
+  if (G_LIKELY (thunar_trace_file != NULL))
+    {
+      fputs (event->str, thunar_trace_file);
+      fflush (thunar_trace_file);
+    }
+  g_mutex_unlock (&thunar_trace_mutex);
+
+  g_string_free (event, TRUE);
+}
+
+
+
+/**
+ * thunar_trace_init:
+ *
+ * Enables the tracing if the THUNAR_TRACE environment variable is set,
+ * and starts watching the default main context for stalls. Must be
+ * called from the main thread before the main loop is run.
+ **/
+void
+thunar_trace_init (void)
+{
+  const gchar *filename;
+  const gchar *threshold;
+
+  filename = g_getenv ("THUNAR_TRACE");
+  if (G_LIKELY (filename == NULL || *filename == '\0' || thunar_trace_file != NULL))
+    return;
+
+  thunar_trace_file = g_fopen (filename, "w");
+  if (G_UNLIKELY (thunar_trace_file == NULL))
+    {
+      g_warning ("Failed to open trace file \"%s\": %s", filename, g_strerror (errno));
+      return;
+    }
+
+  threshold = g_getenv ("THUNAR_TRACE_THRESHOLD");
+  thunar_trace_threshold = (threshold != NULL ? g_ascii_strtod (threshold, NULL) : THUNAR_TRACE_DEFAULT_THRESHOLD) * G_TIME_SPAN_MILLISECOND;
+  thunar_trace_pid = getpid ();
+
+  /* the first element of the array names the main thread */
+  fprintf (thunar_trace_file, "[{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"main\"}}",
+           thunar_trace_pid, thunar_trace_get_tid ());
+  fflush (thunar_trace_file);
+
+  /* the poll function is called between main loop iterations, so it sees every dispatch */
+  thunar_trace_default_poll = g_main_context_get_poll_func (NULL);
+  g_main_context_set_poll_func (NULL, thunar_trace_poll);
+
+  /* most of the work of the main loop is done in idle and timeout sources,
+   * so these are measured one by one to name the slowest in a dispatch */
+  thunar_trace_default_idle_dispatch = g_idle_funcs.dispatch;
+  g_idle_funcs.dispatch = thunar_trace_idle_dispatch;
+  thunar_trace_default_timeout_dispatch = g_timeout_funcs.dispatch;
+  g_timeout_funcs.dispatch = thunar_trace_timeout_dispatch;
+}
+
+
+
+/**
+ * thunar_trace_shutdown:
+ *
+ * Stops watching the main context and closes the trace file
+ * opened by thunar_trace_init().
+ **/
+void
+thunar_trace_shutdown (void)
+{
+  g_mutex_lock (&thunar_trace_mutex);
+
+  if (G_LIKELY (thunar_trace_file == NULL))
+    {
+      g_mutex_unlock (&thunar_trace_mutex);
+      return;
+    }
+
+  g_main_context_set_poll_func (NULL, thunar_trace_default_poll);
+  g_idle_funcs.dispatch = thunar_trace_default_idle_dispatch;
+  g_timeout_funcs.dispatch = thunar_trace_default_timeout_dispatch;
+  thunar_trace_dispatch_time = 0;
+  g_clear_pointer (&thunar_trace_source_name, g_free);
+
+  fputs ("\n]\n", thunar_trace_file);
+  fclose (thunar_trace_file);
+  thunar_trace_file = NULL;
+
+  g_mutex_unlock (&thunar_trace_mutex);
+}
+
+
+
+/**
+ * thunar_trace_begin:
+ *
+ * Starts measuring an instrumented code path, which is finished
+ * by passing the returned value to thunar_trace_end().
+ *
+ * Return value: the current monotonic time or 0 if tracing is disabled.
+ **/
+gint64
+thunar_trace_begin (void)
+{
+  if (G_LIKELY (thunar_trace_file == NULL))
+    return 0;
+
+  return g_get_monotonic_time ();
+}
+
+
+
+/**
+ * thunar_trace_end:
+ * @begin_time : the value returned by thunar_trace_begin().
+ * @category   : the category of the event, e.g. "job".
+ * @name       : the name of the event, usually the function name.
+ *
+ * Records a complete event from @begin_time to now, if it took
+ * longer than the threshold.
+ **/
+void
+thunar_trace_end (gint64       begin_time,
+                  const gchar *category,
+                  const gchar *name)
+{
+  gint64 duration;
+
+  if (G_LIKELY (begin_time == 0 || thunar_trace_file == NULL))
+    return;
+
+  duration = g_get_monotonic_time () - begin_time;
+  if (G_LIKELY (duration < thunar_trace_threshold))
+    return;
+
+  thunar_trace_write (begin_time, duration, category, name, NULL, NULL, 0);
+}
+
+
+
+/**
+ * thunar_trace_end_detail:
+ * @begin_time    : the value returned by thunar_trace_begin().
+ * @category      : the category of the event, e.g. "job".
+ * @name          : the name of the event, usually the function name.
+ * @detail_format : printf-style format for additional details.
+ * @...           : the arguments for @detail_format.
+ *
+ * Like thunar_trace_end(), but also records a detail string with the
+ * event. The details are only formatted if the event is recorded.
+ **/
+void
+thunar_trace_end_detail (gint64       begin_time,
+                         const gchar *category,
+                         const gchar *name,
+                         const gchar *detail_format,
+                         ...)
+{
+  va_list args;
+  gchar  *detail;
+  gint64  duration;
+
+  if (G_LIKELY (begin_time == 0 || thunar_trace_file == NULL))
+    return;
+
+  duration = g_get_monotonic_time () - begin_time;
+  if (G_LIKELY (duration < thunar_trace_threshold))
+    return;
+
+  va_start (args, detail_format);
+  detail = g_strdup_vprintf (detail_format, args);
+  va_end (args);
+
+  thunar_trace_write (begin_time, duration, category, name, detail, NULL, 0);
+
+  g_free (detail);
+}
@@ -980,6 +980,7 @@ thunar_transfer_job_copy_node (ThunarTransferJob  *job,
 
   /* update progress information */
   thunar_job_info_message (THUNAR_JOB (job), "%s", g_file_info_get_display_name (node->source_file_info));
+  thunar_job_set_current_file (THUNAR_JOB (job), node->source_file);
 
 retry_copy:
   thunar_transfer_job_check_pause (job);
@@ -1161,6 +1162,7 @@ thunar_transfer_job_prepare_untrash_file (ThunarJob          *job,
   /* update progress information */
   thunar_job_info_message (job, _("Trying to restore \"%s\""),
                            g_file_info_get_display_name (node->source_file_info));
+  thunar_job_set_current_file (job, node->source_file);
 
   /* determine the parent file */
   target_parent = g_file_get_parent (node->target_file);
@@ -1291,6 +1293,7 @@ thunar_transfer_job_move_file (ThunarJob            *job,
 
   /* update progress information */
   thunar_job_info_message (job, _("Trying to move \"%s\""), g_file_info_get_display_name (node->source_file_info));
+  thunar_job_set_current_file (job, node->source_file);
 
   move_successful = g_file_move (node->source_file,
                                  node->target_file,
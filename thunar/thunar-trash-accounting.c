@@ -0,0 +1,1128 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar Development Team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Keeps the number of items and their total size for every trash directory
+ * (the home trash and the `.Trash-$uid` directories of the mounted volumes),
+ * so the trash applet and the trash properties do not need to walk the trash.
+ *
+ * A trash directory is measured once when it shows up, using the
+ * `directorysizes` cache of the trash specification where it is valid. All
+ * file system access, including the check whether a candidate directory is a
+ * trash directory at all, happens in a thread, so a slow volume never blocks
+ * the main loop. After
+ * that only the items reported by the monitor of its `info` directory, and by
+ * the trash job of Thunar, are measured again. Deleted and restored items are
+ * left to the monitor, gvfs escapes the names of the items in trash:/// which
+ * are not in the home trash.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "thunar/thunar-gio-extensions.h"
+#include "thunar/thunar-private.h"
+#include "thunar/thunar-trash-accounting.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+
+
+/* time (in ms) to collect the reported items before they are measured */
+#define THUNAR_TRASH_ACCOUNTING_MEASURE_DELAY (500)
+
+/* time (in ms) to collect the changes before "changed" is emitted */
+#define THUNAR_TRASH_ACCOUNTING_CHANGED_DELAY (100)
+
+#define TRASHINFO_SUFFIX ".trashinfo"
+
+
+
+/* property identifiers */
+enum
+{
+  PROP_0,
+  PROP_VOLUME_MONITOR,
+};
+
+/* signal identifiers */
+enum
+{
+  CHANGED,
+  LAST_SIGNAL
+};
+
+
+
+typedef struct _ThunarTrashDir ThunarTrashDir;
+
+
+
+static void
+thunar_trash_accounting_constructed (GObject *object);
+static void
+thunar_trash_accounting_finalize (GObject *object);
+static void
+thunar_trash_accounting_set_property (GObject      *object,
+                                      guint         prop_id,
+                                      const GValue *value,
+                                      GParamSpec   *pspec);
+static void
+thunar_trash_accounting_mount_added (GVolumeMonitor        *volume_monitor,
+                                     GMount                *mount,
+                                     ThunarTrashAccounting *accounting);
+static void
+thunar_trash_accounting_mount_removed (GVolumeMonitor        *volume_monitor,
+                                       GMount                *mount,
+                                       ThunarTrashAccounting *accounting);
+static void
+thunar_trash_accounting_add_dir (ThunarTrashAccounting *accounting,
+                                 const gchar           *path,
+                                 gboolean               shared);
+static void
+thunar_trash_accounting_measure (ThunarTrashAccounting *accounting,
+                                 ThunarTrashDir        *dir);
+static void
+thunar_trash_accounting_schedule (ThunarTrashAccounting *accounting);
+static void
+thunar_trash_accounting_changed (ThunarTrashAccounting *accounting);
+
+
+
+struct _ThunarTrashAccountingClass
+{
+  GObjectClass __parent__;
+};
+
+struct _ThunarTrashAccounting
+{
+  GObject __parent__;
+
+  GVolumeMonitor *volume_monitor;
+
+  /* path of the trash directory -> ThunarTrashDir */
+  GHashTable *dirs;
+
+  guint measure_timer_id;
+  guint changed_timer_id;
+};
+
+struct _ThunarTrashDir
+{
+  ThunarTrashAccounting *accounting;
+
+  /* the directory containing `files` and `info` */
+  gchar        *path;
+  GFileMonitor *monitor;
+
+  /* whether @path is the shared $topdir/.Trash/$uid, and whether it turned out to be a trash directory */
+  gboolean shared;
+  gboolean verified;
+
+  /* trash name -> size (guint64) of the items measured so far */
+  GHashTable *items;
+  guint64     size;
+
+  /* trash names which need to be measured (again) */
+  GHashTable *pending;
+
+  gboolean seeded;
+  gboolean measuring;
+};
+
+/* the work of a measuring thread, @names is %NULL to measure the whole trash directory.
+ * If @verify is set, the thread only checks whether @path is a trash directory */
+typedef struct
+{
+  gchar      *path;
+  gchar     **names;
+  GHashTable *sizes;
+  GPtrArray  *missing;
+  gboolean    verify;
+  gboolean    shared;
+  gboolean    is_trash_dir;
+} ThunarTrashMeasure;
+
+/* an item of the directorysizes cache */
+typedef struct
+{
+  guint64 size;
+  gint64  mtime;
+} ThunarTrashDirectorySize;
+
+
+
+static guint                  accounting_signals[LAST_SIGNAL];
+static ThunarTrashAccounting *accounting_instance = NULL;
+
+
+
+G_DEFINE_TYPE (ThunarTrashAccounting, thunar_trash_accounting, G_TYPE_OBJECT)
+
+
+
+static void
+thunar_trash_accounting_class_init (ThunarTrashAccountingClass *klass)
+{
+  GObjectClass *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->constructed = thunar_trash_accounting_constructed;
+  gobject_class->finalize = thunar_trash_accounting_finalize;
+  gobject_class->set_property = thunar_trash_accounting_set_property;
+
+  /**
+   * ThunarTrashAccounting:volume-monitor:
+   *
+   * The #GVolumeMonitor which reports the mounted volumes, the
+   * default one if %NULL.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_VOLUME_MONITOR,
+                                   g_param_spec_object ("volume-monitor", "volume-monitor", "volume-monitor",
+                                                        G_TYPE_VOLUME_MONITOR,
+                                                        G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * ThunarTrashAccounting::changed:
+   * @accounting : a #ThunarTrashAccounting.
+   *
+   * Emitted when the number of items or the size of the trash changed,
+   * or when the trash was measured for the first time.
+   **/
+  accounting_signals[CHANGED] =
+  g_signal_new (I_ ("changed"),
+                G_TYPE_FROM_CLASS (klass),
+                G_SIGNAL_RUN_LAST,
+                0, NULL, NULL,
+                g_cclosure_marshal_VOID__VOID,
+                G_TYPE_NONE, 0);
+}
+
+
+
+/* returns the trash directories of the user on the volume mounted at @root,
+ * the first one is in the shared $topdir/.Trash */
+static gchar **
+thunar_trash_accounting_get_volume_dirs (const gchar *root)
+{
+  gchar **paths;
+  gchar  *uid;
+
+  uid = g_strdup_printf ("%u", (guint) getuid ());
+
+  paths = g_new0 (gchar *, 3);
+  paths[0] = g_build_filename (root, ".Trash", uid, NULL);
+  paths[1] = g_strconcat (root, G_DIR_SEPARATOR_S ".Trash-", uid, NULL);
+
+  g_free (uid);
+
+  return paths;
+}
+
+
+
+static gboolean
+thunar_trash_accounting_is_trash_dir (const gchar *path,
+                                      gboolean     shared)
+{
+  GStatBuf statb;
+  gchar   *parent;
+  gchar   *info_dir;
+  gboolean is_trash_dir;
+
+  /* like g_file_trash(), only use the shared $topdir/.Trash if it is a sticky directory */
+  if (shared)
+    {
+      parent = g_path_get_dirname (path);
+      is_trash_dir = g_lstat (parent, &statb) == 0 && S_ISDIR (statb.st_mode) && (statb.st_mode & S_ISVTX) != 0;
+      g_free (parent);
+
+      if (!is_trash_dir)
+        return FALSE;
+    }
+
+  info_dir = g_build_filename (path, "info", NULL);
+  is_trash_dir = g_file_test (info_dir, G_FILE_TEST_IS_DIR);
+  g_free (info_dir);
+
+  return is_trash_dir;
+}
+
+
+
+static void
+thunar_trash_accounting_add_mount (ThunarTrashAccounting *accounting,
+                                   GMount                *mount)
+{
+  GFile  *root;
+  gchar  *root_path = NULL;
+  gchar **paths;
+
+  /* like g_file_trash(), only local volumes have trash directories of their own */
+  root = g_mount_get_root (mount);
+  if (g_file_is_native (root))
+    root_path = g_file_get_path (root);
+  g_object_unref (root);
+
+  if (root_path == NULL)
+    return;
+
+  /* the candidates are checked in the measuring thread */
+  paths = thunar_trash_accounting_get_volume_dirs (root_path);
+  for (guint n = 0; paths[n] != NULL; ++n)
+    thunar_trash_accounting_add_dir (accounting, paths[n], n == 0);
+
+  g_strfreev (paths);
+  g_free (root_path);
+}
+
+
+
+/* looks for trash directories which were created since the last check */
+static void
+thunar_trash_accounting_add_dirs (ThunarTrashAccounting *accounting)
+{
+  GList *mounts;
+  GList *lp;
+  gchar *home_trash;
+
+  home_trash = g_build_filename (g_get_user_data_dir (), "Trash", NULL);
+  thunar_trash_accounting_add_dir (accounting, home_trash, FALSE);
+  g_free (home_trash);
+
+  mounts = g_volume_monitor_get_mounts (accounting->volume_monitor);
+  for (lp = mounts; lp != NULL; lp = lp->next)
+    thunar_trash_accounting_add_mount (accounting, lp->data);
+  g_list_free_full (mounts, g_object_unref);
+}
+
+
+
+static void
+thunar_trash_accounting_init (ThunarTrashAccounting *accounting)
+{
+  accounting->dirs = g_hash_table_new (g_str_hash, g_str_equal);
+}
+
+
+
+static void
+thunar_trash_accounting_constructed (GObject *object)
+{
+  ThunarTrashAccounting *accounting = THUNAR_TRASH_ACCOUNTING (object);
+
+  (*G_OBJECT_CLASS (thunar_trash_accounting_parent_class)->constructed) (object);
+
+  if (accounting->volume_monitor == NULL)
+    accounting->volume_monitor = g_volume_monitor_get ();
+  g_signal_connect (accounting->volume_monitor, "mount-added", G_CALLBACK (thunar_trash_accounting_mount_added), accounting);
+  g_signal_connect (accounting->volume_monitor, "mount-removed", G_CALLBACK (thunar_trash_accounting_mount_removed), accounting);
+
+  /* the jobs report the items they trashed to the first instance */
+  if (accounting_instance == NULL)
+    {
+      accounting_instance = accounting;
+      g_object_add_weak_pointer (G_OBJECT (accounting_instance), (gpointer) &accounting_instance);
+    }
+
+  thunar_trash_accounting_add_dirs (accounting);
+}
+
+
+
+static void
+thunar_trash_dir_free (gpointer data)
+{
+  ThunarTrashDir *dir = data;
+
+  if (dir->monitor != NULL)
+    {
+      g_signal_handlers_disconnect_by_data (dir->monitor, dir);
+      g_file_monitor_cancel (dir->monitor);
+      g_object_unref (dir->monitor);
+    }
+
+  g_hash_table_destroy (dir->items);
+  g_hash_table_destroy (dir->pending);
+  g_free (dir->path);
+  g_slice_free (ThunarTrashDir, dir);
+}
+
+
+
+static void
+thunar_trash_accounting_finalize (GObject *object)
+{
+  ThunarTrashAccounting *accounting = THUNAR_TRASH_ACCOUNTING (object);
+  GHashTableIter         iter;
+  gpointer               dir;
+
+  if (accounting->measure_timer_id != 0)
+    g_source_remove (accounting->measure_timer_id);
+  if (accounting->changed_timer_id != 0)
+    g_source_remove (accounting->changed_timer_id);
+
+  g_signal_handlers_disconnect_by_data (accounting->volume_monitor, accounting);
+  g_object_unref (accounting->volume_monitor);
+
+  g_hash_table_iter_init (&iter, accounting->dirs);
+  while (g_hash_table_iter_next (&iter, NULL, &dir))
+    thunar_trash_dir_free (dir);
+  g_hash_table_destroy (accounting->dirs);
+
+  (*G_OBJECT_CLASS (thunar_trash_accounting_parent_class)->finalize) (object);
+}
+
+
+
+static void
+thunar_trash_accounting_set_property (GObject      *object,
+                                      guint         prop_id,
+                                      const GValue *value,
+                                      GParamSpec   *pspec)
+{
+  ThunarTrashAccounting *accounting = THUNAR_TRASH_ACCOUNTING (object);
+
+  switch (prop_id)
+    {
+    case PROP_VOLUME_MONITOR:
+      accounting->volume_monitor = g_value_dup_object (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+
+
+static void
+thunar_trash_accounting_mount_added (GVolumeMonitor        *volume_monitor,
+                                     GMount                *mount,
+                                     ThunarTrashAccounting *accounting)
+{
+  _thunar_return_if_fail (THUNAR_IS_TRASH_ACCOUNTING (accounting));
+  _thunar_return_if_fail (G_IS_MOUNT (mount));
+
+  thunar_trash_accounting_add_mount (accounting, mount);
+}
+
+
+
+static void
+thunar_trash_accounting_mount_removed (GVolumeMonitor        *volume_monitor,
+                                       GMount                *mount,
+                                       ThunarTrashAccounting *accounting)
+{
+  ThunarTrashDir *dir;
+  GFile          *root;
+  gchar          *root_path;
+  gchar         **paths;
+
+  _thunar_return_if_fail (THUNAR_IS_TRASH_ACCOUNTING (accounting));
+  _thunar_return_if_fail (G_IS_MOUNT (mount));
+
+  root = g_mount_get_root (mount);
+  root_path = g_file_get_path (root);
+  g_object_unref (root);
+
+  if (root_path == NULL)
+    return;
+
+  /* the items on the volume are no longer in the trash. Pending measurements
+   * of the directory are dropped when they finish */
+  paths = thunar_trash_accounting_get_volume_dirs (root_path);
+  for (guint n = 0; paths[n] != NULL; ++n)
+    {
+      dir = g_hash_table_lookup (accounting->dirs, paths[n]);
+      if (dir != NULL)
+        {
+          g_hash_table_remove (accounting->dirs, paths[n]);
+          thunar_trash_dir_free (dir);
+          thunar_trash_accounting_changed (accounting);
+        }
+    }
+
+  g_strfreev (paths);
+  g_free (root_path);
+}
+
+
+
+static void
+thunar_trash_dir_remove_item (ThunarTrashDir *dir,
+                              const gchar    *name)
+{
+  gpointer size;
+
+  if (g_hash_table_lookup_extended (dir->items, name, NULL, &size))
+    {
+      dir->size -= *(guint64 *) size;
+      g_hash_table_remove (dir->items, name);
+    }
+}
+
+
+
+static void
+thunar_trash_dir_set_item (ThunarTrashDir *dir,
+                           const gchar    *name,
+                           guint64         size)
+{
+  thunar_trash_dir_remove_item (dir, name);
+
+  g_hash_table_insert (dir->items, g_strdup (name), g_memdup2 (&size, sizeof (size)));
+  dir->size += size;
+}
+
+
+
+/* queues @name to be measured, in the background */
+static void
+thunar_trash_dir_queue_item (ThunarTrashDir *dir,
+                             const gchar    *name)
+{
+  g_hash_table_add (dir->pending, g_strdup (name));
+  thunar_trash_accounting_schedule (dir->accounting);
+}
+
+
+
+static void
+thunar_trash_dir_monitor_changed (GFileMonitor     *monitor,
+                                  GFile            *file,
+                                  GFile            *other_file,
+                                  GFileMonitorEvent event_type,
+                                  ThunarTrashDir   *dir)
+{
+  gchar *basename;
+
+  if (event_type == G_FILE_MONITOR_EVENT_RENAMED)
+    {
+      /* handled as removal of @file and creation of @other_file */
+      thunar_trash_dir_monitor_changed (monitor, file, NULL, G_FILE_MONITOR_EVENT_DELETED, dir);
+      if (other_file != NULL)
+        thunar_trash_dir_monitor_changed (monitor, other_file, NULL, G_FILE_MONITOR_EVENT_CREATED, dir);
+      return;
+    }
+
+  if (event_type != G_FILE_MONITOR_EVENT_CREATED
+      && event_type != G_FILE_MONITOR_EVENT_MOVED_IN
+      && event_type != G_FILE_MONITOR_EVENT_DELETED
+      && event_type != G_FILE_MONITOR_EVENT_MOVED_OUT)
+    return;
+
+  basename = g_file_get_basename (file);
+  if (basename != NULL && g_str_has_suffix (basename, TRASHINFO_SUFFIX))
+    {
+      basename[strlen (basename) - strlen (TRASHINFO_SUFFIX)] = '\0';
+
+      if (event_type == G_FILE_MONITOR_EVENT_DELETED || event_type == G_FILE_MONITOR_EVENT_MOVED_OUT)
+        {
+          thunar_trash_dir_remove_item (dir, basename);
+          thunar_trash_accounting_changed (dir->accounting);
+
+          /* a running measurement may still report the item */
+          if (dir->measuring)
+            thunar_trash_dir_queue_item (dir, basename);
+        }
+      else
+        {
+          thunar_trash_dir_queue_item (dir, basename);
+        }
+    }
+
+  g_free (basename);
+}
+
+
+
+/* adds the candidate trash directory @path, which is checked and then measured in the background */
+static void
+thunar_trash_accounting_add_dir (ThunarTrashAccounting *accounting,
+                                 const gchar           *path,
+                                 gboolean               shared)
+{
+  ThunarTrashDir *dir;
+
+  if (g_hash_table_contains (accounting->dirs, path))
+    return;
+
+  dir = g_slice_new0 (ThunarTrashDir);
+  dir->accounting = accounting;
+  dir->path = g_strdup (path);
+  dir->shared = shared;
+  dir->items = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  dir->pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  g_hash_table_insert (accounting->dirs, dir->path, dir);
+
+  thunar_trash_accounting_measure (accounting, dir);
+}
+
+
+
+/* starts to account @dir, once the measuring thread found it to be a trash directory */
+static void
+thunar_trash_dir_verified (ThunarTrashDir *dir)
+{
+  GFile *info_dir;
+
+  dir->verified = TRUE;
+
+  /* watch the trash info files, which are created before and removed after the items */
+  info_dir = g_file_new_build_filename (dir->path, "info", NULL);
+  dir->monitor = g_file_monitor_directory (info_dir, G_FILE_MONITOR_WATCH_MOVES, NULL, NULL);
+  if (dir->monitor != NULL)
+    g_signal_connect (dir->monitor, "changed", G_CALLBACK (thunar_trash_dir_monitor_changed), dir);
+  g_object_unref (info_dir);
+
+  /* measure the whole directory once, items showing up meanwhile are reported by the monitor */
+  thunar_trash_accounting_measure (dir->accounting, dir);
+}
+
+
+
+static void
+thunar_trash_measure_free (gpointer data)
+{
+  ThunarTrashMeasure *measure = data;
+
+  g_free (measure->path);
+  g_strfreev (measure->names);
+  if (measure->sizes != NULL)
+    g_hash_table_destroy (measure->sizes);
+  if (measure->missing != NULL)
+    g_ptr_array_unref (measure->missing);
+  g_slice_free (ThunarTrashMeasure, measure);
+}
+
+
+
+/* the apparent size of @path and its contents, without following symlinks */
+static guint64
+thunar_trash_measure_path (const gchar *path,
+                           GStatBuf    *statb)
+{
+  GStatBuf     child_statb;
+  const gchar *name;
+  guint64      size;
+  gchar       *child_path;
+  GDir        *dp;
+
+  size = statb->st_size;
+
+  if (!S_ISDIR (statb->st_mode))
+    return size;
+
+  dp = g_dir_open (path, 0, NULL);
+  if (dp == NULL)
+    return size;
+
+  while ((name = g_dir_read_name (dp)) != NULL)
+    {
+      child_path = g_build_filename (path, name, NULL);
+      if (g_lstat (child_path, &child_statb) == 0)
+        size += thunar_trash_measure_path (child_path, &child_statb);
+      g_free (child_path);
+    }
+
+  g_dir_close (dp);
+
+  return size;
+}
+
+
+
+/* reads the directorysizes cache of the trash specification, a line
+ * "<size> <mtime of the trash info> <escaped trash name>" per directory */
+static GHashTable *
+thunar_trash_measure_read_directory_sizes (const gchar *path)
+{
+  ThunarTrashDirectorySize *entry;
+  GHashTable               *sizes;
+  gchar                    *filename;
+  gchar                    *contents;
+  gchar                   **lines;
+  gchar                   **fields;
+  gchar                    *name;
+
+  sizes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  filename = g_build_filename (path, "directorysizes", NULL);
+  if (g_file_get_contents (filename, &contents, NULL, NULL))
+    {
+      lines = g_strsplit (contents, "\n", -1);
+      for (guint n = 0; lines[n] != NULL; ++n)
+        {
+          fields = g_strsplit (lines[n], " ", 3);
+          if (g_strv_length (fields) == 3)
+            {
+              name = g_uri_unescape_string (fields[2], NULL);
+              if (name != NULL)
+                {
+                  entry = g_new (ThunarTrashDirectorySize, 1);
+                  entry->size = g_ascii_strtoull (fields[0], NULL, 10);
+                  entry->mtime = g_ascii_strtoll (fields[1], NULL, 10);
+                  g_hash_table_replace (sizes, name, entry);
+                }
+            }
+          g_strfreev (fields);
+        }
+      g_strfreev (lines);
+      g_free (contents);
+    }
+  g_free (filename);
+
+  return sizes;
+}
+
+
+
+static void
+thunar_trash_measure_item (ThunarTrashMeasure *measure,
+                           const gchar        *name,
+                           GHashTable         *directory_sizes)
+{
+  ThunarTrashDirectorySize *cached;
+  GStatBuf                  info_statb;
+  GStatBuf                  statb;
+  guint64                   size;
+  gchar                    *info_path;
+  gchar                    *path;
+
+  info_path = g_strconcat (measure->path, G_DIR_SEPARATOR_S "info" G_DIR_SEPARATOR_S, name, TRASHINFO_SUFFIX, NULL);
+  path = g_build_filename (measure->path, "files", name, NULL);
+
+  /* items without trash info are not shown in the trash */
+  if (g_stat (info_path, &info_statb) != 0 || g_lstat (path, &statb) != 0)
+    {
+      g_ptr_array_add (measure->missing, g_strdup (name));
+    }
+  else
+    {
+      cached = directory_sizes != NULL ? g_hash_table_lookup (directory_sizes, name) : NULL;
+      if (cached != NULL && S_ISDIR (statb.st_mode) && cached->mtime == (gint64) info_statb.st_mtime)
+        size = cached->size;
+      else
+        size = thunar_trash_measure_path (path, &statb);
+
+      g_hash_table_insert (measure->sizes, g_strdup (name), g_memdup2 (&size, sizeof (size)));
+    }
+
+  g_free (path);
+  g_free (info_path);
+}
+
+
+
+static void
+thunar_trash_measure_thread (GTask        *task,
+                             gpointer      source_object,
+                             gpointer      task_data,
+                             GCancellable *cancellable)
+{
+  ThunarTrashMeasure *measure = task_data;
+  GHashTable         *directory_sizes;
+  const gchar        *name;
+  gchar              *info_dir;
+  gchar              *item_name;
+  GDir               *dp;
+
+  measure->sizes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  measure->missing = g_ptr_array_new_with_free_func (g_free);
+
+  if (measure->verify)
+    {
+      measure->is_trash_dir = thunar_trash_accounting_is_trash_dir (measure->path, measure->shared);
+    }
+  else if (measure->names != NULL)
+    {
+      for (guint n = 0; measure->names[n] != NULL; ++n)
+        thunar_trash_measure_item (measure, measure->names[n], NULL);
+    }
+  else
+    {
+      /* the only full walk, when the trash directory shows up */
+      directory_sizes = thunar_trash_measure_read_directory_sizes (measure->path);
+
+      info_dir = g_build_filename (measure->path, "info", NULL);
+      dp = g_dir_open (info_dir, 0, NULL);
+      if (dp != NULL)
+        {
+          while ((name = g_dir_read_name (dp)) != NULL)
+            {
+              if (!g_str_has_suffix (name, TRASHINFO_SUFFIX))
+                continue;
+
+              item_name = g_strndup (name, strlen (name) - strlen (TRASHINFO_SUFFIX));
+              thunar_trash_measure_item (measure, item_name, directory_sizes);
+              g_free (item_name);
+            }
+          g_dir_close (dp);
+        }
+      g_free (info_dir);
+
+      g_hash_table_destroy (directory_sizes);
+    }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+
+
+static void
+thunar_trash_measure_ready (GObject      *object,
+                            GAsyncResult *result,
+                            gpointer      user_data)
+{
+  ThunarTrashAccounting *accounting = THUNAR_TRASH_ACCOUNTING (object);
+  ThunarTrashMeasure    *measure;
+  ThunarTrashDir        *dir;
+  GHashTableIter         iter;
+  gpointer               name;
+  gpointer               size;
+
+  measure = g_task_get_task_data (G_TASK (result));
+
+  /* the volume of the directory was unmounted in the meantime */
+  dir = g_hash_table_lookup (accounting->dirs, measure->path);
+  if (dir == NULL)
+    return;
+
+  if (measure->verify)
+    {
+      dir->measuring = FALSE;
+      if (measure->is_trash_dir)
+        {
+          thunar_trash_dir_verified (dir);
+        }
+      else
+        {
+          /* not (yet) a trash directory, it is checked again after the next files were trashed */
+          g_hash_table_remove (accounting->dirs, dir->path);
+          thunar_trash_dir_free (dir);
+          thunar_trash_accounting_changed (accounting);
+        }
+      return;
+    }
+
+  for (guint n = 0; n < measure->missing->len; ++n)
+    thunar_trash_dir_remove_item (dir, g_ptr_array_index (measure->missing, n));
+
+  g_hash_table_iter_init (&iter, measure->sizes);
+  while (g_hash_table_iter_next (&iter, &name, &size))
+    thunar_trash_dir_set_item (dir, name, *(guint64 *) size);
+
+  dir->seeded = TRUE;
+  dir->measuring = FALSE;
+
+  /* measure what was reported in the meantime */
+  if (g_hash_table_size (dir->pending) > 0)
+    thunar_trash_accounting_schedule (accounting);
+
+  thunar_trash_accounting_changed (accounting);
+}
+
+
+
+/* measures the pending items of @dir in a thread, or the whole directory if it was not seeded yet */
+static void
+thunar_trash_accounting_measure (ThunarTrashAccounting *accounting,
+                                 ThunarTrashDir        *dir)
+{
+  ThunarTrashMeasure *measure;
+  GTask              *task;
+  GHashTableIter      iter;
+  gpointer            name;
+  guint               n = 0;
+
+  _thunar_return_if_fail (!dir->measuring);
+
+  measure = g_slice_new0 (ThunarTrashMeasure);
+  measure->path = g_strdup (dir->path);
+
+  if (!dir->verified)
+    {
+      measure->verify = TRUE;
+      measure->shared = dir->shared;
+    }
+  else if (dir->seeded)
+    {
+      measure->names = g_new (gchar *, g_hash_table_size (dir->pending) + 1);
+      g_hash_table_iter_init (&iter, dir->pending);
+      while (g_hash_table_iter_next (&iter, &name, NULL))
+        {
+          measure->names[n++] = name;
+          g_hash_table_iter_steal (&iter);
+        }
+      measure->names[n] = NULL;
+    }
+  else
+    {
+      /* the full walk covers everything reported so far */
+      g_hash_table_remove_all (dir->pending);
+    }
+
+  dir->measuring = TRUE;
+
+  task = g_task_new (accounting, NULL, thunar_trash_measure_ready, NULL);
+  g_task_set_task_data (task, measure, thunar_trash_measure_free);
+  g_task_run_in_thread (task, thunar_trash_measure_thread);
+  g_object_unref (task);
+}
+
+
+
+static gboolean
+thunar_trash_accounting_measure_timer (gpointer data)
+{
+  ThunarTrashAccounting *accounting = THUNAR_TRASH_ACCOUNTING (data);
+  ThunarTrashDir        *dir;
+  GHashTableIter         iter;
+
+  accounting->measure_timer_id = 0;
+
+  /* busy directories are scheduled again when their measurement finished */
+  g_hash_table_iter_init (&iter, accounting->dirs);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer) &dir))
+    if (dir->seeded && !dir->measuring && g_hash_table_size (dir->pending) > 0)
+      thunar_trash_accounting_measure (accounting, dir);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+
+static void
+thunar_trash_accounting_schedule (ThunarTrashAccounting *accounting)
+{
+  if (accounting->measure_timer_id == 0)
+    accounting->measure_timer_id = g_timeout_add (THUNAR_TRASH_ACCOUNTING_MEASURE_DELAY, thunar_trash_accounting_measure_timer, accounting);
+}
+
+
+
+static gboolean
+thunar_trash_accounting_changed_timer (gpointer data)
+{
+  ThunarTrashAccounting *accounting = THUNAR_TRASH_ACCOUNTING (data);
+
+  accounting->changed_timer_id = 0;
+  g_signal_emit (accounting, accounting_signals[CHANGED], 0);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+
+/* emitting "changed" for every item would flood the bus when the trash is emptied */
+static void
+thunar_trash_accounting_changed (ThunarTrashAccounting *accounting)
+{
+  if (accounting->changed_timer_id == 0)
+    accounting->changed_timer_id = g_timeout_add (THUNAR_TRASH_ACCOUNTING_CHANGED_DELAY, thunar_trash_accounting_changed_timer, accounting);
+}
+
+
+
+/**
+ * thunar_trash_accounting_get:
+ *
+ * Returns the shared #ThunarTrashAccounting instance. The trash
+ * directories are measured in the background when the instance is
+ * created. The caller is responsible to free the returned object
+ * using g_object_unref() when no longer needed.
+ *
+ * Return value: the #ThunarTrashAccounting.
+ **/
+ThunarTrashAccounting *
+thunar_trash_accounting_get (void)
+{
+  /* the new instance registers itself, see thunar_trash_accounting_constructed() */
+  if (G_UNLIKELY (accounting_instance == NULL))
+    return g_object_new (THUNAR_TYPE_TRASH_ACCOUNTING, NULL);
+
+  return g_object_ref (accounting_instance);
+}
+
+
+
+/**
+ * thunar_trash_accounting_get_usage:
+ * @accounting : a #ThunarTrashAccounting.
+ * @n_items    : (out) (optional): return location for the number of items in the trash.
+ * @size       : (out) (optional): return location for the total size of the items.
+ *
+ * Returns the number of items in the trash and their total size, summed
+ * over all trash directories which were measured so far.
+ *
+ * Return value: %FALSE if some trash directories were not measured yet,
+ *               so @n_items and @size only cover a part of the trash.
+ **/
+gboolean
+thunar_trash_accounting_get_usage (ThunarTrashAccounting *accounting,
+                                   guint64               *n_items,
+                                   guint64               *size)
+{
+  ThunarTrashDir *dir;
+  GHashTableIter  iter;
+  guint64         total_items = 0;
+  guint64         total_size = 0;
+  gboolean        complete = TRUE;
+
+  _thunar_return_val_if_fail (THUNAR_IS_TRASH_ACCOUNTING (accounting), FALSE);
+
+  g_hash_table_iter_init (&iter, accounting->dirs);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer) &dir))
+    {
+      if (!dir->seeded)
+        {
+          complete = FALSE;
+          continue;
+        }
+
+      total_items += g_hash_table_size (dir->items);
+      total_size += dir->size;
+    }
+
+  if (n_items != NULL)
+    *n_items = total_items;
+  if (size != NULL)
+    *size = total_size;
+
+  return complete;
+}
+
+
+
+typedef struct
+{
+  gchar  *trash_dir;
+  gchar **names;
+} ThunarTrashHint;
+
+
+
+static void
+thunar_trash_hint_free (gpointer data)
+{
+  ThunarTrashHint *hint = data;
+
+  g_free (hint->trash_dir);
+  g_strfreev (hint->names);
+  g_slice_free (ThunarTrashHint, hint);
+}
+
+
+
+static gboolean
+thunar_trash_hint_dispatch (gpointer data)
+{
+  ThunarTrashHint *hint = data;
+  ThunarTrashDir  *dir;
+  guint            n;
+
+  /* nobody is interested in the trash */
+  if (accounting_instance == NULL)
+    return G_SOURCE_REMOVE;
+
+  if (hint->trash_dir != NULL)
+    {
+      /* the job may have created the trash directory */
+      if (!g_hash_table_contains (accounting_instance->dirs, hint->trash_dir))
+        thunar_trash_accounting_add_dir (accounting_instance, hint->trash_dir, FALSE);
+
+      dir = g_hash_table_lookup (accounting_instance->dirs, hint->trash_dir);
+      for (n = 0; hint->names != NULL && hint->names[n] != NULL; ++n)
+        thunar_trash_dir_queue_item (dir, hint->names[n]);
+    }
+  else
+    {
+      thunar_trash_accounting_add_dirs (accounting_instance);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+
+
+static void
+thunar_trash_hint_send (gchar  *trash_dir,
+                        gchar **names)
+{
+  ThunarTrashHint *hint;
+
+  hint = g_slice_new (ThunarTrashHint);
+  hint->trash_dir = trash_dir;
+  hint->names = names;
+
+  /* the jobs run in their own threads, the accounting lives in the main thread */
+  g_main_context_invoke_full (NULL, G_PRIORITY_DEFAULT_IDLE, thunar_trash_hint_dispatch, hint, thunar_trash_hint_free);
+}
+
+
+
+/**
+ * thunar_trash_accounting_item_added:
+ * @trash_dir  : the trash directory, containing the files and info directories.
+ * @trash_name : the name of the item in the trash directory.
+ *
+ * Tells the trash accounting that an item was moved into @trash_dir. Unlike
+ * the other functions of #ThunarTrashAccounting, this may be called from
+ * any thread.
+ **/
+void
+thunar_trash_accounting_item_added (const gchar *trash_dir,
+                                    const gchar *trash_name)
+{
+  gchar **names;
+
+  _thunar_return_if_fail (trash_dir != NULL);
+  _thunar_return_if_fail (trash_name != NULL);
+
+  names = g_new (gchar *, 2);
+  names[0] = g_strdup (trash_name);
+  names[1] = NULL;
+
+  thunar_trash_hint_send (g_strdup (trash_dir), names);
+}
+
+
+
+/**
+ * thunar_trash_accounting_files_trashed:
+ *
+ * Tells the trash accounting that files were moved to the trash by
+ * g_file_trash(), which may have created a new trash directory. May be
+ * called from any thread.
+ **/
+void
+thunar_trash_accounting_files_trashed (void)
+{
+  thunar_trash_hint_send (NULL, NULL);
+}
@@ -0,0 +1,57 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar Development Team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __THUNAR_TRASH_ACCOUNTING_H__
+#define __THUNAR_TRASH_ACCOUNTING_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS;
+
+typedef struct _ThunarTrashAccountingClass ThunarTrashAccountingClass;
+typedef struct _ThunarTrashAccounting      ThunarTrashAccounting;
+
+#define THUNAR_TYPE_TRASH_ACCOUNTING (thunar_trash_accounting_get_type ())
+#define THUNAR_TRASH_ACCOUNTING(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), THUNAR_TYPE_TRASH_ACCOUNTING, ThunarTrashAccounting))
+#define THUNAR_TRASH_ACCOUNTING_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST ((klass), THUNAR_TYPE_TRASH_ACCOUNTING, ThunarTrashAccountingClass))
+#define THUNAR_IS_TRASH_ACCOUNTING(obj) (G_TYPE_CHECK_INSTANCE_TYPE ((obj), THUNAR_TYPE_TRASH_ACCOUNTING))
+#define THUNAR_IS_TRASH_ACCOUNTING_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), THUNAR_TYPE_TRASH_ACCOUNTING))
+#define THUNAR_TRASH_ACCOUNTING_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj), THUNAR_TYPE_TRASH_ACCOUNTING, ThunarTrashAccountingClass))
+
+GType
+thunar_trash_accounting_get_type (void) G_GNUC_CONST;
+
+ThunarTrashAccounting *
+thunar_trash_accounting_get (void);
+
+gboolean
+thunar_trash_accounting_get_usage (ThunarTrashAccounting *accounting,
+                                   guint64               *n_items,
+                                   guint64               *size);
+
+void
+thunar_trash_accounting_item_added (const gchar *trash_dir,
+                                    const gchar *trash_name);
+
+void
+thunar_trash_accounting_files_trashed (void);
+
+G_END_DECLS;
+
+#endif /* !__THUNAR_TRASH_ACCOUNTING_H__ */
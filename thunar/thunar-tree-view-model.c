@@ -56,6 +56,7 @@
 #include "thunar/thunar-preferences.h"
 #include "thunar/thunar-private.h"
 #include "thunar/thunar-simple-job.h"
+#include "thunar/thunar-trace.h"
 #include "thunar/thunar-tree-view-model.h"
 #include "thunar/thunar-user.h"
 #include "thunar/thunar-util.h"
@@ -296,6 +297,21 @@ thunar_tree_view_model_file_count_callback (ThunarJob           *job,
                                             ThunarTreeViewModel *model);
 static void
 thunar_tree_view_model_node_destroy (Node *node);
+static gboolean
+thunar_tree_view_model_column_is_cached (gint column);
+static const gchar *
+thunar_tree_view_model_node_get_formatted (ThunarTreeViewModel *model,
+                                           Node                *node,
+                                           gint                 column);
+static void
+thunar_tree_view_model_node_set_formatted (ThunarTreeViewModel *model,
+                                           Node                *node,
+                                           gint                 column,
+                                           const gchar         *str);
+static void
+thunar_tree_view_model_node_clear_formatted (Node *node);
+static void
+thunar_tree_view_model_invalidate_formatted (ThunarTreeViewModel *model);
 static void
 thunar_tree_view_model_dir_files_changed (Node       *node,
                                           GHashTable *files);
@@ -354,6 +370,11 @@ struct _ThunarTreeViewModel
   gboolean              show_hidden;
   gboolean              expandable_folders;
 
+  /* the formatted strings cached in the nodes are only valid if their stamp matches,
+   * they expire at midnight because of relative dates like "Today" */
+  guint  formatted_stamp;
+  gint64 formatted_expiry;
+
   gint n_visible_files;
   gint loading;
 
@@ -390,6 +411,10 @@ struct _Node
   CanExpand can_expand;
   gboolean file_watch_active;
 
+  /* formatted strings of the visible columns, see thunar_tree_view_model_node_get_formatted() */
+  gchar **formatted;
+  guint   formatted_stamp;
+
   /* set of all the children gfiles;
    * contains mappings of (gfile -> GSequenceIter *(_child_node->ptr)) */
   GHashTable *set;
@@ -1243,6 +1268,7 @@ thunar_tree_view_model_get_value (GtkTreeModel *model,
   Node         *node;
   ThunarGroup  *group = NULL;
   const gchar  *device_type;
+  const gchar  *formatted;
   const gchar  *name;
   const gchar  *real_name;
   ThunarUser   *user = NULL;
@@ -1252,11 +1278,27 @@ thunar_tree_view_model_get_value (GtkTreeModel *model,
   GFile        *g_file_parent = NULL;
   gchar        *str = NULL;
   ThunarFile   *file = NULL;
+  gint64        trace_time;
 
   _thunar_return_if_fail (THUNAR_TREE_VIEW_MODEL (model));
   _thunar_return_if_fail (iter->stamp == (THUNAR_TREE_VIEW_MODEL (model))->stamp);
 
   node = g_sequence_get (iter->user_data);
+
+  /* most cells are drawn over and over again, reuse their strings if possible */
+  if (G_LIKELY (node != NULL && node->file != NULL && thunar_tree_view_model_column_is_cached (column)))
+    {
+      formatted = thunar_tree_view_model_node_get_formatted (THUNAR_TREE_VIEW_MODEL (model), node, column);
+      if (formatted != NULL)
+        {
+          g_value_init (value, G_TYPE_STRING);
+          g_value_set_static_string (value, formatted);
+          return;
+        }
+    }
+
+  trace_time = thunar_trace_begin ();
+
   if (node != NULL)
     {
       file = node->file;
@@ -1552,6 +1594,18 @@ thunar_tree_view_model_get_value (GtkTreeModel *model,
       break;
     }
 
+  thunar_trace_end_detail (trace_time, "model", "thunar_tree_view_model_get_value", "column %d", column);
+
+  /* remember the string for the next time the cell is drawn, except
+   * for the free space of mount points, which changes all the time */
+  if (file != NULL
+      && thunar_tree_view_model_column_is_cached (column)
+      && g_value_get_string (value) != NULL
+      && !(column == THUNAR_COLUMN_SIZE && thunar_file_is_mountable (file)))
+    {
+      thunar_tree_view_model_node_set_formatted (THUNAR_TREE_VIEW_MODEL (model), node, column, g_value_get_string (value));
+    }
+
   if (file != NULL)
     g_object_unref (file);
 }
@@ -2052,6 +2106,7 @@ thunar_tree_view_model_set_file_size_binary (ThunarTreeViewModel *model,
     {
       /* apply the new setting */
       _model->file_size_binary = file_size_binary;
+      thunar_tree_view_model_invalidate_formatted (_model);
 
       /* resort the model with the new setting */
       thunar_tree_view_model_sort (_model);
@@ -2193,6 +2248,7 @@ thunar_tree_view_model_set_date_style (ThunarTreeViewModel *model,
     {
       /* apply the new setting */
       model->date_style = date_style;
+      thunar_tree_view_model_invalidate_formatted (model);
 
       /* notify listeners */
       g_object_notify_by_pspec (G_OBJECT (model), tree_model_props[PROP_DATE_STYLE]);
@@ -2218,6 +2274,7 @@ thunar_tree_view_model_set_date_custom_style (ThunarTreeViewModel *model,
       /* apply the new setting */
       g_free (model->date_custom_style);
       model->date_custom_style = g_strdup (date_custom_style);
+      thunar_tree_view_model_invalidate_formatted (model);
 
       /* notify listeners */
       g_object_notify_by_pspec (G_OBJECT (model), tree_model_props[PROP_DATE_CUSTOM_STYLE]);
@@ -2242,6 +2299,7 @@ thunar_tree_view_model_set_folder_item_count (ThunarTreeViewModel  *model,
     return;
 
   model->folder_item_count = count_as_dir_size;
+  thunar_tree_view_model_invalidate_formatted (model);
   g_object_notify_by_pspec (G_OBJECT (model), tree_model_props[PROP_FOLDER_ITEM_COUNT]);
 
   gtk_tree_model_foreach (GTK_TREE_MODEL (model), (GtkTreeModelForeachFunc) (void (*) (void)) gtk_tree_model_row_changed, NULL);
@@ -2424,6 +2482,9 @@ thunar_tree_view_model_new_node (ThunarFile *file)
 
   _node->can_expand = can_expand_unknown;
 
+  _node->formatted = NULL;
+  _node->formatted_stamp = 0;
+
   return _node;
 }
 
@@ -2453,6 +2514,9 @@ thunar_tree_view_model_new_dummy_node (void)
 
   _node->scheduled_unload_id = 0;
 
+  _node->formatted = NULL;
+  _node->formatted_stamp = 0;
+
   return _node;
 }
 
@@ -3132,12 +3196,131 @@ thunar_tree_view_model_node_destroy (Node *node)
   g_hash_table_destroy (node->set);
   g_hash_table_destroy (node->hidden_files);
 
+  thunar_tree_view_model_node_clear_formatted (node);
+
   g_object_unref (node->file);
   g_free (node);
 }
 
 
 
+static gboolean
+thunar_tree_view_model_column_is_cached (gint column)
+{
+  switch (column)
+    {
+    case THUNAR_COLUMN_DATE_CREATED:
+    case THUNAR_COLUMN_DATE_ACCESSED:
+    case THUNAR_COLUMN_DATE_MODIFIED:
+    case THUNAR_COLUMN_DATE_DELETED:
+    case THUNAR_COLUMN_RECENCY:
+    case THUNAR_COLUMN_GROUP:
+    case THUNAR_COLUMN_OWNER:
+    case THUNAR_COLUMN_PERMISSIONS:
+    case THUNAR_COLUMN_SIZE:
+    case THUNAR_COLUMN_SIZE_IN_BYTES:
+    case THUNAR_COLUMN_TYPE:
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+
+
+/**
+ * thunar_tree_view_model_node_get_formatted:
+ * @model  : a #ThunarTreeViewModel.
+ * @node   : the #Node of a file.
+ * @column : a column for which thunar_tree_view_model_column_is_cached() is %TRUE.
+ *
+ * Returns the string of the cell, as it was formatted the last time
+ * thunar_tree_view_model_get_value() was called for it. The string is
+ * owned by the @node and only valid until the file or one of the format
+ * settings changes.
+ *
+ * Return value: the cached string or %NULL.
+ **/
+static const gchar *
+thunar_tree_view_model_node_get_formatted (ThunarTreeViewModel *model,
+                                           Node                *node,
+                                           gint                 column)
+{
+  /* relative dates like "Today" are outdated after midnight */
+  if (G_UNLIKELY (g_get_real_time () >= model->formatted_expiry))
+    thunar_tree_view_model_invalidate_formatted (model);
+
+  if (node->formatted == NULL || node->formatted_stamp != model->formatted_stamp)
+    return NULL;
+
+  return node->formatted[column];
+}
+
+
+
+static void
+thunar_tree_view_model_node_set_formatted (ThunarTreeViewModel *model,
+                                           Node                *node,
+                                           gint                 column,
+                                           const gchar         *str)
+{
+  _thunar_return_if_fail (column < THUNAR_N_VISIBLE_COLUMNS);
+
+  /* drop the strings of an older stamp */
+  if (node->formatted != NULL && node->formatted_stamp != model->formatted_stamp)
+    thunar_tree_view_model_node_clear_formatted (node);
+
+  if (node->formatted == NULL)
+    {
+      node->formatted = g_new0 (gchar *, THUNAR_N_VISIBLE_COLUMNS);
+      node->formatted_stamp = model->formatted_stamp;
+    }
+
+  g_free (node->formatted[column]);
+  node->formatted[column] = g_strdup (str);
+}
+
+
+
+static void
+thunar_tree_view_model_node_clear_formatted (Node *node)
+{
+  if (node->formatted == NULL)
+    return;
+
+  for (gint column = 0; column < THUNAR_N_VISIBLE_COLUMNS; ++column)
+    g_free (node->formatted[column]);
+
+  g_free (node->formatted);
+  node->formatted = NULL;
+}
+
+
+
+/* drops the formatted strings of all nodes, they are freed lazily */
+static void
+thunar_tree_view_model_invalidate_formatted (ThunarTreeViewModel *model)
+{
+  GDateTime *now;
+  GDateTime *midnight;
+  GDateTime *tomorrow;
+
+  model->formatted_stamp++;
+
+  /* the strings expire at the next local midnight */
+  now = g_date_time_new_now_local ();
+  midnight = g_date_time_new_local (g_date_time_get_year (now), g_date_time_get_month (now), g_date_time_get_day_of_month (now), 0, 0, 0);
+  tomorrow = g_date_time_add_days (midnight, 1);
+  model->formatted_expiry = g_date_time_to_unix (tomorrow) * G_USEC_PER_SEC;
+
+  g_date_time_unref (tomorrow);
+  g_date_time_unref (midnight);
+  g_date_time_unref (now);
+}
+
+
+
 static void
 thunar_tree_view_model_dir_files_changed (Node       *node_parent,
                                           GHashTable *files)
@@ -3193,6 +3376,9 @@ thunar_tree_view_model_dir_files_changed (Node       *node_parent,
       if (node == NULL)
         continue;
 
+      /* the cached strings are outdated now */
+      thunar_tree_view_model_node_clear_formatted (node);
+
       iter = node->ptr;
 
       pos_before = g_sequence_iter_get_position (iter);
@@ -55,6 +55,7 @@
 
 #include "thunar/thunar-application.h"
 #include "thunar/thunar-folder.h"
+#include "thunar/thunar-grid-view.h"
 #include "thunar/thunar-icon-renderer.h"
 #include "thunar/thunar-io-scan-directory.h"
 #include "thunar/thunar-preferences.h"
@@ -912,9 +913,9 @@ thunar_util_determine_corner_properties (GtkWidget       *widget,
   GtkTextDirection text_direction;
 
   /* only have rounded corners for icon view. */
-  if (G_LIKELY (XFCE_IS_ICON_VIEW (widget)))
+  if (G_LIKELY (THUNAR_IS_GRID_VIEW (widget)))
     {
-      if (xfce_icon_view_get_orientation (XFCE_ICON_VIEW (widget)) == GTK_ORIENTATION_HORIZONTAL)
+      if (thunar_grid_view_get_orientation (THUNAR_GRID_VIEW (widget)) == GTK_ORIENTATION_HORIZONTAL)
         {
           /* Compact View */
           /* determine the radius proportional to either height or width (depens on the view) */
@@ -1263,25 +1264,11 @@ thunar_util_get_statusbar_text_for_files (GHashTable     *files,
                                           const gchar    *date_custom_style,
                                           guint           status_bar_actve_info)
 {
-  guint64        size_summary = 0;
-  gint           folder_count = 0, hidden_folder_count = 0;
-  gint           file_count = 0, hidden_file_count = 0;
-  GList         *text_list = NULL;
-  gchar         *size_string = NULL;
-  gchar         *temp_string = NULL;
-  gchar         *folder_text = NULL;
-  gchar         *file_text = NULL;
-  guint64        last_modified_date = 0;
-  guint64        temp_last_modified_date;
-  GFileInfo     *last_modified_file = NULL;
-  gboolean       show_hidden_count, show_size, show_size_in_bytes, show_last_modified;
-  GHashTableIter iter;
-  gpointer       key;
-
-  show_hidden_count = thunar_status_bar_info_check_active (status_bar_actve_info, THUNAR_STATUS_BAR_INFO_HIDDEN_COUNT);
-  show_size = thunar_status_bar_info_check_active (status_bar_actve_info, THUNAR_STATUS_BAR_INFO_SIZE);
-  show_size_in_bytes = thunar_status_bar_info_check_active (status_bar_actve_info, THUNAR_STATUS_BAR_INFO_SIZE_IN_BYTES);
-  show_last_modified = thunar_status_bar_info_check_active (status_bar_actve_info, THUNAR_STATUS_BAR_INFO_LAST_MODIFIED);
+  ThunarFileSummary summary = { 0, };
+  guint64           temp_last_modified_date;
+  gboolean          is_hidden;
+  GHashTableIter    iter;
+  gpointer          key;
 
   /* analyze files */
   g_hash_table_iter_init (&iter, files);
@@ -1295,44 +1282,79 @@ thunar_util_get_statusbar_text_for_files (GHashTable     *files,
       if (file_info == NULL)
         continue;
 
+      is_hidden = g_file_info_get_attribute_boolean (file_info, G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN) || g_file_info_get_attribute_boolean (file_info, G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP);
       if (g_file_info_get_attribute_uint32 (file_info, G_FILE_ATTRIBUTE_STANDARD_TYPE) == G_FILE_TYPE_DIRECTORY)
         {
-          folder_count++;
-          if (g_file_info_get_attribute_boolean (file_info, G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN) || g_file_info_get_attribute_boolean (file_info, G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP))
-            hidden_folder_count++;
+          summary.folder_count++;
+          if (is_hidden)
+            summary.hidden_folder_count++;
         }
       else
         {
-          file_count++;
-          if (g_file_info_get_attribute_boolean (file_info, G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN) || g_file_info_get_attribute_boolean (file_info, G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP))
-            hidden_file_count++;
-          if (g_file_info_get_attribute_uint32 (file_info, G_FILE_ATTRIBUTE_STANDARD_TYPE) == G_FILE_TYPE_REGULAR)
-            g_file_info_get_attribute_uint64 (file_info, G_FILE_ATTRIBUTE_STANDARD_SIZE);
-          size_summary += g_file_info_get_attribute_uint64 (file_info, G_FILE_ATTRIBUTE_STANDARD_SIZE);
+          summary.file_count++;
+          if (is_hidden)
+            summary.hidden_file_count++;
+          summary.size += g_file_info_get_attribute_uint64 (file_info, G_FILE_ATTRIBUTE_STANDARD_SIZE);
         }
 
       temp_last_modified_date = thunar_util_get_file_time (file_info, THUNAR_FILE_DATE_MODIFIED);
-      if (last_modified_date <= temp_last_modified_date)
-        {
-          last_modified_date = temp_last_modified_date;
-
-          /* Keep the last modified file-info for later */
-          if (last_modified_file != NULL)
-            g_object_unref (last_modified_file);
-          last_modified_file = g_object_ref (file_info);
-        }
+      if (summary.last_modified < temp_last_modified_date)
+        summary.last_modified = temp_last_modified_date;
 
       g_object_unref (file_info);
     }
 
-  if (file_count > 0)
+  return thunar_util_get_statusbar_text_for_summary (&summary, show_hidden, show_file_size_binary_format,
+                                                     date_style, date_custom_style, status_bar_actve_info);
+}
+
+
+
+/**
+ * thunar_util_get_statusbar_text_for_summary:
+ * @summary                      : the totals of the files for which a text is requested
+ * @show_hidden                  : whether hidden files are shown
+ * @show_file_size_binary_format : whether the file size should be displayed in binary format
+ * @date_style                   : the #ThunarDateFormat used to humanize the @file_time.
+ * @date_custom_style            : custom style to apply, if @date_style is set to custom
+ * @status_bar_actve_info        : bitmask of the information shown in the statusbar
+ *
+ * Generates the statusbar text for the files counted in @summary,
+ * without looking at the files themselves.
+ *
+ * The caller is reponsible to free the returned text using
+ * g_free() when it's no longer needed.
+ *
+ * Return value: the statusbar text for @summary.
+ **/
+gchar *
+thunar_util_get_statusbar_text_for_summary (const ThunarFileSummary *summary,
+                                            gboolean                 show_hidden,
+                                            gboolean                 show_file_size_binary_format,
+                                            ThunarDateStyle          date_style,
+                                            const gchar             *date_custom_style,
+                                            guint                    status_bar_actve_info)
+{
+  GList   *text_list = NULL;
+  gchar   *size_string = NULL;
+  gchar   *temp_string = NULL;
+  gchar   *folder_text = NULL;
+  gchar   *file_text = NULL;
+  gboolean show_hidden_count, show_size, show_size_in_bytes, show_last_modified;
+
+  show_hidden_count = thunar_status_bar_info_check_active (status_bar_actve_info, THUNAR_STATUS_BAR_INFO_HIDDEN_COUNT);
+  show_size = thunar_status_bar_info_check_active (status_bar_actve_info, THUNAR_STATUS_BAR_INFO_SIZE);
+  show_size_in_bytes = thunar_status_bar_info_check_active (status_bar_actve_info, THUNAR_STATUS_BAR_INFO_SIZE_IN_BYTES);
+  show_last_modified = thunar_status_bar_info_check_active (status_bar_actve_info, THUNAR_STATUS_BAR_INFO_LAST_MODIFIED);
+
+  if (summary->file_count > 0)
     {
-      file_text = g_strdup_printf (ngettext ("%d file", "%d files", file_count), file_count);
+      file_text = g_strdup_printf (ngettext ("%d file", "%d files", summary->file_count), summary->file_count);
 
-      if (show_hidden_count == TRUE && show_hidden == FALSE && hidden_file_count > 0)
+      if (show_hidden_count == TRUE && show_hidden == FALSE && summary->hidden_file_count > 0)
         {
           /* TRANSLATORS: Using ngettext here, since some languages do require a different plural form here */
-          temp_string = g_strdup_printf (ngettext ("%s (%d hidden)", "%s (%d hidden)", hidden_file_count), file_text, hidden_file_count);
+          temp_string = g_strdup_printf (ngettext ("%s (%d hidden)", "%s (%d hidden)", summary->hidden_file_count), file_text, summary->hidden_file_count);
           g_free (file_text);
           file_text = temp_string;
         }
@@ -1341,12 +1363,12 @@ thunar_util_get_statusbar_text_for_files (GHashTable     *files,
         {
           if (show_size_in_bytes == TRUE)
             {
-              size_string = g_format_size_full (size_summary, G_FORMAT_SIZE_LONG_FORMAT
-                                                              | (show_file_size_binary_format ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT));
+              size_string = g_format_size_full (summary->size, G_FORMAT_SIZE_LONG_FORMAT
+                                                               | (show_file_size_binary_format ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT));
             }
           else
             {
-              size_string = g_format_size_full (size_summary, show_file_size_binary_format ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT);
+              size_string = g_format_size_full (summary->size, show_file_size_binary_format ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT);
             }
 
           temp_string = g_strdup_printf (_ ("%s: %s"), file_text, size_string);
@@ -1356,17 +1378,17 @@ thunar_util_get_statusbar_text_for_files (GHashTable     *files,
         }
     }
 
-  if (folder_count > 0)
+  if (summary->folder_count > 0)
     {
       folder_text = g_strdup_printf (ngettext ("%d folder",
                                                "%d folders",
-                                               folder_count),
-                                     folder_count);
+                                               summary->folder_count),
+                                     summary->folder_count);
 
-      if (show_hidden_count == TRUE && show_hidden == FALSE && hidden_folder_count > 0)
+      if (show_hidden_count == TRUE && show_hidden == FALSE && summary->hidden_folder_count > 0)
         {
           /* TRANSLATORS: Using ngettext here, since some languages do require a different plural form here */
-          temp_string = g_strdup_printf (ngettext ("%s (%d hidden)", "%s (%d hidden)", hidden_folder_count), folder_text, hidden_folder_count);
+          temp_string = g_strdup_printf (ngettext ("%s (%d hidden)", "%s (%d hidden)", summary->hidden_folder_count), folder_text, summary->hidden_folder_count);
           g_free (folder_text);
           folder_text = temp_string;
         }
@@ -1379,17 +1401,15 @@ thunar_util_get_statusbar_text_for_files (GHashTable     *files,
   if (file_text != NULL)
     text_list = g_list_append (text_list, file_text);
 
-  if (show_last_modified && last_modified_file != NULL)
+  if (show_last_modified && (file_text != NULL || folder_text != NULL))
     {
-      temp_string = thunar_util_humanize_file_time (thunar_util_get_file_time (last_modified_file, THUNAR_FILE_DATE_MODIFIED), date_style, date_custom_style);
+      temp_string = thunar_util_humanize_file_time (summary->last_modified, date_style, date_custom_style);
       text_list = g_list_append (text_list, g_strdup_printf (_ ("Last Modified: %s"), temp_string));
       g_free (temp_string);
     }
 
   temp_string = thunar_util_strjoin_list (text_list, "  |  ");
   g_list_free_full (text_list, g_free);
-  if (last_modified_file != NULL)
-    g_object_unref (last_modified_file);
   return temp_string;
 }
 
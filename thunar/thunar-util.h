@@ -45,6 +45,17 @@ typedef enum
   THUNAR_NEXT_FILE_NAME_MODE_LINK,
 } ThunarNextFileNameMode;
 
+/* totals shown in the statusbar for a set of files */
+typedef struct
+{
+  gint    file_count;
+  gint    hidden_file_count;
+  gint    folder_count;
+  gint    hidden_folder_count;
+  guint64 size;
+  guint64 last_modified;
+} ThunarFileSummary;
+
 typedef void (*ThunarBookmarksFunc) (GFile       *file,
                                      const gchar *name,
                                      gint         row_num,
@@ -127,6 +138,13 @@ thunar_util_get_statusbar_text_for_files (GHashTable     *files,
                                           const gchar    *date_custom_style,
                                           guint           status_bar_actve_info);
 gchar *
+thunar_util_get_statusbar_text_for_summary (const ThunarFileSummary *summary,
+                                            gboolean                 show_hidden,
+                                            gboolean                 show_file_size_binary_format,
+                                            ThunarDateStyle          date_style,
+                                            const gchar             *date_custom_style,
+                                            guint                    status_bar_actve_info);
+gchar *
 thunar_util_get_statusbar_text_for_single_file (ThunarFile *file);
 gchar *
 thunar_util_accel_path_to_id (const gchar *accel_path);
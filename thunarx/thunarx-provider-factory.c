@@ -25,12 +25,17 @@
 #include "thunarx/thunarx-visibility.h"
 
 #include <gdk/gdk.h>
+#include <glib/gstdio.h>
 
 
 
 /* "provider cache" cleanup interval (in seconds) */
 #define THUNARX_PROVIDER_FACTORY_INTERVAL (45)
 
+/* location of the provider manifest, relative to the user's cache directory */
+#define THUNARX_PROVIDER_MANIFEST_DIRNAME  "thunarx-3"
+#define THUNARX_PROVIDER_MANIFEST_FILENAME "providers.manifest"
+
 
 
 static void
@@ -40,6 +45,17 @@ thunarx_provider_factory_add (ThunarxProviderFactory *factory,
                               ThunarxProviderModule  *module);
 static void
 thunarx_provider_factory_create_modules (ThunarxProviderFactory *factory);
+static void
+thunarx_provider_factory_load_module (ThunarxProviderModule *module);
+static gboolean
+thunarx_provider_factory_module_implements (ThunarxProviderModule *module,
+                                            GType                  type);
+static gboolean
+thunarx_provider_manifest_read (void);
+static void
+thunarx_provider_manifest_write (void);
+static void
+thunarx_provider_manifest_entry_free (gpointer data);
 static gboolean
 thunarx_provider_factory_timer (gpointer user_data);
 static void
@@ -62,6 +78,13 @@ typedef struct
   GType    type;     /* provider GType */
 } ThunarxProviderInfo;
 
+typedef struct
+{
+  gchar  *path;       /* absolute path of the module file */
+  gint64  mtime;      /* modification time of the module file */
+  gchar **interfaces; /* interfaces implemented by the module's types or %NULL if unknown */
+} ThunarxProviderManifestEntry;
+
 struct _ThunarxProviderFactoryClass
 {
   GObjectClass __parent__;
@@ -76,13 +99,15 @@ struct _ThunarxProviderFactory
 
   guint timer_id; /* GSource timer to cleanup cached providers */
 
-  gint initialized;
+  GHashTable *added_modules; /* modules whose types were added to the infos array */
 };
 
 static gboolean thunarx_provider_modules_created = FALSE;
 static GList   *thunarx_provider_modules = NULL;            /* list of all active provider modules */
 static GList   *thunarx_persistent_provider_modules = NULL; /* list of active persistent provider modules */
 static GList   *thunarx_volatile_provider_modules = NULL;   /* list of active volatile provider modules */
+static GList   *thunarx_lazy_provider_modules = NULL;       /* list of modules not loaded yet, known from the manifest */
+static GQuark   thunarx_provider_manifest_quark;
 
 
 G_DEFINE_TYPE (ThunarxProviderFactory, thunarx_provider_factory, G_TYPE_OBJECT)
@@ -103,7 +128,7 @@ thunarx_provider_factory_class_init (ThunarxProviderFactoryClass *klass)
 static void
 thunarx_provider_factory_init (ThunarxProviderFactory *factory)
 {
-  factory->initialized = FALSE;
+  factory->added_modules = g_hash_table_new (g_direct_hash, g_direct_equal);
 }
 
 
@@ -124,6 +149,8 @@ thunarx_provider_factory_finalize (GObject *object)
       g_object_unref (factory->infos[n].provider);
   g_free (factory->infos);
 
+  g_hash_table_destroy (factory->added_modules);
+
   (*G_OBJECT_CLASS (thunarx_provider_factory_parent_class)->finalize) (object);
 }
 
@@ -158,12 +185,17 @@ thunarx_provider_factory_add (ThunarxProviderFactory *factory,
 static void
 thunarx_provider_factory_create_modules (ThunarxProviderFactory *factory)
 {
-  ThunarxProviderModule *module;
-  const gchar           *name;
-  GList                 *lp;
-  GDir                  *dp;
-  gchar                 *dirs_string = NULL;
-  gchar                **dirs;
+  ThunarxProviderManifestEntry *entry;
+  ThunarxProviderModule        *module;
+  const gchar                  *name;
+  GStatBuf                      statb;
+  GList                        *lp;
+  GDir                         *dp;
+  gchar                        *dirs_string = NULL;
+  gchar                       **dirs;
+
+  if (G_UNLIKELY (thunarx_provider_manifest_quark == 0))
+    thunarx_provider_manifest_quark = g_quark_from_static_string ("thunarx-provider-manifest");
 
   if (g_strcmp0 (THUNARX_ENABLE_CUSTOM_DIRS, "TRUE") == 0)
     dirs_string = (gchar *) g_getenv ("THUNARX_DIRS");
@@ -200,8 +232,16 @@ thunarx_provider_factory_create_modules (ThunarxProviderFactory *factory)
                   if (G_UNLIKELY (module_already_loaded == TRUE))
                     continue;
 
+                  /* remember where the module lives, to match it against the manifest */
+                  entry = g_slice_new0 (ThunarxProviderManifestEntry);
+                  entry->path = g_build_filename (dirs[i], name, NULL);
+                  if (g_stat (entry->path, &statb) == 0)
+                    entry->mtime = statb.st_mtime;
+
                   /* allocate the new module and add it to our lists */
                   module = thunarx_provider_module_new (name);
+                  g_object_set_qdata_full (G_OBJECT (module), thunarx_provider_manifest_quark,
+                                           entry, thunarx_provider_manifest_entry_free);
                   thunarx_provider_modules = g_list_prepend (thunarx_provider_modules, module);
                 }
             }
@@ -215,6 +255,161 @@ thunarx_provider_factory_create_modules (ThunarxProviderFactory *factory)
 
 
 
+static void
+thunarx_provider_factory_load_module (ThunarxProviderModule *module)
+{
+  ThunarxProviderManifestEntry *entry;
+  const GType                  *types = NULL;
+  GPtrArray                    *interfaces;
+  GType                        *ifaces;
+  gint                          n_types = 0;
+  guint                         n;
+
+  entry = g_object_get_qdata (G_OBJECT (module), thunarx_provider_manifest_quark);
+
+  /* only when loaded, we can tell if the module is persistent or volatile */
+  if (g_type_module_use (G_TYPE_MODULE (module)) && entry->interfaces == NULL)
+    {
+      /* remember the interfaces of the module's types for the manifest */
+      interfaces = g_ptr_array_new ();
+      thunarx_provider_module_list_types (module, &types, &n_types);
+      for (; types != NULL && n_types-- > 0; ++types)
+        {
+          ifaces = g_type_interfaces (*types, NULL);
+          for (n = 0; ifaces[n] != 0; ++n)
+            if (!g_ptr_array_find_with_equal_func (interfaces, g_type_name (ifaces[n]), g_str_equal, NULL))
+              g_ptr_array_add (interfaces, g_strdup (g_type_name (ifaces[n])));
+          g_free (ifaces);
+        }
+      g_ptr_array_add (interfaces, NULL);
+      entry->interfaces = (gchar **) g_ptr_array_free (interfaces, FALSE);
+    }
+
+  if (thunarx_provider_plugin_get_resident (THUNARX_PROVIDER_PLUGIN (module)))
+    thunarx_persistent_provider_modules = g_list_prepend (thunarx_persistent_provider_modules, module);
+  else
+    thunarx_volatile_provider_modules = g_list_prepend (thunarx_volatile_provider_modules, module);
+}
+
+
+
+static gboolean
+thunarx_provider_factory_module_implements (ThunarxProviderModule *module,
+                                            GType                  type)
+{
+  ThunarxProviderManifestEntry *entry;
+
+  /* the manifest only knows about interfaces, so load the module for anything else */
+  if (!G_TYPE_IS_INTERFACE (type))
+    return TRUE;
+
+  entry = g_object_get_qdata (G_OBJECT (module), thunarx_provider_manifest_quark);
+  return g_strv_contains ((const gchar *const *) entry->interfaces, g_type_name (type));
+}
+
+
+
+static gboolean
+thunarx_provider_manifest_read (void)
+{
+  ThunarxProviderManifestEntry *entry;
+  GKeyFile                     *key_file;
+  gboolean                      up_to_date = FALSE;
+  GList                        *lp;
+  gchar                        *filename;
+  gchar                       **groups;
+  gsize                         n_groups;
+  gsize                         n_known = 0;
+
+  filename = g_build_filename (g_get_user_cache_dir (), THUNARX_PROVIDER_MANIFEST_DIRNAME,
+                               THUNARX_PROVIDER_MANIFEST_FILENAME, NULL);
+  key_file = g_key_file_new ();
+
+  if (g_key_file_load_from_file (key_file, filename, G_KEY_FILE_NONE, NULL))
+    {
+      for (lp = thunarx_provider_modules; lp != NULL; lp = lp->next)
+        {
+          entry = g_object_get_qdata (G_OBJECT (lp->data), thunarx_provider_manifest_quark);
+
+          /* only trust the manifest if the module did not change since it was written */
+          if (g_key_file_has_group (key_file, entry->path)
+              && g_key_file_get_int64 (key_file, entry->path, "MTime", NULL) == entry->mtime)
+            entry->interfaces = g_key_file_get_string_list (key_file, entry->path, "Interfaces", NULL, NULL);
+
+          if (entry->interfaces != NULL)
+            ++n_known;
+        }
+
+      /* the manifest also needs to be rewritten if modules were removed */
+      groups = g_key_file_get_groups (key_file, &n_groups);
+      up_to_date = (n_groups == n_known);
+      g_strfreev (groups);
+    }
+
+  g_key_file_free (key_file);
+  g_free (filename);
+
+  return up_to_date;
+}
+
+
+
+static void
+thunarx_provider_manifest_write (void)
+{
+  ThunarxProviderManifestEntry *entry;
+  GKeyFile                     *key_file;
+  GError                       *error = NULL;
+  GList                        *lp;
+  gchar                        *filename;
+  gchar                        *dirname;
+
+  key_file = g_key_file_new ();
+
+  for (lp = thunarx_provider_modules; lp != NULL; lp = lp->next)
+    {
+      entry = g_object_get_qdata (G_OBJECT (lp->data), thunarx_provider_manifest_quark);
+
+      /* modules that failed to load are not recorded, so they are retried next time */
+      if (entry->interfaces == NULL)
+        continue;
+
+      g_key_file_set_int64 (key_file, entry->path, "MTime", entry->mtime);
+      g_key_file_set_string_list (key_file, entry->path, "Interfaces",
+                                  (const gchar *const *) entry->interfaces,
+                                  g_strv_length (entry->interfaces));
+    }
+
+  filename = g_build_filename (g_get_user_cache_dir (), THUNARX_PROVIDER_MANIFEST_DIRNAME,
+                               THUNARX_PROVIDER_MANIFEST_FILENAME, NULL);
+  dirname = g_path_get_dirname (filename);
+  g_mkdir_with_parents (dirname, 0700);
+  g_free (dirname);
+
+  if (!g_key_file_save_to_file (key_file, filename, &error))
+    {
+      g_debug ("Failed to write provider manifest `%s': %s", filename, error->message);
+      g_error_free (error);
+    }
+
+  g_key_file_free (key_file);
+  g_free (filename);
+}
+
+
+
+static void
+thunarx_provider_manifest_entry_free (gpointer data)
+{
+  ThunarxProviderManifestEntry *entry = data;
+
+  g_strfreev (entry->interfaces);
+  g_free (entry->path);
+  g_slice_free (ThunarxProviderManifestEntry, entry);
+}
+
+
+
 static gboolean
 thunarx_provider_factory_timer (gpointer user_data)
 {
@@ -291,6 +486,11 @@ thunarx_provider_factory_get_default (void)
  *
  * Returns all providers of the given @type.
  *
+ * Extension modules are only loaded once they are known to implement
+ * @type. The interfaces implemented by each module are remembered in a
+ * manifest in the user's cache directory, which is refreshed whenever
+ * a module is added, changed or removed.
+ *
  * The caller is responsible to release the returned
  * list of providers using code like this:
  * <informalexample><programlisting>
@@ -303,26 +503,44 @@ GList *
 thunarx_provider_factory_list_providers (ThunarxProviderFactory *factory,
                                          GType                   type)
 {
-  ThunarxProviderInfo *info;
-  GList               *providers = NULL;
-  GList               *lp;
-  gint                 n;
+  ThunarxProviderManifestEntry *entry;
+  ThunarxProviderInfo          *info;
+  GList                        *providers = NULL;
+  GList                        *lp;
+  GList                        *lnext;
+  gboolean                      manifest_changed = FALSE;
+  gint64                        start_time;
+  guint                         n_loaded = 0;
+  gint                          n;
+
+  start_time = g_get_monotonic_time ();
 
   /* create all available modules */
   if (thunarx_provider_modules_created == FALSE)
     {
       thunarx_provider_factory_create_modules (factory);
+      manifest_changed = !thunarx_provider_manifest_read ();
 
-      /* On the first call, we need to load all modules once, since only when loaded, we can tell if they are persistent or volatile */
+      /* On the first call, we need to load all modules the manifest does not know about (yet), since only
+       * when loaded, we can tell which providers they implement. All other modules are loaded on-demand. */
       for (lp = thunarx_provider_modules; lp != NULL; lp = lp->next)
         {
-          g_type_module_use (G_TYPE_MODULE (lp->data));
-          if (thunarx_provider_plugin_get_resident (THUNARX_PROVIDER_PLUGIN (lp->data)))
-            thunarx_persistent_provider_modules = g_list_prepend (thunarx_persistent_provider_modules, lp->data);
+          entry = g_object_get_qdata (G_OBJECT (lp->data), thunarx_provider_manifest_quark);
+          if (entry->interfaces == NULL)
+            {
+              thunarx_provider_factory_load_module (THUNARX_PROVIDER_MODULE (lp->data));
+              ++n_loaded;
+            }
           else
-            thunarx_volatile_provider_modules = g_list_prepend (thunarx_volatile_provider_modules, lp->data);
+            {
+              thunarx_lazy_provider_modules = g_list_prepend (thunarx_lazy_provider_modules, lp->data);
+            }
         }
 
+      /* record the modules loaded above */
+      if (manifest_changed || n_loaded > 0)
+        thunarx_provider_manifest_write ();
+
       thunarx_provider_modules_created = TRUE;
     }
   else
@@ -332,19 +550,34 @@ thunarx_provider_factory_list_providers (ThunarxProviderFactory *factory,
         g_type_module_use (G_TYPE_MODULE (lp->data));
     }
 
-  if (factory->initialized == FALSE)
+  /* load the modules skipped so far, which implement the requested provider */
+  for (lp = thunarx_lazy_provider_modules; lp != NULL; lp = lnext)
     {
-      for (lp = thunarx_provider_modules; lp != NULL; lp = lp->next)
-        thunarx_provider_factory_add (factory, THUNARX_PROVIDER_MODULE (lp->data));
-
-      if (G_UNLIKELY (factory->timer_id == 0))
+      lnext = lp->next;
+      if (thunarx_provider_factory_module_implements (THUNARX_PROVIDER_MODULE (lp->data), type))
         {
-          /* start the "provider cache" cleanup timer */
-          factory->timer_id = g_timeout_add_seconds_full (G_PRIORITY_LOW, THUNARX_PROVIDER_FACTORY_INTERVAL,
-                                                          thunarx_provider_factory_timer, factory,
-                                                          thunarx_provider_factory_timer_destroy);
+          thunarx_provider_factory_load_module (THUNARX_PROVIDER_MODULE (lp->data));
+          thunarx_lazy_provider_modules = g_list_delete_link (thunarx_lazy_provider_modules, lp);
+          ++n_loaded;
         }
-      factory->initialized = TRUE;
+    }
+
+  if (G_UNLIKELY (n_loaded > 0))
+    g_debug ("Loaded %u extension module(s) for %s in %.1f ms", n_loaded, g_type_name (type),
+             (g_get_monotonic_time () - start_time) / 1000.0);
+
+  /* add the types of all modules, which are loaded at this point */
+  for (lp = thunarx_provider_modules; lp != NULL; lp = lp->next)
+    if (G_TYPE_MODULE (lp->data)->use_count > 0
+        && g_hash_table_add (factory->added_modules, lp->data))
+      thunarx_provider_factory_add (factory, THUNARX_PROVIDER_MODULE (lp->data));
+
+  if (G_UNLIKELY (factory->timer_id == 0))
+    {
+      /* start the "provider cache" cleanup timer */
+      factory->timer_id = g_timeout_add_seconds_full (G_PRIORITY_LOW, THUNARX_PROVIDER_FACTORY_INTERVAL,
+                                                      thunarx_provider_factory_timer, factory,
+                                                      thunarx_provider_factory_timer_destroy);
     }
 
   /* determine all available providers for the type */
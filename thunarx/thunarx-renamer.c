@@ -91,6 +91,12 @@ thunarx_renamer_real_process (ThunarxRenamer  *renamer,
                               ThunarxFileInfo *file,
                               const gchar     *text,
                               guint            num);
+static gchar **
+thunarx_renamer_real_process_batch (ThunarxRenamer         *renamer,
+                                    guint                   n_items,
+                                    ThunarxFileInfo *const *files,
+                                    const gchar *const     *texts,
+                                    const guint            *indices);
 static void
 thunarx_renamer_real_load (ThunarxRenamer *renamer,
                            GHashTable     *settings);
@@ -132,6 +138,7 @@ thunarx_renamer_class_init (ThunarxRenamerClass *klass)
   gobject_class->set_property = thunarx_renamer_set_property;
 
   klass->process = thunarx_renamer_real_process;
+  klass->process_batch = thunarx_renamer_real_process_batch;
   klass->load = thunarx_renamer_real_load;
   klass->save = thunarx_renamer_real_save;
   klass->get_menu_items = thunarx_renamer_real_get_menu_items;
@@ -307,6 +314,27 @@ thunarx_renamer_real_process (ThunarxRenamer  *renamer,
 
 
 
+static gchar **
+thunarx_renamer_real_process_batch (ThunarxRenamer         *renamer,
+                                    guint                   n_items,
+                                    ThunarxFileInfo *const *files,
+                                    const gchar *const     *texts,
+                                    const guint            *indices)
+{
+  gchar **names;
+  guint   n;
+
+  /* the fallback method processes the items one by one */
+  names = g_new (gchar *, n_items + 1);
+  for (n = 0; n < n_items; ++n)
+    names[n] = (*THUNARX_RENAMER_GET_CLASS (renamer)->process) (renamer, files[n], texts[n], indices[n]);
+  names[n_items] = NULL;
+
+  return names;
+}
+
+
+
 static void
 thunarx_renamer_real_load (ThunarxRenamer *renamer,
                            GHashTable     *settings)
@@ -555,6 +583,44 @@ thunarx_renamer_process (ThunarxRenamer  *renamer,
 
 
 
+/**
+ * thunarx_renamer_process_batch:
+ * @renamer : a #ThunarxRenamer.
+ * @n_items : the number of items in @files, @texts and @indices.
+ * @files   : (array length=n_items): the #ThunarxFileInfo<!---->s of the files.
+ * @texts   : (array length=n_items): the parts of the filenames to which the
+ *            @renamer should be applied.
+ * @indices : (array length=n_items): the indices of the files in the list.
+ *
+ * Same as calling thunarx_renamer_process() for each of the @n_items
+ * files, but in a single call. Derived classes can override this to
+ * share per-call setup between the items, or to process the items in
+ * parallel, as long as the implementation does not access the @files
+ * or any widgets from other threads. The default implementation simply
+ * calls thunarx_renamer_process() for every item.
+ *
+ * The caller is responsible to free the returned array using
+ * g_strfreev() when no longer needed.
+ *
+ * Return value: (array length=n_items) (transfer full): a %NULL-terminated
+ *               array with the replacement for each of the @texts.
+ *
+ * Since: 4.21.6
+ **/
+gchar **
+thunarx_renamer_process_batch (ThunarxRenamer         *renamer,
+                               guint                   n_items,
+                               ThunarxFileInfo *const *files,
+                               const gchar *const     *texts,
+                               const guint            *indices)
+{
+  g_return_val_if_fail (THUNARX_IS_RENAMER (renamer), NULL);
+  g_return_val_if_fail (n_items == 0 || (files != NULL && texts != NULL && indices != NULL), NULL);
+  return (*THUNARX_RENAMER_GET_CLASS (renamer)->process_batch) (renamer, n_items, files, texts, indices);
+}
+
+
+
 /**
  * thunarx_renamer_load:
  * @renamer  : a #ThunarxRenamer.
@@ -45,6 +45,7 @@ typedef struct _ThunarxRenamer        ThunarxRenamer;
 /**
  * ThunarxRenamerClass:
  * @process:        see thunarx_renamer_process().
+ * @process_batch:  see thunarx_renamer_process_batch().
  * @load:           see thunarx_renamer_load().
  * @save:           see thunarx_renamer_save().
  * @get_menu_items: see thunarx_renamer_get_menu_items().
@@ -78,8 +79,13 @@ struct _ThunarxRenamerClass
                             GtkWindow      *window,
                             GList          *files);
 
+  gchar **(*process_batch) (ThunarxRenamer         *renamer,
+                            guint                   n_items,
+                            ThunarxFileInfo *const *files,
+                            const gchar *const     *texts,
+                            const guint            *indices);
+
   /*< private >*/
-  void (*reserved0) (void);
   void (*reserved1) (void);
   void (*reserved2) (void);
   void (*reserved3) (void);
@@ -125,6 +131,13 @@ thunarx_renamer_process (ThunarxRenamer  *renamer,
                          const gchar     *text,
                          guint            index) G_GNUC_MALLOC;
 
+gchar **
+thunarx_renamer_process_batch (ThunarxRenamer         *renamer,
+                               guint                   n_items,
+                               ThunarxFileInfo *const *files,
+                               const gchar *const     *texts,
+                               const guint            *indices) G_GNUC_MALLOC;
+
 void
 thunarx_renamer_load (ThunarxRenamer *renamer,
                       GHashTable     *settings);